@@ -88,6 +88,8 @@ enum TaksIDs{
 	L2NORM_TASK_ID = 11,
 	DIVIDE_TASK_ID = 12,
         CONVERGENCE_TASK_ID = 13,
+        SPMV_DOT_TASK_ID = 14,
+        SUBTRACT_INPLACE_DOT_TASK_ID = 15,
 };
 
 enum OpIDs{
@@ -99,6 +101,7 @@ class TaskArgs1{
 
 	public:
 	int scalar;
+	int slice_height;
 	FieldID A_row_fid;
 	FieldID A_col_fid;
 	FieldID A_val_fid;
@@ -109,6 +112,7 @@ class TaskArgs1{
 	TaskArgs1(const SpMatrix &A, const Array<T> &x, Array<T> &Ax, int64_t scalar){
 		
 		this-> scalar = scalar;
+		this-> slice_height = A.slice_height;
 		this-> A_row_fid = A.row_fid;
 		this-> A_col_fid = A.col_fid;
 		this-> A_val_fid = A.val_fid;
@@ -199,20 +203,10 @@ void FutureSum::fold<false>(RHS &rhs1, RHS rhs2)
   } while (!__sync_bool_compare_and_swap(target, oldval.as_int, newval.as_int));
 }
 
-// A_x = A * x
 template<typename T>
-void spmv(const SpMatrix &A, const Array<T> &x, Array<T> &A_x, 
-          const Predicate &pred, Context ctx,  HighLevelRuntime *runtime){
-	
-	
-	ArgumentMap arg_map;
-
-	TaskArgs1<T> spmv_args(A, x, A_x, A.max_nzeros);
-
-	IndexLauncher spmv_launcher(SPMV_TASK_ID, x.color_domain,
-				    TaskArgument(&spmv_args, sizeof(spmv_args)), 
-                                    arg_map, pred);
-
+static void add_spmv_requirements(IndexLauncher &spmv_launcher, const SpMatrix &A, 
+                                  const Array<T> &x, Array<T> &A_x)
+{
 	spmv_launcher.add_region_requirement(
 			RegionRequirement(A.row_lp, 0, READ_ONLY, EXCLUSIVE, A.row_lr));
 	spmv_launcher.region_requirements[0].add_field(A.row_fid);
@@ -230,12 +224,94 @@ void spmv(const SpMatrix &A, const Array<T> &x, Array<T> &A_x,
 	spmv_launcher.add_region_requirement(
                         RegionRequirement(A_x.lp, 0, WRITE_DISCARD, EXCLUSIVE, A_x.lr));
         spmv_launcher.region_requirements[3].add_field(A_x.fid);
+}
+
+// A_x = A * x
+template<typename T>
+void spmv(const SpMatrix &A, const Array<T> &x, Array<T> &A_x, 
+          const Predicate &pred, Context ctx,  HighLevelRuntime *runtime){
+	
+	
+	ArgumentMap arg_map;
+
+	TaskArgs1<T> spmv_args(A, x, A_x, A.max_nzeros);
+
+	IndexLauncher spmv_launcher(SPMV_TASK_ID, x.color_domain,
+				    TaskArgument(&spmv_args, sizeof(spmv_args)), 
+                                    arg_map, pred);
+
+	add_spmv_requirements(spmv_launcher, A, x, A_x);
 
 	runtime->execute_index_space(ctx, spmv_launcher);
 	
 	return;
 }
 
+// A_x = A * x, returning x' * A_x from the same pass over A_x
+template<typename T>
+Future spmv_dot(const SpMatrix &A, const Array<T> &x, Array<T> &A_x, 
+                const Predicate &pred, const Future &false_result,
+                Context ctx, HighLevelRuntime *runtime){
+
+	ArgumentMap arg_map;
+
+	TaskArgs1<T> spmv_args(A, x, A_x, A.max_nzeros);
+
+	IndexLauncher spmv_launcher(SPMV_DOT_TASK_ID, x.color_domain,
+				    TaskArgument(&spmv_args, sizeof(spmv_args)), 
+                                    arg_map, pred);
+
+	add_spmv_requirements(spmv_launcher, A, x, A_x);
+
+        spmv_launcher.set_predicate_false_future(false_result);
+
+	Future result = runtime->execute_index_space(ctx, spmv_launcher, REDUCE_ID);
+
+	return(result);
+}
+
+// Generic (accessor based) version of the matrix vector product for one
+// piece of rows.  Returns the dot product of the result with the matching
+// piece of x, which is only used by the fused variant.
+template<typename T>
+static T generic_spmv(const TaskArgs1<T> &task_args, const Rect<1> &row_rect,
+                      const Rect<1> &elem_rect,
+                      RegionAccessor<AccessorType::Generic, int64_t> &acc_num_nzeros,
+                      RegionAccessor<AccessorType::Generic, int64_t> &acc_col,
+                      RegionAccessor<AccessorType::Generic, T> &acc_vals,
+                      RegionAccessor<AccessorType::Generic, T> &acc_x,
+                      RegionAccessor<AccessorType::Generic, T> &acc_Ax)
+{
+	const int max_nzeros = task_args.scalar;
+	const int64_t volume = row_rect.volume();
+	T dot = 0.0;
+
+	DomainPoint pir;
+	pir.dim = 1;
+	GenericPointInRectIterator<1> itr1(row_rect);
+
+	for(int64_t i=0; i < volume; i++){
+
+		T sum = 0.0;
+		int limit = acc_num_nzeros.read(DomainPoint::from_point<1>(itr1.p));
+
+		for(int counter=0; counter < limit; counter++){
+
+			Point<1> elem(elem_rect.lo[0] + ell_offset(i, counter, volume, max_nzeros,
+                                                                   task_args.slice_height));
+			int ind = acc_col.read(DomainPoint::from_point<1>(elem));
+			pir.point_data[0] = ind;
+		
+			sum += acc_vals.read(DomainPoint::from_point<1>(elem)) * acc_x.read(pir);
+		}
+		
+		acc_Ax.write(DomainPoint::from_point<1>(itr1.p), sum);
+		dot += sum * acc_x.read(DomainPoint::from_point<1>(itr1.p));
+		itr1++;
+	}
+	return dot;
+}
+
 template<typename T>
 void spmv_task(const Task *task,
 	       const std::vector<PhysicalRegion> &regions,
@@ -246,8 +322,6 @@ void spmv_task(const Task *task,
 
         const  TaskArgs1<T> task_args = *((const TaskArgs1<T>*)task->args);
 
-	int max_nzeros = task_args.scalar;
-
         RegionAccessor<AccessorType::Generic, int64_t> acc_num_nzeros =
         regions[0].get_field_accessor(task_args.A_row_fid).template typeify<int64_t>();
 
@@ -272,45 +346,144 @@ void spmv_task(const Task *task,
         Rect<1> elem_rect = elem_dom.get_rect<1>();
 
 	// apply matrix vector multiplication
-	{
-		T sum;	
-		DomainPoint pir;
-		pir.dim = 1;
+	generic_spmv<T>(task_args, row_rect, elem_rect, acc_num_nzeros, acc_col,
+                        acc_vals, acc_x, acc_Ax);
+	
+	return;
+}
 
-		GenericPointInRectIterator<1> itr1(row_rect);
-		GenericPointInRectIterator<1> itr2(elem_rect);
+template<typename T>
+T spmv_dot_task(const Task *task,
+                const std::vector<PhysicalRegion> &regions,
+                Context ctx, HighLevelRuntime *runtime){
 
-		for(int i=0; i < row_rect.volume(); i++){
+	assert(regions.size() == 4);
+        assert(task->regions.size() == 4);
 
-			sum = 0.0;
-			int limit = acc_num_nzeros.read(DomainPoint::from_point<1>(itr1.p));
+        const  TaskArgs1<T> task_args = *((const TaskArgs1<T>*)task->args);
 
-			for(int counter=0; counter < limit; counter++){
+        RegionAccessor<AccessorType::Generic, int64_t> acc_num_nzeros =
+        regions[0].get_field_accessor(task_args.A_row_fid).template typeify<int64_t>();
 
-				int ind = acc_col.read(DomainPoint::from_point<1>(itr2.p));
-				pir.point_data[0] = ind;
-			
-				sum += acc_vals.read(DomainPoint::from_point<1>(itr2.p)) * acc_x.read(pir);
-				itr2++;
-			}
-			
-			acc_Ax.write(DomainPoint::from_point<1>(itr1.p), sum);
-			itr1++;
-			itr2.p.x[0] = itr2.p.x[0] + (max_nzeros - limit);
-		}
-	}
-	
-	return;
+        RegionAccessor<AccessorType::Generic, int64_t> acc_col =
+        regions[1].get_field_accessor(task_args.A_col_fid).template typeify<int64_t>();
+
+        RegionAccessor<AccessorType::Generic, T> acc_vals =
+        regions[1].get_field_accessor(task_args.A_val_fid).template typeify<T>();
+
+	RegionAccessor<AccessorType::Generic, T> acc_x =
+        regions[2].get_field_accessor(task_args.x_fid).template typeify<T>();
+
+	RegionAccessor<AccessorType::Generic, T> acc_Ax =
+        regions[3].get_field_accessor(task_args.Ax_fid).template typeify<T>();
+
+        Domain row_dom = runtime->get_index_space_domain(ctx,
+                         task->regions[0].region.get_index_space());
+        Rect<1> row_rect = row_dom.get_rect<1>();
+
+        Domain elem_dom = runtime->get_index_space_domain(ctx,
+                          task->regions[1].region.get_index_space());
+        Rect<1> elem_rect = elem_dom.get_rect<1>();
+
+	return generic_spmv<T>(task_args, row_rect, elem_rect, acc_num_nzeros, acc_col,
+                               acc_vals, acc_x, acc_Ax);
+}
+
+// Sliced ELL (SELL-C) kernel.  Each slice of rows is processed as a unit:
+// the j-th entries of all rows in the slice are contiguous, so values are
+// loaded as one vector and the x entries are gathered by column index.
+// Rows are padded with zero entries up to the widest row of their slice.
+static double sell_spmv(int n_rows, int max_nzeros, int slice_height,
+                        const int64_t *in_nzero_ptr, const int64_t *in_col_ptr,
+                        const double *in_val_ptr, const double *in_x_ptr,
+                        const double *in_p_ptr, double *out_ax_ptr)
+{
+  double result = 0.0;
+#if defined(__AVX__)
+  __m256d dotv = _mm256_set1_pd(0.0);
+#elif defined(__SSE2__)
+  __m128d dotv = _mm_set1_pd(0.0);
+#endif
+  int first = 0;
+  while (first < n_rows) {
+    const int height = std::min(slice_height, n_rows - first);
+    int width = 0;
+    for (int l = 0; l < height; l++)
+      width = std::max(width, (int)in_nzero_ptr[first+l]);
+    const int64_t *col = in_col_ptr + (int64_t)first * max_nzeros;
+    const double *val = in_val_ptr + (int64_t)first * max_nzeros;
+#if defined(__AVX__)
+    if (height == 4) {
+      __m256d sum = _mm256_set1_pd(0.0);
+      for (int j = 0; j < width; j++) {
+#if defined(__AVX2__)
+        __m256i idx = _mm256_loadu_si256((const __m256i*)(col+(j<<2)));
+        __m256d x = _mm256_i64gather_pd(in_x_ptr, idx, sizeof(double));
+#else
+        __m256d x = _mm256_set_pd(in_x_ptr[col[(j<<2)+3]], in_x_ptr[col[(j<<2)+2]],
+                                  in_x_ptr[col[(j<<2)+1]], in_x_ptr[col[(j<<2)]]);
+#endif
+        sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_loadu_pd(val+(j<<2)), x));
+      }
+      _mm256_storeu_pd(out_ax_ptr+first, sum);
+      dotv = _mm256_add_pd(dotv, _mm256_mul_pd(sum, _mm256_loadu_pd(in_p_ptr+first)));
+      first += 4;
+      continue;
+    }
+#elif defined(__SSE2__)
+    if (height == 4) {
+      __m128d sum_lo = _mm_set1_pd(0.0);
+      __m128d sum_hi = _mm_set1_pd(0.0);
+      for (int j = 0; j < width; j++) {
+        const int64_t *c = col+(j<<2);
+        __m128d x_lo = _mm_set_pd(in_x_ptr[c[1]], in_x_ptr[c[0]]);
+        __m128d x_hi = _mm_set_pd(in_x_ptr[c[3]], in_x_ptr[c[2]]);
+        sum_lo = _mm_add_pd(sum_lo, _mm_mul_pd(_mm_loadu_pd(val+(j<<2)), x_lo));
+        sum_hi = _mm_add_pd(sum_hi, _mm_mul_pd(_mm_loadu_pd(val+(j<<2)+2), x_hi));
+      }
+      _mm_storeu_pd(out_ax_ptr+first, sum_lo);
+      _mm_storeu_pd(out_ax_ptr+first+2, sum_hi);
+      dotv = _mm_add_pd(dotv, _mm_mul_pd(sum_lo, _mm_loadu_pd(in_p_ptr+first)));
+      dotv = _mm_add_pd(dotv, _mm_mul_pd(sum_hi, _mm_loadu_pd(in_p_ptr+first+2)));
+      first += 4;
+      continue;
+    }
+#endif
+    // Partial slices and other slice heights
+    for (int l = 0; l < height; l++) {
+      double sum = 0.0;
+      for (int j = 0; j < width; j++)
+        sum += val[j*height+l] * in_x_ptr[col[j*height+l]];
+      out_ax_ptr[first+l] = sum;
+      result += sum * in_p_ptr[first+l];
+    }
+    first += height;
+  }
+#if defined(__AVX__)
+  __m128d lower = _mm256_extractf128_pd(dotv, 0);
+  __m128d upper = _mm256_extractf128_pd(dotv, 1);
+  result += _mm_cvtsd_f64(lower);
+  result += _mm_cvtsd_f64(_mm_shuffle_pd(lower,lower,1));
+  result += _mm_cvtsd_f64(upper);
+  result += _mm_cvtsd_f64(_mm_shuffle_pd(upper,upper,1));
+  _mm256_zeroall();
+#elif defined(__SSE2__)
+  result += _mm_cvtsd_f64(dotv);
+  result += _mm_cvtsd_f64(_mm_shuffle_pd(dotv,dotv,1));
+#endif
+  return result;
 }
 
-static bool dense_spmv(int max_nzeros, const Rect<1> &subgrid_bounds, 
-		       		   const Rect<1> &elem_bounds,
-		               const Rect<1> &vec_bounds,
+static bool dense_spmv(int max_nzeros, int slice_height,
+		       const Rect<1> &subgrid_bounds, 
+		       const Rect<1> &elem_bounds,
+		       const Rect<1> &vec_bounds,
 		       RegionAccessor<AccessorType::Generic,int64_t> &fa_nzero,
                        RegionAccessor<AccessorType::Generic,int64_t> &fa_col,
                        RegionAccessor<AccessorType::Generic,double> &fa_val,
                        RegionAccessor<AccessorType::Generic,double> &fa_x,
-                       RegionAccessor<AccessorType::Generic,double> &fa_ax)
+                       RegionAccessor<AccessorType::Generic,double> &fa_ax,
+                       double &result)
 {
   Rect<1> subrect;
   ByteOffset in_offsets[1], offsets[1];
@@ -336,7 +509,17 @@ static bool dense_spmv(int max_nzeros, const Rect<1> &subgrid_bounds,
   if (!out_ax_ptr || (subrect != subgrid_bounds) ||
       !offsets_are_dense<1,double>(subgrid_bounds, offsets)) return false;
 
+  // The rows of x owned by this piece, for the fused dot product
+  const double *in_p_ptr = in_x_ptr + (subgrid_bounds.lo[0] - vec_bounds.lo[0]);
+
   int n_rows = subgrid_bounds.volume();
+  if (slice_height > 1) {
+    result = sell_spmv(n_rows, max_nzeros, slice_height, in_nzero_ptr, in_col_ptr,
+                       in_val_ptr, in_x_ptr, in_p_ptr, out_ax_ptr);
+    return true;
+  }
+
+  result = 0.0;
 #define STRIP_SIZE 256
   while (n_rows > 0) {
     if (n_rows>= STRIP_SIZE) {
@@ -350,11 +533,13 @@ static bool dense_spmv(int max_nzeros, const Rect<1> &subgrid_bounds,
           sum += (val * xval);
         }
         out_ax_ptr[i] = sum;
+        result += sum * in_p_ptr[i];
       }
       n_rows -= STRIP_SIZE;
       in_nzero_ptr += STRIP_SIZE;
       in_col_ptr += (max_nzeros*STRIP_SIZE);
       in_val_ptr += (max_nzeros*STRIP_SIZE);
+      in_p_ptr += STRIP_SIZE;
       out_ax_ptr += STRIP_SIZE;
     } else {
       for (int i = 0; i < n_rows; i++) {
@@ -367,6 +552,7 @@ static bool dense_spmv(int max_nzeros, const Rect<1> &subgrid_bounds,
           sum += (val * xval);         
         }
         out_ax_ptr[i] = sum;
+        result += sum * in_p_ptr[i];
       }
       n_rows = 0;
     }
@@ -375,10 +561,9 @@ static bool dense_spmv(int max_nzeros, const Rect<1> &subgrid_bounds,
   return true;
 }
 
-template<>
-void spmv_task<double>(const Task *task,
-                       const std::vector<PhysicalRegion> &regions,
-                       Context ctx, HighLevelRuntime *runtime) 
+static double spmv_double(const Task *task,
+                          const std::vector<PhysicalRegion> &regions,
+                          Context ctx, HighLevelRuntime *runtime)
 {
   assert(regions.size() == 4);
   assert(task->regions.size() == 4);
@@ -414,38 +599,30 @@ void spmv_task<double>(const Task *task,
                    task->regions[3].region.get_index_space());
   Rect<1> row_rect = row_dom.get_rect<1>();
 
-  
-  if(dense_spmv(max_nzeros, row_rect, elem_rect, vec_rect, acc_num_nzeros, acc_col, acc_vals, acc_x, acc_Ax)){
-    return;
-  }  
-  else{
-
-  	// Otherwise we fall back
-  	GenericPointInRectIterator<1> itr1(row_rect);
-  	GenericPointInRectIterator<1> itr2(elem_rect);
-  	const int volume = row_rect.volume();
-  	DomainPoint pir;
-  	pir.dim = 1;
-  	for (int i = 0; i < volume; i++) {
-    		double sum = 0.0;
-		int limit = acc_num_nzeros.read(DomainPoint::from_point<1>(itr1.p));
-
-    		for (int j = 0; j < limit; j++) {
+  double result = 0.0;
+  if(dense_spmv(max_nzeros, task_args.slice_height, row_rect, elem_rect, vec_rect,
+                acc_num_nzeros, acc_col, acc_vals, acc_x, acc_Ax, result))
+    return result;
 
-			int ind = acc_col.read(DomainPoint::from_point<1>(itr2.p));
-                                pir.point_data[0] = ind;
+  // Otherwise we fall back
+  return generic_spmv<double>(task_args, row_rect, elem_rect, acc_num_nzeros, acc_col,
+                              acc_vals, acc_x, acc_Ax);
+}
 
-                                sum += acc_vals.read(DomainPoint::from_point<1>(itr2.p)) * acc_x.read(pir);
-                                itr2++;
-                        }
+template<>
+void spmv_task<double>(const Task *task,
+                       const std::vector<PhysicalRegion> &regions,
+                       Context ctx, HighLevelRuntime *runtime) 
+{
+  spmv_double(task, regions, ctx, runtime);
+}
 
-                        acc_Ax.write(DomainPoint::from_point<1>(itr1.p), sum);
-                        itr1++;
-                        itr2.p.x[0] = itr2.p.x[0] + (max_nzeros - limit);
-  	}
-  }
- 
- return;
+template<>
+double spmv_dot_task<double>(const Task *task,
+                             const std::vector<PhysicalRegion> &regions,
+                             Context ctx, HighLevelRuntime *runtime) 
+{
+  return spmv_double(task, regions, ctx, runtime);
 }
 
 // b -= Ax
@@ -798,6 +975,190 @@ void subtract_inplace_task<double>(const Task *task,
   }
 }
 
+// b -= coef * Ax, returning b' * b computed in the same pass over b
+template<typename T>
+Future subtract_inplace_dot(Array<T> &b, const Array<T> &A_x, Future coef, 
+                            const Predicate &pred, const Future &false_result,
+                            Context ctx, HighLevelRuntime *runtime){
+
+        ArgumentMap arg_map;
+
+	TaskArgs2<T> subtract_args(b, A_x);
+	
+        IndexLauncher subtract_launcher(SUBTRACT_INPLACE_DOT_TASK_ID, b.color_domain,
+                              TaskArgument(&subtract_args, sizeof(subtract_args)),
+                              arg_map, pred);
+
+	subtract_launcher.add_future(coef);
+
+        subtract_launcher.add_region_requirement(
+                        RegionRequirement(b.lp, 0, READ_WRITE, EXCLUSIVE, b.lr));
+        subtract_launcher.region_requirements[0].add_field(b.fid);
+
+        subtract_launcher.add_region_requirement(
+                        RegionRequirement(A_x.lp, 0, READ_ONLY, EXCLUSIVE, A_x.lr));
+        subtract_launcher.region_requirements[1].add_field(A_x.fid);
+
+        subtract_launcher.set_predicate_false_future(false_result);
+
+        Future result = runtime->execute_index_space(ctx, subtract_launcher, REDUCE_ID);
+
+	return(result);
+}
+
+template<typename T>
+T subtract_inplace_dot_task(const Task *task,
+                            const std::vector<PhysicalRegion> &regions,
+                            Context ctx, HighLevelRuntime *runtime) {
+  assert(regions.size() == 2);
+  assert(task->regions.size() == 2);
+  assert(task->futures.size() == 1);
+
+  const TaskArgs2<T> task_args = *((const TaskArgs2<T>*)task->args);
+
+  Future dummy = task->futures[0];
+  T alpha = dummy.template get_result<T>();
+
+  RegionAccessor<AccessorType::Generic, T> acc_x =
+  regions[0].get_field_accessor(task_args.x_fid).template typeify<T>();
+
+  RegionAccessor<AccessorType::Generic, T> acc_y =
+  regions[1].get_field_accessor(task_args.y_fid).template typeify<T>();
+
+  Domain dom = runtime->get_index_space_domain(ctx,
+                   task->regions[0].region.get_index_space());
+  Rect<1> rect = dom.get_rect<1>();
+
+  T sum = 0.0;
+  GenericPointInRectIterator<1> itr(rect);
+  const int volume = rect.volume();
+  for (int i = 0; i < volume; i++) {
+    T temp = acc_x.read(DomainPoint::from_point<1>(itr.p)) - 
+              alpha * acc_y.read(DomainPoint::from_point<1>(itr.p));
+    acc_x.write(DomainPoint::from_point<1>(itr.p), temp);
+    sum += temp * temp;
+    itr++;
+  }
+  return sum;
+}
+
+static bool dense_subtract_inplace_dot(const Rect<1> &subgrid_bounds, double alpha,
+                                       double &result,
+                                       RegionAccessor<AccessorType::Generic,double> &fa_x,
+                                       RegionAccessor<AccessorType::Generic,double> &fa_y)
+{
+  Rect<1> subrect;
+  ByteOffset in_offsets[1], offsets[1];
+
+  double *inout_x_ptr = fa_x.raw_rect_ptr<1>(subgrid_bounds, subrect, in_offsets);
+  if (!inout_x_ptr || (subrect != subgrid_bounds) ||
+      !offsets_are_dense<1,double>(subgrid_bounds, in_offsets)) return false;
+
+  const double *in_y_ptr = fa_y.raw_rect_ptr<1>(subgrid_bounds, subrect, offsets);
+  if (!in_y_ptr || (subrect != subgrid_bounds) || 
+      offset_mismatch(1, in_offsets, offsets)) return false;
+
+  int n_pts = subgrid_bounds.volume();
+  result = 0.0;
+#if defined(__AVX__)
+  __m256d temp = _mm256_set1_pd(0.0);
+#elif defined(__SSE2__)
+  __m128d temp = _mm_set1_pd(0.0);
+#endif
+#define STRIP_SIZE 256
+  while (n_pts > 0) {
+    if (n_pts >= STRIP_SIZE) {
+#if defined(__AVX__)
+      __m256d alphad = _mm256_set1_pd(alpha);
+      for (int i = 0; i < (STRIP_SIZE>>2); i++) {
+        __m256d x = _mm256_loadu_pd(inout_x_ptr+(i<<2));
+        __m256d y = _mm256_loadu_pd(in_y_ptr+(i<<2));
+        __m256d r = _mm256_sub_pd(x,_mm256_mul_pd(alphad,y));
+        _mm256_storeu_pd(inout_x_ptr+(i<<2), r);
+        temp = _mm256_add_pd(temp, _mm256_mul_pd(r,r));
+      }
+#elif defined(__SSE2__)
+      __m128d alphad = _mm_set1_pd(alpha);
+      for (int i = 0; i < (STRIP_SIZE>>1); i++) {
+        __m128d x = _mm_loadu_pd(inout_x_ptr+(i<<1));
+        __m128d y = _mm_loadu_pd(in_y_ptr+(i<<1));
+        __m128d r = _mm_sub_pd(x,_mm_mul_pd(alphad,y));
+        _mm_storeu_pd(inout_x_ptr+(i<<1), r);
+        temp = _mm_add_pd(temp, _mm_mul_pd(r,r));
+      }
+#else
+      for (int i = 0; i < STRIP_SIZE; i++) {
+        inout_x_ptr[i] -= (alpha * in_y_ptr[i]);
+        result += (inout_x_ptr[i] * inout_x_ptr[i]);
+      }
+#endif
+      n_pts -= STRIP_SIZE;
+      inout_x_ptr += STRIP_SIZE;
+      in_y_ptr += STRIP_SIZE;
+    } else {
+      for (int i = 0; i < n_pts; i++) {
+        inout_x_ptr[i] -= (alpha * in_y_ptr[i]);
+        result += (inout_x_ptr[i] * inout_x_ptr[i]);
+      }
+      n_pts = 0;
+    }
+  }
+#if defined(__AVX__)
+  __m128d lower = _mm256_extractf128_pd(temp, 0);
+  __m128d upper = _mm256_extractf128_pd(temp, 1);
+  result += _mm_cvtsd_f64(lower);
+  result += _mm_cvtsd_f64(_mm_shuffle_pd(lower,lower,1));
+  result += _mm_cvtsd_f64(upper);
+  result += _mm_cvtsd_f64(_mm_shuffle_pd(upper,upper,1));
+  _mm256_zeroall();
+#elif defined(__SSE2__)
+  result += _mm_cvtsd_f64(temp);
+  result += _mm_cvtsd_f64(_mm_shuffle_pd(temp,temp,1));
+#endif
+#undef STRIP_SIZE
+  return true;
+}
+
+template<>
+double subtract_inplace_dot_task<double>(const Task *task,
+                                         const std::vector<PhysicalRegion> &regions,
+                                         Context ctx, HighLevelRuntime *runtime)
+{
+  assert(regions.size() == 2);
+  assert(task->regions.size() == 2);
+  assert(task->futures.size() == 1);
+
+  const TaskArgs2<double> task_args = *((const TaskArgs2<double>*)task->args);
+
+  Future dummy = task->futures[0]; 
+  double alpha = dummy.get_result<double>();
+
+  RegionAccessor<AccessorType::Generic, double> acc_x =
+  regions[0].get_field_accessor(task_args.x_fid).typeify<double>();
+
+  RegionAccessor<AccessorType::Generic, double> acc_y =
+  regions[1].get_field_accessor(task_args.y_fid).typeify<double>();
+
+  Domain dom = runtime->get_index_space_domain(ctx,
+                   task->regions[0].region.get_index_space());
+  Rect<1> rect = dom.get_rect<1>();
+
+  double sum = 0.0;
+  if (dense_subtract_inplace_dot(rect, alpha, sum, acc_x, acc_y))
+    return sum;
+
+  GenericPointInRectIterator<1> itr(rect);
+  const int volume = rect.volume();
+  for (int i = 0; i < volume; i++) {
+    double temp = acc_x.read(DomainPoint::from_point<1>(itr.p)) - 
+              alpha * acc_y.read(DomainPoint::from_point<1>(itr.p));
+    acc_x.write(DomainPoint::from_point<1>(itr.p), temp);
+    sum += temp * temp;
+    itr++;
+  }
+  return sum;
+}
+
 // p = r_old
 template<typename T>
 void copy(const Array<T> &r, Array<T> &p, Context ctx, HighLevelRuntime *runtime){
@@ -1606,6 +1967,10 @@ static void RegisterOperatorTasks(void) {
 	Processor::LOC_PROC, true/*single*/, true/*index*/,
 	AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "spmv");
 
+	HighLevelRuntime::register_legion_task<T, spmv_dot_task<T> >(SPMV_DOT_TASK_ID, 
+	Processor::LOC_PROC, true/*single*/, true/*index*/,
+	AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "spmv_dot");
+
 	HighLevelRuntime::register_legion_task<subtract_task<T> >(SUBTRACT_TASK_ID,
         Processor::LOC_PROC, true/*single*/, true/*index*/,
         AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "subtract");
@@ -1614,6 +1979,10 @@ static void RegisterOperatorTasks(void) {
         Processor::LOC_PROC, true/*single*/, true/*index*/,
         AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "subtract_inplace");
 
+        HighLevelRuntime::register_legion_task<T, subtract_inplace_dot_task<T> >(SUBTRACT_INPLACE_DOT_TASK_ID,
+        Processor::LOC_PROC, true/*single*/, true/*index*/,
+        AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "subtract_inplace_dot");
+
 	HighLevelRuntime::register_legion_task<T, dot_task<T> >(DOT_TASK_ID,
         Processor::LOC_PROC, true/*single*/, true/*index*/, 
         AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "dotproduct");
@@ -45,6 +45,9 @@ void top_level_task(const Task *task,
     std::string rhs_file;
     bool inputmat = false;
     bool inputrhs = false;
+    bool fused = true;
+    int slice_height = SELL_SLICE_HEIGHT;
+    int spmv_iters = 0;
     const InputArgs &command_args = HighLevelRuntime::get_input_args();
     
         // Parse command line arguments
@@ -74,6 +77,23 @@ void top_level_task(const Task *task,
             assert(iter_max >= 0);
             continue;
           }
+          if (!strcmp(command_args.argv[i], "-nofuse"))
+          {
+            fused = false;
+            continue;
+          }
+          if (!strcmp(command_args.argv[i], "-slice"))
+          {
+            slice_height = atoi(command_args.argv[++i]);
+            assert(slice_height >= 1);
+            continue;
+          }
+          if (!strcmp(command_args.argv[i], "-spmv"))
+          {
+            spmv_iters = atoi(command_args.argv[++i]);
+            assert(spmv_iters >= 0);
+            continue;
+          }
         }
    	
 	// get naprts from the custom mapper
@@ -102,7 +122,10 @@ void top_level_task(const Task *task,
 	std::cout<<"*******************************************************"<<std::endl;
 
 	// report the problem size and memory usage 
-	std::cout<<"SPARSE MATRIX STORAGE FORMAT = ELL"<<std::endl;
+	if(slice_height > 1)
+		std::cout<<"SPARSE MATRIX STORAGE FORMAT = SELL-"<<slice_height<<std::endl;
+	else
+		std::cout<<"SPARSE MATRIX STORAGE FORMAT = ELL"<<std::endl;
 	std::cout<<"MATRIX DIMENSIONS="<<params.nrows<<"x"<<params.nrows<<std::endl;
 	std::cout<<"MEMORY SPENT ON  NONZERO VALUES = "<<params.max_nzeros * params.nrows * sizeof(double) / 1e6 <<
 	" Mb"<<std::endl;
@@ -115,7 +138,8 @@ void top_level_task(const Task *task,
 	
 	// build sparse matrix
 	std::cout<<"Make sparse matrix..."<<std::endl;
-	SpMatrix A(params.nrows, nparts, params.nonzeros, params.max_nzeros, ctx, runtime);
+	SpMatrix A(params.nrows, nparts, params.nonzeros, params.max_nzeros, ctx, runtime,
+		   slice_height);
 	A.BuildMatrix(params.vals, params.col_ind, params.nzeros_per_row, ctx, runtime);
 
 	// build unknown vector   
@@ -139,6 +163,32 @@ void top_level_task(const Task *task,
 		b.Initialize(params.rhs, ctx, runtime);	
 	}
 		
+	// count the stored nonzeros for the flop rates below
+	int64_t nnz = 0;
+	for(int i = 0; i < params.nrows; i++)
+		nnz += params.nzeros_per_row[i];
+
+	if(spmv_iters > 0) {
+		// standalone SpMV benchmark: each launch also computes x' * A * x,
+		// wait on the last reduction to time the whole sequence
+		Array<double> A_b(params.nrows, nparts, ctx, runtime);
+		Predicate loop_pred = Predicate::TRUE_PRED;
+		spmv_dot(A, b, A_b, loop_pred, Future(), ctx, runtime).get_void_result();
+
+		double t_start = Realm::Clock::current_time();
+		Future last;
+		for(int i = 0; i < spmv_iters; i++)
+			last = spmv_dot(A, b, A_b, loop_pred, Future(), ctx, runtime);
+		last.get_void_result();
+		double t_end = Realm::Clock::current_time();
+
+		double time = t_end - t_start;
+		std::cout<<"SPMV: "<<spmv_iters<<" iterations in "<<std::setprecision(6)
+			 <<time * 1e3<<" ms, "<<(spmv_iters / time)<<" iterations/s, "
+			 <<(2.0 * (nnz + params.nrows) * spmv_iters / time / 1e9)<<" GFLOP/s"<<std::endl;
+		A_b.DestroyArray(ctx, runtime);
+	}
+
 	std::cout<<"Launch the CG solver..."<<std::endl;	
 	std::cout<<std::endl;
 
@@ -146,7 +196,7 @@ void top_level_task(const Task *task,
 	// run CG solver
         double t_start = Realm::Clock::current_time();
 
-	CGSolver<double> cgsolver;
+	CGSolver<double> cgsolver(fused);
 	bool result = cgsolver.Solve(A, b, x, iter_max, 1e-4, ctx, runtime);
 
         double t_end = Realm::Clock::current_time();
@@ -156,6 +206,12 @@ void top_level_task(const Task *task,
           double time = (t_end - t_start) * 1e3;
 
           std::cout<<"Elapsed time="<<std::setprecision(10)<<time<<" ms"<<std::endl;
+
+          // one SpMV, two dot products and three vector updates per iteration
+          const int niter = cgsolver.GetNumberIterations();
+          const double flops = (2.0 * nnz + 10.0 * params.nrows) * niter;
+          std::cout<<"Iterations/s="<<std::setprecision(6)<<(niter / (time * 1e-3))
+                   <<" GFLOP/s="<<(flops / (time * 1e-3) / 1e9)<<std::endl;
 	}
 	else {
           std::cout<<"NO CONVERGENCE! :("<<std::endl;
@@ -32,8 +32,14 @@ class CGSolver{
 	private:
 	int niter;
 	T L2normr;
+	bool fused;
 	
 	public:
+	// With 'fused' set, each iteration uses the fused spmv+dot and
+	// subtract+dot tasks, which halves the number of passes over the
+	// vectors compared to issuing every operation on its own.
+	CGSolver(bool fused = true) : niter(0), L2normr(0), fused(fused) {}
+
 	bool Solve(const SpMatrix &A,
 		   const Array<T> &b,
 		   Array<T> &x,
@@ -96,19 +102,32 @@ bool CGSolver<T>::Solve(const SpMatrix &A,
 
 	std::cout<<"Iterating..."<<std::endl;
 
+	// in fused mode the residual norm is carried between iterations
+	if (fused)
+		r2_new = dot(r_old, r_old, loop_pred, r2_new, ctx, runtime);
+
 	while(niter < nitermax){
 		
 		std::cout<<niter<<"            "<<L2normr<<std::endl;
 		niter++;
 
-		// Ap = A * p
-		spmv(A, p, A_p, loop_pred, ctx, runtime);
+		if (fused) {
+			// Ap = A * p and pAp = p' * A * p in one pass
+			pAp = spmv_dot(A, p, A_p, loop_pred, pAp, ctx, runtime);
 
-		// r2 = r' * r
-		r2_old = dot(r_old, r_old, loop_pred, r2_old, ctx, runtime);
+			// r2 = r' * r from the previous iteration
+			r2_old = r2_new;
+		}
+		else {
+			// Ap = A * p
+			spmv(A, p, A_p, loop_pred, ctx, runtime);
 
-		// pAp = p' * A * p
-		pAp = dot(p, A_p, loop_pred, pAp, ctx, runtime);	
+			// r2 = r' * r
+			r2_old = dot(r_old, r_old, loop_pred, r2_old, ctx, runtime);
+
+			// pAp = p' * A * p
+			pAp = dot(p, A_p, loop_pred, pAp, ctx, runtime);	
+		}
 
 		// alpha = r2 / pAp
 		alpha = compute_scalar<T>(r2_old, pAp, loop_pred, alpha, ctx, runtime);	
@@ -116,10 +135,16 @@ bool CGSolver<T>::Solve(const SpMatrix &A,
 		// x = x + alpha * p
 		add_inplace(x, p, alpha, loop_pred, ctx, runtime);
 	
-		// r_old = r_old - alpha * A_p
-                subtract_inplace(r_old, A_p, alpha, loop_pred, ctx, runtime);
+		if (fused) {
+			// r_old = r_old - alpha * A_p and r2_new = r_old' * r_old in one pass
+			r2_new = subtract_inplace_dot(r_old, A_p, alpha, loop_pred, r2_new, ctx, runtime);
+		}
+		else {
+			// r_old = r_old - alpha * A_p
+			subtract_inplace(r_old, A_p, alpha, loop_pred, ctx, runtime);
 
-		r2_new = dot(r_old, r_old, loop_pred, r2_new, ctx, runtime);
+			r2_new = dot(r_old, r_old, loop_pred, r2_new, ctx, runtime);
+		}
 
 		beta = compute_scalar<T>(r2_new, r2_old, loop_pred, beta, ctx, runtime);
 	
@@ -127,7 +152,7 @@ bool CGSolver<T>::Solve(const SpMatrix &A,
                 axpy_inplace(r_old, p, beta, loop_pred, ctx, runtime);
 
 #ifdef PREDICATED_EXECUTION
-                Future norm = dot(r_old, r_old, loop_pred, 
+                Future norm = fused ? r2_new : dot(r_old, r_old, loop_pred, 
                     pending_norms.empty() ? Future() : pending_norms.back(), ctx ,runtime);
                 loop_pred = test_convergence(norm, L2normr0, threshold, 
                     loop_pred, ctx, runtime);
@@ -144,7 +169,10 @@ bool CGSolver<T>::Solve(const SpMatrix &A,
                   }
                 }
 #else
-		L2normr = L2norm(r_old, ctx, runtime);
+		if (fused)
+			L2normr = sqrt(r2_new.get_result<T>());
+		else
+			L2normr = L2norm(r_old, ctx, runtime);
 
 
 		if(L2normr/ L2normr0 < threshold){
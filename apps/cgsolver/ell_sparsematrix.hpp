@@ -20,6 +20,7 @@
 #include <cstdio>
 #include <cassert>
 #include <cstdlib>
+#include <algorithm>
 #include "legion.h"
 
 using namespace LegionRuntime::HighLevel;
@@ -47,6 +48,27 @@ static inline bool offsets_are_dense(const Rect<DIM> &bounds, const ByteOffset *
 }
 #endif
 
+// Default number of rows per slice in the sliced ELL (SELL-C) layout.
+// Four doubles fill one AVX register, two SSE registers.
+#ifndef SELL_SLICE_HEIGHT
+#define SELL_SLICE_HEIGHT 4
+#endif
+
+// Offset of the j-th stored nonzero of a piece-local row.  With a slice
+// height of 1 this is plain row-major ELL.  Otherwise rows are grouped into
+// slices of 'slice_height' rows stored column-major (SELL-C), so that the
+// j-th entries of consecutive rows are contiguous and can be loaded as one
+// vector.  A partial slice at the end of a piece is packed to its real height.
+static inline int64_t ell_offset(int64_t row, int j, int64_t piece_rows,
+                                 int64_t max_nzeros, int slice_height)
+{
+  if (slice_height <= 1)
+    return (row * max_nzeros + j);
+  const int64_t first = (row / slice_height) * slice_height;
+  const int64_t height = std::min<int64_t>(slice_height, piece_rows - first);
+  return (first * max_nzeros + j * height + (row - first));
+}
+
 enum SPTaskIDs{
 	SP_INIT_TASK_ID = 2,
 };
@@ -123,6 +145,7 @@ class SpMatrix{
 	int64_t ncols;
 	int64_t nonzeros;
 	int64_t max_nzeros;
+	int slice_height;
 	FieldID row_fid;
 	FieldID val_fid;
 	FieldID col_fid;
@@ -141,13 +164,15 @@ class SpMatrix{
  	LogicalPartition elem_lp;
 
 	SpMatrix(void);
-	SpMatrix(int64_t n, int64_t nparts, int64_t nonzeros, int64_t max_nzeros, Context ctx, HighLevelRuntime *runtime);
+	SpMatrix(int64_t n, int64_t nparts, int64_t nonzeros, int64_t max_nzeros, Context ctx, HighLevelRuntime *runtime,
+		 int slice_height = SELL_SLICE_HEIGHT);
 	void DestroySpMatrix(Context ctx, HighLevelRuntime *runtime);
 	void BuildMatrix(double *vals, int *col_ind, int *nzeros_per_row, 
 			         Context ctx, HighLevelRuntime *runtime);
 };
 
-SpMatrix::SpMatrix(int64_t n, int64_t nparts, int64_t nonzeros, int64_t max_nzeros, Context ctx, HighLevelRuntime *runtime){
+SpMatrix::SpMatrix(int64_t n, int64_t nparts, int64_t nonzeros, int64_t max_nzeros, Context ctx, HighLevelRuntime *runtime,
+		   int slice_height){
 
 	this-> row_fid = FID_NZEROS_PER_ROW;	
 	this-> val_fid = FID_Vals;
@@ -157,6 +182,7 @@ SpMatrix::SpMatrix(int64_t n, int64_t nparts, int64_t nonzeros, int64_t max_nzer
 	this-> nonzeros = nonzeros;
 	this-> max_nzeros = max_nzeros;
 	this-> nparts = nparts;
+	this-> slice_height = slice_height;
 	
 	// build logical region for row_ptr
 	row_rect = Rect<1>(Point<1>(0), Point<1>(nrows-1));
@@ -280,30 +306,35 @@ void SpMatrix::BuildMatrix(double *vals, int *col_ind, int *nzeros_per_row,
           }
         }
 
-        // nonzero values and column index
+        // nonzero values and column index, stored per piece in the
+        // (possibly sliced) ELL layout with explicit zero padding so that
+        // the vector kernels can run over whole slices without masking
+        const int64_t local_num_rows = (nrows + nparts - 1) / nparts;
         int64_t *col_ind_ptr = acc_col.raw_rect_ptr<1>(elem_rect, subrect, offsets);
         Rect<1> subrect2;
         ByteOffset offsets2[1];
         double *val_ptr = acc_vals.raw_rect_ptr<1>(elem_rect, subrect2, offsets2);
-        if (!col_ind_ptr || !val_ptr || (subrect != elem_rect) || 
-            (subrect2 != elem_rect) ||
-            !offsets_are_dense<1,int64_t>(elem_rect, offsets) ||
-            !offsets_are_dense<1,double>(elem_rect, offsets2))
-        {
-                GenericPointInRectIterator<1> itr(elem_rect);
-
-                for(int i=0; i<nrows * max_nzeros; i++){
-
-                        acc_col.write(DomainPoint::from_point<1>(itr.p), col_ind[i]);
-                        acc_vals.write(DomainPoint::from_point<1>(itr.p), vals[i]);
-                        itr++;
-                }
-        }
-        else
-        {
-          for (int i = 0; i < (nrows * max_nzeros); i++) {
-            col_ind_ptr[i] = col_ind[i];
-            val_ptr[i] = vals[i];
+        const bool dense = (col_ind_ptr && val_ptr && (subrect == elem_rect) && 
+                            (subrect2 == elem_rect) &&
+                            offsets_are_dense<1,int64_t>(elem_rect, offsets) &&
+                            offsets_are_dense<1,double>(elem_rect, offsets2));
+        for (int64_t i = 0; i < nrows; i++) {
+          const int64_t piece = i / local_num_rows;
+          const int64_t piece_first = piece * local_num_rows;
+          const int64_t piece_rows = std::min(local_num_rows, nrows - piece_first);
+          for (int j = 0; j < max_nzeros; j++) {
+            const int64_t dst = piece_first * max_nzeros +
+              ell_offset(i - piece_first, j, piece_rows, max_nzeros, slice_height);
+            const bool pad = (j >= nzeros_per_row[i]);
+            const int64_t col = pad ? 0 : col_ind[i*max_nzeros+j];
+            const double val = pad ? 0.0 : vals[i*max_nzeros+j];
+            if (dense) {
+              col_ind_ptr[dst] = col;
+              val_ptr[dst] = val;
+            } else {
+              acc_col.write(DomainPoint::from_point<1>(Point<1>(dst)), col);
+              acc_vals.write(DomainPoint::from_point<1>(Point<1>(dst)), val);
+            }
           }
         }
 
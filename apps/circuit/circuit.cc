@@ -25,6 +25,7 @@
 #include "circuit.h"
 #include "circuit_mapper.h"
 #include "legion.h"
+#include "realm/timers.h"
 
 using namespace LegionRuntime::HighLevel;
 using namespace LegionRuntime::Accessor;
@@ -35,18 +36,25 @@ LegionRuntime::Logger::Category log_circuit("circuit");
 void parse_input_args(char **argv, int argc, int &num_loops, int &num_pieces,
                       int &nodes_per_piece, int &wires_per_piece,
                       int &pct_wire_in_piece, int &random_seed,
-		      int &num_steps, int &sync);
+		      int &num_steps, int &sync, bool &generic_kernels,
+                      bool &compare_kernels);
 
 Partitions load_circuit(Circuit &ckt, std::vector<CircuitPiece> &pieces, Context ctx,
                         HighLevelRuntime *runtime, int num_pieces, int nodes_per_piece,
                         int wires_per_piece, int pct_wire_in_piece, int random_seed,
 			int steps);
 
-void registration_func(Machine *machine, HighLevelRuntime *runtime, const std::set<Processor> &local_procs);
+void registration_func(Machine machine, HighLevelRuntime *runtime, const std::set<Processor> &local_procs);
 
 template<typename T>
 FieldID allocate_field(Context ctx, HighLevelRuntime *runtime, FieldSpace space);
 
+void run_kernel_comparison(Context ctx, HighLevelRuntime *runtime, const Domain &task_space,
+                           const std::vector<RegionRequirement> &cnc_regions,
+                           const std::vector<RegionRequirement> &dsc_regions,
+                           const std::vector<RegionRequirement> &upv_regions,
+                           std::vector<CircuitPiece> &pieces, int num_loops);
+
 // Top level task
 
 void region_main(const void *args, size_t arglen,
@@ -62,6 +70,8 @@ void region_main(const void *args, size_t arglen,
   int random_seed = 12345;
   int steps = STEPS;
   int sync = 0;
+  bool generic_kernels = false;
+  bool compare_kernels = false;
   {
     InputArgs *inputs = (InputArgs*)args;
     char **argv = inputs->argv;
@@ -69,7 +79,7 @@ void region_main(const void *args, size_t arglen,
 
     parse_input_args(argv, argc, num_loops, num_pieces, nodes_per_piece, 
 		     wires_per_piece, pct_wire_in_piece, random_seed,
-		     steps, sync);
+		     steps, sync, generic_kernels, compare_kernels);
 
     log_circuit.print("circuit settings: loops=%d pieces=%d nodes/piece=%d wires/piece=%d pct_in_piece=%d seed=%d",
        num_loops, num_pieces, nodes_per_piece, wires_per_piece,
@@ -101,9 +111,11 @@ void region_main(const void *args, size_t arglen,
   std::vector<CircuitPiece> pieces(num_pieces);
   Partitions parts = load_circuit(circuit, pieces, ctx, runtime, num_pieces, nodes_per_piece,
                                   wires_per_piece, pct_wire_in_piece, random_seed, steps);
+  for (int n = 0; n < num_pieces; n++)
+    pieces[n].generic_kernels = generic_kernels;
 
   // Start the simulation
-  LegionRuntime::LowLevel::DetailedTimer::clear_timers();
+  Realm::DetailedTimer::clear_timers();
   printf("Starting main simulation loop\n");
   struct timespec ts_start, ts_end;
   clock_gettime(CLOCK_MONOTONIC, &ts_start);
@@ -207,9 +219,14 @@ void region_main(const void *args, size_t arglen,
 
     // Compute the number of gflops
     double gflops = (1e-9*operations)/sim_time;
-    printf("GFLOPS = %7.3f GFLOPS\n", gflops);
+    printf("GFLOPS = %7.3f GFLOPS (%s CPU kernels)\n", gflops,
+           (generic_kernels ? "generic" : "dense"));
   }
-  LegionRuntime::LowLevel::DetailedTimer::report_timers();
+  Realm::DetailedTimer::report_timers();
+
+  if (compare_kernels)
+    run_kernel_comparison(ctx, runtime, task_space, cnc_regions, dsc_regions,
+                          upv_regions, pieces, num_loops);
 
   log_circuit.print("simulation complete - destroying regions");
 
@@ -226,89 +243,171 @@ void region_main(const void *args, size_t arglen,
   }
 }
 
-// CPU wrappers
+// Times num_loops launches of one kernel across all the pieces and returns
+// the summed time the tasks report for the kernel itself, so the runtime's
+// own overheads are left out
+static double time_kernel(Context ctx, HighLevelRuntime *runtime, TaskID task_id,
+                          const Domain &task_space,
+                          const std::vector<RegionRequirement> &regions,
+                          std::vector<CircuitPiece> &pieces, int num_loops)
+{
+  TaskArgument global_arg;
+  std::vector<IndexSpaceRequirement> index_space_reqs;
+  std::vector<FieldSpaceRequirement> field_space_reqs;
+  ArgumentMap local_args = runtime->create_argument_map(ctx);
+  for (unsigned idx = 0; idx < pieces.size(); idx++)
+  {
+    DomainPoint point = DomainPoint::from_point<1>(Point<1>(idx));
+    local_args.set_point(point, TaskArgument(&(pieces[idx]),sizeof(CircuitPiece)));
+  }
+
+  double kernel_time = 0.0;
+  for (int i = 0; i < num_loops; i++)
+  {
+    FutureMap fm = runtime->execute_index_space(ctx, task_id, task_space,
+                                  index_space_reqs, field_space_reqs, regions,
+                                  global_arg, local_args);
+    for (unsigned idx = 0; idx < pieces.size(); idx++)
+      kernel_time += fm.get_result<double>(DomainPoint::from_point<1>(Point<1>(idx)));
+  }
+  return kernel_time;
+}
+
+// Compares the generic (accessor per element) and dense CPU kernels, one
+// kernel at a time.  Rates are per core: flops over the summed kernel time
+// of all the pieces.
+void run_kernel_comparison(Context ctx, HighLevelRuntime *runtime, const Domain &task_space,
+                           const std::vector<RegionRequirement> &cnc_regions,
+                           const std::vector<RegionRequirement> &dsc_regions,
+                           const std::vector<RegionRequirement> &upv_regions,
+                           std::vector<CircuitPiece> &pieces, int num_loops)
+{
+  const char *names[3] = { "calc_new_currents", "distribute_charge", "update_voltages" };
+  const TaskID task_ids[3] = { CALC_NEW_CURRENTS, DISTRIBUTE_CHARGE, UPDATE_VOLTAGES };
+  const std::vector<RegionRequirement> *regions[3] = { &cnc_regions, &dsc_regions, &upv_regions };
+  double flops[3] = { 0.0, 0.0, 0.0 };
+  for (unsigned n = 0; n < pieces.size(); n++)
+  {
+    flops[0] += (double)pieces[n].num_wires * (WIRE_SEGMENTS*6 + (WIRE_SEGMENTS-1)*4) * pieces[n].steps;
+    flops[1] += (double)pieces[n].num_wires * 4;
+    flops[2] += (double)pieces[n].num_nodes * 4;
+  }
+
+  double seconds[2][3];
+  for (int dense = 0; dense < 2; dense++)
+  {
+    for (unsigned n = 0; n < pieces.size(); n++)
+      pieces[n].generic_kernels = !dense;
+    for (int k = 0; k < 3; k++)
+      seconds[dense][k] = time_kernel(ctx, runtime, task_ids[k], task_space,
+                                      *regions[k], pieces, num_loops);
+  }
+
+  printf("%-18s %16s %16s %8s\n", "kernel", "generic GFLOP/s", "dense GFLOP/s", "speedup");
+  for (int k = 0; k < 3; k++)
+  {
+    double generic_rate = (1e-9 * flops[k] * num_loops) / seconds[0][k];
+    double dense_rate = (1e-9 * flops[k] * num_loops) / seconds[1][k];
+    printf("%-18s %16.3f %16.3f %7.2fx\n", names[k], generic_rate, dense_rate,
+           dense_rate / generic_rate);
+  }
+}
+
+// CPU wrappers (each returns the time spent in its kernel, for -kernels)
 
-void calculate_currents_task_cpu(const void *global_args, size_t global_arglen,
-                                 const void *local_args, size_t local_arglen,
-                                 const DomainPoint &point, 
-                                 const std::vector<RegionRequirement> &logical_regions,
-                                 const std::vector<PhysicalRegion> &physical_regions,
-                                 Context ctx, HighLevelRuntime *runtime)
+double calculate_currents_task_cpu(const void *global_args, size_t global_arglen,
+                                   const void *local_args, size_t local_arglen,
+                                   const DomainPoint &point, 
+                                   const std::vector<RegionRequirement> &logical_regions,
+                                   const std::vector<PhysicalRegion> &physical_regions,
+                                   Context ctx, HighLevelRuntime *runtime)
 {
   log_circuit.print("CPU calculate currents for point %d",point.point_data[0]);
   CircuitPiece *p = (CircuitPiece*)local_args;
-  calc_new_currents_cpu(p, physical_regions);
+  long long start = Realm::Clock::current_time_in_nanoseconds();
+  calc_new_currents_cpu(p, physical_regions, ctx, runtime);
+  return 1e-9 * (Realm::Clock::current_time_in_nanoseconds() - start);
 }
 
-void distribute_charge_task_cpu(const void *global_args, size_t global_arglen,
-                                const void *local_args, size_t local_arglen,
-                                const DomainPoint &point,
-                                const std::vector<RegionRequirement> &logical_regions,
-                                const std::vector<PhysicalRegion> &physical_regions,
-                                Context ctx, HighLevelRuntime *runtime)
+double distribute_charge_task_cpu(const void *global_args, size_t global_arglen,
+                                  const void *local_args, size_t local_arglen,
+                                  const DomainPoint &point,
+                                  const std::vector<RegionRequirement> &logical_regions,
+                                  const std::vector<PhysicalRegion> &physical_regions,
+                                  Context ctx, HighLevelRuntime *runtime)
 {
   log_circuit.print("CPU distribute charge for point %d",point.point_data[0]);
   CircuitPiece *p = (CircuitPiece*)local_args;
-  distribute_charge_cpu(p, physical_regions);
+  long long start = Realm::Clock::current_time_in_nanoseconds();
+  distribute_charge_cpu(p, physical_regions, ctx, runtime);
+  return 1e-9 * (Realm::Clock::current_time_in_nanoseconds() - start);
 }
 
-void update_voltages_task_cpu(const void *global_args, size_t global_arglen,
-                              const void *local_args, size_t local_arglen,
-                              const DomainPoint &point,
-                              const std::vector<RegionRequirement> &logical_regions,
-                              const std::vector<PhysicalRegion> &physical_regions,
-                              Context ctx, HighLevelRuntime *runtime)
+double update_voltages_task_cpu(const void *global_args, size_t global_arglen,
+                                const void *local_args, size_t local_arglen,
+                                const DomainPoint &point,
+                                const std::vector<RegionRequirement> &logical_regions,
+                                const std::vector<PhysicalRegion> &physical_regions,
+                                Context ctx, HighLevelRuntime *runtime)
 {
   log_circuit.print("CPU update voltages for point %d",point.point_data[0]);
   CircuitPiece *p = (CircuitPiece*)local_args;
-  update_voltages_cpu(p, physical_regions);
+  long long start = Realm::Clock::current_time_in_nanoseconds();
+  update_voltages_cpu(p, physical_regions, ctx, runtime);
+  return 1e-9 * (Realm::Clock::current_time_in_nanoseconds() - start);
 }
 
 // GPU wrappers
-#ifndef SHARED_LOWLEVEL
-void calculate_currents_task_gpu(const void *global_args, size_t global_arglen,
-                                 const void *local_args, size_t local_arglen,
-                                 const DomainPoint &point,
-                                 const std::vector<RegionRequirement> &logical_regions,
-                                 const std::vector<PhysicalRegion> &physical_regions,
-                                 Context ctx, HighLevelRuntime *runtime)
+#ifdef USE_CUDA
+double calculate_currents_task_gpu(const void *global_args, size_t global_arglen,
+                                   const void *local_args, size_t local_arglen,
+                                   const DomainPoint &point,
+                                   const std::vector<RegionRequirement> &logical_regions,
+                                   const std::vector<PhysicalRegion> &physical_regions,
+                                   Context ctx, HighLevelRuntime *runtime)
 {
   log_circuit.print("GPU calculate currents for point %d on proc %x",
 	      point.point_data[0], runtime->get_executing_processor(ctx).id);
   CircuitPiece *p = (CircuitPiece*)local_args;
+  long long start = Realm::Clock::current_time_in_nanoseconds();
   // Call the __host__ function in circuit_gpu.cc that launches the kernel
   calc_new_currents_gpu(p, physical_regions);
+  return 1e-9 * (Realm::Clock::current_time_in_nanoseconds() - start);
 }
 
-void distribute_charge_task_gpu(const void *global_args, size_t global_arglen,
-                                const void *local_args, size_t local_arglen,
-                                const DomainPoint &point,
-                                const std::vector<RegionRequirement> &logical_regions,
-                                const std::vector<PhysicalRegion> &physical_regions,
-                                Context ctx, HighLevelRuntime *runtime)
+double distribute_charge_task_gpu(const void *global_args, size_t global_arglen,
+                                  const void *local_args, size_t local_arglen,
+                                  const DomainPoint &point,
+                                  const std::vector<RegionRequirement> &logical_regions,
+                                  const std::vector<PhysicalRegion> &physical_regions,
+                                  Context ctx, HighLevelRuntime *runtime)
 {
   log_circuit.print("GPU distribute charge for point %d on proc %x",
 	      point.point_data[0], runtime->get_executing_processor(ctx).id);
   CircuitPiece *p = (CircuitPiece*)local_args;
+  long long start = Realm::Clock::current_time_in_nanoseconds();
   distribute_charge_gpu(p, physical_regions);
+  return 1e-9 * (Realm::Clock::current_time_in_nanoseconds() - start);
 }
 
-void update_voltages_task_gpu(const void *global_args, size_t global_arglen,
-                              const void *local_args, size_t local_arglen,
-                              const DomainPoint &point,
-                              const std::vector<RegionRequirement> &logical_regions,
-                              const std::vector<PhysicalRegion> &physical_regions,
-                              Context ctx, HighLevelRuntime *runtime)
+double update_voltages_task_gpu(const void *global_args, size_t global_arglen,
+                                const void *local_args, size_t local_arglen,
+                                const DomainPoint &point,
+                                const std::vector<RegionRequirement> &logical_regions,
+                                const std::vector<PhysicalRegion> &physical_regions,
+                                Context ctx, HighLevelRuntime *runtime)
 {
   log_circuit.print("GPU update voltages for point %d on proc %x",
 	      point.point_data[0], runtime->get_executing_processor(ctx).id);
   CircuitPiece *p = (CircuitPiece*)local_args;
+  long long start = Realm::Clock::current_time_in_nanoseconds();
   update_voltages_gpu(p, physical_regions);
+  return 1e-9 * (Realm::Clock::current_time_in_nanoseconds() - start);
 }
 #endif
 
 // Call back function for running on the GPUs
-void mapper_callback_function(Machine *machine, HighLevelRuntime *rt, const std::set<Processor> &local_procs)
+void mapper_callback_function(Machine machine, HighLevelRuntime *rt, const std::set<Processor> &local_procs)
 {
   for (std::set<Processor>::const_iterator it = local_procs.begin();
         it != local_procs.end(); it++)
@@ -326,19 +425,19 @@ int main(int argc, char **argv)
   // CPU variants
   HighLevelRuntime::register_single_task<region_main>
           (REGION_MAIN, Processor::LOC_PROC, false/*leaf*/, "region_main");
-  HighLevelRuntime::register_index_task<calculate_currents_task_cpu>
+  HighLevelRuntime::register_index_task<double, calculate_currents_task_cpu>
           (CALC_NEW_CURRENTS, Processor::LOC_PROC, true/*leaf*/, "calc_new_currents");
-  HighLevelRuntime::register_index_task<distribute_charge_task_cpu>
+  HighLevelRuntime::register_index_task<double, distribute_charge_task_cpu>
           (DISTRIBUTE_CHARGE, Processor::LOC_PROC, true/*leaf*/, "distribute_charge");
-  HighLevelRuntime::register_index_task<update_voltages_task_cpu>
+  HighLevelRuntime::register_index_task<double, update_voltages_task_cpu>
           (UPDATE_VOLTAGES, Processor::LOC_PROC, true/*leaf*/, "update_voltages");
-#ifndef SHARED_LOWLEVEL
+#ifdef USE_CUDA
   // GPU variants
-  HighLevelRuntime::register_index_task<calculate_currents_task_gpu>
+  HighLevelRuntime::register_index_task<double, calculate_currents_task_gpu>
           (CALC_NEW_CURRENTS, Processor::TOC_PROC, true/*leaf*/, "calc_new_currents");
-  HighLevelRuntime::register_index_task<distribute_charge_task_gpu>
+  HighLevelRuntime::register_index_task<double, distribute_charge_task_gpu>
           (DISTRIBUTE_CHARGE, Processor::TOC_PROC, true/*leaf*/, "distribute_charge");
-  HighLevelRuntime::register_index_task<update_voltages_task_gpu>
+  HighLevelRuntime::register_index_task<double, update_voltages_task_gpu>
           (UPDATE_VOLTAGES, Processor::TOC_PROC, true/*leaf*/, "update_voltages");
 
   // Register the callback function for using the custom CircuitMapper
@@ -353,7 +452,7 @@ int main(int argc, char **argv)
 
 // Utility function implementations
 
-void registration_func(Machine *machine, HighLevelRuntime *runtime, const std::set<Processor> &local_procs)
+void registration_func(Machine machine, HighLevelRuntime *runtime, const std::set<Processor> &local_procs)
 {
 
 }
@@ -361,7 +460,8 @@ void registration_func(Machine *machine, HighLevelRuntime *runtime, const std::s
 void parse_input_args(char **argv, int argc, int &num_loops, int &num_pieces,
                       int &nodes_per_piece, int &wires_per_piece,
                       int &pct_wire_in_piece, int &random_seed,
-		      int &steps, int &sync)
+		      int &steps, int &sync, bool &generic_kernels,
+                      bool &compare_kernels)
 {
   for (int i = 1; i < argc; i++) 
   {
@@ -412,6 +512,21 @@ void parse_input_args(char **argv, int argc, int &num_loops, int &num_pieces,
       sync = atoi(argv[++i]);
       continue;
     }
+
+    // use the generic accessor CPU kernels, for comparison
+    if(!strcmp(argv[i], "-generic")) 
+    {
+      generic_kernels = true;
+      continue;
+    }
+
+    // after the simulation, time each kernel on its own with the generic
+    // and then the dense CPU kernels
+    if(!strcmp(argv[i], "-kernels")) 
+    {
+      compare_kernels = true;
+      continue;
+    }
   }
 }
 
@@ -499,7 +614,7 @@ Partitions load_circuit(Circuit &ckt, std::vector<CircuitPiece> &pieces, Context
     node_allocator.alloc(num_pieces * nodes_per_piece);
   }
   {
-    IndexIterator itr(ckt.all_nodes.get_index_space());
+    IndexIterator itr(runtime, ctx, ckt.all_nodes.get_index_space());
     for (int n = 0; n < num_pieces; n++)
     {
       for (int i = 0; i < nodes_per_piece; i++)
@@ -536,7 +651,7 @@ Partitions load_circuit(Circuit &ckt, std::vector<CircuitPiece> &pieces, Context
     wire_allocator.alloc(num_pieces * wires_per_piece);
   }
   {
-    IndexIterator itr(ckt.all_wires.get_index_space());
+    IndexIterator itr(runtime, ctx, ckt.all_wires.get_index_space());
     for (int n = 0; n < num_pieces; n++)
     {
       for (int i = 0; i < wires_per_piece; i++)
@@ -589,7 +704,7 @@ Partitions load_circuit(Circuit &ckt, std::vector<CircuitPiece> &pieces, Context
 
   // Second pass: make some random fraction of the private nodes shared
   {
-    IndexIterator itr(ckt.all_nodes.get_index_space()); 
+    IndexIterator itr(runtime, ctx, ckt.all_nodes.get_index_space()); 
     for (int n = 0; n < num_pieces; n++)
     {
       for (int i = 0; i < nodes_per_piece; i++)
@@ -612,7 +727,7 @@ Partitions load_circuit(Circuit &ckt, std::vector<CircuitPiece> &pieces, Context
   }
   // Second pass (part 2): go through the wires and update the locations
   {
-    IndexIterator itr(ckt.all_wires.get_index_space());
+    IndexIterator itr(runtime, ctx, ckt.all_wires.get_index_space());
     for (int n = 0; n < num_pieces; n++)
     {
       for (int i = 0; i < wires_per_piece; i++)
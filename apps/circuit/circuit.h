@@ -86,6 +86,7 @@ struct CircuitPiece {
   ptr_t first_node;
   float dt;
   int steps;
+  bool generic_kernels; // don't use the dense CPU kernels
 };
 
 struct Partitions {
@@ -109,13 +110,16 @@ public:
 // CPU function variants
 
 void calc_new_currents_cpu(CircuitPiece *p,
-                           const std::vector<PhysicalRegion> &physical_regions);
+                           const std::vector<PhysicalRegion> &physical_regions,
+                           Context ctx, HighLevelRuntime *runtime);
 
 void distribute_charge_cpu(CircuitPiece *p,
-                           const std::vector<PhysicalRegion> &physical_regions);
+                           const std::vector<PhysicalRegion> &physical_regions,
+                           Context ctx, HighLevelRuntime *runtime);
 
 void update_voltages_cpu(CircuitPiece *p,
-                         const std::vector<PhysicalRegion> &physical_regions);
+                         const std::vector<PhysicalRegion> &physical_regions,
+                         Context ctx, HighLevelRuntime *runtime);
 
 // Functions for linking against CUDA
 
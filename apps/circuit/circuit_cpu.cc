@@ -14,6 +14,8 @@
  */
 
 
+#include <algorithm>
+
 #include "circuit.h"
 
 using namespace LegionRuntime::Accessor;
@@ -121,17 +123,174 @@ static inline void update_region_voltages(CircuitPiece *p,
   }
 }
 
+// Dense kernels
+
+// When an instance is a plain array of the region's element type (the usual
+// layout for these single-field regions), the kernels below index it
+// directly instead of going through a generic accessor for every element.
+// Returns the address of element 0, or NULL for any other layout.
+template<typename T>
+static inline T *get_dense_base(const RegionAccessor<AccessorType::Generic,T> &acc)
+{
+  if (!acc.template can_convert<AccessorType::SOA<sizeof(T)> >())
+    return NULL;
+  RegionAccessor<AccessorType::SOA<sizeof(T)>,T> soa =
+    acc.template convert<AccessorType::SOA<sizeof(T)> >();
+  return soa.ptr(ptr_t(0));
+}
+
+// The dense kernels find a wire's nodes through a table of the three node
+// instances indexed by PointerLocation, so resolving a node costs one load
+// rather than a switch on the location for every access.
+static inline void get_dense_nodes(CircuitNode *node_bases[3], CircuitNode *priv,
+                                   CircuitNode *shr, CircuitNode *ghost)
+{
+  node_bases[PRIVATE_PTR] = priv;
+  node_bases[SHARED_PTR] = shr;
+  node_bases[GHOST_PTR] = ghost;
+}
+
+// Wires are solved in blocks of WIRE_BLOCK, with each block's state
+// transposed so that the innermost loops run across the wires of the
+// block and can be vectorized. A block's state fits comfortably in L1.
+#define WIRE_BLOCK 8
+
+static void calc_new_currents_dense(CircuitPiece *p, CircuitWire *wires,
+                                    CircuitNode *pvt, CircuitNode *shr,
+                                    CircuitNode *ghost)
+{
+  const float dt = p->dt;
+  const float recip_dt = 1.f/dt;
+  const int steps = p->steps;
+  CircuitWire *first = wires + p->first_wire.value;
+  CircuitNode *node_bases[3];
+  get_dense_nodes(node_bases, pvt, shr, ghost);
+
+  for (unsigned w = 0; w < p->num_wires; w += WIRE_BLOCK)
+  {
+    const unsigned count = std::min<unsigned>(WIRE_BLOCK, p->num_wires - w);
+    float inductance[WIRE_BLOCK];
+    float recip_resistance[WIRE_BLOCK];
+    float recip_capacitance[WIRE_BLOCK];
+    float old_i[WIRE_SEGMENTS][WIRE_BLOCK];
+    float old_v[WIRE_SEGMENTS-1][WIRE_BLOCK];
+    float new_i[WIRE_SEGMENTS][WIRE_BLOCK];
+    float new_v[WIRE_SEGMENTS+1][WIRE_BLOCK];
+
+    // a partial block repeats its last wire in the unused lanes
+    for (unsigned k = 0; k < WIRE_BLOCK; k++)
+    {
+      const CircuitWire &wire = first[w + std::min(k, count-1)];
+      inductance[k] = wire.inductance;
+      recip_resistance[k] = 1.f/wire.resistance;
+      recip_capacitance[k] = 1.f/wire.capacitance;
+      for (int i = 0; i < WIRE_SEGMENTS; i++)
+        old_i[i][k] = new_i[i][k] = wire.current[i];
+      for (int i = 0; i < WIRE_SEGMENTS-1; i++)
+        old_v[i][k] = new_v[i+1][k] = wire.voltage[i];
+      new_v[0][k] = node_bases[wire.in_loc][wire.in_ptr.value].voltage;
+      new_v[WIRE_SEGMENTS][k] = node_bases[wire.out_loc][wire.out_ptr.value].voltage;
+    }
+
+    for (int j = 0; j < steps; j++)
+    {
+      // dV = R*I + L*I' ==> I = (dV - L*I')/R
+      for (int i = 0; i < WIRE_SEGMENTS; i++)
+        for (unsigned k = 0; k < WIRE_BLOCK; k++)
+          new_i[i][k] = ((new_v[i][k] - new_v[i+1][k]) -
+                         (inductance[k]*(new_i[i][k] - old_i[i][k]) * recip_dt)) *
+                        recip_resistance[k];
+      // Now update the inter-node voltages
+      for (int i = 0; i < WIRE_SEGMENTS-1; i++)
+        for (unsigned k = 0; k < WIRE_BLOCK; k++)
+          new_v[i+1][k] = old_v[i][k] +
+                          dt*(new_i[i][k] - new_i[i+1][k]) * recip_capacitance[k];
+    }
+
+    // Copy everything back
+    for (unsigned k = 0; k < count; k++)
+    {
+      CircuitWire &wire = first[w + k];
+      for (int i = 0; i < WIRE_SEGMENTS; i++)
+        wire.current[i] = new_i[i][k];
+      for (int i = 0; i < WIRE_SEGMENTS-1; i++)
+        wire.voltage[i] = new_v[i+1][k];
+    }
+  }
+}
+
+// private nodes belong to this task alone, so need no atomics; shared and
+// ghost nodes are found through a table of their fold accessors, like the
+// node instances in calc_new_currents_dense
+template<typename AT>
+static inline void reduce_dense_node(CircuitNode *priv,
+                                     const RegionAccessor<AT,CircuitNode> *const folds[3],
+                                     PointerLocation loc, ptr_t ptr, float value)
+{
+  if (loc == PRIVATE_PTR)
+    AccumulateCharge::apply<true>(priv[ptr.value], value);
+  else
+    folds[loc]->reduce(ptr, value);
+}
+
+template<typename AT>
+static void distribute_charge_dense(CircuitPiece *p, const CircuitWire *wires,
+                                    CircuitNode *pvt,
+                                    const RegionAccessor<AT,CircuitNode> &shr,
+                                    const RegionAccessor<AT,CircuitNode> &ghost)
+{
+  const float dt = p->dt;
+  const CircuitWire *first = wires + p->first_wire.value;
+  const RegionAccessor<AT,CircuitNode> *const folds[3] = { NULL, &shr, &ghost };
+  for (unsigned w = 0; w < p->num_wires; w++)
+  {
+    const CircuitWire &wire = first[w];
+    reduce_dense_node(pvt, folds, wire.in_loc, wire.in_ptr, -dt * wire.current[0]);
+    reduce_dense_node(pvt, folds, wire.out_loc, wire.out_ptr, dt * wire.current[WIRE_SEGMENTS-1]);
+  }
+}
+
+static void update_voltages_dense(CircuitNode *nodes, IndexIterator &itr)
+{
+  while (itr.has_next())
+  {
+    size_t count = 0;
+    CircuitNode *span = nodes + itr.next_span(count).value;
+    for (size_t i = 0; i < count; i++)
+    {
+      CircuitNode &node = span[i];
+      // charge adds in, and then some leaks away
+      node.voltage += node.charge / node.capacitance;
+      node.voltage *= (1.f - node.leakage);
+      node.charge = 0.f;
+    }
+  }
+}
+
 // Actual implementations
 
 void calc_new_currents_cpu(CircuitPiece *p,
-                           const std::vector<PhysicalRegion> &regions)
+                           const std::vector<PhysicalRegion> &regions,
+                           Context ctx, HighLevelRuntime *runtime)
 {
 #ifndef DISABLE_MATH
   RegionAccessor<AccessorType::Generic, CircuitWire> pvt_wires = regions[0].get_accessor().typeify<CircuitWire>();
   RegionAccessor<AccessorType::Generic, CircuitNode> pvt_nodes = regions[1].get_accessor().typeify<CircuitNode>();
   RegionAccessor<AccessorType::Generic, CircuitNode> shr_nodes = regions[2].get_accessor().typeify<CircuitNode>();
   RegionAccessor<AccessorType::Generic, CircuitNode> ghost_nodes = regions[3].get_accessor().typeify<CircuitNode>();
-  LegionRuntime::HighLevel::IndexIterator itr(p->pvt_wires);
+  if (!p->generic_kernels)
+  {
+    CircuitWire *wires = get_dense_base(pvt_wires);
+    CircuitNode *pvt = get_dense_base(pvt_nodes);
+    CircuitNode *shr = get_dense_base(shr_nodes);
+    CircuitNode *ghost = get_dense_base(ghost_nodes);
+    if (wires && pvt && shr && ghost)
+    {
+      calc_new_currents_dense(p, wires, pvt, shr, ghost);
+      return;
+    }
+  }
+  LegionRuntime::HighLevel::IndexIterator itr(runtime, ctx, p->pvt_wires);
   while (itr.has_next())
   {
     ptr_t wire_ptr = itr.next();
@@ -147,7 +306,8 @@ void calc_new_currents_cpu(CircuitPiece *p,
     for (int i = 0; i < WIRE_SEGMENTS; i++)
       new_i[i] = wire.current[i];
     for (int i = 0; i < WIRE_SEGMENTS-1; i++)
-      new_v[i] = wire.voltage[i];
+      new_v[i+1] = wire.voltage[i];
+    new_v[0] = in_node.voltage;
     new_v[WIRE_SEGMENTS] = out_node.voltage;
 
     for (int j = 0; j < steps; j++)
@@ -157,7 +317,7 @@ void calc_new_currents_cpu(CircuitPiece *p,
       // dV = R*I + L*I' ==> I = (dV - L*I')/R
       for (int i = 0; i < WIRE_SEGMENTS; i++)
       {
-        new_i[i] = ((new_v[i+1] - new_v[i]) - 
+        new_i[i] = ((new_v[i] - new_v[i+1]) - 
                     (wire.inductance*(new_i[i] - wire.current[i])/dt)) / wire.resistance;
       }
       // Now update the inter-node voltages
@@ -179,7 +339,8 @@ void calc_new_currents_cpu(CircuitPiece *p,
 }
 
 void distribute_charge_cpu(CircuitPiece *p,
-                           const std::vector<PhysicalRegion> &regions)
+                           const std::vector<PhysicalRegion> &regions,
+                           Context ctx, HighLevelRuntime *runtime)
 {
 #ifndef DISABLE_MATH
   RegionAccessor<AccessorType::Generic, CircuitWire> pvt_wires = regions[0].get_accessor().typeify<CircuitWire>();
@@ -194,7 +355,17 @@ void distribute_charge_cpu(CircuitPiece *p,
             shr_temp.convert<AccessorType::ReductionFold<AccumulateCharge> >();
   RegionAccessor<AccessorType::ReductionFold<AccumulateCharge>, CircuitNode> ghost_nodes = 
             ghost_temp.convert<AccessorType::ReductionFold<AccumulateCharge> >(); 
-  LegionRuntime::HighLevel::IndexIterator itr(p->pvt_wires);
+  if (!p->generic_kernels)
+  {
+    CircuitWire *wires = get_dense_base(pvt_wires);
+    CircuitNode *pvt = get_dense_base(pvt_nodes);
+    if (wires && pvt)
+    {
+      distribute_charge_dense(p, wires, pvt, shr_nodes, ghost_nodes);
+      return;
+    }
+  }
+  LegionRuntime::HighLevel::IndexIterator itr(runtime, ctx, p->pvt_wires);
   while (itr.has_next())
   {
     ptr_t wire_ptr = itr.next();
@@ -209,15 +380,24 @@ void distribute_charge_cpu(CircuitPiece *p,
 }
 
 void update_voltages_cpu(CircuitPiece *p,
-                         const std::vector<PhysicalRegion> &regions)
+                         const std::vector<PhysicalRegion> &regions,
+                         Context ctx, HighLevelRuntime *runtime)
 {
-#ifndef DISABLE_MATh
+#ifndef DISABLE_MATH
   RegionAccessor<AccessorType::Generic, CircuitNode> pvt_nodes = regions[0].get_accessor().typeify<CircuitNode>();
-  IndexIterator pvt_itr(p->pvt_nodes);
-  update_region_voltages(p, pvt_nodes, pvt_itr);
+  IndexIterator pvt_itr(runtime, ctx, p->pvt_nodes);
+  CircuitNode *pvt = (p->generic_kernels ? NULL : get_dense_base(pvt_nodes));
+  if (pvt)
+    update_voltages_dense(pvt, pvt_itr);
+  else
+    update_region_voltages(p, pvt_nodes, pvt_itr);
   RegionAccessor<AccessorType::Generic, CircuitNode> shr_nodes = regions[1].get_accessor().typeify<CircuitNode>();
-  IndexIterator shr_itr(p->shr_nodes);
-  update_region_voltages(p, shr_nodes, shr_itr);
+  IndexIterator shr_itr(runtime, ctx, p->shr_nodes);
+  CircuitNode *shr = (p->generic_kernels ? NULL : get_dense_base(shr_nodes));
+  if (shr)
+    update_voltages_dense(shr, shr_itr);
+  else
+    update_region_voltages(p, shr_nodes, shr_itr);
 #endif
 }
 
@@ -25,15 +25,16 @@ using namespace LegionRuntime::HighLevel;
 
 LegionRuntime::Logger::Category log_mapper("circuit_mapper");
 
-CircuitMapper::CircuitMapper(Machine *m, HighLevelRuntime *rt, Processor local)
+CircuitMapper::CircuitMapper(Machine m, HighLevelRuntime *rt, Processor local)
   : ShimMapper(m, rt, local)
 {
-  const std::set<Processor> &all_procs = m->get_all_processors();
+  std::set<Processor> all_procs;
+  m.get_all_processors(all_procs);
   // Make a list of the CPU and GPU processors
   for (std::set<Processor>::const_iterator it = all_procs.begin();
         it != all_procs.end(); it++)
   {
-    Processor::Kind kind = m->get_processor_kind(*it);
+    Processor::Kind kind = (*it).kind();
     switch(kind) {
     case Processor::LOC_PROC:
       cpu_procs.push_back(*it);
@@ -70,7 +71,7 @@ CircuitMapper::CircuitMapper(Machine *m, HighLevelRuntime *rt, Processor local)
     gasnet_mem = memory_stack[num_mem-1];
     {
       std::vector<ProcessorMemoryAffinity> result;
-      m->get_proc_mem_affinity(result, local_proc, gasnet_mem);
+      m.get_proc_mem_affinity(result, local_proc, gasnet_mem);
       assert(result.size() == 1);
       log_mapper.info("CPU %x has gasnet memory %x with "
           "bandwidth %u and latency %u",local_proc.id, gasnet_mem.id,
@@ -79,7 +80,7 @@ CircuitMapper::CircuitMapper(Machine *m, HighLevelRuntime *rt, Processor local)
     zero_copy_mem = memory_stack[num_mem-2];
     {
       std::vector<ProcessorMemoryAffinity> result;
-      m->get_proc_mem_affinity(result, local_proc, zero_copy_mem);
+      m.get_proc_mem_affinity(result, local_proc, zero_copy_mem);
       assert(result.size() == 1);
       log_mapper.info("CPU %x has zero copy memory %x with "
           "bandwidth %u and latency %u",local_proc.id, zero_copy_mem.id,
@@ -96,7 +97,7 @@ CircuitMapper::CircuitMapper(Machine *m, HighLevelRuntime *rt, Processor local)
     zero_copy_mem = memory_stack[num_mem-1];
     {
       std::vector<ProcessorMemoryAffinity> result;
-      m->get_proc_mem_affinity(result, local_proc, zero_copy_mem);
+      m.get_proc_mem_affinity(result, local_proc, zero_copy_mem);
       assert(result.size() == 1);
       log_mapper.info("GPU %x has zero copy memory %x with "
           "bandwidth %u and latency %u",local_proc.id, zero_copy_mem.id,
@@ -105,7 +106,7 @@ CircuitMapper::CircuitMapper(Machine *m, HighLevelRuntime *rt, Processor local)
     framebuffer_mem = memory_stack[num_mem-2];
     {
       std::vector<ProcessorMemoryAffinity> result;
-      m->get_proc_mem_affinity(result, local_proc, framebuffer_mem);
+      m.get_proc_mem_affinity(result, local_proc, framebuffer_mem);
       assert(result.size() == 1);
       log_mapper.info("GPU %x has frame buffer memory %x with "
           "bandwidth %u and latency %u",local_proc.id, framebuffer_mem.id,
@@ -117,7 +118,7 @@ CircuitMapper::CircuitMapper(Machine *m, HighLevelRuntime *rt, Processor local)
       // from any CPU
       assert(!cpu_procs.empty());
       std::vector<ProcessorMemoryAffinity> result;
-      m->get_proc_mem_affinity(result, (cpu_procs.front()));
+      m.get_proc_mem_affinity(result, (cpu_procs.front()));
       assert(!result.empty());
       unsigned min_idx = 0;
       unsigned min_bandwidth = result[0].bandwidth;
@@ -22,7 +22,7 @@
 
 class CircuitMapper : public ShimMapper {
 public:
-  CircuitMapper(Machine *m, HighLevelRuntime *rt, Processor local);
+  CircuitMapper(Machine m, HighLevelRuntime *rt, Processor local);
 public:
   virtual bool spawn_task(const Task *task);
   virtual Processor select_target_processor(const Task *task);
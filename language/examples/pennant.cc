@@ -18,8 +18,10 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <map>
+#include <thread>
 #include <vector>
 
 #include "default_mapper.h"
@@ -68,315 +70,80 @@ enum {
  * https://github.com/losalamos/PENNANT
  */
 
-static void generate_mesh_rect(config &conf,
-                               std::vector<double> &pointpos_x,
-                               std::vector<double> &pointpos_y,
-                               std::vector<int64_t> &pointcolors,
-                               std::map<int64_t, std::vector<int64_t> > &pointmcolors,
-                               std::vector<int64_t> &zonestart,
-                               std::vector<int64_t> &zonesize,
-                               std::vector<int64_t> &zonepoints,
-                               std::vector<int64_t> &zonecolors,
-                               std::vector<int64_t> &zxbounds,
-                               std::vector<int64_t> &zybounds)
-{
-  int64_t &nz = conf.nz;
-  int64_t &np = conf.np;
-
-  nz = conf.nzx * conf.nzy;
-  const int npx = conf.nzx + 1;
-  const int npy = conf.nzy + 1;
-  np = npx * npy;
-
-  // generate point coordinates
-  pointpos_x.reserve(np);
-  pointpos_y.reserve(np);
-  double dx = conf.lenx / (double) conf.nzx;
-  double dy = conf.leny / (double) conf.nzy;
-  int pcy = 0;
-  for (int j = 0; j < npy; ++j) {
-    if (j >= zybounds[pcy+1]) pcy += 1;
-    double y = dy * (double) j;
-    int pcx = 0;
-    for (int i = 0; i < npx; ++i) {
-      if (i >= zxbounds[pcx+1]) pcx += 1;
-      double x = dx * (double) i;
-      pointpos_x.push_back(x);
-      pointpos_y.push_back(y);
-      int c = pcy * conf.numpcx + pcx;
-      if (i != zxbounds[pcx] && j != zybounds[pcy])
-        pointcolors.push_back(c);
-      else {
-        int p = pointpos_x.size() - 1;
-        pointcolors.push_back(MULTICOLOR);
-        std::vector<int64_t> &pmc = pointmcolors[p];
-        if (i == zxbounds[pcx] && j == zybounds[pcy])
-          pmc.push_back(c - conf.numpcx - 1);
-        if (j == zybounds[pcy]) pmc.push_back(c - conf.numpcx);
-        if (i == zxbounds[pcx]) pmc.push_back(c - 1);
-        pmc.push_back(c);
-      }
-    }
-  }
+// The mesh is generated by several threads at once, each of which takes a
+// range of rows of the mesh and writes its points and zones straight into
+// the buffers supplied by the caller. Points and zones are numbered in
+// closed form from their row, so the only serial work is a prefix sum over
+// the rows (and, when the mesh is compacted, over the threads). The number
+// of threads defaults to the number of hardware threads and can be set
+// with the PENNANT_MESH_THREADS environment variable.
 
-  // generate zone adjacency lists
-  zonestart.reserve(nz);
-  zonesize.reserve(nz);
-  zonepoints.reserve(4 * nz);
-  zonecolors.reserve(nz);
-  pcy = 0;
-  for (int j = 0; j < conf.nzy; ++j) {
-    if (j >= zybounds[pcy+1]) pcy += 1;
-    int pcx = 0;
-    for (int i = 0; i < conf.nzx; ++i) {
-      if (i >= zxbounds[pcx+1]) pcx += 1;
-      zonestart.push_back(zonepoints.size());
-      zonesize.push_back(4);
-      int p0 = j * npx + i;
-      zonepoints.push_back(p0);
-      zonepoints.push_back(p0 + 1);
-      zonepoints.push_back(p0 + npx + 1);
-      zonepoints.push_back(p0 + npx);
-      zonecolors.push_back(pcy * conf.numpcx + pcx);
-    }
-  }
+static int mesh_threads()
+{
+  const char *env = getenv("PENNANT_MESH_THREADS");
+  int nthreads = env ? atoi(env) : int(std::thread::hardware_concurrency());
+  return std::max(nthreads, 1);
 }
 
-static void generate_mesh_pie(config &conf,
-                              std::vector<double> &pointpos_x,
-                              std::vector<double> &pointpos_y,
-                              std::vector<int64_t> &pointcolors,
-                              std::map<int64_t, std::vector<int64_t> > &pointmcolors,
-                              std::vector<int64_t> &zonestart,
-                              std::vector<int64_t> &zonesize,
-                              std::vector<int64_t> &zonepoints,
-                              std::vector<int64_t> &zonecolors,
-                              std::vector<int64_t> &zxbounds,
-                              std::vector<int64_t> &zybounds)
+// Calls f(t, lo, hi) for t in [0, nthreads), where [lo, hi) is the t-th of
+// nthreads nearly equal chunks of [0, n). Chunk 0 runs on the calling thread.
+template<typename F>
+static void parallel_for(int nthreads, int64_t n, const F &f)
 {
-  int64_t &nz = conf.nz;
-  int64_t &np = conf.np;
-
-  nz = conf.nzx * conf.nzy;
-  const int npx = conf.nzx + 1;
-  const int npy = conf.nzy + 1;
-  np = npx * (npy - 1) + 1;
-
-  // generate point coordinates
-  pointpos_x.reserve(np);
-  pointpos_y.reserve(np);
-  double dth = conf.lenx / (double) conf.nzx;
-  double dr  = conf.leny / (double) conf.nzy;
-  int pcy = 0;
-  for (int j = 0; j < npy; ++j) {
-    if (j >= zybounds[pcy+1]) pcy += 1;
-    if (j == 0) {
-      // special case:  "row" at origin only contains
-      // one point, shared by all pieces in row
-      pointpos_x.push_back(0.);
-      pointpos_y.push_back(0.);
-      if (conf.numpcx == 1)
-        pointcolors.push_back(0);
-      else {
-        pointcolors.push_back(MULTICOLOR);
-        std::vector<int64_t> &pmc = pointmcolors[0];
-        for (int c = 0; c < conf.numpcx; ++c)
-          pmc.push_back(c);
-      }
-      continue;
-    }
-    double r = dr * (double) j;
-    int pcx = 0;
-    for (int i = 0; i < npx; ++i) {
-      if (i >= zxbounds[pcx+1]) pcx += 1;
-      double th = dth * (double) (conf.nzx - i);
-      double x = r * cos(th);
-      double y = r * sin(th);
-      pointpos_x.push_back(x);
-      pointpos_y.push_back(y);
-      int c = pcy * conf.numpcx + pcx;
-      if (i != zxbounds[pcx] && j != zybounds[pcy])
-        pointcolors.push_back(c);
-      else {
-        int p = pointpos_x.size() - 1;
-        pointcolors.push_back(MULTICOLOR);
-        std::vector<int64_t> &pmc = pointmcolors[p];
-        if (i == zxbounds[pcx] && j == zybounds[pcy])
-          pmc.push_back(c - conf.numpcx - 1);
-        if (j == zybounds[pcy]) pmc.push_back(c - conf.numpcx);
-        if (i == zxbounds[pcx]) pmc.push_back(c - 1);
-        pmc.push_back(c);
-      }
-    }
+  std::vector<std::thread> threads;
+  for (int t = 1; t < nthreads; t++) {
+    threads.push_back(std::thread(f, t, n * t / nthreads,
+                                  n * (t + 1) / nthreads));
   }
-
-  // generate zone adjacency lists
-  zonestart.reserve(nz);
-  zonesize.reserve(nz);
-  zonepoints.reserve(4 * nz);
-  zonecolors.reserve(nz);
-  pcy = 0;
-  for (int j = 0; j < conf.nzy; ++j) {
-    if (j >= zybounds[pcy+1]) pcy += 1;
-    int pcx = 0;
-    for (int i = 0; i < conf.nzx; ++i) {
-      if (i >= zxbounds[pcx+1]) pcx += 1;
-      zonestart.push_back(zonepoints.size());
-      int p0 = j * npx + i - (npx - 1);
-      if (j == 0) {
-        zonesize.push_back(3);
-        zonepoints.push_back(0);
-      }
-      else {
-        zonesize.push_back(4);
-        zonepoints.push_back(p0);
-        zonepoints.push_back(p0 + 1);
-      }
-      zonepoints.push_back(p0 + npx + 1);
-      zonepoints.push_back(p0 + npx);
-      zonecolors.push_back(pcy * conf.numpcx + pcx);
-    }
+  f(0, int64_t(0), n / nthreads);
+  for (std::vector<std::thread>::iterator it = threads.begin(),
+         ie = threads.end(); it != ie; ++it) {
+    it->join();
   }
 }
 
-static void generate_mesh_hex(config &conf,
-                              std::vector<double> &pointpos_x,
-                              std::vector<double> &pointpos_y,
-                              std::vector<int64_t> &pointcolors,
-                              std::map<int64_t, std::vector<int64_t> > &pointmcolors,
-                              std::vector<int64_t> &zonestart,
-                              std::vector<int64_t> &zonesize,
-                              std::vector<int64_t> &zonepoints,
-                              std::vector<int64_t> &zonecolors,
-                              std::vector<int64_t> &zxbounds,
-                              std::vector<int64_t> &zybounds)
+static double wall_time()
 {
-  int64_t &nz = conf.nz;
-  int64_t &np = conf.np;
-
-  nz = conf.nzx * conf.nzy;
-  const int npx = conf.nzx + 1;
-  const int npy = conf.nzy + 1;
-
-  // generate point coordinates
-  pointpos_x.resize(2 * npx * npy);  // upper bound
-  pointpos_y.resize(2 * npx * npy);  // upper bound
-  double dx = conf.lenx / (double) (conf.nzx - 1);
-  double dy = conf.leny / (double) (conf.nzy - 1);
-
-  std::vector<int64_t> pbase(npy);
-  int p = 0;
-  int pcy = 0;
-  for (int j = 0; j < npy; ++j) {
-    if (j >= zybounds[pcy+1]) pcy += 1;
-    pbase[j] = p;
-    double y = dy * ((double) j - 0.5);
-    y = std::max(0., std::min(conf.leny, y));
-    int pcx = 0;
-    for (int i = 0; i < npx; ++i) {
-      if (i >= zxbounds[pcx+1]) pcx += 1;
-      double x = dx * ((double) i - 0.5);
-      x = std::max(0., std::min(conf.lenx, x));
-      int c = pcy * conf.numpcx + pcx;
-      if (i == 0 || i == conf.nzx || j == 0 || j == conf.nzy) {
-        pointpos_x[p] = x;
-        pointpos_y[p++] = y;
-        if (i != zxbounds[pcx] && j != zybounds[pcy])
-          pointcolors.push_back(c);
-        else {
-          int p1 = p - 1;
-          pointcolors.push_back(MULTICOLOR);
-          std::vector<int64_t> &pmc = pointmcolors[p1];
-          if (j == zybounds[pcy]) pmc.push_back(c - conf.numpcx);
-          if (i == zxbounds[pcx]) pmc.push_back(c - 1);
-          pmc.push_back(c);
-        }
-      }
-      else {
-        pointpos_x[p] = x - dx / 6.;
-        pointpos_y[p++] = y + dy / 6.;
-        pointpos_x[p] = x + dx / 6.;
-        pointpos_y[p++] = y - dy / 6.;
-        if (i != zxbounds[pcx] && j != zybounds[pcy]) {
-          pointcolors.push_back(c);
-          pointcolors.push_back(c);
-        }
-        else {
-          int p1 = p - 2;
-          int p2 = p - 1;
-          pointcolors.push_back(MULTICOLOR);
-          pointcolors.push_back(MULTICOLOR);
-          std::vector<int64_t> &pmc1 = pointmcolors[p1];
-          std::vector<int64_t> &pmc2 = pointmcolors[p2];
-          if (i == zxbounds[pcx] && j == zybounds[pcy]) {
-            pmc1.push_back(c - conf.numpcx - 1);
-            pmc2.push_back(c - conf.numpcx - 1);
-            pmc1.push_back(c - 1);
-            pmc2.push_back(c - conf.numpcx);
-          }
-          else if (j == zybounds[pcy]) {
-            pmc1.push_back(c - conf.numpcx);
-            pmc2.push_back(c - conf.numpcx);
-          }
-          else {  // i == zxbounds[pcx]
-            pmc1.push_back(c - 1);
-            pmc2.push_back(c - 1);
-          }
-          pmc1.push_back(c);
-          pmc2.push_back(c);
-        }
-      }
-    } // for i
-  } // for j
-  np = p;
-  pointpos_x.resize(np);
-  pointpos_y.resize(np);
-
-  // generate zone adjacency lists
-  zonestart.resize(nz);
-  zonesize.resize(nz);
-  zonepoints.reserve(6 * nz);  // upper bound
-  zonecolors.reserve(nz);
-  pcy = 0;
-  for (int j = 0; j < conf.nzy; ++j) {
-    if (j >= zybounds[pcy+1]) pcy += 1;
-    int pbasel = pbase[j];
-    int pbaseh = pbase[j+1];
-    int pcx = 0;
-    for (int i = 0; i < conf.nzx; ++i) {
-      if (i >= zxbounds[pcx+1]) pcx += 1;
-      int z = j * conf.nzx + i;
-      std::vector<int64_t> v(6);
-      v[1] = pbasel + 2 * i;
-      v[0] = v[1] - 1;
-      v[2] = v[1] + 1;
-      v[5] = pbaseh + 2 * i;
-      v[4] = v[5] + 1;
-      v[3] = v[4] + 1;
-      if (j == 0) {
-        v[0] = pbasel + i;
-        v[2] = v[0] + 1;
-        if (i == conf.nzx - 1) v.erase(v.begin()+3);
-        v.erase(v.begin()+1);
-      } // if j
-      else if (j == conf.nzy - 1) {
-        v[5] = pbaseh + i;
-        v[3] = v[5] + 1;
-        v.erase(v.begin()+4);
-        if (i == 0) v.erase(v.begin()+0);
-      } // else if j
-      else if (i == 0)
-        v.erase(v.begin()+0);
-      else if (i == conf.nzx - 1)
-        v.erase(v.begin()+3);
-      zonestart[z] = zonepoints.size();
-      zonesize[z] = v.size();
-      zonepoints.insert(zonepoints.end(), v.begin(), v.end());
-      zonecolors.push_back(pcy * conf.numpcx + pcx);
-    } // for i
-  } // for j
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
 }
 
+// Reports the time taken by each phase of mesh generation.
+struct phase_timer {
+  double start;
+  phase_timer() : start(wall_time()) {}
+  void phase(const char *name)
+  {
+    double now = wall_time();
+    printf("  %-24s %8.3f s\n", name, now - start);
+    start = now;
+  }
+};
+
+// Output buffers of generate_mesh_raw.
+struct mesh_buffers {
+  double *pointpos_x;
+  double *pointpos_y;
+  int64_t *pointcolors;
+  uint64_t *pointmcolors;
+  int64_t *pointspancolors;
+  int64_t *zonestart;
+  int64_t *zonesize;
+  int64_t *zonepoints;
+  int64_t *zonecolors;
+  int64_t *zonespancolors;
+};
+
+// Per-row layout of the mesh, shared by all mesh types.
+struct mesh_rows {
+  int64_t npx, npy;
+  std::vector<int64_t> zxbounds;
+  std::vector<int64_t> zybounds;
+  std::vector<int64_t> pcy;    // piece row of each row of points and zones
+  std::vector<int64_t> pbase;  // first point of each row (pbase[npy] == np)
+};
+
 static void calc_mesh_num_pieces(config &conf)
 {
     // pick numpcx, numpcy such that pieces are as close to square
@@ -406,73 +173,315 @@ static void calc_mesh_num_pieces(config &conf)
     if (swapflag) std::swap(conf.numpcx, conf.numpcy);
 }
 
-static void generate_mesh(config &conf,
-                          std::vector<double> &pointpos_x,
-                          std::vector<double> &pointpos_y,
-                          std::vector<int64_t> &pointcolors,
-                          std::map<int64_t, std::vector<int64_t> > &pointmcolors,
-                          std::vector<int64_t> &zonestart,
-                          std::vector<int64_t> &zonesize,
-                          std::vector<int64_t> &zonepoints,
-                          std::vector<int64_t> &zonecolors)
+static void calc_mesh_rows(config &conf, mesh_rows &m)
 {
   // Do calculations common to all mesh types:
-  std::vector<int64_t> zxbounds;
-  std::vector<int64_t> zybounds;
   calc_mesh_num_pieces(conf);
-  zxbounds.push_back(-1);
+  m.zxbounds.push_back(-1);
   for (int pcx = 1; pcx < conf.numpcx; ++pcx)
-    zxbounds.push_back(pcx * conf.nzx / conf.numpcx);
-  zxbounds.push_back(conf.nzx + 1);
-  zybounds.push_back(-1);
+    m.zxbounds.push_back(pcx * conf.nzx / conf.numpcx);
+  m.zxbounds.push_back(conf.nzx + 1);
+  m.zybounds.push_back(-1);
   for (int pcy = 1; pcy < conf.numpcy; ++pcy)
-    zybounds.push_back(pcy * conf.nzy / conf.numpcy);
-  zybounds.push_back(0x7FFFFFFF);
-
-  // Mesh type-specific calculations:
-  if (conf.meshtype == MESH_PIE) {
-    generate_mesh_pie(conf, pointpos_x, pointpos_y, pointcolors, pointmcolors,
-                      zonestart, zonesize, zonepoints, zonecolors,
-                      zxbounds, zybounds);
-  } else if (conf.meshtype == MESH_RECT) {
-    generate_mesh_rect(conf, pointpos_x, pointpos_y, pointcolors, pointmcolors,
-                       zonestart, zonesize, zonepoints, zonecolors,
-                       zxbounds, zybounds);
+    m.zybounds.push_back(pcy * conf.nzy / conf.numpcy);
+  m.zybounds.push_back(0x7FFFFFFF);
+
+  conf.nz = conf.nzx * conf.nzy;
+  m.npx = conf.nzx + 1;
+  m.npy = conf.nzy + 1;
+
+  m.pcy.resize(m.npy);
+  m.pbase.resize(m.npy + 1);
+  int64_t pcy = 0;
+  int64_t p = 0;
+  for (int64_t j = 0; j < m.npy; ++j) {
+    if (j >= m.zybounds[pcy+1]) pcy += 1;
+    m.pcy[j] = pcy;
+    m.pbase[j] = p;
+    if (conf.meshtype == MESH_PIE && j == 0) {
+      // "row" at origin only contains one point
+      p += 1;
+    } else if (conf.meshtype == MESH_HEX && j != 0 && j != conf.nzy) {
+      // interior points are split in two
+      p += 2 * m.npx - 2;
+    } else {
+      p += m.npx;
+    }
+  }
+  m.pbase[m.npy] = p;
+  conf.np = p;
+}
+
+// Fills in the colors of a point on a piece boundary and returns the
+// number of colors, or returns 0 for a point owned by the single piece c.
+static int boundary_colors(const config &conf, const mesh_rows &m,
+                           int64_t i, int64_t j, int64_t pcx, int64_t pcy,
+                           int64_t c, bool corners, int64_t *mc)
+{
+  bool xb = (i == m.zxbounds[pcx]);
+  bool yb = (j == m.zybounds[pcy]);
+  if (!xb && !yb) return 0;
+  int nmc = 0;
+  if (corners && xb && yb) mc[nmc++] = c - conf.numpcx - 1;
+  if (yb) mc[nmc++] = c - conf.numpcx;
+  if (xb) mc[nmc++] = c - 1;
+  mc[nmc++] = c;
+  return nmc;
+}
+
+// Generates the points of row j, calling
+//   sink(p, x, y, color, mcolors, nmcolors)
+// for each of them, where nmcolors is 0 for single-colored points.
+// Positions are only computed if the sink asks for them.
+template<typename S>
+static void generate_point_row(const config &conf, const mesh_rows &m,
+                               int64_t j, S &sink)
+{
+  int64_t p = m.pbase[j];
+  int64_t pcy = m.pcy[j];
+  int64_t mc[4];
+
+  if (conf.meshtype == MESH_RECT) {
+    double dx = conf.lenx / (double) conf.nzx;
+    double dy = conf.leny / (double) conf.nzy;
+    double y = dy * (double) j;
+    int64_t pcx = 0;
+    for (int64_t i = 0; i < m.npx; ++i) {
+      if (i >= m.zxbounds[pcx+1]) pcx += 1;
+      double x = dx * (double) i;
+      int64_t c = pcy * conf.numpcx + pcx;
+      int nmc = boundary_colors(conf, m, i, j, pcx, pcy, c, true, mc);
+      sink(p++, x, y, c, mc, nmc);
+    }
+  } else if (conf.meshtype == MESH_PIE) {
+    if (j == 0) {
+      // special case:  "row" at origin only contains
+      // one point, shared by all pieces in row
+      std::vector<int64_t> pmc;
+      if (conf.numpcx > 1) {
+        for (int64_t c = 0; c < conf.numpcx; ++c)
+          pmc.push_back(c);
+      }
+      sink(p, 0., 0., int64_t(0), pmc.data(), int(pmc.size()));
+      return;
+    }
+    double dth = conf.lenx / (double) conf.nzx;
+    double dr  = conf.leny / (double) conf.nzy;
+    double r = dr * (double) j;
+    int64_t pcx = 0;
+    for (int64_t i = 0; i < m.npx; ++i) {
+      if (i >= m.zxbounds[pcx+1]) pcx += 1;
+      double x = 0., y = 0.;
+      if (S::positions) {
+        double th = dth * (double) (conf.nzx - i);
+        x = r * cos(th);
+        y = r * sin(th);
+      }
+      int64_t c = pcy * conf.numpcx + pcx;
+      int nmc = boundary_colors(conf, m, i, j, pcx, pcy, c, true, mc);
+      sink(p++, x, y, c, mc, nmc);
+    }
   } else if (conf.meshtype == MESH_HEX) {
-    generate_mesh_hex(conf, pointpos_x, pointpos_y, pointcolors, pointmcolors,
-                      zonestart, zonesize, zonepoints, zonecolors,
-                      zxbounds, zybounds);
+    double dx = conf.lenx / (double) (conf.nzx - 1);
+    double dy = conf.leny / (double) (conf.nzy - 1);
+    double y = dy * ((double) j - 0.5);
+    y = std::max(0., std::min(conf.leny, y));
+    int64_t pcx = 0;
+    for (int64_t i = 0; i < m.npx; ++i) {
+      if (i >= m.zxbounds[pcx+1]) pcx += 1;
+      double x = dx * ((double) i - 0.5);
+      x = std::max(0., std::min(conf.lenx, x));
+      int64_t c = pcy * conf.numpcx + pcx;
+      if (i == 0 || i == conf.nzx || j == 0 || j == conf.nzy) {
+        int nmc = boundary_colors(conf, m, i, j, pcx, pcy, c, false, mc);
+        sink(p++, x, y, c, mc, nmc);
+      }
+      else {
+        bool xb = (i == m.zxbounds[pcx]);
+        bool yb = (j == m.zybounds[pcy]);
+        int64_t mc2[3];
+        int nmc = 0;
+        if (xb && yb) {
+          mc[0] = c - conf.numpcx - 1; mc[1] = c - 1;          mc[2] = c;
+          mc2[0] = c - conf.numpcx - 1; mc2[1] = c - conf.numpcx; mc2[2] = c;
+          nmc = 3;
+        }
+        else if (xb || yb) {
+          mc[0] = mc2[0] = (yb ? c - conf.numpcx : c - 1);
+          mc[1] = mc2[1] = c;
+          nmc = 2;
+        }
+        sink(p++, x - dx / 6., y + dy / 6., c, mc, nmc);
+        sink(p++, x + dx / 6., y - dy / 6., c, mc2, nmc);
+      }
+    } // for i
   }
 }
 
-static void sort_zones_by_color(const config &conf,
-                                const std::vector<int64_t> &zonecolors,
-                                std::vector<int64_t> &zones_inverse_map,
-                                std::vector<int64_t> &zones_map)
+static void erase_point(int64_t *v, int &n, int k)
+{
+  std::copy(v + k + 1, v + n, v + k);
+  n--;
+}
+
+// Fills in the points of zone (i, j) of the mesh and returns their number.
+static int zone_points(const config &conf, const mesh_rows &m,
+                       int64_t i, int64_t j, int64_t *v)
 {
-  // Sort zones by color.
-  assert(int64_t(zonecolors.size()) == conf.nz);
-  std::map<int64_t, std::vector<int64_t> > zones_by_color;
-  for (int64_t z = 0; z < conf.nz; z++) {
-    zones_by_color[zonecolors[z]].push_back(z);
+  if (conf.meshtype == MESH_RECT) {
+    int64_t p0 = j * m.npx + i;
+    v[0] = p0;
+    v[1] = p0 + 1;
+    v[2] = p0 + m.npx + 1;
+    v[3] = p0 + m.npx;
+    return 4;
+  } else if (conf.meshtype == MESH_PIE) {
+    int64_t p0 = j * m.npx + i - (m.npx - 1);
+    int n = 0;
+    if (j == 0) {
+      v[n++] = 0;
+    }
+    else {
+      v[n++] = p0;
+      v[n++] = p0 + 1;
+    }
+    v[n++] = p0 + m.npx + 1;
+    v[n++] = p0 + m.npx;
+    return n;
+  } else {
+    assert(conf.meshtype == MESH_HEX);
+    int64_t pbasel = m.pbase[j];
+    int64_t pbaseh = m.pbase[j+1];
+    int n = 6;
+    v[1] = pbasel + 2 * i;
+    v[0] = v[1] - 1;
+    v[2] = v[1] + 1;
+    v[5] = pbaseh + 2 * i;
+    v[4] = v[5] + 1;
+    v[3] = v[4] + 1;
+    if (j == 0) {
+      v[0] = pbasel + i;
+      v[2] = v[0] + 1;
+      if (i == conf.nzx - 1) erase_point(v, n, 3);
+      erase_point(v, n, 1);
+    } // if j
+    else if (j == conf.nzy - 1) {
+      v[5] = pbaseh + i;
+      v[3] = v[5] + 1;
+      erase_point(v, n, 4);
+      if (i == 0) erase_point(v, n, 0);
+    } // else if j
+    else if (i == 0)
+      erase_point(v, n, 0);
+    else if (i == conf.nzx - 1)
+      erase_point(v, n, 3);
+    return n;
   }
-  for (int64_t c = 0; c < conf.npieces; c++) {
-    std::vector<int64_t> &zones = zones_by_color[c];
-    for (std::vector<int64_t>::iterator zt = zones.begin(), ze = zones.end();
-         zt != ze; ++zt) {
-      int64_t z = *zt;
-      assert(zones_map[z] == -1ll);
-      zones_map[z] = zones_inverse_map.size();
-      zones_inverse_map.push_back(z);
+}
+
+// Generates the zones of rows [j0, j1), starting at zone point zp. Point
+// numbers are translated through points_map when the mesh is compacted.
+static void generate_zone_rows(const config &conf, const mesh_rows &m,
+                               int64_t j0, int64_t j1, int64_t zp,
+                               const int64_t *points_map,
+                               const mesh_buffers &out)
+{
+  int64_t v[6];
+  for (int64_t j = j0; j < j1; ++j) {
+    int64_t pcx = 0;
+    for (int64_t i = 0; i < conf.nzx; ++i) {
+      if (i >= m.zxbounds[pcx+1]) pcx += 1;
+      int64_t z = j * conf.nzx + i;
+      int n = zone_points(conf, m, i, j, v);
+      out.zonestart[z] = zp;
+      out.zonesize[z] = n;
+      for (int k = 0; k < n; ++k) {
+        out.zonepoints[zp++] = points_map ? points_map[v[k]] : v[k];
+      }
+      out.zonecolors[z] = m.pcy[j] * conf.numpcx + pcx;
     }
   }
 }
 
+// Point sink which records the bucket each point is sorted into when the
+// mesh is compacted: multi-color points come first, by first color, then
+// the others by color.
+struct point_classifier {
+  static const bool positions = false;
+  int64_t npieces;
+  int64_t *buckets;
+  void operator()(int64_t p, double x, double y, int64_t c,
+                  const int64_t *mc, int nmc) const
+  {
+    buckets[p] = nmc ? mc[0] : npieces + c;
+  }
+};
+
+// Point sink which writes each point to its final position.
+struct point_writer {
+  static const bool positions = true;
+  const mesh_buffers *out;
+  const int64_t *points_map;
+  void operator()(int64_t p, double x, double y, int64_t c,
+                  const int64_t *mc, int nmc) const
+  {
+    int64_t q = points_map ? points_map[p] : p;
+    out->pointpos_x[q] = x;
+    out->pointpos_y[q] = y;
+    out->pointcolors[q] = nmc ? MULTICOLOR : c;
+    // The first color is kept in pointspancolors until color_spans
+    // replaces it with the span.
+    out->pointspancolors[q] = nmc ? mc[0] : c;
+    for (int k = 0; k < nmc; ++k) {
+      int64_t word = mc[k] / 64;
+      int64_t bit = mc[k] % 64;
+      // The words of neighboring points overlap when there is more than
+      // one word of colors, so they may be shared with other threads.
+      __sync_fetch_and_or(&out->pointmcolors[q + word], uint64_t(1) << bit);
+    }
+  }
+};
+
+// Stable counting sort: on entry map[i] is the bucket of element i, and on
+// exit it is the position of element i in the sorted order.
+static void counting_sort(int nthreads, int64_t n, int64_t nbuckets,
+                          int64_t *map)
+{
+  std::vector<int64_t> offsets(nthreads * nbuckets, 0);
+  parallel_for(nthreads, n, [&](int t, int64_t lo, int64_t hi) {
+    int64_t *count = &offsets[t * nbuckets];
+    for (int64_t i = lo; i < hi; i++) count[map[i]]++;
+  });
+  int64_t next = 0;
+  for (int64_t b = 0; b < nbuckets; b++) {
+    for (int t = 0; t < nthreads; t++) {
+      int64_t count = offsets[t * nbuckets + b];
+      offsets[t * nbuckets + b] = next;
+      next += count;
+    }
+  }
+  assert(next == n);
+  parallel_for(nthreads, n, [&](int t, int64_t lo, int64_t hi) {
+    int64_t *offset = &offsets[t * nbuckets];
+    for (int64_t i = lo; i < hi; i++) map[i] = offset[map[i]]++;
+  });
+}
+
+// Moves values[i] to values[map[i]].
+static void permute(int nthreads, int64_t n, const int64_t *map,
+                    int64_t *values, std::vector<int64_t> &scratch)
+{
+  scratch.assign(values, values + n);
+  parallel_for(nthreads, n, [&](int t, int64_t lo, int64_t hi) {
+    for (int64_t i = lo; i < hi; i++) values[map[i]] = scratch[i];
+  });
+}
+
 static std::set<int64_t> zone_point_set(
   int64_t z,
-  const std::vector<int64_t> &zonestart,
-  const std::vector<int64_t> &zonesize,
-  const std::vector<int64_t> &zonepoints)
+  const int64_t *zonestart,
+  const int64_t *zonesize,
+  const int64_t *zonepoints)
 {
   std::set<int64_t> points;
   for (int64_t z_start = zonestart[z], z_size = zonesize[z],
@@ -483,13 +492,10 @@ static std::set<int64_t> zone_point_set(
 }
 
 static void sort_zones_by_color_strip(const config &conf,
-                                      const std::vector<double> &pointpos_x,
-                                      const std::vector<double> &pointpos_y,
-                                      const std::vector<int64_t> &zonestart,
-                                      const std::vector<int64_t> &zonesize,
-                                      const std::vector<int64_t> &zonepoints,
-                                      const std::vector<int64_t> &zonecolors,
-                                      std::vector<int64_t> &zones_inverse_map,
+                                      const int64_t *zonestart,
+                                      const int64_t *zonesize,
+                                      const int64_t *zonepoints,
+                                      const int64_t *zonecolors,
                                       std::vector<int64_t> &zones_map)
 {
   int64_t stripsize = conf.stripsize;
@@ -498,7 +504,8 @@ static void sort_zones_by_color_strip(const config &conf,
   // size stripsize.
 
   std::vector<std::vector<int64_t> > strips;
-  assert(int64_t(zonecolors.size()) == conf.nz);
+  int64_t next = 0;
+  zones_map.assign(conf.nz, -1ll);
   for (int64_t c = 0; c < conf.npieces; c++) {
     strips.assign(strips.size(), std::vector<int64_t>());
 
@@ -542,284 +549,52 @@ static void sort_zones_by_color_strip(const config &conf,
            zt != ze; ++zt) {
         int64_t z = *zt;
         assert(zones_map[z] == -1ll);
-        zones_map[z] = zones_inverse_map.size();
-        zones_inverse_map.push_back(z);
+        zones_map[z] = next++;
       }
     }
   }
+  assert(next == conf.nz);
 }
 
-static void sort_points_by_color(
-  const config &conf,
-  const std::vector<int64_t> &pointcolors,
-  std::map<int64_t, std::vector<int64_t> > &pointmcolors,
-  std::vector<int64_t> &points_inverse_map,
-  std::vector<int64_t> &points_map)
-{
-  // Sort points by color; sort multi-color points by first color.
-  assert(int64_t(pointcolors.size()) == conf.np);
-  std::map<int64_t, std::vector<int64_t> > points_by_color;
-  std::map<int64_t, std::vector<int64_t> > points_by_multicolor;
-  for (int64_t p = 0; p < conf.np; p++) {
-    if (pointcolors[p] == MULTICOLOR) {
-      points_by_multicolor[pointmcolors[p][0]].push_back(p);
-    } else {
-      points_by_color[pointcolors[p]].push_back(p);
-    }
-  }
-  for (int64_t c = 0; c < conf.npieces; c++) {
-    std::vector<int64_t> &points = points_by_multicolor[c];
-    for (std::vector<int64_t>::iterator pt = points.begin(), pe = points.end();
-         pt != pe; ++pt) {
-      int64_t p = *pt;
-      assert(points_map[p] == -1ll);
-      points_map[p] = points_inverse_map.size();
-      points_inverse_map.push_back(p);
-    }
-  }
-  for (int64_t c = 0; c < conf.npieces; c++) {
-    std::vector<int64_t> &points = points_by_color[c];
-    for (std::vector<int64_t>::iterator pt = points.begin(), pe = points.end();
-         pt != pe; ++pt) {
-      int64_t p = *pt;
-      assert(points_map[p] == -1ll);
-      points_map[p] = points_inverse_map.size();
-      points_inverse_map.push_back(p);
-    }
-  }
-}
-
-static void compact_mesh(const config &conf,
-                         std::vector<double> &pointpos_x,
-                         std::vector<double> &pointpos_y,
-                         std::vector<int64_t> &pointcolors,
-                         std::map<int64_t, std::vector<int64_t> > &pointmcolors,
-                         std::vector<int64_t> &zonestart,
-                         std::vector<int64_t> &zonesize,
-                         std::vector<int64_t> &zonepoints,
-                         std::vector<int64_t> &zonecolors)
-{
-  // This stage is responsible for compacting the mesh so that each of
-  // the pieces is dense (in the global coordinate space). This
-  // involves sorting the various elements by color and then rewriting
-  // the various pointers to be internally consistent again.
-
-  // Sort zones by color.
-  std::vector<int64_t> zones_inverse_map;
-  std::vector<int64_t> zones_map(conf.nz, -1ll);
-  if (conf.stripsize > 0) {
-    sort_zones_by_color_strip(conf, pointpos_x, pointpos_y,
-                              zonestart, zonesize, zonepoints, zonecolors,
-                              zones_inverse_map, zones_map);
-  } else {
-    sort_zones_by_color(conf, zonecolors, zones_inverse_map, zones_map);
-  }
-  assert(int64_t(zones_inverse_map.size()) == conf.nz);
-
-  // Sort points by color; sort multi-color points by first color.
-  std::vector<int64_t> points_inverse_map;
-  std::vector<int64_t> points_map(conf.np, -1ll);
-  sort_points_by_color(conf, pointcolors, pointmcolors,
-                       points_inverse_map, points_map);
-  assert(int64_t(points_inverse_map.size()) == conf.np);
-
-  // Various sanity checks.
-#if 0
-  for (int64_t z = 0; z < conf.nz; z++) {
-    printf("zone old %ld new %ld color %ld\n", z, zones_map[z], zonecolors[z]);
-  }
-
-  printf("\n");
-
-  for (int64_t newz = 0; newz < conf.nz; newz++) {
-    int64_t oldz = zones_inverse_map[newz];
-    printf("zone new %ld old %ld color %ld\n", newz, oldz, zonecolors[oldz]);
-  }
-
-  printf("\n");
-
-  for (int64_t p = 0; p < conf.np; p++) {
-    printf("point old %ld new %ld color %ld\n", p, points_map[p], pointcolors[p]);
-  }
-
-  printf("\n");
-
-  for (int64_t newp = 0; newp < conf.np; newp++) {
-    int64_t oldp = points_inverse_map[newp];
-    printf("point new %ld old %ld color %ld\n", newp, oldp, pointcolors[oldp]);
-  }
-#endif
-
-  // Project zones through the zones map.
-  {
-    std::vector<int64_t> old_zonestart = zonestart;
-    for (int64_t newz = 0; newz < conf.nz; newz++) {
-      int64_t oldz = zones_inverse_map[newz];
-      zonestart[newz] = old_zonestart[oldz];
-    }
-  }
-  {
-    std::vector<int64_t> old_zonesize = zonesize;
-    for (int64_t newz = 0; newz < conf.nz; newz++) {
-      int64_t oldz = zones_inverse_map[newz];
-      zonesize[newz] = old_zonesize[oldz];
-    }
-  }
-  {
-    std::vector<int64_t> old_zonepoints = zonepoints;
-    int64_t nzp = zonepoints.size();
-    for (int64_t zp = 0; zp < nzp; zp++) {
-      zonepoints[zp] = points_map[old_zonepoints[zp]];
-    }
-  }
-  {
-    std::vector<int64_t> old_zonecolors = zonecolors;
-    for (int64_t newz = 0; newz < conf.nz; newz++) {
-      int64_t oldz = zones_inverse_map[newz];
-      zonecolors[newz] = old_zonecolors[oldz];
-    }
-  }
-
-  // Project points through the points map.
-  {
-    std::vector<double> old_pointpos_x = pointpos_x;
-    for (int64_t newp = 0; newp < conf.np; newp++) {
-      int64_t oldp = points_inverse_map[newp];
-      pointpos_x[newp] = old_pointpos_x[oldp];
-    }
-  }
-  {
-    std::vector<double> old_pointpos_y = pointpos_y;
-    for (int64_t newp = 0; newp < conf.np; newp++) {
-      int64_t oldp = points_inverse_map[newp];
-      pointpos_y[newp] = old_pointpos_y[oldp];
-    }
-  }
-  {
-    std::vector<int64_t> old_pointcolors = pointcolors;
-    for (int64_t newp = 0; newp < conf.np; newp++) {
-      int64_t oldp = points_inverse_map[newp];
-      pointcolors[newp] = old_pointcolors[oldp];
-    }
-  }
-  {
-    std::map<int64_t, std::vector<int64_t> > old_pointmcolors = pointmcolors;
-    for (int64_t newp = 0; newp < conf.np; newp++) {
-      int64_t oldp = points_inverse_map[newp];
-      pointmcolors[newp] = old_pointmcolors[oldp];
-    }
-  }
-
-}
-
-static void
-color_spans(const config &conf,
-            const std::vector<double> &pointpos_x,
-            const std::vector<double> &pointpos_y,
-            const std::vector<int64_t> &pointcolors,
-            std::map<int64_t, std::vector<int64_t> > &pointmcolors,
-            const std::vector<int64_t> &zonestart,
-            const std::vector<int64_t> &zonesize,
-            const std::vector<int64_t> &zonepoints,
-            const std::vector<int64_t> &zonecolors,
-            std::vector<int64_t> &zonespancolors_vec,
-            std::vector<int64_t> &pointspancolors_vec,
-            int64_t &nspans_zones,
-            int64_t &nspans_points)
+// Numbers the spans of each color in order, and colors every zone and point
+// by its span. On entry pointspancolors holds the first color of each point.
+static void color_spans(const config &conf,
+                        const mesh_buffers &out,
+                        int64_t &nspans_zones,
+                        int64_t &nspans_points)
 {
   {
     // Compute zone spans.
-    std::vector<std::vector<std::vector<int64_t> > > spans(conf.npieces);
+    std::vector<int64_t> nspans(conf.npieces, 0);
     std::vector<int64_t> span_size(conf.npieces, conf.spansize);
     for (int64_t z = 0; z < conf.nz; z++) {
-      int64_t c = zonecolors[z];
-      if (span_size[c] + zonesize[c] > conf.spansize) {
-        spans[c].resize(spans[c].size() + 1);
+      int64_t c = out.zonecolors[z];
+      if (span_size[c] + out.zonesize[c] > conf.spansize) {
+        nspans[c]++;
         span_size[c] = 0;
       }
-      spans[c][spans[c].size() - 1].push_back(z);
-      span_size[c] += zonesize[z];
-    }
-
-    // Color zones by span.
-    nspans_zones = 0;
-    zonespancolors_vec.assign(conf.nz, -1ll);
-    for (int64_t c = 0; c < conf.npieces; c++) {
-      std::vector<std::vector<int64_t> > &color_spans = spans[c];
-      int64_t nspans = color_spans.size();
-      nspans_zones = std::max(nspans_zones, nspans);
-      for (int64_t ispan = 0; ispan < nspans; ispan++) {
-        std::vector<int64_t> &span = color_spans[ispan];
-        for (std::vector<int64_t>::iterator zt = span.begin(), ze = span.end();
-             zt != ze; ++zt) {
-          int64_t z = *zt;
-          zonespancolors_vec[z] = ispan;
-        }
-      }
-    }
-    for (int64_t z = 0; z < conf.nz; z++) {
-      assert(zonespancolors_vec[z] != -1ll);
+      out.zonespancolors[z] = nspans[c] - 1;
+      span_size[c] += out.zonesize[z];
     }
+    nspans_zones = *std::max_element(nspans.begin(), nspans.end());
   }
 
   {
-    // Compute point spans.
-    std::vector<std::vector<std::vector<int64_t> > > spans(conf.npieces);
-    std::vector<std::vector<std::vector<int64_t> > > mspans(conf.npieces);
-    std::vector<int64_t> span_size(conf.npieces, conf.spansize);
-    std::vector<int64_t> mspan_size(conf.npieces, conf.spansize);
+    // Compute point spans. Multi-color points have spans of their own,
+    // by first color.
+    std::vector<int64_t> nspans(2 * conf.npieces, 0);
+    std::vector<int64_t> span_size(2 * conf.npieces, conf.spansize);
     for (int64_t p = 0; p < conf.np; p++) {
-      int64_t c = pointcolors[p];
-      if (c != MULTICOLOR) {
-        if (span_size[c] >= conf.spansize) {
-          spans[c].resize(spans[c].size() + 1);
-          span_size[c] = 0;
-        }
-        spans[c][spans[c].size() - 1].push_back(p);
-        span_size[c]++;
-      } else {
-        c = pointmcolors[p][0];
-        if (mspan_size[c] >= conf.spansize) {
-          mspans[c].resize(mspans[c].size() + 1);
-          mspan_size[c] = 0;
-        }
-        mspans[c][mspans[c].size() - 1].push_back(p);
-        mspan_size[c]++;
-      }
-    }
-
-    // Color points by span.
-    nspans_points = 0;
-    pointspancolors_vec.assign(conf.np, -1ll);
-    for (int64_t c = 0; c < conf.npieces; c++) {
-      std::vector<std::vector<int64_t> > &color_spans = spans[c];
-      int64_t nspans = color_spans.size();
-      nspans_points = std::max(nspans_points, nspans);
-      for (int64_t ispan = 0; ispan < nspans; ispan++) {
-        std::vector<int64_t> &span = color_spans[ispan];
-        for (std::vector<int64_t>::iterator pt = span.begin(), pe = span.end();
-             pt != pe; ++pt) {
-          int64_t p = *pt;
-          pointspancolors_vec[p] = ispan;
-        }
-      }
-    }
-    for (int64_t c = 0; c < conf.npieces; c++) {
-      std::vector<std::vector<int64_t> > &color_spans = mspans[c];
-      int64_t nspans = color_spans.size();
-      nspans_points = std::max(nspans_points, nspans);
-      for (int64_t ispan = 0; ispan < nspans; ispan++) {
-        std::vector<int64_t> &span = color_spans[ispan];
-        for (std::vector<int64_t>::iterator pt = span.begin(), pe = span.end();
-             pt != pe; ++pt) {
-          int64_t p = *pt;
-          pointspancolors_vec[p] = ispan;
-        }
+      int64_t c = out.pointspancolors[p];
+      if (out.pointcolors[p] == MULTICOLOR) c += conf.npieces;
+      if (span_size[c] >= conf.spansize) {
+        nspans[c]++;
+        span_size[c] = 0;
       }
+      out.pointspancolors[p] = nspans[c] - 1;
+      span_size[c]++;
     }
-    for (int64_t p = 0; p < conf.np; p++) {
-      assert(pointspancolors_vec[p] != -1ll);
-    }
+    nspans_points = *std::max_element(nspans.begin(), nspans.end());
   }
 }
 
@@ -865,99 +640,112 @@ void generate_mesh_raw(
   conf.stripsize = conf_stripsize;
   conf.spansize = conf_spansize;
 
-  std::vector<double> pointpos_x_vec;
-  std::vector<double> pointpos_y_vec;
-  std::vector<int64_t> pointcolors_vec;
-  std::map<int64_t, std::vector<int64_t> > pointmcolors_map;
-  std::vector<int64_t> zonestart_vec;
-  std::vector<int64_t> zonesize_vec;
-  std::vector<int64_t> zonepoints_vec;
-  std::vector<int64_t> zonecolors_vec;
-
-  generate_mesh(conf,
-                pointpos_x_vec,
-                pointpos_y_vec,
-                pointcolors_vec,
-                pointmcolors_map,
-                zonestart_vec,
-                zonesize_vec,
-                zonepoints_vec,
-                zonecolors_vec);
+  mesh_buffers out;
+  out.pointpos_x = pointpos_x;
+  out.pointpos_y = pointpos_y;
+  out.pointcolors = pointcolors;
+  out.pointmcolors = pointmcolors;
+  out.pointspancolors = pointspancolors;
+  out.zonestart = zonestart;
+  out.zonesize = zonesize;
+  out.zonepoints = zonepoints;
+  out.zonecolors = zonecolors;
+  out.zonespancolors = zonespancolors;
+
+  int nthreads = mesh_threads();
+  printf("Generating mesh with %d threads...\n", nthreads);
+  phase_timer timer;
+
+  mesh_rows m;
+  calc_mesh_rows(conf, m);
+  int64_t color_words = int64_t(ceil(conf_npieces/64.0));
 
+  assert(size_t(conf.np) <= *pointpos_x_size);
+  assert(size_t(conf.np) <= *pointpos_y_size);
+  assert(size_t(conf.np) <= *pointcolors_size);
+  assert(size_t(conf.np*color_words) <= *pointmcolors_size);
+  assert(size_t(conf.np) <= *pointspancolors_size);
+  assert(size_t(conf.nz) <= *zonestart_size);
+  assert(size_t(conf.nz) <= *zonesize_size);
+  assert(size_t(conf.nz) <= *zonecolors_size);
+  assert(size_t(conf.nz) <= *zonespancolors_size);
+
+  // When compacting, each piece's points are made dense by sorting the
+  // points by color before any of them are written.
+  std::vector<int64_t> points_map;
   if (conf.compact) {
-    compact_mesh(conf,
-                 pointpos_x_vec,
-                 pointpos_y_vec,
-                 pointcolors_vec,
-                 pointmcolors_map,
-                 zonestart_vec,
-                 zonesize_vec,
-                 zonepoints_vec,
-                 zonecolors_vec);
+    points_map.resize(conf.np);
+    point_classifier classify = { conf.npieces, points_map.data() };
+    parallel_for(nthreads, m.npy, [&](int t, int64_t j0, int64_t j1) {
+      for (int64_t j = j0; j < j1; j++)
+        generate_point_row(conf, m, j, classify);
+    });
+    counting_sort(nthreads, conf.np, 2 * conf.npieces, points_map.data());
+    timer.phase("sort points");
   }
+  const int64_t *pmap = conf.compact ? points_map.data() : NULL;
 
-  std::vector<int64_t> zonespancolors_vec;
-  std::vector<int64_t> pointspancolors_vec;
-
-  color_spans(conf,
-              pointpos_x_vec,
-              pointpos_y_vec,
-              pointcolors_vec,
-              pointmcolors_map,
-              zonestart_vec,
-              zonesize_vec,
-              zonepoints_vec,
-              zonecolors_vec,
-              zonespancolors_vec,
-              pointspancolors_vec,
-              *nspans_zones,
-              *nspans_points);
-
-  int64_t color_words = int64_t(ceil(conf_npieces/64.0));
+  // Generate zones, each row starting after the points of earlier rows.
+  {
+    std::vector<int64_t> zpbase(conf.nzy + 1, 0);
+    parallel_for(nthreads, conf.nzy, [&](int t, int64_t j0, int64_t j1) {
+      int64_t v[6];
+      for (int64_t j = j0; j < j1; j++) {
+        for (int64_t i = 0; i < conf.nzx; i++)
+          zpbase[j+1] += zone_points(conf, m, i, j, v);
+      }
+    });
+    for (int64_t j = 0; j < conf.nzy; j++) zpbase[j+1] += zpbase[j];
+    assert(size_t(zpbase[conf.nzy]) <= *zonepoints_size);
+    *zonepoints_size = zpbase[conf.nzy];
+
+    parallel_for(nthreads, conf.nzy, [&](int t, int64_t j0, int64_t j1) {
+      generate_zone_rows(conf, m, j0, j1, zpbase[j0], pmap, out);
+    });
+    timer.phase("generate zones");
+  }
 
-  assert(pointpos_x_vec.size() <= *pointpos_x_size);
-  assert(pointpos_y_vec.size() <= *pointpos_y_size);
-  assert(pointcolors_vec.size() <= *pointcolors_size);
-  assert(pointcolors_vec.size()*color_words <= *pointmcolors_size);
-  assert(pointspancolors_vec.size() <= *pointspancolors_size);
-  assert(zonestart_vec.size() <= *zonestart_size);
-  assert(zonesize_vec.size() <= *zonesize_size);
-  assert(zonepoints_vec.size() <= *zonepoints_size);
-  assert(zonecolors_vec.size() <= *zonecolors_size);
-  assert(zonespancolors_vec.size() <= *zonespancolors_size);
-
-  memcpy(pointpos_x, pointpos_x_vec.data(), pointpos_x_vec.size()*sizeof(double));
-  memcpy(pointpos_y, pointpos_y_vec.data(), pointpos_y_vec.size()*sizeof(double));
-  memcpy(pointcolors, pointcolors_vec.data(), pointcolors_vec.size()*sizeof(int64_t));
-  memcpy(pointspancolors, pointspancolors_vec.data(), pointspancolors_vec.size()*sizeof(int64_t));
-  memcpy(zonestart, zonestart_vec.data(), zonestart_vec.size()*sizeof(int64_t));
-  memcpy(zonesize, zonesize_vec.data(), zonesize_vec.size()*sizeof(int64_t));
-  memcpy(zonepoints, zonepoints_vec.data(), zonepoints_vec.size()*sizeof(int64_t));
-  memcpy(zonecolors, zonecolors_vec.data(), zonecolors_vec.size()*sizeof(int64_t));
-  memcpy(zonespancolors, zonespancolors_vec.data(), zonespancolors_vec.size()*sizeof(int64_t));
+  // When compacting, sort zones by color (or into strips by color). Zone
+  // points stay where they are, so zonestart keeps its old values.
+  if (conf.compact) {
+    std::vector<int64_t> zones_map;
+    if (conf.stripsize > 0) {
+      sort_zones_by_color_strip(conf, zonestart, zonesize, zonepoints,
+                                zonecolors, zones_map);
+    } else {
+      zones_map.assign(zonecolors, zonecolors + conf.nz);
+      counting_sort(nthreads, conf.nz, conf.npieces, zones_map.data());
+    }
+    std::vector<int64_t> scratch;
+    permute(nthreads, conf.nz, zones_map.data(), zonestart, scratch);
+    permute(nthreads, conf.nz, zones_map.data(), zonesize, scratch);
+    permute(nthreads, conf.nz, zones_map.data(), zonecolors, scratch);
+    timer.phase("sort zones");
+  }
 
+  // Generate points.
   memset(pointmcolors, 0, (*pointmcolors_size)*sizeof(uint64_t));
-  for (std::map<int64_t, std::vector<int64_t> >::iterator it = pointmcolors_map.begin(),
-         ie = pointmcolors_map.end(); it != ie; ++it) {
-    int64_t p = it->first;
-    for (std::vector<int64_t>::iterator ct = it->second.begin(),
-           ce = it->second.end(); ct != ce; ++ct) {
-      int64_t word = (*ct) / 64.0;
-      int64_t bit = (*ct) % 64;
-      pointmcolors[p + word] |= (1 << bit);
-    }
+  {
+    point_writer write = { &out, pmap };
+    parallel_for(nthreads, m.npy, [&](int t, int64_t j0, int64_t j1) {
+      for (int64_t j = j0; j < j1; j++)
+        generate_point_row(conf, m, j, write);
+    });
+    timer.phase("generate points");
   }
 
-  *pointpos_x_size = pointpos_x_vec.size();
-  *pointpos_y_size = pointpos_y_vec.size();
-  *pointcolors_size = pointcolors_vec.size();
-  *pointmcolors_size = pointcolors_vec.size()*color_words;
-  *pointspancolors_size = pointspancolors_vec.size();
-  *zonestart_size = zonestart_vec.size();
-  *zonesize_size = zonesize_vec.size();
-  *zonepoints_size = zonepoints_vec.size();
-  *zonecolors_size = zonecolors_vec.size();
-  *zonespancolors_size = zonespancolors_vec.size();
+  color_spans(conf, out, *nspans_zones, *nspans_points);
+  timer.phase("color spans");
+
+  *pointpos_x_size = conf.np;
+  *pointpos_y_size = conf.np;
+  *pointcolors_size = conf.np;
+  *pointmcolors_size = conf.np*color_words;
+  *pointspancolors_size = conf.np;
+  *zonestart_size = conf.nz;
+  *zonesize_size = conf.nz;
+  *zonecolors_size = conf.nz;
+  *zonespancolors_size = conf.nz;
 }
 
 ///
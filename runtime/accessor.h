@@ -30,6 +30,8 @@
 
 // for fprintf
 #include <stdio.h>
+// for memcpy
+#include <string.h>
 
 using namespace LegionRuntime::Arrays;
 
@@ -189,13 +191,13 @@ namespace LegionRuntime {
       struct Generic {
 	struct Untyped {
           CUDAPREFIX
-	  Untyped() : internal(0), field_offset(0) {}
+	  Untyped() : internal(0), field_offset(0), dense_base(0) {}
           CUDAPREFIX
-	  Untyped(void *_internal, off_t _field_offset = 0) : internal(_internal), field_offset(_field_offset) {}
+	  Untyped(void *_internal, off_t _field_offset = 0) : internal(_internal), field_offset(_field_offset), dense_base(0) {}
 
 	  template <typename ET>
 	  RegionAccessor<Generic, ET, ET> typeify(void) const {
-	    RegionAccessor<Generic, ET, ET> result(Typed<ET, ET>(internal, field_offset));
+	    RegionAccessor<Generic, ET, ET> result(Typed<ET, ET>(*this));
 #if defined(PRIVILEGE_CHECKS) || defined(BOUNDS_CHECKS)
             result.set_region(region);
 #endif
@@ -213,7 +215,38 @@ namespace LegionRuntime {
 
 	  RegionAccessor<Generic, void, void> get_untyped_field_accessor(off_t _field_offset, size_t _field_size)
 	  {
-	    return RegionAccessor<Generic, void, void>(Untyped(internal, field_offset + _field_offset));
+	    Untyped field(internal, field_offset + _field_offset);
+	    field.find_dense_layout();
+	    return RegionAccessor<Generic, void, void>(field);
+	  }
+
+	  // looks (without blocking) for a layout of the instance that can be
+	  //  addressed directly - AOS, SOA or hybrid SOA in CPU-visible memory
+	  //  - and if it finds one, reads and writes of single elements below
+	  //  skip the calls into the runtime
+	  void find_dense_layout(void);
+
+	  // address of 'bytes' bytes at 'offset' in the element 'ptr', or NULL
+	  //  if the instance didn't have a direct layout (or the access falls
+	  //  outside the field)
+	  inline char *dense_elem_ptr(ptr_t ptr, size_t bytes, off_t offset = 0) const
+	  {
+	    if(!dense_base || ((size_t)(offset + bytes) > dense_field_bytes))
+	      return 0;
+	    off_t index = ptr.value + dense_index_offset;
+	    if(dense_block_size == 0)
+	      return dense_base + (index * dense_stride) + offset;
+	    return (dense_base +
+		    ((index / dense_block_size) * dense_block_stride) +
+		    ((index % dense_block_size) * dense_stride) +
+		    offset);
+	  }
+
+	  // no direct path for domain points yet
+	  template <typename PTRTYPE>
+	  inline char *dense_elem_ptr(const PTRTYPE& ptr, size_t bytes, off_t offset = 0) const
+	  {
+	    return 0;
 	  }
 
 	  void *raw_span_ptr(ptr_t ptr, size_t req_count, size_t& act_count, ByteOffset& stride);
@@ -234,6 +267,18 @@ namespace LegionRuntime {
 
 	  void *internal;
 	  off_t field_offset;
+
+	  // the direct layout found by find_dense_layout (dense_base is NULL if
+	  //  there isn't one) - element i of the instance is at
+	  //  dense_base + (i / dense_block_size) * dense_block_stride +
+	  //  (i % dense_block_size) * dense_stride, or simply
+	  //  dense_base + i * dense_stride if dense_block_size is 0
+	  char *dense_base;
+	  off_t dense_stride;
+	  off_t dense_block_size;
+	  off_t dense_block_stride;
+	  off_t dense_index_offset;  // index of ptr_t p is p.value + dense_index_offset
+	  size_t dense_field_bytes;  // bytes addressable from field_offset in each element
 #if defined(PRIVILEGE_CHECKS) || defined(BOUNDS_CHECKS) 
         protected:
           void *region;
@@ -264,6 +309,7 @@ namespace LegionRuntime {
 	  Typed() : Untyped() {}
           CUDAPREFIX
 	  Typed(void *_internal, off_t _field_offset = 0) : Untyped(_internal, _field_offset) {}
+	  Typed(const Untyped& untyped) : Untyped(untyped) {}
 
           bool valid(void) const { return internal != 0; }
 
@@ -283,7 +329,13 @@ namespace LegionRuntime {
 #ifdef BOUNDS_CHECKS 
             check_bounds(region , ptr);
 #endif
-            T val; read_untyped(ptr, &val, sizeof(val)); return val; 
+            T val;
+	    const char *src = dense_elem_ptr(ptr, sizeof(val));
+	    if(src)
+	      memcpy(&val, src, sizeof(val));
+	    else
+	      read_untyped(ptr, &val, sizeof(val));
+	    return val; 
           }
 
 	  template <typename PTRTYPE>
@@ -295,12 +347,33 @@ namespace LegionRuntime {
 #ifdef BOUNDS_CHECKS 
             check_bounds(region, ptr);
 #endif
-            write_untyped(ptr, &newval, sizeof(newval)); 
+	    char *dst = dense_elem_ptr(ptr, sizeof(newval));
+	    if(dst)
+	      memcpy(dst, &newval, sizeof(newval));
+	    else
+	      write_untyped(ptr, &newval, sizeof(newval)); 
           }
 
 	  T *raw_span_ptr(ptr_t ptr, size_t req_count, size_t& act_count, ByteOffset& offset)
 	  { return (T*)(Untyped::raw_span_ptr(ptr, req_count, act_count, offset)); }
 
+	  // if the 'count' elements starting at 'ptr' (e.g. a span from an
+	  //  IndexIterator) sit next to each other in memory, returns a pointer
+	  //  to the first, so that a loop over the span is a plain array loop
+	  //  the compiler can vectorize - otherwise returns NULL
+	  T *dense_span_ptr(ptr_t ptr, size_t count) const
+	  {
+	    if(!dense_base || (dense_stride != (off_t)sizeof(T)) ||
+	       (dense_field_bytes < sizeof(T)))
+	      return 0;
+	    if(dense_block_size != 0) {
+	      off_t index = ptr.value + dense_index_offset;
+	      if(((index % dense_block_size) + (off_t)count) > dense_block_size)
+		return 0;
+	    }
+	    return (T *)dense_elem_ptr(ptr, sizeof(T));
+	  }
+
 	  template <int DIM>
 	  T *raw_rect_ptr(const Rect<DIM>& r, Rect<DIM> &subrect, ByteOffset *offsets)
 	  { return (T*)(Untyped::raw_rect_ptr<DIM>(r, subrect, offsets)); }
@@ -27,6 +27,7 @@
 #endif
 
 #include "lowlevel_impl.h"
+#include "realm/perf_counters.h"
 
 #define NO_DEBUG_AMREQUESTS
 
@@ -767,7 +768,10 @@ void IncomingMessageManager::handler_thread_loop(void)
       int timing_idx = detailed_message_timing.get_next_index(); // grab this while we still hold the lock
       CurrentTime start_time;
 #endif
-      current_msg->run_handler();
+      {
+	Realm::RuntimeOverhead::ScopedTimer t(Realm::RuntimeOverhead::MESSAGE_HANDLER);
+	current_msg->run_handler();
+      }
 #ifdef DETAILED_MESSAGE_TIMING
       detailed_message_timing.record(timing_idx, 
 				     current_msg->get_peer(),
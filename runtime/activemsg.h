@@ -55,6 +55,8 @@
       BARRIER_ADJUST_MSGID,
       BARRIER_SUBSCRIBE_MSGID,
       BARRIER_TRIGGER_MSGID,
+      BARRIER_COMBINE_MSGID,
+      BARRIER_COMBINE_ACK_MSGID,
       METADATA_REQUEST_MSGID,
       METADATA_RESPONSE_MSGID, // should really be a reply
       METADATA_INVALIDATE_MSGID,
@@ -36,6 +36,7 @@ namespace LegionRuntime {
       COMPOSITE_HANDLE_REF,
       PERSISTENCE_REF,
       INITIAL_CREATION_REF,
+      INLINE_MAPPING_REF,
       LAST_SOURCE_REF,
     };
 
@@ -59,6 +60,7 @@ namespace LegionRuntime {
       "Composite Handle Reference",                 \
       "Persistent Reference",                       \
       "Initial Creation Reference",                 \
+      "Inline Mapping Reference",                   \
     }
 
     extern Logger::Category log_garbage;
@@ -2052,6 +2052,32 @@ namespace LegionRuntime {
     {
     }
 
+    //--------------------------------------------------------------------------
+    void ProjectionFunctor::project_points(Context ctx, Task *task,
+                                           unsigned index,
+                                           LogicalRegion upper_bound,
+                                        const std::vector<DomainPoint> &points,
+                                        std::vector<LogicalRegion> &results)
+    //--------------------------------------------------------------------------
+    {
+      results.resize(points.size());
+      for (unsigned idx = 0; idx < points.size(); idx++)
+        results[idx] = project(ctx, task, index, upper_bound, points[idx]);
+    }
+
+    //--------------------------------------------------------------------------
+    void ProjectionFunctor::project_points(Context ctx, Task *task,
+                                           unsigned index,
+                                           LogicalPartition upper_bound,
+                                        const std::vector<DomainPoint> &points,
+                                        std::vector<LogicalRegion> &results)
+    //--------------------------------------------------------------------------
+    {
+      results.resize(points.size());
+      for (unsigned idx = 0; idx < points.size(); idx++)
+        results[idx] = project(ctx, task, index, upper_bound, points[idx]);
+    }
+
     /////////////////////////////////////////////////////////////
     // Coloring Serializer 
     /////////////////////////////////////////////////////////////
@@ -2899,6 +2925,14 @@ namespace LegionRuntime {
       return runtime->execute_index_space(ctx, launcher, redop);
     }
 
+    //--------------------------------------------------------------------------
+    Future HighLevelRuntime::reduce_future_map(Context ctx, 
+                             const FutureMap &future_map, ReductionOpID redop)
+    //--------------------------------------------------------------------------
+    {
+      return runtime->reduce_future_map(ctx, future_map, redop);
+    }
+
     //--------------------------------------------------------------------------
     Future HighLevelRuntime::execute_task(Context ctx, 
                         Processor::TaskFuncID task_id,
@@ -4076,6 +4110,14 @@ namespace LegionRuntime {
                                                      const_cast<Mapper*>(this));
     }
 
+    //--------------------------------------------------------------------------
+    void Mapper::sample_speculation_statistics(
+                                           SpeculationStatistics &stats) const
+    //--------------------------------------------------------------------------
+    {
+      runtime->runtime->sample_speculation_statistics(stats);
+    }
+
   }; // namespace HighLevel
 }; // namespace LegionRuntime
 
@@ -1587,6 +1587,14 @@ namespace LegionRuntime {
      * associated with a task.  In many cases the referenced
      * pointers are annotated const so that this data cannot
      * be corrupted by the application.
+     *
+     * The buffers pointed to by args and local_args are read-only.
+     * Every task on a node that came from the same launch (the
+     * points and slices of an index space launch) points at the
+     * same copy of the global argument, and point tasks borrow
+     * their local argument from the launch's argument map, so
+     * writing through either pointer is visible to other tasks.
+     * Copy the arguments first if a task needs to modify them.
      */
     class Task : public Mappable {
     protected:
@@ -1601,7 +1609,7 @@ namespace LegionRuntime {
       std::vector<Grant>                  grants;
       std::vector<PhaseBarrier>           wait_barriers;
       std::vector<PhaseBarrier>           arrive_barriers;
-      void                               *args;                         
+      void                               *args; // read-only
       size_t                              arglen;
     public:
       // Index task argument information
@@ -1609,7 +1617,7 @@ namespace LegionRuntime {
       bool                                must_parallelism; 
       Domain                              index_domain;
       DomainPoint                         index_point;
-      void                               *local_args;
+      void                               *local_args; // read-only
       size_t                              local_arglen;
     public:
       // Meta data information from the runtime
@@ -2548,7 +2556,11 @@ namespace LegionRuntime {
        * be.  If the call returns false, then the result of
        * spec_value will be ignored by the runtime and 
        * anything depending on the predicate will block until
-       * it resolves.
+       * it resolves.  The runtime currently only acts on guesses
+       * that the predicate is true: the operation is mapped and
+       * run right away with everything it writes shadowed, and
+       * is rolled back if the predicate turns out to be false.
+       * Guesses that the predicate is false are ignored.
        * @param op the op that is predicated
        * @param spec_value the speculative value to be
        *    set if the mapper is going to speculate
@@ -2780,6 +2792,15 @@ namespace LegionRuntime {
        * @return the count of the tasks assigned to the processor but unmapped
        */
       unsigned sample_unmapped_tasks(Processor p) const;
+
+      /**
+       * Take a sample of how well speculation on predicates has
+       * worked out so far for operations launched in the local
+       * address space. Like the other samples the counts can
+       * change between consecutive calls.
+       * @param stats the statistics to fill in
+       */
+      void sample_speculation_statistics(SpeculationStatistics &stats) const;
     };
 
     //==========================================================================
@@ -2808,6 +2829,27 @@ namespace LegionRuntime {
       int argc;
     };
 
+    /**
+     * \struct SpeculationStatistics
+     * Counts of the operations that were started before their
+     * predicates resolved, how many of those guesses turned out
+     * to be right, and how much work was rolled back for the
+     * ones that did not.
+     */
+    struct SpeculationStatistics {
+    public:
+      SpeculationStatistics(void)
+        : speculated(0), hits(0), misses(0), wasted_tasks(0),
+          wasted_copies(0), wasted_time(0) { }
+    public:
+      unsigned long long speculated;
+      unsigned long long hits;
+      unsigned long long misses;
+      unsigned long long wasted_tasks;
+      unsigned long long wasted_copies;
+      unsigned long long wasted_time; // microseconds of rolled back tasks
+    };
+
     /**
      * \struct TaskConfigOptions
      * A class for describing the configuration options
@@ -2881,6 +2923,42 @@ namespace LegionRuntime {
                                     unsigned index,
                                     LogicalPartition upper_bound,
                                     const DomainPoint &point) = 0;
+    public:
+      /**
+       * Compute the projections for all the points of an index
+       * space task launch at once.  The default implementations
+       * call 'project' for each point.  Functors that can compute
+       * many projections more cheaply together than one at a
+       * time should override them.
+       * @param ctx the context for this projection
+       * @param task the task for the requested projection
+       * @param index which region requirement we are projecting
+       * @param upper_bound the upper bound logical region
+       * @param points the points of the task in the index space
+       * @param results the logical region for each point, which
+       *          is resized to match the number of points
+       */
+      virtual void project_points(Context ctx, Task *task,
+                                  unsigned index,
+                                  LogicalRegion upper_bound,
+                                  const std::vector<DomainPoint> &points,
+                                  std::vector<LogicalRegion> &results);
+      /**
+       * Compute the projections for all the points of an index
+       * space task launch from a logical partition at once.
+       * @param ctx the context for this projection
+       * @param task the task for the requested projection
+       * @param index which region requirement we are projecting
+       * @param upper_bound the upper bound logical partition
+       * @param points the points of the task in the index space
+       * @param results the logical region for each point, which
+       *          is resized to match the number of points
+       */
+      virtual void project_points(Context ctx, Task *task,
+                                  unsigned index,
+                                  LogicalPartition upper_bound,
+                                  const std::vector<DomainPoint> &points,
+                                  std::vector<LogicalRegion> &results);
     protected:
       HighLevelRuntime *const runtime;
     };
@@ -3997,6 +4075,22 @@ namespace LegionRuntime {
       Future execute_index_space(Context ctx, const IndexLauncher &launcher,
                                  ReductionOpID redop);
 
+      /**
+       * Reduce all of the values in a future map down to a single
+       * future using the given reduction operator.  This call does
+       * not block; the values are folded by the runtime once all the
+       * points in the future map are ready.  Note that index space
+       * launches that only need the reduced value should prefer the
+       * execute_index_space variant that takes a reduction operator
+       * which folds values on each node before sending them back.
+       * @param ctx enclosing task context
+       * @param future_map the future map to be reduced
+       * @param redop ID for the reduction op to use for reducing values
+       * @return a future containing the reduction of all the values
+       */
+      Future reduce_future_map(Context ctx, const FutureMap &future_map,
+                               ReductionOpID redop);
+
       /**
        * @deprecated
        * An older method for launching a single task maintained for backwards
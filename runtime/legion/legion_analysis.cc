@@ -6805,6 +6805,130 @@ namespace LegionRuntime {
       local = false;
     }
 
+    /////////////////////////////////////////////////////////////
+    // ShadowInstance
+    /////////////////////////////////////////////////////////////
+
+    //--------------------------------------------------------------------------
+    ShadowInstance::ShadowInstance(void)
+      : snapshot_instance(PhysicalInstance::NO_INST), scratch(NULL),
+        fold(false), ready_event(Event::NO_EVENT)
+    //--------------------------------------------------------------------------
+    {
+    }
+
+    //--------------------------------------------------------------------------
+    bool ShadowInstance::allocate_undo(RegionTreeForest *forest,
+                                       const RegionRequirement &req,
+                                       InstanceManager *manager, 
+                                       UniqueID op_id)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_HIGH_LEVEL
+      assert(!snapshot_instance.exists());
+      assert(scratch == NULL);
+#endif
+      RegionNode *node = forest->get_node(req.region);
+      domain = node->get_domain_blocking();
+      FieldMask mask = node->column_source->get_field_mask(req.privilege_fields);
+      manager->compute_copy_offsets(mask, instance_fields);
+      std::vector<size_t> field_sizes(instance_fields.size());
+      for (unsigned idx = 0; idx < instance_fields.size(); idx++)
+        field_sizes[idx] = instance_fields[idx].size;
+      // Make the snapshot the same shape as the instance so that
+      // the copies in and out of it stay simple
+      snapshot_instance = forest->create_instance(
+                            manager->region_node->get_domain_blocking(),
+                            manager->memory, field_sizes,
+                            manager->layout->blocking_factor, op_id);
+      if (!snapshot_instance.exists())
+      {
+        instance_fields.clear();
+        return false;
+      }
+      // The snapshot packs the fields densely in the same order
+      unsigned offset = 0;
+      for (unsigned idx = 0; idx < field_sizes.size(); idx++)
+      {
+        shadow_fields.push_back(Domain::CopySrcDstField(snapshot_instance, 
+                                                  offset, field_sizes[idx]));
+        offset += field_sizes[idx];
+      }
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    void ShadowInstance::record_redo(const RegionRequirement &req,
+                                     ReductionManager *scratch_manager,
+                                     ReductionView *target)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_HIGH_LEVEL
+      assert(!snapshot_instance.exists());
+      assert(scratch == NULL);
+      assert(scratch_manager->redop == target->manager->redop);
+#endif
+      scratch = scratch_manager;
+      domain = scratch->region_node->get_domain_blocking();
+      FieldMask mask = 
+        scratch->region_node->column_source->get_field_mask(
+                                                    req.privilege_fields);
+      fold = target->reduce_to(scratch->redop, mask, instance_fields);
+      scratch->find_field_offsets(mask, shadow_fields);
+    }
+
+    //--------------------------------------------------------------------------
+    Event ShadowInstance::snapshot(RegionTreeForest *forest, Operation *op,
+                                   Event precondition)
+    //--------------------------------------------------------------------------
+    {
+      // Scratch instances start out empty so there is nothing to save
+      if (!snapshot_instance.exists())
+        return Event::NO_EVENT;
+      ready_event = forest->issue_copy(domain, op, instance_fields,
+                                       shadow_fields, precondition);
+      return ready_event;
+    }
+
+    //--------------------------------------------------------------------------
+    Event ShadowInstance::commit(Operation *op, Event precondition)
+    //--------------------------------------------------------------------------
+    {
+      if (scratch == NULL)
+        return Event::NO_EVENT;
+      return scratch->issue_reduction(op, shadow_fields, instance_fields,
+                                      domain, precondition, fold,
+                                      true/*precise*/);
+    }
+
+    //--------------------------------------------------------------------------
+    Event ShadowInstance::rollback(RegionTreeForest *forest, Operation *op,
+                                   Event precondition)
+    //--------------------------------------------------------------------------
+    {
+      if (!snapshot_instance.exists())
+        return Event::NO_EVENT;
+      return forest->issue_copy(domain, op, shadow_fields, instance_fields,
+                     Event::merge_events(precondition, ready_event));
+    }
+
+    //--------------------------------------------------------------------------
+    void ShadowInstance::release(Event precondition)
+    //--------------------------------------------------------------------------
+    {
+      // Scratch instances are owned by their views which keep
+      // them alive until the operation's termination event
+      if (snapshot_instance.exists())
+      {
+        snapshot_instance.destroy(
+            Event::merge_events(precondition, ready_event));
+        snapshot_instance = PhysicalInstance::NO_INST;
+      }
+      scratch = NULL;
+      instance_fields.clear();
+      shadow_fields.clear();
+    }
+
   }; // namespace HighLevel
 }; // namespace LegionRuntime
 
@@ -1182,6 +1182,43 @@ namespace LegionRuntime {
       bool local;
     };
 
+    /**
+     * \class ShadowInstance
+     * A shadow instance lets a speculative operation be undone.
+     * Instances that the operation writes are snapshotted right
+     * before it runs and the snapshot is copied back over them
+     * if the predicate resolves the other way.  Reductions go to
+     * a scratch instance instead which only gets folded into the
+     * real instance once the guess has been confirmed, since the
+     * real instance might be shared with other reducers.
+     */
+    class ShadowInstance {
+    public:
+      ShadowInstance(void);
+    public:
+      // Returns false if there is no room for the snapshot
+      bool allocate_undo(RegionTreeForest *forest, const RegionRequirement &req,
+                         InstanceManager *manager, UniqueID op_id);
+      void record_redo(const RegionRequirement &req, 
+                       ReductionManager *scratch, ReductionView *target);
+    public:
+      Event snapshot(RegionTreeForest *forest, Operation *op,
+                     Event precondition);
+      Event commit(Operation *op, Event precondition);
+      Event rollback(RegionTreeForest *forest, Operation *op,
+                     Event precondition);
+      void release(Event precondition);
+    private:
+      Domain domain;
+      // Only one of these is set depending on the kind of shadow
+      PhysicalInstance snapshot_instance;
+      ReductionManager *scratch;
+      bool fold;
+      std::vector<Domain::CopySrcDstField> instance_fields;
+      std::vector<Domain::CopySrcDstField> shadow_fields;
+      Event ready_event;
+    };
+
     /**
      * \class PremapTraverser
      * A traverser of the physical region tree for
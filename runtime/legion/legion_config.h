@@ -81,6 +81,47 @@
 #ifndef DEFAULT_SUPERSCALAR_WIDTH
 #define DEFAULT_SUPERSCALAR_WIDTH       4
 #endif
+// Maximum number of ready tasks per mapper considered by
+// a single pass of the task scheduler
+#ifndef DEFAULT_MAX_SCHEDULE_BATCH
+#define DEFAULT_MAX_SCHEDULE_BATCH      256
+#endif
+// Maximum number of ready-to-map tasks that are triggered
+// together by a single runtime meta-task
+#ifndef DEFAULT_MAX_TRIGGER_BATCH
+#define DEFAULT_MAX_TRIGGER_BATCH       16
+#endif
+// Fan-out of the tree used to broadcast future values to remote
+// nodes; a value of zero sends directly from the owner to every node
+#ifndef DEFAULT_FUTURE_BROADCAST_RADIX
+#define DEFAULT_FUTURE_BROADCAST_RADIX  4
+#endif
+// Fan-out of the tree of meta-tasks that checks and distributes
+// the per-node groups of tasks in a must epoch launch
+#ifndef DEFAULT_MUST_EPOCH_RADIX
+#define DEFAULT_MUST_EPOCH_RADIX        4
+#endif
+// Number of bounding boxes swept by each meta-task when
+// computing which children of a partition are disjoint
+#ifndef DEFAULT_DISJOINTNESS_SWEEP_CHUNK
+#define DEFAULT_DISJOINTNESS_SWEEP_CHUNK 1024
+#endif
+// Number of elements of the parent index space handled by each
+// meta-task when building an equal or weighted partition
+#ifndef DEFAULT_PARTITION_CHUNK
+#define DEFAULT_PARTITION_CHUNK (1 << 22)
+#endif
+// Number of children a partition needs before intersection
+// tests against it go through a spatial index of its children
+#ifndef DEFAULT_SUBSPACE_INDEX_THRESHOLD
+#define DEFAULT_SUBSPACE_INDEX_THRESHOLD 64
+#endif
+// Number of unmapped inline mappings each task context holds onto
+// so that remapping the same region can skip the mapper and the
+// region tree traversal
+#ifndef DEFAULT_INLINE_MAPPING_CACHE
+#define DEFAULT_INLINE_MAPPING_CACHE    16
+#endif
 // The maximum size of active messages sent by the runtime in bytes
 // Note this value was picked based on making a tradeoff between
 // latency and bandwidth numbers on both Cray and Infiniband
@@ -88,6 +129,11 @@
 #ifndef DEFAULT_MAX_MESSAGE_SIZE
 #define DEFAULT_MAX_MESSAGE_SIZE        16384
 #endif
+// Initial size in bytes of the buffers used for serializing
+// runtime data structures; they grow on demand past this
+#ifndef DEFAULT_SERIALIZER_SIZE
+#define DEFAULT_SERIALIZER_SIZE         4096
+#endif
 // Maximum number of tasks in logical region node before consolidation
 #ifndef DEFAULT_MAX_FILTER_SIZE
 #define DEFAULT_MAX_FILTER_SIZE         0
@@ -1130,13 +1130,20 @@ namespace LegionRuntime {
       speculation_state = RESOLVE_TRUE_STATE;
       predicate = NULL;
       received_trigger_resolution = false;
+      mispredicted = false;
       predicate_waiter = UserEvent::NO_USER_EVENT;
+      speculative_executions = 0;
+      speculative_time = 0;
     }
 
     //--------------------------------------------------------------------------
     void SpeculativeOp::deactivate_speculative(void)
     //--------------------------------------------------------------------------
     {
+#ifdef DEBUG_HIGH_LEVEL
+      assert(speculative_shadows.empty());
+      assert(speculative_terminations.empty());
+#endif
       deactivate_operation();
     }
 
@@ -1252,8 +1259,11 @@ namespace LegionRuntime {
       // Now that we've attempted to register ourselves with the
       // predicate we can remove the predicate reference
       predicate->remove_predicate_reference();
+      // We only ever act on guesses that the predicate will be true,
+      // guessing false would mean skipping the operation and then
+      // having to restart it from scratch on a mispredict
       if (!valid)
-        speculated = speculate(value);
+        speculated = speculate(value) && value;
       // Now hold the lock and figure out what we should do
       bool continue_true = false;
       bool continue_false = false;
@@ -1282,16 +1292,8 @@ namespace LegionRuntime {
               }
               else if (speculated)
               {
-                if (value)
-                {
-                  speculation_state = SPECULATE_TRUE_STATE;
-                  continue_true = true;
-                }
-                else
-                {
-                  speculation_state = SPECULATE_FALSE_STATE;
-                  continue_false = true;
-                }
+                speculation_state = SPECULATE_TRUE_STATE;
+                continue_true = true;
               }
               // Otherwise just stay in pending map state
               break;
@@ -1315,6 +1317,8 @@ namespace LegionRuntime {
       // Now do what we need to do
       if (need_trigger)
         predicate_waiter.trigger();
+      if (speculated && continue_true)
+        runtime->record_speculation_started();
       if (continue_true)
         resolve_true();
       if (continue_false)
@@ -1357,6 +1361,7 @@ namespace LegionRuntime {
       bool restart = false;
       bool need_resolve = false;
       bool need_trigger = false;
+      bool speculation_done = false;
       {
         AutoLock o_lock(op_lock);
 #ifdef DEBUG_HIGH_LEVEL
@@ -1383,17 +1388,18 @@ namespace LegionRuntime {
           case SPECULATE_TRUE_STATE:
             {
               if (value) // We guessed right
-              {
                 speculation_state = RESOLVE_TRUE_STATE;
-                need_resolve = received_trigger_resolution;
-              }
               else
               {
-                // We guessed wrong
+                // We guessed wrong, but everything the operation
+                // writes is shadowed so it can keep going and roll
+                // itself back when it completes
                 speculation_state = RESOLVE_FALSE_STATE;
-                need_mispredict = true;
-                restart = false;
+                mispredicted = true;
               }
+              need_resolve = received_trigger_resolution;
+              need_trigger = predicate_waiter.exists();
+              speculation_done = true;
               break;
             }
           case SPECULATE_FALSE_STATE:
@@ -1417,6 +1423,8 @@ namespace LegionRuntime {
       }
       if (need_trigger)
         predicate_waiter.trigger();
+      if (speculation_done)
+        runtime->record_speculation_resolved(value);
       if (continue_true)
         resolve_true();
       if (continue_false)
@@ -1427,6 +1435,89 @@ namespace LegionRuntime {
         resolve_speculation();
     }
 
+    //--------------------------------------------------------------------------
+    bool SpeculativeOp::is_speculative(void) const
+    //--------------------------------------------------------------------------
+    {
+      if (predicate == NULL)
+        return false;
+      AutoLock o_lock(op_lock);
+      return ((speculation_state == SPECULATE_TRUE_STATE) || mispredicted);
+    }
+
+    //--------------------------------------------------------------------------
+    void SpeculativeOp::record_speculative_execution(
+                                     const std::vector<ShadowInstance> &shadows,
+                                     UserEvent termination, Event executed)
+    //--------------------------------------------------------------------------
+    {
+      AutoLock o_lock(op_lock);
+      speculative_shadows.insert(speculative_shadows.end(),
+                                 shadows.begin(), shadows.end());
+      speculative_terminations.push_back(
+          std::pair<UserEvent,Event>(termination, executed));
+      speculative_executions++;
+    }
+
+    //--------------------------------------------------------------------------
+    void SpeculativeOp::record_speculative_time(long long time_in_us)
+    //--------------------------------------------------------------------------
+    {
+      AutoLock o_lock(op_lock);
+      speculative_time += time_in_us;
+    }
+
+    //--------------------------------------------------------------------------
+    Event SpeculativeOp::finalize_speculation(void)
+    //--------------------------------------------------------------------------
+    {
+      // The predicate has resolved and everything has finished
+      // executing so nobody else is going to be adding to these
+      if (speculative_terminations.empty())
+        return Event::NO_EVENT;
+      std::set<Event> executed_events;
+      for (std::vector<std::pair<UserEvent,Event> >::const_iterator it = 
+            speculative_terminations.begin(); it != 
+            speculative_terminations.end(); it++)
+        executed_events.insert(it->second);
+      Event executed = Event::merge_events(executed_events);
+      // Fold in the scratch reductions if we guessed right,
+      // otherwise put back everything that was overwritten
+      std::set<Event> finalize_events;
+      for (std::vector<ShadowInstance>::iterator it = 
+            speculative_shadows.begin(); it != 
+            speculative_shadows.end(); it++)
+      {
+        if (mispredicted)
+          finalize_events.insert(it->rollback(runtime->forest, 
+                                              this, executed));
+        else
+          finalize_events.insert(it->commit(this, executed));
+      }
+      Event finalized = Event::merge_events(finalize_events);
+      if (mispredicted)
+      {
+        if (get_operation_kind() == COPY_OP_KIND)
+          runtime->record_speculation_waste(0, speculative_executions,
+                                            speculative_time);
+        else
+          runtime->record_speculation_waste(speculative_executions, 0,
+                                            speculative_time);
+      }
+      Event done = Event::merge_events(finalized, executed);
+      for (std::vector<ShadowInstance>::iterator it = 
+            speculative_shadows.begin(); it != speculative_shadows.end(); it++)
+        it->release(done);
+      speculative_shadows.clear();
+      // Now anyone waiting on what we wrote can see the final values
+      for (std::vector<std::pair<UserEvent,Event> >::const_iterator it = 
+            speculative_terminations.begin(); it != 
+            speculative_terminations.end(); it++)
+        it->first.trigger(Event::merge_events(it->second, finalized));
+      speculative_terminations.clear();
+      return done;
+    }
+
     //--------------------------------------------------------------------------
     void SpeculativeOp::deferred_execute(void)
     //--------------------------------------------------------------------------
@@ -2626,6 +2717,15 @@ namespace LegionRuntime {
     bool CopyOp::speculate(bool &value)
     //--------------------------------------------------------------------------
     {
+      // We can only undo copies that overwrite exclusive destinations,
+      // reductions can't be snapshotted while others fold into them
+      for (unsigned idx = 0; idx < dst_requirements.size(); idx++)
+      {
+        if (IS_REDUCE(dst_requirements[idx]) || 
+            (dst_requirements[idx].prop != EXCLUSIVE) ||
+            dst_restrictions[idx].has_restrictions())
+          return false;
+      }
       Processor exec_proc = parent_ctx->get_executing_processor();
       return runtime->invoke_mapper_speculate(exec_proc, this, value);
     }
@@ -2690,6 +2790,7 @@ namespace LegionRuntime {
         return false;
       // Now ask the mapper how to map this copy operation
       bool notify = runtime->invoke_mapper_map_copy(local_proc, this);
+      const bool speculative = is_speculative();
       // Map all the destination instances
       LegionVector<MappingRef>::aligned 
                             src_mapping_refs(src_requirements.size());
@@ -2788,6 +2889,30 @@ namespace LegionRuntime {
           break;
         }
       }
+      // If we're running ahead of our predicate then make snapshots
+      // of the destinations so we can put them back if we guessed wrong
+      std::vector<ShadowInstance> shadows;
+      if (map_success && speculative)
+      {
+        shadows.resize(dst_requirements.size());
+        for (unsigned idx = 0; idx < dst_requirements.size(); idx++)
+        {
+          PhysicalManager *manager = 
+            dst_mapping_refs[idx].get_view()->get_manager();
+          if (!shadows[idx].allocate_undo(runtime->forest, 
+                dst_requirements[idx], manager->as_instance_manager(), 
+                unique_op_id))
+          {
+            map_success = false;
+            dst_requirements[idx].mapping_failed = true;
+            dst_requirements[idx].selected_memory = Memory::NO_MEMORY;
+            for (unsigned idx2 = 0; idx2 < idx; idx2++)
+              shadows[idx2].release(Event::NO_EVENT);
+            shadows.clear();
+            break;
+          }
+        }
+      }
 
       // If we successfully mapped, then we can issue the copies
       // These should be guaranteed to succeed since no new 
@@ -2867,6 +2992,12 @@ namespace LegionRuntime {
           LegionSpy::log_op_user(unique_op_id, src_requirements.size()+idx,
               dst_ref.get_manager()->get_instance().id);
 #endif
+          // The copy can't start until we've saved what it overwrites
+          Event copy_precondition = sync_precondition;
+          if (speculative)
+            copy_precondition = Event::merge_events(sync_precondition,
+                shadows[idx].snapshot(runtime->forest, this, 
+                                      dst_ref.get_ready_event()));
           if (!src_mapping_refs[idx].has_ref())
           {
             // In this case, there is no source instance so we need
@@ -2879,7 +3010,7 @@ namespace LegionRuntime {
                                                    src_requirements[idx],
                                                    src_versions[idx],
                                                    dst_requirements[idx],
-                                                   dst_ref, sync_precondition));
+                                                   dst_ref, copy_precondition));
             else
               copy_complete_events.insert(runtime->forest->reduce_across(this,
                                           parent_ctx->get_executing_processor(),
@@ -2888,7 +3019,7 @@ namespace LegionRuntime {
                                                    src_requirements[idx],
                                                    src_versions[idx],
                                                    dst_requirements[idx],
-                                                   dst_ref, sync_precondition));
+                                                   dst_ref, copy_precondition));
           }
           else
           {
@@ -2927,14 +3058,14 @@ namespace LegionRuntime {
                                           dst_contexts[idx],
                                           src_requirements[idx],
                                           dst_requirements[idx],
-                                          src_ref, dst_ref, sync_precondition));
+                                          src_ref, dst_ref, copy_precondition));
             else
               copy_complete_events.insert(
                   runtime->forest->reduce_across(this, dst_contexts[idx],
                                           dst_contexts[idx],
                                           src_requirements[idx],
                                           dst_requirements[idx],
-                                          src_ref, dst_ref, sync_precondition));
+                                          src_ref, dst_ref, copy_precondition));
 #ifdef LEGION_SPY
             start_events.insert(src_ref.get_ready_event());
             LegionSpy::log_op_user(unique_op_id, idx,
@@ -2983,13 +3114,16 @@ namespace LegionRuntime {
         }
 #endif
         // Chain all the unlock and barrier arrivals off of the
-        // copy complete event
+        // copy complete event, or our completion if we're speculative
+        // since we can't take back an arrival
         if (!arrive_barriers.empty())
         {
+          const Event arrive_event = 
+            speculative ? Event(completion_event) : copy_complete_event;
           for (std::vector<PhaseBarrier>::const_iterator it = 
                 arrive_barriers.begin(); it != arrive_barriers.end(); it++)
           {
-            it->phase_barrier.arrive(1/*count*/, copy_complete_event);    
+            it->phase_barrier.arrive(1/*count*/, arrive_event);    
 #ifdef LEGION_LOGGING
             LegionLogging::log_event_dependence(
                 Processor::get_executing_processor(),       
@@ -3021,8 +3155,13 @@ namespace LegionRuntime {
         LegionSpy::log_event_dependence(copy_complete_event,
                                         completion_event);
 #endif
-        // Handle the case for marking when the copy completes
-        completion_event.trigger(copy_complete_event);
+        // Handle the case for marking when the copy completes, if we're
+        // speculative then it has to wait until we've finalized
+        if (speculative)
+          record_speculative_execution(shadows, completion_event,
+                                       copy_complete_event);
+        else
+          completion_event.trigger(copy_complete_event);
         need_completion_trigger = false;
         complete_execution(copy_complete_event);
       }
@@ -3042,6 +3181,16 @@ namespace LegionRuntime {
       return map_success;
     }
 
+    //--------------------------------------------------------------------------
+    void CopyOp::trigger_complete(void)
+    //--------------------------------------------------------------------------
+    {
+      // Our predicate has resolved by now so we can commit or
+      // roll back anything that we did speculatively
+      finalize_speculation();
+      Operation::trigger_complete();
+    }
+
     //--------------------------------------------------------------------------
     void CopyOp::trigger_commit(void)
     //--------------------------------------------------------------------------
@@ -4969,8 +5118,9 @@ namespace LegionRuntime {
     bool AcquireOp::speculate(bool &value)
     //--------------------------------------------------------------------------
     {
-      Processor exec_proc = parent_ctx->get_executing_processor();
-      return runtime->invoke_mapper_speculate(exec_proc, this, value);
+      // We never speculate on acquire ops since there is no way
+      // to shadow the change in coherence if we guessed wrong
+      return false;
     }
 
     //--------------------------------------------------------------------------
@@ -5558,8 +5708,9 @@ namespace LegionRuntime {
     bool ReleaseOp::speculate(bool &value)
     //--------------------------------------------------------------------------
     {
-      Processor exec_proc = parent_ctx->get_executing_processor();
-      return runtime->invoke_mapper_speculate(exec_proc, this, value);
+      // We never speculate on release ops since there is no way
+      // to shadow the change in coherence if we guessed wrong
+      return false;
     }
 
     //--------------------------------------------------------------------------
@@ -6905,6 +7056,7 @@ namespace LegionRuntime {
       index_triggered.clear();
       slice_tasks.clear();
       single_tasks.clear();
+      single_owners.clear();
       // Remove our reference on the future map
       result_map = FutureMap();
       constraints.clear();
@@ -7072,46 +7224,6 @@ namespace LegionRuntime {
           return false;
       }
 
-      // Everybody successfully mapped so now check that all
-      // of the constraints have been satisfied
-      for (std::vector<Mapper::MappingConstraint>::const_iterator it = 
-            constraints.begin(); it != constraints.end(); it++)
-      {
-        // We know that all these tasks are single tasks
-        // so doing static casts are safe
-        SingleTask *t1 = static_cast<SingleTask*>(const_cast<Task*>(it->t1));
-        SingleTask *t2 = static_cast<SingleTask*>(const_cast<Task*>(it->t2));
-        PhysicalManager *inst1 = t1->get_instance(it->idx1);
-        PhysicalManager *inst2 = t2->get_instance(it->idx2);
-        // Check to make sure they selected the same instance 
-        if (inst1 != inst2)
-        {
-          log_run.error("MUST EPOCH ERROR: failed constraint! "
-              "Task %s (ID %lld) mapped region %d to instance " IDFMT " in "
-              "memory " IDFMT " , but task %s (ID %lld) mapped region %d to "
-              "instance " IDFMT " in memory " IDFMT ".",
-              t1->variants->name, t1->get_unique_task_id(), it->idx1,
-              inst1->get_instance().id, inst1->memory.id,
-              t2->variants->name, t2->get_unique_task_id(), it->idx2,
-              inst2->get_instance().id, inst2->memory.id);
-#ifdef DEBUG_HIGH_LEVEL
-          assert(false);
-#endif
-          exit(ERROR_MUST_EPOCH_FAILURE);
-        }
-      }
-
-      // If the mapper wanted to know on success, then tell it
-      if (notify)
-      {
-        // Notify the mappers that the tasks successfully mapped
-        for (std::deque<SingleTask*>::const_iterator it = 
-              single_tasks.begin(); it != single_tasks.end(); it++)
-        {
-          runtime->invoke_mapper_notify_result(mapper_proc, *it);
-        }
-      }
-
       // Once all the tasks have been initialized we can defer
       // our all mapped event on all their all mapped events
       std::set<Event> tasks_all_mapped;
@@ -7128,9 +7240,12 @@ namespace LegionRuntime {
         tasks_all_mapped.insert((*it)->get_mapped_event());
         tasks_all_complete.insert((*it)->get_completion_event());
       }
-      // If we passed all the constraints, then kick everything off
+      // Everybody successfully mapped so now check the constraints
+      // and kick everything off, a node's worth of tasks at a time
       MustEpochDistributor distributor(this);
-      distributor.distribute_tasks(runtime, indiv_tasks, slice_tasks);
+      distributor.distribute_tasks(runtime, indiv_tasks, slice_tasks,
+                                   single_tasks, single_owners, constraints,
+                                   mapper_proc, notify);
       
       // Mark that we are done mapping and executing this operation
       Event all_mapped = Event::merge_events(tasks_all_mapped);
@@ -7269,7 +7384,8 @@ namespace LegionRuntime {
     }
 
     //--------------------------------------------------------------------------
-    void MustEpochOp::register_single_task(SingleTask *single, unsigned index)
+    void MustEpochOp::register_single_task(SingleTask *single, unsigned index,
+                                           TaskOp *distributed)
     //--------------------------------------------------------------------------
     {
       // Can do the first part without the lock 
@@ -7279,6 +7395,7 @@ namespace LegionRuntime {
       task_sets[index].insert(single);
       AutoLock o_lock(op_lock);
       single_tasks.push_back(single);
+      single_owners[single] = distributed;
     }
 
     //--------------------------------------------------------------------------
@@ -7710,7 +7827,8 @@ namespace LegionRuntime {
 
     //--------------------------------------------------------------------------
     MustEpochDistributor::MustEpochDistributor(MustEpochOp *own)
-      : owner(own)
+      : owner(own), runtime(NULL), constraints(NULL), 
+        mapper_proc(Processor::NO_PROC), notify(false)
     //--------------------------------------------------------------------------
     {
     }
@@ -7741,44 +7859,149 @@ namespace LegionRuntime {
     }
 
     //--------------------------------------------------------------------------
-    void MustEpochDistributor::distribute_tasks(Runtime *runtime,
+    void MustEpochDistributor::distribute_tasks(Runtime *rt,
                                 const std::vector<IndividualTask*> &indiv_tasks,
-                                const std::set<SliceTask*> &slice_tasks)
+                                const std::set<SliceTask*> &slice_tasks,
+                                const std::deque<SingleTask*> &single_tasks,
+                        const std::map<SingleTask*,TaskOp*> &single_owners,
+                    const std::vector<Mapper::MappingConstraint> &constraint_set,
+                                Processor proc, bool notify_mapper)
+    //--------------------------------------------------------------------------
+    {
+      runtime = rt;
+      constraints = &constraint_set;
+      mapper_proc = proc;
+      notify = notify_mapper;
+      // Group the tasks that will be sent by the node they are going to
+      std::map<AddressSpaceID,unsigned> group_indexes;
+      std::map<TaskOp*,unsigned> task_groups;
+      std::vector<TaskOp*> all_tasks(indiv_tasks.begin(), indiv_tasks.end());
+      all_tasks.insert(all_tasks.end(), slice_tasks.begin(), slice_tasks.end());
+      for (std::vector<TaskOp*>::const_iterator it = all_tasks.begin();
+            it != all_tasks.end(); it++)
+      {
+        AddressSpaceID target = runtime->find_address_space((*it)->target_proc);
+        std::map<AddressSpaceID,unsigned>::const_iterator finder = 
+          group_indexes.find(target);
+        unsigned group;
+        if (finder == group_indexes.end())
+        {
+          group = groups.size();
+          group_indexes[target] = group;
+          groups.resize(group+1);
+          groups[group].neighbors.insert(group);
+        }
+        else
+          group = finder->second;
+        groups[group].tasks.push_back(*it);
+        task_groups[*it] = group;
+      }
+      if (notify)
+      {
+        for (std::deque<SingleTask*>::const_iterator it = 
+              single_tasks.begin(); it != single_tasks.end(); it++)
+        {
+#ifdef DEBUG_HIGH_LEVEL
+          assert(single_owners.find(*it) != single_owners.end());
+#endif
+          TaskOp *distributed = single_owners.find(*it)->second;
+          groups[task_groups[distributed]].singles.push_back(*it);
+        }
+      }
+      // Each constraint is checked by the group of its first task.  
+      // Checking reads the instances of both tasks so a group can only 
+      // be sent once every group it shares a constraint with is done.
+      for (unsigned idx = 0; idx < constraint_set.size(); idx++)
+      {
+        const Mapper::MappingConstraint &constraint = constraint_set[idx];
+        SingleTask *t1 = 
+          static_cast<SingleTask*>(const_cast<Task*>(constraint.t1));
+        SingleTask *t2 = 
+          static_cast<SingleTask*>(const_cast<Task*>(constraint.t2));
+#ifdef DEBUG_HIGH_LEVEL
+        assert(single_owners.find(t1) != single_owners.end());
+        assert(single_owners.find(t2) != single_owners.end());
+#endif
+        unsigned g1 = task_groups[single_owners.find(t1)->second];
+        unsigned g2 = task_groups[single_owners.find(t2)->second];
+        groups[g1].constraints.push_back(idx);
+        if (g1 != g2)
+        {
+          groups[g1].neighbors.insert(g2);
+          groups[g2].neighbors.insert(g1);
+        }
+      }
+      std::set<Event> wait_events;
+      for (unsigned idx = 0; idx < groups.size(); idx++)
+      {
+        groups[idx].checked = UserEvent::create_user_event();
+        groups[idx].distributed = UserEvent::create_user_event();
+        wait_events.insert(groups[idx].distributed);
+      }
+      check_groups(0, groups.size());
+      if (!wait_events.empty())
+      {
+        Event dist_event = Event::merge_events(wait_events);
+        dist_event.wait();
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    void MustEpochDistributor::check_groups(unsigned start, unsigned stop)
     //--------------------------------------------------------------------------
     {
+      if (start >= stop)
+        return;
+      // Hand the rest of the range off in at most radix contiguous
+      // chunks, the first group in each chunk is checked by the
+      // meta-task that is then responsible for the rest of its chunk
+      const unsigned first = start + 1;
+      if (first < stop)
+      {
+        const unsigned total = stop - first;
+        const unsigned radix = Runtime::must_epoch_radix;
+        const unsigned chunk = (radix == 0) ? 1 : (total + radix - 1) / radix;
+        MustEpochCheckArgs args;
+        args.hlr_id = HLR_MUST_CHECK_ID;
+        args.distributor = this;
+        for (unsigned idx = first; idx < stop; idx += chunk)
+        {
+          args.start = idx;
+          args.stop = ((idx + chunk) < stop) ? (idx + chunk) : stop;
+          runtime->issue_runtime_meta_task(&args, sizeof(args),
+                                           HLR_MUST_CHECK_ID, owner);
+        }
+      }
+      DistributionGroup &group = groups[start];
+      for (std::vector<unsigned>::const_iterator it = 
+            group.constraints.begin(); it != group.constraints.end(); it++)
+        check_constraint((*constraints)[*it]);
+      // If the mapper wanted to know on success, then tell it
+      for (std::vector<SingleTask*>::const_iterator it = 
+            group.singles.begin(); it != group.singles.end(); it++)
+        runtime->invoke_mapper_notify_result(mapper_proc, *it);
+      group.checked.trigger();
+      std::set<Event> preconditions;
+      for (std::set<unsigned>::const_iterator it = group.neighbors.begin();
+            it != group.neighbors.end(); it++)
+        preconditions.insert(groups[*it].checked);
+      Event precondition = Event::merge_events(preconditions);
+      // Every task gets its own meta-task so remote tasks are
+      // packed and sent in parallel
       MustEpochDistributorArgs dist_args;
       dist_args.hlr_id = HLR_MUST_DIST_ID;
       MustEpochLauncherArgs launch_args;
       launch_args.hlr_id = HLR_MUST_LAUNCH_ID;
       std::set<Event> wait_events;
-      for (std::vector<IndividualTask*>::const_iterator it = 
-            indiv_tasks.begin(); it != indiv_tasks.end(); it++)
-      {
-        if (!runtime->is_local((*it)->target_proc))
-        {
-          dist_args.task = *it;
-          Event wait = runtime->issue_runtime_meta_task(&dist_args,
-                          sizeof(dist_args), HLR_MUST_DIST_ID, owner);
-          if (wait.exists())
-            wait_events.insert(wait);
-        }
-        else
-        {
-          launch_args.task = *it;
-          Event wait = runtime->issue_runtime_meta_task(&launch_args,
-                          sizeof(launch_args), HLR_MUST_LAUNCH_ID, owner);
-          if (wait.exists())
-            wait_events.insert(wait);
-        }
-      }
-      for (std::set<SliceTask*>::const_iterator it = 
-            slice_tasks.begin(); it != slice_tasks.end(); it++)
+      for (std::vector<TaskOp*>::const_iterator it = 
+            group.tasks.begin(); it != group.tasks.end(); it++)
       {
         if (!runtime->is_local((*it)->target_proc))
         {
           dist_args.task = *it;
           Event wait = runtime->issue_runtime_meta_task(&dist_args,
-                          sizeof(dist_args), HLR_MUST_DIST_ID, owner);
+                          sizeof(dist_args), HLR_MUST_DIST_ID, owner,
+                          precondition);
           if (wait.exists())
             wait_events.insert(wait);
         }
@@ -7786,15 +8009,44 @@ namespace LegionRuntime {
         {
           launch_args.task = *it;
           Event wait = runtime->issue_runtime_meta_task(&launch_args,
-                          sizeof(launch_args), HLR_MUST_LAUNCH_ID, owner);
+                          sizeof(launch_args), HLR_MUST_LAUNCH_ID, owner,
+                          precondition);
           if (wait.exists())
             wait_events.insert(wait);
         }
       }
-      if (!wait_events.empty())
+      // Nothing can touch the group once these are done
+      group.distributed.trigger(Event::merge_events(wait_events));
+    }
+
+    //--------------------------------------------------------------------------
+    void MustEpochDistributor::check_constraint(
+                                   const Mapper::MappingConstraint &constraint)
+    //--------------------------------------------------------------------------
+    {
+      // We know that all these tasks are single tasks
+      // so doing static casts are safe
+      SingleTask *t1 = 
+        static_cast<SingleTask*>(const_cast<Task*>(constraint.t1));
+      SingleTask *t2 = 
+        static_cast<SingleTask*>(const_cast<Task*>(constraint.t2));
+      PhysicalManager *inst1 = t1->get_instance(constraint.idx1);
+      PhysicalManager *inst2 = t2->get_instance(constraint.idx2);
+      // Check to make sure they selected the same instance 
+      if (inst1 != inst2)
       {
-        Event dist_event = Event::merge_events(wait_events);
-        dist_event.wait();
+        log_run.error("MUST EPOCH ERROR: failed constraint! "
+            "Task %s (ID %lld) mapped region %d to instance " IDFMT " in "
+            "memory " IDFMT " , but task %s (ID %lld) mapped region %d to "
+            "instance " IDFMT " in memory " IDFMT ".",
+            t1->variants->name, t1->get_unique_task_id(), constraint.idx1,
+            inst1->get_instance().id, inst1->memory.id,
+            t2->variants->name, t2->get_unique_task_id(), constraint.idx2,
+            inst2->get_instance().id, inst2->memory.id);
+#ifdef DEBUG_HIGH_LEVEL
+        assert(false);
+#endif
+        exit(ERROR_MUST_EPOCH_FAILURE);
       }
     }
 
@@ -7817,6 +8069,15 @@ namespace LegionRuntime {
       launch_args->task->launch_task();
     }
 
+    //--------------------------------------------------------------------------
+    /*static*/ void MustEpochDistributor::handle_check_task(const void *args)
+    //--------------------------------------------------------------------------
+    {
+      const MustEpochCheckArgs *check_args = (const MustEpochCheckArgs*)args;
+      check_args->distributor->check_groups(check_args->start, 
+                                            check_args->stop);
+    }
+
     /////////////////////////////////////////////////////////////
     // Pending Partition Op 
     /////////////////////////////////////////////////////////////
@@ -512,12 +512,34 @@ namespace LegionRuntime {
       virtual void resolve_false(void) = 0;
     public:
       virtual void notify_predicate_value(GenerationID gen, bool value);
+    public:
+      // Whether this operation was started on a guess about its
+      // predicate that has not been confirmed yet, in which case
+      // everything it writes has to be shadowed first
+      bool is_speculative(void) const;
+      // Record the shadows for a speculative execution along with
+      // a termination event to hold back until the predicate is
+      // known and the event for when the execution is done
+      void record_speculative_execution(
+                              const std::vector<ShadowInstance> &shadows,
+                              UserEvent termination, Event executed);
+      void record_speculative_time(long long time_in_us);
+      // Called once the predicate has resolved; commits or rolls
+      // back all the shadows, releases the held back termination
+      // events and returns the event for when it is all done
+      Event finalize_speculation(void);
     protected:
       SpecState    speculation_state;
       PredicateOp *predicate;
       bool received_trigger_resolution;
+      bool mispredicted;
     protected:
       UserEvent predicate_waiter; // used only when needed
+    protected:
+      std::vector<ShadowInstance> speculative_shadows;
+      std::vector<std::pair<UserEvent,Event> > speculative_terminations;
+      unsigned speculative_executions;
+      long long speculative_time;
     };
 
     /**
@@ -619,6 +641,7 @@ namespace LegionRuntime {
       virtual void trigger_dependence_analysis(void);
       virtual void trigger_remote_state_analysis(UserEvent ready_event);
       virtual bool trigger_execution(void);
+      virtual void trigger_complete(void);
       virtual void trigger_commit(void);
       virtual void report_interfering_requirements(unsigned idx1,unsigned idx2);
       virtual void report_interfering_close_requirement(unsigned idx);
@@ -1269,7 +1292,8 @@ namespace LegionRuntime {
                              DependenceType dtype);
     public:
       void add_mapping_dependence(Event precondition);
-      void register_single_task(SingleTask *single, unsigned index);
+      void register_single_task(SingleTask *single, unsigned index,
+                                TaskOp *distributed);
       void register_slice_task(SliceTask *slice);
       void set_future(const DomainPoint &point, 
                       const void *result, size_t result_size, bool owned);
@@ -1293,6 +1317,9 @@ namespace LegionRuntime {
       // The actual base operations
       // Use a deque to keep everything in order
       std::deque<SingleTask*>      single_tasks;
+      // The individual or slice task that carries each single
+      // task when the epoch is distributed
+      std::map<SingleTask*,TaskOp*> single_owners;
     protected:
       MapperID                     mapper_id;
       MappingTagID                 mapper_tag;
@@ -1385,6 +1412,15 @@ namespace LegionRuntime {
       bool success;
     };
 
+    /**
+     * \class MustEpochDistributor
+     * A helper class for distributing the tasks of a must epoch.
+     * Tasks are split into groups by the node they will run on.
+     * The groups check their mapping constraints in parallel
+     * through a tree of meta-tasks. Each task is then sent off
+     * by its own meta-task as soon as every group its group
+     * shares a constraint with is checked.
+     */
     class MustEpochDistributor {
     public:
       struct MustEpochDistributorArgs {
@@ -1397,6 +1433,21 @@ namespace LegionRuntime {
         HLRTaskID hlr_id;
         TaskOp *task;
       };
+      struct MustEpochCheckArgs {
+      public:
+        HLRTaskID hlr_id;
+        MustEpochDistributor *distributor;
+        unsigned start, stop;
+      };
+      struct DistributionGroup {
+      public:
+        std::vector<TaskOp*> tasks;
+        std::vector<SingleTask*> singles;
+        std::vector<unsigned> constraints;
+        std::set<unsigned> neighbors;
+        UserEvent checked;
+        UserEvent distributed;
+      };
     public:
       MustEpochDistributor(MustEpochOp *owner);
       MustEpochDistributor(const MustEpochDistributor &rhs);
@@ -1406,12 +1457,25 @@ namespace LegionRuntime {
     public:
       void distribute_tasks(Runtime *runtime,
                             const std::vector<IndividualTask*> &indiv_tasks,
-                            const std::set<SliceTask*> &slice_tasks);
+                            const std::set<SliceTask*> &slice_tasks,
+                            const std::deque<SingleTask*> &single_tasks,
+                  const std::map<SingleTask*,TaskOp*> &single_owners,
+                  const std::vector<Mapper::MappingConstraint> &constraints,
+                            Processor mapper_proc, bool notify);
+      void check_groups(unsigned start, unsigned stop);
+    protected:
+      void check_constraint(const Mapper::MappingConstraint &constraint);
     public:
       static void handle_distribute_task(const void *args);
       static void handle_launch_task(const void *args);
+      static void handle_check_task(const void *args);
     private:
       MustEpochOp *const owner;
+      Runtime *runtime;
+      const std::vector<Mapper::MappingConstraint> *constraints;
+      Processor mapper_proc;
+      bool notify;
+      std::vector<DistributionGroup> groups;
     };
 
     /**
@@ -103,7 +103,9 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     void LegionProfInstance::process_task(size_t id, UniqueID op_id, 
                   Realm::ProfilingMeasurements::OperationTimeline *timeline,
-                  Realm::ProfilingMeasurements::OperationProcessorUsage *usage)
+                  Realm::ProfilingMeasurements::OperationProcessorUsage *usage,
+                  Realm::ProfilingMeasurements::OperationPerfCounters *counters,
+                Realm::ProfilingMeasurements::ProcessorRuntimeOverhead *overhead)
     //--------------------------------------------------------------------------
     {
 #ifdef DEBUG_HIGH_LEVEL
@@ -119,12 +121,24 @@ namespace LegionRuntime {
       info.start = timeline->start_time;
       // use complete_time instead of end_time to include async work
       info.stop = timeline->complete_time;
+      if ((counters != NULL) && counters->is_valid())
+      {
+        task_counters.push_back(TaskCounters());
+        TaskCounters &ctrs = task_counters.back();
+        ctrs.task_id = op_id;
+        ctrs.func_id = id;
+        ctrs.counters = *counters;
+      }
+      if (overhead != NULL)
+        process_overhead(timeline->start_time, overhead);
     }
 
     //--------------------------------------------------------------------------
     void LegionProfInstance::process_meta(size_t id, UniqueID op_id,
                   Realm::ProfilingMeasurements::OperationTimeline *timeline,
-                  Realm::ProfilingMeasurements::OperationProcessorUsage *usage)
+                  Realm::ProfilingMeasurements::OperationProcessorUsage *usage,
+                  Realm::ProfilingMeasurements::OperationPerfCounters *counters,
+                Realm::ProfilingMeasurements::ProcessorRuntimeOverhead *overhead)
     //--------------------------------------------------------------------------
     {
 #ifdef DEBUG_HIGH_LEVEL
@@ -140,12 +154,23 @@ namespace LegionRuntime {
       info.start = timeline->start_time;
       // use complete_time instead of end_time to include async work
       info.stop = timeline->complete_time;
+      if ((counters != NULL) && counters->is_valid())
+      {
+        meta_counters.push_back(MetaCounters());
+        MetaCounters &ctrs = meta_counters.back();
+        ctrs.op_id = op_id;
+        ctrs.hlr_id = id;
+        ctrs.counters = *counters;
+      }
+      if (overhead != NULL)
+        process_overhead(timeline->start_time, overhead);
     }
 
     //--------------------------------------------------------------------------
     void LegionProfInstance::process_copy(UniqueID op_id,
                   Realm::ProfilingMeasurements::OperationTimeline *timeline,
-                  Realm::ProfilingMeasurements::OperationMemoryUsage *usage)
+                  Realm::ProfilingMeasurements::OperationMemoryUsage *usage,
+                  Realm::ProfilingMeasurements::OperationPerfCounters *counters)
     //--------------------------------------------------------------------------
     {
 #ifdef DEBUG_HIGH_LEVEL
@@ -162,12 +187,22 @@ namespace LegionRuntime {
       info.start = timeline->start_time;
       // use complete_time instead of end_time to include async work
       info.stop = timeline->complete_time;
+      if ((counters != NULL) && counters->is_valid())
+      {
+        copy_counters.push_back(CopyCounters());
+        CopyCounters &ctrs = copy_counters.back();
+        ctrs.op_id = op_id;
+        ctrs.source = usage->source;
+        ctrs.target = usage->target;
+        ctrs.counters = *counters;
+      }
     }
 
     //--------------------------------------------------------------------------
     void LegionProfInstance::process_fill(UniqueID op_id,
                   Realm::ProfilingMeasurements::OperationTimeline *timeline,
-                  Realm::ProfilingMeasurements::OperationMemoryUsage *usage)
+                  Realm::ProfilingMeasurements::OperationMemoryUsage *usage,
+                  Realm::ProfilingMeasurements::OperationPerfCounters *counters)
     //--------------------------------------------------------------------------
     {
 #ifdef DEBUG_HIGH_LEVEL
@@ -182,6 +217,14 @@ namespace LegionRuntime {
       info.start = timeline->start_time;
       // use complete_time instead of end_time to include async work
       info.stop = timeline->complete_time;
+      if ((counters != NULL) && counters->is_valid())
+      {
+        fill_counters.push_back(FillCounters());
+        FillCounters &ctrs = fill_counters.back();
+        ctrs.op_id = op_id;
+        ctrs.target = usage->target;
+        ctrs.counters = *counters;
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -201,7 +244,25 @@ namespace LegionRuntime {
     }
 
     //--------------------------------------------------------------------------
-    void LegionProfInstance::dump_state(void)
+    void LegionProfInstance::process_overhead(unsigned long long time,
+                 Realm::ProfilingMeasurements::ProcessorRuntimeOverhead *overhead)
+    //--------------------------------------------------------------------------
+    {
+      // all the values are cumulative so we only need the latest one
+      std::map<Processor,ProcOverhead>::iterator finder = 
+        proc_overheads.find(overhead->proc);
+      if ((finder != proc_overheads.end()) && (finder->second.time >= time))
+        return;
+      ProcOverhead &info = proc_overheads[overhead->proc];
+      info.proc = overhead->proc;
+      info.time = time;
+      info.scheduler_time = overhead->scheduler_time;
+      info.event_time = overhead->event_time;
+      info.message_time = overhead->message_time;
+    }
+
+    //--------------------------------------------------------------------------
+    size_t LegionProfInstance::dump_state(void)
     //--------------------------------------------------------------------------
     {
       for (std::deque<TaskKind>::const_iterator it = task_kinds.begin();
@@ -262,6 +323,45 @@ namespace LegionRuntime {
                       it->op_id, it->inst.id, it->mem.id, it->total_bytes,
                       it->create, it->destroy);
       }
+      for (std::deque<TaskCounters>::const_iterator it = 
+            task_counters.begin(); it != task_counters.end(); it++)
+      {
+        log_prof.info("Prof Task Counters %llu %u %lld %lld %lld",
+                      it->task_id, it->func_id, it->counters.cycles,
+                      it->counters.instructions, it->counters.llc_misses);
+      }
+      for (std::deque<MetaCounters>::const_iterator it = 
+            meta_counters.begin(); it != meta_counters.end(); it++)
+      {
+        log_prof.info("Prof Meta Counters %llu %u %lld %lld %lld",
+                      it->op_id, it->hlr_id, it->counters.cycles,
+                      it->counters.instructions, it->counters.llc_misses);
+      }
+      for (std::deque<CopyCounters>::const_iterator it = 
+            copy_counters.begin(); it != copy_counters.end(); it++)
+      {
+        log_prof.info("Prof Copy Counters %llu " IDFMT " " IDFMT 
+                      " %lld %lld %lld", it->op_id, it->source.id, 
+                      it->target.id, it->counters.cycles,
+                      it->counters.instructions, it->counters.llc_misses);
+      }
+      for (std::deque<FillCounters>::const_iterator it = 
+            fill_counters.begin(); it != fill_counters.end(); it++)
+      {
+        log_prof.info("Prof Fill Counters %llu " IDFMT " %lld %lld %lld",
+                      it->op_id, it->target.id, it->counters.cycles,
+                      it->counters.instructions, it->counters.llc_misses);
+      }
+      for (std::map<Processor,ProcOverhead>::const_iterator it = 
+            proc_overheads.begin(); it != proc_overheads.end(); it++)
+      {
+        log_prof.info("Prof Proc Overhead " IDFMT " %llu %lld %lld %lld",
+                      it->second.proc.id, it->second.time, 
+                      it->second.scheduler_time, it->second.event_time,
+                      it->second.message_time);
+      }
+      const size_t counter_samples = task_counters.size() + 
+        meta_counters.size() + copy_counters.size() + fill_counters.size();
       task_kinds.clear();
       task_variants.clear();
       operation_instances.clear();
@@ -270,6 +370,12 @@ namespace LegionRuntime {
       meta_infos.clear();
       copy_infos.clear();
       inst_infos.clear();
+      task_counters.clear();
+      meta_counters.clear();
+      copy_counters.clear();
+      fill_counters.clear();
+      proc_overheads.clear();
+      return counter_samples;
     }
 
     //--------------------------------------------------------------------------
@@ -278,8 +384,10 @@ namespace LegionRuntime {
                                    const char *const *const task_descriptions,
                                    unsigned num_operation_kinds,
                                    const char *const *const 
-                                                  operation_kind_descriptions)
-      : target_proc(target), instances((LegionProfInstance**)
+                                                  operation_kind_descriptions,
+                                   bool counters)
+      : target_proc(target), profile_counters(counters), 
+        instances((LegionProfInstance**)
             malloc(MAX_NUM_PROCS*sizeof(LegionProfInstance*)))
     //--------------------------------------------------------------------------
     {
@@ -315,7 +423,8 @@ namespace LegionRuntime {
 
     //--------------------------------------------------------------------------
     LegionProfiler::LegionProfiler(const LegionProfiler &rhs)
-      : target_proc(rhs.target_proc), instances(rhs.instances)
+      : target_proc(rhs.target_proc), profile_counters(rhs.profile_counters),
+        instances(rhs.instances)
     //--------------------------------------------------------------------------
     {
       // should never be called
@@ -417,6 +526,13 @@ namespace LegionRuntime {
                 Realm::ProfilingMeasurements::OperationTimeline>();
       req.add_measurement<
                 Realm::ProfilingMeasurements::OperationProcessorUsage>();
+      if (profile_counters)
+      {
+        req.add_measurement<
+                Realm::ProfilingMeasurements::OperationPerfCounters>();
+        req.add_measurement<
+                Realm::ProfilingMeasurements::ProcessorRuntimeOverhead>();
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -434,6 +550,13 @@ namespace LegionRuntime {
                 Realm::ProfilingMeasurements::OperationTimeline>();
       req.add_measurement<
                 Realm::ProfilingMeasurements::OperationProcessorUsage>();
+      if (profile_counters)
+      {
+        req.add_measurement<
+                Realm::ProfilingMeasurements::OperationPerfCounters>();
+        req.add_measurement<
+                Realm::ProfilingMeasurements::ProcessorRuntimeOverhead>();
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -451,6 +574,9 @@ namespace LegionRuntime {
                 Realm::ProfilingMeasurements::OperationTimeline>();
       req.add_measurement<
                 Realm::ProfilingMeasurements::OperationMemoryUsage>();
+      if (profile_counters)
+        req.add_measurement<
+                Realm::ProfilingMeasurements::OperationPerfCounters>();
     }
 
     //--------------------------------------------------------------------------
@@ -468,6 +594,9 @@ namespace LegionRuntime {
                 Realm::ProfilingMeasurements::OperationTimeline>();
       req.add_measurement<
                 Realm::ProfilingMeasurements::OperationMemoryUsage>();
+      if (profile_counters)
+        req.add_measurement<
+                Realm::ProfilingMeasurements::OperationPerfCounters>();
     }
 
     //--------------------------------------------------------------------------
@@ -502,6 +631,13 @@ namespace LegionRuntime {
                 Realm::ProfilingMeasurements::OperationTimeline>();
       req.add_measurement<
                 Realm::ProfilingMeasurements::OperationProcessorUsage>();
+      if (profile_counters)
+      {
+        req.add_measurement<
+                Realm::ProfilingMeasurements::OperationPerfCounters>();
+        req.add_measurement<
+                Realm::ProfilingMeasurements::ProcessorRuntimeOverhead>();
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -519,6 +655,13 @@ namespace LegionRuntime {
                 Realm::ProfilingMeasurements::OperationTimeline>();
       req.add_measurement<
                 Realm::ProfilingMeasurements::OperationProcessorUsage>();
+      if (profile_counters)
+      {
+        req.add_measurement<
+                Realm::ProfilingMeasurements::OperationPerfCounters>();
+        req.add_measurement<
+                Realm::ProfilingMeasurements::ProcessorRuntimeOverhead>();
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -536,6 +679,9 @@ namespace LegionRuntime {
                 Realm::ProfilingMeasurements::OperationTimeline>();
       req.add_measurement<
                 Realm::ProfilingMeasurements::OperationMemoryUsage>();
+      if (profile_counters)
+        req.add_measurement<
+                Realm::ProfilingMeasurements::OperationPerfCounters>();
     }
 
     //--------------------------------------------------------------------------
@@ -553,6 +699,9 @@ namespace LegionRuntime {
                 Realm::ProfilingMeasurements::OperationTimeline>();
       req.add_measurement<
                 Realm::ProfilingMeasurements::OperationMemoryUsage>();
+      if (profile_counters)
+        req.add_measurement<
+                Realm::ProfilingMeasurements::OperationPerfCounters>();
     }
 
     //--------------------------------------------------------------------------
@@ -572,6 +721,17 @@ namespace LegionRuntime {
                 Realm::ProfilingMeasurements::InstanceMemoryUsage>();
     }
 
+    //--------------------------------------------------------------------------
+    template<typename T>
+    static inline T* get_optional_measurement(
+                                      Realm::ProfilingResponse &response)
+    //--------------------------------------------------------------------------
+    {
+      if (!response.has_measurement<T>())
+        return NULL;
+      return response.get_measurement<T>();
+    }
+
     //--------------------------------------------------------------------------
     void LegionProfiler::process_results(Processor p, const void *buffer,
                                          size_t size)
@@ -604,10 +764,18 @@ namespace LegionRuntime {
             Realm::ProfilingMeasurements::OperationProcessorUsage *usage = 
               response.get_measurement<
                     Realm::ProfilingMeasurements::OperationProcessorUsage>();
+            Realm::ProfilingMeasurements::OperationPerfCounters *counters =
+              get_optional_measurement<
+                Realm::ProfilingMeasurements::OperationPerfCounters>(response);
+            Realm::ProfilingMeasurements::ProcessorRuntimeOverhead *overhead =
+              get_optional_measurement<
+               Realm::ProfilingMeasurements::ProcessorRuntimeOverhead>(response);
             instances[local_id]->process_task(info->id, info->op_id,
-                                              timeline, usage);
+                                          timeline, usage, counters, overhead);
             delete timeline;
             delete usage;
+            delete counters;
+            delete overhead;
             break;
           }
         case LEGION_PROF_META:
@@ -624,10 +792,18 @@ namespace LegionRuntime {
             Realm::ProfilingMeasurements::OperationProcessorUsage *usage = 
               response.get_measurement<
                     Realm::ProfilingMeasurements::OperationProcessorUsage>();
+            Realm::ProfilingMeasurements::OperationPerfCounters *counters =
+              get_optional_measurement<
+                Realm::ProfilingMeasurements::OperationPerfCounters>(response);
+            Realm::ProfilingMeasurements::ProcessorRuntimeOverhead *overhead =
+              get_optional_measurement<
+               Realm::ProfilingMeasurements::ProcessorRuntimeOverhead>(response);
             instances[local_id]->process_meta(info->id, info->op_id,
-                                              timeline, usage);
+                                          timeline, usage, counters, overhead);
             delete timeline;
             delete usage;
+            delete counters;
+            delete overhead;
             break;
           }
         case LEGION_PROF_COPY:
@@ -644,10 +820,14 @@ namespace LegionRuntime {
             Realm::ProfilingMeasurements::OperationMemoryUsage *usage = 
               response.get_measurement<
                     Realm::ProfilingMeasurements::OperationMemoryUsage>();
+            Realm::ProfilingMeasurements::OperationPerfCounters *counters =
+              get_optional_measurement<
+                Realm::ProfilingMeasurements::OperationPerfCounters>(response);
             instances[local_id]->process_copy(info->op_id,
-                                              timeline, usage);
+                                              timeline, usage, counters);
             delete timeline;
             delete usage;
+            delete counters;
             break;
           }
         case LEGION_PROF_FILL:
@@ -664,10 +844,14 @@ namespace LegionRuntime {
             Realm::ProfilingMeasurements::OperationMemoryUsage *usage = 
               response.get_measurement<
                     Realm::ProfilingMeasurements::OperationMemoryUsage>();
+            Realm::ProfilingMeasurements::OperationPerfCounters *counters =
+              get_optional_measurement<
+                Realm::ProfilingMeasurements::OperationPerfCounters>(response);
             instances[local_id]->process_fill(info->op_id,
-                                              timeline, usage);
+                                              timeline, usage, counters);
             delete timeline;
             delete usage;
+            delete counters;
             break;
           }
         case LEGION_PROF_INST:
@@ -699,11 +883,16 @@ namespace LegionRuntime {
     void LegionProfiler::finalize(void)
     //--------------------------------------------------------------------------
     {
+      size_t counter_samples = 0;
       for (unsigned idx = 0; idx < MAX_NUM_PROCS; idx++)
       {
         if (instances[idx] != NULL)
-          instances[idx]->dump_state();
+          counter_samples += instances[idx]->dump_state();
       }
+      if (profile_counters && (counter_samples == 0))
+        log_prof.warning("Hardware counters were requested but none could "
+                         "be read (check perf_event_paranoid, or whether this "
+                         "machine exposes a PMU)");
     }
 
   };
@@ -24,6 +24,7 @@
 
 #include <cassert>
 #include <deque>
+#include <map>
 #include <algorithm>
 
 namespace LegionRuntime {
@@ -86,6 +87,38 @@ namespace LegionRuntime {
         size_t total_bytes;
         unsigned long long create, destroy;
       };
+      struct TaskCounters {
+      public:
+        UniqueID task_id;
+        Processor::TaskFuncID func_id;
+        Realm::ProfilingMeasurements::OperationPerfCounters counters;
+      };
+      struct MetaCounters {
+      public:
+        UniqueID op_id;
+        unsigned hlr_id;
+        Realm::ProfilingMeasurements::OperationPerfCounters counters;
+      };
+      struct CopyCounters {
+      public:
+        UniqueID op_id;
+        Memory source, target;
+        Realm::ProfilingMeasurements::OperationPerfCounters counters;
+      };
+      struct FillCounters {
+      public:
+        UniqueID op_id;
+        Memory target;
+        Realm::ProfilingMeasurements::OperationPerfCounters counters;
+      };
+      // only the most recent (i.e. largest) of the cumulative overhead
+      // values for each processor is kept
+      struct ProcOverhead {
+      public:
+        Processor proc;
+        unsigned long long time;
+        long long scheduler_time, event_time, message_time;
+      };
     public:
       LegionProfInstance(LegionProfiler *owner);
       LegionProfInstance(const LegionProfInstance &rhs);
@@ -99,23 +132,34 @@ namespace LegionRuntime {
       void register_operation(Operation *op);
       void register_multi_task(Operation *op, Processor::TaskFuncID kind);
     public:
+      // counters and overhead are NULL unless they were measured
       void process_task(size_t id, UniqueID op_id, 
                   Realm::ProfilingMeasurements::OperationTimeline *timeline,
-                  Realm::ProfilingMeasurements::OperationProcessorUsage *usage);
+                  Realm::ProfilingMeasurements::OperationProcessorUsage *usage,
+                  Realm::ProfilingMeasurements::OperationPerfCounters *counters,
+                Realm::ProfilingMeasurements::ProcessorRuntimeOverhead *overhead);
       void process_meta(size_t id, UniqueID op_id,
                   Realm::ProfilingMeasurements::OperationTimeline *timeline,
-                  Realm::ProfilingMeasurements::OperationProcessorUsage *usage);
+                  Realm::ProfilingMeasurements::OperationProcessorUsage *usage,
+                  Realm::ProfilingMeasurements::OperationPerfCounters *counters,
+                Realm::ProfilingMeasurements::ProcessorRuntimeOverhead *overhead);
       void process_copy(UniqueID op_id,
                   Realm::ProfilingMeasurements::OperationTimeline *timeline,
-                  Realm::ProfilingMeasurements::OperationMemoryUsage *usage);
+                  Realm::ProfilingMeasurements::OperationMemoryUsage *usage,
+                  Realm::ProfilingMeasurements::OperationPerfCounters *counters);
       void process_fill(UniqueID op_id,
                   Realm::ProfilingMeasurements::OperationTimeline *timeline,
-                  Realm::ProfilingMeasurements::OperationMemoryUsage *usage);
+                  Realm::ProfilingMeasurements::OperationMemoryUsage *usage,
+                  Realm::ProfilingMeasurements::OperationPerfCounters *counters);
       void process_inst(UniqueID op_id,
                   Realm::ProfilingMeasurements::InstanceTimeline *timeline,
                   Realm::ProfilingMeasurements::InstanceMemoryUsage *usage);
+    protected:
+      void process_overhead(unsigned long long time,
+                Realm::ProfilingMeasurements::ProcessorRuntimeOverhead *overhead);
     public:
-      void dump_state(void);
+      // returns the number of counter samples that were dumped
+      size_t dump_state(void);
     private:
       LegionProfiler *const owner;
       std::deque<TaskKind>          task_kinds;
@@ -128,6 +172,12 @@ namespace LegionRuntime {
       std::deque<CopyInfo> copy_infos;
       std::deque<FillInfo> fill_infos;
       std::deque<InstInfo> inst_infos;
+    private:
+      std::deque<TaskCounters> task_counters;
+      std::deque<MetaCounters> meta_counters;
+      std::deque<CopyCounters> copy_counters;
+      std::deque<FillCounters> fill_counters;
+      std::map<Processor,ProcOverhead> proc_overheads;
     };
 
     class LegionProfiler {
@@ -155,7 +205,8 @@ namespace LegionRuntime {
                      unsigned num_meta_tasks,
                      const char *const *const meta_task_descriptions,
                      unsigned num_operation_kinds,
-                     const char *const *const operation_kind_descriptions);
+                     const char *const *const operation_kind_descriptions,
+                     bool profile_counters);
       LegionProfiler(const LegionProfiler &rhs);
       ~LegionProfiler(void);
     public:
@@ -201,6 +252,8 @@ namespace LegionRuntime {
       void finalize(void);
     public:
       const Processor target_proc;
+      // also request hardware counters and runtime overhead (-hl:prof_counters)
+      const bool profile_counters;
     private:
       LegionProfInstance **const instances;
     };
@@ -37,7 +37,7 @@ namespace LegionRuntime {
   
     //--------------------------------------------------------------------------
     TaskOp::TaskOp(Runtime *rt)
-      : Task(), SpeculativeOp(rt)
+      : Task(), SpeculativeOp(rt), next_ready(NULL), ready_time(0)
     //--------------------------------------------------------------------------
     {
     }
@@ -124,21 +124,16 @@ namespace LegionRuntime {
       wait_barriers.clear();
       arrive_barriers.clear();
       additional_procs.clear();
-      if (args != NULL)
+      if (arg_manager != NULL)
       {
-        if (arg_manager != NULL)
-        {
-          // If the arg manager is not NULL then we delete the
-          // argument manager and just zero out the arguments
-          if (arg_manager->remove_reference())
-            legion_delete(arg_manager);
-          arg_manager = NULL;
-        }
-        else
-          legion_free(TASK_ARGS_ALLOC, args, arglen);
-        args = NULL;
-        arglen = 0;
+        // Remove our reference to the arguments, whoever is
+        // the last one to go will delete the buffer
+        if (arg_manager->remove_reference())
+          legion_delete(arg_manager);
+        arg_manager = NULL;
       }
+      args = NULL;
+      arglen = 0;
       if (local_args != NULL)
       {
         legion_free(LOCAL_ARGS_ALLOC, local_args, local_arglen);
@@ -184,7 +179,6 @@ namespace LegionRuntime {
       rez.serialize(arrive_barriers.size());
       for (unsigned idx = 0; idx < arrive_barriers.size(); idx++)
         pack_phase_barrier(arrive_barriers[idx], rez);
-      rez.serialize<bool>((arg_manager != NULL));
       rez.serialize(arglen);
       rez.serialize(args,arglen);
       rez.serialize(map_id);
@@ -266,24 +260,11 @@ namespace LegionRuntime {
       arrive_barriers.resize(num_arrive_barriers);
       for (unsigned idx = 0; idx < arrive_barriers.size(); idx++)
         unpack_phase_barrier(arrive_barriers[idx], derez);
-      bool has_arg_manager;
-      derez.deserialize(has_arg_manager);
-      derez.deserialize(arglen);
-      if (arglen > 0)
-      {
-        if (has_arg_manager)
-        {
-#ifdef DEBUG_HIGH_LEVEL
-          assert(arg_manager == NULL);
-#endif
-          arg_manager = legion_new<AllocManager>(arglen);
-          arg_manager->add_reference();
-          args = arg_manager->get_allocation();
-        }
-        else
-          args = legion_malloc(TASK_ARGS_ALLOC, arglen);
-        derez.deserialize(args,arglen);
-      }
+      size_t unpack_arglen;
+      derez.deserialize(unpack_arglen);
+      // Copy the arguments straight out of the message buffer
+      initialize_arguments(derez.get_current_pointer(), unpack_arglen);
+      derez.advance_pointer(unpack_arglen);
       derez.deserialize(map_id);
       derez.deserialize(tag);
       derez.deserialize(is_index_space);
@@ -510,14 +491,53 @@ namespace LegionRuntime {
       runtime->add_to_ready_queue(current_proc, this, false/*prev fail*/);
     }
 
+    //--------------------------------------------------------------------------
+    void TaskOp::complete_mispredicted(void)
+    //--------------------------------------------------------------------------
+    {
+      // should only be called for individual and index tasks
+      assert(false);
+    }
+
     //--------------------------------------------------------------------------
     bool TaskOp::speculate(bool &value)
     //--------------------------------------------------------------------------
     {
+      if (!can_speculate())
+        return false;
       Processor exec_proc = parent_ctx->get_executing_processor();
       return runtime->invoke_mapper_speculate(exec_proc, this, value);
     }
 
+    //--------------------------------------------------------------------------
+    bool TaskOp::can_speculate(void) const
+    //--------------------------------------------------------------------------
+    {
+      // We can only undo what a task did if it can't have launched
+      // any sub-operations of its own, so every variant that the 
+      // mapper might pick has to be a leaf variant
+      if (must_parallelism)
+        return false;
+      const std::map<VariantID,TaskVariantCollection::Variant> &all_variants =
+        variants->get_all_variants();
+      for (std::map<VariantID,TaskVariantCollection::Variant>::const_iterator
+            it = all_variants.begin(); it != all_variants.end(); it++)
+      {
+        if (!it->second.leaf)
+          return false;
+      }
+      // Shadowing relies on nobody else touching the data while
+      // the task is running, so we need exclusive coherence
+      for (unsigned idx = 0; idx < regions.size(); idx++)
+      {
+        if (IS_READ_ONLY(regions[idx]) || IS_NO_ACCESS(regions[idx]))
+          continue;
+        if (regions[idx].prop != EXCLUSIVE)
+          return false;
+      }
+      return true;
+    }
+
     //--------------------------------------------------------------------------
     unsigned TaskOp::find_parent_index(unsigned idx)
     //--------------------------------------------------------------------------
@@ -1422,8 +1442,7 @@ namespace LegionRuntime {
     }
 
     //--------------------------------------------------------------------------
-    void TaskOp::clone_task_op_from(TaskOp *rhs, Processor p, 
-                                    bool stealable, bool duplicate_args)
+    void TaskOp::clone_task_op_from(TaskOp *rhs, Processor p, bool stealable)
     //--------------------------------------------------------------------------
     {
       // From Operation
@@ -1438,33 +1457,7 @@ namespace LegionRuntime {
       this->grants = rhs->grants;
       this->wait_barriers = rhs->wait_barriers;
       this->arrive_barriers = rhs->arrive_barriers;
-      this->arglen = rhs->arglen;
-      if (rhs->arg_manager != NULL)
-      {
-        if (duplicate_args)
-        {
-#ifdef DEBUG_HIGH_LEVEL
-          assert(arg_manager == NULL);
-#endif
-          this->arg_manager = legion_new<AllocManager>(this->arglen); 
-          this->arg_manager->add_reference();
-          this->args = this->arg_manager->get_allocation();
-          memcpy(this->args, rhs->args, this->arglen);
-        }
-        else
-        {
-          // No need to actually do the copy in this case
-          this->arg_manager = rhs->arg_manager; 
-          this->arg_manager->add_reference();
-          this->args = arg_manager->get_allocation();
-        }
-      }
-      else if (arglen > 0)
-      {
-        // If there is no argument manager then we do the copy no matter what
-        this->args = legion_malloc(TASK_ARGS_ALLOC, arglen);
-        memcpy(args,rhs->args,arglen);
-      }
+      share_arguments(rhs);
       this->map_id = rhs->map_id;
       this->tag = rhs->tag;
       this->is_index_space = rhs->is_index_space;
@@ -1489,6 +1482,45 @@ namespace LegionRuntime {
       this->parent_req_indexes = rhs->parent_req_indexes;
     }
 
+    //--------------------------------------------------------------------------
+    void TaskOp::initialize_arguments(const void *ptr, size_t size)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_HIGH_LEVEL
+      assert(arg_manager == NULL);
+#endif
+      arglen = size;
+      if (arglen > 0)
+      {
+        arg_manager = legion_new<AllocManager>(arglen);
+        arg_manager->add_reference();
+        args = arg_manager->get_allocation();
+        memcpy(args, ptr, arglen);
+      }
+      else
+        args = NULL;
+    }
+
+    //--------------------------------------------------------------------------
+    void TaskOp::share_arguments(TaskOp *rhs)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_HIGH_LEVEL
+      assert(arg_manager == NULL);
+#endif
+      // Tasks on the same node just take another reference
+      // to the same buffer, the task body only ever reads it
+      arglen = rhs->arglen;
+      arg_manager = rhs->arg_manager;
+      if (arg_manager != NULL)
+      {
+        arg_manager->add_reference();
+        args = arg_manager->get_allocation();
+      }
+      else
+        args = NULL;
+    }
+
     //--------------------------------------------------------------------------
     void TaskOp::update_grants(const std::vector<Grant> &requested_grants)
     //--------------------------------------------------------------------------
@@ -2169,6 +2201,8 @@ namespace LegionRuntime {
       profiling_done = Event::NO_EVENT;
       current_trace = NULL;
       task_executed = false;
+      speculative_mapping = false;
+      speculative_start = 0;
       outstanding_children_count = 0;
       outstanding_subtasks = 0;
       pending_subtasks = 0;
@@ -2202,6 +2236,10 @@ namespace LegionRuntime {
       safe_cast_domains.clear();
       restricted_trees.clear();
       frame_events.clear();
+#ifdef DEBUG_HIGH_LEVEL
+      assert(task_shadows.empty());
+      assert(cached_inline_mappings.empty());
+#endif
       for (std::map<TraceID,LegionTrace*>::const_iterator it = traces.begin();
             it != traces.end(); it++)
       {
@@ -2361,6 +2399,10 @@ namespace LegionRuntime {
         if (!child->get_predicate_value(executing_processor))
           return;
       }
+      // Inlined children skip find_conflicting_regions, so drop any
+      // cached inline mappings that the child could write behind our back
+      for (unsigned idx = 0; idx < child->regions.size(); idx++)
+        invalidate_cached_mappings(child->regions[idx]);
 
       // Get an available inline task
       InlineTask *inline_task = runtime->get_available_inline_task(true);
@@ -2384,6 +2426,9 @@ namespace LegionRuntime {
       
       // Do the inlining
       child->perform_inlining(inline_task, fn);
+      // The inline task never reaches end_task so let go of
+      // any inline mappings the child left cached on it
+      inline_task->clear_cached_mappings();
 
       // Now when we pop back out, first see if the child made any new
       // regions and add them onto our copied regions
@@ -3491,6 +3536,7 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       const RegionRequirement &req = op->get_requirement(); 
+      invalidate_cached_mappings(req);
       return has_conflicting_internal(req, parent_conflict, inline_conflict);
     }
 
@@ -3501,6 +3547,7 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       const RegionRequirement &req = attach->get_requirement();
+      invalidate_cached_mappings(req);
       return has_conflicting_internal(req, parent_conflict, inline_conflict);
     }
 
@@ -3565,6 +3612,8 @@ namespace LegionRuntime {
                                        std::vector<PhysicalRegion> &conflicting)
     //--------------------------------------------------------------------------
     {
+      for (unsigned idx = 0; idx < task->regions.size(); idx++)
+        invalidate_cached_mappings(task->regions[idx]);
       // No need to hold our lock here because we are the only ones who
       // could possibly be doing any mutating of the regions data structure
       // but we are here so we aren't mutating
@@ -3632,6 +3681,10 @@ namespace LegionRuntime {
                                        std::vector<PhysicalRegion> &conflicting)
     //--------------------------------------------------------------------------
     {
+      for (unsigned idx = 0; idx < copy->src_requirements.size(); idx++)
+        invalidate_cached_mappings(copy->src_requirements[idx]);
+      for (unsigned idx = 0; idx < copy->dst_requirements.size(); idx++)
+        invalidate_cached_mappings(copy->dst_requirements[idx]);
       // No need to hold our lock here because we are the only ones who
       // could possibly be doing any mutating of the regions data structure
       // but we are here so we aren't mutating
@@ -3734,6 +3787,7 @@ namespace LegionRuntime {
                                        std::vector<PhysicalRegion> &conflicting)
     //--------------------------------------------------------------------------
     {
+      invalidate_cached_mappings(req);
       // No need to hold our lock here because we are the only ones who
       // could possibly be doing any mutating of the regions data structure
       // but we are here so we aren't mutating
@@ -3873,6 +3927,226 @@ namespace LegionRuntime {
       }
     }
 
+    //--------------------------------------------------------------------------
+    void SingleTask::cache_inline_mapping(const PhysicalRegion &region)
+    //--------------------------------------------------------------------------
+    {
+#if defined(LEGION_LOGGING) || defined(LEGION_SPY)
+      // Every inline mapping has to show up as an operation in the
+      // logs so we never hand back a cached one
+      return;
+#else
+      // The cache relies on the conflict checks done at launch time
+      // to invalidate it, and traces need to see the same operations
+      // every time they are replayed
+      if ((Runtime::max_cached_inline_mappings == 0) || 
+          Runtime::unsafe_launch || (current_trace != NULL))
+        return;
+      const RegionRequirement &req = region.impl->get_requirement();
+      const InstanceRef &ref = region.impl->get_reference();
+      if (!ref.has_ref() || ref.has_required_locks() || 
+          (req.handle_type != SINGULAR) || (req.prop != EXCLUSIVE) ||
+          IS_REDUCE(req) || IS_NO_ACCESS(req) || req.privilege_fields.empty())
+        return;
+      // Regions the task was launched with get remapped in place
+      for (unsigned idx = 0; idx < physical_regions.size(); idx++)
+      {
+        if (physical_regions[idx].impl == region.impl)
+          return;
+      }
+      // Restricted regions always have to go back through the
+      // region tree so they can find their restricted instance
+      RegionNode *node = runtime->forest->get_node(req.region);
+      FieldMask user_mask = 
+        node->column_source->get_field_mask(req.privilege_fields);
+      if (has_tree_restriction(req.region.get_tree_id(), user_mask))
+        return;
+      // Keep the instance valid for as long as we hold onto it
+      ref.get_instance_view()->add_base_valid_ref(INLINE_MAPPING_REF);
+      std::vector<InstanceRef> to_release;
+      {
+        AutoLock o_lock(op_lock);
+        // Replace any older mapping with the same requirement
+        for (std::list<CachedInlineMapping>::iterator it = 
+              cached_inline_mappings.begin(); it != 
+              cached_inline_mappings.end(); it++)
+        {
+          if ((it->map_id == region.impl->map_id) && 
+              (it->tag == region.impl->tag) && (it->requirement == req))
+          {
+            to_release.push_back(it->reference);
+            cached_inline_mappings.erase(it);
+            break;
+          }
+        }
+        cached_inline_mappings.push_front(CachedInlineMapping());
+        CachedInlineMapping &mapping = cached_inline_mappings.front();
+        mapping.requirement = req;
+        mapping.map_id = region.impl->map_id;
+        mapping.tag = region.impl->tag;
+        mapping.reference = ref;
+        // Drop the least recently unmapped one if we have too many
+        if (cached_inline_mappings.size() > 
+            Runtime::max_cached_inline_mappings)
+        {
+          to_release.push_back(cached_inline_mappings.back().reference);
+          cached_inline_mappings.pop_back();
+        }
+      }
+      for (std::vector<InstanceRef>::const_iterator it = 
+            to_release.begin(); it != to_release.end(); it++)
+        release_cached_mapping(*it);
+#endif
+    }
+
+    //--------------------------------------------------------------------------
+    PhysicalRegion SingleTask::find_cached_inline_mapping(
+                  const RegionRequirement &req, MapperID id, MappingTagID tag)
+    //--------------------------------------------------------------------------
+    {
+      // Operations inside a trace have to match every time it is replayed
+      if (cached_inline_mappings.empty() || (current_trace != NULL))
+        return PhysicalRegion();
+      UserEvent term_event;
+      InstanceRef ref;
+      if (!acquire_cached_mapping(req, id, tag, term_event, ref))
+        return PhysicalRegion();
+      RegionRequirement requirement;
+      requirement.copy_without_mapping_info(req);
+      requirement.initialize_mapping_fields();
+      PhysicalRegion result(legion_new<PhysicalRegion::Impl>(requirement,
+                            ref.get_ready_event(), true/*mapped*/, this,
+                            id, tag, false/*leaf*/, runtime));
+      result.impl->reset_reference(ref, term_event);
+      register_inline_mapped_region(result);
+      return result;
+    }
+
+    //--------------------------------------------------------------------------
+    bool SingleTask::remap_cached_inline_mapping(const PhysicalRegion &region)
+    //--------------------------------------------------------------------------
+    {
+      if (cached_inline_mappings.empty() || (current_trace != NULL))
+        return false;
+      UserEvent term_event;
+      InstanceRef ref;
+      if (!acquire_cached_mapping(region.impl->get_requirement(), 
+            region.impl->map_id, region.impl->tag, term_event, ref))
+        return false;
+      region.impl->remap_region(ref.get_ready_event());
+      region.impl->reset_reference(ref, term_event);
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    bool SingleTask::acquire_cached_mapping(const RegionRequirement &req,
+                                            MapperID id, MappingTagID tag,
+                                            UserEvent &term_event,
+                                            InstanceRef &result)
+    //--------------------------------------------------------------------------
+    {
+      InstanceRef cached;
+      {
+        AutoLock o_lock(op_lock);
+        for (std::list<CachedInlineMapping>::iterator it = 
+              cached_inline_mappings.begin(); it != 
+              cached_inline_mappings.end(); it++)
+        {
+          if ((it->map_id == id) && (it->tag == tag) && 
+              (it->requirement == req))
+          {
+            cached = it->reference;
+            cached_inline_mappings.erase(it);
+            break;
+          }
+        }
+      }
+      if (!cached.has_ref())
+        return false;
+      // If it conflicts with something that is still mapped then drop
+      // it and let the normal path report the error
+      bool parent_conflict = false, inline_conflict = false;
+      has_conflicting_internal(req, parent_conflict, inline_conflict);
+      if (parent_conflict || inline_conflict)
+      {
+        release_cached_mapping(cached);
+        return false;
+      }
+      // Nothing conflicting has been launched since this was unmapped
+      // so the instance still holds the valid data and all we need to
+      // do is wait for anyone else who has been using it in the meantime
+      RegionNode *node = runtime->forest->get_node(req.region);
+      FieldMask user_mask = 
+        node->column_source->get_field_mask(req.privilege_fields);
+      VersionInfo version_info;
+      version_info.set_upper_bound_node(runtime->forest->get_node(req.parent));
+      term_event = UserEvent::create_user_event();
+      result = cached.get_instance_view()->add_user(RegionUsage(req),
+                                    term_event, user_mask, version_info);
+      // Our user now keeps the instance alive until we unmap again
+      release_cached_mapping(cached);
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    void SingleTask::invalidate_cached_mappings(const RegionRequirement &req)
+    //--------------------------------------------------------------------------
+    {
+      if (cached_inline_mappings.empty())
+        return;
+      std::vector<InstanceRef> to_release;
+      {
+        AutoLock o_lock(op_lock);
+        for (std::list<CachedInlineMapping>::iterator it = 
+              cached_inline_mappings.begin(); it != 
+              cached_inline_mappings.end(); /*nothing*/)
+        {
+          const RegionRequirement &our_req = it->requirement;
+          if (check_region_dependence(our_req.region.get_tree_id(),
+                our_req.region.get_index_space(), our_req, 
+                RegionUsage(our_req), req))
+          {
+            to_release.push_back(it->reference);
+            it = cached_inline_mappings.erase(it);
+          }
+          else
+            it++;
+        }
+      }
+      for (std::vector<InstanceRef>::const_iterator it = 
+            to_release.begin(); it != to_release.end(); it++)
+        release_cached_mapping(*it);
+    }
+
+    //--------------------------------------------------------------------------
+    void SingleTask::clear_cached_mappings(void)
+    //--------------------------------------------------------------------------
+    {
+      if (cached_inline_mappings.empty())
+        return;
+      std::vector<InstanceRef> to_release;
+      {
+        AutoLock o_lock(op_lock);
+        for (std::list<CachedInlineMapping>::const_iterator it = 
+              cached_inline_mappings.begin(); it != 
+              cached_inline_mappings.end(); it++)
+          to_release.push_back(it->reference);
+        cached_inline_mappings.clear();
+      }
+      for (std::vector<InstanceRef>::const_iterator it = 
+            to_release.begin(); it != to_release.end(); it++)
+        release_cached_mapping(*it);
+    }
+
+    //--------------------------------------------------------------------------
+    void SingleTask::release_cached_mapping(const InstanceRef &ref)
+    //--------------------------------------------------------------------------
+    {
+      InstanceView *view = ref.get_instance_view();
+      if (view->remove_base_valid_ref(INLINE_MAPPING_REF))
+        LogicalView::delete_logical_view(view);
+    }
+
     //--------------------------------------------------------------------------
     bool SingleTask::is_region_mapped(unsigned idx)
     //--------------------------------------------------------------------------
@@ -4284,7 +4558,7 @@ namespace LegionRuntime {
           {
             if (!premapped)
               premap_task();
-            must_epoch->register_single_task(this, must_epoch_index);
+            must_epoch->register_single_task(this, must_epoch_index, this);
           }
           else
           {
@@ -4369,6 +4643,28 @@ namespace LegionRuntime {
       bool notify = false;
       if (!mapper_invoked)
         notify = runtime->invoke_mapper_map_task(current_proc, this);
+      // If we're running ahead of our predicate then everything we
+      // write has to be shadowed, so only permit mappings we can undo.
+      // Write-discard is mapped as read-write so that the instance 
+      // holds the valid data when we snapshot it, but only while we
+      // map and register so the mapper never sees the difference.
+      SpeculativeOp *speculation_owner = get_speculation_owner();
+      speculative_mapping = (speculation_owner != NULL) &&
+                            speculation_owner->is_speculative();
+      std::vector<unsigned> promoted_discards;
+      if (speculative_mapping)
+      {
+        for (unsigned idx = 0; idx < regions.size(); idx++)
+        {
+          regions[idx].virtual_map = false;
+          regions[idx].reduction_list = false;
+          if (regions[idx].privilege == WRITE_DISCARD)
+          {
+            regions[idx].privilege = READ_WRITE;
+            promoted_discards.push_back(idx);
+          }
+        }
+      }
       // Info for virtual mappings
       virtual_mapped.resize(regions.size(),false);
       locally_mapped.resize(regions.size(),true);
@@ -4462,11 +4758,21 @@ namespace LegionRuntime {
           break;
         }
       }
+      // Make our shadows before we register anything so that we
+      // can still back out if there isn't room for them
+      std::vector<ShadowInstance> shadows;
+      std::vector<ReductionView*> scratch_views;
+      if (map_success && speculative_mapping)
+        map_success = create_speculative_shadows(mapping_refs, 
+                                                 shadows, scratch_views);
 
       if (!map_success)
       {
         // Clean up our mess
         virtual_mapped.clear();
+        for (std::vector<unsigned>::const_iterator it = 
+              promoted_discards.begin(); it != promoted_discards.end(); it++)
+          regions[*it].privilege = WRITE_DISCARD;
         // Finally notify the mapper about the failed mapping
         runtime->invoke_mapper_failed_mapping(current_proc, this);
         for (unsigned idx = 0; idx < regions.size(); idx++)
@@ -4520,6 +4826,9 @@ namespace LegionRuntime {
 	    }
 #endif
             physical_instances[idx] = premapped;
+            if (speculative_mapping)
+              shadow_speculative_region(idx, shadows[idx], 
+                                        scratch_views[idx], user_event);
             continue;
           }
           // Finally, finish setting up the actual instance
@@ -4547,7 +4856,13 @@ namespace LegionRuntime {
           // All these better succeed since we already made the instances
           assert(physical_instances[idx].has_ref());
 #endif 
+          if (speculative_mapping)
+            shadow_speculative_region(idx, shadows[idx],
+                                      scratch_views[idx], user_event);
         }
+        for (std::vector<unsigned>::const_iterator it = 
+              promoted_discards.begin(); it != promoted_discards.end(); it++)
+          regions[*it].privilege = WRITE_DISCARD;
         executing_processor = target;
         if (notify)
           runtime->invoke_mapper_notify_result(current_proc, this);
@@ -4560,6 +4875,100 @@ namespace LegionRuntime {
       return map_success;
     }  
 
+    //--------------------------------------------------------------------------
+    bool SingleTask::create_speculative_shadows(
+                          const LegionVector<MappingRef>::aligned &mapping_refs,
+                          std::vector<ShadowInstance> &shadows,
+                          std::vector<ReductionView*> &scratch_views)
+    //--------------------------------------------------------------------------
+    {
+      shadows.resize(regions.size());
+      scratch_views.resize(regions.size(), NULL);
+      bool success = true;
+      for (unsigned idx = 0; idx < regions.size(); idx++)
+      {
+        if (virtual_mapped[idx] || IS_NO_ACCESS(regions[idx]) ||
+            !HAS_WRITE(regions[idx]))
+          continue;
+        PhysicalManager *manager = NULL;
+        InstanceRef premapped = find_premapped_region(idx);
+        if (premapped.has_ref())
+          manager = premapped.get_manager();
+        else
+          manager = mapping_refs[idx].get_view()->get_manager();
+        if (IS_REDUCE(regions[idx]))
+        {
+          // Reductions go into a scratch instance next to the real one
+          RegionNode *node = runtime->forest->get_node(regions[idx].region);
+          scratch_views[idx] = node->create_reduction(manager->memory,
+                                  *(regions[idx].privilege_fields.begin()),
+                                  false/*list*/, regions[idx].redop, this);
+          success = (scratch_views[idx] != NULL);
+        }
+        else
+          success = shadows[idx].allocate_undo(runtime->forest, regions[idx],
+                            manager->as_instance_manager(), unique_op_id);
+        if (!success)
+        {
+          regions[idx].mapping_failed = true;
+          break;
+        }
+      }
+      if (!success)
+      {
+        for (unsigned idx = 0; idx < regions.size(); idx++)
+        {
+          shadows[idx].release(Event::NO_EVENT);
+          // Nobody else knows about the scratch views so this
+          // is enough to have them cleaned up
+          if (scratch_views[idx] != NULL)
+          {
+            scratch_views[idx]->add_base_gc_ref(PENDING_GC_REF);
+            if (scratch_views[idx]->remove_base_gc_ref(PENDING_GC_REF))
+              LogicalView::delete_logical_view(scratch_views[idx]);
+          }
+        }
+        shadows.clear();
+        scratch_views.clear();
+      }
+      return success;
+    }
+
+    //--------------------------------------------------------------------------
+    void SingleTask::shadow_speculative_region(unsigned idx, 
+                                               ShadowInstance &shadow,
+                                               ReductionView *scratch_view,
+                                               Event user_event)
+    //--------------------------------------------------------------------------
+    {
+      if (scratch_view != NULL)
+      {
+        // Point the task at the scratch instance, the real instance
+        // only sees the reductions once the predicate confirms them
+        shadow.record_redo(regions[idx], scratch_view->manager,
+                           physical_instances[idx].get_reduction_view());
+        RegionNode *node = runtime->forest->get_node(regions[idx].region);
+        FieldMask user_mask = 
+          node->column_source->get_field_mask(regions[idx].privilege_fields);
+        InstanceRef scratch_ref = scratch_view->add_user(
+            RegionUsage(regions[idx]), user_event, user_mask, 
+            get_version_info(idx));
+        physical_instances[idx] = InstanceRef(Event::merge_events(
+              scratch_ref.get_ready_event(), 
+              physical_instances[idx].get_ready_event()), scratch_view);
+      }
+      else
+      {
+        Event snapshot_done = shadow.snapshot(runtime->forest, this,
+                                    physical_instances[idx].get_ready_event());
+        if (!snapshot_done.exists())
+          return;
+        physical_instances[idx] = InstanceRef(snapshot_done,
+                                  physical_instances[idx].get_instance_view());
+      }
+      task_shadows.push_back(shadow);
+    }
+
     //--------------------------------------------------------------------------
     void SingleTask::initialize_region_tree_contexts(
                       const std::vector<RegionRequirement> &clone_requirements,
@@ -5108,8 +5517,28 @@ namespace LegionRuntime {
       // avoid the race.
       bool perform_chaining_optimization = false; 
       UserEvent chain_complete_event;
-      if (chosen_variant.leaf && virtual_instances.empty() &&
-          can_early_complete(chain_complete_event))
+      // If we're speculative, then our termination event is instead
+      // held back until our owner commits or rolls back the shadows.
+      // Hand them over now since we might be cleaned up at any
+      // point once the task has been launched.
+      UserEvent speculation_executed = UserEvent::NO_USER_EVENT;
+      if (speculative_mapping)
+      {
+        UserEvent speculation_termination;
+#ifdef DEBUG_HIGH_LEVEL
+        bool held_back = 
+#endif
+          can_early_complete(speculation_termination);
+#ifdef DEBUG_HIGH_LEVEL
+        assert(held_back);
+#endif
+        speculation_executed = UserEvent::create_user_event();
+        get_speculation_owner()->record_speculative_execution(task_shadows,
+                                speculation_termination, speculation_executed);
+        task_shadows.clear();
+      }
+      else if (chosen_variant.leaf && virtual_instances.empty() &&
+               can_early_complete(chain_complete_event))
         perform_chaining_optimization = true;
       SingleTask *proxy_this = this; // dumb c++
       // Note there is a potential scary race condition to be aware of here: 
@@ -5152,6 +5581,8 @@ namespace LegionRuntime {
       // Finish the chaining optimization if we're doing it
       if (perform_chaining_optimization)
         chain_complete_event.trigger(task_launch_event);
+      if (speculation_executed.exists())
+        speculation_executed.trigger(task_launch_event);
       // STEP 4: After we've launched the task, then we have to release any 
       // locks that we took for while the task was running.  
       if (!atomic_locks.empty())
@@ -5220,6 +5651,9 @@ namespace LegionRuntime {
         pending_done = runtime->issue_runtime_meta_task(&decrement_args, 
             sizeof(decrement_args), HLR_DECREMENT_PENDING_TASK_ID, this);
       }
+      // Keep track of how long we run in case it turns out to be wasted
+      if (speculative_mapping)
+        speculative_start = Realm::Clock::current_time_in_microseconds();
       return physical_regions;
     }
 
@@ -5268,6 +5702,11 @@ namespace LegionRuntime {
       assert(regions.size() == region_deleted.size());
       assert(regions.size() == local_instances.size());
 #endif
+      if (speculative_mapping)
+        get_speculation_owner()->record_speculative_time(
+            Realm::Clock::current_time_in_microseconds() - speculative_start);
+      // Let go of any inline mappings we were holding onto
+      clear_cached_mappings();
       // Unmap all of the physical regions which are still mapped
       for (unsigned idx = 0; idx < regions.size(); idx++)
       {
@@ -5538,6 +5977,8 @@ namespace LegionRuntime {
       slices.clear(); 
       version_infos.clear();
       restrict_infos.clear();
+      // Remove our reference to the argument map
+      argument_map = ArgumentMap();
     }
 
     //--------------------------------------------------------------------------
@@ -5709,7 +6150,9 @@ namespace LegionRuntime {
                                      Processor p, bool recurse, bool stealable)
     //--------------------------------------------------------------------------
     {
-      this->clone_task_op_from(rhs, p, stealable, false/*duplicate*/);
+      this->clone_task_op_from(rhs, p, stealable);
+      // Share the argument map so our points can use it in place
+      this->argument_map = rhs->argument_map;
       this->index_domain = d;
       this->must_parallelism = rhs->must_parallelism;
       this->sliced = !recurse;
@@ -6161,12 +6604,8 @@ namespace LegionRuntime {
       update_grants(launcher.grants);
       wait_barriers = launcher.wait_barriers;
       update_arrival_barriers(launcher.arrive_barriers);
-      arglen = launcher.argument.get_size();
-      if (arglen > 0)
-      {
-        args = legion_malloc(TASK_ARGS_ALLOC, arglen);
-        memcpy(args,launcher.argument.get_ptr(),arglen);
-      }
+      initialize_arguments(launcher.argument.get_ptr(), 
+                           launcher.argument.get_size());
       map_id = launcher.map_id;
       tag = launcher.tag;
       index_point = launcher.point;
@@ -6282,12 +6721,7 @@ namespace LegionRuntime {
         regions[idx].copy_without_mapping_info(region_requirements[idx]);
         regions[idx].initialize_mapping_fields();
       }
-      arglen = arg.get_size();
-      if (arglen > 0)
-      {
-        args = legion_malloc(TASK_ARGS_ALLOC, arglen);
-        memcpy(args,arg.get_ptr(),arglen);
-      }
+      initialize_arguments(arg.get_ptr(), arg.get_size());
       map_id = mid;
       tag = t;
       is_index_space = false;
@@ -6572,6 +7006,7 @@ namespace LegionRuntime {
           args.target = result.impl;
           args.result = predicate_false_future.impl;
           args.task_op = this;
+          args.mispredicted = false;
           runtime->issue_runtime_meta_task(&args, sizeof(args),
                                            HLR_DEFERRED_FUTURE_SET_ID,
                                            this, wait_on);
@@ -6604,8 +7039,15 @@ namespace LegionRuntime {
     {
       if (target_proc != current_proc)
       {
-        runtime->send_task(target_proc, this);
-        return false;
+        // If we're running ahead of our predicate then the shadows
+        // have to be managed from this node so we can't go remote
+        if (!runtime->is_local(target_proc) && is_speculative())
+          target_proc = current_proc;
+        else
+        {
+          runtime->send_task(target_proc, this);
+          return false;
+        }
       }
       return true;
     }
@@ -6705,7 +7147,7 @@ namespace LegionRuntime {
     bool IndividualTask::is_stealable(void) const
     //--------------------------------------------------------------------------
     {
-      return ((!map_locally) && spawn_task);
+      return ((!map_locally) && spawn_task && !is_speculative());
     }
 
     //--------------------------------------------------------------------------
@@ -6733,6 +7175,15 @@ namespace LegionRuntime {
       return true;
     }
 
+    //--------------------------------------------------------------------------
+    SpeculativeOp* IndividualTask::get_speculation_owner(void)
+    //--------------------------------------------------------------------------
+    {
+      if (is_remote())
+        return NULL;
+      return this;
+    }
+
     //--------------------------------------------------------------------------
     VersionInfo& IndividualTask::get_version_info(unsigned idx)
     //--------------------------------------------------------------------------
@@ -6844,7 +7295,14 @@ namespace LegionRuntime {
           }
         }
 #endif
-
+        // Now that the predicate is known we can commit or roll back
+        // anything that we did speculatively and if we guessed wrong
+        // replace our result with the one for a false predicate
+        finalize_speculation();
+        // If the false future isn't ready yet then a meta-task
+        // will finish completing us once it has set our result
+        if (mispredicted && !set_mispredicted_result())
+          return;
         // The future has already been set so just trigger it
         result.impl->complete_future();
       }
@@ -6854,6 +7312,15 @@ namespace LegionRuntime {
         pack_remote_complete(rez);
         runtime->send_individual_remote_complete(orig_proc,rez);
       }
+      complete_mispredicted();
+    }
+
+    //--------------------------------------------------------------------------
+    void IndividualTask::complete_mispredicted(void)
+    //--------------------------------------------------------------------------
+    {
+      // This is also the tail of trigger_task_complete for every task
+      // that didn't have to wait for its false future
       // Invalidate any state that we had if we didn't already
       if (context.exists() && (!is_leaf() || !virtual_instances.empty()))
         invalidate_region_tree_contexts();
@@ -6875,6 +7342,44 @@ namespace LegionRuntime {
         trigger_children_committed();
     }
 
+    //--------------------------------------------------------------------------
+    bool IndividualTask::set_mispredicted_result(void)
+    //--------------------------------------------------------------------------
+    {
+      // Same as resolve_false except that we're already on the completion
+      // path, so the deferred meta-task finishes completing this task
+      if (predicate_false_future.impl != NULL)
+      {
+        Event wait_on = predicate_false_future.impl->get_ready_event();
+        if (!wait_on.has_triggered())
+        {
+          // Add references so they aren't garbage collected
+          result.impl->add_base_gc_ref(DEFERRED_TASK_REF);
+          predicate_false_future.impl->add_base_gc_ref(DEFERRED_TASK_REF);
+          Runtime::DeferredFutureSetArgs args;
+          args.hlr_id = HLR_DEFERRED_FUTURE_SET_ID;
+          args.target = result.impl;
+          args.result = predicate_false_future.impl;
+          args.task_op = this;
+          args.mispredicted = true;
+          runtime->issue_runtime_meta_task(&args, sizeof(args),
+                                           HLR_DEFERRED_FUTURE_SET_ID,
+                                           this, wait_on);
+          return false;
+        }
+        const size_t result_size = 
+          check_future_size(predicate_false_future.impl);
+        if (result_size > 0)
+          result.impl->set_result(
+              predicate_false_future.impl->get_untyped_result(),
+              result_size, false/*own*/);
+      }
+      else if (predicate_false_size > 0)
+        result.impl->set_result(predicate_false_result,
+                                predicate_false_size, false/*own*/);
+      return true;
+    }
+
     //--------------------------------------------------------------------------
     void IndividualTask::trigger_task_commit(void)
     //--------------------------------------------------------------------------
@@ -7334,6 +7839,7 @@ namespace LegionRuntime {
       // Point tasks never have to resolve speculation
       resolve_speculation();
       slice_owner = NULL;
+      owns_local_args = true;
       has_remote_subtasks = false;
     }
 
@@ -7341,6 +7847,12 @@ namespace LegionRuntime {
     void PointTask::deactivate(void)
     //--------------------------------------------------------------------------
     {
+      // Borrowed arguments get freed with their argument map
+      if (!owns_local_args)
+      {
+        local_args = NULL;
+        local_arglen = 0;
+      }
       deactivate_single();
       if (!remote_instances.empty())
       {
@@ -7479,6 +7991,13 @@ namespace LegionRuntime {
       return true;
     }
 
+    //--------------------------------------------------------------------------
+    SpeculativeOp* PointTask::get_speculation_owner(void)
+    //--------------------------------------------------------------------------
+    {
+      return slice_owner->get_speculation_owner();
+    }
+
     //--------------------------------------------------------------------------
     VersionInfo& PointTask::get_version_info(unsigned idx)
     //--------------------------------------------------------------------------
@@ -7694,7 +8213,7 @@ namespace LegionRuntime {
       slice_owner = owner;
       compute_point_region_requirements(mp);
       // Get our argument
-      mp->assign_argument(local_args, local_arglen);
+      owns_local_args = mp->assign_argument(local_args, local_arglen);
       // Make a new termination event for this point
       point_termination = UserEvent::create_user_event();
     } 
@@ -7811,6 +8330,14 @@ namespace LegionRuntime {
       return false;
     }
 
+    //--------------------------------------------------------------------------
+    SpeculativeOp* WrapperTask::get_speculation_owner(void)
+    //--------------------------------------------------------------------------
+    {
+      // Wrappers never map anything so they are never speculative
+      return NULL;
+    }
+
     //--------------------------------------------------------------------------
     void WrapperTask::trigger_task_complete(void)
     //--------------------------------------------------------------------------
@@ -8113,9 +8640,27 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       enclosing = enc;
+      // Parent region requirements are looked up in the enclosing task
+      parent_ctx = enc;
+      // Operations launched by the inlined task run on the enclosing
+      // task's processor and are reported under the child's name
+      task_id = clone->task_id;
+      variants = clone->variants;
+      selected_variant = clone->selected_variant;
+      map_id = clone->map_id;
+      tag = clone->tag;
+      executing_processor = enc->get_executing_processor();
+      orig_proc = executing_processor;
+      current_proc = executing_processor;
+      target_proc = executing_processor;
       indexes = clone->indexes;
       regions = clone->regions;
       physical_regions.resize(regions.size());
+      region_deleted.resize(regions.size(), false);
+      index_deleted.resize(indexes.size(), false);
+      // Everything the inlined task does is analyzed in the
+      // enclosing task's contexts (see compute_parent_indexes)
+      virtual_mapped.resize(regions.size(), true);
       // Now update the parent regions so that they are valid with
       // respect to the outermost context
       for (unsigned idx = 0; idx < indexes.size(); idx++)
@@ -8173,17 +8718,14 @@ namespace LegionRuntime {
     bool InlineTask::has_remote_state(void) const
     //--------------------------------------------------------------------------
     {
-      // should never be called
-      assert(false);
-      return false;
+      return enclosing->has_remote_state();
     }
 
     //--------------------------------------------------------------------------
     void InlineTask::record_remote_state(void)
     //--------------------------------------------------------------------------
     {
-      // should never be called
-      assert(false);
+      enclosing->record_remote_state();
     }
 
     //--------------------------------------------------------------------------
@@ -8191,8 +8733,7 @@ namespace LegionRuntime {
                                             RemoteTask *remote_ctx)
     //--------------------------------------------------------------------------
     {
-      // should never be called
-      assert(false);
+      enclosing->record_remote_instance(remote_inst, remote_ctx);
     }
 
     //--------------------------------------------------------------------------
@@ -8344,8 +8885,6 @@ namespace LegionRuntime {
         }
         locally_mapped_slices.clear();
       }
-      // Remove our reference to the argument map
-      argument_map = ArgumentMap();
       // Remove our reference to the future map
       future_map = FutureMap();
       if (predicate_false_result != NULL)
@@ -8384,17 +8923,8 @@ namespace LegionRuntime {
       update_grants(launcher.grants);
       wait_barriers = launcher.wait_barriers;
       update_arrival_barriers(launcher.arrive_barriers);
-      arglen = launcher.global_arg.get_size();
-      if (arglen > 0)
-      {
-#ifdef DEBUG_HIGH_LEVEL
-        assert(arg_manager == NULL);
-#endif
-        arg_manager = legion_new<AllocManager>(arglen);
-        arg_manager->add_reference();
-        args = arg_manager->get_allocation();
-        memcpy(args, launcher.global_arg.get_ptr(), arglen);
-      }
+      initialize_arguments(launcher.global_arg.get_ptr(),
+                           launcher.global_arg.get_size());
       argument_map = ArgumentMap(launcher.argument_map.impl->freeze());
       map_id = launcher.map_id;
       tag = launcher.tag;
@@ -8455,17 +8985,8 @@ namespace LegionRuntime {
       update_grants(launcher.grants);
       wait_barriers = launcher.wait_barriers;
       update_arrival_barriers(launcher.arrive_barriers);
-      arglen = launcher.global_arg.get_size();
-      if (arglen > 0)
-      {
-#ifdef DEBUG_HIGH_LEVEL
-        assert(arg_manager == NULL);
-#endif
-        arg_manager = legion_new<AllocManager>(arglen);
-        arg_manager->add_reference();
-        args = arg_manager->get_allocation();
-        memcpy(args, launcher.global_arg.get_ptr(), arglen);
-      }
+      initialize_arguments(launcher.global_arg.get_ptr(),
+                           launcher.global_arg.get_size());
       argument_map = ArgumentMap(launcher.argument_map.impl->freeze());
       map_id = launcher.map_id;
       tag = launcher.tag;
@@ -8540,17 +9061,7 @@ namespace LegionRuntime {
         regions[idx].copy_without_mapping_info(region_requirements[idx]);
         regions[idx].initialize_mapping_fields();
       }
-      arglen = global_arg.get_size();
-      if (arglen > 0)
-      {
-#ifdef DEBUG_HIGH_LEVEL
-        assert(arg_manager == NULL);
-#endif
-        arg_manager = legion_new<AllocManager>(arglen);
-        arg_manager->add_reference();
-        args = arg_manager->get_allocation();
-        memcpy(args, global_arg.get_ptr(), arglen);
-      }
+      initialize_arguments(global_arg.get_ptr(), global_arg.get_size());
       argument_map = ArgumentMap(arg_map.impl->freeze());
       map_id = mid;
       tag = t;
@@ -8611,17 +9122,7 @@ namespace LegionRuntime {
         regions[idx].copy_without_mapping_info(region_requirements[idx]);
         regions[idx].initialize_mapping_fields();
       }
-      arglen = global_arg.get_size();
-      if (arglen > 0)
-      {
-#ifdef DEBUG_HIGH_LEVEL
-        assert(arg_manager == NULL);
-#endif
-        arg_manager = legion_new<AllocManager>(arglen);
-        arg_manager->add_reference();
-        args = arg_manager->get_allocation();
-        memcpy(args, global_arg.get_ptr(), arglen);
-      }
+      initialize_arguments(global_arg.get_ptr(), global_arg.get_size());
       argument_map = ArgumentMap(arg_map.impl->freeze());
       map_id = mid;
       tag = t;
@@ -9022,6 +9523,7 @@ namespace LegionRuntime {
             args.result = predicate_false_future.impl;
             args.domain = index_domain;
             args.task_op = this;
+            args.mispredicted = false;
             runtime->issue_runtime_meta_task(&args, sizeof(args),
                                              HLR_DEFERRED_FUTURE_MAP_SET_ID,
                                              this, wait_on);
@@ -9064,6 +9566,7 @@ namespace LegionRuntime {
             args.target = reduction_future.impl;
             args.result = predicate_false_future.impl;
             args.task_op = this;
+            args.mispredicted = false;
             runtime->issue_runtime_meta_task(&args, sizeof(args),
                                              HLR_DEFERRED_FUTURE_SET_ID,
                                              this, wait_on);
@@ -9228,6 +9731,12 @@ namespace LegionRuntime {
 
       // Return back our privileges
       return_privilege_state(parent_ctx);
+      // Commit or roll back anything the points did speculatively
+      finalize_speculation();
+      // If the false future isn't ready yet then a meta-task
+      // will finish completing us once it has set our futures
+      if (mispredicted && !set_mispredicted_result())
+        return;
 
       // Trigger all the futures or set the reduction future result
       // and then trigger it
@@ -9241,12 +9750,84 @@ namespace LegionRuntime {
       }
       else
         future_map.impl->complete_all_futures();
+      complete_mispredicted();
+    }
 
+    //--------------------------------------------------------------------------
+    void IndexTask::complete_mispredicted(void)
+    //--------------------------------------------------------------------------
+    {
+      // This is also the tail of trigger_task_complete for every task
+      // that didn't have to wait for its false future
       complete_operation();
-      if (speculation_state == RESOLVE_FALSE_STATE)
+      // If we guessed wrong the slices still ran and will
+      // report back their commits like they normally do
+      if ((speculation_state == RESOLVE_FALSE_STATE) && !mispredicted)
         trigger_children_committed();
     }
 
+    //--------------------------------------------------------------------------
+    bool IndexTask::set_mispredicted_result(void)
+    //--------------------------------------------------------------------------
+    {
+      // Same as resolve_false except that we're already on the completion
+      // path, so the deferred meta-task finishes completing this task
+      const void *false_result = predicate_false_result;
+      size_t false_size = predicate_false_size;
+      if (predicate_false_future.impl != NULL)
+      {
+        Event wait_on = predicate_false_future.impl->get_ready_event();
+        if (!wait_on.has_triggered())
+        {
+          predicate_false_future.impl->add_base_gc_ref(DEFERRED_TASK_REF);
+          if (redop == 0)
+          {
+            future_map.impl->add_reference();
+            Runtime::DeferredFutureMapSetArgs args;
+            args.hlr_id = HLR_DEFERRED_FUTURE_MAP_SET_ID;
+            args.future_map = future_map.impl;
+            args.result = predicate_false_future.impl;
+            args.domain = index_domain;
+            args.task_op = this;
+            args.mispredicted = true;
+            runtime->issue_runtime_meta_task(&args, sizeof(args),
+                                             HLR_DEFERRED_FUTURE_MAP_SET_ID,
+                                             this, wait_on);
+          }
+          else
+          {
+            reduction_future.impl->add_base_gc_ref(DEFERRED_TASK_REF);
+            Runtime::DeferredFutureSetArgs args;
+            args.hlr_id = HLR_DEFERRED_FUTURE_SET_ID;
+            args.target = reduction_future.impl;
+            args.result = predicate_false_future.impl;
+            args.task_op = this;
+            args.mispredicted = true;
+            runtime->issue_runtime_meta_task(&args, sizeof(args),
+                                             HLR_DEFERRED_FUTURE_SET_ID,
+                                             this, wait_on);
+          }
+          return false;
+        }
+        false_size = check_future_size(predicate_false_future.impl);
+        false_result = predicate_false_future.impl->get_untyped_result();
+      }
+      if (false_size == 0)
+        return true;
+      if (redop == 0)
+      {
+        for (Domain::DomainPointIterator itr(index_domain); itr; itr++)
+        {
+          Future f = future_map.get_future(itr.p);
+          f.impl->set_result(false_result, false_size, false/*own*/);
+        }
+      }
+      else
+        reduction_future.impl->set_result(false_result, false_size,
+                                          false/*own*/);
+      return true;
+    }
+
     //--------------------------------------------------------------------------
     void IndexTask::trigger_task_commit(void)
     //--------------------------------------------------------------------------
@@ -9349,6 +9930,9 @@ namespace LegionRuntime {
           fold_reduction_future(result, result_size, 
                                 true/*owner*/, true/*exclusive*/);
       }
+      // The local arguments were borrowed from the argument map
+      local_args = NULL;
+      local_arglen = 0;
       if (redop == 0)
         future_map.impl->complete_all_futures();
       else
@@ -9435,6 +10019,19 @@ namespace LegionRuntime {
         point->add_argument(arg, false/*own*/);
         minimal_points[itr.p] = point;
       }
+      // Projections are computed for all the points of a requirement
+      // at once, so gather the points in the same order as the map
+      std::vector<DomainPoint> point_list;
+      std::vector<MinimalPoint*> point_data;
+      point_list.reserve(minimal_points.size());
+      point_data.reserve(minimal_points.size());
+      for (std::map<DomainPoint,MinimalPoint*>::const_iterator it = 
+            minimal_points.begin(); it != minimal_points.end(); it++)
+      {
+        point_list.push_back(it->first);
+        point_data.push_back(it->second);
+      }
+      std::vector<LogicalRegion> projected;
       // Figure out which requirements are projection and update them
       for (unsigned idx = 0; idx < regions.size(); idx++)
       {
@@ -9445,25 +10042,20 @@ namespace LegionRuntime {
           // Check to see if we're doing default projection
           if (regions[idx].projection == 0)
           {
-            for (std::map<DomainPoint,MinimalPoint*>::const_iterator it = 
-                  minimal_points.begin(); it != minimal_points.end(); it++)
+            if (index_domain.get_dim() > 3)
             {
-              if (it->first.get_dim() > 3)
-              {
-                log_task.error("Projection ID 0 is invalid for tasks whose "
-                                     "points are larger than three dimensional "
-                                     "unsigned integers.  Points for task %s "
-                                     "have elements of %d dimensions",
-                                  this->variants->name, it->first.get_dim());
+              log_task.error("Projection ID 0 is invalid for tasks whose "
+                                   "points are larger than three dimensional "
+                                   "unsigned integers.  Points for task %s "
+                                   "have elements of %d dimensions",
+                                this->variants->name, index_domain.get_dim());
 #ifdef DEBUG_HIGH_LEVEL
-                assert(false);
+              assert(false);
 #endif
-                exit(ERROR_INVALID_IDENTITY_PROJECTION_USE);
-              }
-              it->second->add_projection_region(idx, 
-                runtime->forest->get_logical_subregion_by_color(
-                    regions[idx].partition, ColorPoint(it->first)));
+              exit(ERROR_INVALID_IDENTITY_PROJECTION_USE);
             }
+            runtime->forest->get_logical_subregions_by_color(
+                regions[idx].partition, point_list, projected);
           }
           else
           {
@@ -9474,24 +10066,16 @@ namespace LegionRuntime {
               PartitionProjectionFnptr projfn = 
                   Runtime::find_partition_projection_function(
                       regions[idx].projection);
-              for (std::map<DomainPoint,MinimalPoint*>::const_iterator it = 
-                    minimal_points.begin(); it != minimal_points.end(); it++)
-              {
-                it->second->add_projection_region(idx,  
-                    (*projfn)(regions[idx].partition,
-                              it->first,runtime->high_level));
-              }
+              projected.resize(point_list.size());
+              for (unsigned pidx = 0; pidx < point_list.size(); pidx++)
+                projected[pidx] = (*projfn)(regions[idx].partition,
+                                            point_list[pidx],
+                                            runtime->high_level);
             }
             else
-            {
-              for (std::map<DomainPoint,MinimalPoint*>::const_iterator it = 
-                    minimal_points.begin(); it != minimal_points.end(); it++)
-              {
-                it->second->add_projection_region(idx,
-                    functor->project(DUMMY_CONTEXT, this, idx,
-                                     regions[idx].partition, it->first));
-              }
-            }
+              functor->project_points(DUMMY_CONTEXT, this, idx,
+                                      regions[idx].partition, 
+                                      point_list, projected);
           }
         }
         else
@@ -9508,24 +10092,16 @@ namespace LegionRuntime {
               RegionProjectionFnptr projfn = 
                 Runtime::find_region_projection_function(
                     regions[idx].projection);
-              for (std::map<DomainPoint,MinimalPoint*>::const_iterator it = 
-                    minimal_points.begin(); it != minimal_points.end(); it++)
-              {
-                it->second->add_projection_region(idx, 
-                  (*projfn)(regions[idx].region,
-                            it->first, runtime->high_level));
-              }
+              projected.resize(point_list.size());
+              for (unsigned pidx = 0; pidx < point_list.size(); pidx++)
+                projected[pidx] = (*projfn)(regions[idx].region,
+                                            point_list[pidx],
+                                            runtime->high_level);
             }
             else
-            {
-              for (std::map<DomainPoint,MinimalPoint*>::const_iterator it = 
-                    minimal_points.begin(); it != minimal_points.end(); it++)
-              {
-                it->second->add_projection_region(idx, 
-                  functor->project(DUMMY_CONTEXT, this, idx, 
-                                   regions[idx].region, it->first));
-              }
-            }
+              functor->project_points(DUMMY_CONTEXT, this, idx,
+                                      regions[idx].region,
+                                      point_list, projected);
           }
           else
           {
@@ -9535,8 +10111,14 @@ namespace LegionRuntime {
             // to be singular since all points will use 
             // the same logical region
             regions[idx].handle_type = SINGULAR;
+            continue;
           }
         }
+#ifdef DEBUG_HIGH_LEVEL
+        assert(projected.size() == point_data.size());
+#endif
+        for (unsigned pidx = 0; pidx < point_data.size(); pidx++)
+          point_data[pidx]->add_projection_region(idx, projected[pidx]);
       }
     }
 
@@ -9961,10 +10543,19 @@ namespace LegionRuntime {
         return true;
       if (target_proc != current_proc)
       {
-        runtime->send_task(target_proc,this);
-        // The runtime will deactivate this task
-        // after it has been sent
-        return false;
+        // If the index space launch is running ahead of its predicate
+        // then the shadows have to be managed from this node
+        SpeculativeOp *speculation_owner = get_speculation_owner();
+        if (!runtime->is_local(target_proc) && (speculation_owner != NULL) &&
+            speculation_owner->is_speculative())
+          target_proc = current_proc;
+        else
+        {
+          runtime->send_task(target_proc,this);
+          // The runtime will deactivate this task
+          // after it has been sent
+          return false;
+        }
       }
       return true;
     }
@@ -9983,7 +10574,7 @@ namespace LegionRuntime {
       {
         // Check to see if we already enumerated all the points, if
         // not then do so now
-        if (points.empty())
+        if (!minimal_points.empty())
           enumerate_points();
 
         for (unsigned idx = 0; idx < points.size(); idx++)
@@ -10058,7 +10649,22 @@ namespace LegionRuntime {
     bool SliceTask::is_stealable(void) const
     //--------------------------------------------------------------------------
     {
-      return ((!map_locally) && spawn_task);
+      if (map_locally || !spawn_task)
+        return false;
+      SpeculativeOp *speculation_owner = get_speculation_owner();
+      return ((speculation_owner == NULL) || 
+              !speculation_owner->is_speculative());
+    }
+
+    //--------------------------------------------------------------------------
+    SpeculativeOp* SliceTask::get_speculation_owner(void) const
+    //--------------------------------------------------------------------------
+    {
+      // Remote slices are never speculative since they can't be sent
+      // anywhere while the index space launch is running ahead
+      if (is_remote())
+        return NULL;
+      return index_owner;
     }
 
     //--------------------------------------------------------------------------
@@ -10090,39 +10696,50 @@ namespace LegionRuntime {
       // Mark that this task is no longer stealable.  Once we start
       // executing things onto a specific processor slices cannot move.
       spawn_task = false;
-      // First enumerate all of our points if we haven't already done so
-      if (points.empty())
-        enumerate_points();
-#ifdef DEBUG_HIGH_LEVEL
-      assert(!points.empty());
-      assert(mapping_index <= points.size());
-#endif
-      // Now try mapping and then launching all the points starting
-      // at the index of the last known good index
-      // Copy the points onto the stack to avoid them being
-      // cleaned up while we are still iterating through the loop
-      std::vector<PointTask*> local_points(points.size()-mapping_index);
-      for (unsigned idx = mapping_index; idx < points.size(); idx++)
-        local_points[idx-mapping_index] = points[idx];
-      for (std::vector<PointTask*>::const_iterator it = local_points.begin();
-            it != local_points.end(); it++)
-      {
-        PointTask *next_point = *it;
-        bool point_success = next_point->perform_mapping();
-        if (!point_success)
-        {
-          map_success = false;    
-          break;
-        }
-        else
-        {
-          // Otherwise update the mapping index and then launch
-          // the point (it is imperative that these happen in this order!)
-          mapping_index++;
-          // Once we call this function on the last point it
-          // is possible that this slice task object can be recycled
-          next_point->launch_task();
+      // Point tasks are only made for a chunk of points at a time, so
+      // the first points can start running before the rest exist
+      while (true)
+      {
+        if ((mapping_index == points.size()) && !minimal_points.empty())
+          enumerate_points(POINT_EXPANSION_CHUNK);
+#ifdef DEBUG_HIGH_LEVEL
+        assert(!points.empty());
+        assert(mapping_index <= points.size());
+#endif
+        // Note whether this is the last chunk before launching any of
+        // it since after the last point is launched we can't look at
+        // anything in this slice task
+        const bool last_chunk = minimal_points.empty();
+        // Now try mapping and then launching all the points starting
+        // at the index of the last known good index
+        // Copy the points onto the stack to avoid them being
+        // cleaned up while we are still iterating through the loop
+        std::vector<PointTask*> local_points(points.size()-mapping_index);
+        for (unsigned idx = mapping_index; idx < points.size(); idx++)
+          local_points[idx-mapping_index] = points[idx];
+        for (std::vector<PointTask*>::const_iterator it = 
+              local_points.begin(); it != local_points.end(); it++)
+        {
+          PointTask *next_point = *it;
+          bool point_success = next_point->perform_mapping();
+          if (!point_success)
+          {
+            map_success = false;    
+            break;
+          }
+          else
+          {
+            // Otherwise update the mapping index and then launch
+            // the point (it is imperative that these happen in this 
+            // order!)
+            mapping_index++;
+            // Once we call this function on the last point it
+            // is possible that this slice task object can be recycled
+            next_point->launch_task();
+          }
         }
+        if (!map_success || last_chunk)
+          break;
       }
       return map_success;
     }
@@ -10359,14 +10976,14 @@ namespace LegionRuntime {
 #ifdef DEBUG_HIGH_LEVEL
       assert(must_epoch != NULL);
 #endif
-      if (points.empty())
+      if (!minimal_points.empty())
         enumerate_points();
       must_epoch->register_slice_task(this);
       for (unsigned idx = 0; idx < points.size(); idx++)
       {
         PointTask *point = points[idx];
         point->premap_task();
-        must_epoch->register_single_task(point, must_epoch_index);
+        must_epoch->register_single_task(point, must_epoch_index, this);
       }
     }
 
@@ -10380,7 +10997,7 @@ namespace LegionRuntime {
                                    false/*track*/, Predicate::TRUE_PRED,
                                    this->task_id);
       result->clone_task_op_from(this, this->target_proc, 
-                                 false/*stealable*/, true/*duplicate*/);
+                                 false/*stealable*/);
       result->enclosing_contexts = this->enclosing_contexts;
       result->is_index_space = true;
       result->must_parallelism = this->must_parallelism;
@@ -10403,7 +11020,42 @@ namespace LegionRuntime {
     }
 
     //--------------------------------------------------------------------------
-    void SliceTask::enumerate_points(void)
+    void SliceTask::enumerate_points(size_t max_points)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_HIGH_LEVEL
+      assert(max_points > 0);
+      assert(!minimal_points.empty());
+#endif
+      // Only the first call has to set things up, later ones just
+      // expand more of the minimal points
+      if (points.empty())
+      {
+        begin_enumeration();
+        mapping_index = 0;
+        // Mark how many points we have
+        num_unmapped_points = minimal_points.size();
+        num_uncomplete_points = minimal_points.size();
+        num_uncommitted_points = minimal_points.size();
+      }
+      // Enumerate the points, deleting the minimal points as we go
+      while (!minimal_points.empty() && (max_points-- > 0))
+      {
+        std::map<DomainPoint,MinimalPoint*>::iterator it = 
+          minimal_points.begin();
+        PointTask *next_point = clone_as_point_task(it->first, it->second);
+        points.push_back(next_point);
+        delete it->second;
+        minimal_points.erase(it);
+      }
+#ifdef DEBUG_HIGH_LEVEL
+      if (minimal_points.empty())
+        assert(index_domain.get_volume() == points.size());
+#endif
+    }
+
+    //--------------------------------------------------------------------------
+    void SliceTask::begin_enumeration(void)
     //--------------------------------------------------------------------------
     {
       // Before we enumerate the points, ask the mapper to pick the
@@ -10428,27 +11080,9 @@ namespace LegionRuntime {
                                   selected_variant);
 #endif
 #ifdef DEBUG_HIGH_LEVEL
-      assert(index_domain.get_volume() > 0);
-#endif
-      // Enumerate all the points
-      for (std::map<DomainPoint,MinimalPoint*>::const_iterator it = 
-            minimal_points.begin(); it != minimal_points.end(); it++)
-      {
-        PointTask *next_point = clone_as_point_task(it->first, it->second);
-        points.push_back(next_point);
-        // We can now delete our old minimal points
-        delete it->second;
-      }
-      minimal_points.clear();
-#ifdef DEBUG_HIGH_LEVEL
-      assert(index_domain.get_volume() == points.size());
+      assert(index_domain.get_volume() == minimal_points.size());
 #endif
-      mapping_index = 0;
-      // Mark how many points we have
-      num_unmapped_points = points.size();
-      num_uncomplete_points = points.size();
-      num_uncommitted_points = points.size();
-    } 
+    }
 
     //--------------------------------------------------------------------------
     void SliceTask::trigger_task_complete(void)
@@ -10758,7 +11392,6 @@ namespace LegionRuntime {
       : owner(own)
     //--------------------------------------------------------------------------
     {
-      slice_lock = Reservation::create_reservation();
     }
 
     //--------------------------------------------------------------------------
@@ -10774,8 +11407,6 @@ namespace LegionRuntime {
     DeferredSlicer::~DeferredSlicer(void)
     //--------------------------------------------------------------------------
     {
-      slice_lock.destroy_reservation();
-      slice_lock = Reservation::NO_RESERVATION;
     }
 
     //--------------------------------------------------------------------------
@@ -10791,27 +11422,32 @@ namespace LegionRuntime {
     bool DeferredSlicer::trigger_slices(std::list<SliceTask*> &slices)
     //--------------------------------------------------------------------------
     {
-      // Watch out for the cleanup race with some acrobatics here
-      // to handle the case where the iterator is invalidated
+      // Watch out for the cleanup race: once the last slice has been
+      // triggered the owner can be cleaned up out from under us if all
+      // the slices succeed, so copy off everything we need first
+      std::vector<SliceTask*> to_trigger(slices.begin(), slices.end());
+#ifdef DEBUG_HIGH_LEVEL
+      assert(!to_trigger.empty());
+#endif
+      failed.resize(to_trigger.size(), 0);
+      Runtime *const rt = owner->runtime;
       std::set<Event> wait_events;
       {
-        std::list<SliceTask*>::const_iterator it = slices.begin();
         DeferredSliceArgs args;
         args.hlr_id = HLR_DEFERRED_SLICE_ID;
         args.slicer = this;
-        while (true) 
+        for (unsigned idx = 0; idx < (to_trigger.size()-1); idx++)
         {
-          args.slice = *it;
-          it++;
-          bool done = (it == slices.end()); 
-          Event wait = owner->runtime->issue_runtime_meta_task(&args, 
-                                sizeof(args), HLR_DEFERRED_SLICE_ID, owner);
+          args.slice = to_trigger[idx];
+          args.index = idx;
+          Event wait = rt->issue_runtime_meta_task(&args, sizeof(args), 
+                                              HLR_DEFERRED_SLICE_ID, owner);
           if (wait.exists())
             wait_events.insert(wait);
-          if (done)
-            break;
         }
       }
+      // Trigger the last slice ourselves rather than sitting idle
+      perform_slice(to_trigger.back(), to_trigger.size()-1);
 
       // Now we wait for the slices to trigger, note we do not
       // block on the event allowing the utility processor to 
@@ -10822,6 +11458,12 @@ namespace LegionRuntime {
         sliced_event.wait();
       }
 
+      std::set<SliceTask*> failed_slices;
+      for (unsigned idx = 0; idx < failed.size(); idx++)
+      {
+        if (failed[idx])
+          failed_slices.insert(to_trigger[idx]);
+      }
       bool success = failed_slices.empty();
       // If there were some slices that didn't succeed, then we
       // need to clean up the ones that did so we know when
@@ -10845,14 +11487,11 @@ namespace LegionRuntime {
     }
 
     //--------------------------------------------------------------------------
-    void DeferredSlicer::perform_slice(SliceTask *slice)
+    void DeferredSlicer::perform_slice(SliceTask *slice, unsigned index)
     //--------------------------------------------------------------------------
     {
       if (!slice->trigger_execution())
-      {
-        AutoLock s_lock(slice_lock);
-        failed_slices.insert(slice);
-      }
+        failed[index] = 1;
     }
 
     //--------------------------------------------------------------------------
@@ -10860,7 +11499,7 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       const DeferredSliceArgs *slice_args = (const DeferredSliceArgs*)args;
-      slice_args->slicer->perform_slice(slice_args->slice);
+      slice_args->slicer->perform_slice(slice_args->slice, slice_args->index);
     }
 
     /////////////////////////////////////////////////////////////
@@ -10910,9 +11549,9 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
 #ifdef DEBUG_HIGH_LEVEL
-      assert(projections.find(idx) == projections.end());
+      assert(projections.empty() || (projections.back().first < idx));
 #endif
-      projections[idx] = handle;
+      projections.push_back(std::pair<unsigned,LogicalRegion>(idx, handle));
     }
     
     //--------------------------------------------------------------------------
@@ -10928,7 +11567,7 @@ namespace LegionRuntime {
     }
 
     //--------------------------------------------------------------------------
-    void MinimalPoint::assign_argument(void *&local_arg, size_t &local_arglen)
+    bool MinimalPoint::assign_argument(void *&local_arg, size_t &local_arglen)
     //--------------------------------------------------------------------------
     {
       // If we own it, we can just give it      
@@ -10939,26 +11578,31 @@ namespace LegionRuntime {
         arg = 0;
         arglen = 0;
         own_arg = false;
+        return true;
       }
-      else if (arg != NULL)
-      {
-        local_arglen = arglen;
-        local_arg = malloc(arglen);
-        memcpy(local_arg, arg, arglen);
-      }
-      // Otherwise there is no argument so we are done
+      // Otherwise it lives in the argument map of the index space
+      // launch which the slice keeps alive for as long as its points
+      // so we can just point at it rather than making a copy
+      local_arg = arg;
+      local_arglen = arglen;
+      return false;
     }
 
     //--------------------------------------------------------------------------
     LogicalRegion MinimalPoint::find_logical_region(unsigned index)
     //--------------------------------------------------------------------------
     {
-      std::map<unsigned,LogicalRegion>::const_iterator finder = 
-        projections.find(index);
+      // Only a few requirements are projections, so a scan is fine
+      for (std::vector<std::pair<unsigned,LogicalRegion> >::const_iterator it =
+            projections.begin(); it != projections.end(); it++)
+      {
+        if (it->first == index)
+          return it->second;
+      }
 #ifdef DEBUG_HIGH_LEVEL
-      assert(finder != projections.end());
+      assert(false);
 #endif
-      return finder->second;
+      return LogicalRegion::NO_REGION;
     }
 
     //--------------------------------------------------------------------------
@@ -10966,7 +11610,7 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       rez.serialize<size_t>(projections.size());
-      for (std::map<unsigned,LogicalRegion>::const_iterator it = 
+      for (std::vector<std::pair<unsigned,LogicalRegion> >::const_iterator it =
             projections.begin(); it != projections.end(); it++)
       {
         rez.serialize(it->first);
@@ -10983,11 +11627,11 @@ namespace LegionRuntime {
     {
       size_t num_projections;
       derez.deserialize(num_projections);
+      projections.resize(num_projections);
       for (unsigned idx = 0; idx < num_projections; idx++)
       {
-        unsigned index;
-        derez.deserialize(index);
-        derez.deserialize(projections[index]);
+        derez.deserialize(projections[idx].first);
+        derez.deserialize(projections[idx].second);
       }
       derez.deserialize(arglen);
       if (arglen > 0)
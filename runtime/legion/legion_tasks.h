@@ -70,6 +70,7 @@ namespace LegionRuntime {
                                 Processor::TaskFuncID tid);
       void check_empty_field_requirements(void);
       size_t check_future_size(Future::Impl *impl);
+      bool can_speculate(void) const;
     public:
       virtual void activate(void) = 0;
       virtual void deactivate(void) = 0;
@@ -82,6 +83,8 @@ namespace LegionRuntime {
       virtual void trigger_commit(void);
       virtual void resolve_true(void);
       virtual void resolve_false(void) = 0;
+      // Called once a deferred mispredicted result has been set
+      virtual void complete_mispredicted(void);
       virtual bool speculate(bool &value);
       virtual unsigned find_parent_index(unsigned idx);
       virtual VersionInfo& get_version_info(unsigned idx);
@@ -156,13 +159,18 @@ namespace LegionRuntime {
       void perform_privilege_checks(void);
     public:
       InstanceRef find_premapped_region(unsigned idx);
-      void clone_task_op_from(TaskOp *rhs, Processor p, 
-                              bool stealable, bool duplicate_args);
+      void clone_task_op_from(TaskOp *rhs, Processor p, bool stealable);
       void update_grants(const std::vector<Grant> &grants);
       void update_arrival_barriers(const std::vector<PhaseBarrier> &barriers);
       void compute_point_region_requirements(MinimalPoint *mp = NULL);
       bool early_map_regions(std::set<Event> &applied_conditions);
       bool prepare_steal(void);
+    protected:
+      // Task arguments always live in a reference counted buffer so
+      // every task on this node that refers to them (slices and points)
+      // can share them; they only get copied when packed for another node
+      void initialize_arguments(const void *ptr, size_t size);
+      void share_arguments(TaskOp *rhs);
     protected:
       void compute_parent_indexes(void);
       void record_aliased_region_requirements(LegionTrace *trace);
@@ -205,6 +213,11 @@ namespace LegionRuntime {
       bool children_commit_invoked;
     protected:
       AllocManager *arg_manager;
+    public:
+      // Intrusive link and timestamp used by the processor
+      // manager while this task is waiting to be mapped
+      TaskOp *next_ready;
+      unsigned long long ready_time;
     public:
       // Static methods
       static void process_unpack_task(Runtime *rt,
@@ -419,6 +432,18 @@ namespace LegionRuntime {
                                   const RegionRequirement &req);
       void register_inline_mapped_region(PhysicalRegion &region);
       void unregister_inline_mapped_region(PhysicalRegion &region);
+    public:
+      void cache_inline_mapping(const PhysicalRegion &region);
+      PhysicalRegion find_cached_inline_mapping(const RegionRequirement &req,
+                                                MapperID id, MappingTagID tag);
+      bool remap_cached_inline_mapping(const PhysicalRegion &region);
+      void invalidate_cached_mappings(const RegionRequirement &req);
+      void clear_cached_mappings(void);
+    protected:
+      bool acquire_cached_mapping(const RegionRequirement &req, MapperID id,
+                                  MappingTagID tag, UserEvent &term_event,
+                                  InstanceRef &result);
+      void release_cached_mapping(const InstanceRef &ref);
     public:
       bool is_region_mapped(unsigned idx);
       int find_parent_region_req(const RegionRequirement &req, 
@@ -441,6 +466,13 @@ namespace LegionRuntime {
     protected:
       bool map_all_regions(Processor target, Event user_event, 
                            bool mapper_invoked); 
+      bool create_speculative_shadows(
+                    const LegionVector<MappingRef>::aligned &mapping_refs,
+                    std::vector<ShadowInstance> &shadows,
+                    std::vector<ReductionView*> &scratch_views);
+      void shadow_speculative_region(unsigned idx, ShadowInstance &shadow,
+                                     ReductionView *scratch_view,
+                                     Event user_event);
       void initialize_region_tree_contexts(
           const std::vector<RegionRequirement> &clone_requirements,
           const std::vector<UserEvent> &unmap_events,
@@ -479,6 +511,9 @@ namespace LegionRuntime {
       virtual bool is_stealable(void) const = 0;
       virtual bool has_restrictions(unsigned idx, LogicalRegion handle) = 0;
       virtual bool can_early_complete(UserEvent &chain_event) = 0;
+      // The operation that knows whether this task is running ahead
+      // of its predicate, NULL if the task can never be speculative
+      virtual SpeculativeOp* get_speculation_owner(void) = 0;
     public:
       virtual Event get_task_completion(void) const = 0;
       virtual TaskKind get_task_kind(void) const = 0;
@@ -532,6 +567,17 @@ namespace LegionRuntime {
       // so we can see when there are conflicts
       LegionList<PhysicalRegion,TASK_INLINE_REGION_ALLOC>::tracked
                                                    inline_regions;
+      // Inline mappings the application has unmapped which we can
+      // hand back out on a remap as long as no conflicting operation
+      // has been launched in this context in the meantime
+      struct CachedInlineMapping {
+      public:
+        RegionRequirement requirement;
+        MapperID map_id;
+        MappingTagID tag;
+        InstanceRef reference;
+      };
+      std::list<CachedInlineMapping> cached_inline_mappings;
       // Context for this task
       RegionTreeContext context; 
       unsigned initial_region_count;
@@ -577,6 +623,12 @@ namespace LegionRuntime {
     protected:
       // Some help for performing fast safe casts
       std::map<IndexSpace,Domain> safe_cast_domains;
+    protected:
+      // Whether the current mapping is ahead of the predicate along
+      // with the shadows that we need to hand over to the owner
+      bool speculative_mapping;
+      std::vector<ShadowInstance> task_shadows;
+      long long speculative_start;
     protected:
       // Information for tracking restrictions
       LegionMap<RegionTreeID,FieldMask>::aligned restricted_trees;
@@ -664,6 +716,9 @@ namespace LegionRuntime {
       std::map<DomainPoint,MinimalPoint*> minimal_points;
       unsigned minimal_points_assigned;
       bool sliced;
+      // Slices hold onto the argument map of their index space
+      // launch so their points can use the arguments in place
+      ArgumentMap argument_map;
     protected:
       ReductionOpID redop;
       const ReductionOp *reduction_op;
@@ -718,6 +773,7 @@ namespace LegionRuntime {
       virtual bool is_stealable(void) const;
       virtual bool has_restrictions(unsigned idx, LogicalRegion handle);
       virtual bool can_early_complete(UserEvent &chain_event);
+      virtual SpeculativeOp* get_speculation_owner(void);
       virtual VersionInfo& get_version_info(unsigned idx);
       virtual RegionTreePath& get_privilege_path(unsigned idx);
       virtual void recapture_version_info(unsigned idx);
@@ -733,6 +789,8 @@ namespace LegionRuntime {
     public:
       virtual void trigger_task_complete(void);
       virtual void trigger_task_commit(void);
+      virtual void complete_mispredicted(void);
+      bool set_mispredicted_result(void);
     public:
       virtual void handle_future(const void *res, 
                                  size_t res_size, bool owned);
@@ -817,6 +875,7 @@ namespace LegionRuntime {
       virtual bool is_stealable(void) const;
       virtual bool has_restrictions(unsigned idx, LogicalRegion handle);
       virtual bool can_early_complete(UserEvent &chain_event);
+      virtual SpeculativeOp* get_speculation_owner(void);
       virtual VersionInfo& get_version_info(unsigned idx);
       virtual void recapture_version_info(unsigned idx);
     public:
@@ -849,6 +908,9 @@ namespace LegionRuntime {
       friend class SliceTask;
       SliceTask                   *slice_owner;
       UserEvent                   point_termination;
+      // Whether local_args is ours to free or just borrowed
+      // from the argument map of the index space launch
+      bool                        owns_local_args;
     protected:
       bool has_remote_subtasks;
       std::map<AddressSpaceID,RemoteTask*> remote_instances;
@@ -883,6 +945,7 @@ namespace LegionRuntime {
       virtual bool is_stealable(void) const;
       virtual bool has_restrictions(unsigned idx, LogicalRegion handle);
       virtual bool can_early_complete(UserEvent &chain_event);
+      virtual SpeculativeOp* get_speculation_owner(void);
       virtual RemoteTask* find_outermost_context(void) = 0;
     public:
       virtual bool has_remote_state(void) const = 0;
@@ -1095,6 +1158,9 @@ namespace LegionRuntime {
     protected:
       virtual void trigger_task_complete(void);
       virtual void trigger_task_commit(void);
+      bool set_mispredicted_result(void);
+    public:
+      virtual void complete_mispredicted(void);
     public:
       virtual bool pack_task(Serializer &rez, Processor target);
       virtual bool unpack_task(Deserializer &derez, Processor current);
@@ -1127,7 +1193,6 @@ namespace LegionRuntime {
       static void process_slice_commit(Deserializer &derez);
     protected:
       friend class SliceTask;
-      ArgumentMap argument_map;
       FutureMap future_map;
       Future reduction_future;
       // The fraction used to keep track of what part of
@@ -1199,8 +1264,11 @@ namespace LegionRuntime {
       virtual void register_must_epoch(void);
       PointTask* clone_as_point_task(const DomainPoint &p,
                                      MinimalPoint *mp);
-      void enumerate_points(void);
+      // Materializes up to max_points more point tasks
+      void enumerate_points(size_t max_points = UINT_MAX);
+      void begin_enumeration(void);
       void premap_slice(void);
+      SpeculativeOp* get_speculation_owner(void) const;
     protected:
       virtual void trigger_task_complete(void);
       virtual void trigger_task_commit(void);
@@ -1224,6 +1292,9 @@ namespace LegionRuntime {
       friend class IndexTask;
       bool reclaim; // used for reclaiming intermediate slices
       std::deque<PointTask*> points;
+      // How many points map_and_launch turns into point tasks at a
+      // time, so big slices don't allocate all their points up front
+      static const size_t POINT_EXPANSION_CHUNK = 64;
     protected:
       unsigned mapping_index;
       unsigned num_unmapped_points;
@@ -1259,6 +1330,7 @@ namespace LegionRuntime {
         HLRTaskID hlr_id;
         DeferredSlicer *slicer;
         SliceTask *slice;
+        unsigned index;
       };
     public:
       DeferredSlicer(MultiTask *owner);
@@ -1268,13 +1340,14 @@ namespace LegionRuntime {
       DeferredSlicer& operator=(const DeferredSlicer &rhs);
     public:
       bool trigger_slices(std::list<SliceTask*> &slices);
-      void perform_slice(SliceTask *slice);
+      void perform_slice(SliceTask *slice, unsigned index);
     public:
       static void handle_slice(const void *args);
     private:
-      Reservation slice_lock;
       MultiTask *const owner;
-      std::set<SliceTask*> failed_slices;
+      // One entry per slice, each written only by the thread that
+      // triggers that slice, so slices never contend on a lock
+      std::vector<char> failed;
     };
 
     /**
@@ -1293,13 +1366,16 @@ namespace LegionRuntime {
       void add_projection_region(unsigned index, LogicalRegion handle);
       void add_argument(const TaskArgument &arg, bool own);
     public:
-      void assign_argument(void *&local_arg, size_t &local_arglen);
+      // Returns true if ownership of the argument was handed over
+      bool assign_argument(void *&local_arg, size_t &local_arglen);
       LogicalRegion find_logical_region(unsigned index);
     public:
       void pack(Serializer &rez);
       void unpack(Deserializer &derez);
     protected:
-      std::map<unsigned,LogicalRegion> projections;
+      // Sorted by region requirement index, which is the order in
+      // which they are added, so a point only needs one allocation
+      std::vector<std::pair<unsigned,LogicalRegion> > projections;
       void *arg;
       size_t arglen;
       bool own_arg;
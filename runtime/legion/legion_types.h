@@ -118,11 +118,13 @@ namespace LegionRuntime {
       HLR_TRIGGER_DEPENDENCE_ID,
       HLR_TRIGGER_OP_ID,
       HLR_TRIGGER_TASK_ID,
+      HLR_TRIGGER_TASK_BATCH_ID,
       HLR_DEFERRED_RECYCLE_ID,
       HLR_DEFERRED_SLICE_ID,
       HLR_MUST_INDIV_ID,
       HLR_MUST_INDEX_ID,
       HLR_MUST_MAP_ID,
+      HLR_MUST_CHECK_ID,
       HLR_MUST_DIST_ID,
       HLR_MUST_LAUNCH_ID,
       HLR_DEFERRED_FUTURE_SET_ID,
@@ -130,11 +132,16 @@ namespace LegionRuntime {
       HLR_RESOLVE_FUTURE_PRED_ID,
       HLR_MPI_RANK_ID,
       HLR_CONTRIBUTE_COLLECTIVE_ID,
+      HLR_REDUCE_FUTURE_MAP_ID,
       HLR_STATE_ANALYSIS_ID,
       HLR_MAPPER_TASK_ID,
       HLR_DISJOINTNESS_TASK_ID,
       HLR_PART_INDEPENDENCE_TASK_ID,
       HLR_SPACE_INDEPENDENCE_TASK_ID,
+      HLR_DISJOINTNESS_SWEEP_TASK_ID,
+      HLR_DISJOINTNESS_FINALIZE_TASK_ID,
+      HLR_PARTITION_COUNT_TASK_ID,
+      HLR_PARTITION_FILL_TASK_ID,
       HLR_PENDING_CHILD_TASK_ID,
       HLR_DECREMENT_PENDING_TASK_ID,
       HLR_SEND_VERSION_STATE_TASK_ID,
@@ -170,11 +177,13 @@ namespace LegionRuntime {
         "Logical Dependence Analysis",                            \
         "Operation Physical Dependence Analysis",                 \
         "Task Physical Dependence Analysis",                      \
+        "Batched Task Physical Dependence Analysis",              \
         "Deferred Recycle",                                       \
         "Deferred Slice",                                         \
         "Must Individual Task Dependence Analysis",               \
         "Must Index Task Dependence Analysis",                    \
         "Must Task Physical Dependence Analysis",                 \
+        "Must Task Constraint Check",                             \
         "Must Task Distribution",                                 \
         "Must Task Launch",                                       \
         "Deferred Future Set",                                    \
@@ -182,11 +191,16 @@ namespace LegionRuntime {
         "Resolve Future Predicate",                               \
         "Update MPI Rank Info",                                   \
         "Contribute Collective",                                  \
+        "Reduce Future Map",                                      \
         "State Analaysis",                                        \
         "Mapper Task",                                            \
         "Disjointness Test",                                      \
         "Partition Independence Test",                            \
         "Index Space Independence Test",                          \
+        "Disjointness Sweep",                                     \
+        "Disjointness Finalize",                                  \
+        "Partition Count",                                        \
+        "Partition Fill",                                         \
         "Remove Pending Child",                                   \
         "Decrement Pending Task",                                 \
         "Send Version State",                                     \
@@ -330,6 +344,7 @@ namespace LegionRuntime {
     class Mapper; 
     template<typename T> struct ColoredPoints; 
     struct InputArgs;
+    struct SpeculationStatistics;
     class ProjectionFunctor;
     class HighLevelRuntime;
 
@@ -405,6 +420,8 @@ namespace LegionRuntime {
     class RegionTreeForest;
     class IndexTreeNode;
     class IndexSpaceNode;
+    class DisjointnessSweep;
+    class PartitionBuilder;
     class IndexPartNode;
     class FieldSpaceNode;
     class RegionTreeNode;
@@ -442,6 +459,7 @@ namespace LegionRuntime {
     class MappingRef;
     class InstanceRef;
     class CompositeRef;
+    class ShadowInstance;
     class InnerTaskView;
     class ReductionManager;
     class ListReductionManager;
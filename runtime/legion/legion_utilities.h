@@ -351,7 +351,7 @@ namespace LegionRuntime {
     /////////////////////////////////////////////////////////////
     class Serializer {
     public:
-      Serializer(size_t base_bytes = 4096)
+      Serializer(size_t base_bytes = DEFAULT_SERIALIZER_SIZE)
         : total_bytes(base_bytes), buffer((char*)malloc(base_bytes)), 
           index(0) 
 #ifdef DEBUG_HIGH_LEVEL
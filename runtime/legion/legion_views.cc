@@ -4734,13 +4734,18 @@ namespace LegionRuntime {
       }
 
       // Now traverse any open children that intersect with the destination
+      std::set<IndexSpaceNode*> intersecting;
+      const bool indexed = find_intersecting_children(dst->logical_node,
+                                                      intersecting);
       for (std::map<CompositeNode*,ChildInfo>::const_iterator it = 
             open_children.begin(); it != open_children.end(); it++)
       {
         FieldMask overlap = copy_mask & it->second.open_fields;
         // If we have no fields in common or we don't intersect with
         // the child then we can skip traversing this child
-        if (!overlap || !it->first->intersects_with(dst->logical_node))
+        if (!overlap || 
+            !it->first->intersects_with(dst->logical_node, 
+                                        indexed ? &intersecting : NULL))
           continue;
         // If we make it here then we need to traverse the child
         it->first->issue_update_copies(info, dst, traversal_mask, 
@@ -4850,11 +4855,15 @@ namespace LegionRuntime {
         }
       }
       // Now traverse any open children that intersect with the destination
+      std::set<IndexSpaceNode*> intersecting;
+      const bool indexed = find_intersecting_children(dst->logical_node,
+                                                      intersecting);
       for (std::map<CompositeNode*,ChildInfo>::const_iterator it = 
             open_children.begin(); it != open_children.end(); it++)
       {
         if ((it->second.open_fields.is_set(src_index)) && 
-            it->first->intersects_with(dst->logical_node))
+            it->first->intersects_with(dst->logical_node,
+                                       indexed ? &intersecting : NULL))
         {
           it->first->issue_across_copies(info, dst, src_index,
                                          src_field, dst_field, need_field,
@@ -4864,12 +4873,37 @@ namespace LegionRuntime {
     }
 
     //--------------------------------------------------------------------------
-    bool CompositeNode::intersects_with(RegionTreeNode *dst)
+    bool CompositeNode::intersects_with(RegionTreeNode *dst,
+                         const std::set<IndexSpaceNode*> *intersecting/*=NULL*/)
     //--------------------------------------------------------------------------
     {
+      if (intersecting != NULL)
+      {
+#ifdef DEBUG_HIGH_LEVEL
+        assert(logical_node->is_region());
+#endif
+        return (intersecting->find(logical_node->as_region_node()->row_source)
+                != intersecting->end());
+      }
       return logical_node->intersects_with(dst);
     }
 
+    //--------------------------------------------------------------------------
+    bool CompositeNode::find_intersecting_children(RegionTreeNode *dst,
+                                        std::set<IndexSpaceNode*> &children)
+    //--------------------------------------------------------------------------
+    {
+      // Testing a few open children directly is cheaper than asking
+      // the partition, but large partitions can find the children
+      // that overlap the destination through their spatial index
+      if (logical_node->is_region() || !dst->is_region() ||
+          (open_children.size() < Runtime::subspace_index_threshold))
+        return false;
+      logical_node->as_partition_node()->row_source->
+        find_intersecting_children(dst->as_region_node()->row_source, children);
+      return true;
+    }
+
     //--------------------------------------------------------------------------
     const std::set<Domain>& CompositeNode::find_intersection_domains(
                                                             RegionTreeNode *dst)
@@ -892,7 +892,12 @@ namespace LegionRuntime {
                                std::set<Event> &preconditions,
                                std::set<Event> &postconditions);
     public:
-      bool intersects_with(RegionTreeNode *dst);
+      // Children of a partition can be tested against the set of
+      // intersecting children computed by find_intersecting_children
+      bool intersects_with(RegionTreeNode *dst,
+                    const std::set<IndexSpaceNode*> *intersecting = NULL);
+      bool find_intersecting_children(RegionTreeNode *dst,
+                                      std::set<IndexSpaceNode*> &children);
       const std::set<Domain>& find_intersection_domains(RegionTreeNode *dst);
     public:
       void find_bounding_roots(CompositeView *target, const FieldMask &mask);
@@ -1286,6 +1286,25 @@ namespace LegionRuntime {
       return result;
     }
 
+    //--------------------------------------------------------------------------
+    void RegionTreeForest::get_logical_subregions_by_color(
+                                  LogicalPartition parent,
+                                  const std::vector<DomainPoint> &colors,
+                                  std::vector<LogicalRegion> &results)
+    //--------------------------------------------------------------------------
+    {
+      // Only look up the partition once for all the colors
+      PartitionNode *parent_node = get_node(parent);
+      results.resize(colors.size());
+      for (unsigned idx = 0; idx < colors.size(); idx++)
+      {
+        IndexSpaceNode *index_node = 
+          parent_node->row_source->get_child(ColorPoint(colors[idx]));
+        results[idx] = LogicalRegion(parent.tree_id, index_node->handle,
+                                     parent.field_space);
+      }
+    }
+
     //--------------------------------------------------------------------------
     bool RegionTreeForest::has_logical_subregion_by_color(
                                LogicalPartition parent, const ColorPoint &color)
@@ -5955,6 +5974,19 @@ namespace LegionRuntime {
     bool IndexSpaceNode::intersects_with(IndexPartNode *other, bool compute)
     //--------------------------------------------------------------------------
     {
+      // Large partitions can answer boolean queries from their index
+      // quickly enough that it isn't worth caching the result
+      SubspaceIndex *index = compute ? NULL : other->get_subspace_index();
+      if (index != NULL)
+      {
+        if (component_domains.empty())
+        {
+          std::set<Domain> local_domains;
+          local_domains.insert(get_domain_blocking());
+          return index->has_intersection(local_domains);
+        }
+        return index->has_intersection(component_domains);
+      }
       {
         AutoLock n_lock(node_lock,1,false/*exclusive*/);
         std::map<IndexTreeNode*,IntersectInfo>::const_iterator finder = 
@@ -5965,20 +5997,18 @@ namespace LegionRuntime {
             (!compute || finder->second.intersections_valid))
           return finder->second.has_intersects;
       }
-      // Build up the set of domains for the partition
-      std::set<Domain> other_domains, intersect;
-      other->get_subspace_domains(other_domains);
+      std::set<Domain> intersect;
       bool result;
       if (component_domains.empty())
       {
-        result = compute_intersections(other_domains, get_domain_blocking(), 
-                                       intersect, compute);
+        std::set<Domain> local_domains;
+        local_domains.insert(get_domain_blocking());
+        result = other->compute_subspace_intersections(local_domains,
+                                                       intersect, compute);
       }
       else
-      {
-        result = compute_intersections(component_domains, other_domains,
-                                       intersect, compute);
-      }
+        result = other->compute_subspace_intersections(component_domains,
+                                                       intersect, compute);
       AutoLock n_lock(node_lock);
       if (result)
       {
@@ -6069,20 +6099,18 @@ namespace LegionRuntime {
             finder->second.intersections_valid)
           return finder->second.intersections;
       }
-      // Build up the set of domains for the partition
-      std::set<Domain> other_domains, intersect;
-      other->get_subspace_domains(other_domains);
+      std::set<Domain> intersect;
       bool result;
       if (component_domains.empty())
       {
-        result = compute_intersections(other_domains, get_domain_blocking(), 
-                                       intersect, true/*compute*/);
+        std::set<Domain> local_domains;
+        local_domains.insert(get_domain_blocking());
+        result = other->compute_subspace_intersections(local_domains,
+                                                  intersect, true/*compute*/);
       }
       else
-      {
-        result = compute_intersections(component_domains, other_domains,
-                                       intersect, true/*compute*/);
-      }
+        result = other->compute_subspace_intersections(component_domains,
+                                                  intersect, true/*compute*/);
       AutoLock n_lock(node_lock);
       if (result)
       {
@@ -6508,6 +6536,672 @@ namespace LegionRuntime {
       return allocator;
     }
 
+    /////////////////////////////////////////////////////////////
+    // Disjointness Sweep 
+    /////////////////////////////////////////////////////////////
+
+    //--------------------------------------------------------------------------
+    DisjointnessSweep::DisjointnessSweep(
+                const std::vector<IndexSpaceNode*> &kids, unsigned chunk)
+      : children(kids), dim(1), sweep_dim(0), 
+        chunk_size((chunk > 0) ? chunk : 1), exact_test(false)
+    //--------------------------------------------------------------------------
+    {
+      for (unsigned idx = 0; idx < children.size(); idx++)
+      {
+        IndexSpaceNode *child = children[idx];
+        if (child->has_component_domains())
+        {
+          const std::set<Domain> &domains = 
+            child->get_component_domains_blocking();
+          for (std::set<Domain>::const_iterator it = domains.begin();
+                it != domains.end(); it++)
+            add_box(idx, *it);
+        }
+        else
+          add_box(idx, child->get_domain_blocking());
+      }
+      if (boxes.empty())
+        return;
+      // Sweep along the dimension with the most distinct starting 
+      // points so that the fewest boxes overlap along the sweep
+      if (dim > 1)
+      {
+        size_t most_distinct = 0;
+        std::vector<int> starts(boxes.size());
+        for (unsigned d = 0; d < dim; d++)
+        {
+          for (unsigned idx = 0; idx < boxes.size(); idx++)
+            starts[idx] = boxes[idx].lo[d];
+          std::sort(starts.begin(), starts.end());
+          size_t distinct = 
+            std::unique(starts.begin(), starts.end()) - starts.begin();
+          if (distinct > most_distinct)
+          {
+            most_distinct = distinct;
+            sweep_dim = d;
+          }
+        }
+      }
+      std::sort(boxes.begin(), boxes.end(), BoxSorter(sweep_dim));
+      chunk_pairs.resize((boxes.size() + chunk_size - 1) / chunk_size);
+    }
+
+    //--------------------------------------------------------------------------
+    DisjointnessSweep::DisjointnessSweep(const DisjointnessSweep &rhs)
+      : children(rhs.children)
+    //--------------------------------------------------------------------------
+    {
+      // should never be called
+      assert(false);
+    }
+
+    //--------------------------------------------------------------------------
+    DisjointnessSweep::~DisjointnessSweep(void)
+    //--------------------------------------------------------------------------
+    {
+    }
+
+    //--------------------------------------------------------------------------
+    DisjointnessSweep& DisjointnessSweep::operator=(
+                                                  const DisjointnessSweep &rhs)
+    //--------------------------------------------------------------------------
+    {
+      // should never be called
+      assert(false);
+      return *this;
+    }
+
+    //--------------------------------------------------------------------------
+    void DisjointnessSweep::add_box(unsigned child, const Domain &domain)
+    //--------------------------------------------------------------------------
+    {
+      Box box;
+      box.child = child;
+      // Empty domains can't alias with anything
+      if (!SubspaceIndex::compute_bounds(domain, box.lo, box.hi))
+        return;
+      // The bounds of an element mask are only
+      // conservative so candidates need an exact test
+      if (domain.get_dim() == 0)
+        exact_test = true;
+      else if (domain.get_dim() > 1)
+        dim = domain.get_dim();
+      boxes.push_back(box);
+    }
+
+    //--------------------------------------------------------------------------
+    void DisjointnessSweep::sweep_chunk(unsigned chunk)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_HIGH_LEVEL
+      assert(chunk < chunk_pairs.size());
+#endif
+      std::vector<std::pair<unsigned,unsigned> > &pairs = chunk_pairs[chunk];
+      const size_t start = size_t(chunk) * chunk_size;
+      const size_t stop = std::min(start + chunk_size, boxes.size());
+      for (size_t idx = start; idx < stop; idx++)
+      {
+        const Box &box = boxes[idx];
+        // Boxes are sorted by their lower bound along the sweep
+        // dimension so only those that start before we end can overlap
+        for (size_t other_idx = idx+1; (other_idx < boxes.size()) &&
+              (boxes[other_idx].lo[sweep_dim] <= box.hi[sweep_dim]); 
+              other_idx++)
+        {
+          const Box &other = boxes[other_idx];
+          if (other.child == box.child)
+            continue;
+          bool overlap = true;
+          for (unsigned d = 0; overlap && (d < dim); d++)
+          {
+            if ((other.hi[d] < box.lo[d]) || (box.hi[d] < other.lo[d]))
+              overlap = false;
+          }
+          if (!overlap)
+            continue;
+          if (box.child < other.child)
+            pairs.push_back(std::pair<unsigned,unsigned>(box.child, 
+                                                         other.child));
+          else
+            pairs.push_back(std::pair<unsigned,unsigned>(other.child,
+                                                         box.child));
+        }
+      }
+      std::sort(pairs.begin(), pairs.end());
+      pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+      if (exact_test)
+      {
+        std::vector<std::pair<unsigned,unsigned> > confirmed;
+        for (std::vector<std::pair<unsigned,unsigned> >::const_iterator it =
+              pairs.begin(); it != pairs.end(); it++)
+        {
+          if (!RegionTreeForest::are_disjoint(children[it->first],
+                                              children[it->second]))
+            confirmed.push_back(*it);
+        }
+        pairs.swap(confirmed);
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    void DisjointnessSweep::get_aliased_pairs(
+                     std::vector<std::pair<unsigned,unsigned> > &pairs) const
+    //--------------------------------------------------------------------------
+    {
+      for (unsigned idx = 0; idx < chunk_pairs.size(); idx++)
+        pairs.insert(pairs.end(), chunk_pairs[idx].begin(), 
+                     chunk_pairs[idx].end());
+      // The same pair can be found by several chunks
+      std::sort(pairs.begin(), pairs.end());
+      pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+    }
+
+    /////////////////////////////////////////////////////////////
+    // Partition Builder
+    /////////////////////////////////////////////////////////////
+
+    //--------------------------------------------------------------------------
+    PartitionBuilder::PartitionBuilder(LowLevel::IndexSpace p, bool alloc,
+                                       unsigned chunk)
+      : parent(p), parent_mask(p.get_valid_mask()), allocable(alloc),
+        chunk_size((chunk > 0) ? chunk : 1), total_count(0)
+    //--------------------------------------------------------------------------
+    {
+      const size_t num_elements = parent_mask.get_num_elmts();
+      chunk_counts.resize((num_elements + chunk_size - 1) / chunk_size, 0);
+    }
+
+    //--------------------------------------------------------------------------
+    PartitionBuilder::PartitionBuilder(const PartitionBuilder &rhs)
+      : parent(rhs.parent), parent_mask(rhs.parent_mask),
+        allocable(rhs.allocable), chunk_size(rhs.chunk_size)
+    //--------------------------------------------------------------------------
+    {
+      // should never be called
+      assert(false);
+    }
+
+    //--------------------------------------------------------------------------
+    PartitionBuilder::~PartitionBuilder(void)
+    //--------------------------------------------------------------------------
+    {
+    }
+
+    //--------------------------------------------------------------------------
+    PartitionBuilder& PartitionBuilder::operator=(const PartitionBuilder &rhs)
+    //--------------------------------------------------------------------------
+    {
+      // should never be called
+      assert(false);
+      return *this;
+    }
+
+    //--------------------------------------------------------------------------
+    void PartitionBuilder::count_chunk(unsigned chunk)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_HIGH_LEVEL
+      assert(chunk < chunk_counts.size());
+#endif
+      const int num_elements = parent_mask.get_num_elmts();
+      const int start = chunk * chunk_size;
+      const int count = ((num_elements - start) < int(chunk_size)) ?
+                          (num_elements - start) : int(chunk_size);
+      chunk_counts[chunk] = parent_mask.pop_count_range(start, count);
+    }
+
+    //--------------------------------------------------------------------------
+    void PartitionBuilder::compute_equal_sizes(size_t num_children,
+                                               size_t granularity)
+    //--------------------------------------------------------------------------
+    {
+      const size_t total = prefix_chunk_counts();
+      // Round up so the last child is the one that comes up short
+      size_t per_child = (num_children > 0) ?
+        ((total + num_children - 1) / num_children) : 0;
+      if (per_child < granularity)
+        per_child = granularity;
+      std::vector<size_t> sizes(num_children, per_child);
+      set_child_sizes(sizes);
+    }
+
+    //--------------------------------------------------------------------------
+    void PartitionBuilder::compute_weighted_sizes(
+                           const std::vector<int> &weights, size_t granularity)
+    //--------------------------------------------------------------------------
+    {
+      const size_t total = prefix_chunk_counts();
+      long long total_weight = 0;
+      for (std::vector<int>::const_iterator it = weights.begin();
+            it != weights.end(); it++)
+      {
+#ifdef DEBUG_HIGH_LEVEL
+        assert((*it) >= 0);
+#endif
+        total_weight += *it;
+      }
+      std::vector<size_t> sizes(weights.size(), 0);
+      if (total_weight == 0)
+      {
+        // Without any weights fall back to an equal partition
+        size_t per_child = weights.empty() ? 0 :
+          ((total + weights.size() - 1) / weights.size());
+        if (per_child < granularity)
+          per_child = granularity;
+        sizes.assign(weights.size(), per_child);
+      }
+      else
+      {
+        // Round the running total of the weights rather than each
+        // weight so that the rounding errors never accumulate
+        long long running_weight = 0;
+        size_t previous_bound = 0;
+        for (unsigned idx = 0; idx < weights.size(); idx++)
+        {
+          running_weight += weights[idx];
+          const size_t bound = size_t(double(total) *
+                  double(running_weight) / double(total_weight) + 0.5);
+          sizes[idx] = bound - previous_bound;
+          previous_bound = bound;
+          if ((weights[idx] > 0) && (sizes[idx] < granularity))
+            sizes[idx] = granularity;
+        }
+      }
+      set_child_sizes(sizes);
+    }
+
+    //--------------------------------------------------------------------------
+    void PartitionBuilder::fill_batch(unsigned batch)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_HIGH_LEVEL
+      assert(batch < get_num_batches());
+#endif
+      const int num_elements = parent_mask.get_num_elmts();
+      const unsigned first_child = batch_starts[batch];
+      const unsigned last_child = batch_starts[batch+1];
+      // Only the first child has to be found, the rest of the
+      // children in the batch start right after the one before
+      int start = find_element(child_starts[first_child]);
+      for (unsigned idx = first_child; idx < last_child; idx++)
+      {
+        const size_t size = child_starts[idx+1] - child_starts[idx];
+        LowLevel::ElementMask child_mask(num_elements);
+        if (size > 0)
+        {
+          const int last = parent_mask.find_nth_enabled(size - 1, start);
+#ifdef DEBUG_HIGH_LEVEL
+          assert(last >= start);
+#endif
+          child_mask.enable_from(parent_mask, start, last - start + 1);
+          start = (child_starts[idx+1] < total_count) ?
+            parent_mask.find_nth_enabled(0, last + 1) : num_elements;
+        }
+        subspaces[idx] =
+          LowLevel::IndexSpace::create_index_space(parent, child_mask,
+                                                   allocable);
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    size_t PartitionBuilder::prefix_chunk_counts(void)
+    //--------------------------------------------------------------------------
+    {
+      // Turn the count of each chunk into the count before it
+      total_count = 0;
+      for (unsigned idx = 0; idx < chunk_counts.size(); idx++)
+      {
+        const size_t count = chunk_counts[idx];
+        chunk_counts[idx] = total_count;
+        total_count += count;
+      }
+      return total_count;
+    }
+
+    //--------------------------------------------------------------------------
+    void PartitionBuilder::set_child_sizes(const std::vector<size_t> &sizes)
+    //--------------------------------------------------------------------------
+    {
+      const unsigned num_children = sizes.size();
+      subspaces.resize(num_children);
+      // Children are handed elements in order until they run out
+      child_starts.resize(num_children + 1);
+      size_t next = 0;
+      for (unsigned idx = 0; idx < num_children; idx++)
+      {
+        child_starts[idx] = next;
+        next = ((total_count - next) < sizes[idx]) ?
+                  total_count : (next + sizes[idx]);
+      }
+      child_starts[num_children] = next;
+      // Start a new batch about every chunk's worth of elements
+      batch_starts.clear();
+      for (unsigned idx = 0; idx < num_children; idx++)
+      {
+        if ((idx == 0) || ((child_starts[idx] / chunk_size) !=
+                           (child_starts[idx-1] / chunk_size)))
+          batch_starts.push_back(idx);
+      }
+      batch_starts.push_back(num_children);
+    }
+
+    //--------------------------------------------------------------------------
+    int PartitionBuilder::find_element(size_t rank) const
+    //--------------------------------------------------------------------------
+    {
+      if (rank >= total_count)
+        return parent_mask.get_num_elmts();
+      // Find the last chunk with no more elements before it than the
+      // rank, which skips over any empty chunks in front of it
+      const unsigned chunk = (std::upper_bound(chunk_counts.begin(),
+                      chunk_counts.end(), rank) - chunk_counts.begin()) - 1;
+      return parent_mask.find_nth_enabled(rank - chunk_counts[chunk],
+                                           chunk * chunk_size);
+    }
+
+    /////////////////////////////////////////////////////////////
+    // Subspace Index 
+    /////////////////////////////////////////////////////////////
+
+    //--------------------------------------------------------------------------
+    SubspaceIndex::SubspaceIndex(const std::vector<IndexSpaceNode*> &children)
+      : num_children(children.size())
+    //--------------------------------------------------------------------------
+    {
+      for (std::vector<IndexSpaceNode*>::const_iterator it = 
+            children.begin(); it != children.end(); it++)
+      {
+        Entry entry;
+        entry.child = *it;
+        if ((*it)->has_component_domains())
+        {
+          const std::set<Domain> &domains = 
+            (*it)->get_component_domains_blocking();
+          for (std::set<Domain>::const_iterator dit = domains.begin();
+                dit != domains.end(); dit++)
+          {
+            if (!compute_bounds(*dit, entry.lo, entry.hi))
+              continue;
+            entry.domain = *dit;
+            entries.push_back(entry);
+          }
+        }
+        else
+        {
+          entry.domain = (*it)->get_domain_blocking();
+          if (compute_bounds(entry.domain, entry.lo, entry.hi))
+            entries.push_back(entry);
+        }
+      }
+      if (entries.empty())
+        return;
+      nodes.resize(1);
+      build(0/*root*/, 0, entries.size());
+    }
+
+    //--------------------------------------------------------------------------
+    SubspaceIndex::SubspaceIndex(const SubspaceIndex &rhs)
+      : num_children(0)
+    //--------------------------------------------------------------------------
+    {
+      // should never be called
+      assert(false);
+    }
+
+    //--------------------------------------------------------------------------
+    SubspaceIndex::~SubspaceIndex(void)
+    //--------------------------------------------------------------------------
+    {
+    }
+
+    //--------------------------------------------------------------------------
+    SubspaceIndex& SubspaceIndex::operator=(const SubspaceIndex &rhs)
+    //--------------------------------------------------------------------------
+    {
+      // should never be called
+      assert(false);
+      return *this;
+    }
+
+    //--------------------------------------------------------------------------
+    void SubspaceIndex::build(unsigned node, unsigned first, unsigned count)
+    //--------------------------------------------------------------------------
+    {
+      TreeNode result;
+      for (unsigned d = 0; d < 3; d++)
+      {
+        result.lo[d] = entries[first].lo[d];
+        result.hi[d] = entries[first].hi[d];
+      }
+      for (unsigned idx = first+1; idx < (first+count); idx++)
+      {
+        for (unsigned d = 0; d < 3; d++)
+        {
+          if (entries[idx].lo[d] < result.lo[d])
+            result.lo[d] = entries[idx].lo[d];
+          if (entries[idx].hi[d] > result.hi[d])
+            result.hi[d] = entries[idx].hi[d];
+        }
+      }
+      result.first = first;
+      result.left = 0;
+      if (count <= LEAF_SIZE)
+      {
+        result.count = count;
+        nodes[node] = result;
+        return;
+      }
+      result.count = 0;
+      // Split the entries in half along the widest dimension
+      unsigned split_dim = 0;
+      long long widest = -1;
+      for (unsigned d = 0; d < 3; d++)
+      {
+        long long width = (long long)result.hi[d] - result.lo[d];
+        if (width > widest)
+        {
+          widest = width;
+          split_dim = d;
+        }
+      }
+      const unsigned half = count / 2;
+      std::nth_element(entries.begin() + first, entries.begin() + first + half,
+                       entries.begin() + first + count, EntrySorter(split_dim));
+      // Reserve both children before recursing so they are adjacent,
+      // the vector can be resized so don't hold references across it
+      result.left = nodes.size();
+      nodes[node] = result;
+      nodes.resize(result.left + 2);
+      build(result.left, first, half);
+      build(result.left + 1, first + half, count - half);
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ bool SubspaceIndex::compute_bounds(const Domain &domain,
+                                                  int lo[3], int hi[3])
+    //--------------------------------------------------------------------------
+    {
+      for (unsigned d = 0; d < 3; d++)
+      {
+        lo[d] = 0;
+        hi[d] = 0;
+      }
+      switch (domain.get_dim())
+      {
+        case 0:
+          {
+            const LowLevel::ElementMask &mask = 
+                                  domain.get_index_space().get_valid_mask();
+            int first = mask.first_enabled();
+            if (first < 0)
+              first = mask.find_enabled();
+            if (first < 0)
+              return false;
+            // The last enabled element is only an upper bound
+            int last = mask.last_enabled();
+            lo[0] = first;
+            hi[0] = (last >= first) ? last : INT_MAX;
+            return true;
+          }
+        case 1:
+          {
+            Rect<1> rect = domain.get_rect<1>();
+            lo[0] = rect.lo[0];
+            hi[0] = rect.hi[0];
+            break;
+          }
+        case 2:
+          {
+            Rect<2> rect = domain.get_rect<2>();
+            for (unsigned d = 0; d < 2; d++)
+            {
+              lo[d] = rect.lo[d];
+              hi[d] = rect.hi[d];
+            }
+            break;
+          }
+        case 3:
+          {
+            Rect<3> rect = domain.get_rect<3>();
+            for (unsigned d = 0; d < 3; d++)
+            {
+              lo[d] = rect.lo[d];
+              hi[d] = rect.hi[d];
+            }
+            break;
+          }
+        default:
+          assert(false);
+      }
+      for (unsigned d = 0; d < 3; d++)
+        if (hi[d] < lo[d])
+          return false;
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    void SubspaceIndex::find_candidates(const int lo[3], const int hi[3],
+                                     std::vector<unsigned> &candidates) const
+    //--------------------------------------------------------------------------
+    {
+      if (nodes.empty())
+        return;
+      std::vector<unsigned> to_visit;
+      to_visit.push_back(0/*root*/);
+      while (!to_visit.empty())
+      {
+        const TreeNode &node = nodes[to_visit.back()];
+        to_visit.pop_back();
+        bool overlap = true;
+        for (unsigned d = 0; overlap && (d < 3); d++)
+        {
+          if ((node.hi[d] < lo[d]) || (hi[d] < node.lo[d]))
+            overlap = false;
+        }
+        if (!overlap)
+          continue;
+        if (node.count == 0)
+        {
+          to_visit.push_back(node.left);
+          to_visit.push_back(node.left + 1);
+          continue;
+        }
+        for (unsigned idx = node.first; idx < (node.first+node.count); idx++)
+        {
+          const Entry &entry = entries[idx];
+          bool entry_overlap = true;
+          for (unsigned d = 0; entry_overlap && (d < 3); d++)
+          {
+            if ((entry.hi[d] < lo[d]) || (hi[d] < entry.lo[d]))
+              entry_overlap = false;
+          }
+          if (entry_overlap)
+            candidates.push_back(idx);
+        }
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    bool SubspaceIndex::has_intersection(
+                                      const std::set<Domain> &domains) const
+    //--------------------------------------------------------------------------
+    {
+      std::vector<unsigned> candidates;
+      for (std::set<Domain>::const_iterator it = domains.begin();
+            it != domains.end(); it++)
+      {
+        int lo[3], hi[3];
+        if (!compute_bounds(*it, lo, hi))
+          continue;
+        candidates.clear();
+        find_candidates(lo, hi, candidates);
+        for (std::vector<unsigned>::const_iterator cit = candidates.begin();
+              cit != candidates.end(); cit++)
+        {
+          Domain dummy;
+          if (IndexTreeNode::compute_intersection(entries[*cit].domain, *it,
+                                                  dummy, false/*compute*/))
+            return true;
+        }
+      }
+      return false;
+    }
+
+    //--------------------------------------------------------------------------
+    bool SubspaceIndex::find_intersections(const std::set<Domain> &domains,
+                                      std::set<Domain> &intersections) const
+    //--------------------------------------------------------------------------
+    {
+      std::vector<unsigned> candidates;
+      for (std::set<Domain>::const_iterator it = domains.begin();
+            it != domains.end(); it++)
+      {
+        int lo[3], hi[3];
+        if (!compute_bounds(*it, lo, hi))
+          continue;
+        candidates.clear();
+        find_candidates(lo, hi, candidates);
+        for (std::vector<unsigned>::const_iterator cit = candidates.begin();
+              cit != candidates.end(); cit++)
+        {
+          Domain intersection;
+          if (IndexTreeNode::compute_intersection(entries[*cit].domain, *it,
+                                            intersection, true/*compute*/))
+            intersections.insert(intersection);
+        }
+      }
+      return !intersections.empty();
+    }
+
+    //--------------------------------------------------------------------------
+    void SubspaceIndex::find_children(const std::set<Domain> &domains,
+                                  std::set<IndexSpaceNode*> &children) const
+    //--------------------------------------------------------------------------
+    {
+      std::vector<unsigned> candidates;
+      for (std::set<Domain>::const_iterator it = domains.begin();
+            it != domains.end(); it++)
+      {
+        int lo[3], hi[3];
+        if (!compute_bounds(*it, lo, hi))
+          continue;
+        candidates.clear();
+        find_candidates(lo, hi, candidates);
+        for (std::vector<unsigned>::const_iterator cit = candidates.begin();
+              cit != candidates.end(); cit++)
+        {
+          const Entry &entry = entries[*cit];
+          if (children.find(entry.child) != children.end())
+            continue;
+          Domain dummy;
+          if (IndexTreeNode::compute_intersection(entry.domain, *it,
+                                                  dummy, false/*compute*/))
+            children.insert(entry.child);
+        }
+      }
+    }
+
     /////////////////////////////////////////////////////////////
     // Index Partition Node 
     /////////////////////////////////////////////////////////////
@@ -6519,7 +7213,7 @@ namespace LegionRuntime {
                                  RegionTreeForest *ctx)
       : IndexTreeNode(c, par->depth+1, ctx), handle(p), color_space(cspace),
         mode(m), parent(par), disjoint(dis), disjoint_ready(Event::NO_EVENT), 
-        has_complete(false)
+        has_complete(false), subspace_index(NULL)
     //--------------------------------------------------------------------------
     { 
     }
@@ -6531,7 +7225,7 @@ namespace LegionRuntime {
                                  RegionTreeForest *ctx)
       : IndexTreeNode(c, par->depth+1, ctx), handle(p), color_space(cspace),
         mode(m), parent(par), disjoint(false), disjoint_ready(ready), 
-        has_complete(false)
+        has_complete(false), subspace_index(NULL)
     //--------------------------------------------------------------------------
     {
     }
@@ -6540,7 +7234,8 @@ namespace LegionRuntime {
     IndexPartNode::IndexPartNode(const IndexPartNode &rhs)
       : IndexTreeNode(), handle(IndexPartition::NO_PART), 
         color_space(Domain::NO_DOMAIN), mode(NO_MEMORY), 
-        parent(NULL), disjoint(false), has_complete(false)
+        parent(NULL), disjoint(false), has_complete(false), 
+        subspace_index(NULL)
     //--------------------------------------------------------------------------
     {
       // should never be called
@@ -6551,6 +7246,11 @@ namespace LegionRuntime {
     IndexPartNode::~IndexPartNode(void)
     //--------------------------------------------------------------------------
     {
+      if (subspace_index != NULL)
+        delete subspace_index;
+      for (std::vector<SubspaceIndex*>::const_iterator it = 
+            stale_indexes.begin(); it != stale_indexes.end(); it++)
+        delete (*it);
     }
 
     //--------------------------------------------------------------------------
@@ -6809,6 +7509,12 @@ namespace LegionRuntime {
 #endif
       color_map[child->color] = child;
       valid_map[child->color] = child;
+      // The index no longer covers all of our children
+      if (subspace_index != NULL)
+      {
+        stale_indexes.push_back(subspace_index);
+        subspace_index = NULL;
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -6846,28 +7552,91 @@ namespace LegionRuntime {
       assert(disjoint_ready.exists() && !disjoint_ready.has_triggered());
       assert(ready_event == disjoint_ready);
 #endif
-      // Make a copy of our color map 
-      std::set<ColorPoint> current_colors;
+      // Make a copy of our children
+      std::vector<IndexSpaceNode*> current_children;
       {
         AutoLock n_lock(node_lock,1,false/*exclusive*/);
         for (std::map<ColorPoint,IndexSpaceNode*>::const_iterator it = 
               color_map.begin(); it != color_map.end(); it++)
-          current_colors.insert(it->first);
+          current_children.push_back(it->second);
+      }
+      // Without dynamic tests any two children are assumed to alias
+      if (!Runtime::dynamic_independence_tests)
+      {
+        disjoint = (current_children.size() < 2);
+        ready_event.trigger();
+        return;
+      }
+      // Sort the bounding boxes of the children and then sweep them
+      // in chunks to find all the pairs of children that intersect
+      DisjointnessSweep *sweep = new DisjointnessSweep(current_children,
+                                           Runtime::disjointness_sweep_chunk);
+      const unsigned num_chunks = sweep->get_num_chunks();
+      if (num_chunks < 2)
+      {
+        if (num_chunks == 1)
+          sweep->sweep_chunk(0);
+        finalize_disjointness(sweep, ready_event);
+        return;
+      }
+      std::set<Event> sweep_events;
+      DisjointnessSweepArgs args;
+      args.hlr_id = HLR_DISJOINTNESS_SWEEP_TASK_ID;
+      args.sweep = sweep;
+      for (unsigned idx = 0; idx < num_chunks; idx++)
+      {
+        args.chunk = idx;
+        sweep_events.insert(context->runtime->issue_runtime_meta_task(&args,
+                              sizeof(args), HLR_DISJOINTNESS_SWEEP_TASK_ID));
+      }
+      DisjointnessFinalizeArgs finalize_args;
+      finalize_args.hlr_id = HLR_DISJOINTNESS_FINALIZE_TASK_ID;
+      finalize_args.node = this;
+      finalize_args.sweep = sweep;
+      finalize_args.ready = ready_event;
+      context->runtime->issue_runtime_meta_task(&finalize_args, 
+          sizeof(finalize_args), HLR_DISJOINTNESS_FINALIZE_TASK_ID, NULL,
+          Event::merge_events(sweep_events));
+    }
+
+    //--------------------------------------------------------------------------
+    void IndexPartNode::finalize_disjointness(DisjointnessSweep *sweep,
+                                              UserEvent ready_event)
+    //--------------------------------------------------------------------------
+    {
+      std::vector<std::pair<unsigned,unsigned> > aliased_pairs;
+      sweep->get_aliased_pairs(aliased_pairs);
+      const std::vector<IndexSpaceNode*> &children = sweep->children;
+      {
+        // Every pair of swept children not recorded as aliased is
+        // disjoint so we don't need to enumerate the disjoint pairs
+        AutoLock n_lock(node_lock);
+        for (unsigned idx = 0; idx < children.size(); idx++)
+          swept_subspaces.insert(children[idx]->color);
+        for (std::vector<std::pair<unsigned,unsigned> >::const_iterator it =
+              aliased_pairs.begin(); it != aliased_pairs.end(); it++)
+        {
+          const ColorPoint &c1 = children[it->first]->color;
+          const ColorPoint &c2 = children[it->second]->color;
+          aliased_subspaces.insert(std::pair<ColorPoint,ColorPoint>(c1,c2));
+          aliased_subspaces.insert(std::pair<ColorPoint,ColorPoint>(c2,c1));
+        }
       }
-      // Now do the pairwise disjointness tests
-      disjoint = true;
-      for (std::set<ColorPoint>::const_iterator it1 = current_colors.begin();
-            disjoint && (it1 != current_colors.end()); it1++)
+#ifdef LEGION_SPY
+      for (unsigned idx1 = 0; idx1 < children.size(); idx1++)
       {
-        for (std::set<ColorPoint>::const_iterator it2 = it1;
-              disjoint && (it2 != current_colors.end()); it2++)
+        for (unsigned idx2 = idx1+1; idx2 < children.size(); idx2++)
         {
-          if ((*it1) == (*it2))
+          if (std::binary_search(aliased_pairs.begin(), aliased_pairs.end(),
+                std::pair<unsigned,unsigned>(idx1, idx2)))
             continue;
-          if (!are_disjoint(*it1, *it2, true/*force compute*/))
-            disjoint = false;
+          LegionSpy::log_index_space_independence(handle.get_id(),
+              children[idx1]->handle.get_id(), children[idx2]->handle.get_id());
         }
       }
+#endif
+      disjoint = aliased_pairs.empty();
+      delete sweep;
       // Once we get here, we know the disjointness result so we can
       // trigger the event saying when the disjointness value is ready
       ready_event.trigger();
@@ -6910,6 +7679,9 @@ namespace LegionRuntime {
           return true;
         else if (aliased_subspaces.find(key) != aliased_subspaces.end())
           return false;
+        else if ((swept_subspaces.find(c1) != swept_subspaces.end()) &&
+                 (swept_subspaces.find(c2) != swept_subspaces.end()))
+          return true;
         else
         {
           std::map<std::pair<ColorPoint,ColorPoint>,Event>::const_iterator
@@ -7157,6 +7929,24 @@ namespace LegionRuntime {
       pending_children.erase(child_color);
     }
 
+    //--------------------------------------------------------------------------
+    /*static*/ void IndexPartNode::handle_disjointness_sweep(const void *args)
+    //--------------------------------------------------------------------------
+    {
+      const DisjointnessSweepArgs *sargs = (const DisjointnessSweepArgs*)args;
+      sargs->sweep->sweep_chunk(sargs->chunk);
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ void IndexPartNode::handle_disjointness_finalize(
+                                                              const void *args)
+    //--------------------------------------------------------------------------
+    {
+      const DisjointnessFinalizeArgs *fargs = 
+        (const DisjointnessFinalizeArgs*)args;
+      fargs->node->finalize_disjointness(fargs->sweep, fargs->ready);
+    }
+
     //--------------------------------------------------------------------------
     /*static*/ void IndexPartNode::handle_pending_child_task(const void *args)
     //--------------------------------------------------------------------------
@@ -7165,23 +7955,38 @@ namespace LegionRuntime {
       pargs->parent->remove_pending_child(pargs->pending_child);
     }
 
+    //--------------------------------------------------------------------------
+    /*static*/ void IndexPartNode::handle_partition_count(const void *args)
+    //--------------------------------------------------------------------------
+    {
+      const PartitionBuilderArgs *pargs = (const PartitionBuilderArgs*)args;
+      pargs->builder->count_chunk(pargs->index);
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ void IndexPartNode::handle_partition_fill(const void *args)
+    //--------------------------------------------------------------------------
+    {
+      const PartitionBuilderArgs *pargs = (const PartitionBuilderArgs*)args;
+      pargs->builder->fill_batch(pargs->index);
+    }
+
     //--------------------------------------------------------------------------
     Event IndexPartNode::create_equal_children(size_t granularity)
     //--------------------------------------------------------------------------
     {
       if (parent->kind == UNSTRUCTURED_KIND)
       {
-        size_t num_subspaces = color_space.get_volume();
-        std::vector<LowLevel::IndexSpace> subspaces(num_subspaces);
-        Event precondition;
-        const Domain &parent_dom = parent->get_domain(precondition);
-        // Launch the operation down to the low-level runtime
-        Event ready_event = 
-          parent_dom.get_index_space().create_equal_subspaces(num_subspaces,
-                                                            granularity,
-                                                            subspaces,
-                                                            (mode & ALLOCABLE),
-                                                            precondition);
+        // The handles of the children have to be known before we return
+        // so wait for the parent's elements and build the children now
+        const Domain &parent_dom = parent->get_domain_blocking();
+        PartitionBuilder builder(parent_dom.get_index_space(),
+                                 (mode & ALLOCABLE), Runtime::partition_chunk);
+        run_partition_tasks(&builder, HLR_PARTITION_COUNT_TASK_ID,
+                            builder.get_num_chunks());
+        builder.compute_equal_sizes(color_space.get_volume(), granularity);
+        run_partition_tasks(&builder, HLR_PARTITION_FILL_TASK_ID,
+                            builder.get_num_batches());
         // Fill in all the subspaces
         unsigned idx = 0;
         for (Domain::DomainPointIterator itr(color_space); itr; itr++, idx++)
@@ -7189,11 +7994,11 @@ namespace LegionRuntime {
           ColorPoint is_color(itr.p);
           IndexSpaceNode *child_node = get_child(is_color);
 #ifdef DEBUG_HIGH_LEVEL
-          assert(subspaces[idx].exists());
+          assert(builder.subspaces[idx].exists());
 #endif
-          child_node->set_domain(Domain(subspaces[idx]));
+          child_node->set_domain(Domain(builder.subspaces[idx]));
         }
-        return ready_event;
+        return Event::NO_EVENT;
       }
       else
       {
@@ -7210,26 +8015,24 @@ namespace LegionRuntime {
     {
       if (parent->kind == UNSTRUCTURED_KIND)
       {
-        size_t num_subspaces = weights.size();
-        std::vector<int> local_weights(num_subspaces);
+        std::vector<int> local_weights(weights.size());
         unsigned idx = 0;
         for (std::map<DomainPoint,int>::const_iterator it = weights.begin();
               it != weights.end(); it++, idx++)
         {
           local_weights[idx] = it->second;
         }
-        std::vector<LowLevel::IndexSpace> subspaces(num_subspaces);
-        Event precondition;
-        const Domain &parent_dom = parent->get_domain(precondition);
-        // Launch the operation down to the low-level runtime
-        Event ready_event = 
-          parent_dom.get_index_space().create_weighted_subspaces(num_subspaces,
-                                                             granularity,
-                                                             local_weights,
-                                                             subspaces,
-                                                             (mode & ALLOCABLE),
-                                                             precondition);
-        // Now create each of the sub-spaces
+        // The handles of the children have to be known before we return
+        // so wait for the parent's elements and build the children now
+        const Domain &parent_dom = parent->get_domain_blocking();
+        PartitionBuilder builder(parent_dom.get_index_space(),
+                                 (mode & ALLOCABLE), Runtime::partition_chunk);
+        run_partition_tasks(&builder, HLR_PARTITION_COUNT_TASK_ID,
+                            builder.get_num_chunks());
+        builder.compute_weighted_sizes(local_weights, granularity);
+        run_partition_tasks(&builder, HLR_PARTITION_FILL_TASK_ID,
+                            builder.get_num_batches());
+        // Now set each of the sub-spaces
         idx = 0; 
         for (std::map<DomainPoint,int>::const_iterator it = weights.begin();
               it != weights.end(); it++, idx++)
@@ -7237,11 +8040,11 @@ namespace LegionRuntime {
           ColorPoint is_color(it->first);
           IndexSpaceNode *child_node = get_child(is_color);
 #ifdef DEBUG_HIGH_LEVEL
-          assert(subspaces[idx].exists());
+          assert(builder.subspaces[idx].exists());
 #endif
-          child_node->set_domain(Domain(subspaces[idx]));
+          child_node->set_domain(Domain(builder.subspaces[idx]));
         }
-        return ready_event;
+        return Event::NO_EVENT;
       }
       else
       {
@@ -7251,6 +8054,35 @@ namespace LegionRuntime {
       }
     }
 
+    //--------------------------------------------------------------------------
+    void IndexPartNode::run_partition_tasks(PartitionBuilder *builder,
+                                            HLRTaskID tid, unsigned count)
+    //--------------------------------------------------------------------------
+    {
+      // A single piece of work isn't worth the meta-task
+      if (count == 1)
+      {
+        if (tid == HLR_PARTITION_COUNT_TASK_ID)
+          builder->count_chunk(0);
+        else
+          builder->fill_batch(0);
+        return;
+      }
+      std::set<Event> done_events;
+      PartitionBuilderArgs args;
+      args.hlr_id = tid;
+      args.builder = builder;
+      for (unsigned idx = 0; idx < count; idx++)
+      {
+        args.index = idx;
+        done_events.insert(context->runtime->issue_runtime_meta_task(&args,
+                                                        sizeof(args), tid));
+      }
+      Event done = Event::merge_events(done_events);
+      if (!done.has_triggered())
+        done.wait();
+    }
+
     //--------------------------------------------------------------------------
     Event IndexPartNode::create_by_operation(IndexPartNode *left, 
                                              IndexPartNode *right,
@@ -7409,10 +8241,106 @@ namespace LegionRuntime {
       }
     }
 
+    //--------------------------------------------------------------------------
+    SubspaceIndex* IndexPartNode::get_subspace_index(void)
+    //--------------------------------------------------------------------------
+    {
+      std::vector<IndexSpaceNode*> children;
+      {
+        AutoLock n_lock(node_lock,1,false/*exclusive*/);
+        if (color_map.size() < Runtime::subspace_index_threshold)
+          return NULL;
+        if (subspace_index != NULL)
+          return subspace_index;
+        for (std::map<ColorPoint,IndexSpaceNode*>::const_iterator it = 
+              color_map.begin(); it != color_map.end(); it++)
+          children.push_back(it->second);
+      }
+      // Build the index without holding the lock since we
+      // might have to wait for the domains of our children
+      SubspaceIndex *result = new SubspaceIndex(children);
+      AutoLock n_lock(node_lock);
+      if (subspace_index != NULL)
+      {
+        // Lost the race
+        delete result;
+        return subspace_index;
+      }
+      if (color_map.size() != children.size())
+      {
+        // Children were added while we were building so this
+        // index is already out of date, fall back to a full scan
+        delete result;
+        return NULL;
+      }
+      subspace_index = result;
+      return subspace_index;
+    }
+
+    //--------------------------------------------------------------------------
+    bool IndexPartNode::compute_subspace_intersections(
+                                    const std::set<Domain> &domains,
+                                    std::set<Domain> &intersect, bool compute)
+    //--------------------------------------------------------------------------
+    {
+      SubspaceIndex *index = get_subspace_index();
+      if (index != NULL)
+      {
+        if (compute)
+          return index->find_intersections(domains, intersect);
+        else
+          return index->has_intersection(domains);
+      }
+      std::set<Domain> local_domains;
+      get_subspace_domains(local_domains);
+      return compute_intersections(local_domains, domains, intersect, compute);
+    }
+
+    //--------------------------------------------------------------------------
+    void IndexPartNode::find_intersecting_children(IndexSpaceNode *other,
+                                          std::set<IndexSpaceNode*> &children)
+    //--------------------------------------------------------------------------
+    {
+      SubspaceIndex *index = get_subspace_index();
+      if (index != NULL)
+      {
+        if (other->has_component_domains())
+          index->find_children(other->get_component_domains_blocking(), 
+                               children);
+        else
+        {
+          std::set<Domain> other_domains;
+          other_domains.insert(other->get_domain_blocking());
+          index->find_children(other_domains, children);
+        }
+        return;
+      }
+      std::map<ColorPoint,IndexSpaceNode*> current_children;
+      get_children(current_children);
+      for (std::map<ColorPoint,IndexSpaceNode*>::const_iterator it = 
+            current_children.begin(); it != current_children.end(); it++)
+      {
+        if (it->second->intersects_with(other, false/*compute*/))
+          children.insert(it->second);
+      }
+    }
+
     //--------------------------------------------------------------------------
     bool IndexPartNode::intersects_with(IndexSpaceNode *other, bool compute)
     //--------------------------------------------------------------------------
     {
+      // Large partitions can answer boolean queries from their index
+      // quickly enough that it isn't worth caching the result
+      SubspaceIndex *index = compute ? NULL : get_subspace_index();
+      if (index != NULL)
+      {
+        if (other->has_component_domains())
+          return index->has_intersection(
+                                    other->get_component_domains_blocking());
+        std::set<Domain> other_domains;
+        other_domains.insert(other->get_domain_blocking());
+        return index->has_intersection(other_domains);
+      }
       {
         AutoLock n_lock(node_lock,1,false/*exclusive*/);
         std::map<IndexTreeNode*,IntersectInfo>::const_iterator finder = 
@@ -7421,19 +8349,17 @@ namespace LegionRuntime {
             (!compute || finder->second.intersections_valid))
           return finder->second.has_intersects;
       }
-      std::set<Domain> local_domains, intersect;
+      std::set<Domain> intersect;
       bool result;
-      get_subspace_domains(local_domains);
       if (other->has_component_domains())
-      {
-        result = compute_intersections(local_domains, 
+        result = compute_subspace_intersections(
                    other->get_component_domains_blocking(), intersect, compute);
-      }
       else
       {
-        result = compute_intersections(local_domains, 
-                                       other->get_domain_blocking(), 
-                                       intersect, compute);
+        std::set<Domain> other_domains;
+        other_domains.insert(other->get_domain_blocking());
+        result = compute_subspace_intersections(other_domains, 
+                                                intersect, compute);
       }
       AutoLock n_lock(node_lock);
       if (result)
@@ -7469,11 +8395,10 @@ namespace LegionRuntime {
             (!compute || finder->second.intersections_valid))
           return finder->second.has_intersects;
       }
-      std::set<Domain> local_domains, other_domains, intersect;
-      get_subspace_domains(local_domains);
+      std::set<Domain> other_domains, intersect;
       other->get_subspace_domains(other_domains);
-      bool result = compute_intersections(local_domains, other_domains, 
-                                          intersect, compute);
+      bool result = compute_subspace_intersections(other_domains, 
+                                                   intersect, compute);
       AutoLock n_lock(node_lock);
       if (result)
       {
@@ -7507,19 +8432,17 @@ namespace LegionRuntime {
             finder->second.intersections_valid)
           return finder->second.intersections;
       }
-      std::set<Domain> local_domains, intersect;
+      std::set<Domain> intersect;
       bool result;
-      get_subspace_domains(local_domains);
       if (other->has_component_domains())
-      {
-        result = compute_intersections(local_domains, 
+        result = compute_subspace_intersections(
            other->get_component_domains_blocking(), intersect, true/*compute*/);
-      }
       else
       {
-        result = compute_intersections(local_domains, 
-                                       other->get_domain_blocking(), 
-                                       intersect, true/*compute*/);
+        std::set<Domain> other_domains;
+        other_domains.insert(other->get_domain_blocking());
+        result = compute_subspace_intersections(other_domains, 
+                                                intersect, true/*compute*/);
       }
       AutoLock n_lock(node_lock);
       if (result)
@@ -7548,11 +8471,10 @@ namespace LegionRuntime {
             finder->second.intersections_valid)
           return finder->second.intersections;
       }
-      std::set<Domain> local_domains, other_domains, intersect;
-      get_subspace_domains(local_domains);
+      std::set<Domain> other_domains, intersect;
       other->get_subspace_domains(other_domains);
-      bool result = compute_intersections(local_domains, other_domains, 
-                                          intersect, true/*compute*/);
+      bool result = compute_subspace_intersections(other_domains, 
+                                                   intersect, true/*compute*/);
       AutoLock n_lock(node_lock);
       if (result)
       {
@@ -7578,18 +8500,17 @@ namespace LegionRuntime {
         if (finder != dominators.end())
           return finder->second;
       }
-      std::set<Domain> local;
-      get_subspace_domains(local);
-      bool result;
+      std::set<Domain> local, other_doms;
       if (other->has_component_domains())
-        result = compute_dominates(local, 
-                  other->get_component_domains_blocking()); 
+        other_doms = other->get_component_domains_blocking();
       else
-      {
-        std::set<Domain> other_doms;
         other_doms.insert(other->get_domain_blocking());
-        result = compute_dominates(local, other_doms);
-      }
+      // Only the parts of our children that overlap the other
+      // space can cover it so the index can prune the rest
+      SubspaceIndex *index = get_subspace_index();
+      if ((index == NULL) || !index->find_intersections(other_doms, local))
+        get_subspace_domains(local);
+      bool result = compute_dominates(local, other_doms);
       AutoLock n_lock(node_lock);
       dominators[other] = result;
       return result;
@@ -224,6 +224,9 @@ namespace LegionRuntime {
                                           IndexSpace handle);
       LogicalRegion get_logical_subregion_by_color(
                               LogicalPartition parent, const ColorPoint &color);
+      void get_logical_subregions_by_color(LogicalPartition parent,
+                                  const std::vector<DomainPoint> &colors,
+                                  std::vector<LogicalRegion> &results);
       bool has_logical_subregion_by_color(LogicalPartition parent,
                                           const ColorPoint &color);
       LogicalRegion get_logical_subregion_by_tree(
@@ -1046,6 +1049,176 @@ namespace LegionRuntime {
       IndexSpaceAllocator *allocator;
     };
 
+    /**
+     * \class DisjointnessSweep
+     * A sweep-line engine for finding which children of a partition
+     * intersect.  The bounding box of every component of every child
+     * is sorted along the dimension where the boxes are most spread
+     * out so that each box only needs to be tested against the boxes
+     * that start before it ends along that dimension.  Boxes for
+     * element masks are confirmed with an exact test.  The sorted
+     * boxes are split into chunks that can be swept by separate
+     * meta-tasks, each of which records its own aliased pairs.
+     */
+    class DisjointnessSweep {
+    public:
+      struct Box {
+      public:
+        int lo[3], hi[3];
+        unsigned child;
+      };
+      struct BoxSorter {
+      public:
+        BoxSorter(unsigned d) : dim(d) { }
+        inline bool operator()(const Box &left, const Box &right) const
+          { return (left.lo[dim] < right.lo[dim]); }
+      public:
+        const unsigned dim;
+      };
+    public:
+      DisjointnessSweep(const std::vector<IndexSpaceNode*> &children,
+                        unsigned chunk_size);
+      DisjointnessSweep(const DisjointnessSweep &rhs);
+      ~DisjointnessSweep(void);
+    public:
+      DisjointnessSweep& operator=(const DisjointnessSweep &rhs);
+    public:
+      inline unsigned get_num_chunks(void) const 
+        { return chunk_pairs.size(); }
+      void sweep_chunk(unsigned chunk);
+      // Pairs of indexes into the vector of children passed to the
+      // constructor with the smaller index first, sorted and unique
+      void get_aliased_pairs(
+                    std::vector<std::pair<unsigned,unsigned> > &pairs) const;
+    public:
+      const std::vector<IndexSpaceNode*> children;
+    protected:
+      void add_box(unsigned child, const Domain &domain);
+    protected:
+      std::vector<Box> boxes;
+      unsigned dim, sweep_dim, chunk_size;
+      bool exact_test;
+      std::vector<std::vector<std::pair<unsigned,unsigned> > > chunk_pairs;
+    };
+
+    /**
+     * \class SubspaceIndex
+     * A static bounding volume hierarchy over the domains of the
+     * children of a partition.  It answers which children intersect
+     * a given domain by only visiting the parts of the tree whose
+     * bounding boxes overlap the domain, so queries against large
+     * partitions take logarithmic time instead of visiting every
+     * child.  The index is immutable once built so it can be
+     * queried concurrently without holding any locks.
+     */
+    class SubspaceIndex {
+    public:
+      static const unsigned LEAF_SIZE = 8;
+    public:
+      struct Entry {
+      public:
+        int lo[3], hi[3];
+        IndexSpaceNode *child;
+        Domain domain;
+      };
+      struct TreeNode {
+      public:
+        int lo[3], hi[3];
+        // Leaves cover the entries [first,first+count) while interior
+        // nodes have count == 0 and their children at left and left+1
+        unsigned first, count, left;
+      };
+      struct EntrySorter {
+      public:
+        EntrySorter(unsigned d) : dim(d) { }
+        inline bool operator()(const Entry &left, const Entry &right) const
+          { return ((long long)left.lo[dim] + left.hi[dim]) < 
+                    ((long long)right.lo[dim] + right.hi[dim]); }
+      public:
+        const unsigned dim;
+      };
+    public:
+      SubspaceIndex(const std::vector<IndexSpaceNode*> &children);
+      SubspaceIndex(const SubspaceIndex &rhs);
+      ~SubspaceIndex(void);
+    public:
+      SubspaceIndex& operator=(const SubspaceIndex &rhs);
+    public:
+      inline size_t get_num_children(void) const { return num_children; }
+      // Any child intersecting any of the domains
+      bool has_intersection(const std::set<Domain> &domains) const;
+      // All the non-empty intersections of children with the domains
+      bool find_intersections(const std::set<Domain> &domains,
+                              std::set<Domain> &intersections) const;
+      // Children with a non-empty intersection with the domains
+      void find_children(const std::set<Domain> &domains,
+                         std::set<IndexSpaceNode*> &children) const;
+    public:
+      // Conservative bounding box of a domain, returns false if empty;
+      // also used by DisjointnessSweep for its boxes
+      static bool compute_bounds(const Domain &domain, int lo[3], int hi[3]);
+    protected:
+      void build(unsigned node, unsigned first, unsigned count);
+      void find_candidates(const int lo[3], const int hi[3],
+                           std::vector<unsigned> &candidates) const;
+    protected:
+      const size_t num_children;
+      std::vector<Entry> entries;
+      std::vector<TreeNode> nodes;
+    };
+
+    /**
+     * \class PartitionBuilder
+     * Builds the children of an equal or weighted partition of an
+     * unstructured index space.  The parent's elements are split into
+     * chunks whose enabled elements are counted by separate meta-tasks.
+     * Prefix sums over the chunk counts tell each child which enabled
+     * elements it gets, so the children can then be built in batches
+     * by separate meta-tasks too, each of which finds where its first
+     * child starts without scanning the elements that come before it.
+     */
+    class PartitionBuilder {
+    public:
+      PartitionBuilder(LowLevel::IndexSpace parent, bool allocable,
+                       unsigned chunk_size);
+      PartitionBuilder(const PartitionBuilder &rhs);
+      ~PartitionBuilder(void);
+    public:
+      PartitionBuilder& operator=(const PartitionBuilder &rhs);
+    public:
+      inline unsigned get_num_chunks(void) const
+        { return chunk_counts.size(); }
+      inline unsigned get_num_batches(void) const
+        { return (batch_starts.size() - 1); }
+      void count_chunk(unsigned chunk);
+      // These must be called after all the chunks have been counted
+      void compute_equal_sizes(size_t num_children, size_t granularity);
+      void compute_weighted_sizes(const std::vector<int> &weights,
+                                  size_t granularity);
+      void fill_batch(unsigned batch);
+    public:
+      const LowLevel::IndexSpace parent;
+      const LowLevel::ElementMask &parent_mask;
+      const bool allocable;
+      // One subspace per child, valid after every batch has been filled
+      std::vector<LowLevel::IndexSpace> subspaces;
+    protected:
+      size_t prefix_chunk_counts(void);
+      void set_child_sizes(const std::vector<size_t> &sizes);
+      int find_element(size_t rank) const;
+    protected:
+      const unsigned chunk_size;
+      // Number of enabled elements in each chunk and then the number
+      // in all the chunks before it once the children are sized
+      std::vector<size_t> chunk_counts;
+      size_t total_count;
+      // Rank among the parent's enabled elements of the first element
+      // of each child, plus one more entry for the end of the last one
+      std::vector<size_t> child_starts;
+      // First child of each batch, plus the number of children
+      std::vector<unsigned> batch_starts;
+    };
+
     /**
      * \class IndexPartNode
      * A node for representing a generic index partition.
@@ -1057,6 +1230,22 @@ namespace LegionRuntime {
         IndexPartNode *parent;
         IndexSpaceNode *left, *right;
       };
+      struct DisjointnessSweepArgs {
+        HLRTaskID hlr_id;
+        DisjointnessSweep *sweep;
+        unsigned chunk;
+      };
+      struct DisjointnessFinalizeArgs {
+        HLRTaskID hlr_id;
+        IndexPartNode *node;
+        DisjointnessSweep *sweep;
+        UserEvent ready;
+      };
+      struct PartitionBuilderArgs {
+        HLRTaskID hlr_id;
+        PartitionBuilder *builder;
+        unsigned index;
+      };
       struct PendingChildArgs {
         HLRTaskID hlr_id;
         IndexPartNode *parent;
@@ -1117,6 +1306,8 @@ namespace LegionRuntime {
                         bool force_compute = false);
       void record_disjointness(bool disjoint,
                                const ColorPoint &c1, const ColorPoint &c2);
+      void finalize_disjointness(DisjointnessSweep *sweep, 
+                                 UserEvent ready_event);
       bool is_complete(void);
     public:
       void add_instance(PartitionNode *inst);
@@ -1138,9 +1329,19 @@ namespace LegionRuntime {
                                 LowLevel::IndexSpace::IndexSpaceOperation op);
       Event create_by_operation(IndexSpaceNode *left, IndexPartNode *right,
                                 LowLevel::IndexSpace::IndexSpaceOperation op);
+    protected:
+      void run_partition_tasks(PartitionBuilder *builder, HLRTaskID tid,
+                               unsigned count);
     public:
       void get_subspace_domain_preconditions(std::set<Event> &preconditions);
       void get_subspace_domains(std::set<Domain> &subspaces);
+      // Returns NULL if the partition is too small to need an index
+      SubspaceIndex* get_subspace_index(void);
+      bool compute_subspace_intersections(const std::set<Domain> &domains,
+                                          std::set<Domain> &intersections,
+                                          bool compute);
+      void find_intersecting_children(IndexSpaceNode *other,
+                                      std::set<IndexSpaceNode*> &children);
       bool intersects_with(IndexSpaceNode *other, bool compute = true);
       bool intersects_with(IndexPartNode *other, bool compute = true);
       const std::set<Domain>& get_intersection_domains(IndexSpaceNode *other);
@@ -1151,6 +1352,10 @@ namespace LegionRuntime {
       static void handle_disjointness_test(IndexPartNode *parent,
                                            IndexSpaceNode *left,
                                            IndexSpaceNode *right);
+      static void handle_disjointness_sweep(const void *args);
+      static void handle_disjointness_finalize(const void *args);
+      static void handle_partition_count(const void *args);
+      static void handle_partition_fill(const void *args);
     public:
       virtual void send_node(AddressSpaceID target, bool up, bool down);
       static void handle_node_creation(RegionTreeForest *context,
@@ -1179,6 +1384,14 @@ namespace LegionRuntime {
       std::set<PartitionNode*> logical_nodes;
       std::set<std::pair<ColorPoint,ColorPoint> > disjoint_subspaces;
       std::set<std::pair<ColorPoint,ColorPoint> > aliased_subspaces;
+      // Children covered by a disjointness sweep, any pair of these
+      // that is not in aliased_subspaces is disjoint
+      std::set<ColorPoint> swept_subspaces;
+      // Spatial index over the children for large partitions, indexes
+      // that were invalidated by new children are kept until we are
+      // deleted since other threads may still be querying them
+      SubspaceIndex *subspace_index;
+      std::vector<SubspaceIndex*> stale_indexes;
     protected:
       // Support for pending child spaces that still need to be computed
       std::map<ColorPoint,std::pair<UserEvent,UserEvent> > pending_children;
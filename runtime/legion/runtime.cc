@@ -712,19 +712,47 @@ namespace LegionRuntime {
 #ifdef DEBUG_HIGH_LEVEL
       assert(is_owner());
 #endif
-      Serializer rez;
+      std::vector<AddressSpaceID> targets;
+      // Need to hold the lock when reading the set of remote spaces
       {
-        rez.serialize(did);
-        RezCheck z(rez);
-        rez.serialize(result_size);
-        rez.serialize(result,result_size);
+        AutoLock gc(gc_lock,1,false/*exclusive*/);
+        if (registered_waiters.empty())
+          return;
+        targets.insert(targets.end(), registered_waiters.begin(),
+                       registered_waiters.end());
       }
-      // Need to hold the lock when reading the set of remote spaces
-      AutoLock gc(gc_lock,1,false/*exclusive*/);
-      for (std::set<AddressSpaceID>::const_iterator it = 
-            registered_waiters.begin(); it != registered_waiters.end(); it++)
+      forward_result(targets, 0, targets.size());
+    }
+
+    //--------------------------------------------------------------------------
+    void Future::Impl::forward_result(
+                            const std::vector<AddressSpaceID> &targets,
+                            unsigned start, unsigned stop)
+    //--------------------------------------------------------------------------
+    {
+      // Split the targets into at most radix contiguous chunks.  The
+      // first node in each chunk gets the value directly and is then
+      // responsible for forwarding it to the rest of its chunk.
+      if (start >= stop)
+        return;
+      const unsigned total = stop - start;
+      const unsigned radix = Runtime::future_broadcast_radix;
+      const unsigned chunk = (radix == 0) ? 1 : (total + radix - 1) / radix;
+      for (unsigned idx = start; idx < stop; idx += chunk)
       {
-        runtime->send_future_result(*it, rez); 
+        const unsigned last = ((idx + chunk) < stop) ? (idx + chunk) : stop;
+        Serializer rez;
+        rez.serialize(did);
+        {
+          RezCheck z(rez);
+          rez.serialize(result_size);
+          rez.serialize(result,result_size);
+        }
+        size_t num_children = last - idx - 1;
+        rez.serialize(num_children);
+        for (unsigned child = idx+1; child < last; child++)
+          rez.serialize(targets[child]);
+        runtime->send_future_result(targets[idx], rez);
       }
     }
 
@@ -800,14 +828,8 @@ namespace LegionRuntime {
         }
         if (send_result)
         {
-          Serializer rez;
-          {
-            rez.serialize(did);
-            RezCheck z(rez);
-            rez.serialize(result_size);
-            rez.serialize(result,result_size);
-          }
-          runtime->send_future_result(sid, rez);
+          std::vector<AddressSpaceID> targets(1, sid);
+          forward_result(targets, 0, 1);
         }
       }
       else
@@ -851,6 +873,14 @@ namespace LegionRuntime {
       derez.deserialize(did);
       Future::Impl *future = runtime->find_future(did);
       future->unpack_future(derez);
+      size_t num_targets;
+      derez.deserialize(num_targets);
+      std::vector<AddressSpaceID> targets(num_targets);
+      for (unsigned idx = 0; idx < num_targets; idx++)
+        derez.deserialize(targets[idx]);
+      // Pass the value down the broadcast tree before completing
+      // the future locally to keep it off the critical path
+      future->forward_result(targets, 0, targets.size());
       future->complete_future();
     }
 
@@ -1081,6 +1111,58 @@ namespace LegionRuntime {
       return result;
     }
 
+    //--------------------------------------------------------------------------
+    Future FutureMap::Impl::reduce_futures(ReductionOpID redop)
+    //--------------------------------------------------------------------------
+    {
+      // The reduced value is produced by the same launch as the
+      // futures it folds, so it names that launch just like them
+      Future result = runtime->help_create_future(valid ? task : NULL);
+      if (!valid || ready_event.has_triggered())
+      {
+        fold_futures(redop, result);
+        return result;
+      }
+      // Add a reference so the map won't be prematurely collected,
+      // the copy of the future handle keeps the result alive
+      add_reference();
+      ReduceFuturesArgs args;
+      args.hlr_id = HLR_REDUCE_FUTURE_MAP_ID;
+      args.impl = this;
+      args.target = new Future(result);
+      args.redop = redop;
+      runtime->issue_runtime_meta_task(&args, sizeof(args),
+                                       HLR_REDUCE_FUTURE_MAP_ID,
+                                       NULL, ready_event);
+      return result;
+    }
+
+    //--------------------------------------------------------------------------
+    void FutureMap::Impl::fold_futures(ReductionOpID redop, 
+                                       const Future &target)
+    //--------------------------------------------------------------------------
+    {
+      if (valid)
+      {
+        AutoLock l_lock(lock);
+        runtime->help_fold_futures(futures, redop, target);
+      }
+      else
+        runtime->help_fold_futures(std::map<DomainPoint,Future>(), 
+                                   redop, target);
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ void FutureMap::Impl::handle_reduce_futures(const void *args)
+    //--------------------------------------------------------------------------
+    {
+      const ReduceFuturesArgs *rargs = (const ReduceFuturesArgs*)args;
+      rargs->impl->fold_futures(rargs->redop, *(rargs->target));
+      delete rargs->target;
+      if (rargs->impl->remove_reference())
+        legion_delete(rargs->impl);
+    }
+
 #ifdef DEBUG_HIGH_LEVEL
     //--------------------------------------------------------------------------
     void FutureMap::Impl::add_valid_domain(const Domain &d)
@@ -1660,6 +1742,9 @@ namespace LegionRuntime {
     // Processor Manager 
     /////////////////////////////////////////////////////////////
 
+    /*static*/ TaskOp *const ProcessorManager::SCHEDULER_IDLE = 
+                                                    reinterpret_cast<TaskOp*>(1);
+
     //--------------------------------------------------------------------------
     ProcessorManager::ProcessorManager(Processor proc, Processor::Kind kind,
                                        Runtime *rt, unsigned width, 
@@ -1668,10 +1753,10 @@ namespace LegionRuntime {
       : runtime(rt), local_proc(proc), proc_kind(kind), 
         superscalar_width(width), 
         stealing_disabled(no_steal), max_outstanding_steals(max_steals),
-        next_local_index(0),
-        task_scheduler_enabled(false), pending_shutdown(false),
+        next_local_index(0), pending_shutdown(false),
         total_active_contexts(0),
         ready_queues(std::vector<std::list<TaskOp*> >(def_mappers)),
+        incoming_tasks(SCHEDULER_IDLE), pending_incoming(0),
         mapper_objects(std::vector<Mapper*>(def_mappers,NULL)),
         mapper_locks(
             std::vector<Reservation>(def_mappers,Reservation::NO_RESERVATION)),
@@ -1700,8 +1785,8 @@ namespace LegionRuntime {
         proc_kind(Processor::LOC_PROC),
         superscalar_width(0), stealing_disabled(false), 
         max_outstanding_steals(0), next_local_index(0),
-        task_scheduler_enabled(false), pending_shutdown(false),
-        total_active_contexts(0)
+        pending_shutdown(false), total_active_contexts(0), 
+        incoming_tasks(SCHEDULER_IDLE), pending_incoming(0)
     //--------------------------------------------------------------------------
     {
       // should never be called
@@ -1712,6 +1797,23 @@ namespace LegionRuntime {
     ProcessorManager::~ProcessorManager(void)
     //--------------------------------------------------------------------------
     {
+      if (Runtime::scheduler_statistics)
+      {
+        SchedulerStatistics stats;
+        get_scheduler_statistics(stats);
+        log_run.print("Scheduler statistics for processor " IDFMT ": "
+                      "%llu passes, %llu tasks enqueued, %llu scheduled, "
+                      "%llu trigger meta-tasks (%llu tasks batched), "
+                      "max queue depth %u, average mapping latency %.2f us, "
+                      "max mapping latency %llu us", local_proc.id,
+                      stats.scheduler_passes, stats.tasks_enqueued,
+                      stats.tasks_scheduled, stats.trigger_tasks,
+                      stats.batched_tasks, stats.max_queue_depth,
+                      (stats.mapped_tasks > 0) ? 
+                        double(stats.total_mapping_latency) / 
+                          stats.mapped_tasks : 0.0,
+                      stats.max_mapping_latency);
+      }
       for (unsigned idx = 0; idx < mapper_objects.size(); idx++)
       {
         if (mapper_objects[idx] != NULL)
@@ -2317,19 +2419,40 @@ namespace LegionRuntime {
     void ProcessorManager::perform_scheduling(void)
     //--------------------------------------------------------------------------
     {
+      if (Runtime::scheduler_statistics)
+        __sync_fetch_and_add(&statistics.scheduler_passes, 1);
       perform_mapping_operations(); 
       // Now re-take the lock and re-check the condition to see 
       // if the next scheduling task should be launched
       AutoLock q_lock(queue_lock);
-      if (!pending_shutdown && (total_active_contexts > 0))
+      while (true)
       {
-        task_scheduler_enabled = true;
-        launch_task_scheduler();
+        // Pick up anything pushed during the pass first since its
+        // producers are counting on us to see it
+        drain_incoming_tasks();
+        if (!pending_shutdown && (total_active_contexts > 0))
+        {
+          launch_task_scheduler();
+          break;
+        }
+        // We can only go idle if nothing was pushed since the drain,
+        // once we do the next producer launches a new scheduler
+        if (__sync_bool_compare_and_swap(&incoming_tasks, 
+                                         (TaskOp*)NULL, SCHEDULER_IDLE))
+          break;
       }
-      else
-        task_scheduler_enabled = false; 
     } 
 
+    //--------------------------------------------------------------------------
+    bool ProcessorManager::arm_task_scheduler(void)
+    //--------------------------------------------------------------------------
+    {
+      // Taking the stack out of the idle state makes us the one
+      // responsible for launching the scheduler
+      return __sync_bool_compare_and_swap(&incoming_tasks, SCHEDULER_IDLE,
+                                          (TaskOp*)NULL);
+    }
+
     //--------------------------------------------------------------------------
     void ProcessorManager::launch_task_scheduler(void)
     //--------------------------------------------------------------------------
@@ -2394,11 +2517,8 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       // Better be called while holding the queue lock
-      if ((total_active_contexts == 0) && !task_scheduler_enabled)
-      {
-        task_scheduler_enabled = true;
+      if ((total_active_contexts == 0) && arm_task_scheduler())
         launch_task_scheduler();
-      }
       total_active_contexts++;
     }
 
@@ -2410,9 +2530,8 @@ namespace LegionRuntime {
 #ifdef DEBUG_HIGH_LEVEL
       assert(total_active_contexts > 0);
 #endif
+      // The running scheduler notices this at the end of its pass
       total_active_contexts--;
-      if (total_active_contexts == 0)
-        task_scheduler_enabled = false;
     }
 
     //--------------------------------------------------------------------------
@@ -2422,6 +2541,12 @@ namespace LegionRuntime {
     {
       log_run.spew("handling a steal request on processor " IDFMT " "
                          "from processor " IDFMT "", local_proc.id,thief.id);
+      // Make sure the thief can see tasks that were just pushed
+      if (has_incoming_tasks())
+      {
+        AutoLock q_lock(queue_lock);
+        drain_incoming_tasks();
+      }
       // Iterate over the task descriptions, asking the appropriate mapper
       // whether we can steal the task
       std::set<TaskOp*> stolen;
@@ -2564,12 +2689,8 @@ namespace LegionRuntime {
       }
       // Do a one time enabling of the scheduler so we can try
       // asking any of the mappers if they would like to try stealing again
-      AutoLock q_lock(queue_lock);
-      if (!task_scheduler_enabled)
-      {
-        task_scheduler_enabled = true;
+      if (arm_task_scheduler())
         launch_task_scheduler();
-      }
     }
 
     //--------------------------------------------------------------------------
@@ -2584,18 +2705,91 @@ namespace LegionRuntime {
       task->schedule = false; 
       // have to do this when we are not holding the lock
       task->activate_outstanding_task();
-      // We can do this without holding the lock because the
-      // vector is of a fixed size
-      ContextID ctx_id = task->get_parent()->get_context_id();
-      AutoLock q_lock(queue_lock);
-      ContextState &state = context_states[ctx_id];
+      if (Runtime::scheduler_statistics)
+      {
+        __sync_fetch_and_add(&statistics.tasks_enqueued, 1);
+        if (!prev_failure)
+          task->ready_time = Realm::Clock::current_time_in_microseconds();
+      }
       if (prev_failure)
+      {
+        // Tasks that failed to map go back on the front of the
+        // queue so they have to go through the lock
+        ContextID ctx_id = task->get_parent()->get_context_id();
+        AutoLock q_lock(queue_lock);
+        ContextState &state = context_states[ctx_id];
         ready_queues[task->map_id].push_front(task);
-      else
+        if (state.active && (state.owned_tasks == 0))
+          increment_active_contexts();
+        state.owned_tasks++;
+        return;
+      }
+      // Otherwise push it onto the lock-free stack of incoming tasks
+      // without ever taking the queue lock, the scheduler moves it
+      // over to the ready queues on its next pass
+      TaskOp *head;
+      bool idle;
+      do {
+        head = incoming_tasks;
+        idle = (head == SCHEDULER_IDLE);
+        task->next_ready = idle ? NULL : head;
+      } while (!__sync_bool_compare_and_swap(&incoming_tasks, head, task));
+      if (Runtime::scheduler_statistics)
+        __sync_fetch_and_add(&pending_incoming, 1);
+      // If no scheduler was running then we took the stack out of
+      // the idle state and it is up to us to start one
+      if (idle)
+        launch_task_scheduler();
+    }
+
+    //--------------------------------------------------------------------------
+    void ProcessorManager::drain_incoming_tasks(void)
+    //--------------------------------------------------------------------------
+    {
+      // Better be called while holding the queue lock, take the whole
+      // stack unless it is empty or idle (which only the scheduler
+      // itself is allowed to change)
+      TaskOp *head;
+      do {
+        head = incoming_tasks;
+        if ((head == NULL) || (head == SCHEDULER_IDLE))
+          return;
+      } while (!__sync_bool_compare_and_swap(&incoming_tasks, head, 
+                                             (TaskOp*)NULL));
+      // Reverse the stack so tasks go onto the ready queues
+      // in the order in which they were added
+      TaskOp *ordered = NULL;
+      int count = 0;
+      while (head != NULL)
+      {
+        TaskOp *next = head->next_ready;
+        head->next_ready = ordered;
+        ordered = head;
+        head = next;
+        count++;
+      }
+      while (ordered != NULL)
+      {
+        TaskOp *task = ordered;
+        ordered = task->next_ready;
+        task->next_ready = NULL;
         ready_queues[task->map_id].push_back(task);
-      if (state.active && (state.owned_tasks == 0))
-        increment_active_contexts();
-      state.owned_tasks++;
+        ContextID ctx_id = task->get_parent()->get_context_id();
+        ContextState &state = context_states[ctx_id];
+        if (state.active && (state.owned_tasks == 0))
+          increment_active_contexts();
+        state.owned_tasks++;
+      }
+      if (Runtime::scheduler_statistics)
+      {
+        __sync_fetch_and_sub(&pending_incoming, count);
+        unsigned depth = 0;
+        for (unsigned idx = 0; idx < ready_queues.size(); idx++)
+          depth += ready_queues[idx].size();
+        statistics.queue_depth = depth;
+        if (depth > statistics.max_queue_depth)
+          statistics.max_queue_depth = depth;
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -2637,10 +2831,103 @@ namespace LegionRuntime {
     unsigned ProcessorManager::sample_unmapped_tasks(MapperID map_id)
     //--------------------------------------------------------------------------
     {
+      if (has_incoming_tasks())
+      {
+        AutoLock q_lock(queue_lock);
+        drain_incoming_tasks();
+        return ready_queues[map_id].size();
+      }
       AutoLock q_lock(queue_lock, 1, false/*exclusive*/);
       return ready_queues[map_id].size();
     }
 
+    //--------------------------------------------------------------------------
+    void ProcessorManager::get_scheduler_statistics(SchedulerStatistics &stats)
+    //--------------------------------------------------------------------------
+    {
+      // No queue lock here: the counters are only ever updated with
+      // atomics or by the drain, so a racy snapshot is good enough and
+      // we never wait on the scheduler (or on a reservation at shutdown).
+      // The queue depth is the one seen by the last drain plus any
+      // pushes that have not been drained yet (a push is counted just
+      // after it lands, so this can briefly be behind).
+      stats = statistics;
+      const int pending = pending_incoming;
+      if (pending > 0)
+        stats.queue_depth += pending;
+    }
+
+    //--------------------------------------------------------------------------
+    void ProcessorManager::record_mapping_latency(unsigned long long ready_time)
+    //--------------------------------------------------------------------------
+    {
+      unsigned long long latency = 
+        Realm::Clock::current_time_in_microseconds() - ready_time;
+      __sync_fetch_and_add(&statistics.mapped_tasks, 1);
+      __sync_fetch_and_add(&statistics.total_mapping_latency, latency);
+      unsigned long long current = statistics.max_mapping_latency;
+      while (latency > current)
+      {
+        unsigned long long prev = __sync_val_compare_and_swap(
+                          &statistics.max_mapping_latency, current, latency);
+        if (prev == current)
+          break;
+        current = prev;
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    void ProcessorManager::trigger_ready_tasks(const std::vector<TaskOp*> &ops)
+    //--------------------------------------------------------------------------
+    {
+      for (std::vector<TaskOp*>::const_iterator it = ops.begin();
+            it != ops.end(); it++)
+      {
+        // Read this before mapping as the task can be
+        // recycled as soon as it is done mapping
+        const unsigned long long ready_time = (*it)->ready_time;
+        bool mapped = (*it)->trigger_execution();
+        if (!mapped)
+          add_to_ready_queue(*it, true/*failure*/);
+        else if (Runtime::scheduler_statistics)
+          record_mapping_latency(ready_time);
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    void ProcessorManager::issue_trigger_tasks(std::vector<TaskOp*> &ops)
+    //--------------------------------------------------------------------------
+    {
+      if (ops.empty())
+        return;
+      if (Runtime::scheduler_statistics)
+        __sync_fetch_and_add(&statistics.trigger_tasks, 1);
+      if (ops.size() == 1)
+      {
+        TriggerTaskArgs args;
+        args.hlr_id = HLR_TRIGGER_TASK_ID;
+        args.manager = this;
+        args.op = ops[0];
+        runtime->issue_runtime_meta_task(&args, sizeof(args),
+                                         HLR_TRIGGER_TASK_ID, ops[0],
+                                         Event::NO_EVENT, 1/*priority*/);
+      }
+      else
+      {
+        if (Runtime::scheduler_statistics)
+          __sync_fetch_and_add(&statistics.batched_tasks, ops.size());
+        TriggerTaskBatchArgs args;
+        args.hlr_id = HLR_TRIGGER_TASK_BATCH_ID;
+        args.manager = this;
+        // Deleted by the meta-task
+        args.ops = new std::vector<TaskOp*>(ops);
+        runtime->issue_runtime_meta_task(&args, sizeof(args),
+                                         HLR_TRIGGER_TASK_BATCH_ID, ops[0],
+                                         Event::NO_EVENT, 1/*priority*/);
+      }
+      ops.clear();
+    }
+
 #ifdef HANG_TRACE
     //--------------------------------------------------------------------------
     void ProcessorManager::dump_state(FILE *target)
@@ -2672,6 +2959,12 @@ namespace LegionRuntime {
     {
       std::multimap<Processor,MapperID> stealing_targets;
       std::vector<MapperID> mappers_with_work;
+      // Pick up anything that has been pushed since the last drain
+      if (has_incoming_tasks())
+      {
+        AutoLock q_lock(queue_lock);
+        drain_incoming_tasks();
+      }
       for (unsigned map_id = 0; map_id < ready_queues.size(); map_id++)
       {
         if (mapper_objects[map_id] == NULL)
@@ -2679,11 +2972,17 @@ namespace LegionRuntime {
         std::list<TaskOp*> visible_tasks;
         // We also need to capture the generations here
         std::vector<GenerationID> visible_generations;
-        // Pull out the current tasks for this mapping operation
+        // Pull out the current tasks for this mapping operation,
+        // bounding how many we look at in a single pass
         {
           AutoLock q_lock(queue_lock,1,false/*exclusive*/);
+          std::list<TaskOp*>::iterator last = ready_queues[map_id].begin();
+          for (unsigned idx = 0; (last != ready_queues[map_id].end()) &&
+                ((Runtime::max_schedule_batch == 0) || 
+                 (idx < Runtime::max_schedule_batch)); idx++)
+            last++;
           visible_tasks.insert(visible_tasks.begin(),
-               ready_queues[map_id].begin(), ready_queues[map_id].end());
+               ready_queues[map_id].begin(), last);
           visible_generations.resize(visible_tasks.size());
           unsigned idx = 0;
           for (std::list<TaskOp*>::const_iterator it = visible_tasks.begin();
@@ -2785,7 +3084,13 @@ namespace LegionRuntime {
             mappers_with_work.push_back(map_id);
         }
         // Now that we've removed them from the queue, issue the
-        // mapping analysis calls
+        // mapping analysis calls.  Local tasks of the same kind that
+        // have no precondition are triggered in batches to cut down
+        // on the number of meta-tasks.
+        if (Runtime::scheduler_statistics)
+          __sync_fetch_and_add(&statistics.tasks_scheduled, 
+                               visible_tasks.size());
+        std::map<Processor::TaskFuncID,std::vector<TaskOp*> > batches;
         TriggerTaskArgs args;
         args.hlr_id = HLR_TRIGGER_TASK_ID;
         args.manager = this;
@@ -2798,6 +3103,17 @@ namespace LegionRuntime {
 #endif
           (*vis_it)->deactivate_outstanding_task();
           Event wait_on = (*vis_it)->invoke_state_analysis();
+          if ((Runtime::max_trigger_batch > 1) && wait_on.has_triggered() &&
+              ((*vis_it)->target_proc == local_proc))
+          {
+            std::vector<TaskOp*> &batch = batches[(*vis_it)->task_id];
+            batch.push_back(*vis_it);
+            if (batch.size() == Runtime::max_trigger_batch)
+              issue_trigger_tasks(batch);
+            continue;
+          }
+          if (Runtime::scheduler_statistics)
+            __sync_fetch_and_add(&statistics.trigger_tasks, 1);
           // We give a slight priority to triggering the execution
           // of tasks relative to other runtime operations because
           // they actually have a feedback mechanism controlling
@@ -2810,6 +3126,9 @@ namespace LegionRuntime {
                                            HLR_TRIGGER_TASK_ID, *vis_it,
                                            wait_on, priority);
         }
+        for (std::map<Processor::TaskFuncID,std::vector<TaskOp*> >::iterator
+              it = batches.begin(); it != batches.end(); it++)
+          issue_trigger_tasks(it->second);
       }
 
       // Advertise any work that we have
@@ -3869,9 +4188,101 @@ namespace LegionRuntime {
       // See if we are done
       return (__sync_add_and_fetch(&remaining, -1) == 0);
     }
-    
+
     /////////////////////////////////////////////////////////////
-    // Legion Runtime 
+    // Thread Op Cache
+    /////////////////////////////////////////////////////////////
+
+    /*static*/ __thread ThreadOpCache *ThreadOpCache::local_cache = NULL;
+    /*static*/ __thread ThreadOpCache::Batch *ThreadOpCache::refill_batch = 
+                                                                        NULL;
+
+    // Exiting threads hand their caches back to the owning runtime while
+    // holding this lock, a runtime takes it to disown its caches
+    static pthread_mutex_t thread_cache_owner_lock = PTHREAD_MUTEX_INITIALIZER;
+    static pthread_key_t thread_cache_key;
+    static pthread_once_t thread_cache_key_once = PTHREAD_ONCE_INIT;
+
+    //--------------------------------------------------------------------------
+    ThreadOpCache::ThreadOpCache(Runtime *rt)
+      : owner(rt)
+    //--------------------------------------------------------------------------
+    {
+      for (unsigned idx = 0; idx < NUM_CACHE_KINDS; idx++)
+      {
+        counts[idx] = 0;
+        hits[idx] = 0;
+        refills[idx] = 0;
+        spills[idx] = 0;
+        allocations[idx] = 0;
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ ThreadOpCache* ThreadOpCache::find_local(Runtime *rt)
+    //--------------------------------------------------------------------------
+    {
+      // A runtime that shuts down just disowns its caches and a 
+      // disowned cache can be picked up by the next runtime, caches
+      // are only deleted when their thread exits
+      ThreadOpCache *cache = local_cache;
+      if (cache == NULL)
+      {
+        cache = new ThreadOpCache(rt);
+        local_cache = cache;
+        pthread_once(&thread_cache_key_once, create_local_key);
+        pthread_setspecific(thread_cache_key, cache);
+        rt->register_thread_cache(cache);
+      }
+      else if (cache->owner != rt)
+      {
+        if (cache->owner != NULL)
+          return NULL;
+        cache->owner = rt;
+        rt->register_thread_cache(cache);
+      }
+      return cache;
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ void ThreadOpCache::create_local_key(void)
+    //--------------------------------------------------------------------------
+    {
+      pthread_key_create(&thread_cache_key, release_local);
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ void ThreadOpCache::release_local(void *ptr)
+    //--------------------------------------------------------------------------
+    {
+      ThreadOpCache *cache = static_cast<ThreadOpCache*>(ptr);
+      // Give back anything still in the magazines so it isn't stranded
+      pthread_mutex_lock(&thread_cache_owner_lock);
+      if (cache->owner != NULL)
+        cache->owner->release_thread_cache(cache);
+      pthread_mutex_unlock(&thread_cache_owner_lock);
+      local_cache = NULL;
+      delete cache;
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ const char* ThreadOpCache::get_kind_name(Kind kind)
+    //--------------------------------------------------------------------------
+    {
+      static const char *const names[NUM_CACHE_KINDS] = {
+        "Individual Task", "Point Task", "Index Task", "Slice Task",
+        "Remote Task", "Inline Task", "Map Op", "Copy Op", "Fence Op",
+        "Deletion Op", "Inter Close Op", "Post Close Op", "Virtual Close Op",
+        "Dynamic Collective Op", "Future Predicate Op", "Not Predicate Op",
+        "And Predicate Op", "Or Predicate Op", "Acquire Op", "Release Op",
+        "Capture Op", "Trace Op", "Must Epoch Op", "Pending Partition Op",
+        "Dependent Partition Op", "Fill Op", "Attach Op", "Detach Op"
+      };
+      return names[kind];
+    }
+
+    /////////////////////////////////////////////////////////////
+    // Legion Runtime
     /////////////////////////////////////////////////////////////
 
     //--------------------------------------------------------------------------
@@ -3901,6 +4312,9 @@ namespace LegionRuntime {
         unique_region_tree_id((unique == 0) ? runtime_stride : unique),
         unique_operation_id((unique == 0) ? runtime_stride : unique),
         unique_field_id((unique == 0) ? runtime_stride : unique),
+        speculated_operations(0), speculation_hits(0), speculation_misses(0),
+        wasted_speculative_tasks(0), wasted_speculative_copies(0),
+        wasted_speculative_time(0),
         available_lock(Reservation::create_reservation()), total_contexts(0),
         group_lock(Reservation::create_reservation()),
         distributed_id_lock(Reservation::create_reservation()),
@@ -3938,7 +4352,8 @@ namespace LegionRuntime {
         dependent_partition_op_lock(Reservation::create_reservation()),
         fill_op_lock(Reservation::create_reservation()),
         attach_op_lock(Reservation::create_reservation()),
-        detach_op_lock(Reservation::create_reservation())
+        detach_op_lock(Reservation::create_reservation()),
+        thread_cache_lock(true/*initialize*/), retired_cache_stats(this)
     //--------------------------------------------------------------------------
     {
       log_run.debug("Initializing high-level runtime in address space %x",
@@ -4049,7 +4464,8 @@ namespace LegionRuntime {
                                       machine, HLR_LAST_TASK_ID,
                                       hlr_task_descriptions, 
                                       Operation::LAST_OP_KIND, 
-                                      Operation::op_names); 
+                                      Operation::op_names,
+                                      Runtime::profile_perf_counters); 
         // We also have to register any statically registered task
         // variants here since the profiler didn't exist before
         const std::map<Processor::TaskFuncID,TaskVariantCollection*> 
@@ -4097,6 +4513,7 @@ namespace LegionRuntime {
         , cleanup_proc(Processor::NO_PROC), gc_proc(Processor::NO_PROC),
         message_proc(Processor::NO_PROC)
 #endif
+        , retired_cache_stats(NULL)
     //--------------------------------------------------------------------------
     {
       // should never be called
@@ -4121,6 +4538,20 @@ namespace LegionRuntime {
         delete profiler;
         profiler = NULL;
       }
+      if (speculation_statistics)
+      {
+        SpeculationStatistics stats;
+        sample_speculation_statistics(stats);
+        log_run.print("Speculation statistics for address space %d: "
+                      "%llu operations speculated, %llu hits, %llu misses "
+                      "(hit rate %.1f%%), %llu tasks and %llu copies rolled "
+                      "back, %llu us of wasted task execution", address_space,
+                      stats.speculated, stats.hits, stats.misses,
+                      ((stats.hits + stats.misses) > 0) ? 
+                        (100.0 * stats.hits) / (stats.hits + stats.misses) : 
+                        0.0, stats.wasted_tasks, stats.wasted_copies,
+                      stats.wasted_time);
+      }
       delete high_level;
       for (std::map<Processor,ProcessorManager*>::const_iterator it = 
             proc_managers.begin(); it != proc_managers.end(); it++)
@@ -4160,6 +4591,57 @@ namespace LegionRuntime {
       future_lock = Reservation::NO_RESERVATION;
       remote_lock.destroy_reservation();
       remote_lock = Reservation::NO_RESERVATION;
+      // Pull everything out of the thread caches so that it gets
+      // deleted with the rest of the pools below, exiting threads
+      // can't hand their caches back while we do this
+      pthread_mutex_lock(&thread_cache_owner_lock);
+      report_thread_cache_statistics();
+      reclaim_cached(available_individual_tasks,
+                     ThreadOpCache::INDIVIDUAL_TASK_CACHE);
+      reclaim_cached(available_point_tasks, ThreadOpCache::POINT_TASK_CACHE);
+      reclaim_cached(available_index_tasks, ThreadOpCache::INDEX_TASK_CACHE);
+      reclaim_cached(available_slice_tasks, ThreadOpCache::SLICE_TASK_CACHE);
+      reclaim_cached(available_remote_tasks, ThreadOpCache::REMOTE_TASK_CACHE);
+      reclaim_cached(available_inline_tasks, ThreadOpCache::INLINE_TASK_CACHE);
+      reclaim_cached(available_map_ops, ThreadOpCache::MAP_OP_CACHE);
+      reclaim_cached(available_copy_ops, ThreadOpCache::COPY_OP_CACHE);
+      reclaim_cached(available_fence_ops, ThreadOpCache::FENCE_OP_CACHE);
+      reclaim_cached(available_deletion_ops, ThreadOpCache::DELETION_OP_CACHE);
+      reclaim_cached(available_inter_close_ops,
+                     ThreadOpCache::INTER_CLOSE_OP_CACHE);
+      reclaim_cached(available_post_close_ops,
+                     ThreadOpCache::POST_CLOSE_OP_CACHE);
+      reclaim_cached(available_virtual_close_ops,
+                     ThreadOpCache::VIRTUAL_CLOSE_OP_CACHE);
+      reclaim_cached(available_dynamic_collective_ops,
+                     ThreadOpCache::DYNAMIC_COLLECTIVE_OP_CACHE);
+      reclaim_cached(available_future_pred_ops,
+                     ThreadOpCache::FUTURE_PRED_OP_CACHE);
+      reclaim_cached(available_not_pred_ops, ThreadOpCache::NOT_PRED_OP_CACHE);
+      reclaim_cached(available_and_pred_ops, ThreadOpCache::AND_PRED_OP_CACHE);
+      reclaim_cached(available_or_pred_ops, ThreadOpCache::OR_PRED_OP_CACHE);
+      reclaim_cached(available_acquire_ops, ThreadOpCache::ACQUIRE_OP_CACHE);
+      reclaim_cached(available_release_ops, ThreadOpCache::RELEASE_OP_CACHE);
+      reclaim_cached(available_capture_ops, ThreadOpCache::CAPTURE_OP_CACHE);
+      reclaim_cached(available_trace_ops, ThreadOpCache::TRACE_OP_CACHE);
+      reclaim_cached(available_epoch_ops, ThreadOpCache::EPOCH_OP_CACHE);
+      reclaim_cached(available_pending_partition_ops,
+                     ThreadOpCache::PENDING_PARTITION_OP_CACHE);
+      reclaim_cached(available_dependent_partition_ops,
+                     ThreadOpCache::DEPENDENT_PARTITION_OP_CACHE);
+      reclaim_cached(available_fill_ops, ThreadOpCache::FILL_OP_CACHE);
+      reclaim_cached(available_attach_ops, ThreadOpCache::ATTACH_OP_CACHE);
+      reclaim_cached(available_detach_ops, ThreadOpCache::DETACH_OP_CACHE);
+      {
+        // The threads still point at their caches so just disown them
+        AutoLock c_lock(thread_cache_lock);
+        for (std::vector<ThreadOpCache*>::const_iterator it =
+              thread_caches.begin(); it != thread_caches.end(); it++)
+          (*it)->owner = NULL;
+        thread_caches.clear();
+      }
+      pthread_mutex_unlock(&thread_cache_owner_lock);
+      thread_cache_lock.destroy();
       for (std::deque<IndividualTask*>::const_iterator it = 
             available_individual_tasks.begin(); 
             it != available_individual_tasks.end(); it++)
@@ -4514,16 +4996,14 @@ namespace LegionRuntime {
         top_context->initialize_remote(0, NULL);
         // Set the executing processor
         top_context->set_executing_processor(proc);
-        TaskLauncher launcher(Runtime::legion_main_id, TaskArgument());
+        // The input arguments are the top-level task's argument
+        TaskLauncher launcher(Runtime::legion_main_id, 
+            TaskArgument(&Runtime::get_input_args(), sizeof(InputArgs)));
         // Mark that this task is the top-level task
         top_task->set_top_level();
         top_task->initialize_task(top_context, launcher, 
                                   false/*check priv*/, false/*track parent*/);
-        // Set up the input arguments
-        top_task->arglen = sizeof(InputArgs);
-        top_task->args = malloc(top_task->arglen);
         top_task->depth = 0;
-        memcpy(top_task->args,&Runtime::get_input_args(),top_task->arglen);
 #ifdef DEBUG_HIGH_LEVEL
         assert(proc_managers.find(proc) != proc_managers.end());
 #endif
@@ -4880,6 +5360,7 @@ namespace LegionRuntime {
       Processor proc = ctx->get_executing_processor();
       DeletionOp *op = get_available_deletion_op(true);
       op->initialize_index_space_deletion(ctx, handle);
+      ctx->clear_cached_mappings();
 #ifdef INORDER_EXECUTION
       Event term_event = op->get_completion_event();
 #endif
@@ -5521,6 +6002,7 @@ namespace LegionRuntime {
       Processor proc = ctx->get_executing_processor();
       DeletionOp *op = get_available_deletion_op(true);
       op->initialize_index_part_deletion(ctx, handle);
+      ctx->clear_cached_mappings();
 #ifdef INORDER_EXECUTION
       Event term_event = op->get_completion_event();
 #endif
@@ -7244,6 +7726,7 @@ namespace LegionRuntime {
       Processor proc = ctx->get_executing_processor();
       DeletionOp *op = get_available_deletion_op(true);
       op->initialize_field_space_deletion(ctx, handle);
+      ctx->clear_cached_mappings();
 #ifdef INORDER_EXECUTION
       Event term_event = op->get_completion_event();
 #endif
@@ -7363,6 +7846,7 @@ namespace LegionRuntime {
       Processor proc = ctx->get_executing_processor();
       DeletionOp *op = get_available_deletion_op(true);
       op->initialize_logical_region_deletion(ctx, handle);
+      ctx->clear_cached_mappings();
 #ifdef INORDER_EXECUTION
       Event term_event = op->get_completion_event();
 #endif
@@ -7405,6 +7889,7 @@ namespace LegionRuntime {
       Processor proc = ctx->get_executing_processor();
       DeletionOp *op = get_available_deletion_op(true);
       op->initialize_logical_partition_deletion(ctx, handle);
+      ctx->clear_cached_mappings();
 #ifdef INORDER_EXECUTION
       Event term_event = op->get_completion_event();
 #endif
@@ -8184,11 +8669,58 @@ namespace LegionRuntime {
       return result;
     }
 
+    //--------------------------------------------------------------------------
+    Future Runtime::reduce_future_map(Context ctx, const FutureMap &future_map,
+                                      ReductionOpID redop)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_HIGH_LEVEL
+      if (ctx == DUMMY_CONTEXT)
+      {
+        log_run.error("Illegal dummy context reduce future map!");
+        assert(false);
+        exit(ERROR_DUMMY_CONTEXT_OPERATION);
+      }
+      log_run.debug("Reduce future map with reduction operator %d "
+                    "in task %s (ID %lld)", redop,
+                    ctx->variants->name, ctx->get_unique_task_id());
+#endif
+      if (future_map.impl == NULL)
+      {
+        log_run.error("Illegal reduction of an empty future map handle "
+                      "in task %s (ID %lld)", ctx->variants->name,
+                      ctx->get_unique_task_id());
+#ifdef DEBUG_HIGH_LEVEL
+        assert(false);
+#endif
+        exit(ERROR_ACCESSING_EMPTY_FUTURE);
+      }
+      Future result = future_map.impl->reduce_futures(redop);
+#ifdef INORDER_EXECUTION
+      if (program_order_execution)
+      {
+        result.get_void_result();
+      }
+#endif
+      return result;
+    }
+
     //--------------------------------------------------------------------------
     PhysicalRegion Runtime::map_region(Context ctx, 
                                                 const InlineLauncher &launcher)
     //--------------------------------------------------------------------------
     {
+      // See if we still have an earlier mapping of the same region
+      PhysicalRegion cached = ctx->find_cached_inline_mapping(
+                    launcher.requirement, launcher.map_id, launcher.tag);
+      if (cached.impl != NULL)
+      {
+#ifdef INORDER_EXECUTION
+        if (program_order_execution)
+          cached.wait_until_valid();
+#endif
+        return cached;
+      }
       MapOp *map_op = get_available_map_op(true);
 #ifdef DEBUG_HIGH_LEVEL
       PhysicalRegion result = map_op->initialize(ctx, launcher, 
@@ -8261,6 +8793,16 @@ namespace LegionRuntime {
                     const RegionRequirement &req, MapperID id, MappingTagID tag)
     //--------------------------------------------------------------------------
     {
+      // See if we still have an earlier mapping of the same region
+      PhysicalRegion cached = ctx->find_cached_inline_mapping(req, id, tag);
+      if (cached.impl != NULL)
+      {
+#ifdef INORDER_EXECUTION
+        if (program_order_execution)
+          cached.wait_until_valid();
+#endif
+        return cached;
+      }
       MapOp *map_op = get_available_map_op(true);
 #ifdef DEBUG_HIGH_LEVEL
       PhysicalRegion result = map_op->initialize(ctx, req, id, tag, 
@@ -8364,6 +8906,17 @@ namespace LegionRuntime {
         exit(ERROR_LEAF_TASK_VIOLATION);
       }
 #endif
+      // If nothing conflicting has happened since we unmapped it then
+      // we can hand back the same instance without a mapping operation
+      if (ctx->remap_cached_inline_mapping(region))
+      {
+        ctx->register_inline_mapped_region(region);
+#ifdef INORDER_EXECUTION
+        if (program_order_execution)
+          region.wait_until_valid();
+#endif
+        return;
+      }
       MapOp *map_op = get_available_map_op(true);
       map_op->initialize(ctx, region);
       ctx->register_inline_mapped_region(region);
@@ -8398,7 +8951,11 @@ namespace LegionRuntime {
 #endif
       ctx->unregister_inline_mapped_region(region);
       if (region.impl->is_mapped())
+      {
+        // Hang onto the mapping in case the task maps it again
+        ctx->cache_inline_mapping(region);
         region.impl->unmap_region();
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -10247,6 +10804,7 @@ namespace LegionRuntime {
       Processor proc = ctx->get_executing_processor();
       DeletionOp *op = get_available_deletion_op(true);
       op->initialize_field_deletion(ctx, space, fid);
+      ctx->clear_cached_mappings();
 #ifdef INORDER_EXECUTION
       Event term_event = op->get_completion_event();
 #endif
@@ -10332,6 +10890,7 @@ namespace LegionRuntime {
       Processor proc = ctx->get_executing_processor();
       DeletionOp *op = get_available_deletion_op(true);
       op->initialize_field_deletions(ctx, space, to_free);
+      ctx->clear_cached_mappings();
 #ifdef INORDER_EXECUTION
       Event term_event = op->get_completion_event();
 #endif
@@ -10459,6 +11018,49 @@ namespace LegionRuntime {
         return 0;
     }
 
+    //--------------------------------------------------------------------------
+    void Runtime::sample_speculation_statistics(
+                                          SpeculationStatistics &stats) const
+    //--------------------------------------------------------------------------
+    {
+      stats.speculated = speculated_operations;
+      stats.hits = speculation_hits;
+      stats.misses = speculation_misses;
+      stats.wasted_tasks = wasted_speculative_tasks;
+      stats.wasted_copies = wasted_speculative_copies;
+      stats.wasted_time = wasted_speculative_time;
+    }
+
+    //--------------------------------------------------------------------------
+    void Runtime::record_speculation_started(void)
+    //--------------------------------------------------------------------------
+    {
+      __sync_fetch_and_add(&speculated_operations, 1);
+    }
+
+    //--------------------------------------------------------------------------
+    void Runtime::record_speculation_resolved(bool hit)
+    //--------------------------------------------------------------------------
+    {
+      if (hit)
+        __sync_fetch_and_add(&speculation_hits, 1);
+      else
+        __sync_fetch_and_add(&speculation_misses, 1);
+    }
+
+    //--------------------------------------------------------------------------
+    void Runtime::record_speculation_waste(unsigned tasks, unsigned copies,
+                                           long long time_in_us)
+    //--------------------------------------------------------------------------
+    {
+      if (tasks > 0)
+        __sync_fetch_and_add(&wasted_speculative_tasks, tasks);
+      if (copies > 0)
+        __sync_fetch_and_add(&wasted_speculative_copies, copies);
+      if (time_in_us > 0)
+        __sync_fetch_and_add(&wasted_speculative_time, time_in_us);
+    }
+
     //--------------------------------------------------------------------------
     MessageManager* Runtime::find_messenger(AddressSpaceID sid)
     //--------------------------------------------------------------------------
@@ -10540,7 +11142,9 @@ namespace LegionRuntime {
       else
       {
         MessageManager *manager = find_messenger(target);
-        Serializer rez;
+        // Size the buffer for the arguments up front so large
+        // arguments don't get copied again by every resize
+        Serializer rez(DEFAULT_SERIALIZER_SIZE + task->arglen);
         bool deactivate_task;
         {
           RezCheck z(rez);
@@ -10584,7 +11188,7 @@ namespace LegionRuntime {
         for (std::set<TaskOp*>::const_iterator it = tasks.begin();
               it != tasks.end(); it++,idx++)
         {
-          Serializer rez;
+          Serializer rez(DEFAULT_SERIALIZER_SIZE + (*it)->arglen);
           bool deactivate_task;
           {
             RezCheck z(rez);
@@ -13090,23 +13694,297 @@ namespace LegionRuntime {
       LLRuntime::get_runtime().shutdown();
     }
 
+    //--------------------------------------------------------------------------
+    void Runtime::register_thread_cache(ThreadOpCache *cache)
+    //--------------------------------------------------------------------------
+    {
+      AutoLock c_lock(thread_cache_lock);
+      thread_caches.push_back(cache);
+    }
+
+    //--------------------------------------------------------------------------
+    void Runtime::release_thread_cache(ThreadOpCache *cache)
+    //--------------------------------------------------------------------------
+    {
+      {
+        AutoLock c_lock(thread_cache_lock);
+        for (std::vector<ThreadOpCache*>::iterator it = 
+              thread_caches.begin(); it != thread_caches.end(); it++)
+        {
+          if ((*it) != cache)
+            continue;
+          thread_caches.erase(it);
+          break;
+        }
+        for (unsigned kind = 0; kind < ThreadOpCache::NUM_CACHE_KINDS; kind++)
+        {
+          retired_cache_stats.hits[kind] += cache->hits[kind];
+          retired_cache_stats.refills[kind] += cache->refills[kind];
+          retired_cache_stats.spills[kind] += cache->spills[kind];
+          retired_cache_stats.allocations[kind] += cache->allocations[kind];
+        }
+      }
+      for (unsigned kind = 0; kind < ThreadOpCache::NUM_CACHE_KINDS; kind++)
+      {
+        if (cache->counts[kind] == 0)
+          continue;
+        return_cached(ThreadOpCache::Kind(kind), cache->objects[kind],
+                      cache->counts[kind]);
+        cache->counts[kind] = 0;
+      }
+      cache->owner = NULL;
+    }
+
+    //--------------------------------------------------------------------------
+    void Runtime::accept_cache_batch(ThreadOpCache::Batch &batch)
+    //--------------------------------------------------------------------------
+    {
+      const ThreadOpCache::Kind kind = batch.kind;
+      unsigned taken = 0;
+      ThreadOpCache *cache = ThreadOpCache::find_local(this);
+      if (cache != NULL)
+      {
+        unsigned &count = cache->counts[kind];
+        while ((taken < batch.count) && 
+               (count < ThreadOpCache::MAGAZINE_SIZE))
+          cache->objects[kind][count++] = batch.objects[taken++];
+        cache->refills[kind]++;
+      }
+      // Anything that doesn't fit goes back to the shared pool
+      if (taken < batch.count)
+        return_cached(kind, batch.objects + taken, batch.count - taken);
+      batch.count = 0;
+    }
+
+    //--------------------------------------------------------------------------
+    void Runtime::return_cached(ThreadOpCache::Kind kind,
+                                void *const *objects, unsigned count)
+    //--------------------------------------------------------------------------
+    {
+      switch (kind)
+      {
+        case ThreadOpCache::INDIVIDUAL_TASK_CACHE:
+          {
+            return_cached(individual_task_lock, available_individual_tasks,
+                          objects, count);
+            break;
+          }
+        case ThreadOpCache::POINT_TASK_CACHE:
+          {
+            return_cached(point_task_lock, available_point_tasks,
+                          objects, count, true/*can delete*/);
+            break;
+          }
+        case ThreadOpCache::INDEX_TASK_CACHE:
+          {
+            return_cached(index_task_lock, available_index_tasks,
+                          objects, count);
+            break;
+          }
+        case ThreadOpCache::SLICE_TASK_CACHE:
+          {
+            return_cached(slice_task_lock, available_slice_tasks,
+                          objects, count, true/*can delete*/);
+            break;
+          }
+        case ThreadOpCache::REMOTE_TASK_CACHE:
+          {
+            return_cached(remote_task_lock, available_remote_tasks,
+                          objects, count, true/*can delete*/);
+            break;
+          }
+        case ThreadOpCache::INLINE_TASK_CACHE:
+          {
+            return_cached(inline_task_lock, available_inline_tasks,
+                          objects, count, true/*can delete*/);
+            break;
+          }
+        case ThreadOpCache::MAP_OP_CACHE:
+          {
+            return_cached(map_op_lock, available_map_ops, objects, count);
+            break;
+          }
+        case ThreadOpCache::COPY_OP_CACHE:
+          {
+            return_cached(copy_op_lock, available_copy_ops, objects, count);
+            break;
+          }
+        case ThreadOpCache::FENCE_OP_CACHE:
+          {
+            return_cached(fence_op_lock, available_fence_ops, objects, count);
+            break;
+          }
+        case ThreadOpCache::DELETION_OP_CACHE:
+          {
+            return_cached(deletion_op_lock, available_deletion_ops,
+                          objects, count);
+            break;
+          }
+        case ThreadOpCache::INTER_CLOSE_OP_CACHE:
+          {
+            return_cached(inter_close_op_lock, available_inter_close_ops,
+                          objects, count);
+            break;
+          }
+        case ThreadOpCache::POST_CLOSE_OP_CACHE:
+          {
+            return_cached(post_close_op_lock, available_post_close_ops,
+                          objects, count);
+            break;
+          }
+        case ThreadOpCache::VIRTUAL_CLOSE_OP_CACHE:
+          {
+            return_cached(virtual_close_op_lock, available_virtual_close_ops,
+                          objects, count);
+            break;
+          }
+        case ThreadOpCache::DYNAMIC_COLLECTIVE_OP_CACHE:
+          {
+            return_cached(dynamic_collective_op_lock, 
+                          available_dynamic_collective_ops, objects, count);
+            break;
+          }
+        case ThreadOpCache::FUTURE_PRED_OP_CACHE:
+          {
+            return_cached(future_pred_op_lock, available_future_pred_ops,
+                          objects, count);
+            break;
+          }
+        case ThreadOpCache::NOT_PRED_OP_CACHE:
+          {
+            return_cached(not_pred_op_lock, available_not_pred_ops,
+                          objects, count);
+            break;
+          }
+        case ThreadOpCache::AND_PRED_OP_CACHE:
+          {
+            return_cached(and_pred_op_lock, available_and_pred_ops,
+                          objects, count);
+            break;
+          }
+        case ThreadOpCache::OR_PRED_OP_CACHE:
+          {
+            return_cached(or_pred_op_lock, available_or_pred_ops,
+                          objects, count);
+            break;
+          }
+        case ThreadOpCache::ACQUIRE_OP_CACHE:
+          {
+            return_cached(acquire_op_lock, available_acquire_ops,
+                          objects, count);
+            break;
+          }
+        case ThreadOpCache::RELEASE_OP_CACHE:
+          {
+            return_cached(release_op_lock, available_release_ops,
+                          objects, count);
+            break;
+          }
+        case ThreadOpCache::CAPTURE_OP_CACHE:
+          {
+            return_cached(capture_op_lock, available_capture_ops,
+                          objects, count);
+            break;
+          }
+        case ThreadOpCache::TRACE_OP_CACHE:
+          {
+            return_cached(trace_op_lock, available_trace_ops, objects, count);
+            break;
+          }
+        case ThreadOpCache::EPOCH_OP_CACHE:
+          {
+            return_cached(epoch_op_lock, available_epoch_ops, objects, count);
+            break;
+          }
+        case ThreadOpCache::PENDING_PARTITION_OP_CACHE:
+          {
+            return_cached(pending_partition_op_lock, 
+                          available_pending_partition_ops, objects, count);
+            break;
+          }
+        case ThreadOpCache::DEPENDENT_PARTITION_OP_CACHE:
+          {
+            return_cached(dependent_partition_op_lock,
+                          available_dependent_partition_ops, objects, count);
+            break;
+          }
+        case ThreadOpCache::FILL_OP_CACHE:
+          {
+            return_cached(fill_op_lock, available_fill_ops, objects, count);
+            break;
+          }
+        case ThreadOpCache::ATTACH_OP_CACHE:
+          {
+            return_cached(attach_op_lock, available_attach_ops, 
+                          objects, count);
+            break;
+          }
+        case ThreadOpCache::DETACH_OP_CACHE:
+          {
+            return_cached(detach_op_lock, available_detach_ops, 
+                          objects, count);
+            break;
+          }
+        default:
+          assert(false);
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    void Runtime::report_thread_cache_statistics(void)
+    //--------------------------------------------------------------------------
+    {
+      AutoLock c_lock(thread_cache_lock);
+      for (unsigned kind = 0; kind < ThreadOpCache::NUM_CACHE_KINDS; kind++)
+      {
+        unsigned long long hits = retired_cache_stats.hits[kind];
+        unsigned long long refills = retired_cache_stats.refills[kind];
+        unsigned long long spills = retired_cache_stats.spills[kind];
+        unsigned long long allocations = retired_cache_stats.allocations[kind];
+        for (std::vector<ThreadOpCache*>::const_iterator it =
+              thread_caches.begin(); it != thread_caches.end(); it++)
+        {
+          hits += (*it)->hits[kind];
+          refills += (*it)->refills[kind];
+          spills += (*it)->spills[kind];
+          allocations += (*it)->allocations[kind];
+        }
+        // Every request either hits in a thread cache, gets
+        // an object from the shared pool, or makes a new one
+        unsigned long long requests = hits + refills + allocations;
+        if (requests == 0)
+          continue;
+        log_run.info("%s pool: %llu requests, %.1f%% thread cache hits, "
+                     "%llu refills, %llu spills, %llu allocations",
+                     ThreadOpCache::get_kind_name(ThreadOpCache::Kind(kind)),
+                     requests, 100.0 * hits / requests, refills, spills,
+                     allocations);
+      }
+    }
+
     //--------------------------------------------------------------------------
     IndividualTask* Runtime::get_available_individual_task(bool need_cont,
                                                            bool has_lock)
     //--------------------------------------------------------------------------
     {
-      if (need_cont)
+      IndividualTask *result =
+        get_cached<IndividualTask>(ThreadOpCache::INDIVIDUAL_TASK_CACHE);
+      if (result == NULL)
       {
+        if (need_cont)
+        {
 #ifdef DEBUG_HIGH_LEVEL
-        assert(!has_lock);
+          assert(!has_lock);
 #endif
-        GetAvailableContinuation<IndividualTask*,
-                     &Runtime::get_available_individual_task> 
-                       continuation(this, individual_task_lock);
-        return continuation.get_result();
+          GetAvailableContinuation<IndividualTask*,
+                       &Runtime::get_available_individual_task> 
+                         continuation(this, individual_task_lock);
+          return continuation.get_result();
+        }
+        result = get_available(individual_task_lock,
+                               available_individual_tasks, has_lock,
+                               ThreadOpCache::INDIVIDUAL_TASK_CACHE);
       }
-      IndividualTask *result = get_available(individual_task_lock, 
-                                         available_individual_tasks, has_lock);
 #if defined(DEBUG_HIGH_LEVEL) || defined(HANG_TRACE)
       if (!has_lock)
       {
@@ -13123,18 +14001,23 @@ namespace LegionRuntime {
     PointTask* Runtime::get_available_point_task(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
-      if (need_cont)
+      PointTask *result =
+        get_cached<PointTask>(ThreadOpCache::POINT_TASK_CACHE);
+      if (result == NULL)
       {
+        if (need_cont)
+        {
 #ifdef DEBUG_HIGH_LEVEL
-        assert(!has_lock);
+          assert(!has_lock);
 #endif
-        GetAvailableContinuation<PointTask*,
-                     &Runtime::get_available_point_task> 
-                       continuation(this, point_task_lock);
-        return continuation.get_result();
+          GetAvailableContinuation<PointTask*,
+                       &Runtime::get_available_point_task> 
+                         continuation(this, point_task_lock);
+          return continuation.get_result();
+        }
+        result = get_available(point_task_lock, available_point_tasks,
+                               has_lock, ThreadOpCache::POINT_TASK_CACHE);
       }
-      PointTask *result = get_available(point_task_lock, 
-                                        available_point_tasks, has_lock);
 #if defined(DEBUG_HIGH_LEVEL) || defined(HANG_TRACE)
       if (!has_lock)
       {
@@ -13151,18 +14034,23 @@ namespace LegionRuntime {
     IndexTask* Runtime::get_available_index_task(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
-      if (need_cont)
+      IndexTask *result =
+        get_cached<IndexTask>(ThreadOpCache::INDEX_TASK_CACHE);
+      if (result == NULL)
       {
+        if (need_cont)
+        {
 #ifdef DEBUG_HIGH_LEVEL
-        assert(!has_lock);
+          assert(!has_lock);
 #endif
-        GetAvailableContinuation<IndexTask*,
-                     &Runtime::get_available_index_task> 
-                       continuation(this, index_task_lock);
-        return continuation.get_result();
+          GetAvailableContinuation<IndexTask*,
+                       &Runtime::get_available_index_task> 
+                         continuation(this, index_task_lock);
+          return continuation.get_result();
+        }
+        result = get_available(index_task_lock, available_index_tasks,
+                               has_lock, ThreadOpCache::INDEX_TASK_CACHE);
       }
-      IndexTask *result = get_available(index_task_lock, 
-                                       available_index_tasks, has_lock);
 #if defined(DEBUG_HIGH_LEVEL) || defined(HANG_TRACE)
       if (!has_lock)
       {
@@ -13179,18 +14067,23 @@ namespace LegionRuntime {
     SliceTask* Runtime::get_available_slice_task(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
-      if (need_cont)
+      SliceTask *result =
+        get_cached<SliceTask>(ThreadOpCache::SLICE_TASK_CACHE);
+      if (result == NULL)
       {
+        if (need_cont)
+        {
 #ifdef DEBUG_HIGH_LEVEL
-        assert(!has_lock);
+          assert(!has_lock);
 #endif
-        GetAvailableContinuation<SliceTask*,
-                     &Runtime::get_available_slice_task> 
-                       continuation(this, slice_task_lock);
-        return continuation.get_result();
+          GetAvailableContinuation<SliceTask*,
+                       &Runtime::get_available_slice_task> 
+                         continuation(this, slice_task_lock);
+          return continuation.get_result();
+        }
+        result = get_available(slice_task_lock, available_slice_tasks,
+                               has_lock, ThreadOpCache::SLICE_TASK_CACHE);
       }
-      SliceTask *result = get_available(slice_task_lock, 
-                                       available_slice_tasks, has_lock);
 #if defined(DEBUG_HIGH_LEVEL) || defined(HANG_TRACE)
       if (!has_lock)
       {
@@ -13208,6 +14101,10 @@ namespace LegionRuntime {
                                                    bool has_lock)
     //--------------------------------------------------------------------------
     {
+      RemoteTask *result =
+        get_cached<RemoteTask>(ThreadOpCache::REMOTE_TASK_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13218,7 +14115,8 @@ namespace LegionRuntime {
                        continuation(this, remote_task_lock);
         return continuation.get_result();
       }
-      return get_available(remote_task_lock, available_remote_tasks, has_lock);
+      return get_available(remote_task_lock, available_remote_tasks, has_lock,
+                           ThreadOpCache::REMOTE_TASK_CACHE);
     }
 
     //--------------------------------------------------------------------------
@@ -13226,6 +14124,10 @@ namespace LegionRuntime {
                                                    bool has_lock)
     //--------------------------------------------------------------------------
     {
+      InlineTask *result =
+        get_cached<InlineTask>(ThreadOpCache::INLINE_TASK_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13236,13 +14138,17 @@ namespace LegionRuntime {
                        continuation(this, inline_task_lock);
         return continuation.get_result();
       }
-      return get_available(inline_task_lock, available_inline_tasks, has_lock);
+      return get_available(inline_task_lock, available_inline_tasks, has_lock,
+                           ThreadOpCache::INLINE_TASK_CACHE);
     }
 
     //--------------------------------------------------------------------------
     MapOp* Runtime::get_available_map_op(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      MapOp *result = get_cached<MapOp>(ThreadOpCache::MAP_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13253,13 +14159,17 @@ namespace LegionRuntime {
                        continuation(this, map_op_lock);
         return continuation.get_result();
       }
-      return get_available(map_op_lock, available_map_ops, has_lock);
+      return get_available(map_op_lock, available_map_ops, has_lock,
+                           ThreadOpCache::MAP_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
     CopyOp* Runtime::get_available_copy_op(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      CopyOp *result = get_cached<CopyOp>(ThreadOpCache::COPY_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13270,13 +14180,17 @@ namespace LegionRuntime {
                        continuation(this, copy_op_lock);
         return continuation.get_result();
       }
-      return get_available(copy_op_lock, available_copy_ops, has_lock);
+      return get_available(copy_op_lock, available_copy_ops, has_lock,
+                           ThreadOpCache::COPY_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
     FenceOp* Runtime::get_available_fence_op(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      FenceOp *result = get_cached<FenceOp>(ThreadOpCache::FENCE_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13287,7 +14201,8 @@ namespace LegionRuntime {
                        continuation(this, fence_op_lock);
         return continuation.get_result();
       }
-      return get_available(fence_op_lock, available_fence_ops, has_lock);
+      return get_available(fence_op_lock, available_fence_ops, has_lock,
+                           ThreadOpCache::FENCE_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
@@ -13312,6 +14227,10 @@ namespace LegionRuntime {
                                                    bool has_lock)
     //--------------------------------------------------------------------------
     {
+      DeletionOp *result =
+        get_cached<DeletionOp>(ThreadOpCache::DELETION_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13322,7 +14241,8 @@ namespace LegionRuntime {
                        continuation(this, deletion_op_lock);
         return continuation.get_result();
       }
-      return get_available(deletion_op_lock, available_deletion_ops, has_lock);
+      return get_available(deletion_op_lock, available_deletion_ops, has_lock,
+                           ThreadOpCache::DELETION_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
@@ -13330,6 +14250,10 @@ namespace LegionRuntime {
                                                         bool has_lock)
     //--------------------------------------------------------------------------
     {
+      InterCloseOp *result =
+        get_cached<InterCloseOp>(ThreadOpCache::INTER_CLOSE_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13341,7 +14265,8 @@ namespace LegionRuntime {
         return continuation.get_result();
       }
       return get_available(inter_close_op_lock, 
-                           available_inter_close_ops, has_lock);
+                           available_inter_close_ops, has_lock,
+                           ThreadOpCache::INTER_CLOSE_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
@@ -13349,6 +14274,10 @@ namespace LegionRuntime {
                                                       bool has_lock)
     //--------------------------------------------------------------------------
     {
+      PostCloseOp *result =
+        get_cached<PostCloseOp>(ThreadOpCache::POST_CLOSE_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13360,7 +14289,8 @@ namespace LegionRuntime {
         return continuation.get_result();
       }
       return get_available(post_close_op_lock, 
-                           available_post_close_ops, has_lock);
+                           available_post_close_ops, has_lock,
+                           ThreadOpCache::POST_CLOSE_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
@@ -13368,6 +14298,10 @@ namespace LegionRuntime {
                                                             bool has_lock)
     //--------------------------------------------------------------------------
     {
+      VirtualCloseOp *result =
+        get_cached<VirtualCloseOp>(ThreadOpCache::VIRTUAL_CLOSE_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13379,7 +14313,8 @@ namespace LegionRuntime {
         return continuation.get_result();
       }
       return get_available(virtual_close_op_lock,
-                           available_virtual_close_ops, has_lock);
+                           available_virtual_close_ops, has_lock,
+                           ThreadOpCache::VIRTUAL_CLOSE_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
@@ -13387,6 +14322,11 @@ namespace LegionRuntime {
                                                   bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      DynamicCollectiveOp *result =
+        get_cached<DynamicCollectiveOp>(
+                                  ThreadOpCache::DYNAMIC_COLLECTIVE_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13398,7 +14338,8 @@ namespace LegionRuntime {
         return continuation.get_result();
       }
       return get_available(dynamic_collective_op_lock, 
-                           available_dynamic_collective_ops, has_lock);
+                           available_dynamic_collective_ops, has_lock,
+                           ThreadOpCache::DYNAMIC_COLLECTIVE_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
@@ -13406,6 +14347,10 @@ namespace LegionRuntime {
                                                         bool has_lock)
     //--------------------------------------------------------------------------
     {
+      FuturePredOp *result =
+        get_cached<FuturePredOp>(ThreadOpCache::FUTURE_PRED_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13417,13 +14362,18 @@ namespace LegionRuntime {
         return continuation.get_result();
       }
       return get_available(future_pred_op_lock, 
-                           available_future_pred_ops, has_lock);
+                           available_future_pred_ops, has_lock,
+                           ThreadOpCache::FUTURE_PRED_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
     NotPredOp* Runtime::get_available_not_pred_op(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      NotPredOp *result =
+        get_cached<NotPredOp>(ThreadOpCache::NOT_PRED_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13434,13 +14384,18 @@ namespace LegionRuntime {
                        continuation(this, not_pred_op_lock);
         return continuation.get_result();
       }
-      return get_available(not_pred_op_lock, available_not_pred_ops, has_lock);
+      return get_available(not_pred_op_lock, available_not_pred_ops, has_lock,
+                           ThreadOpCache::NOT_PRED_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
     AndPredOp* Runtime::get_available_and_pred_op(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      AndPredOp *result =
+        get_cached<AndPredOp>(ThreadOpCache::AND_PRED_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13451,13 +14406,17 @@ namespace LegionRuntime {
                        continuation(this, and_pred_op_lock);
         return continuation.get_result();
       }
-      return get_available(and_pred_op_lock, available_and_pred_ops, has_lock);
+      return get_available(and_pred_op_lock, available_and_pred_ops, has_lock,
+                           ThreadOpCache::AND_PRED_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
     OrPredOp* Runtime::get_available_or_pred_op(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      OrPredOp *result = get_cached<OrPredOp>(ThreadOpCache::OR_PRED_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13468,13 +14427,18 @@ namespace LegionRuntime {
                        continuation(this, or_pred_op_lock);
         return continuation.get_result();
       }
-      return get_available(or_pred_op_lock, available_or_pred_ops, has_lock);
+      return get_available(or_pred_op_lock, available_or_pred_ops, has_lock,
+                           ThreadOpCache::OR_PRED_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
     AcquireOp* Runtime::get_available_acquire_op(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      AcquireOp *result =
+        get_cached<AcquireOp>(ThreadOpCache::ACQUIRE_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13485,13 +14449,18 @@ namespace LegionRuntime {
                        continuation(this, acquire_op_lock);
         return continuation.get_result();
       }
-      return get_available(acquire_op_lock, available_acquire_ops, has_lock);
+      return get_available(acquire_op_lock, available_acquire_ops, has_lock,
+                           ThreadOpCache::ACQUIRE_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
     ReleaseOp* Runtime::get_available_release_op(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      ReleaseOp *result =
+        get_cached<ReleaseOp>(ThreadOpCache::RELEASE_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13502,7 +14471,8 @@ namespace LegionRuntime {
                        continuation(this, release_op_lock);
         return continuation.get_result();
       }
-      return get_available(release_op_lock, available_release_ops, has_lock);
+      return get_available(release_op_lock, available_release_ops, has_lock,
+                           ThreadOpCache::RELEASE_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
@@ -13510,6 +14480,10 @@ namespace LegionRuntime {
                                                       bool has_lock)
     //--------------------------------------------------------------------------
     {
+      TraceCaptureOp *result =
+        get_cached<TraceCaptureOp>(ThreadOpCache::CAPTURE_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13520,7 +14494,8 @@ namespace LegionRuntime {
                        continuation(this, capture_op_lock);
         return continuation.get_result();
       }
-      return get_available(capture_op_lock, available_capture_ops, has_lock);
+      return get_available(capture_op_lock, available_capture_ops, has_lock,
+                           ThreadOpCache::CAPTURE_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
@@ -13528,6 +14503,10 @@ namespace LegionRuntime {
                                                      bool has_lock)
     //--------------------------------------------------------------------------
     {
+      TraceCompleteOp *result =
+        get_cached<TraceCompleteOp>(ThreadOpCache::TRACE_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13538,13 +14517,18 @@ namespace LegionRuntime {
                        continuation(this, trace_op_lock);
         return continuation.get_result();
       }
-      return get_available(trace_op_lock, available_trace_ops, has_lock);
+      return get_available(trace_op_lock, available_trace_ops, has_lock,
+                           ThreadOpCache::TRACE_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
     MustEpochOp* Runtime::get_available_epoch_op(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      MustEpochOp *result =
+        get_cached<MustEpochOp>(ThreadOpCache::EPOCH_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13555,7 +14539,8 @@ namespace LegionRuntime {
                        continuation(this, epoch_op_lock);
         return continuation.get_result();
       }
-      return get_available(epoch_op_lock, available_epoch_ops, has_lock);
+      return get_available(epoch_op_lock, available_epoch_ops, has_lock,
+                           ThreadOpCache::EPOCH_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
@@ -13563,6 +14548,11 @@ namespace LegionRuntime {
                                                   bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      PendingPartitionOp *result =
+        get_cached<PendingPartitionOp>(
+                                  ThreadOpCache::PENDING_PARTITION_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13574,7 +14564,8 @@ namespace LegionRuntime {
         return continuation.get_result();
       }
       return get_available(pending_partition_op_lock, 
-                           available_pending_partition_ops, has_lock);
+                           available_pending_partition_ops, has_lock,
+                           ThreadOpCache::PENDING_PARTITION_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
@@ -13582,6 +14573,11 @@ namespace LegionRuntime {
                                                   bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      DependentPartitionOp *result =
+        get_cached<DependentPartitionOp>(
+                                  ThreadOpCache::DEPENDENT_PARTITION_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13593,13 +14589,17 @@ namespace LegionRuntime {
         return continuation.get_result();
       }
       return get_available(dependent_partition_op_lock, 
-                           available_dependent_partition_ops, has_lock);
+                           available_dependent_partition_ops, has_lock,
+                           ThreadOpCache::DEPENDENT_PARTITION_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
     FillOp* Runtime::get_available_fill_op(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      FillOp *result = get_cached<FillOp>(ThreadOpCache::FILL_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13610,13 +14610,17 @@ namespace LegionRuntime {
                        continuation(this, fill_op_lock);
         return continuation.get_result();
       }
-      return get_available(fill_op_lock, available_fill_ops, has_lock);
+      return get_available(fill_op_lock, available_fill_ops, has_lock,
+                           ThreadOpCache::FILL_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
     AttachOp* Runtime::get_available_attach_op(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      AttachOp *result = get_cached<AttachOp>(ThreadOpCache::ATTACH_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13627,13 +14631,17 @@ namespace LegionRuntime {
                        continuation(this, attach_op_lock);
         return continuation.get_result();
       }
-      return get_available(attach_op_lock, available_attach_ops, has_lock);
+      return get_available(attach_op_lock, available_attach_ops, has_lock,
+                           ThreadOpCache::ATTACH_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
     DetachOp* Runtime::get_available_detach_op(bool need_cont, bool has_lock)
     //--------------------------------------------------------------------------
     {
+      DetachOp *result = get_cached<DetachOp>(ThreadOpCache::DETACH_OP_CACHE);
+      if (result != NULL)
+        return result;
       if (need_cont)
       {
 #ifdef DEBUG_HIGH_LEVEL
@@ -13644,125 +14652,129 @@ namespace LegionRuntime {
                        continuation(this, detach_op_lock);
         return continuation.get_result();
       }
-      return get_available(detach_op_lock, available_detach_ops, has_lock);
+      return get_available(detach_op_lock, available_detach_ops, has_lock,
+                           ThreadOpCache::DETACH_OP_CACHE);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_individual_task(IndividualTask *task)
     //--------------------------------------------------------------------------
     {
-      AutoLock i_lock(individual_task_lock);
-      available_individual_tasks.push_front(task);
 #if defined(DEBUG_HIGH_LEVEL) || defined(HANG_TRACE)
-      out_individual_tasks.erase(task);
+      {
+        AutoLock i_lock(individual_task_lock);
+        out_individual_tasks.erase(task);
+      }
 #endif
+      release_available(individual_task_lock, available_individual_tasks, task,
+                        ThreadOpCache::INDIVIDUAL_TASK_CACHE,
+                        false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_point_task(PointTask *task)
     //--------------------------------------------------------------------------
     {
-      AutoLock p_lock(point_task_lock);
 #if defined(DEBUG_HIGH_LEVEL) || defined(HANG_TRACE)
-      out_point_tasks.erase(task);
+      {
+        AutoLock p_lock(point_task_lock);
+        out_point_tasks.erase(task);
+      }
 #endif
       // Note that we can safely delete point tasks because they are
       // never registered in the logical state of the region tree
       // as part of the dependence analysis. This does not apply
       // to all operation objects.
-      if (available_point_tasks.size() == LEGION_MAX_RECYCLABLE_OBJECTS)
-        legion_delete(task);
-      else
-        available_point_tasks.push_front(task);
+      release_available(point_task_lock, available_point_tasks, task,
+                        ThreadOpCache::POINT_TASK_CACHE, true/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_index_task(IndexTask *task)
     //--------------------------------------------------------------------------
     {
-      AutoLock i_lock(index_task_lock);
-      available_index_tasks.push_front(task);
 #if defined(DEBUG_HIGH_LEVEL) || defined(HANG_TRACE)
-      out_index_tasks.erase(task);
+      {
+        AutoLock i_lock(index_task_lock);
+        out_index_tasks.erase(task);
+      }
 #endif
+      release_available(index_task_lock, available_index_tasks, task,
+                        ThreadOpCache::INDEX_TASK_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_slice_task(SliceTask *task)
     //--------------------------------------------------------------------------
     {
-      AutoLock s_lock(slice_task_lock);
 #if defined(DEBUG_HIGH_LEVEL) || defined(HANG_TRACE)
-      out_slice_tasks.erase(task);
+      {
+        AutoLock s_lock(slice_task_lock);
+        out_slice_tasks.erase(task);
+      }
 #endif
       // Note that we can safely delete slice tasks because they are
       // never registered in the logical state of the region tree
       // as part of the dependence analysis. This does not apply
       // to all operation objects.
-      if (available_slice_tasks.size() == LEGION_MAX_RECYCLABLE_OBJECTS)
-        legion_delete(task);
-      else
-        available_slice_tasks.push_front(task);
+      release_available(slice_task_lock, available_slice_tasks, task,
+                        ThreadOpCache::SLICE_TASK_CACHE, true/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_remote_task(RemoteTask *task)
     //--------------------------------------------------------------------------
     {
-      AutoLock r_lock(remote_task_lock);
       // Note that we can safely delete remote tasks because they are
       // never registered in the logical state of the region tree
       // as part of the dependence analysis. This does not apply
       // to all operation objects.
-      if (available_remote_tasks.size() == LEGION_MAX_RECYCLABLE_OBJECTS)
-        legion_delete(task);
-      else
-        available_remote_tasks.push_front(task);
+      release_available(remote_task_lock, available_remote_tasks, task,
+                        ThreadOpCache::REMOTE_TASK_CACHE, true/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_inline_task(InlineTask *task)
     //--------------------------------------------------------------------------
     {
-      AutoLock i_lock(inline_task_lock);
       // Note that we can safely delete inline tasks because they are
       // never registered in the logical state of the region tree
       // as part of the dependence analysis. This does not apply
       // to all operation objects.
-      if (available_inline_tasks.size() == LEGION_MAX_RECYCLABLE_OBJECTS)
-        legion_delete(task);
-      else
-        available_inline_tasks.push_front(task);
+      release_available(inline_task_lock, available_inline_tasks, task,
+                        ThreadOpCache::INLINE_TASK_CACHE, true/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_map_op(MapOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock m_lock(map_op_lock);
-      available_map_ops.push_front(op);
+      release_available(map_op_lock, available_map_ops, op,
+                        ThreadOpCache::MAP_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_copy_op(CopyOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock c_lock(copy_op_lock);
-      available_copy_ops.push_front(op);
+      release_available(copy_op_lock, available_copy_ops, op,
+                        ThreadOpCache::COPY_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_fence_op(FenceOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock f_lock(fence_op_lock);
-      available_fence_ops.push_front(op);
+      release_available(fence_op_lock, available_fence_ops, op,
+                        ThreadOpCache::FENCE_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_frame_op(FrameOp *op)
     //--------------------------------------------------------------------------
     {
+      // Frame ops are reused in the order they were freed,
+      // so they go straight to the shared pool
       AutoLock f_lock(frame_op_lock);
       available_frame_ops.push_back(op);
     }
@@ -13771,152 +14783,162 @@ namespace LegionRuntime {
     void Runtime::free_deletion_op(DeletionOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock d_lock(deletion_op_lock);
-      available_deletion_ops.push_front(op);
+      release_available(deletion_op_lock, available_deletion_ops, op,
+                        ThreadOpCache::DELETION_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_inter_close_op(InterCloseOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock i_lock(inter_close_op_lock);
-      available_inter_close_ops.push_front(op);
+      release_available(inter_close_op_lock, available_inter_close_ops, op,
+                        ThreadOpCache::INTER_CLOSE_OP_CACHE,
+                        false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_post_close_op(PostCloseOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock p_lock(post_close_op_lock);
-      available_post_close_ops.push_front(op);
+      release_available(post_close_op_lock, available_post_close_ops, op,
+                        ThreadOpCache::POST_CLOSE_OP_CACHE,
+                        false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_virtual_close_op(VirtualCloseOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock v_lock(virtual_close_op_lock);
-      available_virtual_close_ops.push_front(op);
+      release_available(virtual_close_op_lock, available_virtual_close_ops, op,
+                        ThreadOpCache::VIRTUAL_CLOSE_OP_CACHE,
+                        false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_dynamic_collective_op(DynamicCollectiveOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock dc_lock(dynamic_collective_op_lock);
-      available_dynamic_collective_ops.push_front(op);
+      release_available(dynamic_collective_op_lock,
+                        available_dynamic_collective_ops, op,
+                        ThreadOpCache::DYNAMIC_COLLECTIVE_OP_CACHE,
+                        false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_future_predicate_op(FuturePredOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock f_lock(future_pred_op_lock);
-      available_future_pred_ops.push_front(op);
+      release_available(future_pred_op_lock, available_future_pred_ops, op,
+                        ThreadOpCache::FUTURE_PRED_OP_CACHE,
+                        false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_not_predicate_op(NotPredOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock n_lock(not_pred_op_lock);
-      available_not_pred_ops.push_front(op);
+      release_available(not_pred_op_lock, available_not_pred_ops, op,
+                        ThreadOpCache::NOT_PRED_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_and_predicate_op(AndPredOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock a_lock(and_pred_op_lock);
-      available_and_pred_ops.push_front(op);
+      release_available(and_pred_op_lock, available_and_pred_ops, op,
+                        ThreadOpCache::AND_PRED_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_or_predicate_op(OrPredOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock o_lock(or_pred_op_lock);
-      available_or_pred_ops.push_front(op);
+      release_available(or_pred_op_lock, available_or_pred_ops, op,
+                        ThreadOpCache::OR_PRED_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_acquire_op(AcquireOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock a_lock(acquire_op_lock);
-      available_acquire_ops.push_front(op);
+      release_available(acquire_op_lock, available_acquire_ops, op,
+                        ThreadOpCache::ACQUIRE_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_release_op(ReleaseOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock r_lock(release_op_lock);
-      available_release_ops.push_front(op);
+      release_available(release_op_lock, available_release_ops, op,
+                        ThreadOpCache::RELEASE_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_capture_op(TraceCaptureOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock c_lock(capture_op_lock);
-      available_capture_ops.push_front(op);
+      release_available(capture_op_lock, available_capture_ops, op,
+                        ThreadOpCache::CAPTURE_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_trace_op(TraceCompleteOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock t_lock(trace_op_lock);
-      available_trace_ops.push_front(op);
+      release_available(trace_op_lock, available_trace_ops, op,
+                        ThreadOpCache::TRACE_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_epoch_op(MustEpochOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock e_lock(epoch_op_lock);
-      available_epoch_ops.push_front(op);
+      release_available(epoch_op_lock, available_epoch_ops, op,
+                        ThreadOpCache::EPOCH_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_pending_partition_op(PendingPartitionOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock p_lock(pending_partition_op_lock);
-      available_pending_partition_ops.push_front(op);
+      release_available(pending_partition_op_lock,
+                        available_pending_partition_ops, op,
+                        ThreadOpCache::PENDING_PARTITION_OP_CACHE,
+                        false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_dependent_partition_op(DependentPartitionOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock p_lock(dependent_partition_op_lock);
-      available_dependent_partition_ops.push_front(op);
+      release_available(dependent_partition_op_lock,
+                        available_dependent_partition_ops, op,
+                        ThreadOpCache::DEPENDENT_PARTITION_OP_CACHE,
+                        false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_fill_op(FillOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock f_lock(fill_op_lock);
-      available_fill_ops.push_front(op);
+      release_available(fill_op_lock, available_fill_ops, op,
+                        ThreadOpCache::FILL_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_attach_op(AttachOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock a_lock(attach_op_lock);
-      available_attach_ops.push_front(op);
+      release_available(attach_op_lock, available_attach_ops, op,
+                        ThreadOpCache::ATTACH_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
     void Runtime::free_detach_op(DetachOp *op)
     //--------------------------------------------------------------------------
     {
-      AutoLock d_lock(detach_op_lock);
-      available_detach_ops.push_front(op);
+      release_available(detach_op_lock, available_detach_ops, op,
+                        ThreadOpCache::DETACH_OP_CACHE, false/*can delete*/);
     }
 
     //--------------------------------------------------------------------------
@@ -14176,6 +15198,31 @@ namespace LegionRuntime {
       return f.impl->reset_future();
     }
 
+    //--------------------------------------------------------------------------
+    void Runtime::help_fold_futures(const std::map<DomainPoint,Future> &futures,
+                                    ReductionOpID redop, const Future &target)
+    //--------------------------------------------------------------------------
+    {
+      const ReductionOp *reduction_op = get_reduction_op(redop);
+      void *state = malloc(reduction_op->sizeof_rhs);
+      reduction_op->init(state, 1);
+      // All the futures are local and ready so fold them in point
+      // order to keep the result deterministic
+      for (std::map<DomainPoint,Future>::const_iterator it = 
+            futures.begin(); it != futures.end(); it++)
+      {
+        Future::Impl *impl = it->second.impl;
+        if (impl->empty)
+          continue;
+#ifdef DEBUG_HIGH_LEVEL
+        assert(impl->result_size == reduction_op->sizeof_rhs);
+#endif
+        reduction_op->fold(state, impl->result, 1, true/*exclusive*/);
+      }
+      target.impl->set_result(state, reduction_op->sizeof_rhs, true/*own*/);
+      target.impl->complete_future();
+    }
+
     //--------------------------------------------------------------------------
     unsigned Runtime::generate_random_integer(void)
     //--------------------------------------------------------------------------
@@ -14654,6 +15701,23 @@ namespace LegionRuntime {
                                       DEFAULT_MIN_TASKS_TO_SCHEDULE;
     /*static*/ unsigned Runtime::superscalar_width = 
                                       DEFAULT_SUPERSCALAR_WIDTH;
+    /*static*/ unsigned Runtime::max_schedule_batch = 
+                                      DEFAULT_MAX_SCHEDULE_BATCH;
+    /*static*/ unsigned Runtime::future_broadcast_radix = 
+                                      DEFAULT_FUTURE_BROADCAST_RADIX;
+    /*static*/ unsigned Runtime::must_epoch_radix = 
+                                      DEFAULT_MUST_EPOCH_RADIX;
+    /*static*/ unsigned Runtime::max_trigger_batch = 
+                                      DEFAULT_MAX_TRIGGER_BATCH;
+    /*static*/ unsigned Runtime::disjointness_sweep_chunk = 
+                                      DEFAULT_DISJOINTNESS_SWEEP_CHUNK;
+    /*static*/ unsigned Runtime::partition_chunk = DEFAULT_PARTITION_CHUNK;
+    /*static*/ unsigned Runtime::subspace_index_threshold = 
+                                      DEFAULT_SUBSPACE_INDEX_THRESHOLD;
+    /*static*/ unsigned Runtime::max_cached_inline_mappings = 
+                                      DEFAULT_INLINE_MAPPING_CACHE;
+    /*static*/ bool Runtime::scheduler_statistics = false;
+    /*static*/ bool Runtime::speculation_statistics = false;
     /*static*/ unsigned Runtime::max_message_size = 
                                       DEFAULT_MAX_MESSAGE_SIZE;
     /*static*/ unsigned Runtime::max_filter_size = 
@@ -14688,6 +15752,7 @@ namespace LegionRuntime {
     /*static*/ unsigned long long Runtime::perf_trace_tolerance = 10000; 
 #endif
     /*static*/ unsigned Runtime::num_profiling_nodes = 0;
+    /*static*/ bool Runtime::profile_perf_counters = false;
 
 #ifdef HANG_TRACE
     //--------------------------------------------------------------------------
@@ -14781,6 +15846,16 @@ namespace LegionRuntime {
         initial_task_window_hysteresis = DEFAULT_TASK_WINDOW_HYSTERESIS;
         initial_tasks_to_schedule = DEFAULT_MIN_TASKS_TO_SCHEDULE;
         superscalar_width = DEFAULT_SUPERSCALAR_WIDTH;
+        max_schedule_batch = DEFAULT_MAX_SCHEDULE_BATCH;
+        max_trigger_batch = DEFAULT_MAX_TRIGGER_BATCH;
+        future_broadcast_radix = DEFAULT_FUTURE_BROADCAST_RADIX;
+        must_epoch_radix = DEFAULT_MUST_EPOCH_RADIX;
+        disjointness_sweep_chunk = DEFAULT_DISJOINTNESS_SWEEP_CHUNK;
+        partition_chunk = DEFAULT_PARTITION_CHUNK;
+        subspace_index_threshold = DEFAULT_SUBSPACE_INDEX_THRESHOLD;
+        max_cached_inline_mappings = DEFAULT_INLINE_MAPPING_CACHE;
+        scheduler_statistics = false;
+        speculation_statistics = false;
         max_message_size = DEFAULT_MAX_MESSAGE_SIZE;
         max_filter_size = DEFAULT_MAX_FILTER_SIZE;
         gc_epoch_size = DEFAULT_GC_EPOCH_SIZE;
@@ -14788,6 +15863,7 @@ namespace LegionRuntime {
         program_order_execution = true;
 #endif
         num_profiling_nodes = 0;
+        profile_perf_counters = false;
 #ifdef DEBUG_HIGH_LEVEL
         logging_region_tree_state = false;
         verbose_logging = false;
@@ -14813,6 +15889,16 @@ namespace LegionRuntime {
           INT_ARG("-hl:hysteresis", initial_task_window_hysteresis);
           INT_ARG("-hl:sched", initial_tasks_to_schedule);
           INT_ARG("-hl:width", superscalar_width);
+          INT_ARG("-hl:sched_batch", max_schedule_batch);
+          INT_ARG("-hl:trigger_batch", max_trigger_batch);
+          BOOL_ARG("-hl:sched_stats", scheduler_statistics);
+          BOOL_ARG("-hl:spec_stats", speculation_statistics);
+          INT_ARG("-hl:future_radix", future_broadcast_radix);
+          INT_ARG("-hl:epoch_radix", must_epoch_radix);
+          INT_ARG("-hl:sweep_chunk", disjointness_sweep_chunk);
+          INT_ARG("-hl:partition_chunk", partition_chunk);
+          INT_ARG("-hl:subspace_index", subspace_index_threshold);
+          INT_ARG("-hl:inline_cache", max_cached_inline_mappings);
           INT_ARG("-hl:message",max_message_size);
           INT_ARG("-hl:filter", max_filter_size);
           INT_ARG("-hl:epoch", gc_epoch_size);
@@ -14843,6 +15929,7 @@ namespace LegionRuntime {
           INT_ARG("-hl:perf_tol", perf_trace_tolerance);
 #endif
           INT_ARG("-hl:prof", num_profiling_nodes);
+          BOOL_ARG("-hl:prof_counters", profile_perf_counters);
         }
 #undef INT_ARG
 #undef BOOL_ARG
@@ -15901,12 +16988,23 @@ namespace LegionRuntime {
             const ProcessorManager::TriggerTaskArgs *trigger_args = 
                           (const ProcessorManager::TriggerTaskArgs*)args;
             TaskOp *op = trigger_args->op; 
+            const unsigned long long ready_time = op->ready_time;
             bool mapped = op->trigger_execution();
             if (!mapped)
             {
               ProcessorManager *manager = trigger_args->manager;
               manager->add_to_ready_queue(op, true/*failure*/);
             }
+            else if (Runtime::scheduler_statistics)
+              trigger_args->manager->record_mapping_latency(ready_time);
+            break;
+          }
+        case HLR_TRIGGER_TASK_BATCH_ID:
+          {
+            const ProcessorManager::TriggerTaskBatchArgs *batch_args = 
+                          (const ProcessorManager::TriggerTaskBatchArgs*)args;
+            batch_args->manager->trigger_ready_tasks(*batch_args->ops);
+            delete batch_args->ops;
             break;
           }
         case HLR_DEFERRED_RECYCLE_ID:
@@ -15937,6 +17035,11 @@ namespace LegionRuntime {
             MustEpochMapper::handle_map_task(args);
             break;
           }
+        case HLR_MUST_CHECK_ID:
+          {
+            MustEpochDistributor::handle_check_task(args);
+            break;
+          }
         case HLR_MUST_DIST_ID:
           {
             MustEpochDistributor::handle_distribute_task(args);
@@ -15962,7 +17065,10 @@ namespace LegionRuntime {
               legion_delete(future_args->target);
             if (future_args->result->remove_base_gc_ref(DEFERRED_TASK_REF))
               legion_delete(future_args->result);
-            future_args->task_op->complete_execution();
+            if (future_args->mispredicted)
+              future_args->task_op->complete_mispredicted();
+            else
+              future_args->task_op->complete_execution();
             break;
           }
         case HLR_DEFERRED_FUTURE_MAP_SET_ID:
@@ -15984,7 +17090,10 @@ namespace LegionRuntime {
               legion_delete(future_args->future_map);
             if (future_args->result->remove_base_gc_ref(DEFERRED_TASK_REF))
               legion_delete(future_args->result);
-            future_args->task_op->complete_execution();
+            if (future_args->mispredicted)
+              future_args->task_op->complete_mispredicted();
+            else
+              future_args->task_op->complete_execution();
             break;
           }
         case HLR_RESOLVE_FUTURE_PRED_ID:
@@ -16012,6 +17121,11 @@ namespace LegionRuntime {
             Future::Impl::handle_contribute_to_collective(args);
             break;
           }
+        case HLR_REDUCE_FUTURE_MAP_ID:
+          {
+            FutureMap::Impl::handle_reduce_futures(args);
+            break;
+          }
         case HLR_STATE_ANALYSIS_ID:
           {
             Operation::StateAnalysisArgs *sargs = 
@@ -16062,6 +17176,26 @@ namespace LegionRuntime {
                 dargs->parent, dargs->left, dargs->right);
             break;
           }
+        case HLR_DISJOINTNESS_SWEEP_TASK_ID:
+          {
+            IndexPartNode::handle_disjointness_sweep(args);
+            break;
+          }
+        case HLR_DISJOINTNESS_FINALIZE_TASK_ID:
+          {
+            IndexPartNode::handle_disjointness_finalize(args);
+            break;
+          }
+        case HLR_PARTITION_COUNT_TASK_ID:
+          {
+            IndexPartNode::handle_partition_count(args);
+            break;
+          }
+        case HLR_PARTITION_FILL_TASK_ID:
+          {
+            IndexPartNode::handle_partition_fill(args);
+            break;
+          }
         case HLR_PENDING_CHILD_TASK_ID:
           {
             IndexPartNode::handle_pending_child_task(args);
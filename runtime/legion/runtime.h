@@ -181,6 +181,8 @@ namespace LegionRuntime {
     protected:
       void mark_sampled(void);
       void broadcast_result(void);
+      void forward_result(const std::vector<AddressSpaceID> &targets,
+                          unsigned start, unsigned stop);
       void send_future(AddressSpaceID sid);
       void register_waiter(AddressSpaceID sid);
     public:
@@ -227,12 +229,24 @@ namespace LegionRuntime {
       ~Impl(void);
     public:
       Impl& operator=(const FutureMap::Impl &rhs);
+    public:
+      struct ReduceFuturesArgs {
+      public:
+        HLRTaskID hlr_id;
+        FutureMap::Impl *impl;
+        Future *target;
+        ReductionOpID redop;
+      };
     public:
       Future get_future(const DomainPoint &point);
       void get_void_result(const DomainPoint &point);
       void wait_all_results(void);
       void complete_all_futures(void);
       bool reset_all_futures(void);
+    public:
+      Future reduce_futures(ReductionOpID redop);
+      void fold_futures(ReductionOpID redop, const Future &target);
+      static void handle_reduce_futures(const void *args);
 #ifdef DEBUG_HIGH_LEVEL
     public:
       void add_valid_domain(const Domain &d);
@@ -439,6 +453,33 @@ namespace LegionRuntime {
         TaskOp *op;
         ProcessorManager *manager;
       };
+      struct TriggerTaskBatchArgs {
+      public:
+        HLRTaskID hlr_id;
+        std::vector<TaskOp*> *ops;
+        ProcessorManager *manager;
+      };
+      struct SchedulerStatistics {
+      public:
+        SchedulerStatistics(void)
+          : queue_depth(0), max_queue_depth(0), scheduler_passes(0),
+            tasks_enqueued(0), tasks_scheduled(0), trigger_tasks(0),
+            batched_tasks(0), mapped_tasks(0), total_mapping_latency(0),
+            max_mapping_latency(0) { }
+      public:
+        unsigned queue_depth;
+        unsigned max_queue_depth;
+        unsigned long long scheduler_passes;
+        unsigned long long tasks_enqueued;
+        unsigned long long tasks_scheduled;
+        unsigned long long trigger_tasks;
+        unsigned long long batched_tasks;
+        // Latency in microseconds from entering the ready
+        // queue to completing the mapping of the task
+        unsigned long long mapped_tasks;
+        unsigned long long total_mapping_latency;
+        unsigned long long max_mapping_latency;
+      };
       struct MapperMessage {
       public:
         MapperMessage(void)
@@ -543,9 +584,13 @@ namespace LegionRuntime {
     public:
       void add_to_ready_queue(TaskOp *op, bool previous_failure);
       void add_to_local_ready_queue(Operation *op, bool previous_failure);
+      void trigger_ready_tasks(const std::vector<TaskOp*> &ops);
     public:
       // Mapper introspection methods
       unsigned sample_unmapped_tasks(MapperID map_id);
+    public:
+      void get_scheduler_statistics(SchedulerStatistics &stats);
+      void record_mapping_latency(unsigned long long ready_time);
 #ifdef HANG_TRACE
     public:
       void dump_state(FILE *target);
@@ -553,6 +598,16 @@ namespace LegionRuntime {
     protected:
       void perform_mapping_operations(void);
       void issue_advertisements(MapperID mid);
+      void issue_trigger_tasks(std::vector<TaskOp*> &ops);
+      // Must be called while holding the queue lock
+      void drain_incoming_tasks(void);
+      // Returns true if the caller has to launch the scheduler
+      bool arm_task_scheduler(void);
+      inline bool has_incoming_tasks(void) const
+      {
+        TaskOp *head = incoming_tasks;
+        return ((head != NULL) && (head != SCHEDULER_IDLE));
+      }
     protected:
       void increment_active_contexts(void);
       void decrement_active_contexts(void);
@@ -575,7 +630,6 @@ namespace LegionRuntime {
     protected:
       // Scheduling state
       Reservation queue_lock;
-      bool task_scheduler_enabled;
       bool pending_shutdown;
       unsigned total_active_contexts;
       struct ContextState {
@@ -593,6 +647,19 @@ namespace LegionRuntime {
       Reservation message_lock;
       // For each mapper, a list of tasks that are ready to map
       std::vector<std::list<TaskOp*> > ready_queues;
+      // Tasks added to the ready queue are pushed onto this lock-free
+      // stack without taking the queue lock and moved over to the
+      // ready queues by the scheduler.  The stack holds SCHEDULER_IDLE
+      // while no scheduler is running, the producer that pushes onto
+      // it then launches one.  The scheduler only goes idle by
+      // swapping that marker in for an empty stack.
+      static TaskOp *const SCHEDULER_IDLE;
+      TaskOp *volatile incoming_tasks;
+      // Pushes not yet moved over, only kept for the statistics
+      volatile int pending_incoming;
+      // Scheduler statistics, updated with atomics except for the
+      // queue depths which are recorded by drain_incoming_tasks
+      SchedulerStatistics statistics;
       // Mapper objects
       std::vector<Mapper*> mapper_objects;
       // Mapper locks
@@ -831,8 +898,94 @@ namespace LegionRuntime {
       virtual void execute(void) = 0;
     public:
       static void handle_continuation(const void *args);
-    }; 
- 
+    };
+
+    /**
+     * \class ThreadOpCache
+     * A per-thread cache (a magazine) of recycled operation objects
+     * that sits in front of the runtime's shared pools.  Getting or
+     * freeing an operation only touches the calling thread's magazine,
+     * so it never takes a reservation or needs a continuation.  Objects
+     * move between a magazine and the shared pools in batches of
+     * TRANSFER_SIZE.  Each thread caches for the first runtime that it
+     * recycles operations for and goes straight to the shared pools
+     * of any other runtime.  When a thread exits its magazines are
+     * flushed back to the shared pools and its cache is deleted.
+     */
+    class ThreadOpCache {
+    public:
+      enum Kind {
+        INDIVIDUAL_TASK_CACHE,
+        POINT_TASK_CACHE,
+        INDEX_TASK_CACHE,
+        SLICE_TASK_CACHE,
+        REMOTE_TASK_CACHE,
+        INLINE_TASK_CACHE,
+        MAP_OP_CACHE,
+        COPY_OP_CACHE,
+        FENCE_OP_CACHE,
+        DELETION_OP_CACHE,
+        INTER_CLOSE_OP_CACHE,
+        POST_CLOSE_OP_CACHE,
+        VIRTUAL_CLOSE_OP_CACHE,
+        DYNAMIC_COLLECTIVE_OP_CACHE,
+        FUTURE_PRED_OP_CACHE,
+        NOT_PRED_OP_CACHE,
+        AND_PRED_OP_CACHE,
+        OR_PRED_OP_CACHE,
+        ACQUIRE_OP_CACHE,
+        RELEASE_OP_CACHE,
+        CAPTURE_OP_CACHE,
+        TRACE_OP_CACHE,
+        EPOCH_OP_CACHE,
+        PENDING_PARTITION_OP_CACHE,
+        DEPENDENT_PARTITION_OP_CACHE,
+        FILL_OP_CACHE,
+        ATTACH_OP_CACHE,
+        DETACH_OP_CACHE,
+        NUM_CACHE_KINDS
+      };
+      static const unsigned MAGAZINE_SIZE = 32;
+      static const unsigned TRANSFER_SIZE = 16;
+      // Objects that a continuation takes from a shared pool on behalf
+      // of the thread waiting for it, see GetAvailableContinuation
+      struct Batch {
+      public:
+        Batch(void) : kind(NUM_CACHE_KINDS), count(0) { }
+      public:
+        Kind kind;
+        unsigned count;
+        void *objects[TRANSFER_SIZE];
+      };
+    public:
+      ThreadOpCache(Runtime *owner);
+    public:
+      // Find the calling thread's cache for a runtime, making one
+      // the first time, or NULL if the thread caches for another one
+      static ThreadOpCache* find_local(Runtime *rt);
+      static const char* get_kind_name(Kind kind);
+    public:
+      // While set, refills from the shared pools go into this batch
+      // instead of the calling thread's magazine
+      static __thread Batch *refill_batch;
+    public:
+      Runtime *owner;
+      unsigned counts[NUM_CACHE_KINDS];
+      void *objects[NUM_CACHE_KINDS][MAGAZINE_SIZE];
+    public:
+      // Pool statistics, only ever updated by the owning thread
+      unsigned long long hits[NUM_CACHE_KINDS];
+      unsigned long long refills[NUM_CACHE_KINDS];
+      unsigned long long spills[NUM_CACHE_KINDS];
+      unsigned long long allocations[NUM_CACHE_KINDS];
+    protected:
+      // Destructor of the thread-specific key for a thread's cache
+      static void release_local(void *cache);
+      static void create_local_key(void);
+    protected:
+      static __thread ThreadOpCache *local_cache;
+    };
+
     /**
      * \class Runtime
      * This is the actual implementation of the Legion runtime functionality
@@ -854,6 +1007,7 @@ namespace LegionRuntime {
         Future::Impl *target;
         Future::Impl *result;
         TaskOp *task_op;
+        bool mispredicted;
       };
       struct DeferredFutureMapSetArgs {
         HLRTaskID hlr_id;
@@ -861,6 +1015,7 @@ namespace LegionRuntime {
         Future::Impl *result;
         Domain domain;
         TaskOp *task_op;
+        bool mispredicted;
       };
       struct MPIRankArgs {
         HLRTaskID hlr_id;
@@ -1172,6 +1327,8 @@ namespace LegionRuntime {
       FutureMap execute_index_space(Context ctx, const IndexLauncher &launcher);
       Future execute_index_space(Context ctx, const IndexLauncher &launcher,
                                  ReductionOpID redop);
+      Future reduce_future_map(Context ctx, const FutureMap &future_map,
+                               ReductionOpID redop);
       Future execute_task(Context ctx, 
                           Processor::TaskFuncID task_id,
                           const std::vector<IndexSpaceRequirement> &indexes,
@@ -1356,6 +1513,13 @@ namespace LegionRuntime {
       size_t sample_free_space(Memory mem);
       unsigned sample_allocated_instances(Memory mem);
       unsigned sample_unmapped_tasks(Processor proc, Mapper *mapper);
+      void sample_speculation_statistics(SpeculationStatistics &stats) const;
+    public:
+      // Speculation on predicates
+      void record_speculation_started(void);
+      void record_speculation_resolved(bool hit);
+      void record_speculation_waste(unsigned tasks, unsigned copies,
+                                    long long time_in_us);
     public:
       // Messaging functions
       MessageManager* find_messenger(AddressSpaceID sid);
@@ -1713,6 +1877,28 @@ namespace LegionRuntime {
       template<typename T>
       inline T* get_available(Reservation reservation,
                               std::deque<T*> &queue, bool has_lock);
+      template<typename T>
+      inline T* get_available(Reservation reservation, std::deque<T*> &queue,
+                              bool has_lock, ThreadOpCache::Kind kind);
+      template<typename T>
+      inline T* get_cached(ThreadOpCache::Kind kind);
+      template<typename T>
+      inline void release_available(Reservation reservation,
+                                    std::deque<T*> &queue, T *op,
+                                    ThreadOpCache::Kind kind, bool can_delete);
+      template<typename T>
+      inline void reclaim_cached(std::deque<T*> &queue,
+                                 ThreadOpCache::Kind kind);
+      void register_thread_cache(ThreadOpCache *cache);
+      void release_thread_cache(ThreadOpCache *cache);
+      void accept_cache_batch(ThreadOpCache::Batch &batch);
+      void return_cached(ThreadOpCache::Kind kind, 
+                         void *const *objects, unsigned count);
+      template<typename T>
+      inline void return_cached(Reservation reservation, std::deque<T*> &queue,
+                                void *const *objects, unsigned count,
+                                bool can_delete = false);
+      void report_thread_cache_statistics(void);
     public:
       IndividualTask*       get_available_individual_task(bool need_cont,
                                                   bool has_lock = false);
@@ -1826,6 +2012,8 @@ namespace LegionRuntime {
       Future help_create_future(Operation *op = NULL);
       void help_complete_future(const Future &f);
       bool help_reset_future(const Future &f);
+      void help_fold_futures(const std::map<DomainPoint,Future> &futures,
+                             ReductionOpID redop, const Future &target);
     public:
       unsigned generate_random_integer(void);
 #ifdef TRACE_ALLOCATION
@@ -1917,6 +2105,14 @@ namespace LegionRuntime {
       unsigned unique_region_tree_id;
       unsigned unique_operation_id;
       unsigned unique_field_id; 
+    protected:
+      // Speculation counters, updated with atomics
+      unsigned long long speculated_operations;
+      unsigned long long speculation_hits;
+      unsigned long long speculation_misses;
+      unsigned long long wasted_speculative_tasks;
+      unsigned long long wasted_speculative_copies;
+      unsigned long long wasted_speculative_time;
     protected:
       std::map<ProjectionID,ProjectionFunctor*> projection_functors;
     protected:
@@ -2038,6 +2234,14 @@ namespace LegionRuntime {
       std::deque<FillOp*>               available_fill_ops;
       std::deque<AttachOp*>             available_attach_ops;
       std::deque<DetachOp*>             available_detach_ops;
+    protected:
+      // All the thread caches that hold objects from our pools,
+      // the lock is a pthread lock since caches register from
+      // whatever thread first recycles an operation
+      ImmovableLock thread_cache_lock;
+      std::vector<ThreadOpCache*> thread_caches;
+      // Statistics of the caches of threads that have exited
+      ThreadOpCache retired_cache_stats;
 #if defined(DEBUG_HIGH_LEVEL) || defined(HANG_TRACE)
       TreeStateLogger *tree_state_logger;
       // For debugging purposes keep track of
@@ -2132,6 +2336,16 @@ namespace LegionRuntime {
       static unsigned initial_task_window_hysteresis;
       static unsigned initial_tasks_to_schedule;
       static unsigned superscalar_width;
+      static unsigned max_schedule_batch;
+      static unsigned future_broadcast_radix;
+      static unsigned must_epoch_radix;
+      static unsigned max_trigger_batch;
+      static unsigned disjointness_sweep_chunk;
+      static unsigned partition_chunk;
+      static unsigned subspace_index_threshold;
+      static unsigned max_cached_inline_mappings;
+      static bool scheduler_statistics;
+      static bool speculation_statistics;
       static unsigned max_message_size;
       static unsigned max_filter_size;
       static unsigned gc_epoch_size;
@@ -2165,6 +2379,7 @@ namespace LegionRuntime {
 #endif
     public:
       static unsigned num_profiling_nodes;
+      static bool profile_perf_counters;
     };
 
     /**
@@ -2193,13 +2408,19 @@ namespace LegionRuntime {
         // to avoid waiting for a reservation in an application task
         Event done_event = defer(runtime, acquire_event);
         done_event.wait();
+        // The continuation ran on another thread so it passed back
+        // the objects it took for our magazine instead of keeping them
+        if (batch.kind != ThreadOpCache::NUM_CACHE_KINDS)
+          runtime->accept_cache_batch(batch);
         return result;
       }
       virtual void execute(void)
       {
         // If we got here we know we have the reservation
+        ThreadOpCache::refill_batch = &batch;
         result = (runtime->*FUNC_PTR)(false/*do continuation*/,
                                       true/*has lock*/); 
+        ThreadOpCache::refill_batch = NULL;
         // Now release the reservation 
         reservation.release();
       }
@@ -2207,6 +2428,7 @@ namespace LegionRuntime {
       Runtime *const runtime;
       Reservation reservation;
       T result;
+      ThreadOpCache::Batch batch;
     };
 
     /**
@@ -2536,6 +2758,174 @@ namespace LegionRuntime {
       return result;
     }
 
+    //--------------------------------------------------------------------------
+    template<typename T>
+    inline T* Runtime::get_available(Reservation reservation,
+                                     std::deque<T*> &queue, bool has_lock,
+                                     ThreadOpCache::Kind kind)
+    //--------------------------------------------------------------------------
+    {
+      T *result = NULL;
+      if (!has_lock)
+      {
+        Event lock_event = reservation.acquire();
+        if (lock_event.exists())
+          lock_event.wait();
+      }
+      if (!queue.empty())
+      {
+        result = queue.front();
+        queue.pop_front();
+        // Refill this thread's magazine while we hold the lock, but
+        // only look for the cache now since we might have waited
+        ThreadOpCache::Batch *batch = ThreadOpCache::refill_batch;
+        ThreadOpCache *cache = 
+          (batch == NULL) ? ThreadOpCache::find_local(this) : NULL;
+        if (batch != NULL)
+        {
+          // We're a continuation so the refill is for the waiting thread
+          batch->kind = kind;
+          while ((batch->count < ThreadOpCache::TRANSFER_SIZE) &&
+                 !queue.empty())
+          {
+            batch->objects[batch->count++] = queue.front();
+            queue.pop_front();
+          }
+        }
+        else if (cache != NULL)
+        {
+          unsigned &count = cache->counts[kind];
+          for (unsigned idx = 0; (idx < ThreadOpCache::TRANSFER_SIZE) &&
+                (count < ThreadOpCache::MAGAZINE_SIZE) &&
+                !queue.empty(); idx++)
+          {
+            cache->objects[kind][count++] = queue.front();
+            queue.pop_front();
+          }
+          cache->refills[kind]++;
+        }
+      }
+      if (!has_lock)
+        reservation.release();
+      // Couldn't find one so make one
+      if (result == NULL)
+      {
+        result = legion_new<T>(this);
+        ThreadOpCache *cache = ThreadOpCache::find_local(this);
+        if (cache != NULL)
+          cache->allocations[kind]++;
+      }
+#ifdef DEBUG_HIGH_LEVEL
+      assert(result != NULL);
+#endif
+      result->activate();
+      return result;
+    }
+
+    //--------------------------------------------------------------------------
+    template<typename T>
+    inline T* Runtime::get_cached(ThreadOpCache::Kind kind)
+    //--------------------------------------------------------------------------
+    {
+      ThreadOpCache *cache = ThreadOpCache::find_local(this);
+      if ((cache == NULL) || (cache->counts[kind] == 0))
+        return NULL;
+      T *result = static_cast<T*>(cache->objects[kind][--cache->counts[kind]]);
+      cache->hits[kind]++;
+      result->activate();
+      return result;
+    }
+
+    //--------------------------------------------------------------------------
+    template<typename T>
+    inline void Runtime::release_available(Reservation reservation,
+                                           std::deque<T*> &queue, T *op,
+                                           ThreadOpCache::Kind kind,
+                                           bool can_delete)
+    //--------------------------------------------------------------------------
+    {
+      ThreadOpCache *cache = ThreadOpCache::find_local(this);
+      if ((cache != NULL) &&
+          (cache->counts[kind] < ThreadOpCache::MAGAZINE_SIZE))
+      {
+        cache->objects[kind][cache->counts[kind]++] = op;
+        return;
+      }
+      AutoLock r_lock(reservation);
+      // Look again in case we waited for the lock
+      cache = ThreadOpCache::find_local(this);
+      if (cache != NULL)
+      {
+        unsigned &count = cache->counts[kind];
+        if (count == ThreadOpCache::MAGAZINE_SIZE)
+        {
+          // Magazine is full, send its oldest objects back to the
+          // shared pool and keep the recently used ones here
+          void **objects = cache->objects[kind];
+          for (unsigned idx = 0; idx < ThreadOpCache::TRANSFER_SIZE; idx++)
+          {
+            T *spill = static_cast<T*>(objects[idx]);
+            // Some objects are never registered in the logical state
+            // of the region tree so they can be deleted if we have
+            // plenty of them already
+            if (can_delete &&
+                (queue.size() >= LEGION_MAX_RECYCLABLE_OBJECTS))
+              legion_delete(spill);
+            else
+              queue.push_front(spill);
+          }
+          for (unsigned idx = ThreadOpCache::TRANSFER_SIZE;
+                idx < count; idx++)
+            objects[idx - ThreadOpCache::TRANSFER_SIZE] = objects[idx];
+          count -= ThreadOpCache::TRANSFER_SIZE;
+          cache->spills[kind]++;
+        }
+        cache->objects[kind][count++] = op;
+      }
+      else if (can_delete && (queue.size() >= LEGION_MAX_RECYCLABLE_OBJECTS))
+        legion_delete(op);
+      else
+        queue.push_front(op);
+    }
+
+    //--------------------------------------------------------------------------
+    template<typename T>
+    inline void Runtime::return_cached(Reservation reservation,
+                                       std::deque<T*> &queue,
+                                       void *const *objects, unsigned count,
+                                       bool can_delete)
+    //--------------------------------------------------------------------------
+    {
+      AutoLock r_lock(reservation);
+      for (unsigned idx = 0; idx < count; idx++)
+      {
+        T *op = static_cast<T*>(objects[idx]);
+        // Same cap as release_available for objects we can delete
+        if (can_delete && (queue.size() >= LEGION_MAX_RECYCLABLE_OBJECTS))
+          legion_delete(op);
+        else
+          queue.push_front(op);
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    template<typename T>
+    inline void Runtime::reclaim_cached(std::deque<T*> &queue,
+                                        ThreadOpCache::Kind kind)
+    //--------------------------------------------------------------------------
+    {
+      // Only called while shutting down, after all operations are done
+      AutoLock c_lock(thread_cache_lock);
+      for (std::vector<ThreadOpCache*>::const_iterator it =
+            thread_caches.begin(); it != thread_caches.end(); it++)
+      {
+        ThreadOpCache *cache = *it;
+        for (unsigned idx = 0; idx < cache->counts[kind]; idx++)
+          queue.push_back(static_cast<T*>(cache->objects[kind][idx]));
+        cache->counts[kind] = 0;
+      }
+    }
+
   }; // namespace HighLevel
 }; // namespace LegionRuntime
 
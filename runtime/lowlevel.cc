@@ -1237,6 +1237,71 @@ namespace LegionRuntime {
   namespace Accessor {
     using namespace LegionRuntime::LowLevel;
 
+    void AccessorType::Generic::Untyped::find_dense_layout(void)
+    {
+      dense_base = 0;
+
+      RegionInstanceImpl *impl = (RegionInstanceImpl *) internal;
+      if(!impl) return;
+
+      // don't block on the metadata - if it isn't here yet, accesses just
+      //  take the slow path
+      if(!impl->metadata.is_valid()) return;
+      const RegionInstanceImpl::Metadata& md = impl->metadata;
+
+      // reduction lists aren't indexed by element
+      if(md.red_list_size > 0) return;
+
+      // only CPU-visible memory can be addressed directly
+      MemoryImpl *mem = get_runtime()->get_memory_impl(impl->memory);
+      if((mem->kind != MemoryImpl::MKIND_SYSMEM) &&
+	 (mem->kind != MemoryImpl::MKIND_RDMA) &&
+	 (mem->kind != MemoryImpl::MKIND_ZEROCOPY))
+	return;
+
+      // element pointers must map onto instance indices by a translation
+      if(md.linearization.get_dim() != 1) return;
+      Arrays::Mapping<1, 1> *mapping = md.linearization.get_mapping<1>();
+      int index0 = mapping->image(0);
+      int index1 = mapping->image(1);
+      if(index1 != (index0 + 1)) return;
+
+      if((md.elmt_size == 0) || (field_offset < 0) || (field_offset >= (off_t)md.elmt_size))
+	return;
+      size_t num_elmts = md.size / md.elmt_size;
+
+      off_t offset = md.alloc_offset;
+      if(md.block_size <= 1) {
+	// AOS - the element is contiguous, so accesses may span fields
+	offset += field_offset;
+	dense_stride = md.elmt_size;
+	dense_block_size = 0;
+	dense_block_stride = 0;
+	dense_field_bytes = md.elmt_size - field_offset;
+      } else {
+	off_t field_start;
+	int field_size;
+	Realm::find_field_start(md.field_sizes, field_offset, 1, field_start, field_size);
+	offset += (field_start * md.block_size) + (field_offset - field_start);
+	dense_stride = field_size;
+	// a single block is plain SOA
+	if(md.block_size >= num_elmts) {
+	  dense_block_size = 0;
+	  dense_block_stride = 0;
+	} else {
+	  dense_block_size = md.block_size;
+	  dense_block_stride = md.block_size * md.elmt_size;
+	}
+	dense_field_bytes = field_start + field_size - field_offset;
+      }
+
+      char *base = (char *)(mem->get_direct_ptr(offset, md.size - (offset - md.alloc_offset)));
+      if(!base) return;
+
+      dense_index_offset = index0;
+      dense_base = base;
+    }
+
     void AccessorType::Generic::Untyped::read_untyped(ptr_t ptr, void *dst, size_t bytes, off_t offset) const
     {
       RegionInstanceImpl *impl = (RegionInstanceImpl *) internal;
@@ -1250,6 +1315,11 @@ namespace LegionRuntime {
 #ifdef BOUNDS_CHECKS
       check_bounds(region, ptr);
 #endif
+      const char *elem = dense_elem_ptr(ptr, bytes, offset);
+      if(elem) {
+	memcpy(dst, elem, bytes);
+	return;
+      }
 #ifdef USE_HDF
       // HDF memory doesn't support 
       assert(impl->memory.kind() != Memory::HDF_MEM);
@@ -1317,6 +1387,11 @@ namespace LegionRuntime {
 #ifdef BOUNDS_CHECKS
       check_bounds(region, ptr);
 #endif
+      char *elem = dense_elem_ptr(ptr, bytes, offset);
+      if(elem) {
+	memcpy(elem, src, bytes);
+	return;
+      }
 #ifdef USE_HDF
      // HDF memory doesn't support enumerate type
      assert(impl->memory.kind() != Memory::HDF_MEM);
@@ -1495,15 +1570,31 @@ namespace LegionRuntime {
       // must have valid data by now - block if we have to
       impl->metadata.await_data();
 
+#ifdef BOUNDS_CHECKS
+      check_bounds(region, ptr);
+#endif
+
+      // with a direct layout, the span runs to the end of the instance (or
+      //  of the block, for hybrid SOA)
+      Untyped dense(*this);
+      if(!dense.dense_base)
+	dense.find_dense_layout();
+      char *dense_ptr = dense.dense_elem_ptr(ptr, 0);
+      if(dense_ptr) {
+	off_t index = ptr.value + dense.dense_index_offset;
+	stride.offset = dense.dense_stride;
+	if(dense.dense_block_size == 0)
+	  act_count = (impl->metadata.size / impl->metadata.elmt_size) - index;
+	else
+	  act_count = dense.dense_block_size - (index % dense.dense_block_size);
+	return dense_ptr;
+      }
+
       void *base;
       size_t act_stride = 0;
       bool ok = impl->get_strided_parameters(base, act_stride, field_offset);
       assert(ok);
 
-#ifdef BOUNDS_CHECKS
-      check_bounds(region, ptr);
-#endif
-
       Arrays::Mapping<1, 1> *mapping = impl->metadata.linearization.get_mapping<1>();
       int index = mapping->image(ptr.value);
 
@@ -41,6 +41,7 @@ using namespace LegionRuntime::HighLevel::LegionLogging;
 
 #include "realm/timers.h"
 #include "realm/serialize.h"
+#include "realm/event_tracer.h"
 
 using namespace Realm::Serialization;
 
@@ -162,10 +163,22 @@ namespace LegionRuntime {
 
       virtual bool handler_safe(void) { return(false); }
 
+      size_t compute_copy_bytes(void) const;
+
+    protected:
+      // a copy is finished (for the CopyCostModel) once the async work its
+      //  channel started (e.g. remote writes, GPU copies) is done too
+      virtual void mark_completed(void);
+
+    public:
       Domain domain;
       OASByInst *oas_by_inst;
       Event before_copy;
       Waiter waiter; // if we need to wait on events
+      size_t copy_bytes; // counted in the CopyCostModel once queued
+      Memory src_mem, dst_mem;
+      MemPairCopierFactory *channel; // 0 if no DMA channel was used
+      long long start_time;
     };
 
     class ReduceRequest : public DmaRequest {
@@ -352,7 +365,7 @@ namespace LegionRuntime {
 			     int _priority)
       : DmaRequest(_priority, _after_copy),
 	oas_by_inst(0),
-	before_copy(_before_copy)
+	before_copy(_before_copy), copy_bytes(0), channel(0), start_time(0)
     {
       const IDType *idata = (const IDType *)data;
 
@@ -425,7 +438,7 @@ namespace LegionRuntime {
                              const Realm::ProfilingRequestSet &reqs)
       : DmaRequest(_priority, _after_copy, reqs),
 	domain(_domain), oas_by_inst(_oas_by_inst),
-	before_copy(_before_copy)
+	before_copy(_before_copy), copy_bytes(0), channel(0), start_time(0)
     {
       log_dma.info("dma request %p created - " IDFMT "[%zd]->" IDFMT "[%zd]:%d (+%zd) (" IDFMT ") " IDFMT "/%d " IDFMT "/%d",
 		   this,
@@ -449,6 +462,25 @@ namespace LegionRuntime {
       delete oas_by_inst;
     }
 
+    void CopyRequest::mark_completed(void)
+    {
+      // only copies that were queued were counted
+      if(start_time != 0)
+	copy_cost_model.copy_finished(src_mem, dst_mem, channel, copy_bytes,
+				      Realm::Clock::current_time_in_nanoseconds() - start_time);
+
+      DmaRequest::mark_completed();
+    }
+
+    size_t CopyRequest::compute_copy_bytes(void) const
+    {
+      size_t elmt_bytes = 0;
+      for(OASByInst::const_iterator it = oas_by_inst->begin(); it != oas_by_inst->end(); it++)
+	for(OASVec::const_iterator it2 = it->second.begin(); it2 != it->second.end(); it2++)
+	  elmt_bytes += it2->size;
+      return elmt_bytes * domain.get_volume();
+    }
+
     size_t CopyRequest::compute_size(void) const
     {
       size_t result = domain.compute_size();
@@ -636,6 +668,12 @@ namespace LegionRuntime {
 	log_timing_event(Processor::NO_PROC, after_copy, COPY_READY);
 #endif
 
+	// the copy counts against its memory pair until it is complete
+	copy_bytes = compute_copy_bytes();
+	src_mem = get_runtime()->get_instance_impl(oas_by_inst->begin()->first.first)->memory;
+	dst_mem = get_runtime()->get_instance_impl(oas_by_inst->begin()->first.second)->memory;
+	copy_cost_model.copy_queued(src_mem, dst_mem, copy_bytes);
+
 	// once we're enqueued, we may be deleted at any time, so no more
 	//  references
 	rq->enqueue_request(this);
@@ -1131,6 +1169,146 @@ namespace LegionRuntime {
       return name;
     }
 
+    double MemPairCopierFactory::estimate_copy_time(Memory src_mem, Memory dst_mem,
+						    size_t bytes)
+    {
+      return copy_cost_model.estimate_copy_time(src_mem, dst_mem, bytes, this);
+    }
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class CopyCostModel
+  //
+
+    CopyCostModel copy_cost_model;
+
+    // each completed copy's weight in the observed bandwidth decays by this
+    //  much per later copy, so the estimate follows changes in load
+    static const double OBSERVED_DECAY = 0.875;
+
+    CopyCostModel::Observed::Observed(void)
+      : bytes(0), ns(0)
+    {
+    }
+
+    void CopyCostModel::Observed::add(size_t _bytes, long long _ns)
+    {
+      bytes = (bytes * OBSERVED_DECAY) + _bytes;
+      ns = (ns * OBSERVED_DECAY) + _ns;
+    }
+
+    double CopyCostModel::Observed::bandwidth(void) const
+    {
+      return ((ns > 0) ? (bytes / ns) : 0);
+    }
+
+    CopyCostModel::PairCost::PairCost(void)
+      : prior_valid(false), prior_bandwidth(0), prior_latency(0),
+	queued_bytes(0), queued_copies(0)
+    {
+    }
+
+    CopyCostModel::ChannelCost::ChannelCost(void)
+      : queued_bytes(0), queued_copies(0)
+    {
+    }
+
+    // caller must hold the mutex
+    CopyCostModel::PairCost& CopyCostModel::lookup(Memory src_mem, Memory dst_mem)
+    {
+      PairCost& pc = costs[std::make_pair(src_mem, dst_mem)];
+      if(!pc.prior_valid) {
+	// affinities are directional, but a copy can use either one
+	std::vector<Machine::MemoryMemoryAffinity> mmas;
+	Machine machine = Machine::get_machine();
+	if(machine.get_mem_mem_affinity(mmas, src_mem, dst_mem) == 0)
+	  machine.get_mem_mem_affinity(mmas, dst_mem, src_mem);
+	if(!mmas.empty()) {
+	  // the affinities are relative numbers - read them as bandwidth in
+	  //  units of 100MB/s and latency in microseconds, which puts a local
+	  //  memcpy (bandwidth 100) at about 10GB/s
+	  pc.prior_bandwidth = mmas[0].bandwidth * 0.1;
+	  pc.prior_latency = mmas[0].latency * 1000.0;
+	}
+	pc.prior_valid = true;
+      }
+      return pc;
+    }
+
+    void CopyCostModel::copy_queued(Memory src_mem, Memory dst_mem, size_t bytes)
+    {
+      AutoHSLLock al(mutex);
+      PairCost& pc = lookup(src_mem, dst_mem);
+      pc.queued_bytes += bytes;
+      pc.queued_copies++;
+    }
+
+    void CopyCostModel::copy_started(const MemPairCopierFactory *channel, size_t bytes)
+    {
+      AutoHSLLock al(mutex);
+      ChannelCost& cc = channel_costs[channel];
+      cc.queued_bytes += bytes;
+      cc.queued_copies++;
+    }
+
+    void CopyCostModel::copy_finished(Memory src_mem, Memory dst_mem,
+				      const MemPairCopierFactory *channel,
+				      size_t bytes, long long elapsed_ns)
+    {
+      AutoHSLLock al(mutex);
+      PairCost& pc = lookup(src_mem, dst_mem);
+      assert((pc.queued_copies > 0) && (pc.queued_bytes >= bytes));
+      pc.queued_bytes -= bytes;
+      pc.queued_copies--;
+      if((bytes > 0) && (elapsed_ns > 0))
+	pc.observed.add(bytes, elapsed_ns);
+
+      if(channel) {
+	ChannelCost& cc = channel_costs[channel];
+	assert((cc.queued_copies > 0) && (cc.queued_bytes >= bytes));
+	cc.queued_bytes -= bytes;
+	cc.queued_copies--;
+	if((bytes > 0) && (elapsed_ns > 0))
+	  cc.observed[std::make_pair(src_mem, dst_mem)].add(bytes, elapsed_ns);
+      }
+    }
+
+    double CopyCostModel::estimate_copy_time(Memory src_mem, Memory dst_mem, size_t bytes,
+					     const MemPairCopierFactory *channel /*= 0*/)
+    {
+      AutoHSLLock al(mutex);
+      PairCost& pc = lookup(src_mem, dst_mem);
+
+      // for a particular channel, the backlog is what that channel already
+      //  has in flight (for any pair), at the rate it has achieved for this
+      //  pair - copies still waiting in the DMA queue delay every channel
+      //  equally, so they don't matter when choosing between channels
+      size_t backlog_bytes = pc.queued_bytes;
+      int backlog_copies = pc.queued_copies;
+      const Observed *obs = &pc.observed;
+      if(channel) {
+	ChannelCost& cc = channel_costs[channel];
+	backlog_bytes = cc.queued_bytes;
+	backlog_copies = cc.queued_copies;
+	std::map<std::pair<Memory, Memory>, Observed>::const_iterator it =
+	  cc.observed.find(std::make_pair(src_mem, dst_mem));
+	if(it != cc.observed.end())
+	  obs = &(it->second);
+      }
+
+      // observed bandwidth includes per-copy overheads, so it replaces both
+      //  of the static numbers once there is any
+      double bandwidth = obs->bandwidth();
+      if(bandwidth > 0)
+	return (backlog_bytes + bytes) / bandwidth;
+
+      if(pc.prior_bandwidth <= 0)
+	return -1;
+      return (((backlog_copies + 1) * pc.prior_latency) +
+	      ((backlog_bytes + bytes) / pc.prior_bandwidth));
+    }
+
 
     class BufferedMemPairCopier : public MemPairCopier {
     public:
@@ -1886,25 +2064,40 @@ namespace LegionRuntime {
 
     MemPairCopier *MemPairCopier::create_copier(Memory src_mem, Memory dst_mem,
 						ReductionOpID redop_id /*= 0*/,
-						bool fold /*= false*/)
+						bool fold /*= false*/,
+						size_t bytes /*= 0*/,
+						MemPairCopierFactory **channel /*= 0*/)
     {
-      // try to use new DMA channels first
+      // try to use new DMA channels first, picking the capable channel that
+      //  expects to finish soonest (ties go to the earliest registered)
       const std::vector<MemPairCopierFactory *>& channels = get_runtime()->get_dma_channels();
+      MemPairCopierFactory *best = 0;
+      double best_time = 0;
       for(std::vector<MemPairCopierFactory *>::const_iterator it = channels.begin();
 	  it != channels.end();
 	  it++) {
-	if((*it)->can_perform_copy(src_mem, dst_mem, redop_id, fold)) {
-	  // impls and kinds are just for logging now
-	  MemoryImpl *src_impl = get_runtime()->get_memory_impl(src_mem);
-	  MemoryImpl *dst_impl = get_runtime()->get_memory_impl(dst_mem);
+	if(!(*it)->can_perform_copy(src_mem, dst_mem, redop_id, fold))
+	  continue;
+	double t = (*it)->estimate_copy_time(src_mem, dst_mem, bytes);
+	if(!best || ((t >= 0) && ((best_time < 0) || (t < best_time)))) {
+	  best = *it;
+	  best_time = t;
+	}
+      }
+      if(best) {
+	// impls and kinds are just for logging now
+	MemoryImpl *src_impl = get_runtime()->get_memory_impl(src_mem);
+	MemoryImpl *dst_impl = get_runtime()->get_memory_impl(dst_mem);
 
-	  MemoryImpl::MemoryKind src_kind = src_impl->kind;
-	  MemoryImpl::MemoryKind dst_kind = dst_impl->kind;
+	MemoryImpl::MemoryKind src_kind = src_impl->kind;
+	MemoryImpl::MemoryKind dst_kind = dst_impl->kind;
 
-	  log_dma.info("copier: " IDFMT "(%d) -> " IDFMT "(%d) = %s",
-		       src_mem.id, src_kind, dst_mem.id, dst_kind, (*it)->get_name().c_str());
-	  return (*it)->create_copier(src_mem, dst_mem, redop_id, fold);
-	}
+	log_dma.info("copier: " IDFMT "(%d) -> " IDFMT "(%d) = %s (est. %.0f ns)",
+		     src_mem.id, src_kind, dst_mem.id, dst_kind, best->get_name().c_str(),
+		     best_time);
+	if(channel)
+	  *channel = best;
+	return best->create_copier(src_mem, dst_mem, redop_id, fold);
       }
 
       // old style - various options in here are being turned into assert(0)'s as they are 
@@ -2211,11 +2404,13 @@ namespace LegionRuntime {
 #endif
       DetailedTimer::ScopedPush sp(TIME_COPY);
 
-      // create a copier for the memory used by all of these instance pairs
-      Memory src_mem = get_runtime()->get_instance_impl(oas_by_inst->begin()->first.first)->memory;
-      Memory dst_mem = get_runtime()->get_instance_impl(oas_by_inst->begin()->first.second)->memory;
+      start_time = Realm::Clock::current_time_in_nanoseconds();
 
-      MemPairCopier *mpc = MemPairCopier::create_copier(src_mem, dst_mem);
+      // create a copier for the memory used by all of these instance pairs
+      MemPairCopier *mpc = MemPairCopier::create_copier(src_mem, dst_mem, 0, false,
+							copy_bytes, &channel);
+      if(channel)
+	copy_cost_model.copy_started(channel, copy_bytes);
 
       switch(domain.get_dim()) {
       case 0:
@@ -3604,6 +3799,11 @@ namespace Realm {
 
   using namespace LegionRuntime::LowLevel;
 
+    double Machine::estimate_copy_time(Memory src_mem, Memory dst_mem, size_t bytes) const
+    {
+      return copy_cost_model.estimate_copy_time(src_mem, dst_mem, bytes);
+    }
+
     Event Domain::fill(const std::vector<CopySrcDstField> &dsts,
                        const void *fill_value, size_t fill_value_size,
                        Event wait_on /*= Event::NO_EVENT*/) const
@@ -3622,6 +3822,7 @@ namespace Realm {
             it != dsts.end(); it++)
       {
         Event ev = GenEventImpl::create_genevent()->current_event();
+        Realm::EventTracer::record_copy(ev, wait_on);
         FillRequest *r = new FillRequest(*this, *it, fill_value,
                                          fill_value_size, wait_on,
                                          ev, 0/*priority*/, requests);
@@ -3819,6 +4020,7 @@ namespace Realm {
 	  OASByInst *oas_by_inst = it->second;
 
 	  Event ev = GenEventImpl::create_genevent()->current_event();
+	  Realm::EventTracer::record_copy(ev, wait_on);
 #ifdef EVENT_GRAPH_TRACE
           Event enclosing = find_enclosing_termination_event();
           log_event_graph.info("Copy Request: (" IDFMT ",%d) (" IDFMT ",%d) "
@@ -3899,6 +4101,7 @@ namespace Realm {
 	bool inst_lock_needed = (dst_kind == MemoryImpl::MKIND_GLOBAL);
 
 	Event ev = GenEventImpl::create_genevent()->current_event();
+	Realm::EventTracer::record_copy(ev, wait_on);
 
 	ReduceRequest *r = new ReduceRequest(*this, 
 					     srcs, dsts[0],
@@ -194,11 +194,17 @@ namespace LegionRuntime {
       std::vector<bool> partial_field;
     };
 
+    class MemPairCopierFactory;
+
     class MemPairCopier {
     public:
+      // 'bytes' (if known) is the size of the copy, used to choose between
+      //  DMA channels
       static MemPairCopier* create_copier(Memory src_mem, Memory dst_mem,
 					  ReductionOpID redop_id = 0,
-					  bool fold = false);
+					  bool fold = false,
+					  size_t bytes = 0,
+					  MemPairCopierFactory **channel = 0);
 
       MemPairCopier(void);
 
@@ -228,11 +234,16 @@ namespace LegionRuntime {
 
       const std::string& get_name(void) const;
 
-      // TODO: consider responding with a "goodness" metric that would allow choosing between
-      //  multiple capable channels - these metrics are the probably the same as "mem-to-mem affinity"
       virtual bool can_perform_copy(Memory src_mem, Memory dst_mem,
 				    ReductionOpID redop_id, bool fold) = 0;
 
+      // the "goodness" of this channel for a copy, used to choose between
+      //  multiple capable channels - the predicted time (in ns) for a copy of
+      //  'bytes' bytes issued now, which by default is the CopyCostModel's
+      //  estimate from this channel's own backlog and observed bandwidth
+      virtual double estimate_copy_time(Memory src_mem, Memory dst_mem,
+					size_t bytes);
+
       virtual MemPairCopier *create_copier(Memory src_mem, Memory dst_mem,
 					   ReductionOpID redop_id, bool fold) = 0;
 
@@ -240,6 +251,67 @@ namespace LegionRuntime {
       std::string name;
     };
 
+    // a node-local model of what copies between a pair of memories cost
+    //  right now, built from the copies this node's DMA system performs: the
+    //  bytes queued (or in flight) between the pair and the bandwidth
+    //  observed for recent copies, with the static mem-mem affinity standing
+    //  in for pairs that haven't been used yet
+    class CopyCostModel {
+    public:
+      // a copy counts against its memory pair from when it is queued and
+      //  against its channel (if any) from when it starts, until the copy
+      //  and any async work it started are complete
+      void copy_queued(Memory src_mem, Memory dst_mem, size_t bytes);
+      void copy_started(const MemPairCopierFactory *channel, size_t bytes);
+      void copy_finished(Memory src_mem, Memory dst_mem,
+			 const MemPairCopierFactory *channel,
+			 size_t bytes, long long elapsed_ns);
+
+      // predicted time (in ns) until a copy of 'bytes' bytes issued now
+      //  would finish, or a negative value if there is no direct path
+      //  between the two memories - if 'channel' is given, the prediction
+      //  is for a copy performed by that channel
+      double estimate_copy_time(Memory src_mem, Memory dst_mem, size_t bytes,
+				const MemPairCopierFactory *channel = 0);
+
+    protected:
+      // decayed sums over completed copies
+      struct Observed {
+	Observed(void);
+	void add(size_t _bytes, long long _ns);
+	double bandwidth(void) const;  // bytes/ns, 0 if nothing observed
+
+	double bytes, ns;
+      };
+
+      struct PairCost {
+	PairCost(void);
+
+	bool prior_valid;
+	double prior_bandwidth;   // bytes/ns, 0 if no affinity
+	double prior_latency;     // ns
+	size_t queued_bytes;
+	int queued_copies;
+	Observed observed;
+      };
+
+      struct ChannelCost {
+	ChannelCost(void);
+
+	size_t queued_bytes;
+	int queued_copies;
+	std::map<std::pair<Memory, Memory>, Observed> observed;
+      };
+
+      PairCost& lookup(Memory src_mem, Memory dst_mem);
+
+      GASNetHSL mutex;
+      std::map<std::pair<Memory, Memory>, PairCost> costs;
+      std::map<const MemPairCopierFactory *, ChannelCost> channel_costs;
+    };
+
+    extern CopyCostModel copy_cost_model;
+
   };
 };
 
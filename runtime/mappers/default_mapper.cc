@@ -29,6 +29,11 @@
 #define STATIC_MAX_SCHEDULE_COUNT     8
 #define STATIC_NUM_PROFILE_SAMPLES    1
 #define STATIC_MAX_FAILED_MAPPINGS    8
+#define STATIC_COPY_ESTIMATE_SIZE     (1 << 20)
+#define STATIC_SPECULATION_ENABLED    false
+// Stop speculating once we've seen this many guesses resolve
+// and fewer than half of them turned out to be right
+#define STATIC_SPECULATION_WARMUP     32
 
 // This is the default implementation of the mapper interface for 
 // the general low level runtime
@@ -77,6 +82,8 @@ namespace LegionRuntime {
         stealing_enabled(STATIC_STEALING_ENABLED),
         max_schedule_count(STATIC_MAX_SCHEDULE_COUNT),
         max_failed_mappings(STATIC_MAX_FAILED_MAPPINGS),
+        copy_estimate_size(STATIC_COPY_ESTIMATE_SIZE),
+        speculation_enabled(STATIC_SPECULATION_ENABLED),
         machine_interface(MappingUtilities::MachineQueryInterface(m))
     //--------------------------------------------------------------------------
     {
@@ -110,6 +117,8 @@ namespace LegionRuntime {
           INT_ARG("-dm:sched", max_schedule_count);
           INT_ARG("-dm:prof",num_profiling_samples);
           INT_ARG("-dm:fail",max_failed_mappings);
+          INT_ARG("-dm:copysize",copy_estimate_size);
+          BOOL_ARG("-dm:speculate",speculation_enabled);
 #undef BOOL_ARG
 #undef INT_ARG
         }
@@ -766,8 +775,26 @@ namespace LegionRuntime {
         return;
       }
 
-      machine_interface.find_memory_stack(dst_mem, 
-                                          chosen_order, true/*latency*/);
+      // Rank the memories with valid data by when a copy from each of
+      // them would be expected to finish, which accounts for copies that
+      // are already queued between the memories and the bandwidth they
+      // have been getting, so an idle replica beats a busy one.  The
+      // mapper doesn't know how big the copy is, so use a nominal size.
+      std::vector<std::pair<double,Memory> > ranking;
+      for (std::set<Memory>::const_iterator it = current_instances.begin();
+            it != current_instances.end(); it++)
+      {
+        double estimate = machine.estimate_copy_time(*it, dst_mem,
+                                                     copy_estimate_size);
+        // Skip memories that would need a multi-hop copy
+        if (estimate < 0)
+          continue;
+        ranking.push_back(std::pair<double,Memory>(estimate, *it));
+      }
+      std::sort(ranking.begin(), ranking.end());
+      for (std::vector<std::pair<double,Memory> >::const_iterator it = 
+            ranking.begin(); it != ranking.end(); it++)
+        chosen_order.push_back(it->second);
       if (chosen_order.empty())
       {
         // This is the multi-hop copy because none 
@@ -816,10 +843,19 @@ namespace LegionRuntime {
                             "default mapper for processor " IDFMT "",
                             mappable->get_unique_mappable_id(),
                             local_proc.id);
-      // While the runtime supports speculation, it currently doesn't
-      // know how to roll back from mis-speculation, so for the moment
-      // we don't speculate.
-      return false;
+      if (!speculation_enabled)
+        return false;
+      // Predicates mostly guard loops that keep going until some
+      // convergence test fails, so guess that they're true unless
+      // the guesses so far have mostly been wrong
+      SpeculationStatistics stats;
+      sample_speculation_statistics(stats);
+      const unsigned long long resolved = stats.hits + stats.misses;
+      if ((resolved >= STATIC_SPECULATION_WARMUP) && 
+          (stats.hits < stats.misses))
+        return false;
+      spec_value = true;
+      return true;
     }
 
     //--------------------------------------------------------------------------
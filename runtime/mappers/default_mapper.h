@@ -131,6 +131,14 @@ namespace LegionRuntime {
       unsigned max_schedule_count;
       // Maximum number of failed mappings for a task before error
       unsigned max_failed_mappings;
+      // The copy size (in bytes) assumed when ranking copy sources by
+      // their estimated copy times
+      // Controlled by -dm:copysize
+      unsigned copy_estimate_size;
+      // Whether to run predicated operations before their predicates
+      // resolve, guessing that they will be true
+      // Controlled by -dm:speculate
+      bool speculation_enabled;
       std::map<UniqueID,unsigned> failed_mappings;
       // Utilities for use within the default mapper 
       MappingUtilities::MachineQueryInterface machine_interface;
@@ -15,6 +15,9 @@
 
 // a little helper class for storing a dynamically allocated byte array
 //  an accessing it in various ways
+//
+// small arrays (e.g. the arguments of most tasks) are stored inside the
+//  ByteArray itself rather than in a separate heap allocation
 
 #ifndef REALM_BYTEARRAY_H
 #define REALM_BYTEARRAY_H
@@ -64,9 +67,24 @@ namespace Realm {
     template <typename T>
     const T& at(size_t offset) const;
 
+    // arrays up to this size are stored inline
+    static const size_t INLINE_BYTES = 64;
+
   protected:
+    // true if the contents are held in inline_data rather than the heap
+    inline bool is_inline(void) const;
+
+    // returns storage for 'new_size' bytes - caller must have cleared
+    inline void *allocate(size_t new_size);
+
     void *array_base;
     size_t array_size;
+    union {
+      char bytes[INLINE_BYTES];
+      double align_double;   // alignment for at<T>
+      long long align_ll;
+      void *align_ptr;
+    } inline_data;
   };
 
   // support for realm-style serialization
@@ -40,9 +40,7 @@ namespace Realm {
     : array_base(0), array_size(0)
   {
     if(copy_size) {
-      array_base = malloc(copy_size);
-      assert(array_base != 0);
-      memcpy(array_base, copy_from, copy_size);
+      memcpy(allocate(copy_size), copy_from, copy_size);
       array_size = copy_size;
     }
   }
@@ -51,27 +49,24 @@ namespace Realm {
     : array_base(0), array_size(0)
   {
     if(copy_from.size()) {
-      array_base = malloc(copy_from.size());
-      assert(array_base != 0);
-      memcpy(array_base, copy_from.base(), copy_from.size());
+      memcpy(allocate(copy_from.size()), copy_from.base(), copy_from.size());
       array_size = copy_from.size();
     }
   }
 
   ByteArray::~ByteArray(void)
   {
-    if(array_size)
+    if(array_size && !is_inline())
       free(array_base);
   }
 
   // copies the contents of the rhs ByteArray
   ByteArray& ByteArray::operator=(const ByteArray& copy_from)
   {
+    if(&copy_from == this) return *this;
     clear();  // throw away any data we had before
     if(copy_from.size()) {
-      array_base = malloc(copy_from.size());
-      assert(array_base != 0);
-      memcpy(array_base, copy_from.base(), copy_from.size());
+      memcpy(allocate(copy_from.size()), copy_from.base(), copy_from.size());
       array_size = copy_from.size();
     }
     return *this;
@@ -82,8 +77,17 @@ namespace Realm {
   //   ByteArray().swap(old_array)
   ByteArray& ByteArray::swap(ByteArray& swap_with)
   {
+    // inline contents have to move with the bytes, and the base pointers
+    //  then have to be pointed at the new owner's storage
+    bool this_inline = is_inline();
+    bool other_inline = swap_with.is_inline();
+    std::swap(inline_data, swap_with.inline_data);
     std::swap(array_base, swap_with.array_base);
     std::swap(array_size, swap_with.array_size);
+    if(other_inline)
+      array_base = inline_data.bytes;
+    if(this_inline)
+      swap_with.array_base = swap_with.inline_data.bytes;
     return *this;
   }
 
@@ -92,9 +96,7 @@ namespace Realm {
   {
     clear();  // throw away any data we had before
     if(copy_size) {
-      array_base = malloc(copy_size);
-      assert(array_base != 0);
-      memcpy(array_base, copy_from, copy_size);
+      memcpy(allocate(copy_size), copy_from, copy_size);
       array_size = copy_size;
     }
     return *this;
@@ -153,7 +155,8 @@ namespace Realm {
   void ByteArray::clear(void)
   {
     if(array_size) {
-      free(array_base);
+      if(!is_inline())
+	free(array_base);
       array_base = 0;
       array_size = 0;
     }
@@ -164,6 +167,12 @@ namespace Realm {
   {
     if(array_size) {
       void *retval = array_base;
+      // inline data has to be copied out to storage the caller can free
+      if(is_inline()) {
+	retval = malloc(array_size);
+	assert(retval != 0);
+	memcpy(retval, array_base, array_size);
+      }
       array_base = 0;
       array_size = 0;
       return retval;
@@ -171,6 +180,23 @@ namespace Realm {
       return 0;
   }
 
+  bool ByteArray::is_inline(void) const
+  {
+    return (array_base == inline_data.bytes);
+  }
+
+  void *ByteArray::allocate(size_t new_size)
+  {
+    assert(array_size == 0);
+    if(new_size <= INLINE_BYTES) {
+      array_base = inline_data.bytes;
+    } else {
+      array_base = malloc(new_size);
+      assert(array_base != 0);
+    }
+    return array_base;
+  }
+
   // support for realm-style serialization
   template <typename S>
   bool operator<<(S& serdez, const ByteArray& a)
@@ -185,6 +211,14 @@ namespace Realm {
   {
     size_t new_size;
     if(!(serdez >> new_size)) return false;
+    // small arrays don't need a heap allocation at all
+    if((new_size > 0) && (new_size <= ByteArray::INLINE_BYTES)) {
+      char buffer[ByteArray::INLINE_BYTES];
+      if(!serdez.extract_bytes(buffer, new_size))
+	return false;
+      a.set(buffer, new_size);
+      return true;
+    }
     void *new_base = 0;
     if(new_size) {
       new_base = malloc(new_size);
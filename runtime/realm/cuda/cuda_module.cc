@@ -1527,15 +1527,18 @@ namespace Realm {
     static unsigned *get_gpu_valid_mask(RegionMetaDataUntyped region)
     {
 	const ElementMask &mask = region.get_valid_mask();
+	// the mask may be a run list, so copy out its bitmap form
+	std::vector<char> mask_bits(mask.raw_size());
+	mask.copy_raw(&mask_bits[0]);
 	void *valid_mask_base;
 	for(size_t p = 0; p < mask.raw_size(); p += 4)
 	  log_gpudma.info("  raw mask data[%zd] = %08x\n", p,
-		       ((unsigned *)(mask.get_raw()))[p>>2]);
+		       ((unsigned *)(&mask_bits[0]))[p>>2]);
         CHECK_CU( cuMemAlloc((cuDevicePtr*)(&valid_mask_base), mask.raw_size()) );
 	log_gpudma.info("copy of valid mask (%zd bytes) created at %p",
 		     mask.raw_size(), valid_mask_base);
         CHECK_CU( cuMemcpyHtoD(vald_mask_base, 
-                               mask.get_raw(),
+                               &mask_bits[0],
                                mask.raw_size()) );
 	return (unsigned *)&(((ElementMaskImpl *)valid_mask_base)->bits);
     }
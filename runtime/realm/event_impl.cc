@@ -19,6 +19,8 @@
 #include "runtime_impl.h"
 #include "logging.h"
 #include "threads.h"
+#include "event_tracer.h"
+#include "perf_counters.h"
 
 namespace Realm {
 
@@ -399,6 +401,7 @@ namespace Realm {
 	  it != wait_for.end();
 	  it++) {
 	log_event.info() << "event merging: event=" << e << " wait_on=" << *it;
+	EventTracer::record_dependence(e, *it);
 	m->add_event(*it);
 #ifdef EVENT_GRAPH_TRACE
         log_event_graph.info("Event Precondition: (" IDFMT ",%d) (" IDFMT ",%d)",
@@ -467,26 +470,32 @@ namespace Realm {
 
       if(ev1.exists()) {
 	log_event.info() << "event merging: event=" << e << " wait_on=" << ev1;
+	EventTracer::record_dependence(e, ev1);
 	m->add_event(ev1);
       }
       if(ev2.exists()) {
 	log_event.info() << "event merging: event=" << e << " wait_on=" << ev2;
+	EventTracer::record_dependence(e, ev2);
 	m->add_event(ev2);
       }
       if(ev3.exists()) {
 	log_event.info() << "event merging: event=" << e << " wait_on=" << ev3;
+	EventTracer::record_dependence(e, ev3);
 	m->add_event(ev3);
       }
       if(ev4.exists()) {
 	log_event.info() << "event merging: event=" << e << " wait_on=" << ev4;
+	EventTracer::record_dependence(e, ev4);
 	m->add_event(ev4);
       }
       if(ev5.exists()) {
 	log_event.info() << "event merging: event=" << e << " wait_on=" << ev5;
+	EventTracer::record_dependence(e, ev5);
 	m->add_event(ev5);
       }
       if(ev6.exists()) {
 	log_event.info() << "event merging: event=" << e << " wait_on=" << ev6;
+	EventTracer::record_dependence(e, ev6);
 	m->add_event(ev6);
       }
 
@@ -527,6 +536,7 @@ namespace Realm {
       assert(ID(impl->me).type() == ID::ID_EVENT);
 
       log_event.info() << "event created: event=" << impl->current_event();
+      EventTracer::record_create(impl->current_event());
 
 #ifdef EVENT_TRACING
       {
@@ -725,6 +735,7 @@ namespace Realm {
 
 
   /*static*/ Barrier::timestamp_t BarrierImpl::barrier_adjustment_timestamp;
+  /*static*/ int BarrierImpl::tree_radix = 0;
 
 
 
@@ -831,10 +842,13 @@ namespace Realm {
 	t.id = me.id();
 	t.gen = gen_triggered;
 	log_event.info() << "deferring event trigger: event=" << t << " wait_on=" << wait_on;
+	EventTracer::record_dependence(t, wait_on);
 	EventImpl::add_waiter(wait_on, new DeferredEventTrigger(this));
 	return;
       }
 
+      RuntimeOverhead::ScopedTimer overhead_timer(RuntimeOverhead::EVENT_TRIGGER);
+
       log_event.spew("event triggered: event=" IDFMT "/%d by node %d", 
 		me.id(), gen_triggered, trigger_node);
 #ifdef EVENT_TRACING
@@ -863,6 +877,12 @@ namespace Realm {
 
         generation = gen_triggered;
 
+	if(EventTracer::is_enabled()) {
+	  Event triggered = me.convert<Event>();
+	  triggered.gen = gen_triggered;
+	  EventTracer::record_trigger(triggered);
+	}
+
 	// grab whole list of local waiters - we'll trigger them once we let go of the lock
 	//printf("[%d] LOCAL WAITERS: %zd\n", gasnet_mynode(), local_waiters.size());
 	to_wake.swap(local_waiters);
@@ -977,6 +997,7 @@ namespace Realm {
       initial_value = 0;
       value_capacity = 0;
       final_values = 0;
+      combines_in_flight = 0;
     }
 
     void BarrierImpl::init(ID _me, unsigned _init_owner)
@@ -994,6 +1015,7 @@ namespace Realm {
       initial_value = 0;
       value_capacity = 0;
       final_values = 0;
+      combines_in_flight = 0;
     }
 
     /*static*/ void BarrierAdjustMessage::handle_request(RequestArgs args, const void *data, size_t datalen)
@@ -1140,11 +1162,6 @@ static void *bytedup(const void *data, size_t datalen)
         }
       }
 
-    struct RemoteNotification {
-      unsigned node;
-      Event::gen_t trigger_gen, previous_gen;
-    };
-
     // used to adjust a barrier's arrival count either up or down
     // if delta > 0, timestamp is current time (on requesting node)
     // if delta < 0, timestamp says which positive adjustment this arrival must wait for
@@ -1158,7 +1175,8 @@ static void *bytedup(const void *data, size_t datalen)
 	b.gen = barrier_gen;
 	b.timestamp = timestamp;
 #ifndef DEFER_ARRIVALS_LOCALLY
-        if(owner != gasnet_mynode()) {
+	// (in tree mode they're deferred locally so they can still be combined)
+        if((owner != gasnet_mynode()) && (tree_radix == 0)) {
 	  // let deferral happen on owner node (saves latency if wait_on event
           //   gets triggered there)
           //printf("sending deferred arrival to %d for " IDFMT "/%d (" IDFMT "/%d)\n",
@@ -1190,7 +1208,15 @@ static void *bytedup(const void *data, size_t datalen)
 #endif
 
       if(owner != gasnet_mynode()) {
-	// all adjustments handled by owner node
+	// arrivals without a timestamp can be combined with others on the way
+	//  up the tree - reduction values too, as long as we know how to fold them
+	if((tree_radix > 0) && (timestamp == 0) &&
+	   ((reduce_value_size == 0) || (redop && redop->is_foldable))) {
+	  combine_arrival(barrier_gen, delta, reduce_value, reduce_value_size);
+	  return;
+	}
+
+	// all other adjustments handled by owner node
 	Barrier b = me.convert<Barrier>();
 	b.gen = barrier_gen;
 	b.timestamp = timestamp;
@@ -1244,40 +1270,6 @@ static void *bytedup(const void *data, size_t datalen)
 	    generations.erase(it);
 	    it = generations.begin();
 	  }
-
-	  // if any triggers occurred, figure out which remote nodes need notifications
-	  //  (i.e. any who have subscribed)
-	  if(generation >= barrier_gen) {
-	    std::map<unsigned, Event::gen_t>::iterator it = remote_subscribe_gens.begin();
-	    while(it != remote_subscribe_gens.end()) {
-	      RemoteNotification rn;
-	      rn.node = it->first;
-	      if(it->second <= generation) {
-		// we have fulfilled the entire subscription
-		rn.trigger_gen = it->second;
-		std::map<unsigned, Event::gen_t>::iterator to_nuke = it++;
-		remote_subscribe_gens.erase(to_nuke);
-	      } else {
-		// subscription remains valid
-		rn.trigger_gen = generation;
-		it++;
-	      }
-	      // also figure out what the previous generation this node knew about was
-	      {
-		std::map<unsigned, Event::gen_t>::iterator it2 = remote_trigger_gens.find(rn.node);
-		if(it2 != remote_trigger_gens.end()) {
-		  rn.previous_gen = it2->second;
-		  it2->second = rn.trigger_gen;
-		} else {
-		  rn.previous_gen = first_generation;
-		  remote_trigger_gens[rn.node] = rn.trigger_gen;
-		}
-	      }
-	      if(remote_notifications.empty() || (rn.previous_gen < oldest_previous))
-		oldest_previous = rn.previous_gen;
-	      remote_notifications.push_back(rn);
-	    }
-	  }
 	}
 
 	// do we have reduction data to apply?  we can do this even if the actual adjustment is
@@ -1302,16 +1294,11 @@ static void *bytedup(const void *data, size_t datalen)
 	  redop->apply(final_values + ((rel_gen - 1) * redop->sizeof_lhs), reduce_value, 1, true);
 	}
 
-	// do this AFTER we actually update the reduction value above :)
-	// if any remote notifications are going to occur and we have reduction values, make a copy so
-	//  we have something stable after we let go of the lock
-	if(trigger_gen && redop) {
-	  int rel_gen = oldest_previous + 1 - first_generation;
-	  assert(rel_gen > 0);
-	  int count = trigger_gen - oldest_previous;
-	  final_values_copy = bytedup(final_values + ((rel_gen - 1) * redop->sizeof_lhs),
-				      count * redop->sizeof_lhs);
-	}
+	// if any triggers occurred, figure out which remote nodes need notifications
+	//  (i.e. any who have subscribed) - do this AFTER we actually update the
+	//  reduction value above :)
+	if(trigger_gen != 0)
+	  final_values_copy = find_remote_notifications(remote_notifications, oldest_previous);
       }
 
       if(trigger_gen != 0) {
@@ -1328,20 +1315,70 @@ static void *bytedup(const void *data, size_t datalen)
 	}
 
 	// now do remote notifications
-	for(std::vector<RemoteNotification>::const_iterator it = remote_notifications.begin();
-	    it != remote_notifications.end();
-	    it++) {
-	  log_barrier.info("sending remote trigger notification: " IDFMT "/%d -> %d, dest=%d",
-			   me.id(), (*it).previous_gen, (*it).trigger_gen, (*it).node);
-	  void *data = 0;
-	  size_t datalen = 0;
-	  if(final_values_copy) {
-	    data = (char *)final_values_copy + (((*it).previous_gen - oldest_previous) * redop->sizeof_lhs);
-	    datalen = ((*it).trigger_gen - (*it).previous_gen) * redop->sizeof_lhs;
+	send_remote_notifications(remote_notifications, oldest_previous, final_values_copy);
+      }
+    }
+
+    void *BarrierImpl::find_remote_notifications(std::vector<RemoteNotification>& notifications,
+						 Event::gen_t& oldest_previous)
+    {
+      std::map<unsigned, Event::gen_t>::iterator it = remote_subscribe_gens.begin();
+      while(it != remote_subscribe_gens.end()) {
+	RemoteNotification rn;
+	rn.node = it->first;
+	if(it->second <= generation) {
+	  // we have fulfilled the entire subscription
+	  rn.trigger_gen = it->second;
+	  std::map<unsigned, Event::gen_t>::iterator to_nuke = it++;
+	  remote_subscribe_gens.erase(to_nuke);
+	} else {
+	  // subscription remains valid
+	  rn.trigger_gen = generation;
+	  it++;
+	}
+	// also figure out what the previous generation this node knew about was
+	{
+	  std::map<unsigned, Event::gen_t>::iterator it2 = remote_trigger_gens.find(rn.node);
+	  if(it2 != remote_trigger_gens.end()) {
+	    rn.previous_gen = it2->second;
+	    it2->second = rn.trigger_gen;
+	  } else {
+	    rn.previous_gen = first_generation;
+	    remote_trigger_gens[rn.node] = rn.trigger_gen;
 	  }
-	  BarrierTriggerMessage::send_request((*it).node, me.id(), (*it).trigger_gen, (*it).previous_gen,
-					      first_generation, redop_id, data, datalen);
 	}
+	if(notifications.empty() || (rn.previous_gen < oldest_previous))
+	  oldest_previous = rn.previous_gen;
+	notifications.push_back(rn);
+      }
+
+      // if any remote notifications are going to occur and we have reduction values, make a copy so
+      //  we have something stable after we let go of the lock
+      if(notifications.empty() || !redop || !final_values)
+	return 0;
+      int rel_gen = oldest_previous + 1 - first_generation;
+      assert(rel_gen > 0);
+      int count = generation - oldest_previous;
+      return bytedup(final_values + ((rel_gen - 1) * redop->sizeof_lhs),
+		     count * redop->sizeof_lhs);
+    }
+
+    void BarrierImpl::send_remote_notifications(const std::vector<RemoteNotification>& notifications,
+						Event::gen_t oldest_previous, void *final_values_copy)
+    {
+      for(std::vector<RemoteNotification>::const_iterator it = notifications.begin();
+	  it != notifications.end();
+	  it++) {
+	log_barrier.info("sending remote trigger notification: " IDFMT "/%d -> %d, dest=%d",
+			 me.id(), (*it).previous_gen, (*it).trigger_gen, (*it).node);
+	void *data = 0;
+	size_t datalen = 0;
+	if(final_values_copy) {
+	  data = (char *)final_values_copy + (((*it).previous_gen - oldest_previous) * redop->sizeof_lhs);
+	  datalen = ((*it).trigger_gen - (*it).previous_gen) * redop->sizeof_lhs;
+	}
+	BarrierTriggerMessage::send_request((*it).node, me.id(), (*it).trigger_gen, (*it).previous_gen,
+					    first_generation, redop_id, data, datalen);
       }
 
       // free our copy of the final values, if we had one
@@ -1349,6 +1386,144 @@ static void *bytedup(const void *data, size_t datalen)
 	free(final_values_copy);
     }
 
+    gasnet_node_t BarrierImpl::tree_parent(void) const
+    {
+      // number the nodes relative to the owner, which is the root of the tree
+      unsigned num_nodes = gasnet_nodes();
+      unsigned rel_node = (gasnet_mynode() + num_nodes - owner) % num_nodes;
+      assert(rel_node > 0);
+      return ((rel_node - 1) / tree_radix + owner) % num_nodes;
+    }
+
+    void BarrierImpl::combine_arrival(Event::gen_t barrier_gen, int delta,
+				      const void *reduce_value, size_t reduce_value_size)
+    {
+      std::map<Event::gen_t, CombinedArrival> to_send;
+      {
+	AutoHSLLock a(mutex);
+
+	std::map<Event::gen_t, CombinedArrival>::iterator it = pending_combines.find(barrier_gen);
+	if(it == pending_combines.end()) {
+	  CombinedArrival ca;
+	  ca.delta = 0;
+	  ca.value = 0;
+	  it = pending_combines.insert(std::make_pair(barrier_gen, ca)).first;
+	}
+	it->second.delta += delta;
+	if(reduce_value_size > 0) {
+	  assert(redop && (reduce_value_size == redop->sizeof_rhs));
+	  if(it->second.value)
+	    redop->fold(it->second.value, reduce_value, 1, true);
+	  else
+	    it->second.value = (char *)bytedup(reduce_value, reduce_value_size);
+	}
+
+	// only one batch goes to our parent at a time - everything that shows up
+	//  in the meantime is combined into the next one
+	if(combines_in_flight == 0) {
+	  to_send.swap(pending_combines);
+	  combines_in_flight = to_send.size();
+	}
+      }
+
+      send_combined_arrivals(to_send);
+    }
+
+    void BarrierImpl::combine_acknowledged(ReductionOpID parent_redop_id)
+    {
+      std::map<Event::gen_t, CombinedArrival> to_send;
+      {
+	AutoHSLLock a(mutex);
+
+	// learning the reduction op lets us fold values from here on
+	if(parent_redop_id && !redop) {
+	  redop_id = parent_redop_id;
+	  redop = get_runtime()->reduce_op_table[parent_redop_id];
+	}
+
+	assert(combines_in_flight > 0);
+	combines_in_flight--;
+	if(combines_in_flight == 0) {
+	  to_send.swap(pending_combines);
+	  combines_in_flight = to_send.size();
+	}
+      }
+
+      send_combined_arrivals(to_send);
+    }
+
+    void BarrierImpl::send_combined_arrivals(std::map<Event::gen_t, CombinedArrival>& to_send)
+    {
+      if(to_send.empty())
+	return;
+
+      gasnet_node_t parent = tree_parent();
+      for(std::map<Event::gen_t, CombinedArrival>::iterator it = to_send.begin();
+	  it != to_send.end();
+	  it++) {
+	Barrier b = me.convert<Barrier>();
+	b.gen = it->first;
+	b.timestamp = 0;
+	log_barrier.info("sending combined barrier arrival: " IDFMT "/%d delta=%d -> %d",
+			 b.id, b.gen, it->second.delta, parent);
+	BarrierCombineMessage::send_request(parent, b, it->second.delta,
+					    it->second.value,
+					    (it->second.value ? redop->sizeof_rhs : 0));
+	if(it->second.value)
+	  free(it->second.value);
+      }
+    }
+
+    /*static*/ void BarrierCombineMessage::handle_request(RequestArgs args, const void *data, size_t datalen)
+    {
+      log_barrier.info("received combined barrier arrival: " IDFMT "/%d delta=%d from %d",
+		       args.barrier.id, args.barrier.gen, args.delta, args.node);
+      BarrierImpl *impl = get_runtime()->get_barrier_impl(args.barrier);
+
+      // the owner applies the batch like any other arrival, everybody else adds
+      //  it to what they'll send up the tree next
+      if(impl->owner == gasnet_mynode())
+	impl->adjust_arrival(args.barrier.gen, args.delta, 0, Event::NO_EVENT,
+			     datalen ? data : 0, datalen);
+      else
+	impl->combine_arrival(args.barrier.gen, args.delta,
+			      datalen ? data : 0, datalen);
+
+      BarrierCombineAckMessage::send_request(args.node, args.barrier.id, impl->redop_id);
+    }
+
+    /*static*/ void BarrierCombineMessage::send_request(gasnet_node_t target, Barrier barrier, int delta,
+							const void *data, size_t datalen)
+    {
+      RequestArgs args;
+
+      args.node = gasnet_mynode();
+      args.barrier = barrier;
+      args.delta = delta;
+
+      Message::request(target, args, data, datalen, PAYLOAD_COPY);
+    }
+
+    /*static*/ void BarrierCombineAckMessage::handle_request(RequestArgs args)
+    {
+      Barrier b;
+      b.id = args.barrier_id;
+      b.gen = 0;
+      BarrierImpl *impl = get_runtime()->get_barrier_impl(b);
+      impl->combine_acknowledged(args.redop_id);
+    }
+
+    /*static*/ void BarrierCombineAckMessage::send_request(gasnet_node_t target, ID::IDType barrier_id,
+							   ReductionOpID redop_id)
+    {
+      RequestArgs args;
+
+      args.barrier_id = barrier_id;
+      args.redop_id = redop_id;
+
+      Message::request(target, args);
+    }
+
     bool BarrierImpl::has_triggered(Event::gen_t needed_gen)
     {
       // no need to take lock to check current generation
@@ -1367,7 +1542,9 @@ static void *bytedup(const void *data, size_t datalen)
 
 	if(previous_subscription < needed_gen) {
 	  log_barrier.info("subscribing to barrier " IDFMT "/%d", me.id(), needed_gen);
-	  BarrierSubscribeMessage::send_request(owner, me.id(), needed_gen);
+	  // in tree mode, our parent subscribes on our behalf if it needs to
+	  BarrierSubscribeMessage::send_request((tree_radix > 0) ? tree_parent() : owner,
+						me.id(), needed_gen);
 	}
       }
 
@@ -1429,6 +1606,7 @@ static void *bytedup(const void *data, size_t datalen)
       Event::gen_t previous_gen = 0;
       void *final_values_copy = 0;
       size_t final_values_size = 0;
+      bool forward_subscription = false;
       {
 	AutoHSLLock a(impl->mutex);
 
@@ -1457,6 +1635,15 @@ static void *bytedup(const void *data, size_t datalen)
 	  }
 	}
 
+	// an interior node of the combining tree has to subscribe to its own parent
+	//  to hear about the generations its children want
+	if((impl->owner != gasnet_mynode()) &&
+	   (args.subscribe_gen > impl->generation) &&
+	   (args.subscribe_gen > impl->gen_subscribed)) {
+	  impl->gen_subscribed = args.subscribe_gen;
+	  forward_subscription = true;
+	}
+
 	// as long as we're not already subscribed to this generation, check to see if
 	//  any trigger notifications are needed
 	if(!already_subscribed && (impl->generation > impl->first_generation)) {
@@ -1490,6 +1677,13 @@ static void *bytedup(const void *data, size_t datalen)
 
       if(final_values_copy)
 	free(final_values_copy);
+
+      if(forward_subscription) {
+	log_barrier.info("forwarding barrier subscription: " IDFMT "/%d",
+			 args.barrier_id, args.subscribe_gen);
+	BarrierSubscribeMessage::send_request(impl->tree_parent(), args.barrier_id,
+					      args.subscribe_gen);
+      }
     }
 
     /*static*/ void BarrierTriggerMessage::handle_request(BarrierTriggerMessage::RequestArgs args,
@@ -1505,6 +1699,10 @@ static void *bytedup(const void *data, size_t datalen)
 
       // we'll probably end up with a list of local waiters to notify
       std::vector<EventWaiter *> local_notifications;
+      // and in tree mode, children to pass the trigger along to
+      std::vector<BarrierImpl::RemoteNotification> remote_notifications;
+      Event::gen_t oldest_previous = 0;
+      void *final_values_copy = 0;
       {
 	AutoHSLLock a(impl->mutex);
 
@@ -1565,6 +1763,12 @@ static void *bytedup(const void *data, size_t datalen)
 	  assert(datalen == (impl->redop->sizeof_lhs * (args.trigger_gen - args.previous_gen)));
 	  memcpy(impl->final_values + ((rel_gen - 1) * impl->redop->sizeof_lhs), data, datalen);
 	}
+
+	// only nodes that children have subscribed to (in tree mode) have any
+	//  remote subscriptions to fulfill
+	if((args.previous_gen < impl->generation) && !impl->remote_subscribe_gens.empty())
+	  final_values_copy = impl->find_remote_notifications(remote_notifications,
+							      oldest_previous);
       }
 
       // with lock released, perform any local notifications
@@ -1575,6 +1779,9 @@ static void *bytedup(const void *data, size_t datalen)
 	if(nuke)
 	  delete (*it);
       }
+
+      if(!remote_notifications.empty())
+	impl->send_remote_notifications(remote_notifications, oldest_previous, final_values_copy);
     }
 
     bool BarrierImpl::get_result(Event::gen_t result_gen, void *value, size_t value_size)
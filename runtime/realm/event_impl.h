@@ -144,6 +144,43 @@ namespace Realm {
 
       bool get_result(Event::gen_t result_gen, void *value, size_t value_size);
 
+      // combining tree mode (-ll:barrier_radix > 0) - arrivals that don't carry
+      //  a timestamp are folded together on each node and sent up a tree of the
+      //  given radix rooted at the owner, and triggers are forwarded back down it
+      static int tree_radix;
+
+      gasnet_node_t tree_parent(void) const;
+
+      // adds arrivals that came from this node or from its children in the tree
+      //  to the ones waiting to go to our parent
+      void combine_arrival(Event::gen_t barrier_gen, int delta,
+			   const void *reduce_value, size_t reduce_value_size);
+
+      // our parent has seen the last batch of combined arrivals we sent
+      void combine_acknowledged(ReductionOpID parent_redop_id);
+
+      struct RemoteNotification {
+	unsigned node;
+	Event::gen_t trigger_gen, previous_gen;
+      };
+
+      // called with the lock held once 'generation' has advanced - works out
+      //  which subscribed nodes need to hear about it and returns a copy of any
+      //  reduction results they'll need
+      void *find_remote_notifications(std::vector<RemoteNotification>& notifications,
+				      Event::gen_t& oldest_previous);
+
+      void send_remote_notifications(const std::vector<RemoteNotification>& notifications,
+				     Event::gen_t oldest_previous, void *final_values_copy);
+
+    protected:
+      struct CombinedArrival {
+	int delta;
+	char *value;  // folded reduction value, if any
+      };
+
+      void send_combined_arrivals(std::map<Event::gen_t, CombinedArrival>& to_send);
+
     public: //protected:
       ID me;
       unsigned owner;
@@ -186,6 +223,11 @@ namespace Realm {
 
       unsigned value_capacity; // how many values the two allocations below can hold
       char *final_values;   // results of completed reductions
+
+      // arrivals waiting to go up the tree, and how many combined updates we've
+      //  sent to our parent that it hasn't acknowledged yet
+      std::map<Event::gen_t, CombinedArrival> pending_combines;
+      int combines_in_flight;
     };
 
   // active messages
@@ -279,7 +321,43 @@ namespace Realm {
 			       const void *data, size_t datalen);
     };
 
-	
+    // a batch of arrivals (and their folded reduction value) for one generation
+    //  of a barrier, sent to a node's parent in the combining tree
+    struct BarrierCombineMessage {
+      struct RequestArgs : public BaseMedium {
+	gasnet_node_t node;
+	Barrier barrier;
+	int delta;
+      };
+
+      static void handle_request(RequestArgs args, const void *data, size_t datalen);
+
+      typedef ActiveMessageMediumNoReply<BARRIER_COMBINE_MSGID,
+					 RequestArgs,
+					 handle_request> Message;
+
+      static void send_request(gasnet_node_t target, Barrier barrier, int delta,
+			       const void *data, size_t datalen);
+    };
+
+    // tells a child in the combining tree that it may send its next batch - also
+    //  passes along the barrier's reduction op, so that the child can fold values
+    struct BarrierCombineAckMessage {
+      struct RequestArgs {
+	ID::IDType barrier_id;
+	ReductionOpID redop_id;
+      };
+
+      static void handle_request(RequestArgs args);
+
+      typedef ActiveMessageShortNoReply<BARRIER_COMBINE_ACK_MSGID,
+					RequestArgs,
+					handle_request> Message;
+
+      static void send_request(gasnet_node_t target, ID::IDType barrier_id,
+			       ReductionOpID redop_id);
+    };
+
 }; // namespace Realm
 
 //include "event_impl.inl"
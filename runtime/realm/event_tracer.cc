@@ -0,0 +1,334 @@
+/* Copyright 2015 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// lightweight event graph tracer for Realm
+
+#include "event_tracer.h"
+
+#include "logging.h"
+#include "timers.h"
+
+#include <pthread.h>
+#include <algorithm>
+#include <map>
+
+namespace Realm {
+
+  Logger log_etrace("eventtrace");
+
+  namespace {
+
+    // each thread appends to its own buffer, so the only synchronization
+    //  needed is when a new buffer is registered or the buffers are read
+    struct TraceBuffer {
+      TraceBuffer(size_t capacity)
+	: records(capacity), count(0) {}
+
+      std::vector<EventTracer::Record> records;
+      volatile size_t count;  // total number of records ever written
+    };
+
+    __thread TraceBuffer *local_buffer = 0;
+
+    pthread_mutex_t buffers_mutex = PTHREAD_MUTEX_INITIALIZER;
+    std::vector<TraceBuffer *> all_buffers;
+    size_t records_per_thread = 1 << 16;
+
+    struct OpInfo {
+      OpInfo(void)
+	: kind(EventTracer::REC_TASK), info(0), before(Event::NO_EVENT),
+	  start(-1), end(-1), known(false) {}
+
+      unsigned kind, info;
+      Event before;
+      long long start, end;
+      bool known;
+    };
+
+    long long lookup_time(const std::map<Event, long long>& times, Event e)
+    {
+      std::map<Event, long long>::const_iterator it = times.find(e);
+      return ((it != times.end()) ? it->second : -1);
+    }
+
+    class EventGraph {
+    public:
+      EventGraph(const std::map<Event, long long>& _trigger_times,
+		 const std::map<Event, std::vector<Event> >& _preconditions,
+		 const std::map<Event, OpInfo>& _ops)
+	: trigger_times(_trigger_times), preconditions(_preconditions), ops(_ops) {}
+
+      // returns the event that gated 'e' (or NO_EVENT if there isn't one in
+      //  the window) - if 'e' is an operation, 'ready' is set to the time
+      //  the operation became ready to run
+      Event predecessor(Event e, long long window_start, long long& ready) const
+      {
+	ready = -1;
+	Event pred = Event::NO_EVENT;
+	std::map<Event, OpInfo>::const_iterator op_it = ops.find(e);
+	if((op_it != ops.end()) && op_it->second.known) {
+	  pred = op_it->second.before;
+	  ready = lookup_time(trigger_times, pred);
+	  if(ready < 0)
+	    ready = op_it->second.start;
+	} else {
+	  // follow whichever precondition triggered last - event
+	  //  generations are never reused, so this cannot cycle
+	  std::map<Event, std::vector<Event> >::const_iterator pre_it = preconditions.find(e);
+	  if(pre_it == preconditions.end())
+	    return Event::NO_EVENT;
+	  long long latest = -1;
+	  for(std::vector<Event>::const_iterator it = pre_it->second.begin();
+	      it != pre_it->second.end();
+	      it++) {
+	    long long t = lookup_time(trigger_times, *it);
+	    if(t > latest) {
+	      pred = *it;
+	      latest = t;
+	    }
+	  }
+	}
+	if(!pred.exists() || (lookup_time(trigger_times, pred) < window_start))
+	  return Event::NO_EVENT;
+	return pred;
+      }
+
+    protected:
+      const std::map<Event, long long>& trigger_times;
+      const std::map<Event, std::vector<Event> >& preconditions;
+      const std::map<Event, OpInfo>& ops;
+    };
+
+  };
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class EventTracer
+  //
+
+  /*static*/ volatile bool EventTracer::enabled = false;
+
+  /*static*/ void EventTracer::configure(bool enable, size_t _records_per_thread)
+  {
+    if(_records_per_thread > 0)
+      records_per_thread = _records_per_thread;
+    enabled = enable;
+  }
+
+  /*static*/ void EventTracer::enable_tracing(void)
+  {
+    enabled = true;
+  }
+
+  /*static*/ void EventTracer::disable_tracing(void)
+  {
+    enabled = false;
+  }
+
+  /*static*/ void EventTracer::clear(void)
+  {
+    pthread_mutex_lock(&buffers_mutex);
+    for(std::vector<TraceBuffer *>::iterator it = all_buffers.begin();
+	it != all_buffers.end();
+	it++)
+      (*it)->count = 0;
+    pthread_mutex_unlock(&buffers_mutex);
+  }
+
+  /*static*/ void EventTracer::record(unsigned kind, Event e, Event other, unsigned info)
+  {
+    TraceBuffer *buffer = local_buffer;
+    if(!buffer) {
+      // buffers are never freed because the analysis may run after the
+      //  thread that owns them has exited
+      buffer = new TraceBuffer(records_per_thread);
+      pthread_mutex_lock(&buffers_mutex);
+      all_buffers.push_back(buffer);
+      pthread_mutex_unlock(&buffers_mutex);
+      local_buffer = buffer;
+    }
+    size_t index = buffer->count;
+    Record& r = buffer->records[index % buffer->records.size()];
+    r.time = Clock::current_time_in_nanoseconds();
+    r.event = e;
+    r.other = other;
+    r.kind = kind;
+    r.info = info;
+    // make the record visible before the count that covers it
+    __sync_synchronize();
+    buffer->count = index + 1;
+  }
+
+  /*static*/ long long EventTracer::compute_critical_path(std::vector<PathEntry>& path,
+							 long long window_start /*= 0*/,
+							 long long window_end /*= -1*/)
+  {
+    path.clear();
+
+    // gather the surviving records from every ring buffer
+    std::vector<Record> records;
+    pthread_mutex_lock(&buffers_mutex);
+    for(std::vector<TraceBuffer *>::const_iterator it = all_buffers.begin();
+	it != all_buffers.end();
+	it++) {
+      size_t count = (*it)->count;
+      size_t capacity = (*it)->records.size();
+      size_t first = (count > capacity) ? (count - capacity) : 0;
+      for(size_t i = first; i < count; i++)
+	records.push_back((*it)->records[i % capacity]);
+    }
+    pthread_mutex_unlock(&buffers_mutex);
+
+    std::map<Event, long long> trigger_times;
+    std::map<Event, std::vector<Event> > preconditions;
+    std::map<Event, OpInfo> ops;
+    for(std::vector<Record>::const_iterator it = records.begin();
+	it != records.end();
+	it++) {
+      switch(it->kind) {
+      case REC_DEPENDENCE:
+	preconditions[it->event].push_back(it->other);
+	break;
+      case REC_TRIGGER:
+	{
+	  // keep the earliest trigger in case of duplicate notifications
+	  long long t = lookup_time(trigger_times, it->event);
+	  if((t < 0) || (it->time < t))
+	    trigger_times[it->event] = it->time;
+	  break;
+	}
+      case REC_TASK:
+      case REC_COPY:
+	{
+	  OpInfo& op = ops[it->event];
+	  op.kind = it->kind;
+	  op.info = it->info;
+	  op.before = it->other;
+	  op.known = true;
+	  break;
+	}
+      case REC_OP_START:
+	ops[it->event].start = it->time;
+	break;
+      case REC_OP_END:
+	ops[it->event].end = it->time;
+	break;
+      default:
+	break;
+      }
+    }
+
+    EventGraph graph(trigger_times, preconditions, ops);
+
+    // the critical path is the dependence chain with the largest span from
+    //  the time its first operation became ready to the time its last
+    //  operation finished - chains share their tails, so remember the
+    //  origin of every event already walked
+    std::map<Event, long long> origins;
+    Event sink = Event::NO_EVENT;
+    long long best_span = -1;
+    for(std::map<Event, OpInfo>::const_iterator it = ops.begin();
+	it != ops.end();
+	it++) {
+      if(!it->second.known) continue;
+      long long t = lookup_time(trigger_times, it->first);
+      if((t < window_start) || ((window_end >= 0) && (t > window_end)))
+	continue;
+      std::vector<Event> walked;
+      long long origin = t;
+      Event current = it->first;
+      while(current.exists()) {
+	std::map<Event, long long>::const_iterator memo = origins.find(current);
+	if(memo != origins.end()) {
+	  origin = memo->second;
+	  break;
+	}
+	walked.push_back(current);
+	long long ready = -1;
+	current = graph.predecessor(current, window_start, ready);
+	if(ready >= 0)
+	  origin = ready;
+      }
+      for(std::vector<Event>::const_iterator it2 = walked.begin();
+	  it2 != walked.end();
+	  it2++)
+	origins[*it2] = origin;
+      if((t - origin) > best_span) {
+	sink = it->first;
+	best_span = t - origin;
+      }
+    }
+    if(!sink.exists())
+      return 0;
+
+    Event current = sink;
+    while(current.exists()) {
+      std::map<Event, OpInfo>::const_iterator op_it = ops.find(current);
+      if((op_it != ops.end()) && op_it->second.known) {
+	const OpInfo& op = op_it->second;
+	PathEntry entry;
+	entry.kind = op.kind;
+	entry.info = op.info;
+	entry.finish_event = current;
+	entry.start_time = op.start;
+	entry.end_time = op.end;
+	entry.trigger_time = lookup_time(trigger_times, current);
+	entry.ready_time = lookup_time(trigger_times, op.before);
+	if(entry.ready_time < 0)
+	  entry.ready_time = ((op.start >= 0) ? op.start : entry.trigger_time);
+	path.push_back(entry);
+      }
+      long long ready;
+      current = graph.predecessor(current, window_start, ready);
+    }
+
+    std::reverse(path.begin(), path.end());
+    return best_span;
+  }
+
+  /*static*/ void EventTracer::report_critical_path(void)
+  {
+    bool was_enabled = enabled;
+    enabled = false;
+
+    std::vector<PathEntry> path;
+    long long span = compute_critical_path(path);
+
+    long long busy = 0;
+    for(std::vector<PathEntry>::const_iterator it = path.begin();
+	it != path.end();
+	it++)
+      if((it->start_time >= 0) && (it->end_time >= it->start_time))
+	busy += it->end_time - it->start_time;
+
+    log_etrace.print("critical path: %zd operations, span=%lld us, running=%lld us",
+		     path.size(), span / 1000, busy / 1000);
+    for(std::vector<PathEntry>::const_iterator it = path.begin();
+	it != path.end();
+	it++) {
+      long long wait = ((it->start_time >= 0) ? (it->start_time - it->ready_time) : 0);
+      long long run = ((it->end_time >= it->start_time) ? (it->end_time - it->start_time) : 0);
+      if(it->kind == REC_TASK)
+	log_etrace.print() << "  task func=" << it->info << " finish=" << it->finish_event
+			   << " wait=" << (wait / 1000) << " us run=" << (run / 1000) << " us";
+      else
+	log_etrace.print() << "  copy finish=" << it->finish_event
+			   << " wait=" << (wait / 1000) << " us run=" << (run / 1000) << " us";
+    }
+
+    enabled = was_enabled;
+  }
+
+}; // namespace Realm
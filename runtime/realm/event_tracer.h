@@ -0,0 +1,101 @@
+/* Copyright 2015 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// lightweight event graph tracer for Realm
+
+#ifndef REALM_EVENT_TRACER_H
+#define REALM_EVENT_TRACER_H
+
+#include "event.h"
+
+#include <vector>
+
+namespace Realm {
+
+  // Unlike the EVENT_TRACING and EVENT_GRAPH_TRACE builds, the event tracer
+  //  is always compiled in and can be turned on and off while the program
+  //  runs - when it is off each hook is a single test of a flag.  Records
+  //  go into a fixed-size ring buffer owned by the recording thread, so only
+  //  the most recent window of execution is kept.
+  class EventTracer {
+  public:
+    enum RecordKind {
+      REC_CREATE,      // 'event' was created
+      REC_DEPENDENCE,  // 'event' cannot trigger before 'other' has
+      REC_TRIGGER,     // 'event' triggered on this node
+      REC_TASK,        // 'event' is the finish event of a task (info = func id)
+      REC_COPY,        // 'event' is the finish event of a copy
+      REC_OP_START,    // operation with finish event 'event' started running
+      REC_OP_END,      // operation with finish event 'event' stopped running
+    };
+
+    struct Record {
+      long long time;  // in nanoseconds
+      Event event, other;
+      unsigned kind, info;
+    };
+
+    // one operation on a critical path - all times are in nanoseconds and
+    //  ready_time is when the operation's precondition triggered
+    struct PathEntry {
+      unsigned kind;   // REC_TASK or REC_COPY
+      unsigned info;
+      Event finish_event;
+      long long ready_time, start_time, end_time, trigger_time;
+    };
+
+    // sets the ring buffer size for threads that haven't recorded anything
+    //  yet and turns tracing on or off
+    static void configure(bool enable, size_t records_per_thread);
+
+    static void enable_tracing(void);
+    static void disable_tracing(void);
+    static bool is_enabled(void);
+
+    // throws away everything recorded so far
+    static void clear(void);
+
+    static inline void record_create(Event e);
+    static inline void record_dependence(Event e, Event precondition);
+    static inline void record_trigger(Event e);
+    static inline void record_task(Event finish_event, Event before_event,
+				   unsigned func_id);
+    static inline void record_copy(Event finish_event, Event before_event);
+    static inline void record_op_start(Event finish_event);
+    static inline void record_op_end(Event finish_event);
+
+    // finds the chain of tasks and copies that gated the last operation to
+    //  finish in [window_start, window_end] (in nanoseconds, a negative end
+    //  means no limit) - the path is returned from the earliest operation
+    //  to the latest, and the return value is the span of the path
+    // tracing should be disabled while the analysis runs
+    static long long compute_critical_path(std::vector<PathEntry>& path,
+					   long long window_start = 0,
+					   long long window_end = -1);
+
+    // computes the critical path over everything recorded and prints it
+    static void report_critical_path(void);
+
+  protected:
+    static void record(unsigned kind, Event e, Event other, unsigned info);
+
+    static volatile bool enabled;
+  };
+
+}; // namespace Realm
+
+#include "event_tracer.inl"
+
+#endif // REALM_EVENT_TRACER_H
@@ -0,0 +1,76 @@
+/* Copyright 2015 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// INCLDUED FROM event_tracer.h - DO NOT INCLUDE THIS DIRECTLY
+
+// this is a nop, but it's for the benefit of IDEs trying to parse this file
+#include "event_tracer.h"
+
+namespace Realm {
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class EventTracer
+  //
+
+  inline /*static*/ bool EventTracer::is_enabled(void)
+  {
+    return enabled;
+  }
+
+  inline /*static*/ void EventTracer::record_create(Event e)
+  {
+    if(__builtin_expect(enabled, false))
+      record(REC_CREATE, e, Event::NO_EVENT, 0);
+  }
+
+  inline /*static*/ void EventTracer::record_dependence(Event e, Event precondition)
+  {
+    if(__builtin_expect(enabled, false) && precondition.exists())
+      record(REC_DEPENDENCE, e, precondition, 0);
+  }
+
+  inline /*static*/ void EventTracer::record_trigger(Event e)
+  {
+    if(__builtin_expect(enabled, false))
+      record(REC_TRIGGER, e, Event::NO_EVENT, 0);
+  }
+
+  inline /*static*/ void EventTracer::record_task(Event finish_event, Event before_event,
+						  unsigned func_id)
+  {
+    if(__builtin_expect(enabled, false))
+      record(REC_TASK, finish_event, before_event, func_id);
+  }
+
+  inline /*static*/ void EventTracer::record_copy(Event finish_event, Event before_event)
+  {
+    if(__builtin_expect(enabled, false))
+      record(REC_COPY, finish_event, before_event, 0);
+  }
+
+  inline /*static*/ void EventTracer::record_op_start(Event finish_event)
+  {
+    if(__builtin_expect(enabled, false) && finish_event.exists())
+      record(REC_OP_START, finish_event, Event::NO_EVENT, 0);
+  }
+
+  inline /*static*/ void EventTracer::record_op_end(Event finish_event)
+  {
+    if(__builtin_expect(enabled, false) && finish_event.exists())
+      record(REC_OP_END, finish_event, Event::NO_EVENT, 0);
+  }
+
+}; // namespace Realm
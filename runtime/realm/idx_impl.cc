@@ -23,6 +23,14 @@
 #include "mem_impl.h"
 #include "runtime_impl.h"
 
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace Realm {
 
   Logger log_meta("meta");
@@ -558,6 +566,405 @@ namespace Realm {
     }
 
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // bitmap kernels for ElementMask
+  //
+
+    // these work on the 64-bit words of a dense mask; with AVX2 or SSE2
+    //  the bulk of each loop is done a whole vector at a time and only the
+    //  last few words are handled by the scalar tail
+
+#if defined(__AVX2__)
+#define BITMAP_HAS_VECTORS
+    typedef __m256i bitmap_vec_t;
+    static const size_t BITMAP_VEC_WORDS = 4;
+
+    static inline bitmap_vec_t vec_load(const uint64_t *p)
+    { return _mm256_loadu_si256((const __m256i *)p); }
+    static inline void vec_store(uint64_t *p, bitmap_vec_t v)
+    { _mm256_storeu_si256((__m256i *)p, v); }
+    static inline bitmap_vec_t vec_or(bitmap_vec_t a, bitmap_vec_t b)
+    { return _mm256_or_si256(a, b); }
+    static inline bitmap_vec_t vec_and(bitmap_vec_t a, bitmap_vec_t b)
+    { return _mm256_and_si256(a, b); }
+    static inline bitmap_vec_t vec_andnot(bitmap_vec_t a, bitmap_vec_t b)
+    { return _mm256_andnot_si256(b, a); }
+    static inline bool vec_is_zero(bitmap_vec_t a)
+    { return _mm256_testz_si256(a, a); }
+    static inline bool vec_equal(bitmap_vec_t a, bitmap_vec_t b)
+    { return _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)) == -1; }
+#elif defined(__SSE2__)
+#define BITMAP_HAS_VECTORS
+    typedef __m128i bitmap_vec_t;
+    static const size_t BITMAP_VEC_WORDS = 2;
+
+    static inline bitmap_vec_t vec_load(const uint64_t *p)
+    { return _mm_loadu_si128((const __m128i *)p); }
+    static inline void vec_store(uint64_t *p, bitmap_vec_t v)
+    { _mm_storeu_si128((__m128i *)p, v); }
+    static inline bitmap_vec_t vec_or(bitmap_vec_t a, bitmap_vec_t b)
+    { return _mm_or_si128(a, b); }
+    static inline bitmap_vec_t vec_and(bitmap_vec_t a, bitmap_vec_t b)
+    { return _mm_and_si128(a, b); }
+    static inline bitmap_vec_t vec_andnot(bitmap_vec_t a, bitmap_vec_t b)
+    { return _mm_andnot_si128(b, a); }
+    static inline bool vec_is_zero(bitmap_vec_t a)
+    { return _mm_movemask_epi8(_mm_cmpeq_epi8(a, _mm_setzero_si128())) == 0xFFFF; }
+    static inline bool vec_equal(bitmap_vec_t a, bitmap_vec_t b)
+    { return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF; }
+#endif
+
+    struct BitmapOr {
+      static inline uint64_t word(uint64_t a, uint64_t b) { return a | b; }
+#ifdef BITMAP_HAS_VECTORS
+      static inline bitmap_vec_t vec(bitmap_vec_t a, bitmap_vec_t b) { return vec_or(a, b); }
+#endif
+    };
+
+    struct BitmapAnd {
+      static inline uint64_t word(uint64_t a, uint64_t b) { return a & b; }
+#ifdef BITMAP_HAS_VECTORS
+      static inline bitmap_vec_t vec(bitmap_vec_t a, bitmap_vec_t b) { return vec_and(a, b); }
+#endif
+    };
+
+    struct BitmapAndNot {
+      static inline uint64_t word(uint64_t a, uint64_t b) { return a & ~b; }
+#ifdef BITMAP_HAS_VECTORS
+      static inline bitmap_vec_t vec(bitmap_vec_t a, bitmap_vec_t b) { return vec_andnot(a, b); }
+#endif
+    };
+
+    // dst[i] = OP(a[i], b[i]) - dst may be the same as a
+    template <typename OP>
+    static void bitmap_apply(uint64_t *dst, const uint64_t *a,
+			     const uint64_t *b, size_t words)
+    {
+      size_t i = 0;
+#ifdef BITMAP_HAS_VECTORS
+      for(; (i + BITMAP_VEC_WORDS) <= words; i += BITMAP_VEC_WORDS)
+	vec_store(dst + i, OP::vec(vec_load(a + i), vec_load(b + i)));
+#endif
+      for(; i < words; i++)
+	dst[i] = OP::word(a[i], b[i]);
+    }
+
+    static bool bitmap_any(const uint64_t *a, size_t words)
+    {
+      size_t i = 0;
+#ifdef BITMAP_HAS_VECTORS
+      for(; (i + BITMAP_VEC_WORDS) <= words; i += BITMAP_VEC_WORDS)
+	if(!vec_is_zero(vec_load(a + i)))
+	  return true;
+#endif
+      for(; i < words; i++)
+	if(a[i])
+	  return true;
+      return false;
+    }
+
+    static bool bitmap_intersects(const uint64_t *a, const uint64_t *b, size_t words)
+    {
+      size_t i = 0;
+#ifdef BITMAP_HAS_VECTORS
+      for(; (i + BITMAP_VEC_WORDS) <= words; i += BITMAP_VEC_WORDS)
+	if(!vec_is_zero(vec_and(vec_load(a + i), vec_load(b + i))))
+	  return true;
+#endif
+      for(; i < words; i++)
+	if(a[i] & b[i])
+	  return true;
+      return false;
+    }
+
+    static bool bitmap_equal(const uint64_t *a, const uint64_t *b, size_t words)
+    {
+      size_t i = 0;
+#ifdef BITMAP_HAS_VECTORS
+      for(; (i + BITMAP_VEC_WORDS) <= words; i += BITMAP_VEC_WORDS)
+	if(!vec_equal(vec_load(a + i), vec_load(b + i)))
+	  return false;
+#endif
+      for(; i < words; i++)
+	if(a[i] != b[i])
+	  return false;
+      return true;
+    }
+
+    static size_t bitmap_popcount(const uint64_t *a, size_t words)
+    {
+      size_t i = 0;
+      size_t total = 0;
+#if defined(__AVX2__)
+      // nibble lookup through pshufb, summed per 64-bit lane with psadbw
+      const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3,
+					      1, 2, 2, 3, 2, 3, 3, 4,
+					      0, 1, 1, 2, 1, 2, 2, 3,
+					      1, 2, 2, 3, 2, 3, 3, 4);
+      const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+      __m256i acc = _mm256_setzero_si256();
+      for(; (i + 4) <= words; i += 4) {
+	__m256i v = vec_load(a + i);
+	__m256i lo = _mm256_and_si256(v, low_nibbles);
+	__m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibbles);
+	__m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+				      _mm256_shuffle_epi8(lookup, hi));
+	acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+      }
+      total = (_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) +
+	       _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3));
+#endif
+      for(; i < words; i++)
+	total += __builtin_popcountll(a[i]);
+      return total;
+    }
+
+    // number of maximal runs of set bits in the first 'words' words
+    static size_t bitmap_count_runs(const uint64_t *a, size_t words)
+    {
+      // a run starts at every set bit whose predecessor is clear
+      size_t total = 0;
+      uint64_t carry = 0;
+      for(size_t i = 0; i < words; i++) {
+	uint64_t w = a[i];
+	total += __builtin_popcountll(w & ~((w << 1) | carry));
+	carry = w >> 63;
+      }
+      return total;
+    }
+
+    static void bitmap_set_range(uint64_t *a, int first, int last)
+    {
+      int first_word = first >> 6;
+      int last_word = last >> 6;
+      uint64_t lo_mask = ~0ULL << (first & 0x3f);
+      uint64_t hi_mask = ~0ULL >> (63 - (last & 0x3f));
+      if(first_word == last_word) {
+	a[first_word] |= lo_mask & hi_mask;
+	return;
+      }
+      a[first_word] |= lo_mask;
+      if(last_word > (first_word + 1))
+	memset(a + first_word + 1, 0xff, (last_word - first_word - 1) << 3);
+      a[last_word] |= hi_mask;
+    }
+
+    static void bitmap_clear_range(uint64_t *a, int first, int last)
+    {
+      int first_word = first >> 6;
+      int last_word = last >> 6;
+      uint64_t lo_mask = ~0ULL << (first & 0x3f);
+      uint64_t hi_mask = ~0ULL >> (63 - (last & 0x3f));
+      if(first_word == last_word) {
+	a[first_word] &= ~(lo_mask & hi_mask);
+	return;
+      }
+      a[first_word] &= ~lo_mask;
+      if(last_word > (first_word + 1))
+	memset(a + first_word + 1, 0, (last_word - first_word - 1) << 3);
+      a[last_word] &= ~hi_mask;
+    }
+
+    static bool bitmap_any_in_range(const uint64_t *a, int first, int last)
+    {
+      int first_word = first >> 6;
+      int last_word = last >> 6;
+      uint64_t lo_mask = ~0ULL << (first & 0x3f);
+      uint64_t hi_mask = ~0ULL >> (63 - (last & 0x3f));
+      if(first_word == last_word)
+	return (a[first_word] & lo_mask & hi_mask) != 0;
+      if(a[first_word] & lo_mask) return true;
+      if(bitmap_any(a + first_word + 1, last_word - first_word - 1)) return true;
+      return (a[last_word] & hi_mask) != 0;
+    }
+
+    // finds the next run of bits equal to 'polarity' that starts at or
+    //  after 'pos' and ends before 'limit', clipping it at 'limit'
+    static bool bitmap_next_run(const uint64_t *a, int pos, int limit, int polarity,
+				int &run_start, int &run_length)
+    {
+      if(pos >= limit)
+	return false;
+
+      int idx = pos >> 6;
+      uint64_t bits = a[idx];
+      if(!polarity) bits = ~bits;
+      // for the first one, we may have bits to ignore at the start
+      if(pos & 0x3f)
+	bits &= ~((1ULL << (pos & 0x3f)) - 1);
+
+      // skip over words with nothing of interest in them
+      while(!bits) {
+	idx++;
+	if((idx << 6) >= limit)
+	  return false;
+	bits = a[idx];
+	if(!polarity) bits = ~bits;
+      }
+
+      int extra = __builtin_ctzll(bits);
+      run_start = (idx << 6) + extra;
+      if(run_start >= limit)
+	return false;
+
+      // now turn it around and look for the end of the run
+      if(extra)
+	bits |= ((1ULL << extra) - 1);
+      bits = ~bits;
+      while(!bits) {
+	idx++;
+	if((idx << 6) >= limit) {
+	  run_length = limit - run_start;
+	  return true;
+	}
+	bits = a[idx];
+	if(polarity) bits = ~bits;
+      }
+      int run_end = (idx << 6) + __builtin_ctzll(bits);
+      if(run_end > limit)
+	run_end = limit;
+      run_length = run_end - run_start;
+      return true;
+    }
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // run lists for ElementMask
+  //
+
+    // a mask stays a list of (first, last) runs as long as it has only a
+    //  few runs or no more than one run for every RUN_LIST_DENSITY
+    //  elements - past that, the bitmap is both smaller and faster
+    static const size_t RUN_LIST_MIN_RUNS = 8;
+    static const int RUN_LIST_DENSITY = 256;
+
+    static inline bool runs_fit(size_t num_runs, int num_elements)
+    {
+      return ((num_runs <= RUN_LIST_MIN_RUNS) ||
+	      (num_runs <= (size_t)(num_elements / RUN_LIST_DENSITY)));
+    }
+
+    // index of the first run that ends at or after 'pos'
+    static size_t runs_find(const ElementMask::RunList& runs, int pos)
+    {
+      size_t lo = 0, hi = runs.size();
+      while(lo < hi) {
+	size_t mid = (lo + hi) >> 1;
+	if(runs[mid].second < pos)
+	  lo = mid + 1;
+	else
+	  hi = mid;
+      }
+      return lo;
+    }
+
+    static void runs_add(ElementMask::RunList& runs, int first, int last)
+    {
+      // anything that overlaps or touches [first, last] gets merged into it
+      size_t lo = runs_find(runs, first - 1);
+      size_t hi = lo;
+      while((hi < runs.size()) && (runs[hi].first <= (last + 1)))
+	hi++;
+      if(lo == hi) {
+	runs.insert(runs.begin() + lo, std::make_pair(first, last));
+	return;
+      }
+      runs[lo].first = std::min(first, runs[lo].first);
+      runs[lo].second = std::max(last, runs[hi - 1].second);
+      runs.erase(runs.begin() + lo + 1, runs.begin() + hi);
+    }
+
+    static void runs_remove(ElementMask::RunList& runs, int first, int last)
+    {
+      size_t lo = runs_find(runs, first);
+      size_t hi = lo;
+      while((hi < runs.size()) && (runs[hi].first <= last))
+	hi++;
+      if(lo == hi)
+	return;
+      // the ends of the first and last runs we hit may survive
+      std::pair<int,int> head(runs[lo].first, first - 1);
+      std::pair<int,int> tail(last + 1, runs[hi - 1].second);
+      runs.erase(runs.begin() + lo, runs.begin() + hi);
+      if(tail.first <= tail.second)
+	runs.insert(runs.begin() + lo, tail);
+      if(head.first <= head.second)
+	runs.insert(runs.begin() + lo, head);
+    }
+
+    static void runs_union(ElementMask::RunList& result,
+			   const ElementMask::RunList& a, const ElementMask::RunList& b)
+    {
+      result.reserve(a.size() + b.size());
+      size_t i = 0, j = 0;
+      while((i < a.size()) || (j < b.size())) {
+	std::pair<int,int> next;
+	if((j >= b.size()) || ((i < a.size()) && (a[i].first <= b[j].first)))
+	  next = a[i++];
+	else
+	  next = b[j++];
+	if(!result.empty() && (next.first <= (result.back().second + 1)))
+	  result.back().second = std::max(result.back().second, next.second);
+	else
+	  result.push_back(next);
+      }
+    }
+
+    static void runs_intersect(ElementMask::RunList& result,
+			       const ElementMask::RunList& a, const ElementMask::RunList& b)
+    {
+      size_t i = 0, j = 0;
+      while((i < a.size()) && (j < b.size())) {
+	int first = std::max(a[i].first, b[j].first);
+	int last = std::min(a[i].second, b[j].second);
+	if(first <= last)
+	  result.push_back(std::make_pair(first, last));
+	if(a[i].second < b[j].second)
+	  i++;
+	else
+	  j++;
+      }
+    }
+
+    static void runs_subtract(ElementMask::RunList& result,
+			      const ElementMask::RunList& a, const ElementMask::RunList& b)
+    {
+      size_t j = 0;
+      for(size_t i = 0; i < a.size(); i++) {
+	int first = a[i].first;
+	int last = a[i].second;
+	while((j < b.size()) && (b[j].second < first))
+	  j++;
+	// chop out every run of b that overlaps this one
+	size_t k = j;
+	while((k < b.size()) && (b[k].first <= last)) {
+	  if(b[k].first > first)
+	    result.push_back(std::make_pair(first, b[k].first - 1));
+	  first = b[k].second + 1;
+	  if(b[k].second > last)
+	    break;
+	  k++;
+	}
+	if(first <= last)
+	  result.push_back(std::make_pair(first, last));
+      }
+    }
+
+    static bool runs_overlap(const ElementMask::RunList& a, const ElementMask::RunList& b)
+    {
+      size_t i = 0, j = 0;
+      while((i < a.size()) && (j < b.size())) {
+	if(std::max(a[i].first, b[j].first) <= std::min(a[i].second, b[j].second))
+	  return true;
+	if(a[i].second < b[j].second)
+	  i++;
+	else
+	  j++;
+      }
+      return false;
+    }
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class ElementMask
@@ -565,34 +972,22 @@ namespace Realm {
 
     ElementMask::ElementMask(void)
       : first_element(-1), num_elements(-1), memory(Memory::NO_MEMORY), offset(-1),
-	raw_data(0), first_enabled_elmt(-1), last_enabled_elmt(-1)
+	raw_data(0), runs(0), first_enabled_elmt(-1), last_enabled_elmt(-1)
     {
     }
 
     ElementMask::ElementMask(int _num_elements, int _first_element /*= 0*/)
-      : first_element(_first_element), num_elements(_num_elements), memory(Memory::NO_MEMORY), offset(-1), first_enabled_elmt(-1), last_enabled_elmt(-1)
+      : first_element(_first_element), num_elements(_num_elements), memory(Memory::NO_MEMORY), offset(-1),
+	raw_data(0), runs(new RunList), first_enabled_elmt(-1), last_enabled_elmt(-1)
     {
-      size_t bytes_needed = ElementMaskImpl::bytes_needed(first_element, num_elements);
-      raw_data = calloc(1, bytes_needed);
-      //((ElementMaskImpl *)raw_data)->count = num_elements;
-      //((ElementMaskImpl *)raw_data)->offset = first_element;
+      // a new mask is empty, which is one (trivial) run list
     }
 
     ElementMask::ElementMask(const ElementMask &copy_from, 
 			     int _num_elements /*= -1*/, int _first_element /*= 0*/)
+      : raw_data(0), runs(0)
     {
-      first_element = copy_from.first_element;
-      num_elements = copy_from.num_elements;
-      first_enabled_elmt = copy_from.first_enabled_elmt;
-      last_enabled_elmt = copy_from.last_enabled_elmt;
-      size_t bytes_needed = ElementMaskImpl::bytes_needed(first_element, num_elements);
-      raw_data = calloc(1, bytes_needed);
-
-      if(copy_from.raw_data) {
-	memcpy(raw_data, copy_from.raw_data, bytes_needed);
-      } else {
-	get_runtime()->get_memory_impl(copy_from.memory)->get_bytes(copy_from.offset, raw_data, bytes_needed);
-      }
+      copy_contents(copy_from);
     }
 
     ElementMask::~ElementMask(void)
@@ -601,27 +996,56 @@ namespace Realm {
         free(raw_data);
         raw_data = 0;
       }
+      if (runs) {
+	delete runs;
+	runs = 0;
+      }
     }
 
     ElementMask& ElementMask::operator=(const ElementMask &rhs)
     {
-      first_element = rhs.first_element;
-      num_elements = rhs.num_elements;
-      first_enabled_elmt = rhs.first_enabled_elmt;
-      last_enabled_elmt = rhs.last_enabled_elmt;
-      size_t bytes_needed = rhs.raw_size();
-      if (raw_data)
+      if (this == &rhs)
+	return *this;
+      if (raw_data) {
         free(raw_data);
-      raw_data = calloc(1, bytes_needed);
-      if (rhs.raw_data)
-        memcpy(raw_data, rhs.raw_data, bytes_needed);
-      else
-        get_runtime()->get_memory_impl(rhs.memory)->get_bytes(rhs.offset, raw_data, bytes_needed);
+	raw_data = 0;
+      }
+      if (runs) {
+	delete runs;
+	runs = 0;
+      }
+      copy_contents(rhs);
       return *this;
     }
 
+    void ElementMask::copy_contents(const ElementMask &copy_from)
+    {
+      first_element = copy_from.first_element;
+      num_elements = copy_from.num_elements;
+      memory = Memory::NO_MEMORY;
+      offset = -1;
+      first_enabled_elmt = copy_from.first_enabled_elmt;
+      last_enabled_elmt = copy_from.last_enabled_elmt;
+      if(copy_from.runs) {
+	runs = new RunList(*copy_from.runs);
+	return;
+      }
+      size_t bytes_needed = ElementMaskImpl::bytes_needed(first_element, num_elements);
+      raw_data = malloc(bytes_needed);
+
+      if(copy_from.raw_data) {
+	memcpy(raw_data, copy_from.raw_data, bytes_needed);
+      } else {
+	get_runtime()->get_memory_impl(copy_from.memory)->get_bytes(copy_from.offset, raw_data, bytes_needed);
+      }
+    }
+
     void ElementMask::init(int _first_element, int _num_elements, Memory _memory, off_t _offset)
     {
+      if(runs) {
+	delete runs;
+	runs = 0;
+      }
       first_element = _first_element;
       num_elements = _num_elements;
       memory = _memory;
@@ -630,18 +1054,84 @@ namespace Realm {
       raw_data = get_runtime()->get_memory_impl(memory)->get_direct_ptr(offset, bytes_needed);
     }
 
+    void ElementMask::make_dense(void)
+    {
+      if(!runs) return;
+      raw_data = malloc(ElementMaskImpl::bytes_needed(first_element, num_elements));
+      copy_raw(raw_data);
+      delete runs;
+      runs = 0;
+    }
+
+    void ElementMask::copy_raw(void *dst) const
+    {
+      size_t bytes_needed = ElementMaskImpl::bytes_needed(first_element, num_elements);
+      if(!runs) {
+	memcpy(dst, raw_data, bytes_needed);
+	return;
+      }
+      memset(dst, 0, bytes_needed);
+      ElementMaskImpl *impl = (ElementMaskImpl *)dst;
+      for(RunList::const_iterator it = runs->begin(); it != runs->end(); it++)
+	bitmap_set_range(impl->bits, it->first - first_element, it->second - first_element);
+    }
+
+    void ElementMask::choose_representation(void)
+    {
+      if(runs || !raw_data || (memory != Memory::NO_MEMORY)) return;
+      ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
+      const size_t words = (num_elements + 63) >> 6;
+      if(!runs_fit(bitmap_count_runs(impl->bits, words), num_elements))
+	return;
+      RunList *new_runs = new RunList;
+      int pos = 0, run_start, run_length;
+      while(bitmap_next_run(impl->bits, pos, num_elements, 1, run_start, run_length)) {
+	new_runs->push_back(std::make_pair(first_element + run_start,
+					   first_element + run_start + run_length - 1));
+	pos = run_start + run_length;
+      }
+      free(raw_data);
+      raw_data = 0;
+      runs = new_runs;
+      update_enabled_range();
+    }
+
+    void ElementMask::update_enabled_range(void)
+    {
+      first_enabled_elmt = -1;
+      last_enabled_elmt = -1;
+      if(!runs && !raw_data) return;
+      if(runs) {
+	if(!runs->empty()) {
+	  first_enabled_elmt = runs->front().first;
+	  last_enabled_elmt = runs->back().second;
+	}
+	return;
+      }
+      const ElementMaskImpl *impl = (const ElementMaskImpl *)raw_data;
+      const int words = (num_elements + 63) >> 6;
+      int lo = 0;
+      while((lo < words) && !impl->bits[lo]) lo++;
+      if(lo == words) return;
+      int hi = words - 1;
+      while(!impl->bits[hi]) hi--;
+      first_enabled_elmt = first_element + (lo << 6) + __builtin_ctzll(impl->bits[lo]);
+      last_enabled_elmt = first_element + (hi << 6) + 63 - __builtin_clzll(impl->bits[hi]);
+    }
+
     void ElementMask::enable(int start, int count /*= 1*/)
     {
-      if(raw_data != 0) {
+      if(count <= 0) return;
+      if(runs != 0) {
+	runs_add(*runs, start, start + count - 1);
+	if(!runs_fit(runs->size(), num_elements))
+	  make_dense();
+      } else if(raw_data != 0) {
 	ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
 	//printf("ENABLE %p %d %d %d " IDFMT "\n", raw_data, offset, start, count, impl->bits[0]);
 	int pos = start - first_element;
-        assert(pos < num_elements);
-	for(int i = 0; i < count; i++) {
-	  uint64_t *ptr = &(impl->bits[pos >> 6]);
-	  *ptr |= (1ULL << (pos & 0x3f));
-	  pos++;
-	}
+        assert((pos + count) <= num_elements);
+	bitmap_set_range(impl->bits, pos, pos + count - 1);
 	//printf("ENABLED %p %d %d %d " IDFMT "\n", raw_data, offset, start, count, impl->bits[0]);
       } else {
 	//printf("ENABLE(2) " IDFMT " %d %d %d\n", memory.id, offset, start, count);
@@ -668,14 +1158,19 @@ namespace Realm {
 
     void ElementMask::disable(int start, int count /*= 1*/)
     {
-      if(raw_data != 0) {
+      if(count <= 0) return;
+      if(runs != 0) {
+	runs_remove(*runs, start, start + count - 1);
+	// run lists always know exactly where they start and end
+	if(runs_fit(runs->size(), num_elements))
+	  update_enabled_range();
+	else
+	  make_dense();
+	return;
+      } else if(raw_data != 0) {
 	ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
 	int pos = start - first_element;
-	for(int i = 0; i < count; i++) {
-	  uint64_t *ptr = &(impl->bits[pos >> 6]);
-	  *ptr &= ~(1ULL << (pos & 0x3f));
-	  pos++;
-	}
+	bitmap_clear_range(impl->bits, pos, pos + count - 1);
       } else {
 	//printf("DISABLE(2) " IDFMT " %d %d %d\n", memory.id, offset, start, count);
 	MemoryImpl *m_impl = get_runtime()->get_memory_impl(memory);
@@ -701,19 +1196,23 @@ namespace Realm {
 
     int ElementMask::find_enabled(int count /*= 1 */, int start /*= 0*/) const
     {
-      if(start == 0)
+      if((start == 0) && (first_enabled_elmt > 0))
 	start = first_enabled_elmt;
-      if(raw_data != 0) {
+      if(runs != 0) {
+	for(size_t i = runs_find(*runs, start); i < runs->size(); i++) {
+	  int first = std::max((*runs)[i].first, start);
+	  if(((*runs)[i].second - first + 1) >= count)
+	    return first;
+	}
+      } else if(raw_data != 0) {
 	ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
 	//printf("FIND_ENABLED %p %d %d " IDFMT "\n", raw_data, first_element, count, impl->bits[0]);
-	for(int pos = start; pos <= num_elements - count; pos++) {
-	  int run = 0;
-	  while(1) {
-	    uint64_t bit = ((impl->bits[pos >> 6] >> (pos & 0x3f))) & 1;
-	    if(bit != 1) break;
-	    pos++; run++;
-	    if(run >= count) return pos - run;
-	  }
+	int pos = start - first_element;
+	int run_start, run_length;
+	while(bitmap_next_run(impl->bits, pos, num_elements, 1, run_start, run_length)) {
+	  if(run_length >= count)
+	    return first_element + run_start;
+	  pos = run_start + run_length;
 	}
       } else {
 	MemoryImpl *m_impl = get_runtime()->get_memory_impl(memory);
@@ -738,16 +1237,24 @@ namespace Realm {
     {
       if((start == 0) && (first_enabled_elmt > 0))
 	start = first_enabled_elmt;
-      if(raw_data != 0) {
+      if(runs != 0) {
+	// the disabled runs are the gaps between the enabled ones
+	int gap_start = start;
+	for(size_t i = runs_find(*runs, start); i < runs->size(); i++) {
+	  if(((*runs)[i].first - gap_start) >= count)
+	    return gap_start;
+	  gap_start = std::max(gap_start, (*runs)[i].second + 1);
+	}
+	if((first_element + num_elements - gap_start) >= count)
+	  return gap_start;
+      } else if(raw_data != 0) {
 	ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
-	for(int pos = start; pos <= num_elements - count; pos++) {
-	  int run = 0;
-	  while(1) {
-	    uint64_t bit = ((impl->bits[pos >> 6] >> (pos & 0x3f))) & 1;
-	    if(bit != 0) break;
-	    pos++; run++;
-	    if(run >= count) return pos - run;
-	  }
+	int pos = start - first_element;
+	int run_start, run_length;
+	while(bitmap_next_run(impl->bits, pos, num_elements, 0, run_start, run_length)) {
+	  if(run_length >= count)
+	    return first_element + run_start;
+	  pos = run_start + run_length;
 	}
       } else {
 	assert(0);
@@ -762,6 +1269,9 @@ namespace Realm {
 
     const void *ElementMask::get_raw(void) const
     {
+      // a const mask may be shared between threads, so a run list is never
+      //  expanded in place here - use make_dense() or copy_raw() instead
+      assert(runs == 0);
       return raw_data;
     }
 
@@ -772,7 +1282,10 @@ namespace Realm {
 
     bool ElementMask::is_set(int ptr) const
     {
-      if(raw_data != 0) {
+      if(runs != 0) {
+	size_t idx = runs_find(*runs, ptr);
+	return ((idx < runs->size()) && ((*runs)[idx].first <= ptr));
+      } else if(raw_data != 0) {
 	ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
 	
 	int pos = ptr;// - first_element;
@@ -795,32 +1308,182 @@ namespace Realm {
     size_t ElementMask::pop_count(bool enabled) const
     {
       size_t count = 0;
-      if (raw_data != 0) {
+      if (runs != 0) {
+	for (RunList::const_iterator it = runs->begin(); it != runs->end(); it++)
+	  count += it->second - it->first + 1;
+      } else if (raw_data != 0) {
         ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
-        int max_full = (num_elements >> 6);
-        bool remainder = (num_elements % 64) != 0;
-        for (int index = 0; index < max_full; index++)
-          count += __builtin_popcountll(impl->bits[index]);
-        if (remainder)
-          count += __builtin_popcountll(impl->bits[max_full]);
-        if (!enabled)
-          count = num_elements - count;
+	count = bitmap_popcount(impl->bits, (num_elements + 63) >> 6);
       } else {
         // TODO: implement this
         assert(0);
       }
+      if (!enabled)
+	count = num_elements - count;
       return count;
     }
 
+    size_t ElementMask::pop_count_range(int start, int count) const
+    {
+      if(count <= 0) return 0;
+      if(runs != 0) {
+	const int last = start + count - 1;
+	size_t total = 0;
+	for(size_t i = runs_find(*runs, start);
+	    (i < runs->size()) && ((*runs)[i].first <= last);
+	    i++)
+	  total += (std::min((*runs)[i].second, last) -
+		    std::max((*runs)[i].first, start) + 1);
+	return total;
+      }
+      assert(raw_data != 0);
+      const ElementMaskImpl *impl = (const ElementMaskImpl *)raw_data;
+      int pos = start - first_element;
+      int last = pos + count - 1;
+      assert((pos >= 0) && (last < num_elements));
+      int first_word = pos >> 6;
+      int last_word = last >> 6;
+      uint64_t lo_mask = ~0ULL << (pos & 0x3f);
+      uint64_t hi_mask = ~0ULL >> (63 - (last & 0x3f));
+      if(first_word == last_word)
+	return __builtin_popcountll(impl->bits[first_word] & lo_mask & hi_mask);
+      size_t total = __builtin_popcountll(impl->bits[first_word] & lo_mask);
+      total += bitmap_popcount(impl->bits + first_word + 1, last_word - first_word - 1);
+      total += __builtin_popcountll(impl->bits[last_word] & hi_mask);
+      return total;
+    }
+
+    int ElementMask::find_nth_enabled(size_t skip, int start /*= 0*/) const
+    {
+      if(runs != 0) {
+	for(size_t i = runs_find(*runs, start); i < runs->size(); i++) {
+	  int first = std::max((*runs)[i].first, start);
+	  size_t length = (*runs)[i].second - first + 1;
+	  if(skip < length)
+	    return first + (int)skip;
+	  skip -= length;
+	}
+	return -1;
+      }
+      assert(raw_data != 0);
+      const ElementMaskImpl *impl = (const ElementMaskImpl *)raw_data;
+      int pos = start - first_element;
+      if(pos < 0) pos = 0;
+      if(pos >= num_elements) return -1;
+      const int num_words = (num_elements + 63) >> 6;
+      int w = pos >> 6;
+      uint64_t bits = impl->bits[w] & (~0ULL << (pos & 0x3f));
+      // skip whole words by their population counts, then drop set bits
+      //  from the word that holds the one we want
+      while(1) {
+	size_t n = __builtin_popcountll(bits);
+	if(skip < n) {
+	  for(size_t i = 0; i < skip; i++)
+	    bits &= bits - 1;
+	  return first_element + (w << 6) + __builtin_ctzll(bits);
+	}
+	skip -= n;
+	if(++w >= num_words) return -1;
+	bits = impl->bits[w];
+      }
+    }
+
+    void ElementMask::enable_from(const ElementMask &other, int start, int count)
+    {
+      if(count <= 0) return;
+      assert((first_element == other.first_element) &&
+	     (num_elements == other.num_elements));
+      const int last = start + count - 1;
+      if(other.runs != 0) {
+	for(size_t i = runs_find(*other.runs, start);
+	    (i < other.runs->size()) && ((*other.runs)[i].first <= last);
+	    i++) {
+	  int first = std::max((*other.runs)[i].first, start);
+	  enable(first, std::min((*other.runs)[i].second, last) - first + 1);
+	}
+	return;
+      }
+      assert(other.raw_data != 0);
+      const ElementMaskImpl *other_impl = (const ElementMaskImpl *)other.raw_data;
+      if(runs != 0) {
+	// stay a run list if the runs we'd pick up still leave us small
+	//  enough, counting them without building anything first
+	size_t budget = runs->size();
+	int pos = start - first_element, run_start, run_length;
+	while(runs_fit(budget, num_elements) &&
+	      bitmap_next_run(other_impl->bits, pos, last - first_element + 1, 1,
+			      run_start, run_length)) {
+	  budget++;
+	  pos = run_start + run_length;
+	}
+	if(runs_fit(budget, num_elements)) {
+	  pos = start - first_element;
+	  while(bitmap_next_run(other_impl->bits, pos, last - first_element + 1, 1,
+				run_start, run_length)) {
+	    enable(first_element + run_start, run_length);
+	    pos = run_start + run_length;
+	  }
+	  return;
+	}
+	make_dense();
+      }
+      assert(raw_data != 0);
+      ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
+      int pos = start - first_element;
+      int last_pos = last - first_element;
+      assert((pos >= 0) && (last_pos < num_elements));
+      int first_word = pos >> 6;
+      int last_word = last_pos >> 6;
+      uint64_t lo_mask = ~0ULL << (pos & 0x3f);
+      uint64_t hi_mask = ~0ULL >> (63 - (last_pos & 0x3f));
+      // the interior words go through the vector kernel; the partial
+      //  words at either end are masked by hand
+      int first_set = -1, last_set = -1;
+      uint64_t head = other_impl->bits[first_word] & lo_mask;
+      if(first_word == last_word) head &= hi_mask;
+      impl->bits[first_word] |= head;
+      if(last_word > first_word) {
+	bitmap_apply<BitmapOr>(impl->bits + first_word + 1,
+			       impl->bits + first_word + 1,
+			       other_impl->bits + first_word + 1,
+			       last_word - first_word - 1);
+	impl->bits[last_word] |= other_impl->bits[last_word] & hi_mask;
+      }
+      // the enabled range only needs the first and last set bits we copied
+      for(int w = first_word; w <= last_word; w++) {
+	uint64_t bits = other_impl->bits[w];
+	if(w == first_word) bits &= lo_mask;
+	if(w == last_word) bits &= hi_mask;
+	if(bits) {
+	  first_set = first_element + (w << 6) + __builtin_ctzll(bits);
+	  break;
+	}
+      }
+      if(first_set < 0) return;
+      for(int w = last_word; w >= first_word; w--) {
+	uint64_t bits = other_impl->bits[w];
+	if(w == first_word) bits &= lo_mask;
+	if(w == last_word) bits &= hi_mask;
+	if(bits) {
+	  last_set = first_element + (w << 6) + 63 - __builtin_clzll(bits);
+	  break;
+	}
+      }
+
+      if((first_enabled_elmt < 0) || (first_set < first_enabled_elmt))
+	first_enabled_elmt = first_set;
+
+      if((last_enabled_elmt < 0) || (last_set > last_enabled_elmt))
+	last_enabled_elmt = last_set;
+    }
+
     bool ElementMask::operator!(void) const
     {
-      if (raw_data != 0) {
+      if (runs != 0) {
+	return runs->empty();
+      } else if (raw_data != 0) {
         ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
-        const int max_full = ((num_elements+63) >> 6);
-        for (int index = 0; index < max_full; index++) {
-          if (impl->bits[index])
-            return false;
-        }
+	return !bitmap_any(impl->bits, (num_elements + 63) >> 6);
       } else {
         // TODO: implement this
         assert(0);
@@ -832,20 +1495,27 @@ namespace Realm {
     {
       if (num_elements != other.num_elements)
         return false;
-      if (raw_data != 0) {
-        ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
-        if (other.raw_data != 0) {
-          ElementMaskImpl *other_impl = (ElementMaskImpl *)other.raw_data;
-          const int max_full = ((num_elements+63) >> 6);
-          for (int index = 0; index < max_full; index++)
-          {
-            if (impl->bits[index] != other_impl->bits[index])
-              return false;
-          }
-        } else {
-          // TODO: Implement this
-          assert(false);
-        }
+      if ((runs != 0) && (other.runs != 0))
+	return (*runs == *other.runs);
+      if ((runs != 0) || (other.runs != 0)) {
+	// mixed representations - compare the enabled runs of each
+	ElementMask::Enumerator e1(*this, 0, 1), e2(other, 0, 1);
+	int pos1, len1, pos2, len2;
+	while (true) {
+	  bool more1 = e1.get_next(pos1, len1);
+	  bool more2 = e2.get_next(pos2, len2);
+	  if (more1 != more2)
+	    return false;
+	  if (!more1)
+	    return true;
+	  if ((pos1 != pos2) || (len1 != len2))
+	    return false;
+	}
+      }
+      if ((raw_data != 0) && (other.raw_data != 0)) {
+	ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
+	ElementMaskImpl *other_impl = (ElementMaskImpl *)other.raw_data;
+	return bitmap_equal(impl->bits, other_impl->bits, (num_elements + 63) >> 6);
       } else {
         // TODO: Implement this
         assert(false);
@@ -858,156 +1528,235 @@ namespace Realm {
       return !((*this) == other);
     }
 
+    // the binary operators build their result in whichever form the
+    //  operands are in and then let it pick the cheaper representation
+    // the bitmap of a mask that may be shared, expanding a run list into
+    //  'scratch' (which the caller frees) rather than into the mask itself
+    static const ElementMaskImpl *shared_bitmap(const ElementMask& m, void *&scratch)
+    {
+      if(m.runs == 0)
+	return (const ElementMaskImpl *)m.raw_data;
+      scratch = malloc(ElementMaskImpl::bytes_needed(m.first_element, m.num_elements));
+      m.copy_raw(scratch);
+      return (const ElementMaskImpl *)scratch;
+    }
+
+    template <typename OP>
+    static ElementMask combine_dense(const ElementMask& a, const ElementMask& b)
+    {
+      assert(a.num_elements == b.num_elements);
+      ElementMask result(a.num_elements, a.first_element);
+      delete result.runs;
+      result.runs = 0;
+      result.raw_data = malloc(ElementMaskImpl::bytes_needed(a.first_element,
+							     a.num_elements));
+      void *a_scratch = 0, *b_scratch = 0;
+      bitmap_apply<OP>(((ElementMaskImpl *)result.raw_data)->bits,
+		       shared_bitmap(a, a_scratch)->bits,
+		       shared_bitmap(b, b_scratch)->bits,
+		       (a.num_elements + 63) >> 6);
+      free(a_scratch);
+      free(b_scratch);
+      result.choose_representation();
+      if(result.runs == 0)
+	result.update_enabled_range();
+      return result;
+    }
+
     ElementMask ElementMask::operator|(const ElementMask &other) const
     {
-      ElementMask result(num_elements);
-      ElementMaskImpl *target = (ElementMaskImpl *)result.raw_data;
-      if (raw_data != 0) {
-        ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
-        if (other.raw_data != 0) {
-          ElementMaskImpl *other_impl = (ElementMaskImpl *)other.raw_data;
-          assert(num_elements == other.num_elements);
-          const int max_full = ((num_elements+63) >> 6);
-          for (int index = 0; index < max_full; index++) {
-            target->bits[index] = impl->bits[index] | other_impl->bits[index]; 
-          }
-        } else {
-          // TODO implement this
-          assert(0);
-        }
-      } else {
-        // TODO: implement this
-        assert(0);
-      }
+      if ((runs == 0) && (other.runs == 0))
+	return combine_dense<BitmapOr>(*this, other);
+      ElementMask result(*this);
+      result |= other;
+      result.choose_representation();
       return result;
     }
 
     ElementMask ElementMask::operator&(const ElementMask &other) const
     {
-      ElementMask result(num_elements);
-      ElementMaskImpl *target = (ElementMaskImpl *)result.raw_data;
-      if (raw_data != 0) {
-        ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
-        if (other.raw_data != 0) {
-          ElementMaskImpl *other_impl = (ElementMaskImpl *)other.raw_data;
-          assert(num_elements == other.num_elements);
-          const int max_full = ((num_elements+63) >> 6);
-          for (int index = 0; index < max_full; index++) {
-            target->bits[index] = impl->bits[index] & other_impl->bits[index];
-          }
-        } else {
-          // TODO: implement this
-          assert(0);
-        }
-      } else {
-        // TODO: implement this
-        assert(0);
-      }
+      if ((runs == 0) && (other.runs == 0))
+	return combine_dense<BitmapAnd>(*this, other);
+      // keep the result a run list if either side is one
+      ElementMask result(runs ? *this : other);
+      result &= (runs ? other : *this);
+      result.choose_representation();
       return result;
     }
 
     ElementMask ElementMask::operator-(const ElementMask &other) const
     {
-      ElementMask result(num_elements);
-      ElementMaskImpl *target = (ElementMaskImpl *)result.raw_data;
-      if (raw_data != 0) {
-        ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
-        if (other.raw_data != 0) {
-          ElementMaskImpl *other_impl = (ElementMaskImpl *)other.raw_data;
-          assert(num_elements == other.num_elements);
-          const int max_full = ((num_elements+63) >> 6);
-          for (int index = 0; index < max_full; index++) {
-            target->bits[index] = impl->bits[index] & ~(other_impl->bits[index]);
-          }
-        } else {
-          // TODO: implement this
-          assert(0);
-        }
-      } else {
-        // TODO: implement this
-        assert(0);
-      }
+      if ((runs == 0) && (other.runs == 0))
+	return combine_dense<BitmapAndNot>(*this, other);
+      ElementMask result(*this);
+      result -= other;
+      result.choose_representation();
       return result;
     }
 
     ElementMask& ElementMask::operator|=(const ElementMask &other)
     {
-      if (raw_data != 0) {
+      assert(num_elements == other.num_elements);
+      if (other.runs != 0) {
+	if (runs != 0) {
+	  RunList *result = new RunList;
+	  runs_union(*result, *runs, *other.runs);
+	  delete runs;
+	  runs = result;
+	  if (!runs_fit(runs->size(), num_elements))
+	    make_dense();
+	} else {
+	  assert(raw_data != 0);
+	  ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
+	  for (RunList::const_iterator it = other.runs->begin();
+	       it != other.runs->end(); it++)
+	    bitmap_set_range(impl->bits, it->first - first_element,
+			     it->second - first_element);
+	}
+      } else if (other.raw_data != 0) {
+	make_dense();
+	assert(raw_data != 0);
         ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
-        if (other.raw_data != 0) {
-          ElementMaskImpl *other_impl = (ElementMaskImpl *)other.raw_data;
-          assert(num_elements == other.num_elements);
-          const int max_full = ((num_elements+63) >> 6);
-          for (int index = 0; index < max_full; index++) {
-            impl->bits[index] |= other_impl->bits[index];
-          }
-        } else {
-          // TODO: implement this
-          assert(0);
-        }
+	ElementMaskImpl *other_impl = (ElementMaskImpl *)other.raw_data;
+	bitmap_apply<BitmapOr>(impl->bits, impl->bits, other_impl->bits,
+			       (num_elements + 63) >> 6);
       } else {
-        // TODO: implement this
-        assert(0);
+	// TODO: implement this
+	assert(0);
+      }
+      if (other.first_enabled_elmt >= 0) {
+	if ((first_enabled_elmt < 0) || (other.first_enabled_elmt < first_enabled_elmt))
+	  first_enabled_elmt = other.first_enabled_elmt;
+	if (other.last_enabled_elmt > last_enabled_elmt)
+	  last_enabled_elmt = other.last_enabled_elmt;
       }
       return *this;
     }
 
     ElementMask& ElementMask::operator&=(const ElementMask &other)
     {
-      if (raw_data != 0) {
+      assert(num_elements == other.num_elements);
+      if (runs != 0) {
+	RunList *result = new RunList;
+	if (other.runs != 0) {
+	  runs_intersect(*result, *runs, *other.runs);
+	} else {
+	  // keep the pieces of each of our runs that are set in other
+	  assert(other.raw_data != 0);
+	  const ElementMaskImpl *other_impl = (const ElementMaskImpl *)other.raw_data;
+	  for (RunList::const_iterator it = runs->begin(); it != runs->end(); it++) {
+	    int pos = it->first - first_element, run_start, run_length;
+	    while (bitmap_next_run(other_impl->bits, pos, it->second - first_element + 1,
+				   1, run_start, run_length)) {
+	      result->push_back(std::make_pair(first_element + run_start,
+					       first_element + run_start + run_length - 1));
+	      pos = run_start + run_length;
+	    }
+	  }
+	}
+	delete runs;
+	runs = result;
+	if (runs_fit(runs->size(), num_elements)) {
+	  update_enabled_range();
+	  return *this;
+	}
+	make_dense();
+      } else if (other.runs != 0) {
+	// clear everything in the gaps between other's runs
+	assert(raw_data != 0);
+	ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
+	int gap_start = first_element;
+	for (RunList::const_iterator it = other.runs->begin();
+	     it != other.runs->end(); it++) {
+	  if (it->first > gap_start)
+	    bitmap_clear_range(impl->bits, gap_start - first_element,
+			       it->first - 1 - first_element);
+	  gap_start = it->second + 1;
+	}
+	if (gap_start < (first_element + num_elements))
+	  bitmap_clear_range(impl->bits, gap_start - first_element, num_elements - 1);
+      } else if ((raw_data != 0) && (other.raw_data != 0)) {
         ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
-        if (other.raw_data != 0) {
-          ElementMaskImpl *other_impl = (ElementMaskImpl *)other.raw_data;
-          assert(num_elements == other.num_elements);
-          const int max_full = ((num_elements+63) >> 6);
-          for (int index = 0; index < max_full; index++) {
-            impl->bits[index] &= other_impl->bits[index];
-          }
-        } else {
-          // TODO: implement this
-          assert(0);
-        }
+	ElementMaskImpl *other_impl = (ElementMaskImpl *)other.raw_data;
+	bitmap_apply<BitmapAnd>(impl->bits, impl->bits, other_impl->bits,
+				(num_elements + 63) >> 6);
       } else {
-        // TODO: implement this
-        assert(0);
+	// TODO: implement this
+	assert(0);
       }
+      update_enabled_range();
       return *this;
     }
 
     ElementMask& ElementMask::operator-=(const ElementMask &other)
     {
-      if (raw_data != 0) {
+      assert(num_elements == other.num_elements);
+      if (other.runs != 0) {
+	if (runs != 0) {
+	  RunList *result = new RunList;
+	  runs_subtract(*result, *runs, *other.runs);
+	  delete runs;
+	  runs = result;
+	  if (runs_fit(runs->size(), num_elements)) {
+	    update_enabled_range();
+	    return *this;
+	  }
+	  make_dense();
+	} else {
+	  assert(raw_data != 0);
+	  ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
+	  for (RunList::const_iterator it = other.runs->begin();
+	       it != other.runs->end(); it++)
+	    bitmap_clear_range(impl->bits, it->first - first_element,
+			       it->second - first_element);
+	}
+      } else if (other.raw_data != 0) {
+	make_dense();
+	assert(raw_data != 0);
         ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
-        if (other.raw_data != 0) {
-          ElementMaskImpl *other_impl = (ElementMaskImpl *)other.raw_data;
-          assert(num_elements == other.num_elements);
-          const int max_full = ((num_elements+63) >> 6);
-          for (int index = 0; index < max_full; index++) {
-            impl->bits[index] &= ~(other_impl->bits[index]);
-          }
-        } else {
-          // TODO: implement this
-          assert(0);
-        }
+	ElementMaskImpl *other_impl = (ElementMaskImpl *)other.raw_data;
+	bitmap_apply<BitmapAndNot>(impl->bits, impl->bits, other_impl->bits,
+				   (num_elements + 63) >> 6);
       } else {
-        // TODO: implement this
-        assert(0);
+	// TODO: implement this
+	assert(0);
       }
+      update_enabled_range();
       return *this;
     }
 
     ElementMask::OverlapResult ElementMask::overlaps_with(const ElementMask& other,
 							  off_t max_effort /*= -1*/) const
     {
+      // quick out if the enabled ranges don't even touch
+      if ((first_enabled_elmt >= 0) && (other.first_enabled_elmt >= 0) &&
+	  (last_enabled_elmt >= 0) && (other.last_enabled_elmt >= 0) &&
+	  ((last_enabled_elmt < other.first_enabled_elmt) ||
+	   (other.last_enabled_elmt < first_enabled_elmt)) &&
+	  ((runs != 0) || (other.runs != 0)))
+	return ElementMask::OVERLAP_NO;
+      if ((runs != 0) && (other.runs != 0))
+	return (runs_overlap(*runs, *other.runs) ?
+		  ElementMask::OVERLAP_YES : ElementMask::OVERLAP_NO);
+      if ((runs != 0) || (other.runs != 0)) {
+	const RunList& run_list = (runs ? *runs : *other.runs);
+	const ElementMask& dense = (runs ? other : *this);
+	if (dense.raw_data == 0)
+	  return ElementMask::OVERLAP_MAYBE;
+	const ElementMaskImpl *impl = (const ElementMaskImpl *)dense.raw_data;
+	for (RunList::const_iterator it = run_list.begin(); it != run_list.end(); it++)
+	  if (bitmap_any_in_range(impl->bits, it->first - first_element,
+				  it->second - first_element))
+	    return ElementMask::OVERLAP_YES;
+	return ElementMask::OVERLAP_NO;
+      }
       if (raw_data != 0) {
         ElementMaskImpl *i1 = (ElementMaskImpl *)raw_data;
         if (other.raw_data != 0) {
           ElementMaskImpl *i2 = (ElementMaskImpl *)(other.raw_data);
           assert(num_elements == other.num_elements);
-          for(int i = 0; i < (num_elements + 63) >> 6; i++)
-            if((i1->bits[i] & i2->bits[i]) != 0)
-              return ElementMask::OVERLAP_YES;
-          return ElementMask::OVERLAP_NO;
+	  return (bitmap_intersects(i1->bits, i2->bits, (num_elements + 63) >> 6) ?
+		    ElementMask::OVERLAP_YES : ElementMask::OVERLAP_NO);
         } else {
           return ElementMask::OVERLAP_MAYBE;
         }
@@ -1033,68 +1782,58 @@ namespace Realm {
 
     bool ElementMask::Enumerator::get_next(int &position, int &length)
     {
-      if(mask.raw_data != 0) {
+      if(mask.runs != 0) {
+	const RunList& runs = *(mask.runs);
+	const int end = mask.first_element + mask.num_elements;
+	if(pos >= end)
+	  return false;
+	size_t idx = runs_find(runs, pos);
+	if(polarity) {
+	  if(idx >= runs.size()) {
+	    pos = end;
+	    return false;
+	  }
+	  position = std::max(runs[idx].first, pos);
+	  length = runs[idx].second - position + 1;
+	  pos = runs[idx].second + 1;
+	  return true;
+	}
+	// disabled runs are the gaps - step past the run we're in, if any
+	if((idx < runs.size()) && (runs[idx].first <= pos)) {
+	  pos = runs[idx].second + 1;
+	  idx++;
+	  if(pos >= end)
+	    return false;
+	}
+	position = pos;
+	pos = ((idx < runs.size()) ? runs[idx].first : end);
+	length = pos - position;
+	return true;
+      } else if(mask.raw_data != 0) {
 	ElementMaskImpl *impl = (ElementMaskImpl *)(mask.raw_data);
 
 	// are we already off the end?
 	if(pos >= mask.num_elements)
 	  return false;
 
-        // if our current pos is below the first known-set element, skip to there
-        if((mask.first_enabled_elmt > 0) && (pos < mask.first_enabled_elmt))
-          pos = mask.first_enabled_elmt;
-
-	// fetch first value and see if we have any bits set
-	int idx = pos >> 6;
-	uint64_t bits = impl->bits[idx];
-	if(!polarity) bits = ~bits;
-
-	// for the first one, we may have bits to ignore at the start
-	if(pos & 0x3f)
-	  bits &= ~((1ULL << (pos & 0x3f)) - 1);
-
-	// skip over words that are all zeros, and try to ignore trailing zeros completely
-        int stop_at = mask.num_elements;
-        if(mask.last_enabled_elmt >= 0)
-          stop_at = mask.last_enabled_elmt+1;
-	while(!bits) {
-	  idx++;
-	  if((idx << 6) >= stop_at) {
-	    pos = mask.num_elements; // so we don't scan again
-	    return false;
-	  }
-	  bits = impl->bits[idx];
-	  if(!polarity) bits = ~bits;
+	// when looking for set bits, the known enabled range lets us skip
+	//  whole stretches of zeros at either end
+	int stop_at = mask.num_elements;
+	if(polarity) {
+	  if((mask.first_enabled_elmt > 0) && (pos < mask.first_enabled_elmt))
+	    pos = mask.first_enabled_elmt;
+	  if(mask.last_enabled_elmt >= 0)
+	    stop_at = std::min(stop_at, mask.last_enabled_elmt + 1);
 	}
 
-	// if we get here, we've got at least one good bit
-	int extra = __builtin_ctzll(bits);
-	assert(extra < 64);
-	position = (idx << 6) + extra;
-	
-	// now we're going to turn it around and scan ones
-	if(extra)
-	  bits |= ((1ULL << extra) - 1);
-	bits = ~bits;
-
-	while(!bits) {
-	  idx++;
-	  // did our 1's take us right to the end?
-	  if((idx << 6) >= mask.num_elements) {
-	    pos = mask.num_elements; // so we don't scan again
-	    length = mask.num_elements - position;
-	    return true;
-	  }
-	  bits = ~impl->bits[idx]; // note the inversion
-	  if(!polarity) bits = ~bits;
+	int run_start, run_length;
+	if(!bitmap_next_run(impl->bits, pos, stop_at, polarity, run_start, run_length)) {
+	  pos = mask.num_elements; // so we don't scan again
+	  return false;
 	}
-
-	// if we get here, we got to the end of the 1's
-	int extra2 = __builtin_ctzll(bits);
-	pos = (idx << 6) + extra2;
-	if(pos >= mask.num_elements)
-	  pos = mask.num_elements;
-	length = pos - position;
+	position = run_start;
+	length = run_length;
+	pos = run_start + run_length;
 	return true;
       } else {
 	assert(0);
@@ -1239,6 +1978,8 @@ namespace Realm {
 	}
 	
 	valid_mask = new ElementMask(num_elmts);
+	// the data messages fill in the bitmap directly
+	valid_mask->make_dense();
 	valid_mask_owner = ID(me).node(); // a good guess?
 	valid_mask_count = (valid_mask->raw_size() + 2047) >> 11;
 	valid_mask_complete = false;
@@ -1318,18 +2059,30 @@ namespace Realm {
     IndexSpaceImpl *r_impl = get_runtime()->get_index_space_impl(args.is);
 
     assert(r_impl->valid_mask);
-    const char *mask_data = (const char *)(r_impl->valid_mask->get_raw());
+    const ElementMask *valid_mask = r_impl->valid_mask;
+    size_t mask_len = valid_mask->raw_size();
+
+    // other threads may be reading the mask too, so a run list is sent
+    //  from an expanded copy rather than being made dense in place
+    char *scratch = 0;
+    int payload_mode = PAYLOAD_KEEP;
+    if(valid_mask->runs) {
+      scratch = (char *)malloc(mask_len);
+      valid_mask->copy_raw(scratch);
+      payload_mode = PAYLOAD_COPY;
+    }
+    const char *mask_data = (scratch ?
+			     scratch :
+			     (const char *)(valid_mask->get_raw()));
     assert(mask_data);
 
-    size_t mask_len = r_impl->valid_mask->raw_size();
-
     // send data in 2KB blocks
     unsigned block_id = 0;
     while(mask_len >= (1 << 11)) {
       ValidMaskDataMessage::send_request(args.sender, args.is, block_id,
 					 mask_data,
 					 1 << 11,
-					 PAYLOAD_KEEP);
+					 payload_mode);
       mask_data += 1 << 11;
       mask_len -= 1 << 11;
       block_id++;
@@ -1338,8 +2091,9 @@ namespace Realm {
       ValidMaskDataMessage::send_request(args.sender, args.is, block_id,
 					 mask_data,
 					 mask_len,
-					 PAYLOAD_KEEP);
+					 payload_mode);
     }
+    free(scratch);
   }
 
   /*static*/ void ValidMaskRequestMessage::send_request(gasnet_node_t target,
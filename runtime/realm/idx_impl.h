@@ -25,6 +25,8 @@
 
 #include "rsrv_impl.h"
 
+#include <stdint.h>
+
 namespace Realm {
 
     struct ElementMaskImpl {
@@ -29,12 +29,21 @@
 #include "lowlevel_config.h"
 #include "arrays.h"
 
+#include <vector>
+#include <utility>
+
 namespace Realm {
 
   class ProfilingRequestSet;
 
+    // an ElementMask is either a bitmap or, when it has few enough runs of
+    //  enabled elements, a sorted list of (first, last) runs - operations
+    //  switch between the two as needed and callers never need to care,
+    //  except that get_raw() is only allowed on a mask in bitmap form
     class ElementMask {
     public:
+      typedef std::vector<std::pair<int,int> > RunList;
+
       ElementMask(void);
       explicit ElementMask(int num_elements, int first_element = 0);
       ElementMask(const ElementMask &copy_from, int num_elements = -1, int first_element = 0);
@@ -52,6 +61,14 @@ namespace Realm {
 
       bool is_set(int ptr) const;
       size_t pop_count(bool enabled = true) const;
+      // number of enabled elements in [start, start + count)
+      size_t pop_count_range(int start, int count) const;
+      // position of the enabled element that has 'skip' enabled elements
+      //  before it at or after 'start', or -1 if there aren't enough
+      int find_nth_enabled(size_t skip, int start = 0) const;
+      // enables each element of [start, start + count) that is enabled in
+      //  'other', which must cover the same elements as this mask
+      void enable_from(const ElementMask &other, int start, int count);
       bool operator!(void) const;
       bool operator==(const ElementMask &other) const;
       bool operator!=(const ElementMask &other) const;
@@ -96,6 +113,17 @@ namespace Realm {
       size_t raw_size(void) const;
       const void *get_raw(void) const;
       void set_raw(const void *data);
+      // writes the bitmap form of the mask (raw_size() bytes) to 'dst'
+      //  without changing the mask, so it is safe on a shared mask
+      void copy_raw(void *dst) const;
+
+      // representation management - make_dense() expands a run list into
+      //  a bitmap, choose_representation() switches a bitmap to a run list
+      //  if that would be cheaper, and update_enabled_range() recomputes
+      //  first/last_enabled_elmt exactly
+      void make_dense(void);
+      void choose_representation(void);
+      void update_enabled_range(void);
 
       // Implementations below
       template <class T>
@@ -119,9 +147,20 @@ namespace Realm {
       Memory memory;
       off_t offset;
       void *raw_data;
+      RunList *runs;
       int first_enabled_elmt, last_enabled_elmt;
+
+    protected:
+      void copy_contents(const ElementMask &copy_from);
     };
 
+    // masks can be packed into any of the Realm serializers - run lists are
+    //  sent as runs, so a mostly-contiguous mask stays small on the wire
+    template <typename S>
+    bool operator<<(S& s, const ElementMask& mask);
+    template <typename S>
+    bool operator>>(S& s, ElementMask& mask);
+
     class IndexSpaceAllocator;
     class DomainPoint;
     class Domain;
@@ -994,6 +1033,53 @@ namespace Realm {
 
     // Implementations for template functions
 
+    template <typename S>
+    bool operator<<(S& s, const ElementMask& mask)
+    {
+      if(!((s << mask.first_element) && (s << mask.num_elements) &&
+	   (s << mask.first_enabled_elmt) && (s << mask.last_enabled_elmt)))
+	return false;
+      if(mask.runs) {
+	if(!((s << (int)1) && (s << mask.runs->size())))
+	  return false;
+	for(ElementMask::RunList::const_iterator it = mask.runs->begin();
+	    it != mask.runs->end();
+	    it++)
+	  if(!((s << it->first) && (s << it->second)))
+	    return false;
+	return true;
+      }
+      if(!(s << (int)0))
+	return false;
+      return s.append_bytes(mask.get_raw(), mask.raw_size());
+    }
+
+    template <typename S>
+    bool operator>>(S& s, ElementMask& mask)
+    {
+      int first_element, num_elements, first_enabled, last_enabled, is_runs;
+      if(!((s >> first_element) && (s >> num_elements) &&
+	   (s >> first_enabled) && (s >> last_enabled) && (s >> is_runs)))
+	return false;
+      mask = ElementMask(num_elements, first_element);
+      if(is_runs) {
+	size_t count;
+	if(!(s >> count))
+	  return false;
+	mask.runs->resize(count);
+	for(size_t i = 0; i < count; i++)
+	  if(!((s >> (*mask.runs)[i].first) && (s >> (*mask.runs)[i].second)))
+	    return false;
+      } else {
+	mask.make_dense();
+	if(!s.extract_bytes(mask.raw_data, mask.raw_size()))
+	  return false;
+      }
+      mask.first_enabled_elmt = first_enabled;
+      mask.last_enabled_elmt = last_enabled;
+      return true;
+    }
+
     template <class T>
     /*static*/ int ElementMask::forall_ranges(T &executor,
 					      const ElementMask &mask,
@@ -99,7 +99,10 @@ namespace Realm {
       if(!e.has_triggered())
 	log_inst.info("requested metadata in accessor creation: " IDFMT, id);
 	
-      return LegionRuntime::Accessor::RegionAccessor<LegionRuntime::Accessor::AccessorType::Generic>(LegionRuntime::Accessor::AccessorType::Generic::Untyped((void *)i_impl));
+      LegionRuntime::Accessor::AccessorType::Generic::Untyped untyped((void *)i_impl);
+      // finds a direct layout only if the metadata is already here
+      untyped.find_dense_layout();
+      return LegionRuntime::Accessor::RegionAccessor<LegionRuntime::Accessor::AccessorType::Generic>(untyped);
     }
 
   
@@ -354,7 +357,8 @@ namespace Realm {
 	int field_size;
 	find_field_start(metadata.field_sizes, byte_offset, size, field_start, field_size);
         o = calc_mem_loc(metadata.alloc_offset, field_start, field_size,
-                         metadata.elmt_size, metadata.block_size, index);
+                         metadata.elmt_size, metadata.block_size, index) +
+	    (byte_offset - field_start);
 
       }
       MemoryImpl *m = get_runtime()->get_memory_impl(memory);
@@ -374,7 +378,8 @@ namespace Realm {
 	int field_size;
 	find_field_start(metadata.field_sizes, byte_offset, size, field_start, field_size);
         o = calc_mem_loc(metadata.alloc_offset, field_start, field_size,
-                         metadata.elmt_size, metadata.block_size, index);
+                         metadata.elmt_size, metadata.block_size, index) +
+	    (byte_offset - field_start);
       }
       MemoryImpl *m = get_runtime()->get_memory_impl(memory);
       m->put_bytes(o, src, size);
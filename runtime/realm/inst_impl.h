@@ -19,9 +19,11 @@
 #define REALM_INST_IMPL_H
 
 #include "instance.h"
+#include "indexspace.h"
 #include "id.h"
 
 #include "activemsg.h"
+#include "profiling.h"
 
 #include "rsrv_impl.h"
 #include "metadata.h"
@@ -76,6 +76,14 @@ namespace Realm {
       int get_mem_mem_affinity(std::vector<MemoryMemoryAffinity>& result,
 			       Memory restrict_mem1 = Memory::NO_MEMORY,
 			       Memory restrict_mem2 = Memory::NO_MEMORY) const;
+
+      // a dynamic estimate of how long (in nanoseconds) a copy of 'bytes'
+      //  bytes from src_mem to dst_mem would take if issued now, based on the
+      //  copies this node has queued between the two memories and the
+      //  bandwidth it has observed for recent ones (or the static affinity,
+      //  for a pair that hasn't been used) - negative if there is no direct
+      //  path between the memories
+      double estimate_copy_time(Memory src_mem, Memory dst_mem, size_t bytes) const;
     };
 	
 }; // namespace Realm
@@ -19,6 +19,7 @@
 #define REALM_MEMORY_IMPL_H
 
 #include "memory.h"
+#include "indexspace.h"
 #include "id.h"
 
 #include "activemsg.h"
@@ -18,12 +18,59 @@
 #ifndef REALM_NODESET_H
 #define REALM_NODESET_H
 
-// currently just using the HLR's version
-#include "legion_types.h"
-#include "legion_utilities.h"
+#include "activemsg.h"
 
 namespace Realm {
-  typedef LegionRuntime::HighLevel::NodeSet NodeSet;
-};
+
+  // a set of node IDs, used to track which remote nodes care about an event,
+  //  reservation, or piece of metadata - almost all of these sets are empty
+  //  or name just a few nodes, so up to INLINE_NODES are stored (sorted) in
+  //  the object itself, and only larger sets use a heap-allocated bitmask,
+  //  which is sized by the largest node ID seen rather than the maximum
+  //  number of nodes
+  class NodeSet {
+  public:
+    NodeSet(void);
+    NodeSet(const NodeSet& copy_from);
+    ~NodeSet(void);
+
+    NodeSet& operator=(const NodeSet& copy_from);
+
+    bool empty(void) const;
+    size_t size(void) const;
+
+    bool contains(gasnet_node_t node) const;
+    void add(gasnet_node_t node);
+    void remove(gasnet_node_t node);
+    void clear(void);
+    void swap(NodeSet& swap_with);
+
+    // lowest node ID in the set (which must not be empty)
+    gasnet_node_t find_first_set(void) const;
+
+    // calls target.apply(node) for each node in the set, in increasing order
+    template <typename T>
+    void map(T& target) const;
+
+  protected:
+    typedef unsigned long long bitmask_elem_t;
+
+    static const unsigned INLINE_NODES = 4;
+    static const unsigned BITS_PER_ELEM = 8 * sizeof(bitmask_elem_t);
+
+    void convert_to_dense(gasnet_node_t max_node);
+    void grow_bitmask(gasnet_node_t max_node);
+
+    unsigned count;           // number of nodes in the set
+    unsigned bitmask_elems;   // 0 if the nodes are stored inline
+    union {
+      gasnet_node_t nodes[INLINE_NODES];
+      bitmask_elem_t *bitmask;
+    } data;
+  };
+
+}; // namespace Realm
+
+#include "nodeset.inl"
 
 #endif // ifndef REALM_NODESET_H
@@ -0,0 +1,223 @@
+/* Copyright 2015 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// dynamic node set implementation for Realm
+
+// nop, but helps IDEs
+#include "nodeset.h"
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+namespace Realm {
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class NodeSet
+
+  inline NodeSet::NodeSet(void)
+    : count(0), bitmask_elems(0)
+  {}
+
+  inline NodeSet::NodeSet(const NodeSet& copy_from)
+    : count(copy_from.count), bitmask_elems(copy_from.bitmask_elems)
+  {
+    if(bitmask_elems) {
+      data.bitmask = new bitmask_elem_t[bitmask_elems];
+      memcpy(data.bitmask, copy_from.data.bitmask,
+	     bitmask_elems * sizeof(bitmask_elem_t));
+    } else
+      data = copy_from.data;
+  }
+
+  inline NodeSet::~NodeSet(void)
+  {
+    if(bitmask_elems)
+      delete[] data.bitmask;
+  }
+
+  inline NodeSet& NodeSet::operator=(const NodeSet& copy_from)
+  {
+    if(this != &copy_from) {
+      NodeSet tmp(copy_from);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  inline bool NodeSet::empty(void) const
+  {
+    return (count == 0);
+  }
+
+  inline size_t NodeSet::size(void) const
+  {
+    return count;
+  }
+
+  inline bool NodeSet::contains(gasnet_node_t node) const
+  {
+    if(bitmask_elems) {
+      unsigned idx = node / BITS_PER_ELEM;
+      return ((idx < bitmask_elems) &&
+	      ((data.bitmask[idx] >> (node % BITS_PER_ELEM)) & 1) != 0);
+    }
+
+    for(unsigned i = 0; i < count; i++)
+      if(data.nodes[i] == node)
+	return true;
+    return false;
+  }
+
+  inline void NodeSet::add(gasnet_node_t node)
+  {
+    if(!bitmask_elems) {
+      // keep the inline entries sorted, so that map() visits nodes in the
+      //  same order either way
+      unsigned pos = 0;
+      while((pos < count) && (data.nodes[pos] < node))
+	pos++;
+      if((pos < count) && (data.nodes[pos] == node))
+	return;
+
+      if(count < INLINE_NODES) {
+	for(unsigned i = count; i > pos; i--)
+	  data.nodes[i] = data.nodes[i - 1];
+	data.nodes[pos] = node;
+	count++;
+	return;
+      }
+
+      // out of inline space
+      convert_to_dense(std::max(node, data.nodes[count - 1]));
+    }
+
+    unsigned idx = node / BITS_PER_ELEM;
+    if(idx >= bitmask_elems)
+      grow_bitmask(node);
+
+    bitmask_elem_t bit = ((bitmask_elem_t)1) << (node % BITS_PER_ELEM);
+    if(!(data.bitmask[idx] & bit)) {
+      data.bitmask[idx] |= bit;
+      count++;
+    }
+  }
+
+  inline void NodeSet::remove(gasnet_node_t node)
+  {
+    if(!bitmask_elems) {
+      for(unsigned i = 0; i < count; i++)
+	if(data.nodes[i] == node) {
+	  for(unsigned j = i + 1; j < count; j++)
+	    data.nodes[j - 1] = data.nodes[j];
+	  count--;
+	  return;
+	}
+      return;
+    }
+
+    unsigned idx = node / BITS_PER_ELEM;
+    if(idx >= bitmask_elems)
+      return;
+
+    bitmask_elem_t bit = ((bitmask_elem_t)1) << (node % BITS_PER_ELEM);
+    if(data.bitmask[idx] & bit) {
+      data.bitmask[idx] &= ~bit;
+      // a set that empties goes back to inline storage - one that is merely
+      //  small again stays dense, so that it doesn't flip back and forth
+      if(--count == 0)
+	clear();
+    }
+  }
+
+  inline void NodeSet::clear(void)
+  {
+    if(bitmask_elems) {
+      delete[] data.bitmask;
+      bitmask_elems = 0;
+    }
+    count = 0;
+  }
+
+  inline void NodeSet::swap(NodeSet& swap_with)
+  {
+    std::swap(count, swap_with.count);
+    std::swap(bitmask_elems, swap_with.bitmask_elems);
+    std::swap(data, swap_with.data);
+  }
+
+  inline gasnet_node_t NodeSet::find_first_set(void) const
+  {
+    assert(count > 0);
+    if(!bitmask_elems)
+      return data.nodes[0];
+
+    for(unsigned idx = 0; idx < bitmask_elems; idx++)
+      if(data.bitmask[idx])
+	return (idx * BITS_PER_ELEM) + __builtin_ctzll(data.bitmask[idx]);
+    assert(0);
+    return 0;
+  }
+
+  template <typename T>
+  inline void NodeSet::map(T& target) const
+  {
+    if(!bitmask_elems) {
+      for(unsigned i = 0; i < count; i++)
+	target.apply(data.nodes[i]);
+      return;
+    }
+
+    // skip empty words a whole word at a time, and within a word jump
+    //  straight from one set bit to the next
+    for(unsigned idx = 0; idx < bitmask_elems; idx++) {
+      bitmask_elem_t bits = data.bitmask[idx];
+      while(bits) {
+	target.apply((idx * BITS_PER_ELEM) + __builtin_ctzll(bits));
+	bits &= bits - 1;
+      }
+    }
+  }
+
+  inline void NodeSet::convert_to_dense(gasnet_node_t max_node)
+  {
+    assert(!bitmask_elems);
+    unsigned elems = (max_node / BITS_PER_ELEM) + 1;
+    bitmask_elem_t *bitmask = new bitmask_elem_t[elems];
+    memset(bitmask, 0, elems * sizeof(bitmask_elem_t));
+    for(unsigned i = 0; i < count; i++)
+      bitmask[data.nodes[i] / BITS_PER_ELEM] |= (((bitmask_elem_t)1) <<
+						 (data.nodes[i] % BITS_PER_ELEM));
+    data.bitmask = bitmask;
+    bitmask_elems = elems;
+  }
+
+  inline void NodeSet::grow_bitmask(gasnet_node_t max_node)
+  {
+    // at least double, so that adding nodes in increasing order doesn't
+    //  reallocate for every word
+    unsigned elems = std::max((unsigned)((max_node / BITS_PER_ELEM) + 1),
+			      2 * bitmask_elems);
+    bitmask_elem_t *bitmask = new bitmask_elem_t[elems];
+    memcpy(bitmask, data.bitmask, bitmask_elems * sizeof(bitmask_elem_t));
+    memset(bitmask + bitmask_elems, 0,
+	   (elems - bitmask_elems) * sizeof(bitmask_elem_t));
+    delete[] data.bitmask;
+    data.bitmask = bitmask;
+    bitmask_elems = elems;
+  }
+
+}; // namespace Realm
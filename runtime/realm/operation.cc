@@ -16,6 +16,7 @@
 #include "operation.h"
 
 #include "runtime_impl.h"
+#include "event_tracer.h"
 
 namespace Realm {
 
@@ -37,11 +38,22 @@ namespace Realm {
   void Operation::mark_started(void)
   {
     timeline.record_start_time();
+    EventTracer::record_op_start(finish_event);
+
+    if(measurements.wants_measurement<ProfilingMeasurements::OperationPerfCounters>())
+      ThreadPerfCounters::sample(perf_start);
   }
 
   void Operation::mark_finished(void)
   {
+    if(measurements.wants_measurement<ProfilingMeasurements::OperationPerfCounters>()) {
+      ThreadPerfCounters::Sample perf_end;
+      ThreadPerfCounters::sample(perf_end);
+      measurements.add_measurement(ThreadPerfCounters::difference(perf_start, perf_end));
+    }
+
     timeline.record_end_time();
+    EventTracer::record_op_end(finish_event);
 
     // do an atomic decrement of the work counter to see if we're also complete
     int remaining = __sync_sub_and_fetch(&pending_work_items, 1);
@@ -17,6 +17,7 @@
 #define REALM_OPERATION_H
 
 #include "realm/profiling.h"
+#include "realm/perf_counters.h"
 
 #include <set>
 
@@ -71,6 +72,7 @@ namespace Realm {
   protected:
     ProfilingMeasurements::OperationStatus status;
     ProfilingMeasurements::OperationTimeline timeline;
+    ThreadPerfCounters::Sample perf_start;  // only if counters are wanted
     ProfilingRequestSet requests; 
     ProfilingMeasurementCollection measurements;
 
@@ -0,0 +1,250 @@
+/* Copyright 2015 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// hardware counters and runtime overhead accounting behind the
+//  OperationPerfCounters and ProcessorRuntimeOverhead profiling measurements
+
+#include "perf_counters.h"
+
+#include "logging.h"
+#include "timers.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define REALM_USE_PERF_EVENT
+#endif
+
+namespace Realm {
+
+  Logger log_perf("perf");
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class ThreadPerfCounters
+  //
+
+  namespace {
+    typedef ProfilingMeasurements::OperationPerfCounters::counter_t counter_t;
+
+    enum {
+      CTR_CYCLES,
+      CTR_INSTRUCTIONS,
+      CTR_LLC_MISSES,
+      NUM_COUNTERS
+    };
+
+    // the counters of one kernel thread form a single perf_event group, so
+    //  that one read() gets all of them - slot[i] is the position of counter
+    //  i in the group, or -1 if the kernel wouldn't give it to us
+    struct PerThreadCounters {
+      int leader_fd;
+      int fds[NUM_COUNTERS];
+      int slot[NUM_COUNTERS];
+      int num_open;
+    };
+
+    __thread int thread_counter_state = 0;  // 0 = unopened, 1 = open, -1 = failed
+    __thread PerThreadCounters *thread_counters = 0;
+
+    pthread_key_t counters_key;
+    pthread_once_t counters_key_once = PTHREAD_ONCE_INIT;
+
+    // closes a thread's counters when the thread exits (worker threads come
+    //  and go, and would otherwise leak file descriptors)
+    void close_counters(void *data)
+    {
+      PerThreadCounters *ptc = (PerThreadCounters *)data;
+      for(int i = 0; i < NUM_COUNTERS; i++)
+	if(ptc->fds[i] >= 0)
+	  close(ptc->fds[i]);
+      delete ptc;
+    }
+
+    void create_counters_key(void)
+    {
+      pthread_key_create(&counters_key, close_counters);
+    }
+
+#ifdef REALM_USE_PERF_EVENT
+    int open_counter(unsigned type, unsigned long long config, int group_fd)
+    {
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = type;
+      attr.config = config;
+      attr.read_format = PERF_FORMAT_GROUP;
+      // user-level counts only, which is all that an unprivileged process
+      //  gets at the default perf_event_paranoid setting anyway
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      // pid = 0, cpu = -1: this thread, on whichever cpu it runs
+      return syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+    }
+#endif
+
+    PerThreadCounters *open_thread_counters(void)
+    {
+#ifdef REALM_USE_PERF_EVENT
+      PerThreadCounters *ptc = new PerThreadCounters;
+      ptc->leader_fd = -1;
+      ptc->num_open = 0;
+      for(int i = 0; i < NUM_COUNTERS; i++) {
+	ptc->fds[i] = -1;
+	ptc->slot[i] = -1;
+      }
+
+      static const struct { unsigned type; unsigned long long config; } events[NUM_COUNTERS] = {
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+      };
+
+      // whichever counter opens first leads the group
+      for(int i = 0; i < NUM_COUNTERS; i++) {
+	int fd = open_counter(events[i].type, events[i].config, ptc->leader_fd);
+	if(fd < 0) continue;
+	if(ptc->leader_fd < 0)
+	  ptc->leader_fd = fd;
+	ptc->fds[i] = fd;
+	ptc->slot[i] = ptc->num_open++;
+      }
+
+      if(ptc->num_open == 0) {
+	log_perf.info("hardware counters unavailable on this thread: %s", strerror(errno));
+	delete ptc;
+	return 0;
+      }
+
+      ioctl(ptc->leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+      pthread_once(&counters_key_once, create_counters_key);
+      pthread_setspecific(counters_key, ptc);
+      return ptc;
+#else
+      return 0;
+#endif
+    }
+  };
+
+  /*static*/ void ThreadPerfCounters::sample(Sample& s)
+  {
+    ProfilingMeasurements::OperationPerfCounters& counts = s.counts;
+    counts.cycles = counts.instructions = counts.llc_misses =
+      ProfilingMeasurements::OperationPerfCounters::UNAVAILABLE;
+    s.thread = 0;
+
+    if(thread_counter_state == 0) {
+      thread_counters = open_thread_counters();
+      thread_counter_state = (thread_counters ? 1 : -1);
+    }
+    if(thread_counter_state < 0)
+      return;
+
+    // group read format is { nr, values[nr] }
+    unsigned long long buffer[1 + NUM_COUNTERS];
+    ssize_t amt = ::read(thread_counters->leader_fd, buffer, sizeof(buffer));
+    if((amt < (ssize_t)sizeof(unsigned long long)) ||
+       (buffer[0] != (unsigned long long)(thread_counters->num_open)))
+      return;
+
+    s.thread = thread_counters;
+    const int *slot = thread_counters->slot;
+    if(slot[CTR_CYCLES] >= 0)
+      counts.cycles = buffer[1 + slot[CTR_CYCLES]];
+    if(slot[CTR_INSTRUCTIONS] >= 0)
+      counts.instructions = buffer[1 + slot[CTR_INSTRUCTIONS]];
+    if(slot[CTR_LLC_MISSES] >= 0)
+      counts.llc_misses = buffer[1 + slot[CTR_LLC_MISSES]];
+  }
+
+  static inline counter_t counter_difference(counter_t start, counter_t end)
+  {
+    if((start == ProfilingMeasurements::OperationPerfCounters::UNAVAILABLE) ||
+       (end == ProfilingMeasurements::OperationPerfCounters::UNAVAILABLE))
+      return ProfilingMeasurements::OperationPerfCounters::UNAVAILABLE;
+    return end - start;
+  }
+
+  /*static*/ ProfilingMeasurements::OperationPerfCounters
+    ThreadPerfCounters::difference(const Sample& start, const Sample& end)
+  {
+    ProfilingMeasurements::OperationPerfCounters diff;
+    if((start.thread == 0) || (start.thread != end.thread)) {
+      diff.cycles = diff.instructions = diff.llc_misses =
+	ProfilingMeasurements::OperationPerfCounters::UNAVAILABLE;
+      return diff;
+    }
+    diff.cycles = counter_difference(start.counts.cycles, end.counts.cycles);
+    diff.instructions = counter_difference(start.counts.instructions,
+					   end.counts.instructions);
+    diff.llc_misses = counter_difference(start.counts.llc_misses,
+					 end.counts.llc_misses);
+    return diff;
+  }
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class RuntimeOverhead
+  //
+
+  /*static*/ volatile bool RuntimeOverhead::enabled = false;
+  /*static*/ volatile long long RuntimeOverhead::totals[RuntimeOverhead::NUM_CATEGORIES];
+
+  namespace {
+    // nesting depth of timers of each category on this thread
+    __thread int timer_depth[RuntimeOverhead::NUM_CATEGORIES];
+  };
+
+  /*static*/ void RuntimeOverhead::enable(void)
+  {
+    if(!enabled) {
+      log_perf.info("runtime overhead accounting enabled");
+      enabled = true;
+    }
+  }
+
+  /*static*/ long long RuntimeOverhead::total_time(Category cat)
+  {
+    return totals[cat];
+  }
+
+  void RuntimeOverhead::ScopedTimer::start(void)
+  {
+    // nested timers just track the depth (start_time < 0)
+    if(timer_depth[cat]++ == 0)
+      start_time = Clock::current_time_in_nanoseconds();
+    else
+      start_time = -1;
+  }
+
+  void RuntimeOverhead::ScopedTimer::stop(void)
+  {
+    timer_depth[cat]--;
+    if(start_time > 0) {
+      long long elapsed = Clock::current_time_in_nanoseconds() - start_time;
+      __sync_fetch_and_add(&totals[cat], elapsed);
+    }
+  }
+
+}; // namespace Realm
@@ -0,0 +1,87 @@
+/* Copyright 2015 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// hardware counters and runtime overhead accounting behind the
+//  OperationPerfCounters and ProcessorRuntimeOverhead profiling measurements
+
+#ifndef REALM_PERF_COUNTERS_H
+#define REALM_PERF_COUNTERS_H
+
+#include "profiling.h"
+
+namespace Realm {
+
+  // reads the hardware counters of the calling kernel thread - the counters
+  //  are opened the first time a thread reads them, and a thread that can't
+  //  open them (see OperationPerfCounters) doesn't try again
+  class ThreadPerfCounters {
+  public:
+    struct Sample {
+      ProfilingMeasurements::OperationPerfCounters counts;
+      const void *thread;  // identifies the kernel thread that was sampled
+    };
+
+    static void sample(Sample& s);
+
+    // counts between two samples - everything is UNAVAILABLE if the samples
+    //  came from different kernel threads (e.g. a user thread that blocked
+    //  and was resumed elsewhere)
+    static ProfilingMeasurements::OperationPerfCounters difference(const Sample& start,
+								   const Sample& end);
+  };
+
+  // node-wide accumulators for the time spent triggering events and handling
+  //  active messages - timing is off until something asks for a
+  //  ProcessorRuntimeOverhead measurement, and while it's off each timer is
+  //  a single test of a flag
+  class RuntimeOverhead {
+  public:
+    enum Category {
+      EVENT_TRIGGER,
+      MESSAGE_HANDLER,
+      NUM_CATEGORIES
+    };
+
+    static inline bool is_enabled(void);
+    static void enable(void);
+
+    static long long total_time(Category cat);
+
+    // times the enclosing scope - only the outermost timer of each category
+    //  on a thread counts, so that (for example) the triggers of dependent
+    //  events aren't counted more than once
+    class ScopedTimer {
+    public:
+      inline ScopedTimer(Category _cat);
+      inline ~ScopedTimer(void);
+
+    protected:
+      void start(void);
+      void stop(void);
+
+      Category cat;
+      long long start_time;  // 0 if this timer was never started
+    };
+
+  protected:
+    static volatile bool enabled;
+    static volatile long long totals[NUM_CATEGORIES];
+  };
+
+}; // namespace Realm
+
+#include "perf_counters.inl"
+
+#endif // REALM_PERF_COUNTERS_H
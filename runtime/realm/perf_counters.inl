@@ -0,0 +1,52 @@
+/* Copyright 2015 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// INCLDUED FROM perf_counters.h - DO NOT INCLUDE THIS DIRECTLY
+
+// this is a nop, but it's for the benefit of IDEs trying to parse this file
+#include "perf_counters.h"
+
+namespace Realm {
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class RuntimeOverhead
+  //
+
+  inline /*static*/ bool RuntimeOverhead::is_enabled(void)
+  {
+    return enabled;
+  }
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class RuntimeOverhead::ScopedTimer
+  //
+
+  inline RuntimeOverhead::ScopedTimer::ScopedTimer(Category _cat)
+    : cat(_cat), start_time(0)
+  {
+    if(__builtin_expect(enabled, false))
+      start();
+  }
+
+  inline RuntimeOverhead::ScopedTimer::~ScopedTimer(void)
+  {
+    if(__builtin_expect(start_time != 0, false))
+      stop();
+  }
+
+}; // namespace Realm
@@ -92,6 +92,9 @@ namespace Realm {
 
     // the actual queue - priorities are negated here to that queue.begin() gives us the
     //  "highest" priority
+    // when the last item is taken, its (empty) deque is kept so that a queue that
+    //  keeps draining and refilling at one priority doesn't allocate every time -
+    //  an empty deque is only ever present as the sole entry of the map
     std::map<priority_t, std::deque<T> > queue;
 
     // notification subscriptions
@@ -70,6 +70,11 @@ namespace Realm {
       }
     }
 
+    // a retained empty deque at some other priority must go first
+    if((queue.size() == 1) && queue.begin()->second.empty() &&
+       (queue.begin()->first != -priority))
+      queue.clear();
+
     // get the right deque (this will create one if needed)
     std::deque<T>& dq = queue[-priority]; // remember negation...
 
@@ -94,7 +99,7 @@ namespace Realm {
     lock.lock();
 
     // empty queue - early out
-    if(queue.empty()) {
+    if(queue.empty() || queue.begin()->second.empty()) {
       lock.unlock();
       return 0; // TODO - EMPTY_VAL
     }
@@ -112,12 +117,14 @@ namespace Realm {
     T item = it->second.front();
     it->second.pop_front();
 
-    // if list is now empty, remove from the queue and adjust highest_priority
+    // if list is now empty, remove from the queue (unless it's the last one) and
+    //  adjust highest_priority
     if(it->second.empty()) {
-      queue.erase(it);
-      highest_priority = (queue.empty() ?
-			    PRI_NEG_INF :
-			    -(queue.begin()->first));
+      if(queue.size() > 1) {
+	queue.erase(it);
+	highest_priority = -(queue.begin()->first);
+      } else
+	highest_priority = PRI_NEG_INF;
     }
 
     // release lock and then return result
@@ -138,7 +145,7 @@ namespace Realm {
     lock.lock();
 
     // empty queue - early out
-    if(queue.empty()) {
+    if(queue.empty() || queue.begin()->second.empty()) {
       lock.unlock();
       return 0; // TODO - EMPTY_VAL
     }
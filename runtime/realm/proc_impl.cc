@@ -20,6 +20,7 @@
 #include "logging.h"
 #include "serialize.h"
 #include "profiling.h"
+#include "event_tracer.h"
 
 #include <sys/types.h>
 #include <dirent.h>
@@ -127,6 +128,8 @@ namespace Realm {
                             priority, args, arglen);
 #endif
 
+      EventTracer::record_task(e, wait_on, func_id);
+
       p->spawn_task(func_id, args, arglen, ProfilingRequestSet(),
 		    wait_on, e, priority);
       return e;
@@ -152,6 +155,8 @@ namespace Realm {
                             priority, args, arglen);
 #endif
 
+      EventTracer::record_task(e, wait_on, func_id);
+
       p->spawn_task(func_id, args, arglen, reqs,
 		    wait_on, e, priority);
       return e;
@@ -518,7 +523,8 @@ namespace Realm {
   //
 
   LocalCPUProcessor::LocalCPUProcessor(Processor _me, CoreReservationSet& crs,
-				       size_t _stack_size)
+				       size_t _stack_size, bool _force_kthreads,
+				       int _max_user_workers)
     : LocalTaskProcessor(_me, Processor::LOC_PROC)
   {
     CoreReservationParameters params;
@@ -533,12 +539,16 @@ namespace Realm {
     core_rsrv = new CoreReservation(name, crs, params);
 
 #ifdef REALM_USE_USER_THREADS
-    UserThreadTaskScheduler *sched = new UserThreadTaskScheduler(me, *core_rsrv);
-    // no config settings we want to tweak yet
-#else
+    if(!_force_kthreads) {
+      UserThreadTaskScheduler *sched = new UserThreadTaskScheduler(me, *core_rsrv);
+      sched->cfg_max_workers = _max_user_workers;
+      sched->cfg_stack_size = _stack_size;
+      set_scheduler(sched);
+      return;
+    }
+#endif
     KernelThreadTaskScheduler *sched = new KernelThreadTaskScheduler(me, *core_rsrv);
     sched->cfg_max_idle_workers = 3; // keep a few idle threads around
-#endif
     set_scheduler(sched);
   }
 
@@ -554,7 +564,8 @@ namespace Realm {
   //
 
   LocalUtilityProcessor::LocalUtilityProcessor(Processor _me, CoreReservationSet& crs,
-					       size_t _stack_size)
+					       size_t _stack_size, bool _force_kthreads,
+					       int _max_user_workers)
     : LocalTaskProcessor(_me, Processor::UTIL_PROC)
   {
     CoreReservationParameters params;
@@ -569,12 +580,16 @@ namespace Realm {
     core_rsrv = new CoreReservation(name, crs, params);
 
 #ifdef REALM_USE_USER_THREADS
-    UserThreadTaskScheduler *sched = new UserThreadTaskScheduler(me, *core_rsrv);
-    // no config settings we want to tweak yet
-#else
+    if(!_force_kthreads) {
+      UserThreadTaskScheduler *sched = new UserThreadTaskScheduler(me, *core_rsrv);
+      sched->cfg_max_workers = _max_user_workers;
+      sched->cfg_stack_size = _stack_size;
+      set_scheduler(sched);
+      return;
+    }
+#endif
     KernelThreadTaskScheduler *sched = new KernelThreadTaskScheduler(me, *core_rsrv);
     // no config settings we want to tweak yet
-#endif
     set_scheduler(sched);
   }
 
@@ -99,7 +99,8 @@ namespace Realm {
 
     class LocalCPUProcessor : public LocalTaskProcessor {
     public:
-      LocalCPUProcessor(Processor _me, CoreReservationSet& crs, size_t _stack_size);
+      LocalCPUProcessor(Processor _me, CoreReservationSet& crs, size_t _stack_size,
+			bool _force_kthreads, int _max_user_workers);
       virtual ~LocalCPUProcessor(void);
     protected:
       CoreReservation *core_rsrv;
@@ -107,7 +108,8 @@ namespace Realm {
 
     class LocalUtilityProcessor : public LocalTaskProcessor {
     public:
-      LocalUtilityProcessor(Processor _me, CoreReservationSet& crs, size_t _stack_size);
+      LocalUtilityProcessor(Processor _me, CoreReservationSet& crs, size_t _stack_size,
+			    bool _force_kthreads, int _max_user_workers);
       virtual ~LocalUtilityProcessor(void);
     protected:
       CoreReservation *core_rsrv;
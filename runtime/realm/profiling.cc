@@ -16,6 +16,7 @@
 // implementation of profiling stuff for Realm
 
 #include "profiling.h"
+#include "perf_counters.h"
 
 namespace Realm {
 
@@ -154,6 +155,11 @@ namespace Realm {
 	it++)
       requested_measurements.insert((*it)->requested_measurements.begin(),
 				    (*it)->requested_measurements.end());
+
+    // runtime overhead isn't timed until somebody wants it
+    if(!RuntimeOverhead::is_enabled() &&
+       wants_measurement<ProfilingMeasurements::ProcessorRuntimeOverhead>())
+      RuntimeOverhead::enable();
   }
 
   void ProfilingMeasurementCollection::send_responses(const ProfilingRequestSet& prs) const
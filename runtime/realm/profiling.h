@@ -39,6 +39,8 @@ namespace Realm {
     PMID_OP_MEM_USAGE, // memories used by a copy
     PMID_INST_TIMELINE, // timeline for a physical instance
     PMID_INST_MEM_USAGE, // memory and size used by an instance
+    PMID_OP_PERF_COUNTERS, // hardware counters while running an operation
+    PMID_PROC_RUNTIME_OVERHEAD, // time spent in the runtime itself
   };
 
   namespace ProfilingMeasurements {
@@ -132,6 +134,41 @@ namespace Realm {
       Memory memory;
       size_t bytes;
     };
+
+    // Hardware performance counters (Linux perf_event) sampled on the
+    //  thread running a task or copy - counters that cannot be read on this
+    //  system (not Linux, perf_event_paranoid too strict, no PMU in a VM, ...)
+    //  are reported as UNAVAILABLE
+    // if a task blocks, its counts include whatever else ran on the same
+    //  kernel thread in the meantime, and if it resumes on a different kernel
+    //  thread, its counts are all UNAVAILABLE
+    struct OperationPerfCounters {
+      static const ProfilingMeasurementID ID = PMID_OP_PERF_COUNTERS;
+
+      typedef long long counter_t;
+      static const counter_t UNAVAILABLE = -1;
+
+      counter_t cycles;
+      counter_t instructions;
+      counter_t llc_misses;  // last-level cache misses
+
+      inline bool is_valid(void) const;
+    };
+
+    // Cumulative time (in nanoseconds) spent by the runtime rather than by
+    //  tasks, sampled when a task is started - scheduler time is for the
+    //  processor running the task, while event triggering and active message
+    //  handling are totals for the node
+    // nothing is timed until the first request for this measurement is seen
+    //  on the node, so the first values reported will be small
+    struct ProcessorRuntimeOverhead {
+      static const ProfilingMeasurementID ID = PMID_PROC_RUNTIME_OVERHEAD;
+
+      Processor proc;
+      long long scheduler_time;
+      long long event_time;
+      long long message_time;
+    };
   };
 
   class ProfilingRequest {
@@ -26,6 +26,8 @@ TYPE_IS_SERIALIZABLE(Realm::ProfilingMeasurements::OperationMemoryUsage);
 TYPE_IS_SERIALIZABLE(Realm::ProfilingMeasurements::OperationProcessorUsage);
 TYPE_IS_SERIALIZABLE(Realm::ProfilingMeasurements::InstanceMemoryUsage);
 TYPE_IS_SERIALIZABLE(Realm::ProfilingMeasurements::InstanceTimeline);
+TYPE_IS_SERIALIZABLE(Realm::ProfilingMeasurements::OperationPerfCounters);
+TYPE_IS_SERIALIZABLE(Realm::ProfilingMeasurements::ProcessorRuntimeOverhead);
 
 #include "timers.h"
 
@@ -99,6 +101,19 @@ namespace Realm {
       delete_time = Clock::current_time_in_nanoseconds();
     }
 
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    // struct OperationPerfCounters
+    //
+
+    inline bool OperationPerfCounters::is_valid(void) const
+    {
+      return ((cycles != UNAVAILABLE) ||
+	      (instructions != UNAVAILABLE) ||
+	      (llc_misses != UNAVAILABLE));
+    }
+
   }; // namespace ProfilingMeasurements
 
   ////////////////////////////////////////////////////////////////////////
@@ -670,9 +670,7 @@ namespace Realm {
 
 	if(!any_local && (!remote_waiter_mask.empty())) {
 	  // nobody local wants it, but another node does
-	  //HACK int new_owner = remote_waiter_mask.find_first_set();
-	  // TODO: use iterator - all we need is *begin()
-          int new_owner = 0;  while(!remote_waiter_mask.contains(new_owner)) new_owner++;
+	  int new_owner = remote_waiter_mask.find_first_set();
           remote_waiter_mask.remove(new_owner);
 
 	  log_reservation.debug(              "reservation going to remote waiter: new=%d", // mask=%lx",
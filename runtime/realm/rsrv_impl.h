@@ -24,6 +24,9 @@
 #include "activemsg.h"
 #include "nodeset.h"
 
+#include <map>
+#include <deque>
+
 namespace Realm {
 
 #ifdef LOCK_TRACING
@@ -24,6 +24,7 @@
 #include "activemsg.h"
 
 #include "cmdline.h"
+#include "event_tracer.h"
 
 #ifndef USE_GASNET
 /*extern*/ void *fake_gasnet_mem_base = 0;
@@ -162,6 +163,7 @@ namespace Realm {
     , num_cpu_procs(1), num_util_procs(1), num_io_procs(0)
     , concurrent_io_threads(1)  // Legion does not support values > 1 right now
     , sysmem_size_in_mb(512), stack_size_in_mb(2)
+    , force_kthreads(false), max_user_workers(0)
   {}
 
   CoreModule::~CoreModule(void)
@@ -180,6 +182,8 @@ namespace Realm {
       .add_option_int("-ll:concurrent_io", m->concurrent_io_threads)
       .add_option_int("-ll:csize", m->sysmem_size_in_mb)
       .add_option_int("-ll:stacksize", m->stack_size_in_mb, true /*keep*/)
+      .add_option_bool("-ll:force_kthreads", m->force_kthreads)
+      .add_option_int("-ll:max_uthreads", m->max_user_workers)
       .parse_command_line(cmdline);
 
     return m;
@@ -208,7 +212,8 @@ namespace Realm {
     for(int i = 0; i < num_util_procs; i++) {
       Processor p = runtime->next_local_processor_id();
       ProcessorImpl *pi = new LocalUtilityProcessor(p, runtime->core_reservation_set(),
-						    stack_size_in_mb << 20);
+						    stack_size_in_mb << 20,
+						    force_kthreads, max_user_workers);
       runtime->add_processor(pi);
     }
 
@@ -223,7 +228,8 @@ namespace Realm {
     for(int i = 0; i < num_cpu_procs; i++) {
       Processor p = runtime->next_local_processor_id();
       ProcessorImpl *pi = new LocalCPUProcessor(p, runtime->core_reservation_set(),
-						stack_size_in_mb << 20);
+						stack_size_in_mb << 20,
+						force_kthreads, max_user_workers);
       runtime->add_processor(pi);
     }
   }
@@ -513,9 +519,15 @@ namespace Realm {
 	.add_option_int("-ll:amsg", active_msg_worker_threads)
 	.add_option_int("-ll:ahandlers", active_msg_handler_threads)
 	.add_option_int("-ll:dummy_rsrv_ok", dummy_reservation_ok)
-	.add_option_bool("-ll:show_rsrv", show_reservations);
+	.add_option_bool("-ll:show_rsrv", show_reservations)
+	.add_option_int("-ll:barrier_radix", BarrierImpl::tree_radix);
 
       std::string event_trace_file, lock_trace_file;
+      bool event_tracer_enabled = false;
+      size_t event_tracer_records = 0;
+
+      cp.add_option_bool("-ll:etrace", event_tracer_enabled)
+	.add_option_int("-ll:etrace_size", event_tracer_records);
 
       cp.add_option_string("-ll:eventtrace", event_trace_file)
 	.add_option_string("-ll:locktrace", lock_trace_file);
@@ -541,6 +553,8 @@ namespace Realm {
 	gasnet_exit(1);
       }
 
+      EventTracer::configure(event_tracer_enabled, event_tracer_records);
+
 #ifndef EVENT_TRACING
       if(!event_trace_file.empty()) {
 	fprintf(stderr, "WARNING: event tracing requested, but not enabled at compile time!\n");
@@ -628,6 +642,8 @@ namespace Realm {
       hcount += BarrierAdjustMessage::Message::add_handler_entries(&handlers[hcount], "Barrier Adjust AM");
       hcount += BarrierSubscribeMessage::Message::add_handler_entries(&handlers[hcount], "Barrier Subscribe AM");
       hcount += BarrierTriggerMessage::Message::add_handler_entries(&handlers[hcount], "Barrier Trigger AM");
+      hcount += BarrierCombineMessage::Message::add_handler_entries(&handlers[hcount], "Barrier Combine AM");
+      hcount += BarrierCombineAckMessage::Message::add_handler_entries(&handlers[hcount], "Barrier Combine Ack AM");
       hcount += MetadataRequestMessage::Message::add_handler_entries(&handlers[hcount], "Metadata Request AM");
       hcount += MetadataResponseMessage::Message::add_handler_entries(&handlers[hcount], "Metadata Response AM");
       hcount += MetadataInvalidateMessage::Message::add_handler_entries(&handlers[hcount], "Metadata Invalidate AM");
@@ -1122,6 +1138,9 @@ namespace Realm {
 	log_runtime.info("shutdown request received - terminating\n");
       }
 
+      if(EventTracer::is_enabled())
+	EventTracer::report_critical_path();
+
 #ifdef REPORT_REALM_RESOURCE_USAGE
       {
         RuntimeImpl *rt = get_runtime();
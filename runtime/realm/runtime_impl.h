@@ -153,6 +153,8 @@ namespace Realm {
       int num_cpu_procs, num_util_procs, num_io_procs;
       int concurrent_io_threads;
       size_t sysmem_size_in_mb, stack_size_in_mb;
+      bool force_kthreads;
+      int max_user_workers;
     };
 
     REGISTER_REALM_MODULE(CoreModule);
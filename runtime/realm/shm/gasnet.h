@@ -0,0 +1,239 @@
+/* Copyright 2015 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// shared-memory conduit - implements the subset of the GASNet API used by
+//  activemsg.cc and the low-level runtime on top of POSIX shared memory, so
+//  that several processes on one machine can run as separate Realm nodes
+//  without a GASNet installation (build with CONDUIT=shm)
+//
+// set GASNET_PSHM_NODES=<n> in the environment to run n nodes - gasnet_init
+//  forks the extra processes, so the program is launched exactly once
+//
+// differences from real GASNet worth knowing about:
+//  - the payload of a medium message is only valid until the handler returns
+//     (this is the GASNet rule too, but some conduits are more forgiving)
+//  - all RMA operations are blocking, so the _nbi variants complete
+//     immediately and their handles are trivial
+
+#ifndef REALM_SHM_GASNET_H
+#define REALM_SHM_GASNET_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GASNET_CONDUIT_SHM 1
+
+#define GASNET_OK                 0
+#define GASNET_ERR_RESOURCE       10002
+#define GASNET_ERR_BAD_ARG        10003
+#define GASNET_ERR_NOT_READY      10004
+
+#define GASNET_BARRIERFLAG_ANONYMOUS 1
+
+#define GASNET_WAIT_SPIN  0
+#define GASNET_WAIT_BLOCK 1
+
+typedef uint32_t gasnet_node_t;
+typedef unsigned char gasnet_handler_t;
+typedef int32_t gasnet_handlerarg_t;
+typedef void *gasnet_token_t;
+typedef void *gasnet_handle_t;
+
+typedef struct {
+  gasnet_handler_t index;
+  void (*fnptr)();
+} gasnet_handlerentry_t;
+
+typedef struct {
+  void *addr;
+  uintptr_t size;
+} gasnet_seginfo_t;
+
+// job setup and teardown
+
+extern int gasnet_init(int *argc, char ***argv);
+extern int gasnet_attach(gasnet_handlerentry_t *table, int numentries,
+			 uintptr_t segsize, uintptr_t minheapoffset);
+extern void gasnet_exit(int exitcode) __attribute__((noreturn));
+extern int gasnet_set_waitmode(int wait_mode);
+
+extern gasnet_node_t gasnetc_mynode, gasnetc_nodes;
+
+inline gasnet_node_t gasnet_mynode(void) { return gasnetc_mynode; }
+inline gasnet_node_t gasnet_nodes(void) { return gasnetc_nodes; }
+
+extern uintptr_t gasnet_getMaxLocalSegmentSize(void);
+extern int gasnet_getSegmentInfo(gasnet_seginfo_t *seginfo_table, int numentries);
+
+extern const char *gasnet_ErrorName(int errval);
+extern const char *gasnet_ErrorDesc(int errval);
+
+// barriers
+
+extern void gasnet_barrier_notify(int id, int flags);
+extern int gasnet_barrier_wait(int id, int flags);
+
+// handler-safe locks
+
+typedef struct {
+  pthread_mutex_t lock;
+} gasnet_hsl_t;
+
+#define GASNET_HSL_INITIALIZER { PTHREAD_MUTEX_INITIALIZER }
+
+inline void gasnet_hsl_init(gasnet_hsl_t *hsl) { pthread_mutex_init(&hsl->lock, 0); }
+inline void gasnet_hsl_destroy(gasnet_hsl_t *hsl) { pthread_mutex_destroy(&hsl->lock); }
+inline void gasnet_hsl_lock(gasnet_hsl_t *hsl) { pthread_mutex_lock(&hsl->lock); }
+inline void gasnet_hsl_unlock(gasnet_hsl_t *hsl) { pthread_mutex_unlock(&hsl->lock); }
+inline int gasnet_hsl_trylock(gasnet_hsl_t *hsl)
+{
+  return ((pthread_mutex_trylock(&hsl->lock) == 0) ? GASNET_OK : GASNET_ERR_NOT_READY);
+}
+
+// active messages
+
+enum {
+  GASNETC_AM_SHORT,
+  GASNETC_AM_MEDIUM,
+  GASNETC_AM_LONG,
+};
+
+extern int gasnetc_am_request(gasnet_node_t dest, gasnet_handler_t handler, int category,
+			      const void *source_addr, size_t nbytes, void *dest_addr,
+			      int numargs, const gasnet_handlerarg_t *args);
+extern int gasnetc_am_reply(gasnet_token_t token, gasnet_handler_t handler, int category,
+			    const void *source_addr, size_t nbytes, void *dest_addr,
+			    int numargs, const gasnet_handlerarg_t *args);
+
+extern int gasnet_AMPoll(void);
+extern int gasnet_AMGetMsgSource(gasnet_token_t token, gasnet_node_t *srcindex);
+
+inline size_t gasnet_AMMaxMedium(void) { return 65536; }
+inline size_t gasnet_AMMaxLongRequest(void) { return 16 << 20; }
+
+#define GASNETC_PARAMS_1 gasnet_handlerarg_t a0
+#define GASNETC_PARAMS_2 GASNETC_PARAMS_1, gasnet_handlerarg_t a1
+#define GASNETC_PARAMS_3 GASNETC_PARAMS_2, gasnet_handlerarg_t a2
+#define GASNETC_PARAMS_4 GASNETC_PARAMS_3, gasnet_handlerarg_t a3
+#define GASNETC_PARAMS_5 GASNETC_PARAMS_4, gasnet_handlerarg_t a4
+#define GASNETC_PARAMS_6 GASNETC_PARAMS_5, gasnet_handlerarg_t a5
+#define GASNETC_PARAMS_7 GASNETC_PARAMS_6, gasnet_handlerarg_t a6
+#define GASNETC_PARAMS_8 GASNETC_PARAMS_7, gasnet_handlerarg_t a7
+#define GASNETC_PARAMS_9 GASNETC_PARAMS_8, gasnet_handlerarg_t a8
+#define GASNETC_PARAMS_10 GASNETC_PARAMS_9, gasnet_handlerarg_t a9
+#define GASNETC_PARAMS_11 GASNETC_PARAMS_10, gasnet_handlerarg_t a10
+#define GASNETC_PARAMS_12 GASNETC_PARAMS_11, gasnet_handlerarg_t a11
+#define GASNETC_PARAMS_13 GASNETC_PARAMS_12, gasnet_handlerarg_t a12
+#define GASNETC_PARAMS_14 GASNETC_PARAMS_13, gasnet_handlerarg_t a13
+#define GASNETC_PARAMS_15 GASNETC_PARAMS_14, gasnet_handlerarg_t a14
+#define GASNETC_PARAMS_16 GASNETC_PARAMS_15, gasnet_handlerarg_t a15
+
+#define GASNETC_VALUES_1 a0
+#define GASNETC_VALUES_2 GASNETC_VALUES_1, a1
+#define GASNETC_VALUES_3 GASNETC_VALUES_2, a2
+#define GASNETC_VALUES_4 GASNETC_VALUES_3, a3
+#define GASNETC_VALUES_5 GASNETC_VALUES_4, a4
+#define GASNETC_VALUES_6 GASNETC_VALUES_5, a5
+#define GASNETC_VALUES_7 GASNETC_VALUES_6, a6
+#define GASNETC_VALUES_8 GASNETC_VALUES_7, a7
+#define GASNETC_VALUES_9 GASNETC_VALUES_8, a8
+#define GASNETC_VALUES_10 GASNETC_VALUES_9, a9
+#define GASNETC_VALUES_11 GASNETC_VALUES_10, a10
+#define GASNETC_VALUES_12 GASNETC_VALUES_11, a11
+#define GASNETC_VALUES_13 GASNETC_VALUES_12, a12
+#define GASNETC_VALUES_14 GASNETC_VALUES_13, a13
+#define GASNETC_VALUES_15 GASNETC_VALUES_14, a14
+#define GASNETC_VALUES_16 GASNETC_VALUES_15, a15
+
+#define GASNETC_DEFINE_AM_CALLS(n) \
+inline int gasnet_AMRequestShort##n(gasnet_node_t dest, gasnet_handler_t handler, \
+				    GASNETC_PARAMS_##n) \
+{ \
+  gasnet_handlerarg_t args[n] = { GASNETC_VALUES_##n }; \
+  return gasnetc_am_request(dest, handler, GASNETC_AM_SHORT, 0, 0, 0, n, args); \
+} \
+inline int gasnet_AMRequestMedium##n(gasnet_node_t dest, gasnet_handler_t handler, \
+				     void *source_addr, size_t nbytes, \
+				     GASNETC_PARAMS_##n) \
+{ \
+  gasnet_handlerarg_t args[n] = { GASNETC_VALUES_##n }; \
+  return gasnetc_am_request(dest, handler, GASNETC_AM_MEDIUM, \
+			    source_addr, nbytes, 0, n, args); \
+} \
+inline int gasnet_AMRequestLongAsync##n(gasnet_node_t dest, gasnet_handler_t handler, \
+					void *source_addr, size_t nbytes, \
+					void *dest_addr, GASNETC_PARAMS_##n) \
+{ \
+  gasnet_handlerarg_t args[n] = { GASNETC_VALUES_##n }; \
+  return gasnetc_am_request(dest, handler, GASNETC_AM_LONG, \
+			    source_addr, nbytes, dest_addr, n, args); \
+} \
+inline int gasnet_AMReplyShort##n(gasnet_token_t token, gasnet_handler_t handler, \
+				  GASNETC_PARAMS_##n) \
+{ \
+  gasnet_handlerarg_t args[n] = { GASNETC_VALUES_##n }; \
+  return gasnetc_am_reply(token, handler, GASNETC_AM_SHORT, 0, 0, 0, n, args); \
+}
+
+GASNETC_DEFINE_AM_CALLS(1)
+GASNETC_DEFINE_AM_CALLS(2)
+GASNETC_DEFINE_AM_CALLS(3)
+GASNETC_DEFINE_AM_CALLS(4)
+GASNETC_DEFINE_AM_CALLS(5)
+GASNETC_DEFINE_AM_CALLS(6)
+GASNETC_DEFINE_AM_CALLS(7)
+GASNETC_DEFINE_AM_CALLS(8)
+GASNETC_DEFINE_AM_CALLS(9)
+GASNETC_DEFINE_AM_CALLS(10)
+GASNETC_DEFINE_AM_CALLS(11)
+GASNETC_DEFINE_AM_CALLS(12)
+GASNETC_DEFINE_AM_CALLS(13)
+GASNETC_DEFINE_AM_CALLS(14)
+GASNETC_DEFINE_AM_CALLS(15)
+GASNETC_DEFINE_AM_CALLS(16)
+
+#undef GASNETC_DEFINE_AM_CALLS
+
+// one-sided transfers - 'node' names the process that owns the remote
+//  address, which must lie in that node's segment
+
+extern void gasnet_get(void *dest, gasnet_node_t node, void *src, size_t nbytes);
+extern void gasnet_put(gasnet_node_t node, void *dest, void *src, size_t nbytes);
+
+inline void gasnet_get_nbi(void *dest, gasnet_node_t node, void *src, size_t nbytes)
+{
+  gasnet_get(dest, node, src, nbytes);
+}
+
+inline void gasnet_put_nbi(gasnet_node_t node, void *dest, void *src, size_t nbytes)
+{
+  gasnet_put(node, dest, src, nbytes);
+}
+
+inline void gasnet_wait_syncnbi_gets(void) {}
+inline void gasnet_begin_nbi_accessregion(void) {}
+inline gasnet_handle_t gasnet_end_nbi_accessregion(void) { return 0; }
+inline void gasnet_wait_syncnb(gasnet_handle_t handle) {}
+
+// activemsg.h takes the address of these to silence warnings from the real
+//  GASNet headers
+static inline void _gasneti_threadkey_init(void) {}
+static inline int _gasnett_trace_printf_noop(const char *fmt, ...) { return 0; }
+
+#endif
@@ -0,0 +1,54 @@
+/* Copyright 2015 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// shared-memory conduit - the GASNet tools that the low-level runtime uses,
+//  implemented directly on pthreads
+
+#ifndef REALM_SHM_GASNET_TOOLS_H
+#define REALM_SHM_GASNET_TOOLS_H
+
+#include <pthread.h>
+
+typedef struct {
+  pthread_cond_t cond;
+} gasnett_cond_t;
+
+inline void gasnett_cond_init(gasnett_cond_t *c) { pthread_cond_init(&c->cond, 0); }
+inline void gasnett_cond_destroy(gasnett_cond_t *c) { pthread_cond_destroy(&c->cond); }
+inline void gasnett_cond_signal(gasnett_cond_t *c) { pthread_cond_signal(&c->cond); }
+inline void gasnett_cond_broadcast(gasnett_cond_t *c) { pthread_cond_broadcast(&c->cond); }
+inline void gasnett_cond_wait(gasnett_cond_t *c, pthread_mutex_t *m) { pthread_cond_wait(&c->cond, m); }
+
+// thread keys are created on first use, so they can be defined in headers
+//  and used from static constructors
+struct gasnett_threadkey_t {
+  gasnett_threadkey_t(void) { pthread_key_create(&key, 0); }
+  pthread_key_t key;
+};
+
+#define GASNETT_THREADKEY_DECLARE(keyname) \
+  extern gasnett_threadkey_t& gasnett_threadkey_##keyname(void)
+#define GASNETT_THREADKEY_DEFINE(keyname) \
+  gasnett_threadkey_t& gasnett_threadkey_##keyname(void) { \
+    static gasnett_threadkey_t key; \
+    return key; \
+  }
+
+#define gasnett_threadkey_get(keyname) \
+  pthread_getspecific(gasnett_threadkey_##keyname().key)
+#define gasnett_threadkey_set(keyname, value) \
+  pthread_setspecific(gasnett_threadkey_##keyname().key, (value))
+
+#endif
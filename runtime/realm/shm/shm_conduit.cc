@@ -0,0 +1,737 @@
+/* Copyright 2015 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// shared-memory conduit - active messages and RMA between processes on the
+//  same machine
+//
+// gasnet_init maps an anonymous shared control region and forks the other
+//  nodes, so every process inherits it at the same address.  The control
+//  region holds the barrier state, the location of every node's segment and
+//  one single-producer/single-consumer byte ring for each ordered pair of
+//  nodes.  Segments are separate POSIX shared memory objects that each node
+//  creates in gasnet_attach and everyone else maps wherever it likes, so
+//  remote addresses are translated by their offset into the owner's segment.
+
+#include "gasnet.h"
+#include "gasnet_tools.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <deque>
+#include <vector>
+
+gasnet_node_t gasnetc_mynode = 0;
+gasnet_node_t gasnetc_nodes = 1;
+
+namespace {
+
+  const size_t RING_BYTES = 1 << 20;
+  const int MAX_ARGS = 16;
+  const size_t CACHE_LINE = 64;
+
+  enum {
+    RECORD_SHORT = GASNETC_AM_SHORT,
+    RECORD_MEDIUM = GASNETC_AM_MEDIUM,
+    RECORD_LONG = GASNETC_AM_LONG,
+    RECORD_PAD,  // fills the end of the ring when a record doesn't fit
+  };
+
+  // every record starts on an 8-byte boundary, and a medium message's
+  //  payload immediately follows its header
+  struct RecordHeader {
+    uint32_t size;  // of the whole record, including the payload
+    uint16_t kind;
+    uint8_t handler;
+    uint8_t numargs;
+    uint64_t nbytes;
+    uint64_t dest_addr;  // in the receiver's address space
+    gasnet_handlerarg_t args[MAX_ARGS];
+  };
+
+  // head and tail count the bytes ever written and read - the producer
+  //  only writes head and the consumer only writes tail
+  struct Ring {
+    volatile uint64_t head;
+    char pad0[CACHE_LINE - sizeof(uint64_t)];
+    volatile uint64_t tail;
+    char pad1[CACHE_LINE - sizeof(uint64_t)];
+    char data[RING_BYTES];
+  };
+
+  struct ControlHeader {
+    volatile int barrier_count;
+    volatile int barrier_sense;
+    volatile int exit_requested;
+    volatile int exit_code;
+    char pad[CACHE_LINE - 4 * sizeof(int)];
+  };
+
+  struct SegmentSlot {
+    volatile uint64_t base;  // in the owner's address space
+    volatile uint64_t size;
+  };
+
+  struct Token {
+    gasnet_node_t source;
+  };
+
+  ControlHeader *control = 0;
+  SegmentSlot *slots = 0;
+  Ring *rings = 0;  // rings[src * nodes + dst]
+  pid_t job_id = 0;
+  int barrier_sense = 0;
+  bool attached = false;
+
+  void (*handler_table[256])();
+
+  // where each node's segment is in its own address space and in ours
+  std::vector<char *> remote_bases, local_bases;
+  std::vector<uintptr_t> segment_sizes;
+
+  // one sender at a time per outgoing ring and one receiver at a time per
+  //  incoming ring
+  pthread_mutex_t *send_locks = 0;
+  pthread_mutex_t *recv_locks = 0;
+
+  // a handler can't block waiting for ring space, so replies that don't fit
+  //  are held here until the ring drains
+  pthread_mutex_t *pending_locks = 0;
+  std::deque<std::vector<char> > *pending_replies = 0;
+  volatile int *pending_counts = 0;
+
+  // rank 0 keeps track of the processes it forked - entries are cleared as
+  //  the children are reaped
+  volatile pid_t *children = 0;
+  volatile sig_atomic_t aborting = 0;
+  bool exiting = false;
+
+  inline Ring& ring(gasnet_node_t src, gasnet_node_t dst)
+  {
+    return rings[src * gasnetc_nodes + dst];
+  }
+
+  size_t round_up(size_t val, size_t align)
+  {
+    return ((val + align - 1) / align) * align;
+  }
+
+  void segment_name(char *name, gasnet_node_t node)
+  {
+    sprintf(name, "/realm_shm.%d.%d", (int)job_id, (int)node);
+  }
+
+  char *translate(gasnet_node_t node, const void *addr, size_t nbytes)
+  {
+    if(node == gasnetc_mynode)
+      return (char *)addr;
+    size_t offset = (const char *)addr - remote_bases[node];
+    assert((offset + nbytes) <= segment_sizes[node]);
+    return local_bases[node] + offset;
+  }
+
+  void reap_children(bool block)
+  {
+    for(gasnet_node_t i = 1; i < gasnetc_nodes; i++) {
+      pid_t pid = children[i];
+      if(pid == 0) continue;
+      int status;
+      pid_t ret = waitpid(pid, &status, (block ? 0 : WNOHANG));
+      if(ret == 0) continue;  // still running
+      if(ret < 0) {
+	if(errno == EINTR) { i--; continue; }
+	// reaped by someone else (i.e. the signal handler) - they'll deal
+	//  with any failure
+	children[i] = 0;
+	continue;
+      }
+      children[i] = 0;
+      if(!WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+	if(aborting) continue;
+	// take down the rest of the job - the other children die with us
+	static const char msg[] = "shm conduit: a node exited abnormally - terminating job\n";
+	ssize_t dummy = write(2, msg, sizeof(msg) - 1);
+	(void)dummy;
+	_exit(1);
+      }
+    }
+  }
+
+  void child_exited(int signum)
+  {
+    int saved_errno = errno;
+    reap_children(false);
+    errno = saved_errno;
+  }
+
+  // as with GASNet, the first node to exit takes the rest of the job with
+  //  it - this matters because nodes don't wait for their last messages to
+  //  go out before exiting
+  void job_exiting(int status, void *arg)
+  {
+    exiting = true;
+    if(!control->exit_requested) {
+      control->exit_code = status;
+      __sync_synchronize();
+      control->exit_requested = 1;
+    }
+    if((gasnetc_mynode == 0) && !aborting)
+      reap_children(true);
+  }
+
+  void check_for_exit(void)
+  {
+    if(!control->exit_requested || exiting) return;
+    fflush(stdout);
+    fflush(stderr);
+    if(gasnetc_mynode == 0)
+      reap_children(true);
+    _exit(control->exit_code);
+  }
+
+  // appends a record to our ring to 'dest' if there's room - caller must
+  //  hold send_locks[dest]
+  bool try_write(gasnet_node_t dest, const RecordHeader& hdr, const void *payload)
+  {
+    Ring& r = ring(gasnetc_mynode, dest);
+    uint64_t head = r.head;
+    uint64_t tail = r.tail;
+    size_t offset = head % RING_BYTES;
+    size_t pad = (((offset + hdr.size) > RING_BYTES) ? (RING_BYTES - offset) : 0);
+    if((head + pad + hdr.size - tail) > RING_BYTES)
+      return false;
+    if(pad > 0) {
+      // sizes are multiples of 8, so there's room for the size and kind
+      RecordHeader *p = (RecordHeader *)(r.data + offset);
+      p->size = pad;
+      p->kind = RECORD_PAD;
+      offset = 0;
+    }
+    memcpy(r.data + offset, &hdr, sizeof(RecordHeader));
+    if((hdr.kind == RECORD_MEDIUM) && (hdr.nbytes > 0))
+      memcpy(r.data + offset + sizeof(RecordHeader), payload, hdr.nbytes);
+    // the record must be visible before the head that covers it
+    __sync_synchronize();
+    r.head = head + pad + hdr.size;
+    return true;
+  }
+
+  // caller must hold send_locks[dest]
+  void flush_pending(gasnet_node_t dest)
+  {
+    if(pending_counts[dest] == 0) return;
+    pthread_mutex_lock(&pending_locks[dest]);
+    std::deque<std::vector<char> >& q = pending_replies[dest];
+    while(!q.empty()) {
+      const RecordHeader *hdr = (const RecordHeader *)&(q.front()[0]);
+      if(!try_write(dest, *hdr, hdr + 1))
+	break;
+      q.pop_front();
+    }
+    pending_counts[dest] = q.size();
+    pthread_mutex_unlock(&pending_locks[dest]);
+  }
+
+  void queue_pending(gasnet_node_t dest, const RecordHeader& hdr, const void *payload)
+  {
+    std::vector<char> rec(sizeof(RecordHeader) + ((hdr.kind == RECORD_MEDIUM) ? hdr.nbytes : 0));
+    memcpy(&rec[0], &hdr, sizeof(RecordHeader));
+    if(rec.size() > sizeof(RecordHeader))
+      memcpy(&rec[sizeof(RecordHeader)], payload, hdr.nbytes);
+    pthread_mutex_lock(&pending_locks[dest]);
+    pending_replies[dest].push_back(rec);
+    pending_counts[dest] = pending_replies[dest].size();
+    pthread_mutex_unlock(&pending_locks[dest]);
+  }
+
+  int fill_header(RecordHeader& hdr, gasnet_handler_t handler, int category,
+		  size_t nbytes, void *dest_addr,
+		  int numargs, const gasnet_handlerarg_t *args)
+  {
+    if((numargs < 0) || (numargs > MAX_ARGS))
+      return GASNET_ERR_BAD_ARG;
+    if((category == GASNETC_AM_MEDIUM) && (nbytes > gasnet_AMMaxMedium()))
+      return GASNET_ERR_BAD_ARG;
+    if((category == GASNETC_AM_LONG) && (nbytes > gasnet_AMMaxLongRequest()))
+      return GASNET_ERR_BAD_ARG;
+    size_t size = sizeof(RecordHeader);
+    if(category == GASNETC_AM_MEDIUM)
+      size += nbytes;
+    hdr.size = round_up(size, 8);
+    hdr.kind = category;
+    hdr.handler = handler;
+    hdr.numargs = numargs;
+    hdr.nbytes = nbytes;
+    hdr.dest_addr = (uintptr_t)dest_addr;
+    for(int i = 0; i < numargs; i++)
+      hdr.args[i] = args[i];
+    return GASNET_OK;
+  }
+
+#define ARGTYPES_0
+#define ARGTYPES_1 , gasnet_handlerarg_t
+#define ARGTYPES_2 ARGTYPES_1, gasnet_handlerarg_t
+#define ARGTYPES_3 ARGTYPES_2, gasnet_handlerarg_t
+#define ARGTYPES_4 ARGTYPES_3, gasnet_handlerarg_t
+#define ARGTYPES_5 ARGTYPES_4, gasnet_handlerarg_t
+#define ARGTYPES_6 ARGTYPES_5, gasnet_handlerarg_t
+#define ARGTYPES_7 ARGTYPES_6, gasnet_handlerarg_t
+#define ARGTYPES_8 ARGTYPES_7, gasnet_handlerarg_t
+#define ARGTYPES_9 ARGTYPES_8, gasnet_handlerarg_t
+#define ARGTYPES_10 ARGTYPES_9, gasnet_handlerarg_t
+#define ARGTYPES_11 ARGTYPES_10, gasnet_handlerarg_t
+#define ARGTYPES_12 ARGTYPES_11, gasnet_handlerarg_t
+#define ARGTYPES_13 ARGTYPES_12, gasnet_handlerarg_t
+#define ARGTYPES_14 ARGTYPES_13, gasnet_handlerarg_t
+#define ARGTYPES_15 ARGTYPES_14, gasnet_handlerarg_t
+#define ARGTYPES_16 ARGTYPES_15, gasnet_handlerarg_t
+
+#define ARGVALUES_0
+#define ARGVALUES_1 , a[0]
+#define ARGVALUES_2 ARGVALUES_1, a[1]
+#define ARGVALUES_3 ARGVALUES_2, a[2]
+#define ARGVALUES_4 ARGVALUES_3, a[3]
+#define ARGVALUES_5 ARGVALUES_4, a[4]
+#define ARGVALUES_6 ARGVALUES_5, a[5]
+#define ARGVALUES_7 ARGVALUES_6, a[6]
+#define ARGVALUES_8 ARGVALUES_7, a[7]
+#define ARGVALUES_9 ARGVALUES_8, a[8]
+#define ARGVALUES_10 ARGVALUES_9, a[9]
+#define ARGVALUES_11 ARGVALUES_10, a[10]
+#define ARGVALUES_12 ARGVALUES_11, a[11]
+#define ARGVALUES_13 ARGVALUES_12, a[12]
+#define ARGVALUES_14 ARGVALUES_13, a[13]
+#define ARGVALUES_15 ARGVALUES_14, a[14]
+#define ARGVALUES_16 ARGVALUES_15, a[15]
+
+#define SHORT_CASE(n) \
+  case n: ((void (*)(gasnet_token_t ARGTYPES_##n))fn)(&token ARGVALUES_##n); break
+#define PAYLOAD_CASE(n) \
+  case n: ((void (*)(gasnet_token_t, void *, size_t ARGTYPES_##n))fn)(&token, buf, nbytes ARGVALUES_##n); break
+
+  void dispatch(gasnet_node_t source, const RecordHeader *hdr)
+  {
+    void (*fn)() = handler_table[hdr->handler];
+    if(!fn) {
+      fprintf(stderr, "shm conduit: no handler registered for message %d from node %d\n",
+	      hdr->handler, source);
+      abort();
+    }
+    Token token;
+    token.source = source;
+    const gasnet_handlerarg_t *a = hdr->args;
+
+    if(hdr->kind == RECORD_SHORT) {
+      switch(hdr->numargs) {
+	SHORT_CASE(0); SHORT_CASE(1); SHORT_CASE(2); SHORT_CASE(3);
+	SHORT_CASE(4); SHORT_CASE(5); SHORT_CASE(6); SHORT_CASE(7);
+	SHORT_CASE(8); SHORT_CASE(9); SHORT_CASE(10); SHORT_CASE(11);
+	SHORT_CASE(12); SHORT_CASE(13); SHORT_CASE(14); SHORT_CASE(15);
+	SHORT_CASE(16);
+      default: assert(0);
+      }
+    } else {
+      // a long payload was copied straight to its destination before the
+      //  record was written
+      void *buf = ((hdr->kind == RECORD_MEDIUM) ?
+		     (void *)(hdr + 1) :
+		     (void *)(uintptr_t)(hdr->dest_addr));
+      size_t nbytes = hdr->nbytes;
+      switch(hdr->numargs) {
+	PAYLOAD_CASE(0); PAYLOAD_CASE(1); PAYLOAD_CASE(2); PAYLOAD_CASE(3);
+	PAYLOAD_CASE(4); PAYLOAD_CASE(5); PAYLOAD_CASE(6); PAYLOAD_CASE(7);
+	PAYLOAD_CASE(8); PAYLOAD_CASE(9); PAYLOAD_CASE(10); PAYLOAD_CASE(11);
+	PAYLOAD_CASE(12); PAYLOAD_CASE(13); PAYLOAD_CASE(14); PAYLOAD_CASE(15);
+	PAYLOAD_CASE(16);
+      default: assert(0);
+      }
+    }
+  }
+
+#undef SHORT_CASE
+#undef PAYLOAD_CASE
+
+  // handles everything currently in the ring from 'source' unless another
+  //  thread is already doing so
+  void poll_ring(gasnet_node_t source)
+  {
+    if(pthread_mutex_trylock(&recv_locks[source]) != 0)
+      return;
+    Ring& r = ring(source, gasnetc_mynode);
+    uint64_t tail = r.tail;
+    uint64_t head = r.head;
+    // don't read any records until we've seen the head that covers them
+    __sync_synchronize();
+    while(tail != head) {
+      const RecordHeader *hdr = (const RecordHeader *)(r.data + (tail % RING_BYTES));
+      uint32_t size = hdr->size;
+      if(hdr->kind != RECORD_PAD)
+	dispatch(source, hdr);
+      tail += size;
+      // a medium payload stays valid until the handler returns, so the
+      //  space can only be given back now
+      __sync_synchronize();
+      r.tail = tail;
+    }
+    pthread_mutex_unlock(&recv_locks[source]);
+  }
+
+  void poll_all(void)
+  {
+    check_for_exit();
+    for(gasnet_node_t i = 0; i < gasnetc_nodes; i++)
+      if(pending_counts[i] && (pthread_mutex_trylock(&send_locks[i]) == 0)) {
+	flush_pending(i);
+	pthread_mutex_unlock(&send_locks[i]);
+      }
+    for(gasnet_node_t i = 0; i < gasnetc_nodes; i++)
+      poll_ring(i);
+  }
+
+};
+
+int gasnet_init(int *argc, char ***argv)
+{
+  int nodes = 1;
+  const char *e = getenv("GASNET_PSHM_NODES");
+  if(e) {
+    nodes = atoi(e);
+    if((nodes < 1) || (nodes > 256)) {
+      fprintf(stderr, "shm conduit: GASNET_PSHM_NODES must be between 1 and 256 (got '%s')\n", e);
+      return GASNET_ERR_BAD_ARG;
+    }
+  }
+  gasnetc_nodes = nodes;
+
+  size_t slots_offset = round_up(sizeof(ControlHeader), CACHE_LINE);
+  size_t rings_offset = round_up(slots_offset + nodes * sizeof(SegmentSlot), CACHE_LINE);
+  size_t control_size = rings_offset + (size_t)nodes * nodes * sizeof(Ring);
+  // anonymous memory is zeroed, which is the initial state of everything
+  void *base = mmap(0, control_size, PROT_READ | PROT_WRITE,
+		    MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if(base == MAP_FAILED) {
+    perror("shm conduit: mmap of control region");
+    return GASNET_ERR_RESOURCE;
+  }
+  control = (ControlHeader *)base;
+  slots = (SegmentSlot *)(((char *)base) + slots_offset);
+  rings = (Ring *)(((char *)base) + rings_offset);
+
+  send_locks = new pthread_mutex_t[nodes];
+  recv_locks = new pthread_mutex_t[nodes];
+  pending_locks = new pthread_mutex_t[nodes];
+  for(int i = 0; i < nodes; i++) {
+    pthread_mutex_init(&send_locks[i], 0);
+    pthread_mutex_init(&recv_locks[i], 0);
+    pthread_mutex_init(&pending_locks[i], 0);
+  }
+  pending_replies = new std::deque<std::vector<char> >[nodes];
+  pending_counts = new int[nodes];
+  children = new pid_t[nodes];
+  for(int i = 0; i < nodes; i++) {
+    pending_counts[i] = 0;
+    children[i] = 0;
+  }
+
+  // anything still buffered would otherwise be printed once per process
+  fflush(stdout);
+  fflush(stderr);
+
+  job_id = getpid();
+  for(int i = 1; i < nodes; i++) {
+    pid_t pid = fork();
+    if(pid < 0) {
+      perror("shm conduit: fork");
+      for(int j = 1; j < i; j++)
+	kill(children[j], SIGKILL);
+      return GASNET_ERR_RESOURCE;
+    }
+    if(pid == 0) {
+      gasnetc_mynode = i;
+      // don't outlive the job if rank 0 goes away
+      prctl(PR_SET_PDEATHSIG, SIGKILL);
+      if(getppid() != job_id)
+	_exit(1);
+      for(int j = 1; j < i; j++)
+	children[j] = 0;
+      on_exit(job_exiting, 0);
+      return GASNET_OK;
+    }
+    children[i] = pid;
+  }
+
+  if(nodes > 1) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = child_exited;
+    sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &sa, 0);
+    // catch anything that exited before the handler was installed
+    reap_children(false);
+  }
+  on_exit(job_exiting, 0);
+
+  return GASNET_OK;
+}
+
+int gasnet_attach(gasnet_handlerentry_t *table, int numentries,
+		  uintptr_t segsize, uintptr_t minheapoffset)
+{
+  for(int i = 0; i < numentries; i++)
+    handler_table[table[i].index] = table[i].fnptr;
+
+  gasnet_node_t nodes = gasnetc_nodes;
+  gasnet_node_t me = gasnetc_mynode;
+  remote_bases.resize(nodes, 0);
+  local_bases.resize(nodes, 0);
+  segment_sizes.resize(nodes, 0);
+
+  segsize = round_up(segsize, sysconf(_SC_PAGESIZE));
+  char name[64];
+  segment_name(name, me);
+  if(segsize > 0) {
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd < 0) {
+      perror("shm conduit: shm_open");
+      return GASNET_ERR_RESOURCE;
+    }
+    void *base = MAP_FAILED;
+    if(ftruncate(fd, segsize) == 0)
+      base = mmap(0, segsize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED) {
+      perror("shm conduit: segment allocation");
+      shm_unlink(name);
+      return GASNET_ERR_RESOURCE;
+    }
+    slots[me].base = (uintptr_t)base;
+    slots[me].size = segsize;
+  }
+
+  gasnet_barrier_notify(0, GASNET_BARRIERFLAG_ANONYMOUS);
+  gasnet_barrier_wait(0, GASNET_BARRIERFLAG_ANONYMOUS);
+
+  for(gasnet_node_t i = 0; i < nodes; i++) {
+    remote_bases[i] = (char *)(uintptr_t)(slots[i].base);
+    segment_sizes[i] = slots[i].size;
+    if(i == me) {
+      local_bases[i] = remote_bases[i];
+      continue;
+    }
+    if(segment_sizes[i] == 0) continue;
+    char peer_name[64];
+    segment_name(peer_name, i);
+    int fd = shm_open(peer_name, O_RDWR, 0);
+    if(fd < 0) {
+      perror("shm conduit: shm_open of peer segment");
+      return GASNET_ERR_RESOURCE;
+    }
+    void *base = mmap(0, segment_sizes[i], PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED) {
+      perror("shm conduit: mmap of peer segment");
+      return GASNET_ERR_RESOURCE;
+    }
+    local_bases[i] = (char *)base;
+  }
+
+  // once everybody has mapped everything, the names can go away so that
+  //  nothing is left behind in /dev/shm however the job ends
+  gasnet_barrier_notify(0, GASNET_BARRIERFLAG_ANONYMOUS);
+  gasnet_barrier_wait(0, GASNET_BARRIERFLAG_ANONYMOUS);
+  if(segsize > 0)
+    shm_unlink(name);
+
+  attached = true;
+  return GASNET_OK;
+}
+
+void gasnet_exit(int exitcode)
+{
+  fflush(stdout);
+  fflush(stderr);
+  if(exitcode != 0) {
+    aborting = 1;
+    if(gasnetc_mynode == 0)
+      for(gasnet_node_t i = 1; i < gasnetc_nodes; i++)
+	if(children[i] != 0)
+	  kill(children[i], SIGKILL);
+  }
+  exit(exitcode);
+}
+
+int gasnet_set_waitmode(int wait_mode)
+{
+  return GASNET_OK;
+}
+
+uintptr_t gasnet_getMaxLocalSegmentSize(void)
+{
+  struct statvfs sv;
+  if(statvfs("/dev/shm", &sv) == 0)
+    return (uintptr_t)sv.f_bavail * sv.f_frsize;
+  return (uintptr_t)-1;
+}
+
+int gasnet_getSegmentInfo(gasnet_seginfo_t *seginfo_table, int numentries)
+{
+  if(!attached)
+    return GASNET_ERR_NOT_READY;
+  for(int i = 0; (i < numentries) && (i < (int)gasnetc_nodes); i++) {
+    seginfo_table[i].addr = remote_bases[i];
+    seginfo_table[i].size = segment_sizes[i];
+  }
+  return GASNET_OK;
+}
+
+const char *gasnet_ErrorName(int errval)
+{
+  switch(errval) {
+  case GASNET_OK: return "GASNET_OK";
+  case GASNET_ERR_RESOURCE: return "GASNET_ERR_RESOURCE";
+  case GASNET_ERR_BAD_ARG: return "GASNET_ERR_BAD_ARG";
+  case GASNET_ERR_NOT_READY: return "GASNET_ERR_NOT_READY";
+  default: return "unknown error";
+  }
+}
+
+const char *gasnet_ErrorDesc(int errval)
+{
+  switch(errval) {
+  case GASNET_OK: return "no error";
+  case GASNET_ERR_RESOURCE: return "out of shared memory or processes";
+  case GASNET_ERR_BAD_ARG: return "invalid argument";
+  case GASNET_ERR_NOT_READY: return "not ready";
+  default: return "unknown error";
+  }
+}
+
+// a sense-reversing barrier in the control region - waiters keep handling
+//  messages so that nobody stalls a node that is still sending
+
+void gasnet_barrier_notify(int id, int flags)
+{
+  barrier_sense = !barrier_sense;
+  if(__sync_add_and_fetch(&control->barrier_count, 1) == (int)gasnetc_nodes) {
+    control->barrier_count = 0;
+    __sync_synchronize();
+    control->barrier_sense = barrier_sense;
+  }
+}
+
+int gasnet_barrier_wait(int id, int flags)
+{
+  while(control->barrier_sense != barrier_sense) {
+    gasnet_AMPoll();
+    sched_yield();
+  }
+  __sync_synchronize();
+  return GASNET_OK;
+}
+
+int gasnetc_am_request(gasnet_node_t dest, gasnet_handler_t handler, int category,
+		       const void *source_addr, size_t nbytes, void *dest_addr,
+		       int numargs, const gasnet_handlerarg_t *args)
+{
+  if(dest >= gasnetc_nodes)
+    return GASNET_ERR_BAD_ARG;
+  RecordHeader hdr;
+  int ret = fill_header(hdr, handler, category, nbytes, dest_addr, numargs, args);
+  if(ret != GASNET_OK)
+    return ret;
+
+  // a long payload goes straight to its destination - the ring write that
+  //  follows orders it before the handler runs
+  if((category == GASNETC_AM_LONG) && (nbytes > 0))
+    memcpy(translate(dest, dest_addr, nbytes), source_addr, nbytes);
+
+  pthread_mutex_lock(&send_locks[dest]);
+  flush_pending(dest);
+  while(!try_write(dest, hdr, source_addr)) {
+    // the destination may be stuck sending to us, so keep our own incoming
+    //  rings moving while we wait for space
+    poll_all();
+    sched_yield();
+    flush_pending(dest);
+  }
+  pthread_mutex_unlock(&send_locks[dest]);
+  return GASNET_OK;
+}
+
+int gasnetc_am_reply(gasnet_token_t token, gasnet_handler_t handler, int category,
+		     const void *source_addr, size_t nbytes, void *dest_addr,
+		     int numargs, const gasnet_handlerarg_t *args)
+{
+  gasnet_node_t dest = ((Token *)token)->source;
+  RecordHeader hdr;
+  int ret = fill_header(hdr, handler, category, nbytes, dest_addr, numargs, args);
+  if(ret != GASNET_OK)
+    return ret;
+
+  if((category == GASNETC_AM_LONG) && (nbytes > 0))
+    memcpy(translate(dest, dest_addr, nbytes), source_addr, nbytes);
+
+  // the send lock may be held by this very thread if the handler is being
+  //  run from within a blocked request, so never wait for it
+  if(pthread_mutex_trylock(&send_locks[dest]) == 0) {
+    flush_pending(dest);
+    bool sent = ((pending_counts[dest] == 0) && try_write(dest, hdr, source_addr));
+    pthread_mutex_unlock(&send_locks[dest]);
+    if(sent)
+      return GASNET_OK;
+  }
+  queue_pending(dest, hdr, source_addr);
+  return GASNET_OK;
+}
+
+int gasnet_AMPoll(void)
+{
+  if(attached)
+    poll_all();
+  else
+    check_for_exit();
+  return GASNET_OK;
+}
+
+int gasnet_AMGetMsgSource(gasnet_token_t token, gasnet_node_t *srcindex)
+{
+  *srcindex = ((Token *)token)->source;
+  return GASNET_OK;
+}
+
+void gasnet_get(void *dest, gasnet_node_t node, void *src, size_t nbytes)
+{
+  memcpy(dest, translate(node, src, nbytes), nbytes);
+}
+
+void gasnet_put(gasnet_node_t node, void *dest, void *src, size_t nbytes)
+{
+  memcpy(translate(node, dest, nbytes), src, nbytes);
+  // make the data visible before any message that announces it
+  __sync_synchronize();
+}
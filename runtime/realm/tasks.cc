@@ -19,6 +19,8 @@
 
 #include "runtime_impl.h"
 
+#include <pthread.h>
+
 namespace Realm {
 
   Logger log_task("task");
@@ -46,6 +48,121 @@ namespace Realm {
   {
   }
 
+  // Task storage is recycled through a small per-thread cache of free blocks,
+  //  which needs no locking - tasks are usually freed on a different thread
+  //  (the one that ran them) than the one that allocated them, so caches
+  //  that grow too large spill half their blocks to a shared pool, and empty
+  //  caches refill from that pool before falling back to the heap
+  namespace {
+    struct FreeTaskBlock {
+      FreeTaskBlock *next;
+    };
+
+    static const size_t TASK_CACHE_MAX = 64;
+    static const size_t TASK_CACHE_BATCH = TASK_CACHE_MAX / 2;
+
+    struct TaskCache {
+      FreeTaskBlock *head;
+      size_t count;
+      bool registered;  // with task_cache_key, so it's flushed on thread exit
+    };
+
+    __thread TaskCache task_cache = { 0, 0, false };
+
+    GASNetHSL shared_task_pool_mutex;
+    FreeTaskBlock *shared_task_pool = 0;
+
+    pthread_key_t task_cache_key;
+    pthread_once_t task_cache_key_once = PTHREAD_ONCE_INIT;
+
+    // destructor for task_cache_key - an exiting thread's cached blocks go
+    //  back to the shared pool rather than being stranded
+    void release_task_cache(void *ptr)
+    {
+      TaskCache& tc = *static_cast<TaskCache *>(ptr);
+      if(tc.head) {
+	FreeTaskBlock *last = tc.head;
+	while(last->next)
+	  last = last->next;
+
+	AutoHSLLock al(shared_task_pool_mutex);
+	last->next = shared_task_pool;
+	shared_task_pool = tc.head;
+      }
+      tc.head = 0;
+      tc.count = 0;
+      tc.registered = false;
+    }
+
+    void create_task_cache_key(void)
+    {
+      pthread_key_create(&task_cache_key, release_task_cache);
+    }
+  };
+
+  /*static*/ void *Task::operator new(size_t size)
+  {
+    // anything other than a plain Task (e.g. a subclass) uses the heap
+    if(size != sizeof(Task))
+      return ::operator new(size);
+
+    TaskCache& tc = task_cache;
+    if(!tc.head) {
+      AutoHSLLock al(shared_task_pool_mutex);
+      while(shared_task_pool && (tc.count < TASK_CACHE_BATCH)) {
+	FreeTaskBlock *b = shared_task_pool;
+	shared_task_pool = b->next;
+	b->next = tc.head;
+	tc.head = b;
+	tc.count++;
+      }
+    }
+
+    if(tc.head) {
+      FreeTaskBlock *b = tc.head;
+      tc.head = b->next;
+      tc.count--;
+      return b;
+    }
+
+    return ::operator new(size);
+  }
+
+  /*static*/ void Task::operator delete(void *ptr, size_t size)
+  {
+    if(!ptr) return;
+    if(size != sizeof(Task)) {
+      ::operator delete(ptr);
+      return;
+    }
+
+    TaskCache& tc = task_cache;
+    if(!tc.registered) {
+      pthread_once(&task_cache_key_once, create_task_cache_key);
+      pthread_setspecific(task_cache_key, &tc);
+      tc.registered = true;
+    }
+
+    FreeTaskBlock *b = static_cast<FreeTaskBlock *>(ptr);
+    b->next = tc.head;
+    tc.head = b;
+    tc.count++;
+
+    if(tc.count > TASK_CACHE_MAX) {
+      // detach a batch and hand it to the shared pool
+      FreeTaskBlock *first = tc.head;
+      FreeTaskBlock *last = first;
+      for(size_t i = 1; i < TASK_CACHE_BATCH; i++)
+	last = last->next;
+      tc.head = last->next;
+      tc.count -= TASK_CACHE_BATCH;
+
+      AutoHSLLock al(shared_task_pool_mutex);
+      last->next = shared_task_pool;
+      shared_task_pool = first;
+    }
+  }
+
   void Task::mark_ready(void)
   {
     log_task.info() << "task " << this << " ready: func=" << func_id
@@ -125,6 +242,19 @@ namespace Realm {
   }
 
 
+  void Task::record_runtime_overhead(long long scheduler_time)
+  {
+    if(measurements.wants_measurement<ProfilingMeasurements::ProcessorRuntimeOverhead>()) {
+      ProfilingMeasurements::ProcessorRuntimeOverhead pro;
+      pro.proc = proc;
+      pro.scheduler_time = scheduler_time;
+      pro.event_time = RuntimeOverhead::total_time(RuntimeOverhead::EVENT_TRIGGER);
+      pro.message_time = RuntimeOverhead::total_time(RuntimeOverhead::MESSAGE_HANDLER);
+      measurements.add_measurement(pro);
+    }
+  }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class ThreadedTaskScheduler::WorkCounter
@@ -248,6 +378,7 @@ namespace Realm {
     : shutdown_flag(false)
     , active_worker_count(0)
     , unassigned_worker_count(0)
+    , overhead_time(0)
     , wcu_task_queues(this)
     , wcu_resume_queue(this)
     , cfg_reuse_workers(true)
@@ -332,7 +463,9 @@ namespace Realm {
 	Thread *yield_to = resumable_workers.get(0); // we don't care about priority
 	// first check - is this US?  if so, we're done
 	if(yield_to == thread) {
-	  printf("resuming ourselves!\n");
+	  // happens when we were waiting for work below and our own wakeup
+	  //  was what showed up
+	  log_sched.debug() << "scheduler worker resuming itself: sched=" << this << " worker=" << thread;
 	  return;
 	}
 	// this preserves active and unassigned counts
@@ -363,7 +496,7 @@ namespace Realm {
 	
       // last choice - create a new worker to mind the store
       // TODO: consider not doing this until we know there's work for it?
-      if(true) {
+      if(worker_create_allowed()) {
 	Thread *yield_to = worker_create(false);
 	// this preserves the active count, increased unassigned by 1
 	update_worker_count(0, +1);
@@ -377,6 +510,11 @@ namespace Realm {
     }
   }
 
+  /*virtual*/ bool ThreadedTaskScheduler::worker_create_allowed(void)
+  {
+    return true;
+  }
+
   void ThreadedTaskScheduler::thread_ready(Thread *thread)
   {
     log_sched.debug() << "scheduler worker ready: sched=" << this << " worker=" << thread;
@@ -438,6 +576,10 @@ namespace Realm {
 	  old_work_counter = work_counter.read_counter();  // re-read - may have changed while we slept
 	}
 
+	// time spent looking for a task counts as overhead only if one is found
+	long long search_start = (RuntimeOverhead::is_enabled() ?
+				    Clock::current_time_in_nanoseconds() : 0);
+
 	// try to get a new task then
 	// remember where a task has come from in case we want to put it back
 	Task *task = 0;
@@ -476,15 +618,32 @@ namespace Realm {
 	  //  priority here
 	  worker_priorities[Thread::self()] = task_priority;
 
+	  long long sched_time = 0;
+	  if(search_start != 0) {
+	    overhead_time += Clock::current_time_in_nanoseconds() - search_start;
+	    sched_time = overhead_time;
+	  }
+
 	  // release the lock while we run the task
 	  lock.unlock();
 
+	  if(search_start != 0)
+	    task->record_runtime_overhead(sched_time);
+
 	  bool ok = execute_task(task);
 	  assert(ok);  // no fault recovery yet
 
+	  long long relock_start = (RuntimeOverhead::is_enabled() ?
+				      Clock::current_time_in_nanoseconds() : 0);
+
 	  lock.lock();
 
-	  worker_priorities.erase(Thread::self());
+	  if(relock_start != 0)
+	    overhead_time += Clock::current_time_in_nanoseconds() - relock_start;
+
+	  // this worker's entry in worker_priorities is left in place (its next
+	  //  task will overwrite it) rather than paying for a map erase and
+	  //  insert on every task - it's removed when the worker thread exits
 
 	  // and we're back to being unassigned
 	  update_worker_count(0, +1);
@@ -679,6 +838,7 @@ namespace Realm {
     // detach and delete the worker thread - better be expected now
     assert(terminating_workers.count(thread) > 0);
     terminating_workers.erase(thread);
+    worker_priorities.erase(thread);
     thread->detach();
     delete thread;
 
@@ -802,6 +962,8 @@ namespace Realm {
     : proc(_proc)
     , core_rsrv(_core_rsrv)
     , cfg_num_host_threads(1)
+    , cfg_max_workers(0)
+    , cfg_stack_size(0)
   {
   }
 
@@ -882,6 +1044,8 @@ namespace Realm {
   inline void UserThreadTaskScheduler::do_user_thread_cleanup(void)
   {
     if(ThreadLocal::terminated_user_thread != 0) {
+      // caller holds lock
+      worker_priorities.erase(ThreadLocal::terminated_user_thread);
       delete ThreadLocal::terminated_user_thread;
       ThreadLocal::terminated_user_thread = 0;
     }
@@ -932,6 +1096,8 @@ namespace Realm {
     assert(!make_active);
 
     ThreadLaunchParameters tlp;
+    if(cfg_stack_size > 0)
+      tlp.set_stack_size(cfg_stack_size);
     Thread *t = Thread::create_user_thread<ThreadedTaskScheduler,
 					   &ThreadedTaskScheduler::scheduler_loop>(this,
 										   tlp,
@@ -941,6 +1107,13 @@ namespace Realm {
     //  active_workers.insert(t);
     return t;
   }
+
+  bool UserThreadTaskScheduler::worker_create_allowed(void)
+  {
+    // lock held by caller
+    return ((cfg_max_workers <= 0) ||
+	    ((int)(all_workers.size()) < cfg_max_workers));
+  }
     
   void UserThreadTaskScheduler::worker_sleep(Thread *switch_to)
   {
@@ -42,11 +42,20 @@ namespace Realm {
 
       virtual ~Task(void);
 
+      // tasks are created and destroyed at a high rate, so their storage is
+      //  recycled through per-thread freelists instead of the heap
+      static void *operator new(size_t size);
+      static void operator delete(void *ptr, size_t size);
+
       virtual void mark_ready(void);
       virtual void mark_started(void);
 
       void execute_on_processor(Processor p);
 
+      // called by the scheduler before the task starts, if runtime overhead
+      //  accounting is enabled
+      void record_runtime_overhead(long long scheduler_time);
+
       Processor proc;
       Processor::TaskFuncID func_id;
       ByteArray args;
@@ -92,6 +101,9 @@ namespace Realm {
       virtual bool execute_task(Task *task) = 0;
 
       virtual Thread *worker_create(bool make_active) = 0;
+      // a blocking worker that can't hand off to an existing worker creates a
+      //  new one only if this says it may - otherwise it waits for new work
+      virtual bool worker_create_allowed(void);
       virtual void worker_sleep(Thread *switch_to) = 0;
       virtual void worker_wake(Thread *to_wake) = 0;
       virtual void worker_terminate(Thread *switch_to) = 0;
@@ -106,6 +118,9 @@ namespace Realm {
       bool shutdown_flag;
       int active_worker_count;  // workers that are awake (i.e. using a core)
       int unassigned_worker_count;  // awake but unassigned workers
+      // time spent finding tasks and doing the bookkeeping around them (in
+      //  ns), once runtime overhead accounting is enabled
+      long long overhead_time;
 
       // helper for tracking/sanity-checking worker counts
       void update_worker_count(int active_delta, int unassigned_delta, bool check = true);
@@ -240,6 +255,7 @@ namespace Realm {
       void do_user_thread_cleanup(void);
       
       virtual Thread *worker_create(bool make_active);
+      virtual bool worker_create_allowed(void);
       virtual void worker_sleep(Thread *switch_to);
       virtual void worker_wake(Thread *to_wake);
       virtual void worker_terminate(Thread *switch_to);
@@ -254,6 +270,11 @@ namespace Realm {
 
     public:
       int cfg_num_host_threads;
+      // upper bound on user threads (i.e. tasks that may be blocked at once),
+      //  0 = unlimited
+      int cfg_max_workers;
+      // stack size of each user thread, 0 = default
+      size_t cfg_stack_size;
     };
 #endif
 
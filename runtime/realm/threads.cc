@@ -32,7 +32,20 @@
 #endif
 
 #ifdef REALM_USE_USER_THREADS
+// on x86-64 Linux, user threads switch with a few instructions of assembly
+//  rather than swapcontext, which also saves and restores the signal mask
+//  with a system call on every switch
+#if defined(__x86_64__) && defined(__linux__)
+#define REALM_USE_FAST_USER_SWITCH
+#endif
+// user thread stacks are mmap'd with a guard page
+#include <sys/mman.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <vector>
+#ifndef REALM_USE_FAST_USER_SWITCH
 #include <ucontext.h>
+#endif
 #ifdef __MACH__
 // MacOS has (loudly) deprecated set/get/make/swapcontext,
 //  despite there being no POSIX replacement for them...
@@ -671,6 +684,168 @@ namespace Realm {
   }
 
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // user thread contexts and stacks
+
+#ifdef REALM_USE_USER_THREADS
+#ifdef REALM_USE_FAST_USER_SWITCH
+  // a saved context is just a stack pointer - everything else the ABI says
+  //  must survive a call (callee-saved registers, SSE/x87 control words) is
+  //  pushed on the stack being switched away from
+  struct UserContext {
+    void *sp;
+  };
+
+  extern "C" void realm_user_context_switch(void **save_sp, void *restore_sp);
+
+  asm(".text\n"
+      ".globl realm_user_context_switch\n"
+      ".type realm_user_context_switch, @function\n"
+      "realm_user_context_switch:\n"
+      "  pushq %rbp\n"
+      "  pushq %rbx\n"
+      "  pushq %r12\n"
+      "  pushq %r13\n"
+      "  pushq %r14\n"
+      "  pushq %r15\n"
+      "  subq $8, %rsp\n"
+      "  stmxcsr (%rsp)\n"
+      "  fnstcw 4(%rsp)\n"
+      "  movq %rsp, (%rdi)\n"
+      "  movq %rsi, %rsp\n"
+      "  ldmxcsr (%rsp)\n"
+      "  fldcw 4(%rsp)\n"
+      "  addq $8, %rsp\n"
+      "  popq %r15\n"
+      "  popq %r14\n"
+      "  popq %r13\n"
+      "  popq %r12\n"
+      "  popq %rbx\n"
+      "  popq %rbp\n"
+      "  ret\n"
+      ".size realm_user_context_switch, .-realm_user_context_switch\n");
+
+  // builds a frame on the new stack that realm_user_context_switch will
+  //  "return" into 'entry' from
+  static void user_context_init(UserContext& ctx, void *stack_base, size_t stack_size,
+				void (*entry)(void))
+  {
+    uintptr_t top = (reinterpret_cast<uintptr_t>(stack_base) + stack_size) & ~(uintptr_t)15;
+    void **frame = reinterpret_cast<void **>(top);
+    *--frame = 0;                               // entry's (nonexistent) return address
+    *--frame = reinterpret_cast<void *>(entry); // popped by the 'ret'
+    for(int i = 0; i < 6; i++)
+      *--frame = 0;                             // rbp, rbx, r12-r15
+    // start with the same floating point control state as the creating thread
+    unsigned mxcsr;
+    unsigned short fcw;
+    asm volatile("stmxcsr %0" : "=m" (mxcsr));
+    asm volatile("fnstcw %0" : "=m" (fcw));
+    --frame;
+    memcpy(reinterpret_cast<char *>(frame), &mxcsr, 4);
+    memcpy(reinterpret_cast<char *>(frame) + 4, &fcw, 2);
+    ctx.sp = frame;
+  }
+
+  static inline void user_context_switch(UserContext *from, UserContext *to)
+  {
+    realm_user_context_switch(&from->sp, to->sp);
+  }
+#else
+  typedef ucontext_t UserContext;
+
+  static void user_context_init(UserContext& ctx, void *stack_base, size_t stack_size,
+				void (*entry)(void))
+  {
+    getcontext(&ctx);
+
+    ctx.uc_link = 0; // we don't expect it to ever fall through
+    ctx.uc_stack.ss_sp = stack_base;
+    ctx.uc_stack.ss_size = stack_size;
+    ctx.uc_stack.ss_flags = 0;
+
+    // grr...  entry point takes int's, which might not hold a void *
+    // we'll just fish our UserThread * out of TLS
+    makecontext(&ctx, entry, 0);
+  }
+
+  static inline void user_context_switch(UserContext *from, UserContext *to)
+  {
+    int ret = swapcontext(from, to);
+    assert(ret == 0);
+  }
+#endif
+
+  // user thread stacks are mmap'd with an inaccessible guard page below them,
+  //  so that an overflow faults instead of silently corrupting the heap, and
+  //  stacks of terminated threads are kept for reuse since the mmap/mprotect
+  //  pair is far more expensive than creating the thread itself
+  namespace UserStackPool {
+    static const size_t MAX_POOLED_STACKS = 32;
+
+    static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    // allocated on first use and never destroyed, so that threads still
+    //  running during static destruction don't touch a dead map
+    static std::map<size_t, std::vector<void *> > *pool = 0;
+    static size_t pooled_count = 0;
+
+    static size_t guard_size(void)
+    {
+      static size_t page_size = 0;
+      if(page_size == 0)
+	page_size = sysconf(_SC_PAGESIZE);
+      return page_size;
+    }
+
+    // returns the lowest usable address of a stack of (at least) 'size' bytes
+    static void *allocate(size_t size)
+    {
+      pthread_mutex_lock(&mutex);
+      if(pool) {
+	std::map<size_t, std::vector<void *> >::iterator it = pool->find(size);
+	if((it != pool->end()) && !it->second.empty()) {
+	  void *base = it->second.back();
+	  it->second.pop_back();
+	  pooled_count--;
+	  pthread_mutex_unlock(&mutex);
+	  return base;
+	}
+      }
+      pthread_mutex_unlock(&mutex);
+
+      size_t guard = guard_size();
+      void *mapping = mmap(0, size + guard, PROT_READ | PROT_WRITE,
+			   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if(mapping == MAP_FAILED) {
+	log_thread.fatal() << "failed to allocate user thread stack of " << size << " bytes";
+	assert(0);
+      }
+      int ret = mprotect(mapping, guard, PROT_NONE);
+      assert(ret == 0);
+      return static_cast<char *>(mapping) + guard;
+    }
+
+    static void release(void *base, size_t size)
+    {
+      pthread_mutex_lock(&mutex);
+      if(pooled_count < MAX_POOLED_STACKS) {
+	if(!pool)
+	  pool = new std::map<size_t, std::vector<void *> >;
+	(*pool)[size].push_back(base);
+	pooled_count++;
+	pthread_mutex_unlock(&mutex);
+	return;
+      }
+      pthread_mutex_unlock(&mutex);
+
+      size_t guard = guard_size();
+      munmap(static_cast<char *>(base) - guard, size + guard);
+    }
+  };
+#endif
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class UserThread
@@ -698,7 +873,7 @@ namespace Realm {
     void *target;
     void (*entry_wrapper)(void *);
     int magic;
-    ucontext_t ctx;
+    UserContext ctx;
     void *stack_base;
     size_t stack_size;
     bool ok_to_delete;
@@ -719,11 +894,11 @@ namespace Realm {
     assert(!running);
 
     if(stack_base != 0)
-      free(stack_base);
+      UserStackPool::release(stack_base, stack_size);
   }
 
   namespace ThreadLocal {
-    __thread ucontext_t *host_context = 0;
+    __thread UserContext *host_context = 0;
     // current_user_thread is redundant with current_thread, but kept for debugging
     //  purposes for now
     __thread UserThread *current_user_thread = 0;
@@ -773,20 +948,13 @@ namespace Realm {
     } else {
       stack_size = 2 << 20; // pick something - 2MB ?
     }
+    // whole pages, so that pooled stacks of a given size are interchangeable
+    size_t page = UserStackPool::guard_size();
+    stack_size = (stack_size + page - 1) & ~(page - 1);
 
-    stack_base = malloc(stack_size);
-    assert(stack_base != 0);
+    stack_base = UserStackPool::allocate(stack_size);
 
-    getcontext(&ctx);
-
-    ctx.uc_link = 0; // we don't expect it to ever fall through
-    ctx.uc_stack.ss_sp = stack_base;
-    ctx.uc_stack.ss_size = stack_size;
-    ctx.uc_stack.ss_flags = 0;
-
-    // grr...  entry point takes int's, which might not hold a void *
-    // we'll just fish our UserThread * out of TLS
-    makecontext(&ctx, uthread_entry, 0);
+    user_context_init(ctx, stack_base, stack_size, uthread_entry);
 
     update_state(STATE_STARTUP);    
   }
@@ -818,18 +986,15 @@ namespace Realm {
       assert(ThreadLocal::host_context == 0);
 
       // this holds the host's state
-      ucontext_t host_ctx;
+      UserContext host_ctx;
 
       ThreadLocal::host_context = &host_ctx;
       ThreadLocal::current_user_thread = switch_to;
       ThreadLocal::current_host_thread = ThreadLocal::current_thread;
       ThreadLocal::current_thread = switch_to;
 
-      int ret = swapcontext(&host_ctx, &switch_to->ctx);
-
-      // if we return with a value of 0, that means we were (eventually) given control
-      //  back, as we hoped
-      assert(ret == 0);
+      // returns when we are (eventually) given control back
+      user_context_switch(&host_ctx, &switch_to->ctx);
 
       assert(ThreadLocal::current_user_thread == 0);
       assert(ThreadLocal::host_context == &host_ctx);
@@ -848,8 +1013,7 @@ namespace Realm {
 	ThreadLocal::current_thread = switch_to;
 
 	// a switch between two user contexts - nice and simple
-	int ret = swapcontext(&switch_from->ctx, &switch_to->ctx);
-	assert(ret == 0);
+	user_context_switch(&switch_from->ctx, &switch_to->ctx);
 
 	assert(switch_from->running == false);
 	switch_from->running = true;
@@ -860,8 +1024,7 @@ namespace Realm {
 	ThreadLocal::current_thread = ThreadLocal::current_host_thread;
 	ThreadLocal::current_host_thread = 0;
 
-	int ret = swapcontext(&switch_from->ctx, ThreadLocal::host_context);
-	assert(ret == 0);
+	user_context_switch(&switch_from->ctx, ThreadLocal::host_context);
 
 	// if we get control back
 	assert(switch_from->running == false);
@@ -177,7 +177,13 @@ endif
 
 # general low-level uses GASNet by default
 USE_GASNET ?= 1
-ifeq ($(strip $(USE_GASNET)),1)
+ifeq ($(strip $(USE_GASNET))$(strip $(CONDUIT)),1shm)
+  # the shm conduit provides the parts of the GASNet API that we use on top
+  #  of POSIX shared memory, so no GASNet installation is needed - run with
+  #  GASNET_PSHM_NODES=<n> to get n nodes on the local machine
+  INC_FLAGS	+= -I$(LG_RT_DIR)/realm/shm
+  CC_FLAGS	+= -DUSE_GASNET
+else ifeq ($(strip $(USE_GASNET)),1)
   ifndef GASNET
     $(error GASNET variable is not defined, aborting build)
   endif
@@ -284,6 +290,7 @@ LOW_RUNTIME_SRC += $(LG_RT_DIR)/realm/runtime_impl.cc \
 	           $(LG_RT_DIR)/realm/tasks.cc \
 	           $(LG_RT_DIR)/realm/metadata.cc \
 		   $(LG_RT_DIR)/realm/event_impl.cc \
+		   $(LG_RT_DIR)/realm/event_tracer.cc \
 		   $(LG_RT_DIR)/realm/rsrv_impl.cc \
 		   $(LG_RT_DIR)/realm/proc_impl.cc \
 		   $(LG_RT_DIR)/realm/mem_impl.cc \
@@ -298,6 +305,9 @@ LOW_RUNTIME_SRC += $(LG_RT_DIR)/realm/cuda/cuda_module.cc \
 endif
 ifeq ($(strip $(USE_GASNET)),1)
 LOW_RUNTIME_SRC += $(LG_RT_DIR)/activemsg.cc
+ifeq ($(strip $(CONDUIT)),shm)
+LOW_RUNTIME_SRC += $(LG_RT_DIR)/realm/shm/shm_conduit.cc
+endif
 endif
 GPU_RUNTIME_SRC +=
 else
@@ -307,6 +317,7 @@ endif
 LOW_RUNTIME_SRC += $(LG_RT_DIR)/realm/logging.cc \
 	           $(LG_RT_DIR)/realm/cmdline.cc \
 		   $(LG_RT_DIR)/realm/profiling.cc \
+		   $(LG_RT_DIR)/realm/perf_counters.cc \
 		   $(LG_RT_DIR)/realm/timers.cc
 
 # If you want to go back to using the shared mapper, comment out the next line
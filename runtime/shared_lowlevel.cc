@@ -2631,13 +2631,13 @@ namespace Realm {
 
     ElementMask::ElementMask(void)
       : first_element(-1), num_elements(-1), memory(Memory::NO_MEMORY), offset(-1),
-	raw_data(0), first_enabled_elmt(-1), last_enabled_elmt(-1)
+	raw_data(0), runs(0), first_enabled_elmt(-1), last_enabled_elmt(-1)
     {
     }
 
     ElementMask::ElementMask(int _num_elements, int _first_element /*= 0*/)
       : first_element(_first_element), num_elements(_num_elements), memory(Memory::NO_MEMORY), offset(-1),
-        first_enabled_elmt(-1), last_enabled_elmt(-1)
+        runs(0), first_enabled_elmt(-1), last_enabled_elmt(-1)
     {
       size_t bytes_needed = ElementMaskImpl::bytes_needed(first_element, num_elements);
       raw_data = calloc(1, bytes_needed);
@@ -2647,6 +2647,7 @@ namespace Realm {
 
     ElementMask::ElementMask(const ElementMask &copy_from, 
 			     int _num_elements /*= -1*/, int _first_element /*= 0*/)
+      : runs(0)
     {
       first_element = copy_from.first_element;
       num_elements = copy_from.num_elements;
@@ -2804,6 +2805,96 @@ namespace Realm {
       return count;
     }
 
+    size_t ElementMask::pop_count_range(int start, int count) const
+    {
+      if (count <= 0)
+        return 0;
+      assert(raw_data != 0);
+      const ElementMaskImpl *impl = (const ElementMaskImpl *)raw_data;
+      int pos = start - first_element;
+      int last = pos + count - 1;
+      assert((pos >= 0) && (last < num_elements));
+      const int first_word = pos >> 5;
+      const int last_word = last >> 5;
+      const unsigned lo_mask = ~0U << (pos & 0x1f);
+      const unsigned hi_mask = ~0U >> (31 - (last & 0x1f));
+      if (first_word == last_word)
+        return __builtin_popcount(impl->bits[first_word] & lo_mask & hi_mask);
+      size_t total = __builtin_popcount(impl->bits[first_word] & lo_mask);
+      for (int index = first_word + 1; index < last_word; index++)
+        total += __builtin_popcount(impl->bits[index]);
+      total += __builtin_popcount(impl->bits[last_word] & hi_mask);
+      return total;
+    }
+
+    int ElementMask::find_nth_enabled(size_t skip, int start /*= 0*/) const
+    {
+      assert(raw_data != 0);
+      const ElementMaskImpl *impl = (const ElementMaskImpl *)raw_data;
+      int pos = start - first_element;
+      if (pos < 0)
+        pos = 0;
+      if (pos >= num_elements)
+        return -1;
+      const int num_words = (num_elements + 31) >> 5;
+      int index = pos >> 5;
+      unsigned bits = impl->bits[index] & (~0U << (pos & 0x1f));
+      // Skip whole words by their population counts and then
+      // drop set bits from the word holding the one we want
+      while (true) {
+        size_t local = __builtin_popcount(bits);
+        if (skip < local) {
+          for (size_t i = 0; i < skip; i++)
+            bits &= bits - 1;
+          return first_element + (index << 5) + __builtin_ctz(bits);
+        }
+        skip -= local;
+        if (++index >= num_words)
+          return -1;
+        bits = impl->bits[index];
+      }
+    }
+
+    void ElementMask::enable_from(const ElementMask &other, int start, int count)
+    {
+      if (count <= 0)
+        return;
+      assert((raw_data != 0) && (other.raw_data != 0));
+      assert((first_element == other.first_element) &&
+             (num_elements == other.num_elements));
+      ElementMaskImpl *impl = (ElementMaskImpl *)raw_data;
+      const ElementMaskImpl *other_impl = (const ElementMaskImpl *)other.raw_data;
+      int pos = start - first_element;
+      int last = pos + count - 1;
+      assert((pos >= 0) && (last < num_elements));
+      const int first_word = pos >> 5;
+      const int last_word = last >> 5;
+      const unsigned lo_mask = ~0U << (pos & 0x1f);
+      const unsigned hi_mask = ~0U >> (31 - (last & 0x1f));
+      // Copy a word at a time and remember the first and last
+      // words with anything in them to update the enabled range
+      int first_set = -1, last_set = -1;
+      for (int index = first_word; index <= last_word; index++) {
+        unsigned bits = other_impl->bits[index];
+        if (index == first_word)
+          bits &= lo_mask;
+        if (index == last_word)
+          bits &= hi_mask;
+        if (!bits)
+          continue;
+        impl->bits[index] |= bits;
+        if (first_set < 0)
+          first_set = first_element + (index << 5) + __builtin_ctz(bits);
+        last_set = first_element + (index << 5) + 31 - __builtin_clz(bits);
+      }
+      if (first_set < 0)
+        return;
+      if ((first_enabled_elmt < 0) || (first_set < first_enabled_elmt))
+        first_enabled_elmt = first_set;
+      if ((last_enabled_elmt < 0) || (last_set > last_enabled_elmt))
+        last_enabled_elmt = last_set;
+    }
+
     bool ElementMask::operator!(void) const
     {
       if (raw_data != 0) {
@@ -3561,6 +3652,7 @@ namespace LegionRuntime {
         void verify_access(unsigned ptr);
         bool is_reduction(void) const { return reduction; }
         bool is_list_reduction(void) const { return list; }
+        bool is_active(void) const { return active; }
         void* get_base_ptr(void) const { return base_ptr; }
         void* get_address(int index, size_t field_start, size_t field_Size, size_t within_field);
         size_t get_elmt_size(void) const { return elmt_size; }
@@ -3624,7 +3716,9 @@ namespace Realm {
     {
       DetailedTimer::ScopedPush sp(TIME_LOW_LEVEL);
       RegionInstanceImpl *impl = RuntimeImpl::get_runtime()->get_instance_impl(*this);
-      return RegionAccessor<AccessorType::Generic>(AccessorType::Generic::Untyped(impl));
+      AccessorType::Generic::Untyped untyped(impl);
+      untyped.find_dense_layout();
+      return RegionAccessor<AccessorType::Generic>(untyped);
     }
 
     AddressSpace RegionInstance::address_space(void) const 
@@ -6413,6 +6507,19 @@ namespace Realm {
       return ((MachineImpl *)impl)->get_mem_mem_affinity(result, restrict_mem1, restrict_mem2);
     }
 
+    double Machine::estimate_copy_time(Memory src_mem, Memory dst_mem, size_t bytes) const
+    {
+      // no DMA queues to watch here, so this is just the static affinity,
+      //  read as bandwidth in units of 100MB/s and latency in microseconds
+      //  (as the general runtime does for memory pairs it hasn't used yet)
+      std::vector<Machine::MemoryMemoryAffinity> mmas;
+      if(get_mem_mem_affinity(mmas, src_mem, dst_mem) == 0)
+	get_mem_mem_affinity(mmas, dst_mem, src_mem);
+      if(mmas.empty() || (mmas[0].bandwidth == 0))
+	return -1;
+      return (mmas[0].latency * 1000.0) + (bytes / (mmas[0].bandwidth * 0.1));
+    }
+
 };
 
 namespace LegionRuntime {
@@ -7419,6 +7526,61 @@ namespace LegionRuntime {
   namespace Accessor {
     using namespace LegionRuntime::LowLevel;
 
+    void AccessorType::Generic::Untyped::find_dense_layout(void)
+    {
+      dense_base = 0;
+
+      RegionInstanceImpl *impl = (RegionInstanceImpl *) internal;
+      if(!impl || !impl->is_active()) return;
+
+      // reduction lists aren't indexed by element
+      if(impl->is_list_reduction()) return;
+
+      // element pointers must map onto instance indices by a translation
+      //  (or directly, for an unstructured index space)
+      int index0 = 0;
+      const DomainLinearization& dl = impl->get_linearization();
+      if(dl.get_dim() == 1) {
+	Arrays::Mapping<1, 1> *mapping = dl.get_mapping<1>();
+	index0 = mapping->image(0);
+	int index1 = mapping->image(1);
+	if(index1 != (index0 + 1)) return;
+      } else if(dl.get_dim() > 1)
+	return;
+
+      size_t elmt_size = impl->get_elmt_size();
+      if((field_offset < 0) || (field_offset >= (off_t)elmt_size)) return;
+
+      size_t field_start = 0, field_size = 0, within_field = 0;
+      size_t block_size = impl->get_block_size();
+      char *base = (char *)(impl->get_base_ptr());
+      if(!base) return;
+
+      if(block_size <= 1) {
+	// AOS - the element is contiguous, so accesses may span fields
+	dense_base = base + field_offset;
+	dense_stride = elmt_size;
+	dense_block_size = 0;
+	dense_block_stride = 0;
+	dense_field_bytes = elmt_size - field_offset;
+      } else {
+	find_field(impl->get_field_sizes(), field_offset, 1,
+		   field_start, field_size, within_field);
+	dense_base = base + (field_start * block_size) + within_field;
+	dense_stride = field_size;
+	// a single block is plain SOA
+	if(block_size >= impl->get_num_elmts()) {
+	  dense_block_size = 0;
+	  dense_block_stride = 0;
+	} else {
+	  dense_block_size = block_size;
+	  dense_block_stride = block_size * elmt_size;
+	}
+	dense_field_bytes = field_size - within_field;
+      }
+      dense_index_offset = index0;
+    }
+
     void AccessorType::Generic::Untyped::read_untyped(ptr_t ptr, void *dst, size_t bytes, off_t offset) const
     {
 #ifdef PRIVILEGE_CHECKS 
@@ -7427,6 +7589,11 @@ namespace LegionRuntime {
 #ifdef BOUNDS_CHECKS
       check_bounds(region, ptr);
 #endif
+      const char *elem = dense_elem_ptr(ptr, bytes, offset);
+      if(elem) {
+	memcpy(dst, elem, bytes);
+	return;
+      }
       RegionInstanceImpl *impl = (RegionInstanceImpl *) internal;
       int index = ((impl->get_linearization().get_dim() == 1) ?
 		     (int)(impl->get_linearization().get_mapping<1>()->image(ptr.value)) :
@@ -7471,6 +7638,11 @@ namespace LegionRuntime {
 #ifdef BOUNDS_CHECKS
       check_bounds(region, ptr);
 #endif
+      char *elem = dense_elem_ptr(ptr, bytes, offset);
+      if(elem) {
+	memcpy(elem, src, bytes);
+	return;
+      }
       RegionInstanceImpl *impl = (RegionInstanceImpl *) internal;
       int index = ((impl->get_linearization().get_dim() == 1) ?
 		     (int)(impl->get_linearization().get_mapping<1>()->image(ptr.value)) :
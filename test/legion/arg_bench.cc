@@ -0,0 +1,268 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include "legion.h"
+#include "default_mapper.h"
+#include "realm/timers.h"
+using namespace LegionRuntime::HighLevel;
+
+/*
+ * Measures task launch latency, from the launch call until
+ * the task starts, as the task arguments grow.  Tasks that
+ * stay on the launching node share their argument buffer
+ * with the launcher, so their latency should not grow with
+ * the size of the arguments.  Tasks sent to another node
+ * have to serialize them and are timed for comparison when
+ * there is more than one node.  Individual tasks are timed
+ * one launch at a time and we report the median.  Index
+ * launches give each point its own argument of the same
+ * size through an argument map and we report how long it
+ * takes until the last point has started.  Every task checks
+ * that its arguments arrived intact.
+ */
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  ARG_TASK_ID,
+};
+
+enum MappingTags {
+  LOCAL_TAG,
+  REMOTE_TAG,
+};
+
+// Sends tasks tagged REMOTE_TAG to a processor on another
+// node and keeps everything else on the launching processor
+class ArgBenchMapper : public DefaultMapper {
+public:
+  ArgBenchMapper(Machine m, HighLevelRuntime *rt, Processor p)
+    : DefaultMapper(m, rt, p), remote_proc(Processor::NO_PROC)
+  {
+    std::set<Processor> all_procs;
+    m.get_all_processors(all_procs);
+    for (std::set<Processor>::const_iterator it = all_procs.begin();
+          it != all_procs.end(); it++)
+    {
+      if (((*it).kind() == Processor::LOC_PROC) &&
+          ((*it).address_space() != p.address_space()))
+      {
+        remote_proc = *it;
+        break;
+      }
+    }
+  }
+public:
+  virtual void select_task_options(Task *task)
+  {
+    DefaultMapper::select_task_options(task);
+    if (task->task_id == ARG_TASK_ID)
+      task->target_proc = target(task);
+  }
+  virtual void slice_domain(const Task *task, const Domain &domain,
+                            std::vector<DomainSplit> &slices)
+  {
+    if (task->task_id != ARG_TASK_ID)
+    {
+      DefaultMapper::slice_domain(task, domain, slices);
+      return;
+    }
+    slices.push_back(DomainSplit(domain, target(task), 
+                                 false/*recurse*/, false/*stealable*/));
+  }
+protected:
+  Processor target(const Task *task) const
+  {
+    return ((task->tag == REMOTE_TAG) ? remote_proc : local_proc);
+  }
+public:
+  Processor remote_proc;
+};
+
+static void fill_buffer(char *buffer, size_t size, int seed)
+{
+  for (size_t i = 0; i < size; i++)
+    buffer[i] = (char)((i * 31 + seed) & 0xff);
+}
+
+static bool check_buffer(const void *buffer, size_t size, int seed)
+{
+  const char *ptr = (const char*)buffer;
+  // Spot check rather than walk the whole thing so we
+  // don't time reading the arguments
+  for (size_t i = 0; i < size; i += 4093)
+    if (ptr[i] != (char)((i * 31 + seed) & 0xff))
+      return false;
+  return ((size == 0) ||
+          (ptr[size-1] == (char)(((size-1) * 31 + seed) & 0xff)));
+}
+
+long long arg_task(const Task *task,
+                   const std::vector<PhysicalRegion> &regions,
+                   Context ctx, HighLevelRuntime *runtime)
+{
+  // Remote tasks compare this with the launching node's
+  // clock, which only works when the nodes share a host
+  long long start = Realm::Clock::current_time_in_nanoseconds(true/*absolute*/);
+  if (!check_buffer(task->args, task->arglen, 0))
+  {
+    printf("ERROR: corrupted task arguments\n");
+    assert(false);
+  }
+  if (task->is_index_space &&
+      !check_buffer(task->local_args, task->local_arglen,
+                    task->index_point.get_point<1>()[0]))
+  {
+    printf("ERROR: corrupted point arguments\n");
+    assert(false);
+  }
+  return start;
+}
+
+// Median latency in us of launching one task at a time
+static double single_latency(HighLevelRuntime *runtime, Context ctx,
+                             const char *buffer, size_t size,
+                             MappingTagID tag, int samples)
+{
+  TaskLauncher launcher(ARG_TASK_ID, TaskArgument(buffer, size), 
+                        Predicate::TRUE_PRED, 0/*mapper*/, tag);
+  std::vector<long long> latencies(samples);
+  for (int i = 0; i < samples; i++)
+  {
+    long long launch = Realm::Clock::current_time_in_nanoseconds(true/*absolute*/);
+    Future f = runtime->execute_task(ctx, launcher);
+    latencies[i] = f.get_result<long long>() - launch;
+  }
+  std::nth_element(latencies.begin(), latencies.begin() + samples/2,
+                   latencies.end());
+  return 1e-3 * latencies[samples/2];
+}
+
+// Latency in us until the last point of an index launch has started
+static double index_latency(HighLevelRuntime *runtime, Context ctx,
+                            const char *buffer, size_t size,
+                            MappingTagID tag, int num_points)
+{
+  Rect<1> launch_bounds(Point<1>(0),Point<1>(num_points-1));
+  Domain launch_domain = Domain::from_rect<1>(launch_bounds);
+  ArgumentMap arg_map;
+  char *point_buffer = (char*)malloc(size > 0 ? size : 1);
+  for (int i = 0; i < num_points; i++)
+  {
+    fill_buffer(point_buffer, size, i);
+    arg_map.set_point(DomainPoint::from_point<1>(Point<1>(i)),
+                      TaskArgument(point_buffer, size));
+  }
+  free(point_buffer);
+  IndexLauncher launcher(ARG_TASK_ID, launch_domain,
+                         TaskArgument(buffer, size), arg_map,
+                         Predicate::TRUE_PRED, false/*must*/, 
+                         0/*mapper*/, tag);
+
+  long long launch = Realm::Clock::current_time_in_nanoseconds(true/*absolute*/);
+  FutureMap fm = runtime->execute_index_space(ctx, launcher);
+  long long last = launch;
+  for (int i = 0; i < num_points; i++)
+    last = std::max(last,
+        fm.get_result<long long>(DomainPoint::from_point<1>(Point<1>(i))));
+  return 1e-3 * (last - launch);
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, HighLevelRuntime *runtime)
+{
+  size_t max_size = 1 << 20;
+  int samples = 64;
+  {
+    const InputArgs &command_args = HighLevelRuntime::get_input_args();
+    for (int i = 1; i < command_args.argc; i++)
+    {
+      if (!strcmp(command_args.argv[i],"-s"))
+        max_size = atol(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i],"-n"))
+        samples = atoi(command_args.argv[++i]);
+    }
+  }
+  assert(samples > 0);
+  bool remote = false;
+  {
+    std::set<AddressSpaceID> spaces;
+    std::set<Processor> all_procs;
+    Machine::get_machine().get_all_processors(all_procs);
+    for (std::set<Processor>::const_iterator it = all_procs.begin();
+          it != all_procs.end(); it++)
+      spaces.insert((*it).address_space());
+    remote = (spaces.size() > 1);
+  }
+
+  char *buffer = (char*)malloc(max_size > 0 ? max_size : 1);
+  fill_buffer(buffer, max_size, 0);
+
+  // Small parameter blocks up to the 100 KB+ ones that
+  // motivated sharing the buffers
+  const size_t sizes[] = { 0, 256, 4096, 32768, 131072, 524288, 1048576,
+                           4194304 };
+  printf("launch latency in us, %d points per index launch\n", samples);
+  printf("%10s %12s %12s %12s %12s\n", "arg bytes", "local task",
+         "remote task", "local index", "remote index");
+  for (unsigned idx = 0; idx < (sizeof(sizes)/sizeof(sizes[0])); idx++)
+  {
+    const size_t size = sizes[idx];
+    if (size > max_size)
+      break;
+    printf("%10zd %12.2f", size, 
+           single_latency(runtime, ctx, buffer, size, LOCAL_TAG, samples));
+    if (remote)
+      printf(" %12.2f", 
+             single_latency(runtime, ctx, buffer, size, REMOTE_TAG, samples));
+    else
+      printf(" %12s", "-");
+    printf(" %12.2f", 
+           index_latency(runtime, ctx, buffer, size, LOCAL_TAG, samples));
+    if (remote)
+      printf(" %12.2f\n", 
+             index_latency(runtime, ctx, buffer, size, REMOTE_TAG, samples));
+    else
+      printf(" %12s\n", "-");
+  }
+  free(buffer);
+}
+
+void mapper_registration(Machine machine, HighLevelRuntime *rt,
+                         const std::set<Processor> &local_procs)
+{
+  for (std::set<Processor>::const_iterator it = local_procs.begin();
+        it != local_procs.end(); it++)
+    rt->replace_default_mapper(new ArgBenchMapper(machine, rt, *it), *it);
+}
+
+int main(int argc, char **argv)
+{
+  HighLevelRuntime::set_registration_callback(mapper_registration);
+  HighLevelRuntime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+  HighLevelRuntime::register_legion_task<top_level_task>(TOP_LEVEL_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/);
+  HighLevelRuntime::register_legion_task<long long, arg_task>(ARG_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, true/*index*/,
+      AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "arg_task");
+
+  return HighLevelRuntime::start(argc, argv);
+}
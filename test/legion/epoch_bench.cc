@@ -0,0 +1,193 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include "legion.h"
+#include "realm/timers.h"
+using namespace LegionRuntime::HighLevel;
+
+/*
+ * Measures the startup time of SPMD-style must epoch launches
+ * as the number of shards grows: how long it takes from the
+ * launch until the last shard starts running, which is the
+ * serial phase that mapping and distributing the epoch in
+ * per-node groups shortens.  Every shard names its own piece
+ * of a region and its right neighbor's piece with simultaneous
+ * coherence, in the same way as the ghost example, so the
+ * epoch carries a mapping constraint between every pair of
+ * neighbors.  Each shard count is launched -r times and we
+ * report the fastest and the mean startup, along with when
+ * the first shard started in the fastest launch.  A must
+ * epoch needs a processor per shard, so the shard count is
+ * capped by the number of CPUs (use -ll:cpu and several
+ * nodes to scale it).
+ */
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  SHARD_TASK_ID,
+};
+
+enum FieldIDs {
+  FID_GHOST,
+};
+
+struct Startup {
+  double first; // us until the first shard started
+  double last;  // us until the last shard started
+};
+
+long long shard_task(const Task *task,
+                     const std::vector<PhysicalRegion> &regions,
+                     Context ctx, HighLevelRuntime *runtime)
+{
+  // Shards on other nodes compare this with the launching
+  // node's clock, which only works when the nodes share a host
+  return Realm::Clock::current_time_in_nanoseconds(true/*absolute*/);
+}
+
+static Startup launch_epoch(HighLevelRuntime *runtime, Context ctx,
+                            int num_shards)
+{
+  Rect<1> shard_bounds(Point<1>(0),Point<1>(num_shards-1));
+  Domain shard_domain = Domain::from_rect<1>(shard_bounds);
+
+  IndexSpace is = runtime->create_index_space(ctx, shard_domain);
+  FieldSpace fs = runtime->create_field_space(ctx);
+  {
+    FieldAllocator allocator = runtime->create_field_allocator(ctx, fs);
+    allocator.allocate_field(sizeof(double), FID_GHOST);
+  }
+  LogicalRegion lr = runtime->create_logical_region(ctx, is, fs);
+  // one element per shard
+  DomainPointColoring coloring;
+  for (int i = 0; i < num_shards; i++)
+    coloring[DomainPoint::from_point<1>(Point<1>(i))] =
+      Domain::from_rect<1>(Rect<1>(Point<1>(i), Point<1>(i)));
+  IndexPartition ip = runtime->create_index_partition(ctx, is,
+                                shard_domain, coloring, DISJOINT_KIND);
+  LogicalPartition lp = runtime->get_logical_partition(ctx, lr, ip);
+
+  MustEpochLauncher must_epoch_launcher;
+  for (int i = 0; i < num_shards; i++)
+  {
+    LogicalRegion mine = runtime->get_logical_subregion_by_color(ctx, lp,
+                              DomainPoint::from_point<1>(Point<1>(i)));
+    LogicalRegion right = runtime->get_logical_subregion_by_color(ctx, lp,
+                   DomainPoint::from_point<1>(Point<1>((i+1) % num_shards)));
+    TaskLauncher shard_launcher(SHARD_TASK_ID, TaskArgument(NULL, 0));
+    shard_launcher.add_region_requirement(
+        RegionRequirement(mine, READ_WRITE, SIMULTANEOUS, lr));
+    shard_launcher.region_requirements[0].flags |= NO_ACCESS_FLAG;
+    shard_launcher.add_field(0, FID_GHOST);
+    if (num_shards > 1)
+    {
+      shard_launcher.add_region_requirement(
+          RegionRequirement(right, READ_ONLY, SIMULTANEOUS, lr));
+      shard_launcher.region_requirements[1].flags |= NO_ACCESS_FLAG;
+      shard_launcher.add_field(1, FID_GHOST);
+    }
+    must_epoch_launcher.add_single_task(
+        DomainPoint::from_point<1>(Point<1>(i)), shard_launcher);
+  }
+
+  long long start = Realm::Clock::current_time_in_nanoseconds(true/*absolute*/);
+  FutureMap fm = runtime->execute_must_epoch(ctx, must_epoch_launcher);
+  long long first = 0, last = 0;
+  for (int i = 0; i < num_shards; i++)
+  {
+    long long shard_start =
+      fm.get_result<long long>(DomainPoint::from_point<1>(Point<1>(i)));
+    if ((i == 0) || (shard_start < first))
+      first = shard_start;
+    if ((i == 0) || (shard_start > last))
+      last = shard_start;
+  }
+  Startup result;
+  result.first = 1e-3 * (first - start);
+  result.last = 1e-3 * (last - start);
+
+  runtime->destroy_logical_region(ctx, lr);
+  runtime->destroy_field_space(ctx, fs);
+  runtime->destroy_index_space(ctx, is);
+  return result;
+}
+
+static void time_startup(HighLevelRuntime *runtime, Context ctx,
+                         int num_shards, int repeats)
+{
+  Startup best = launch_epoch(runtime, ctx, num_shards);
+  double total = best.last;
+  for (int i = 1; i < repeats; i++)
+  {
+    Startup startup = launch_epoch(runtime, ctx, num_shards);
+    total += startup.last;
+    if (startup.last < best.last)
+      best = startup;
+  }
+  printf("%8d %16.0f %16.0f %16.0f\n", num_shards, best.last,
+         total / repeats, best.first);
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, HighLevelRuntime *runtime)
+{
+  std::set<Processor> all_procs;
+  Realm::Machine::get_machine().get_all_processors(all_procs);
+  int max_shards = 0;
+  for (std::set<Processor>::const_iterator it = all_procs.begin();
+        it != all_procs.end(); it++)
+    if ((*it).kind() == Processor::LOC_PROC)
+      max_shards++;
+  int repeats = 3;
+  {
+    const InputArgs &command_args = HighLevelRuntime::get_input_args();
+    for (int i = 1; i < command_args.argc; i++)
+    {
+      if (!strcmp(command_args.argv[i],"-s"))
+      {
+        int shards = atoi(command_args.argv[++i]);
+        if (shards < max_shards)
+          max_shards = shards;
+      }
+      if (!strcmp(command_args.argv[i],"-r"))
+        repeats = atoi(command_args.argv[++i]);
+    }
+  }
+  assert(repeats > 0);
+
+  printf("%8s %16s %16s %16s\n", "shards", "startup (us)",
+         "mean (us)", "first shard (us)");
+  for (int shards = 1; shards < max_shards; shards *= 2)
+    time_startup(runtime, ctx, shards, repeats);
+  time_startup(runtime, ctx, max_shards, repeats);
+}
+
+int main(int argc, char **argv)
+{
+  HighLevelRuntime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+  HighLevelRuntime::register_legion_task<top_level_task>(TOP_LEVEL_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/);
+  HighLevelRuntime::register_legion_task<long long, shard_task>(SHARD_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/,
+      AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "shard_task");
+
+  return HighLevelRuntime::start(argc, argv);
+}
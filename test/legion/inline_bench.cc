@@ -0,0 +1,278 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include "legion.h"
+#include "default_mapper.h"
+#include "realm/timers.h"
+using namespace LegionRuntime::HighLevel;
+using namespace LegionRuntime::Accessor;
+
+/*
+ * Measures the latency of mapping a region inline, updating
+ * it and unmapping it again in a loop.  The very first mapping
+ * has to make the region's instance and is reported on its own
+ * as the cost that caching can't avoid.  The loop is run with
+ * nothing else going on, with a task using a different field
+ * of the region launched every iteration, and with a task
+ * reading the mapped field launched every iteration, which
+ * forces every mapping to go through the whole mapping path.
+ * Each loop is run both with fresh map_region calls and by
+ * remapping the same physical region.  The last loop runs
+ * inside a child task that the mapper inlines into the top
+ * level task.  Before exiting it checks that the top level task
+ * sees an update made by an inlined child to a region it still
+ * has a cached mapping for.  Run with -hl:inline_cache 0 to
+ * compare against no caching.
+ */
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  READ_TASK_ID,
+  INLINE_LOOP_TASK_ID,
+};
+
+enum FieldIDs {
+  FID_MAPPED,
+  FID_OTHER,
+};
+
+enum LoopKind {
+  LOOP_ALONE,
+  LOOP_OTHER_FIELD,
+  LOOP_CONFLICT,
+  LOOP_INLINED,
+};
+
+struct InlineLoopArgs {
+  int iterations;
+  bool remap;
+  int counter;
+};
+
+class InlineBenchMapper : public DefaultMapper {
+public:
+  InlineBenchMapper(Machine m, HighLevelRuntime *rt, Processor p)
+    : DefaultMapper(m, rt, p) { }
+public:
+  virtual void select_task_options(Task *task)
+  {
+    DefaultMapper::select_task_options(task);
+    if (task->task_id == INLINE_LOOP_TASK_ID)
+      task->inline_task = true;
+  }
+};
+
+int read_task(const Task *task,
+              const std::vector<PhysicalRegion> &regions,
+              Context ctx, HighLevelRuntime *runtime)
+{
+  FieldID fid = *(task->regions[0].privilege_fields.begin());
+  RegionAccessor<AccessorType::Generic, int> acc = 
+    regions[0].get_field_accessor(fid).typeify<int>();
+  return acc.read(DomainPoint::from_point<1>(Point<1>(0)));
+}
+
+static void update(const PhysicalRegion &region, int expected)
+{
+  RegionAccessor<AccessorType::Generic, int> acc = 
+    region.get_field_accessor(FID_MAPPED).typeify<int>();
+  DomainPoint dp = DomainPoint::from_point<1>(Point<1>(0));
+  int value = acc.read(dp);
+  if (value != expected)
+  {
+    printf("ERROR: read %d from the mapped region, expected %d\n",
+           value, expected);
+    assert(false);
+  }
+  acc.write(dp, value + 1);
+}
+
+static void map_loop(HighLevelRuntime *runtime, Context ctx,
+                     LogicalRegion lr, int iterations, bool remap, 
+                     int &counter, const TaskLauncher *between,
+                     std::vector<Future> &futures)
+{
+  RegionRequirement req(lr, READ_WRITE, EXCLUSIVE, lr);
+  req.add_field(FID_MAPPED);
+  PhysicalRegion region;
+  for (int i = 0; i < iterations; i++)
+  {
+    if (remap && (i > 0))
+      runtime->remap_region(ctx, region);
+    else
+      region = runtime->map_region(ctx, req);
+    region.wait_until_valid();
+    update(region, counter++);
+    runtime->unmap_region(ctx, region);
+    if (between != NULL)
+      futures.push_back(runtime->execute_task(ctx, *between));
+  }
+}
+
+void inline_loop_task(const Task *task,
+                      const std::vector<PhysicalRegion> &regions,
+                      Context ctx, HighLevelRuntime *runtime)
+{
+  const InlineLoopArgs *args = (const InlineLoopArgs*)task->args;
+  int counter = args->counter;
+  std::vector<Future> futures;
+  map_loop(runtime, ctx, task->regions[0].region, args->iterations,
+           args->remap, counter, NULL, futures);
+}
+
+static void inlined_loop(HighLevelRuntime *runtime, Context ctx,
+                         LogicalRegion lr, int iterations, bool remap,
+                         int &counter)
+{
+  InlineLoopArgs args;
+  args.iterations = iterations;
+  args.remap = remap;
+  args.counter = counter;
+  TaskLauncher child(INLINE_LOOP_TASK_ID, 
+                     TaskArgument(&args, sizeof(args)));
+  child.add_region_requirement(RegionRequirement(lr, READ_WRITE,
+                                                 EXCLUSIVE, lr));
+  child.add_field(0, FID_MAPPED);
+  runtime->execute_task(ctx, child).get_void_result();
+  counter += iterations;
+}
+
+static void check_inlined_writer(HighLevelRuntime *runtime, Context ctx,
+                                 LogicalRegion lr, int &counter)
+{
+  std::vector<Future> futures;
+  // Leave a cached mapping of the field behind in this task
+  map_loop(runtime, ctx, lr, 1, false, counter, NULL, futures);
+  // Update the field from an inlined child
+  inlined_loop(runtime, ctx, lr, 1, false, counter);
+  // Mapping it again here has to see the child's update
+  map_loop(runtime, ctx, lr, 1, false, counter, NULL, futures);
+}
+
+static void time_loop(HighLevelRuntime *runtime, Context ctx,
+                      LogicalRegion lr, int iterations, 
+                      LoopKind kind, bool remap, int &counter)
+{
+  TaskLauncher launcher(READ_TASK_ID, TaskArgument());
+  launcher.add_region_requirement(RegionRequirement(lr, READ_ONLY, 
+                                                    EXCLUSIVE, lr));
+  launcher.add_field(0, (kind == LOOP_CONFLICT) ? FID_MAPPED : FID_OTHER);
+
+  std::vector<Future> futures;
+  double start = Realm::Clock::current_time_in_microseconds();
+  if (kind == LOOP_INLINED)
+    inlined_loop(runtime, ctx, lr, iterations, remap, counter);
+  else
+    map_loop(runtime, ctx, lr, iterations, remap, counter,
+             (kind == LOOP_ALONE) ? NULL : &launcher, futures);
+  double stop = Realm::Clock::current_time_in_microseconds();
+  // The conflicting readers have to have seen each update in order
+  for (unsigned idx = 0; idx < futures.size(); idx++)
+  {
+    int value = futures[idx].get_result<int>();
+    int expected = (kind == LOOP_CONFLICT) ? (counter - iterations + idx + 1) 
+                                           : 0;
+    if (value != expected)
+    {
+      printf("ERROR: task read %d, expected %d\n", value, expected);
+      assert(false);
+    }
+  }
+  const char *names[] = { "alone", "other field", "conflict", "inlined" };
+  printf("%12s %8s %10d %12.2f\n", names[kind], remap ? "remap" : "map",
+         iterations, (stop - start) / iterations);
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, HighLevelRuntime *runtime)
+{
+  int iterations = 1000;
+  {
+    const InputArgs &command_args = HighLevelRuntime::get_input_args();
+    for (int i = 1; i < command_args.argc; i++)
+    {
+      if (!strcmp(command_args.argv[i],"-n"))
+        iterations = atoi(command_args.argv[++i]);
+    }
+  }
+
+  Rect<1> bounds(Point<1>(0),Point<1>(1023));
+  IndexSpace is = runtime->create_index_space(ctx, 
+                                      Domain::from_rect<1>(bounds));
+  FieldSpace fs = runtime->create_field_space(ctx);
+  {
+    FieldAllocator allocator = runtime->create_field_allocator(ctx, fs);
+    allocator.allocate_field(sizeof(int), FID_MAPPED);
+    allocator.allocate_field(sizeof(int), FID_OTHER);
+  }
+  LogicalRegion lr = runtime->create_logical_region(ctx, is, fs);
+  int zero = 0;
+  runtime->fill_field(ctx, lr, lr, FID_MAPPED, &zero, sizeof(zero));
+  runtime->fill_field(ctx, lr, lr, FID_OTHER, &zero, sizeof(zero));
+
+  int counter = 0;
+  printf("%12s %8s %10s %12s\n", "between", "call", "iterations", 
+         "us/iteration");
+  {
+    std::vector<Future> futures;
+    double start = Realm::Clock::current_time_in_microseconds();
+    map_loop(runtime, ctx, lr, 1, false, counter, NULL, futures);
+    double stop = Realm::Clock::current_time_in_microseconds();
+    printf("%12s %8s %10d %12.2f\n", "first map", "map", 1, stop - start);
+  }
+  const LoopKind kinds[] = { LOOP_ALONE, LOOP_OTHER_FIELD, 
+                             LOOP_CONFLICT, LOOP_INLINED };
+  for (unsigned k = 0; k < (sizeof(kinds)/sizeof(kinds[0])); k++)
+  {
+    time_loop(runtime, ctx, lr, iterations, kinds[k], false, counter);
+    time_loop(runtime, ctx, lr, iterations, kinds[k], true, counter);
+  }
+
+  check_inlined_writer(runtime, ctx, lr, counter);
+
+  runtime->destroy_logical_region(ctx, lr);
+  runtime->destroy_field_space(ctx, fs);
+  runtime->destroy_index_space(ctx, is);
+}
+
+void mapper_registration(Machine machine, HighLevelRuntime *rt,
+                         const std::set<Processor> &local_procs)
+{
+  for (std::set<Processor>::const_iterator it = local_procs.begin();
+        it != local_procs.end(); it++)
+    rt->replace_default_mapper(new InlineBenchMapper(machine, rt, *it), *it);
+}
+
+int main(int argc, char **argv)
+{
+  HighLevelRuntime::set_registration_callback(mapper_registration);
+  HighLevelRuntime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+  HighLevelRuntime::register_legion_task<top_level_task>(TOP_LEVEL_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/);
+  HighLevelRuntime::register_legion_task<int, read_task>(READ_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/,
+      AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "read_task");
+  HighLevelRuntime::register_legion_task<inline_loop_task>(INLINE_LOOP_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/,
+      AUTO_GENERATE_ID, TaskConfigOptions(), "inline_loop_task");
+
+  return HighLevelRuntime::start(argc, argv);
+}
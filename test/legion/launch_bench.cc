@@ -0,0 +1,175 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include "legion.h"
+#include "realm/timers.h"
+using namespace LegionRuntime::HighLevel;
+
+/*
+ * Measures how long it takes to slice massive index space
+ * task launches.  The point tasks do nothing but return
+ * their start time, so the time until the first point
+ * starts is the cost of slicing the launch down to its
+ * first points and the time until the whole launch is done
+ * is the cost of expanding every point.  Each point count
+ * is launched -t times and we report the fastest launch.
+ * With -r each point also gets a subregion of a partition
+ * through a projection requirement, so the launch has to
+ * compute a projection per point.
+ */
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  POINT_TASK_ID,
+};
+
+enum FieldIDs {
+  FID_VAL,
+};
+
+struct LaunchTimes {
+  double first; // us until the first point started
+  double all;   // us until every point was done
+};
+
+double point_task(const Task *task,
+                  const std::vector<PhysicalRegion> &regions,
+                  Context ctx, HighLevelRuntime *runtime)
+{
+  return Realm::Clock::current_time_in_microseconds();
+}
+
+static LaunchTimes launch_points(HighLevelRuntime *runtime, Context ctx,
+                                 int num_points, bool use_regions)
+{
+  Rect<1> launch_bounds(Point<1>(0),Point<1>(num_points-1));
+  Domain launch_domain = Domain::from_rect<1>(launch_bounds);
+
+  IndexSpace is = IndexSpace::NO_SPACE;
+  FieldSpace fs = FieldSpace::NO_SPACE;
+  LogicalRegion lr = LogicalRegion::NO_REGION;
+  LogicalPartition lp = LogicalPartition::NO_PART;
+  if (use_regions)
+  {
+    is = runtime->create_index_space(ctx, launch_domain);
+    fs = runtime->create_field_space(ctx);
+    {
+      FieldAllocator allocator = runtime->create_field_allocator(ctx, fs);
+      allocator.allocate_field(sizeof(double), FID_VAL);
+    }
+    lr = runtime->create_logical_region(ctx, is, fs);
+    // one element per point
+    DomainPointColoring coloring;
+    for (int i = 0; i < num_points; i++)
+      coloring[DomainPoint::from_point<1>(Point<1>(i))] =
+        Domain::from_rect<1>(Rect<1>(Point<1>(i), Point<1>(i)));
+    IndexPartition ip = runtime->create_index_partition(ctx, is,
+                                  launch_domain, coloring, DISJOINT_KIND);
+    lp = runtime->get_logical_partition(ctx, lr, ip);
+  }
+
+  IndexLauncher launcher(POINT_TASK_ID, launch_domain,
+                         TaskArgument(NULL, 0), ArgumentMap());
+  if (use_regions)
+  {
+    launcher.add_region_requirement(
+        RegionRequirement(lp, 0/*projection ID*/,
+                          WRITE_DISCARD, EXCLUSIVE, lr));
+    launcher.add_field(0, FID_VAL);
+  }
+
+  double start = Realm::Clock::current_time_in_microseconds();
+  FutureMap fm = runtime->execute_index_space(ctx, launcher);
+  fm.wait_all_results();
+  double stop = Realm::Clock::current_time_in_microseconds();
+
+  double first = stop;
+  for (int i = 0; i < num_points; i++)
+  {
+    double point_start =
+      fm.get_result<double>(DomainPoint::from_point<1>(Point<1>(i)));
+    if (point_start < first)
+      first = point_start;
+  }
+  LaunchTimes result;
+  result.first = first - start;
+  result.all = stop - start;
+
+  if (use_regions)
+  {
+    runtime->destroy_logical_region(ctx, lr);
+    runtime->destroy_field_space(ctx, fs);
+    runtime->destroy_index_space(ctx, is);
+  }
+  return result;
+}
+
+static void time_launch(HighLevelRuntime *runtime, Context ctx,
+                        int num_points, bool use_regions, int trials)
+{
+  LaunchTimes best = launch_points(runtime, ctx, num_points, use_regions);
+  for (int i = 1; i < trials; i++)
+  {
+    LaunchTimes times = launch_points(runtime, ctx, num_points, use_regions);
+    if (times.all < best.all)
+      best = times;
+  }
+  printf("%12d %16.0f %16.0f %12.2f\n", num_points, best.first,
+         best.all, best.all / num_points);
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, HighLevelRuntime *runtime)
+{
+  int max_points = 100000;
+  int trials = 3;
+  bool use_regions = false;
+  {
+    const InputArgs &command_args = HighLevelRuntime::get_input_args();
+    for (int i = 1; i < command_args.argc; i++)
+    {
+      if (!strcmp(command_args.argv[i],"-n"))
+        max_points = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i],"-t"))
+        trials = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i],"-r"))
+        use_regions = true;
+    }
+  }
+  assert(trials > 0);
+
+  printf("%12s %16s %16s %12s\n", "points", "first (us)",
+         "all (us)", "us/point");
+  for (int points = 1000; points <= max_points; points *= 10)
+    time_launch(runtime, ctx, points, use_regions, trials);
+}
+
+int main(int argc, char **argv)
+{
+  HighLevelRuntime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+  HighLevelRuntime::register_legion_task<top_level_task>(TOP_LEVEL_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/);
+  HighLevelRuntime::register_legion_task<double, point_task>(POINT_TASK_ID,
+      Processor::LOC_PROC, false/*single*/, true/*index*/,
+      AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "point_task");
+
+  return HighLevelRuntime::start(argc, argv);
+}
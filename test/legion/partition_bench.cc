@@ -0,0 +1,209 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include "legion.h"
+#include "realm/timers.h"
+using namespace LegionRuntime::HighLevel;
+
+/*
+ * Measures how long the runtime takes to decide whether
+ * a computed partition is disjoint as the number of
+ * subregions grows.  Each partition tiles a 2D index
+ * space into a grid of blocks.  The disjoint partitions
+ * use exact tiles while the aliased partitions grow
+ * each tile by a halo of one element so that every
+ * tile overlaps with its neighbors.
+ *
+ * It then measures how long equal and weighted partitions
+ * of an unstructured index space take to build as the
+ * number of subregions grows.  Every seventh element of
+ * the index space is freed so the parent has holes, and
+ * the subregions are checked to hold every element once.
+ */
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+};
+
+static double time_partition(HighLevelRuntime *runtime, Context ctx,
+                             IndexSpace is, int grid, int tile, int halo,
+                             bool expected)
+{
+  const int extent = grid * tile;
+  DomainPointColoring coloring;
+  for (int x = 0; x < grid; x++)
+  {
+    for (int y = 0; y < grid; y++)
+    {
+      Point<2> lo, hi;
+      lo.x[0] = std::max(x * tile - halo, 0);
+      lo.x[1] = std::max(y * tile - halo, 0);
+      hi.x[0] = std::min((x+1) * tile - 1 + halo, extent - 1);
+      hi.x[1] = std::min((y+1) * tile - 1 + halo, extent - 1);
+      Point<2> color;
+      color.x[0] = x;
+      color.x[1] = y;
+      coloring[DomainPoint::from_point<2>(color)] = 
+        Domain::from_rect<2>(Rect<2>(lo, hi));
+    }
+  }
+  Point<2> colors_lo, colors_hi;
+  colors_lo.x[0] = 0; colors_lo.x[1] = 0;
+  colors_hi.x[0] = grid - 1; colors_hi.x[1] = grid - 1;
+  Domain color_space = Domain::from_rect<2>(Rect<2>(colors_lo, colors_hi));
+
+  double start = Realm::Clock::current_time_in_microseconds();
+  IndexPartition ip = runtime->create_index_partition(ctx, is, color_space,
+                                                      coloring, COMPUTE_KIND);
+  bool disjoint = runtime->is_index_partition_disjoint(ctx, ip);
+  double stop = Realm::Clock::current_time_in_microseconds();
+  if (disjoint != expected)
+  {
+    printf("ERROR: partition with %d subregions reported as %s\n",
+           grid * grid, disjoint ? "disjoint" : "aliased");
+    assert(false);
+  }
+  runtime->destroy_index_partition(ctx, ip);
+  return (stop - start);
+}
+
+static double time_counted_partition(HighLevelRuntime *runtime, Context ctx,
+                                     IndexSpace is, size_t num_elements,
+                                     int num_colors, bool weighted)
+{
+  Domain color_space = 
+    Domain::from_rect<1>(Rect<1>(Point<1>(0), Point<1>(num_colors-1)));
+  std::map<DomainPoint,int> weights;
+  if (weighted)
+  {
+    for (int c = 0; c < num_colors; c++)
+      weights[DomainPoint::from_point<1>(Point<1>(c))] = 1 + (c % 3);
+  }
+
+  double start = Realm::Clock::current_time_in_microseconds();
+  IndexPartition ip = weighted ?
+    runtime->create_weighted_partition(ctx, is, color_space, weights) :
+    runtime->create_equal_partition(ctx, is, color_space);
+  // Waiting for the domains of all the subspaces waits for the partition
+  std::vector<Domain> domains(num_colors);
+  for (int c = 0; c < num_colors; c++)
+    domains[c] = runtime->get_index_space_domain(ctx,
+        runtime->get_index_subspace(ctx, ip, 
+                                    DomainPoint::from_point<1>(Point<1>(c))));
+  double stop = Realm::Clock::current_time_in_microseconds();
+
+  // Subregions get the elements in order, so each one
+  // has to start after the last one that has any ends
+  size_t total = 0;
+  int last_end = -1;
+  for (int c = 0; c < num_colors; c++)
+  {
+    const LegionRuntime::LowLevel::ElementMask &mask = 
+      domains[c].get_index_space().get_valid_mask();
+    size_t count = mask.pop_count();
+    if (count == 0)
+      continue;
+    if (mask.first_enabled() <= last_end)
+    {
+      printf("ERROR: subregion %d overlaps the one before it\n", c);
+      assert(false);
+    }
+    last_end = mask.last_enabled();
+    total += count;
+  }
+  if (total != num_elements)
+  {
+    printf("ERROR: %d subregions hold %zd of %zd elements\n", 
+           num_colors, total, num_elements);
+    assert(false);
+  }
+  runtime->destroy_index_partition(ctx, ip);
+  return (stop - start);
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, HighLevelRuntime *runtime)
+{
+  int max_subregions = 16384;
+  int tile = 8;
+  int max_colors = 1024;
+  int num_elements = (1 << 20);
+  {
+    const InputArgs &command_args = HighLevelRuntime::get_input_args();
+    for (int i = 1; i < command_args.argc; i++)
+    {
+      if (!strcmp(command_args.argv[i],"-n"))
+        max_subregions = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i],"-t"))
+        tile = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i],"-c"))
+        max_colors = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i],"-e"))
+        num_elements = atoi(command_args.argv[++i]);
+    }
+  }
+
+  printf("%12s %16s %16s\n", "subregions", "disjoint (us)", "aliased (us)");
+  for (int grid = 4; (grid * grid) <= max_subregions; grid *= 2)
+  {
+    const int extent = grid * tile;
+    Point<2> lo, hi;
+    lo.x[0] = 0; lo.x[1] = 0;
+    hi.x[0] = extent - 1; hi.x[1] = extent - 1;
+    IndexSpace is = runtime->create_index_space(ctx,
+                          Domain::from_rect<2>(Rect<2>(lo, hi)));
+    double disjoint_time = 
+      time_partition(runtime, ctx, is, grid, tile, 0/*halo*/, true);
+    double aliased_time = 
+      time_partition(runtime, ctx, is, grid, tile, 1/*halo*/, false);
+    printf("%12d %16.0f %16.0f\n", grid * grid, disjoint_time, aliased_time);
+    runtime->destroy_index_space(ctx, is);
+  }
+
+  IndexSpace is = runtime->create_index_space(ctx, num_elements);
+  size_t enabled = num_elements;
+  {
+    IndexAllocator allocator = runtime->create_index_allocator(ctx, is);
+    allocator.alloc(num_elements);
+    for (int i = 0; i < num_elements; i += 7, enabled--)
+      allocator.free(ptr_t(i));
+  }
+  printf("\n%12s %16s %16s  (%zd elements)\n", "subregions",
+         "equal (us)", "weighted (us)", enabled);
+  for (int colors = 16; colors <= max_colors; colors *= 4)
+  {
+    double equal_time = 
+      time_counted_partition(runtime, ctx, is, enabled, colors, false);
+    double weighted_time =
+      time_counted_partition(runtime, ctx, is, enabled, colors, true);
+    printf("%12d %16.0f %16.0f\n", colors, equal_time, weighted_time);
+  }
+  runtime->destroy_index_space(ctx, is);
+}
+
+int main(int argc, char **argv)
+{
+  HighLevelRuntime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+  HighLevelRuntime::register_legion_task<top_level_task>(TOP_LEVEL_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/);
+
+  return HighLevelRuntime::start(argc, argv);
+}
@@ -0,0 +1,279 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <set>
+#include "legion.h"
+#include "realm/timers.h"
+using namespace LegionRuntime::HighLevel;
+
+/*
+ * Times reduce_future_map against folding the values of
+ * a future map one point at a time in the parent task
+ * as the number of points grows.  Both are timed once
+ * every point is done, so the times are only the cost of
+ * gathering and folding the values.  Each launch is also
+ * reduced right after it is issued, while the points are
+ * still running, to check that the fold waits for every
+ * point.  Run it with several nodes (e.g.
+ * GASNET_PSHM_NODES=4 with the shm conduit) to see the
+ * cost of gathering values from other nodes.
+ *
+ * The second part times the broadcast of one future
+ * to every node.  A stamp task returns the time it
+ * finished and one reader per CPU, already waiting on
+ * its node, records how long after that it got to run.
+ * The stamp task delays first so that every reader has
+ * subscribed and the value goes down the broadcast
+ * tree (give each node a utility processor so readers
+ * are sent out while the stamp task sleeps).  Compare
+ * radixes with one run each, e.g.
+ *   for r in 0 2 4; do GASNET_PSHM_NODES=8 ./reduce_bench \
+ *     -ll:util 1 -hl:future_radix $r; done
+ * where 0 sends straight from the owner to every node.
+ * Latencies compare clocks across processes, so they
+ * are only meaningful when the nodes share a host.
+ */
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  VALUE_TASK_ID,
+  STAMP_TASK_ID,
+  READER_TASK_ID,
+};
+
+enum ReductionOpIDs {
+  SUM_REDUCE_ID = 1,
+};
+
+class SumReduction {
+public:
+  typedef long long LHS;
+  typedef long long RHS;
+  static const long long identity;
+
+  template <bool EXCLUSIVE> static void apply(LHS &lhs, RHS rhs);
+  template <bool EXCLUSIVE> static void fold(RHS &rhs1, RHS rhs2);
+};
+
+const long long SumReduction::identity = 0;
+
+template <>
+void SumReduction::apply<true>(LHS &lhs, RHS rhs)
+{
+  lhs += rhs;
+}
+
+template <>
+void SumReduction::apply<false>(LHS &lhs, RHS rhs)
+{
+  __sync_fetch_and_add(&lhs, rhs);
+}
+
+template <>
+void SumReduction::fold<true>(RHS &rhs1, RHS rhs2)
+{
+  rhs1 += rhs2;
+}
+
+template <>
+void SumReduction::fold<false>(RHS &rhs1, RHS rhs2)
+{
+  __sync_fetch_and_add(&rhs1, rhs2);
+}
+
+static long long point_value(int point)
+{
+  // Different for every point and large enough that a
+  // dropped or doubled point changes the sum
+  return ((long long)point * 1000003LL) ^ 0x5555LL;
+}
+
+long long value_task(const Task *task,
+                     const std::vector<PhysicalRegion> &regions,
+                     Context ctx, HighLevelRuntime *runtime)
+{
+  return point_value(task->index_point.get_point<1>()[0]);
+}
+
+long long stamp_task(const Task *task,
+                     const std::vector<PhysicalRegion> &regions,
+                     Context ctx, HighLevelRuntime *runtime)
+{
+  usleep(*((const int*)task->args));
+  return Realm::Clock::current_time_in_nanoseconds(true/*absolute*/);
+}
+
+struct BroadcastSample {
+  long long latency; // ns from the stamp task finishing
+  AddressSpaceID node;
+};
+
+BroadcastSample reader_task(const Task *task,
+                            const std::vector<PhysicalRegion> &regions,
+                            Context ctx, HighLevelRuntime *runtime)
+{
+  Future stamp = task->futures[0];
+  BroadcastSample sample;
+  sample.latency = Realm::Clock::current_time_in_nanoseconds(true/*absolute*/) -
+                   stamp.get_result<long long>();
+  sample.node = task->current_proc.address_space();
+  return sample;
+}
+
+static long long serial_fold(FutureMap fm, int num_points)
+{
+  long long result = SumReduction::identity;
+  for (int i = 0; i < num_points; i++)
+    SumReduction::fold<true>(result,
+        fm.get_result<long long>(DomainPoint::from_point<1>(Point<1>(i))));
+  return result;
+}
+
+static void time_reduce(HighLevelRuntime *runtime, Context ctx,
+                        int num_points)
+{
+  Rect<1> launch_bounds(Point<1>(0),Point<1>(num_points-1));
+  Domain launch_domain = Domain::from_rect<1>(launch_bounds);
+  IndexLauncher launcher(VALUE_TASK_ID, launch_domain,
+                         TaskArgument(NULL, 0), ArgumentMap());
+
+  FutureMap fm = runtime->execute_index_space(ctx, launcher);
+  Future early = runtime->reduce_future_map(ctx, fm, SUM_REDUCE_ID);
+  long long early_sum = early.get_result<long long>();
+
+  fm.wait_all_results();
+  double start = Realm::Clock::current_time_in_microseconds();
+  Future late = runtime->reduce_future_map(ctx, fm, SUM_REDUCE_ID);
+  long long late_sum = late.get_result<long long>();
+  double reduced = Realm::Clock::current_time_in_microseconds();
+  long long expected = serial_fold(fm, num_points);
+  double folded = Realm::Clock::current_time_in_microseconds();
+
+  if ((early_sum != expected) || (late_sum != expected))
+  {
+    printf("ERROR: reduced %lld and %lld but folding %d points gives %lld\n",
+           early_sum, late_sum, num_points, expected);
+    assert(false);
+  }
+  printf("%10d %16.2f %16.2f\n", num_points,
+         reduced - start, folded - reduced);
+}
+
+// Returns the latency of the slowest reader
+static long long time_broadcast(HighLevelRuntime *runtime, Context ctx,
+                                int num_readers, int delay_us,
+                                std::set<AddressSpaceID> &nodes)
+{
+  TaskLauncher stamp_launcher(STAMP_TASK_ID,
+                              TaskArgument(&delay_us, sizeof(delay_us)));
+  Future stamp = runtime->execute_task(ctx, stamp_launcher);
+
+  Rect<1> launch_bounds(Point<1>(0),Point<1>(num_readers-1));
+  Domain launch_domain = Domain::from_rect<1>(launch_bounds);
+  IndexLauncher launcher(READER_TASK_ID, launch_domain,
+                         TaskArgument(NULL, 0), ArgumentMap());
+  launcher.add_future(stamp);
+  FutureMap fm = runtime->execute_index_space(ctx, launcher);
+
+  long long slowest = 0;
+  for (int i = 0; i < num_readers; i++)
+  {
+    BroadcastSample sample = 
+      fm.get_result<BroadcastSample>(DomainPoint::from_point<1>(Point<1>(i)));
+    nodes.insert(sample.node);
+    if (sample.latency > slowest)
+      slowest = sample.latency;
+  }
+  return slowest;
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, HighLevelRuntime *runtime)
+{
+  int max_points = 65536;
+  int trials = 10;
+  int delay_us = 50000;
+  int radix = DEFAULT_FUTURE_BROADCAST_RADIX;
+  {
+    const InputArgs &command_args = HighLevelRuntime::get_input_args();
+    for (int i = 1; i < command_args.argc; i++)
+    {
+      if (!strcmp(command_args.argv[i],"-p"))
+        max_points = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i],"-t"))
+        trials = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i],"-d"))
+        delay_us = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i],"-hl:future_radix"))
+        radix = atoi(command_args.argv[++i]);
+    }
+  }
+
+  printf("%10s %16s %16s\n", "points", "reduce (us)", "serial fold (us)");
+  for (int points = 16; points <= max_points; points *= 16)
+    time_reduce(runtime, ctx, points);
+  printf("reduce_future_map matched the serial fold\n");
+
+  // One reader for every CPU in the machine
+  int num_readers = 0;
+  {
+    std::set<Processor> all_procs;
+    Machine::get_machine().get_all_processors(all_procs);
+    for (std::set<Processor>::const_iterator it = all_procs.begin();
+          it != all_procs.end(); it++)
+      if (it->kind() == Processor::LOC_PROC)
+        num_readers++;
+  }
+  std::set<AddressSpaceID> nodes;
+  long long total = 0, best = 0;
+  for (int i = 0; i < trials; i++)
+  {
+    long long latency = time_broadcast(runtime, ctx, num_readers, 
+                                       delay_us, nodes);
+    total += latency;
+    if ((i == 0) || (latency < best))
+      best = latency;
+  }
+  printf("broadcast to %zd nodes (%d readers, radix %d): "
+         "slowest reader after %.2f us (best %.2f us)\n",
+         nodes.size(), num_readers, radix,
+         1e-3 * total / trials, 1e-3 * best);
+}
+
+int main(int argc, char **argv)
+{
+  HighLevelRuntime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+  HighLevelRuntime::register_legion_task<top_level_task>(TOP_LEVEL_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/);
+  HighLevelRuntime::register_legion_task<long long, value_task>(VALUE_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, true/*index*/,
+      AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "value_task");
+  HighLevelRuntime::register_legion_task<long long, stamp_task>(STAMP_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/,
+      AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "stamp_task");
+  HighLevelRuntime::register_legion_task<BroadcastSample, reader_task>(
+      READER_TASK_ID, Processor::LOC_PROC, false/*single*/, true/*index*/,
+      AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "reader_task");
+  HighLevelRuntime::register_reduction_op<SumReduction>(SUM_REDUCE_ID);
+
+  return HighLevelRuntime::start(argc, argv);
+}
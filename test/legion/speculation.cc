@@ -0,0 +1,390 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include "legion.h"
+#include "default_mapper.h"
+using namespace LegionRuntime::HighLevel;
+using namespace LegionRuntime::Accessor;
+
+/*
+ * Checks that speculation on a predicate is committed or rolled
+ * back correctly once the predicate resolves.  A predicated leaf
+ * task writes a read-write field, a write-discard field and a
+ * reduction field.  The predicate comes from a task that only
+ * returns after the predicated task has run, so the task always
+ * runs speculatively.  When the predicate is false every field
+ * must be back to its old value and the task's future must hold
+ * the false result; when it is true the writes and the reduction
+ * must land.  The mapper always guesses true and checks that the
+ * task's write-discard requirement is still write-discard once it
+ * has been mapped.  Run with -hl:spec_stats to see the runtime's
+ * own counts.
+ */
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  COND_TASK_ID,
+  SPEC_TASK_ID,
+};
+
+enum FieldIDs {
+  FID_RW,
+  FID_WD,
+  FID_RED,
+};
+
+enum {
+  REDOP_SUM = 1,
+};
+
+enum {
+  OLD_RW = 1,
+  OLD_WD = 2,
+  OLD_RED = 3,
+  NEW_RW = OLD_RW + 10,
+  NEW_WD = 99,
+  RED_DELTA = 5,
+  TRUE_RESULT = 42,
+  FALSE_RESULT = -1,
+};
+
+class SumReduction {
+public:
+  typedef int LHS;
+  typedef int RHS;
+  static const int identity;
+
+  template <bool EXCLUSIVE> static void apply(LHS &lhs, RHS rhs);
+  template <bool EXCLUSIVE> static void fold(RHS &rhs1, RHS rhs2);
+};
+
+const int SumReduction::identity = 0;
+
+template <>
+void SumReduction::apply<true>(LHS &lhs, RHS rhs)
+{
+  lhs += rhs;
+}
+
+template <>
+void SumReduction::apply<false>(LHS &lhs, RHS rhs)
+{
+  __sync_fetch_and_add(&lhs, rhs);
+}
+
+template <>
+void SumReduction::fold<true>(RHS &rhs1, RHS rhs2)
+{
+  rhs1 += rhs2;
+}
+
+template <>
+void SumReduction::fold<false>(RHS &rhs1, RHS rhs2)
+{
+  __sync_fetch_and_add(&rhs1, rhs2);
+}
+
+struct CondArgs {
+  UserEvent spec_ran;
+  bool value;
+};
+
+static int num_errors = 0;
+static int discards_mapped = 0;
+
+static void check(bool ok, const char *what)
+{
+  if (!ok)
+  {
+    printf("ERROR: %s\n", what);
+    __sync_fetch_and_add(&num_errors, 1);
+  }
+}
+
+class SpeculationMapper : public DefaultMapper {
+public:
+  SpeculationMapper(Machine machine, HighLevelRuntime *rt, Processor local)
+    : DefaultMapper(machine, rt, local) { }
+public:
+  virtual void select_task_options(Task *task)
+  {
+    DefaultMapper::select_task_options(task);
+    // Keep the predicate task off the processor the predicated
+    // task runs on since it waits for that task to run
+    if (task->task_id == COND_TASK_ID)
+    {
+      std::set<Processor> all_procs;
+      machine.get_all_processors(all_procs);
+      for (std::set<Processor>::const_iterator it = all_procs.begin();
+            it != all_procs.end(); it++)
+      {
+        if (((*it).kind() == Processor::LOC_PROC) && (*it != local_proc))
+        {
+          task->target_proc = *it;
+          break;
+        }
+      }
+    }
+  }
+  virtual bool map_task(Task *task)
+  {
+    DefaultMapper::map_task(task);
+    // Ask to be told how the predicated task mapped
+    return (task->task_id == SPEC_TASK_ID);
+  }
+  virtual void notify_mapping_result(const Mappable *mappable)
+  {
+    const Task *task = mappable->as_mappable_task();
+    if ((task != NULL) && (task->task_id == SPEC_TASK_ID))
+    {
+      check(task->regions[1].privilege == WRITE_DISCARD,
+            "mapper saw the write-discard requirement promoted");
+      __sync_fetch_and_add(&discards_mapped, 1);
+    }
+  }
+  virtual bool speculate_on_predicate(const Mappable *mappable,
+                                      bool &spec_value)
+  {
+    spec_value = true;
+    return true;
+  }
+public:
+  void sample_statistics(SpeculationStatistics &stats) const
+  {
+    sample_speculation_statistics(stats);
+  }
+};
+
+static SpeculationMapper *local_mapper = NULL;
+
+void mapper_registration(Machine machine, HighLevelRuntime *rt,
+                         const std::set<Processor> &local_procs)
+{
+  for (std::set<Processor>::const_iterator it = local_procs.begin();
+        it != local_procs.end(); it++)
+  {
+    SpeculationMapper *mapper = new SpeculationMapper(machine, rt, *it);
+    if (local_mapper == NULL)
+      local_mapper = mapper;
+    rt->replace_default_mapper(mapper, *it);
+  }
+}
+
+bool cond_task(const Task *task,
+               const std::vector<PhysicalRegion> &regions,
+               Context ctx, HighLevelRuntime *runtime)
+{
+  const CondArgs *args = (const CondArgs*)task->args;
+  // Only resolve the predicate once the predicated task has run
+  args->spec_ran.wait();
+  return args->value;
+}
+
+int spec_task(const Task *task,
+              const std::vector<PhysicalRegion> &regions,
+              Context ctx, HighLevelRuntime *runtime)
+{
+  assert(regions.size() == 3);
+  RegionAccessor<AccessorType::Generic, int> acc_rw =
+    regions[0].get_field_accessor(FID_RW).typeify<int>();
+  RegionAccessor<AccessorType::Generic, int> acc_wd =
+    regions[1].get_field_accessor(FID_WD).typeify<int>();
+  RegionAccessor<AccessorType::Generic, int> acc_red =
+    regions[2].get_accessor().typeify<int>();
+  Domain dom = runtime->get_index_space_domain(ctx,
+      task->regions[0].region.get_index_space());
+  Rect<1> rect = dom.get_rect<1>();
+  for (GenericPointInRectIterator<1> pir(rect); pir; pir++)
+  {
+    DomainPoint dp = DomainPoint::from_point<1>(pir.p);
+    acc_rw.write(dp, acc_rw.read(dp) + (NEW_RW - OLD_RW));
+    acc_wd.write(dp, NEW_WD);
+    acc_red.reduce<SumReduction>(ptr_t(pir.p.x[0]), RED_DELTA);
+  }
+  const UserEvent *spec_ran = (const UserEvent*)task->args;
+  spec_ran->trigger();
+  return TRUE_RESULT;
+}
+
+static void fill_fields(HighLevelRuntime *runtime, Context ctx,
+                        LogicalRegion lr, const Rect<1> &rect)
+{
+  InlineLauncher launcher(RegionRequirement(lr, WRITE_DISCARD,
+                                            EXCLUSIVE, lr));
+  launcher.requirement.add_field(FID_RW);
+  launcher.requirement.add_field(FID_WD);
+  launcher.requirement.add_field(FID_RED);
+  PhysicalRegion pr = runtime->map_region(ctx, launcher);
+  pr.wait_until_valid();
+  RegionAccessor<AccessorType::Generic, int> acc_rw =
+    pr.get_field_accessor(FID_RW).typeify<int>();
+  RegionAccessor<AccessorType::Generic, int> acc_wd =
+    pr.get_field_accessor(FID_WD).typeify<int>();
+  RegionAccessor<AccessorType::Generic, int> acc_red =
+    pr.get_field_accessor(FID_RED).typeify<int>();
+  for (GenericPointInRectIterator<1> pir(rect); pir; pir++)
+  {
+    DomainPoint dp = DomainPoint::from_point<1>(pir.p);
+    acc_rw.write(dp, OLD_RW);
+    acc_wd.write(dp, OLD_WD);
+    acc_red.write(dp, OLD_RED);
+  }
+  runtime->unmap_region(ctx, pr);
+}
+
+static void check_fields(HighLevelRuntime *runtime, Context ctx,
+                         LogicalRegion lr, const Rect<1> &rect, bool hit)
+{
+  InlineLauncher launcher(RegionRequirement(lr, READ_ONLY, EXCLUSIVE, lr));
+  launcher.requirement.add_field(FID_RW);
+  launcher.requirement.add_field(FID_WD);
+  launcher.requirement.add_field(FID_RED);
+  PhysicalRegion pr = runtime->map_region(ctx, launcher);
+  pr.wait_until_valid();
+  RegionAccessor<AccessorType::Generic, int> acc_rw =
+    pr.get_field_accessor(FID_RW).typeify<int>();
+  RegionAccessor<AccessorType::Generic, int> acc_wd =
+    pr.get_field_accessor(FID_WD).typeify<int>();
+  RegionAccessor<AccessorType::Generic, int> acc_red =
+    pr.get_field_accessor(FID_RED).typeify<int>();
+  bool rw_ok = true, wd_ok = true, red_ok = true;
+  for (GenericPointInRectIterator<1> pir(rect); pir; pir++)
+  {
+    DomainPoint dp = DomainPoint::from_point<1>(pir.p);
+    rw_ok = rw_ok && (acc_rw.read(dp) == (hit ? NEW_RW : OLD_RW));
+    wd_ok = wd_ok && (acc_wd.read(dp) == (hit ? NEW_WD : OLD_WD));
+    red_ok = red_ok &&
+      (acc_red.read(dp) == (hit ? (OLD_RED + RED_DELTA) : OLD_RED));
+  }
+  check(rw_ok, hit ? "read-write field not written on a hit" :
+                     "read-write field not restored on a miss");
+  check(wd_ok, hit ? "write-discard field not written on a hit" :
+                     "write-discard field not restored on a miss");
+  check(red_ok, hit ? "reduction not applied on a hit" :
+                      "reduction applied on a miss");
+  runtime->unmap_region(ctx, pr);
+}
+
+static void run_case(HighLevelRuntime *runtime, Context ctx,
+                     LogicalRegion lr, const Rect<1> &rect, bool value)
+{
+  fill_fields(runtime, ctx, lr, rect);
+
+  SpeculationStatistics before;
+  local_mapper->sample_statistics(before);
+
+  CondArgs cond_args;
+  cond_args.spec_ran = UserEvent::create_user_event();
+  cond_args.value = value;
+  TaskLauncher cond_launcher(COND_TASK_ID,
+                             TaskArgument(&cond_args, sizeof(cond_args)));
+  Future cond = runtime->execute_task(ctx, cond_launcher);
+  Predicate pred = runtime->create_predicate(ctx, cond);
+
+  int false_result = FALSE_RESULT;
+  TaskLauncher spec_launcher(SPEC_TASK_ID,
+      TaskArgument(&cond_args.spec_ran, sizeof(cond_args.spec_ran)), pred);
+  spec_launcher.set_predicate_false_result(
+      TaskArgument(&false_result, sizeof(false_result)));
+  spec_launcher.add_region_requirement(
+      RegionRequirement(lr, READ_WRITE, EXCLUSIVE, lr));
+  spec_launcher.add_field(0, FID_RW);
+  spec_launcher.add_region_requirement(
+      RegionRequirement(lr, WRITE_DISCARD, EXCLUSIVE, lr));
+  spec_launcher.add_field(1, FID_WD);
+  spec_launcher.add_region_requirement(
+      RegionRequirement(lr, REDOP_SUM, EXCLUSIVE, lr));
+  spec_launcher.add_field(2, FID_RED);
+  Future result = runtime->execute_task(ctx, spec_launcher);
+
+  check(result.get_result<int>() == (value ? TRUE_RESULT : FALSE_RESULT),
+        value ? "future does not hold the task's result on a hit" :
+                "future does not hold the false result on a miss");
+  check_fields(runtime, ctx, lr, rect, value);
+
+  SpeculationStatistics after;
+  local_mapper->sample_statistics(after);
+  check((after.speculated - before.speculated) == 1,
+        "predicated task was not speculated");
+  if (value)
+  {
+    check((after.hits - before.hits) == 1, "hit not counted");
+    check(after.misses == before.misses, "hit counted as a miss");
+  }
+  else
+  {
+    check((after.misses - before.misses) == 1, "miss not counted");
+    check(after.hits == before.hits, "miss counted as a hit");
+    check((after.wasted_tasks - before.wasted_tasks) == 1,
+          "rolled back task not counted");
+  }
+  printf("%s: speculated %llu, hits %llu, misses %llu, "
+         "wasted tasks %llu\n", value ? "hit" : "miss",
+         after.speculated, after.hits, after.misses, after.wasted_tasks);
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, HighLevelRuntime *runtime)
+{
+  Rect<1> rect(Point<1>(0), Point<1>(1023));
+  IndexSpace is = runtime->create_index_space(ctx,
+                                  Domain::from_rect<1>(rect));
+  FieldSpace fs = runtime->create_field_space(ctx);
+  {
+    FieldAllocator allocator = runtime->create_field_allocator(ctx, fs);
+    allocator.allocate_field(sizeof(int), FID_RW);
+    allocator.allocate_field(sizeof(int), FID_WD);
+    allocator.allocate_field(sizeof(int), FID_RED);
+  }
+  LogicalRegion lr = runtime->create_logical_region(ctx, is, fs);
+
+  run_case(runtime, ctx, lr, rect, false/*miss*/);
+  run_case(runtime, ctx, lr, rect, true/*hit*/);
+  check(discards_mapped == 2, "mapper was not told how the task mapped");
+
+  runtime->destroy_logical_region(ctx, lr);
+  runtime->destroy_field_space(ctx, fs);
+  runtime->destroy_index_space(ctx, is);
+
+  if (num_errors > 0)
+  {
+    printf("FAILED with %d errors\n", num_errors);
+    exit(1);
+  }
+  printf("PASSED\n");
+}
+
+int main(int argc, char **argv)
+{
+  HighLevelRuntime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+  HighLevelRuntime::register_legion_task<top_level_task>(TOP_LEVEL_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/);
+  HighLevelRuntime::register_legion_task<bool, cond_task>(COND_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/,
+      AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "cond_task");
+  HighLevelRuntime::register_legion_task<int, spec_task>(SPEC_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/,
+      AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "spec_task");
+  HighLevelRuntime::register_reduction_op<SumReduction>(REDOP_SUM);
+  HighLevelRuntime::set_registration_callback(mapper_registration);
+
+  return HighLevelRuntime::start(argc, argv);
+}
@@ -0,0 +1,283 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include "legion.h"
+#include "default_mapper.h"
+using namespace LegionRuntime::HighLevel;
+using namespace LegionRuntime::Accessor;
+
+/*
+ * Checks the copies the runtime makes out of a composite
+ * instance of a large partition, which find the children that
+ * overlap their destination with a spatial index over the
+ * partition once it has at least -hl:subspace_index children.
+ * A 2D region is tiled into a grid of blocks and also covered
+ * by tiles grown by a halo of one element and by a few row
+ * stripes.  Every round the tile writers fill their block
+ * with the round number, then the halo readers and a reader
+ * per stripe check that they see that value everywhere.
+ * The mapper closes the tiles into a composite instance, so
+ * a tile that the copies miss leaves stale values behind.
+ * Run it with -hl:subspace_index 1 to index every partition
+ * and with a large value to index none of them.
+ */
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  WRITE_TASK_ID,
+  CHECK_TASK_ID,
+};
+
+enum FieldIDs {
+  FID_VAL,
+};
+
+
+class SubspaceIndexMapper : public DefaultMapper {
+public:
+  SubspaceIndexMapper(Machine m, HighLevelRuntime *rt, Processor p)
+    : DefaultMapper(m, rt, p) { }
+public:
+  // Closing the tiles with a composite instance makes the
+  // copies for the halos and stripes find the tiles that
+  // overlap them through the partition's spatial index
+  virtual bool rank_copy_targets(const Mappable *mappable,
+                                 LogicalRegion rebuild_region,
+                                 const std::set<Memory> &current_instances,
+                                 bool complete,
+                                 size_t max_blocking_factor,
+                                 std::set<Memory> &to_reuse,
+                                 std::vector<Memory> &to_create,
+                                 bool &create_one, size_t &blocking_factor)
+  {
+    DefaultMapper::rank_copy_targets(mappable, rebuild_region,
+                                     current_instances, complete,
+                                     max_blocking_factor, to_reuse,
+                                     to_create, create_one, blocking_factor);
+    return complete;
+  }
+};
+
+static Rect<2> subregion_rect(HighLevelRuntime *runtime, Context ctx,
+                              const PhysicalRegion &region)
+{
+  IndexSpace is = region.get_logical_region().get_index_space();
+  return runtime->get_index_space_domain(ctx, is).get_rect<2>();
+}
+
+void write_task(const Task *task,
+                const std::vector<PhysicalRegion> &regions,
+                Context ctx, HighLevelRuntime *runtime)
+{
+  const int round = *((const int*)task->args);
+  RegionAccessor<AccessorType::Generic, int> acc =
+    regions[0].get_field_accessor(FID_VAL).typeify<int>();
+  Rect<2> rect = subregion_rect(runtime, ctx, regions[0]);
+  for (GenericPointInRectIterator<2> pir(rect); pir; pir++)
+    acc.write(DomainPoint::from_point<2>(pir.p), round);
+}
+
+int check_task(const Task *task,
+               const std::vector<PhysicalRegion> &regions,
+               Context ctx, HighLevelRuntime *runtime)
+{
+  const int round = *((const int*)task->args);
+  RegionAccessor<AccessorType::Generic, int> acc =
+    regions[0].get_field_accessor(FID_VAL).typeify<int>();
+  Rect<2> rect = subregion_rect(runtime, ctx, regions[0]);
+  int stale = 0;
+  for (GenericPointInRectIterator<2> pir(rect); pir; pir++)
+    if (acc.read(DomainPoint::from_point<2>(pir.p)) != round)
+      stale++;
+  return stale;
+}
+
+static IndexPartition create_tiles(HighLevelRuntime *runtime, Context ctx,
+                                   IndexSpace is, int grid, int tile,
+                                   int halo)
+{
+  const int extent = grid * tile;
+  DomainPointColoring coloring;
+  for (int x = 0; x < grid; x++)
+  {
+    for (int y = 0; y < grid; y++)
+    {
+      Point<2> lo, hi;
+      lo.x[0] = std::max(x * tile - halo, 0);
+      lo.x[1] = std::max(y * tile - halo, 0);
+      hi.x[0] = std::min((x+1) * tile - 1 + halo, extent - 1);
+      hi.x[1] = std::min((y+1) * tile - 1 + halo, extent - 1);
+      coloring[DomainPoint::from_point<1>(Point<1>(x * grid + y))] =
+        Domain::from_rect<2>(Rect<2>(lo, hi));
+    }
+  }
+  Rect<1> colors(Point<1>(0), Point<1>(grid * grid - 1));
+  return runtime->create_index_partition(ctx, is,
+      Domain::from_rect<1>(colors), coloring,
+      (halo == 0) ? DISJOINT_KIND : ALIASED_KIND);
+}
+
+static IndexPartition create_stripes(HighLevelRuntime *runtime, Context ctx,
+                                     IndexSpace is, int extent, int stripes)
+{
+  DomainPointColoring coloring;
+  for (int s = 0; s < stripes; s++)
+  {
+    Point<2> lo, hi;
+    lo.x[0] = 0;
+    lo.x[1] = (s * extent) / stripes;
+    hi.x[0] = extent - 1;
+    hi.x[1] = ((s+1) * extent) / stripes - 1;
+    coloring[DomainPoint::from_point<1>(Point<1>(s))] =
+      Domain::from_rect<2>(Rect<2>(lo, hi));
+  }
+  Rect<1> colors(Point<1>(0), Point<1>(stripes - 1));
+  return runtime->create_index_partition(ctx, is,
+      Domain::from_rect<1>(colors), coloring, DISJOINT_KIND);
+}
+
+static int count_stale(FutureMap fm, int num_points)
+{
+  int stale = 0;
+  for (int i = 0; i < num_points; i++)
+    stale += fm.get_result<int>(DomainPoint::from_point<1>(Point<1>(i)));
+  return stale;
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, HighLevelRuntime *runtime)
+{
+  int grid = 16;
+  int tile = 8;
+  int num_stripes = 4;
+  int num_rounds = 3;
+  {
+    const InputArgs &command_args = HighLevelRuntime::get_input_args();
+    for (int i = 1; i < command_args.argc; i++)
+    {
+      if (!strcmp(command_args.argv[i],"-g"))
+        grid = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i],"-r"))
+        num_rounds = atoi(command_args.argv[++i]);
+    }
+  }
+  const int extent = grid * tile;
+  const int num_tiles = grid * grid;
+
+  Rect<2> bounds(make_point(0,0), make_point(extent-1,extent-1));
+  IndexSpace is = runtime->create_index_space(ctx,
+                                      Domain::from_rect<2>(bounds));
+  FieldSpace fs = runtime->create_field_space(ctx);
+  {
+    FieldAllocator allocator = runtime->create_field_allocator(ctx, fs);
+    allocator.allocate_field(sizeof(int), FID_VAL);
+  }
+  LogicalRegion lr = runtime->create_logical_region(ctx, is, fs);
+  LogicalPartition tiles = runtime->get_logical_partition(ctx, lr,
+      create_tiles(runtime, ctx, is, grid, tile, 0/*halo*/));
+  LogicalPartition halos = runtime->get_logical_partition(ctx, lr,
+      create_tiles(runtime, ctx, is, grid, tile, 1/*halo*/));
+  LogicalPartition stripes = runtime->get_logical_partition(ctx, lr,
+      create_stripes(runtime, ctx, is, extent, num_stripes));
+
+  Domain tile_domain =
+    Domain::from_rect<1>(Rect<1>(Point<1>(0), Point<1>(num_tiles - 1)));
+  int num_errors = 0;
+  for (int round = 1; round <= num_rounds; round++)
+  {
+    TaskArgument round_arg(&round, sizeof(round));
+    IndexLauncher writers(WRITE_TASK_ID, tile_domain, round_arg,
+                          ArgumentMap());
+    writers.add_region_requirement(
+        RegionRequirement(tiles, 0/*projection ID*/,
+                          READ_WRITE, EXCLUSIVE, lr));
+    writers.add_field(0, FID_VAL);
+    runtime->execute_index_space(ctx, writers);
+
+    IndexLauncher halo_checks(CHECK_TASK_ID, tile_domain, round_arg,
+                              ArgumentMap());
+    halo_checks.add_region_requirement(
+        RegionRequirement(halos, 0/*projection ID*/,
+                          READ_ONLY, EXCLUSIVE, lr));
+    halo_checks.add_field(0, FID_VAL);
+    FutureMap halo_fm = runtime->execute_index_space(ctx, halo_checks);
+
+    std::vector<Future> stripe_checks;
+    for (int s = 0; s < num_stripes; s++)
+    {
+      LogicalRegion stripe =
+        runtime->get_logical_subregion_by_color(ctx, stripes,
+                                  DomainPoint::from_point<1>(Point<1>(s)));
+      TaskLauncher check(CHECK_TASK_ID, round_arg);
+      check.add_region_requirement(
+          RegionRequirement(stripe, READ_ONLY, EXCLUSIVE, lr));
+      check.add_field(0, FID_VAL);
+      stripe_checks.push_back(runtime->execute_task(ctx, check));
+    }
+
+    int halo_stale = count_stale(halo_fm, num_tiles);
+    int stripe_stale = 0;
+    for (unsigned idx = 0; idx < stripe_checks.size(); idx++)
+      stripe_stale += stripe_checks[idx].get_result<int>();
+    if ((halo_stale > 0) || (stripe_stale > 0))
+    {
+      printf("ERROR: round %d: %d stale elements in halos, "
+             "%d in stripes\n", round, halo_stale, stripe_stale);
+      num_errors++;
+    }
+  }
+
+  runtime->destroy_logical_region(ctx, lr);
+  runtime->destroy_field_space(ctx, fs);
+  runtime->destroy_index_space(ctx, is);
+
+  if (num_errors > 0)
+  {
+    printf("FAILED with %d errors\n", num_errors);
+    exit(1);
+  }
+  printf("PASSED\n");
+}
+
+void mapper_registration(Machine machine, HighLevelRuntime *rt,
+                         const std::set<Processor> &local_procs)
+{
+  for (std::set<Processor>::const_iterator it = local_procs.begin();
+        it != local_procs.end(); it++)
+    rt->replace_default_mapper(new SubspaceIndexMapper(machine, rt, *it), *it);
+}
+
+int main(int argc, char **argv)
+{
+  HighLevelRuntime::set_registration_callback(mapper_registration);
+  HighLevelRuntime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+  HighLevelRuntime::register_legion_task<top_level_task>(TOP_LEVEL_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/);
+  HighLevelRuntime::register_legion_task<write_task>(WRITE_TASK_ID,
+      Processor::LOC_PROC, false/*single*/, true/*index*/,
+      AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "write_task");
+  HighLevelRuntime::register_legion_task<int, check_task>(CHECK_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, true/*index*/,
+      AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "check_task");
+
+  return HighLevelRuntime::start(argc, argv);
+}
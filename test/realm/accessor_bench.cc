@@ -0,0 +1,179 @@
+// measures the cost of element accesses through a generic accessor for AOS,
+//  SOA and hybrid SOA instances in system memory, comparing:
+//    call    - the old path, a call into the runtime for every element
+//    direct  - the layout found when the accessor is created
+//    span    - raw loops over spans from raw_span_ptr/dense_span_ptr
+//  and checks that all of them see the same data
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+
+#include <set>
+#include <vector>
+
+#include "realm/realm.h"
+
+using namespace Realm;
+using namespace LegionRuntime::Accessor;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+int num_elements = 1 << 20;
+int num_iterations = 10;
+
+typedef RegionAccessor<AccessorType::Generic, double> DoubleAccessor;
+
+static Memory find_sysmem(AddressSpace node)
+{
+  std::set<Memory> all_memories;
+  Machine::get_machine().get_all_memories(all_memories);
+  for(std::set<Memory>::const_iterator it = all_memories.begin();
+      it != all_memories.end();
+      it++)
+    if(((*it).kind() == Memory::SYSTEM_MEM) && ((*it).address_space() == node))
+      return *it;
+  return Memory::NO_MEMORY;
+}
+
+// each pass adds one to every element and returns the sum of the old values
+static double pass_elementwise(const DoubleAccessor& acc)
+{
+  double sum = 0;
+  for(int i = 0; i < num_elements; i++) {
+    double v = acc.read(ptr_t(i));
+    sum += v;
+    acc.write(ptr_t(i), v + 1);
+  }
+  return sum;
+}
+
+static double pass_spans(DoubleAccessor& acc)
+{
+  double sum = 0;
+  int i = 0;
+  while(i < num_elements) {
+    size_t count = num_elements - i;
+    double *p = acc.dense_span_ptr(ptr_t(i), count);
+    if(p) {
+      for(size_t j = 0; j < count; j++) {
+	sum += p[j];
+	p[j] += 1;
+      }
+    } else {
+      // strided span, which may end early at a block boundary
+      size_t act_count;
+      ByteOffset stride;
+      char *base = (char *)acc.raw_span_ptr(ptr_t(i), count, act_count, stride);
+      if(act_count < count)
+	count = act_count;
+      for(size_t j = 0; j < count; j++) {
+	double *e = (double *)(base + j * stride.offset);
+	sum += *e;
+	*e += 1;
+      }
+    }
+    i += count;
+  }
+  return sum;
+}
+
+static double expected_sum(int pass)
+{
+  // element i holds i + pass before the pass
+  return ((double)num_elements * (num_elements - 1)) / 2 + (double)pass * num_elements;
+}
+
+static void measure(Memory m, const char *desc, size_t block_size)
+{
+  Domain d = Domain::from_rect<1>(Rect<1>(Point<1>(0), Point<1>(num_elements - 1)));
+  // a double and an int per element, so that AOS isn't unit-stride
+  std::vector<size_t> field_sizes;
+  field_sizes.push_back(sizeof(double));
+  field_sizes.push_back(sizeof(int));
+  RegionInstance inst = d.create_instance(m, field_sizes, block_size);
+  assert(inst.exists());
+
+  DoubleAccessor direct = inst.get_accessor().typeify<double>();
+  assert(direct.dense_base != 0);
+  // the same accessor, without its direct layout
+  DoubleAccessor call = direct;
+  call.dense_base = 0;
+
+  for(int i = 0; i < num_elements; i++)
+    call.write(ptr_t(i), i);
+
+  int pass = 0;
+  printf("%-10s", desc);
+
+  const char *names[] = { "call", "direct", "span" };
+  for(int path = 0; path < 3; path++) {
+    long long start = Clock::current_time_in_nanoseconds();
+    for(int it = 0; it < num_iterations; it++) {
+      double sum;
+      switch(path) {
+      case 0: sum = pass_elementwise(call); break;
+      case 1: sum = pass_elementwise(direct); break;
+      default: sum = pass_spans(direct); break;
+      }
+      if(sum != expected_sum(pass)) {
+	printf("\nMISMATCH: %s pass %d: %g != %g\n", names[path], pass, sum, expected_sum(pass));
+	exit(1);
+      }
+      pass++;
+    }
+    long long elapsed = Clock::current_time_in_nanoseconds() - start;
+    printf(" %s %6.2f ns/elem", names[path],
+	   (double)elapsed / ((double)num_elements * num_iterations));
+  }
+  printf("\n");
+
+  inst.destroy();
+}
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  Memory m = find_sysmem(p.address_space());
+  assert(m.exists());
+
+  measure(m, "AOS:", 1);
+  measure(m, "SOA:", num_elements);
+  measure(m, "hybrid:", 1024);
+
+  printf("done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-n")) {
+      num_elements = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+  }
+  assert(num_elements > 1);
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  return 0;
+}
@@ -0,0 +1,182 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// measures the latency and bandwidth of the active message layer between
+//  two nodes - with the shm conduit both nodes can be on one machine:
+//
+//    make CONDUIT=shm am_bench
+//    GASNET_PSHM_NODES=2 ./am_bench
+//
+// with a single node there is nothing to measure, so the test just passes
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <unistd.h>
+
+#include "realm/realm.h"
+
+using namespace Realm;
+using namespace LegionRuntime::Arrays;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  EMPTY_TASK     = Processor::TASK_ID_FIRST_AVAILABLE+1,
+};
+
+int num_iterations = 1000;
+size_t max_copy_size = 16 << 20;
+
+void empty_task(const void *args, size_t arglen, Processor p)
+{
+}
+
+static Processor find_remote_cpu(Processor p)
+{
+  std::set<Processor> all_processors;
+  Machine::get_machine().get_all_processors(all_processors);
+  for(std::set<Processor>::const_iterator it = all_processors.begin();
+      it != all_processors.end();
+      it++)
+    if(((*it).kind() == Processor::LOC_PROC) &&
+       ((*it).address_space() != p.address_space()))
+      return *it;
+  return Processor::NO_PROC;
+}
+
+static Memory find_sysmem(AddressSpace node)
+{
+  std::set<Memory> all_memories;
+  Machine::get_machine().get_all_memories(all_memories);
+  for(std::set<Memory>::const_iterator it = all_memories.begin();
+      it != all_memories.end();
+      it++)
+    if(((*it).kind() == Memory::SYSTEM_MEM) && ((*it).address_space() == node))
+      return *it;
+  return Memory::NO_MEMORY;
+}
+
+// each remote spawn is a request message and the finish event trigger is
+//  the response, so waiting on each one in turn measures the round trip
+static void measure_latency(Processor remote)
+{
+  for(int i = 0; i < 10; i++)
+    remote.spawn(EMPTY_TASK, 0, 0).wait();
+
+  long long start = Clock::current_time_in_microseconds();
+  for(int i = 0; i < num_iterations; i++)
+    remote.spawn(EMPTY_TASK, 0, 0).wait();
+  long long elapsed = Clock::current_time_in_microseconds() - start;
+  printf("round trip latency: %.2f us\n", (double)elapsed / num_iterations);
+
+  // without waiting, the spawns stream out back to back
+  start = Clock::current_time_in_microseconds();
+  std::set<Event> events;
+  for(int i = 0; i < num_iterations; i++)
+    events.insert(remote.spawn(EMPTY_TASK, 0, 0));
+  Event::merge_events(events).wait();
+  elapsed = Clock::current_time_in_microseconds() - start;
+  printf("message rate: %.0f spawns/s\n", num_iterations * 1e6 / (elapsed ? elapsed : 1));
+}
+
+static void measure_bandwidth(Memory src_mem, Memory dst_mem, const char *desc)
+{
+  for(size_t size = 4096; size <= max_copy_size; size <<= 2) {
+    size_t elmts = size / sizeof(long long);
+    Domain d = Domain::from_rect<1>(Rect<1>(Point<1>(0), Point<1>(elmts - 1)));
+    RegionInstance src_inst = d.create_instance(src_mem, sizeof(long long));
+    RegionInstance dst_inst = d.create_instance(dst_mem, sizeof(long long));
+    assert(src_inst.exists() && dst_inst.exists());
+
+    // enough repetitions to move 64MB, within the iteration limit
+    int reps = (64 << 20) / size;
+    if(reps > num_iterations) reps = num_iterations;
+    if(reps < 1) reps = 1;
+
+    std::vector<Domain::CopySrcDstField> srcs(1), dsts(1);
+    srcs[0] = Domain::CopySrcDstField(src_inst, 0, sizeof(long long));
+    dsts[0] = Domain::CopySrcDstField(dst_inst, 0, sizeof(long long));
+
+    d.copy(srcs, dsts).wait();
+    long long start = Clock::current_time_in_microseconds();
+    Event e = Event::NO_EVENT;
+    for(int i = 0; i < reps; i++)
+      e = d.copy(srcs, dsts, e);
+    e.wait();
+    long long elapsed = Clock::current_time_in_microseconds() - start;
+    printf("%s %9zd bytes: %8.1f MB/s\n", desc, size,
+	   (double)size * reps / (elapsed ? elapsed : 1));
+
+    src_inst.destroy();
+    dst_inst.destroy();
+  }
+}
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  Processor remote = find_remote_cpu(p);
+  if(!remote.exists()) {
+    printf("only one node - nothing to measure (run with GASNET_PSHM_NODES=2 for the shm conduit)\n");
+    // give the worker threads a chance to finish starting up before the
+    //  shutdown (see ctxswitch)
+    sleep(1);
+    Runtime::get_runtime().shutdown();
+    return;
+  }
+  printf("measuring between processors " IDFMT " and " IDFMT "\n", p.id, remote.id);
+
+  measure_latency(remote);
+
+  Memory local_mem = find_sysmem(p.address_space());
+  Memory remote_mem = find_sysmem(remote.address_space());
+  assert(local_mem.exists() && remote_mem.exists());
+  measure_bandwidth(local_mem, remote_mem, "put");
+  measure_bandwidth(remote_mem, local_mem, "get");
+
+  printf("done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-s")) {
+      max_copy_size = ((size_t)atoi(argv[++i])) << 10;
+      continue;
+    }
+  }
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+  rt.register_task(EMPTY_TASK, empty_task);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  return 0;
+}
@@ -16,6 +16,7 @@ enum {
   TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
   CHILD_TASK     = Processor::TASK_ID_FIRST_AVAILABLE+1,
   CHECK_TASK     = Processor::TASK_ID_FIRST_AVAILABLE+2,
+  LATENCY_TASK   = Processor::TASK_ID_FIRST_AVAILABLE+3,
 };
 
 enum { REDOP_ADD = 1 };
@@ -43,10 +44,17 @@ struct ChildTaskArgs {
   Barrier b;
 };
 
+struct LatencyTaskArgs {
+  size_t num_iters;
+  Barrier b;
+};
+
 static const int BARRIER_INITIAL_VALUE = 42;
 
 static int errors = 0;
 
+static size_t latency_iters = 1000;
+
 // we're going to use alarm() as a watchdog to detect deadlocks
 void sigalrm_handler(int sig)
 {
@@ -120,6 +128,66 @@ void check_task(const void *args, size_t arglen, Processor p)
   }
 }
 
+// each latency task arrives at every generation of the barrier and waits for it
+//  to trigger before going on to the next one
+void latency_task(const void *args, size_t arglen, Processor p)
+{
+  assert(arglen == sizeof(LatencyTaskArgs));
+  const LatencyTaskArgs& lat_args = *(const LatencyTaskArgs *)args;
+
+  Barrier b = lat_args.b;
+  for(size_t i = 0; i < lat_args.num_iters; i++) {
+    int reduce_val = 1;
+    b.arrive(1, Event::NO_EVENT, &reduce_val, sizeof(reduce_val));
+    b.wait();
+    b = b.advance_barrier();
+  }
+}
+
+// time back-to-back generations of a reduction barrier that every CPU arrives at
+static void measure_barrier_latency(const std::vector<Processor>& all_cpus)
+{
+  // restart the watchdog for the loop - a generation waits for an arrival
+  //  from every CPU, which is slow when the nodes share a host, so allow
+  //  up to 100ms per arrival
+  alarm(10 + (latency_iters * all_cpus.size()) / 10);
+
+  Barrier b = Barrier::create_barrier(all_cpus.size(), REDOP_ADD,
+				      &BARRIER_INITIAL_VALUE, sizeof(BARRIER_INITIAL_VALUE));
+
+  long long start = Clock::current_time_in_nanoseconds();
+
+  std::set<Event> task_events;
+  for(size_t i = 0; i < all_cpus.size(); i++) {
+    LatencyTaskArgs args;
+    args.num_iters = latency_iters;
+    args.b = b;
+
+    Event e = all_cpus[i].spawn(LATENCY_TASK, &args, sizeof(args));
+    task_events.insert(e);
+  }
+  Event::merge_events(task_events).wait();
+
+  long long elapsed = Clock::current_time_in_nanoseconds() - start;
+
+  // every generation reduces one arrival per CPU - check the last one
+  Barrier last = b;
+  for(size_t i = 1; i < latency_iters; i++)
+    last = last.advance_barrier();
+  int result;
+  bool ready = last.get_result(&result, sizeof(result));
+  int exp_result = BARRIER_INITIAL_VALUE + all_cpus.size();
+  if(!ready || (result != exp_result)) {
+    printf("latency: last generation = %d (%d) ERROR (expected %d)\n", result, ready, exp_result);
+    errors++;
+  }
+
+  printf("barrier latency: %zd arrivals/generation, %zd generations, %.2f us/generation\n",
+	 all_cpus.size(), latency_iters, 1e-3 * elapsed / latency_iters);
+
+  b.destroy_barrier();
+}
+
 void top_level_task(const void *args, size_t arglen, Processor p)
 {
   printf("top level task - getting machine and list of CPUs\n");
@@ -208,6 +276,9 @@ void top_level_task(const void *args, size_t arglen, Processor p)
 
   b.destroy_barrier();
 
+  if(latency_iters > 0)
+    measure_barrier_latency(all_cpus);
+
   if(errors > 0) {
     printf("Exiting with errors.\n");
     exit(1);
@@ -226,9 +297,17 @@ int main(int argc, char **argv)
 
   rt.init(&argc, &argv);
 
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-b")) {
+      latency_iters = atoi(argv[++i]);
+      continue;
+    }
+  }
+
   rt.register_task(TOP_LEVEL_TASK, top_level_task);
   rt.register_task(CHILD_TASK, child_task);
   rt.register_task(CHECK_TASK, check_task);
+  rt.register_task(LATENCY_TASK, latency_task);
 
   rt.register_reduction(REDOP_ADD, 
 			ReductionOpUntyped::create_reduction_op<ReductionOpIntAdd>());
@@ -0,0 +1,145 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// compares the DMA system's copy cost model (Machine::estimate_copy_time)
+//  with measured copy times, from this node's system memory to itself and
+//  to every other node's system memory (remote writes only complete when
+//  the remote node acknowledges them), and checks that a copy stops
+//  counting against its memory pair once its completion event triggers
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+
+#include <set>
+#include <vector>
+
+#include "realm/realm.h"
+
+using namespace Realm;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+size_t max_bytes = 16 << 20;
+int num_iterations = 8;
+
+static void find_sysmems(std::vector<Memory>& sysmems)
+{
+  std::set<Memory> all_memories;
+  Machine::get_machine().get_all_memories(all_memories);
+  for(std::set<Memory>::const_iterator it = all_memories.begin();
+      it != all_memories.end();
+      it++)
+    if((*it).kind() == Memory::SYSTEM_MEM)
+      sysmems.push_back(*it);
+}
+
+static void measure(Memory src_mem, Memory dst_mem, size_t bytes)
+{
+  size_t num_elements = bytes / sizeof(double);
+  Domain d = Domain::from_rect<1>(Rect<1>(Point<1>(0), Point<1>(num_elements - 1)));
+  RegionInstance src_inst = d.create_instance(src_mem, sizeof(double));
+  RegionInstance dst_inst = d.create_instance(dst_mem, sizeof(double));
+  assert(src_inst.exists() && dst_inst.exists());
+  std::vector<Domain::CopySrcDstField> srcs, dsts;
+  srcs.push_back(Domain::CopySrcDstField(src_inst, 0, sizeof(double)));
+  dsts.push_back(Domain::CopySrcDstField(dst_inst, 0, sizeof(double)));
+
+  Machine machine = Machine::get_machine();
+  double first_est = machine.estimate_copy_time(src_mem, dst_mem, bytes);
+  double total_est = 0;
+  long long total_ns = 0;
+  for(int i = 0; i < num_iterations; i++) {
+    double est = machine.estimate_copy_time(src_mem, dst_mem, bytes);
+    long long start = Clock::current_time_in_nanoseconds();
+    d.copy(srcs, dsts).wait();
+    total_ns += Clock::current_time_in_nanoseconds() - start;
+    total_est += est;
+
+    // the copy (including any remote writes) is complete, so it must no
+    //  longer count as queued - with a bandwidth observed, an empty copy
+    //  is then predicted to take no time at all
+    double idle = machine.estimate_copy_time(src_mem, dst_mem, 0);
+    if(idle != 0) {
+      printf("ERROR: " IDFMT " -> " IDFMT ": %.0f ns still queued after copy %d\n",
+	     src_mem.id, dst_mem.id, idle, i);
+      exit(1);
+    }
+  }
+
+  double meas = (double)total_ns / num_iterations;
+  double est = total_est / num_iterations;
+  printf("  %9zd bytes: first est %10.0f ns, est %10.0f ns, measured %10.0f ns (est/meas %.2f)\n",
+	 bytes, first_est, est, meas, est / meas);
+
+  src_inst.destroy();
+  dst_inst.destroy();
+}
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  std::vector<Memory> sysmems;
+  find_sysmems(sysmems);
+
+  Memory local = Memory::NO_MEMORY;
+  for(std::vector<Memory>::const_iterator it = sysmems.begin(); it != sysmems.end(); it++)
+    if((*it).address_space() == p.address_space())
+      local = *it;
+  assert(local.exists());
+
+  for(std::vector<Memory>::const_iterator it = sysmems.begin(); it != sysmems.end(); it++) {
+    printf("sysmem " IDFMT " (node %d) -> sysmem " IDFMT " (node %d):\n",
+	   local.id, local.address_space(), (*it).id, (*it).address_space());
+    for(size_t bytes = 64 << 10; bytes <= max_bytes; bytes <<= 2)
+      measure(local, *it, bytes);
+  }
+
+  printf("done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-b")) {
+      max_bytes = strtoull(argv[++i], 0, 0);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+  }
+  assert(num_iterations > 0);
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  return 0;
+}
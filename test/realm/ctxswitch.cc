@@ -17,6 +17,8 @@ enum {
   TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
   SWITCH_TEST_TASK,
   SLEEP_TEST_TASK,
+  BLOCK_TEST_TASK,
+  TRIGGER_TASK,
 };
 
 // we're going to use alarm() as a watchdog to detect deadlocks
@@ -84,11 +86,29 @@ void sleep_task(const void *args, size_t arglen, Processor p)
 #endif
 }
 
+// each blocking child just waits on an event that's triggered once all the
+//  children have started - every one of them needs its own thread (and stack)
+//  while it's blocked
+void block_task(const void *args, size_t arglen, Processor p)
+{
+  assert(arglen == sizeof(UserEvent));
+  UserEvent go = *(const UserEvent *)args;
+  go.wait();
+}
+
+void trigger_task(const void *args, size_t arglen, Processor p)
+{
+  assert(arglen == sizeof(UserEvent));
+  UserEvent go = *(const UserEvent *)args;
+  go.trigger();
+}
+
 static int num_children = 4;
 static int num_iterations = 100000;
 static int timeout_seconds = 10;
 static int sleep_useconds = 500000;
 static int concurrent_io = 1;
+static int num_blockers = 100;
 
 void top_level_task(const void *args, size_t arglen, Processor p)
 {
@@ -154,6 +174,33 @@ void top_level_task(const void *args, size_t arglen, Processor p)
                pp.id, k, elapsed, ns_per_switch);
       }
 
+      // next, the blocking test - many tasks blocked at once, which costs a
+      //  thread per task - done twice, as the second round should be able to
+      //  reuse threads/stacks from the first
+      for(int round = 0; (num_blockers > 0) && (round < 2); round++) {
+	alarm(timeout_seconds);
+
+	UserEvent go = UserEvent::create_user_event();
+
+	double t_start = Clock::current_time();
+	std::set<Event> finish_events;
+	for(int i = 0; i < num_blockers; i++)
+	  finish_events.insert(pp.spawn(BLOCK_TEST_TASK, &go, sizeof(go)));
+	// tasks on a processor start in order, so this runs after every
+	//  blocker has started and is waiting
+	finish_events.insert(pp.spawn(TRIGGER_TASK, &go, sizeof(go)));
+
+	Event e = Event::merge_events(finish_events);
+	e.wait();
+	double t_end = Clock::current_time();
+
+	alarm(0);
+
+	double elapsed = t_end - t_start;
+	printf("block: proc " IDFMT " (kind=%d) round %d: %d blocked tasks, time/task=%6.0fns\n",
+	       pp.id, k, round, num_blockers, 1e9 * elapsed / num_blockers);
+      }
+
       // now the sleep (i.e. kernel-level switching, if possible) test
       if(sleep_useconds > 0) {
         double exp_time = 1e-6 * sleep_useconds;
@@ -236,6 +283,11 @@ int main(int argc, char **argv)
       continue;
     }
 
+    if(!strcmp(argv[i], "-b")) {
+      num_blockers = atoi(argv[++i]);
+      continue;
+    }
+
     // peek at Realm configuration here...
     if(!strcmp(argv[i], "-ll:concurrent_io")) {
       concurrent_io = atoi(argv[++i]);
@@ -246,6 +298,8 @@ int main(int argc, char **argv)
   rt.register_task(TOP_LEVEL_TASK, top_level_task);
   rt.register_task(SWITCH_TEST_TASK, switch_task);
   rt.register_task(SLEEP_TEST_TASK, sleep_task);
+  rt.register_task(BLOCK_TEST_TASK, block_task);
+  rt.register_task(TRIGGER_TASK, trigger_task);
 
   signal(SIGALRM, sigalrm_handler);
 
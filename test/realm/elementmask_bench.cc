@@ -0,0 +1,228 @@
+// measures the cost of the ElementMask set operations (union, intersect,
+//  difference), enumeration and serialization for masks of different
+//  densities and run lengths - each mask is timed twice, once in whatever
+//  representation it picked for itself (a run list for masks made of a few
+//  long runs) and once forced into its bitmap form, and the results of the
+//  two are checked against each other - at the end several threads read
+//  one shared run-list mask at once in ways that need its bitmap form
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <vector>
+#include <pthread.h>
+
+#include "realm/realm.h"
+#include "realm/indexspace.h"
+#include "realm/serialize.h"
+
+using namespace Realm;
+
+int num_elements = 1 << 22;
+int num_iterations = 10;
+
+// builds a mask out of runs of about 'run_length' enabled elements, spaced
+//  so that roughly 'density' of all the elements are enabled
+static void build_mask(ElementMask& mask, double density, int run_length,
+		       unsigned seed)
+{
+  srand(seed);
+  int avg_gap = (int)(run_length * (1.0 - density) / density);
+  int pos = rand() % (avg_gap + 1);
+  while(pos < num_elements) {
+    int len = 1 + rand() % (2 * run_length);
+    if(len > (num_elements - pos))
+      len = num_elements - pos;
+    mask.enable(pos, len);
+    pos += len + 1 + ((avg_gap > 0) ? (rand() % (2 * avg_gap)) : 0);
+  }
+}
+
+struct Results {
+  size_t union_count, intersect_count, diff_count;
+  int spans;
+  size_t bytes;
+  ElementMask union_mask;
+};
+
+static double elapsed_us(long long start)
+{
+  return (Clock::current_time_in_nanoseconds() - start) * 1e-3 / num_iterations;
+}
+
+static void measure(const char *name, const ElementMask& a, const ElementMask& b,
+		    Results& r)
+{
+  long long start;
+
+  start = Clock::current_time_in_nanoseconds();
+  for(int i = 0; i < num_iterations; i++)
+    r.union_mask = a | b;
+  double t_union = elapsed_us(start);
+  r.union_count = r.union_mask.pop_count();
+
+  ElementMask tmp;
+  start = Clock::current_time_in_nanoseconds();
+  for(int i = 0; i < num_iterations; i++)
+    tmp = a & b;
+  double t_intersect = elapsed_us(start);
+  r.intersect_count = tmp.pop_count();
+
+  start = Clock::current_time_in_nanoseconds();
+  for(int i = 0; i < num_iterations; i++)
+    tmp = a - b;
+  double t_diff = elapsed_us(start);
+  r.diff_count = tmp.pop_count();
+
+  start = Clock::current_time_in_nanoseconds();
+  for(int i = 0; i < num_iterations; i++) {
+    r.spans = 0;
+    ElementMask::Enumerator e(a, 0, 1);
+    int pos, len;
+    while(e.get_next(pos, len))
+      r.spans++;
+  }
+  double t_enum = elapsed_us(start);
+
+  start = Clock::current_time_in_nanoseconds();
+  for(int i = 0; i < num_iterations; i++) {
+    Serialization::DynamicBufferSerializer dbs(1024);
+    bool ok = (dbs << a);
+    assert(ok);
+    r.bytes = dbs.bytes_used();
+    Serialization::FixedBufferDeserializer fbd(dbs.get_buffer(), r.bytes);
+    ElementMask copy;
+    ok = (fbd >> copy);
+    assert(ok && (copy == a));
+  }
+  double t_serdez = elapsed_us(start);
+
+  printf("  %-5s %4s %10.1f %10.1f %10.1f %10.1f %10.1f %10zd\n",
+	 name, (a.runs ? "runs" : "bits"),
+	 t_union, t_intersect, t_diff, t_enum, t_serdez, r.bytes);
+}
+
+// each reader expands, combines and serializes the same shared mask, none
+//  of which is allowed to change its representation under the others
+struct SharedReadArgs {
+  const ElementMask *runs_mask, *dense_mask;
+  const void *expected_bits;
+  size_t expected_union;
+  bool ok;
+};
+
+static void *shared_read_thread(void *data)
+{
+  SharedReadArgs *args = (SharedReadArgs *)data;
+  size_t bytes = args->runs_mask->raw_size();
+  void *bits = malloc(bytes);
+  args->ok = true;
+  for(int i = 0; i < num_iterations; i++) {
+    args->runs_mask->copy_raw(bits);
+    if(memcmp(bits, args->expected_bits, bytes))
+      args->ok = false;
+    ElementMask u = *(args->runs_mask) | *(args->dense_mask);
+    if(u.pop_count() != args->expected_union)
+      args->ok = false;
+    Serialization::DynamicBufferSerializer dbs(1024);
+    if(!(dbs << *(args->runs_mask)))
+      args->ok = false;
+  }
+  free(bits);
+  return 0;
+}
+
+static void check_shared_reads(int num_threads)
+{
+  ElementMask a(num_elements), b(num_elements);
+  build_mask(a, 0.5, 65536, 4242);
+  build_mask(b, 0.5, 64, 4243);
+  b.make_dense();
+  assert(a.runs != 0);
+
+  void *expected_bits = malloc(a.raw_size());
+  a.copy_raw(expected_bits);
+  size_t expected_union = (a | b).pop_count();
+
+  std::vector<pthread_t> threads(num_threads);
+  std::vector<SharedReadArgs> args(num_threads);
+  for(int i = 0; i < num_threads; i++) {
+    args[i].runs_mask = &a;
+    args[i].dense_mask = &b;
+    args[i].expected_bits = expected_bits;
+    args[i].expected_union = expected_union;
+    pthread_create(&threads[i], 0, shared_read_thread, &args[i]);
+  }
+  bool ok = true;
+  for(int i = 0; i < num_threads; i++) {
+    pthread_join(threads[i], 0);
+    ok = ok && args[i].ok;
+  }
+  free(expected_bits);
+
+  if(!ok || (a.runs == 0)) {
+    printf("MISMATCH in shared reads\n");
+    exit(1);
+  }
+  printf("%d threads reading a shared run list: ok\n", num_threads);
+}
+
+int main(int argc, char **argv)
+{
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-n")) {
+      num_elements = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+  }
+
+  double densities[] = { 0.01, 0.5, 0.99 };
+  int run_lengths[] = { 1, 64, 65536 };
+
+  printf("%d elements, times in us\n", num_elements);
+  printf("  %-5s %4s %10s %10s %10s %10s %10s %10s\n", "", "rep",
+	 "union", "intersect", "diff", "enumerate", "serdez", "bytes");
+  for(size_t d = 0; d < sizeof(densities) / sizeof(densities[0]); d++)
+    for(size_t l = 0; l < sizeof(run_lengths) / sizeof(run_lengths[0]); l++) {
+      printf("density %.2f, run length %d:\n", densities[d], run_lengths[l]);
+      ElementMask a(num_elements), b(num_elements);
+      build_mask(a, densities[d], run_lengths[l], 1 + d * 7 + l);
+      build_mask(b, densities[d], run_lengths[l], 1001 + d * 7 + l);
+
+      Results auto_results, dense_results;
+      measure("auto", a, b, auto_results);
+
+      ElementMask dense_a(a), dense_b(b);
+      dense_a.make_dense();
+      dense_b.make_dense();
+      measure("dense", dense_a, dense_b, dense_results);
+
+      if((auto_results.union_count != dense_results.union_count) ||
+	 (auto_results.intersect_count != dense_results.intersect_count) ||
+	 (auto_results.diff_count != dense_results.diff_count) ||
+	 (auto_results.spans != dense_results.spans) ||
+	 (auto_results.union_mask != dense_results.union_mask) ||
+	 (auto_results.union_count + auto_results.intersect_count !=
+	    a.pop_count() + b.pop_count())) {
+	printf("MISMATCH\n");
+	exit(1);
+      }
+      // and spot check the union against the inputs element by element
+      for(int i = 0; i < num_elements; i += 97)
+	if(auto_results.union_mask.is_set(i) != (a.is_set(i) || b.is_set(i))) {
+	  printf("MISMATCH at %d\n", i);
+	  exit(1);
+	}
+    }
+
+  check_shared_reads(4);
+
+  printf("done!\n");
+  return 0;
+}
@@ -0,0 +1,111 @@
+// measures the memory footprint and iteration cost of the node sets that
+//  track remote waiters on events, reservations and metadata, comparing
+//  Realm's adaptive NodeSet with the Legion runtime's IntegerSet-based one
+//  (which Realm used to share) for a range of set sizes - nearly every
+//  event in the event table has no remote waiters or just a few, and the
+//  iteration is what an event trigger does to notify the waiters
+//
+// on glibc systems heap usage is measured by interposing malloc; on other
+//  systems only the size of the set objects themselves is reported
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+
+#include <vector>
+
+#include "realm/realm.h"
+#include "realm/nodeset.h"
+#include "legion_types.h"
+#include "legion_utilities.h"
+
+using namespace Realm;
+
+typedef LegionRuntime::HighLevel::NodeSet LegionNodeSet;
+
+int num_sets = 10000;
+int num_iterations = 100;
+
+#ifdef __GLIBC__
+extern "C" void *__libc_malloc(size_t size);
+
+static volatile long long malloc_bytes = 0;
+
+extern "C" void *malloc(size_t size)
+{
+  __sync_fetch_and_add(&malloc_bytes, size);
+  return __libc_malloc(size);
+}
+
+static long long current_malloc_bytes(void) { return malloc_bytes; }
+#define COUNTING_MALLOCS 1
+#else
+static long long current_malloc_bytes(void) { return 0; }
+#define COUNTING_MALLOCS 0
+#endif
+
+// stands in for sending a trigger message to each node
+struct SumNodes {
+  SumNodes(void) : sum(0) {}
+  inline void apply(unsigned node) { sum += node; }
+  long long sum;
+};
+
+template <typename SET>
+static void measure(const char *name, int set_size, long long& sum)
+{
+  long long bytes_before = current_malloc_bytes();
+  std::vector<SET> *sets = new std::vector<SET>(num_sets);
+  for(int i = 0; i < num_sets; i++)
+    for(int j = 0; j < set_size; j++)
+      (*sets)[i].add(((i + j * 997) % MAX_NUM_NODES));
+  long long heap_bytes = (current_malloc_bytes() - bytes_before -
+			  num_sets * sizeof(SET));
+
+  SumNodes total;
+  long long start = Clock::current_time_in_nanoseconds();
+  for(int it = 0; it < num_iterations; it++)
+    for(int i = 0; i < num_sets; i++)
+      (*sets)[i].map(total);
+  long long elapsed = Clock::current_time_in_nanoseconds() - start;
+  sum = total.sum;
+
+  long long set_bytes = sizeof(SET);
+  if(COUNTING_MALLOCS)
+    set_bytes += heap_bytes / num_sets;
+  printf("  %s %4lld B/set %7.1f ns/trigger", name, set_bytes,
+	 (double)elapsed / ((double)num_sets * num_iterations));
+  delete sets;
+}
+
+int main(int argc, char **argv)
+{
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-n")) {
+      num_sets = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+  }
+
+  int sizes[] = { 0, 1, 2, 4, 8, 64, 512 };
+  for(size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    long long realm_sum, legion_sum;
+    printf("%3d nodes:", sizes[i]);
+    measure<NodeSet>("realm", sizes[i], realm_sum);
+    measure<LegionNodeSet>("legion", sizes[i], legion_sum);
+    printf("\n");
+    if(realm_sum != legion_sum) {
+      printf("MISMATCH: %lld != %lld\n", realm_sum, legion_sum);
+      exit(1);
+    }
+  }
+
+  printf("done!\n");
+  return 0;
+}
@@ -0,0 +1,132 @@
+// measures the rate at which tasks can be spawned and run on the local node,
+//  and how many heap allocations each task costs, for a range of argument
+//  sizes - small arguments (like those of most runtime meta-tasks) should be
+//  stored inline in the task and the task objects themselves recycled, so
+//  in the steady state they should need very few allocations
+//
+// on glibc systems the allocations are counted by interposing malloc; on
+//  other systems only the spawn rate is reported
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <unistd.h>
+
+#include <vector>
+
+#include "realm/realm.h"
+
+using namespace Realm;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  EMPTY_TASK     = Processor::TASK_ID_FIRST_AVAILABLE+1,
+};
+
+int num_iterations = 100000;
+int batch_size = 1000;
+
+#ifdef __GLIBC__
+extern "C" void *__libc_malloc(size_t size);
+
+static volatile long long malloc_count = 0;
+
+extern "C" void *malloc(size_t size)
+{
+  __sync_fetch_and_add(&malloc_count, 1);
+  return __libc_malloc(size);
+}
+
+static long long current_malloc_count(void) { return malloc_count; }
+#define COUNTING_MALLOCS 1
+#else
+static long long current_malloc_count(void) { return 0; }
+#define COUNTING_MALLOCS 0
+#endif
+
+void empty_task(const void *args, size_t arglen, Processor p)
+{
+}
+
+// spawns batches of tasks and waits for each batch to finish, so that the
+//  recycled task objects (and events) get reused by later batches - the
+//  waits go from last to first so that the spawning thread usually only
+//  has to sleep once per batch
+static void spawn_batches(Processor p, const void *args, size_t arglen,
+			  int count, std::vector<Event>& events)
+{
+  for(int done = 0; done < count; done += batch_size) {
+    int n = count - done;
+    if(n > batch_size) n = batch_size;
+    for(int i = 0; i < n; i++)
+      events[i] = p.spawn(EMPTY_TASK, args, arglen);
+    for(int i = n - 1; i >= 0; i--)
+      events[i].wait();
+  }
+}
+
+static void measure_spawn_rate(Processor p, size_t arglen)
+{
+  std::vector<char> args(arglen ? arglen : 1, 0);
+  std::vector<Event> events(batch_size);
+
+  // warm up the recycling and the event tables
+  spawn_batches(p, &args[0], arglen, 10 * batch_size, events);
+
+  long long mallocs_before = current_malloc_count();
+  long long start = Clock::current_time_in_microseconds();
+  spawn_batches(p, &args[0], arglen, num_iterations, events);
+  long long elapsed = Clock::current_time_in_microseconds() - start;
+  long long mallocs = current_malloc_count() - mallocs_before;
+
+  printf("arglen %4zd: %9.0f tasks/s", arglen,
+	 num_iterations * 1e6 / (elapsed ? elapsed : 1));
+  if(COUNTING_MALLOCS)
+    printf(", %.3f mallocs/task", (double)mallocs / num_iterations);
+  printf("\n");
+}
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  // 16 bytes is typical for a meta-task, 64 is the largest argument stored
+  //  inline, and 256 needs a heap allocation
+  size_t sizes[] = { 0, 16, 64, 256 };
+  for(size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    measure_spawn_rate(p, sizes[i]);
+
+  printf("done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-b")) {
+      batch_size = atoi(argv[++i]);
+      continue;
+    }
+  }
+  assert(batch_size > 0);
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+  rt.register_task(EMPTY_TASK, empty_task);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  return 0;
+}
@@ -115,6 +115,31 @@ void response_task(const void *args, size_t arglen, Processor p)
   } else
     printf("no timeline\n");
 
+  // hardware counters may not be available (e.g. in a VM), but the
+  //  measurement should still be there
+  if(pr.has_measurement<OperationPerfCounters>()) {
+    OperationPerfCounters *op_counters = pr.get_measurement<OperationPerfCounters>();
+    if(op_counters->is_valid())
+      printf("op counters = %lld cycles, %lld instructions, %lld llc misses\n",
+	     op_counters->cycles, op_counters->instructions, op_counters->llc_misses);
+    else
+      printf("op counters unavailable\n");
+    delete op_counters;
+  } else
+    printf("no counters\n");
+
+  if(pr.has_measurement<ProcessorRuntimeOverhead>()) {
+    ProcessorRuntimeOverhead *overhead = pr.get_measurement<ProcessorRuntimeOverhead>();
+    printf("runtime overhead on " IDFMT " = %lld sched, %lld event, %lld message (ns)\n",
+	   overhead->proc.id, overhead->scheduler_time,
+	   overhead->event_time, overhead->message_time);
+    assert((overhead->scheduler_time >= 0) &&
+	   (overhead->event_time >= 0) &&
+	   (overhead->message_time >= 0));
+    delete overhead;
+  } else
+    printf("no runtime overhead\n");
+
   if(pr.user_data_size() > 0) {
     printf("user data = %zd (", pr.user_data_size());
     unsigned char *data = (unsigned char *)(pr.user_data());
@@ -175,7 +200,9 @@ void top_level_task(const void *args, size_t arglen, Processor p)
   ProfilingRequestSet prs;
   prs.add_request(first_cpu, RESPONSE_TASK, &first_cpu, sizeof(first_cpu))
     .add_measurement<OperationStatus>()
-    .add_measurement<OperationTimeline>();
+    .add_measurement<OperationTimeline>()
+    .add_measurement<OperationPerfCounters>()
+    .add_measurement<ProcessorRuntimeOverhead>();
 
   // we expect (exactly) three responses
   response_counter = Barrier::create_barrier(3);
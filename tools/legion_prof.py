@@ -35,6 +35,13 @@ meta_desc_pat = re.compile(prefix + r'Prof Meta Desc (?P<hlr>[0-9]+) (?P<kind>[a
 op_desc_pat = re.compile(prefix + r'Prof Op Desc (?P<opkind>[0-9]+) (?P<kind>[a-zA-Z0-9_ ]+)')
 proc_desc_pat = re.compile(prefix + r'Prof Proc Desc (?P<pid>[a-f0-9]+) (?P<kind>[0-9]+)')
 mem_desc_pat = re.compile(prefix + r'Prof Mem Desc (?P<mid>[a-f0-9]+) (?P<kind>[0-9]+) (?P<size>[0-9]+)')
+# hardware counters and runtime overhead (-hl:prof_counters)
+counters = r' (?P<cycles>-?[0-9]+) (?P<instructions>-?[0-9]+) (?P<misses>-?[0-9]+)'
+task_counters_pat = re.compile(prefix + r'Prof Task Counters (?P<tid>[0-9]+) (?P<fid>[0-9]+)' + counters)
+meta_counters_pat = re.compile(prefix + r'Prof Meta Counters (?P<opid>[0-9]+) (?P<hlr>[0-9]+)' + counters)
+copy_counters_pat = re.compile(prefix + r'Prof Copy Counters (?P<opid>[0-9]+) (?P<src>[a-f0-9]+) (?P<dst>[a-f0-9]+)' + counters)
+fill_counters_pat = re.compile(prefix + r'Prof Fill Counters (?P<opid>[0-9]+) (?P<dst>[a-f0-9]+)' + counters)
+proc_overhead_pat = re.compile(prefix + r'Prof Proc Overhead (?P<pid>[a-f0-9]+) (?P<time>[0-9]+) (?P<sched>[0-9]+) (?P<event>[0-9]+) (?P<message>[0-9]+)')
 
 # Make sure this is up to date with lowlevel.h
 processor_kinds = {
@@ -114,6 +121,55 @@ def color_helper(step, num_steps):
 def read_time(string):
     return long(string)/1000
 
+# hardware counter totals for a task, a variant, or a channel - a count
+# of -1 means the counter couldn't be read and is left out
+class Counters(object):
+    def __init__(self):
+        self.samples = 0
+        self.cycles = 0L
+        self.instructions = 0L
+        self.misses = 0L
+        self.measured_cycles = 0
+        self.measured_instructions = 0
+        self.measured_misses = 0
+
+    def add(self, cycles, instructions, misses):
+        self.samples += 1
+        if cycles >= 0:
+            self.cycles += cycles
+            self.measured_cycles += 1
+        if instructions >= 0:
+            self.instructions += instructions
+            self.measured_instructions += 1
+        if misses >= 0:
+            self.misses += misses
+            self.measured_misses += 1
+
+    def get_summary(self):
+        result = list()
+        if self.measured_instructions > 0:
+            result.append('instructions='+str(self.instructions))
+            if self.measured_cycles > 0 and self.cycles > 0:
+                result.append('IPC=%.2f' % (float(self.instructions)/float(self.cycles)))
+        if self.measured_misses > 0:
+            result.append('LLC misses='+str(self.misses))
+        return ' '.join(result)
+
+    def print_stats(self, indent):
+        print indent+'Counter Samples: '+str(self.samples)
+        if self.measured_cycles > 0:
+            print indent+'Cycles: '+str(self.cycles)
+        if self.measured_instructions > 0:
+            print indent+'Instructions: '+str(self.instructions)
+            if self.measured_cycles > 0 and self.cycles > 0:
+                print indent+'Instructions Per Cycle: %.3f' % \
+                        (float(self.instructions)/float(self.cycles))
+        if self.measured_misses > 0:
+            print indent+'LLC Misses: '+str(self.misses)
+            if self.measured_instructions > 0 and self.instructions > 0:
+                print indent+'LLC Misses Per 1000 Instructions: %.3f' % \
+                        (1000.0*float(self.misses)/float(self.instructions))
+
 class TimeRange(object):
     def __init__(self, start_time, stop_time):
         assert start_time <= stop_time
@@ -234,6 +290,8 @@ class TaskRange(TimeRange):
         if self.task.is_meta:
             title += (' '+self.task.get_initiation())
         title += (' '+self.task.get_timing())
+        if self.task.counters is not None:
+            title += (' '+self.task.counters.get_summary())
         printer.emit_timing_range(self.task.variant.color, level,
                                   self.start_time, self.stop_time, title)
         for subrange in self.subranges:
@@ -244,6 +302,8 @@ class TaskRange(TimeRange):
         if self.task.is_meta:
             title += (' '+self.task.get_initiation())
         title += (' '+self.task.get_timing())
+        if self.task.counters is not None:
+            title += (' '+self.task.counters.get_summary())
         tsv_file.write("%d\t%ld\t%ld\t%s\t%s\n" % \
                 (base_level + (max_levels - level),
                  self.start_time, self.stop_time,
@@ -298,6 +358,7 @@ class Processor(object):
         self.kind = kind
         self.task_ranges = list()
         self.full_range = None
+        self.overhead = None
 
     def add_task(self, task):
         self.task_ranges.append(TaskRange(task))
@@ -337,6 +398,14 @@ class Processor(object):
         print "    Active time: %d us (%.3f%%)" % (active_time, active_ratio)
         print "    Application time: %d us (%.3f%%)" % (application_time, application_ratio)
         print "    Meta time: %d us (%.3f%%)" % (meta_time, meta_ratio)
+        if self.overhead is not None:
+            # times were logged in ns - event and message handling are
+            # totals for the whole node
+            time, sched, event, message = self.overhead
+            print "    Scheduler overhead: %d us (%.3f%%)" % \
+                    (sched/1000, 100.0*float(sched/1000)/float(total_time))
+            print "    Node event triggering: %d us" % (event/1000)
+            print "    Node message handling: %d us" % (message/1000)
         print
 
     def update_task_stats(self, stat):
@@ -459,6 +528,7 @@ class Channel(object):
         self.time_points = list()
         self.max_live_copies = None 
         self.last_time = None
+        self.counters = None
 
     def add_copy(self, copy):
         self.copies.add(copy)
@@ -536,6 +606,8 @@ class Channel(object):
         print "    Total Transfers: %d" % len(self.copies)
         print "    Maximum Executing Transfers: %d" % (max_transfers)
         print "    Average Utilization: %.3f%%" % (100.0 * average_usage)
+        if self.counters is not None:
+            self.counters.print_stats('    ')
         print
         
     def __repr__(self):
@@ -566,6 +638,7 @@ class Variant(object):
         self.all_calls = list()
         self.max_call = None
         self.min_call = None
+        self.counters = None
 
     def add_task(self, task):
         self.tasks.append(task)
@@ -610,6 +683,8 @@ class Variant(object):
         print '       Average Time: %.2f us' % (avg)
         print '       Maximum Time: %d us (%.3f sig)' % (self.max_call,max_dev)
         print '       Minimum Time: %d us (%.3f sig)' % (self.min_call,min_dev)
+        if self.counters is not None:
+            self.counters.print_stats('       ')
         print
 
 class Operation(object):
@@ -628,6 +703,7 @@ class Operation(object):
         self.start = None
         self.stop = None
         self.color = None
+        self.counters = None
 
     def assign_color(self, color_map):
         assert self.color is None
@@ -675,6 +751,7 @@ class MetaTask(object):
         self.ready = None
         self.start = None
         self.stop = None
+        self.counters = None
 
     def get_timing(self):
         return 'total='+str(self.stop - self.start)+' us start='+ \
@@ -1035,6 +1112,47 @@ class State(object):
                                       memory_kinds[kind],
                                       long(m.group('size')))
                     continue
+                m = task_counters_pat.match(line)
+                if m is not None:
+                    self.log_task_counters(long(m.group('tid')),
+                                           int(m.group('fid')),
+                                           long(m.group('cycles')),
+                                           long(m.group('instructions')),
+                                           long(m.group('misses')))
+                    continue
+                m = meta_counters_pat.match(line)
+                if m is not None:
+                    self.log_meta_counters(long(m.group('opid')),
+                                           int(m.group('hlr')),
+                                           long(m.group('cycles')),
+                                           long(m.group('instructions')),
+                                           long(m.group('misses')))
+                    continue
+                m = copy_counters_pat.match(line)
+                if m is not None:
+                    self.log_copy_counters(long(m.group('opid')),
+                                           int(m.group('src'),16),
+                                           int(m.group('dst'),16),
+                                           long(m.group('cycles')),
+                                           long(m.group('instructions')),
+                                           long(m.group('misses')))
+                    continue
+                m = fill_counters_pat.match(line)
+                if m is not None:
+                    self.log_fill_counters(long(m.group('opid')),
+                                           int(m.group('dst'),16),
+                                           long(m.group('cycles')),
+                                           long(m.group('instructions')),
+                                           long(m.group('misses')))
+                    continue
+                m = proc_overhead_pat.match(line)
+                if m is not None:
+                    self.log_proc_overhead(int(m.group('pid'),16),
+                                           long(m.group('time')),
+                                           long(m.group('sched')),
+                                           long(m.group('event')),
+                                           long(m.group('message')))
+                    continue
                 # If we made it here then we failed to match
                 matches -= 1 
                 print 'Skipping line: %s' % line.strip()
@@ -1121,6 +1239,44 @@ class State(object):
             self.last_time = destroy 
         mem.add_instance(inst)
 
+    def log_task_counters(self, task_id, func_id, cycles, instructions, misses):
+        variant = self.find_variant(func_id)
+        task = self.find_task(task_id, variant)
+        if task.counters is None:
+            task.counters = Counters()
+        task.counters.add(cycles, instructions, misses)
+        if variant.counters is None:
+            variant.counters = Counters()
+        variant.counters.add(cycles, instructions, misses)
+
+    def log_meta_counters(self, op_id, hlr, cycles, instructions, misses):
+        variant = self.find_meta_variant(hlr)
+        if variant.counters is None:
+            variant.counters = Counters()
+        variant.counters.add(cycles, instructions, misses)
+
+    def log_copy_counters(self, op_id, src_mem, dst_mem,
+                          cycles, instructions, misses):
+        src = self.find_memory(src_mem)
+        dst = self.find_memory(dst_mem)
+        channel = self.find_channel(src, dst)
+        if channel.counters is None:
+            channel.counters = Counters()
+        channel.counters.add(cycles, instructions, misses)
+
+    def log_fill_counters(self, op_id, dst_mem, cycles, instructions, misses):
+        dst = self.find_memory(dst_mem)
+        channel = self.find_channel(None, dst)
+        if channel.counters is None:
+            channel.counters = Counters()
+        channel.counters.add(cycles, instructions, misses)
+
+    def log_proc_overhead(self, proc_id, time, sched, event, message):
+        # the values are cumulative, so keep the latest sample
+        proc = self.find_processor(proc_id)
+        if proc.overhead is None or proc.overhead[0] < time:
+            proc.overhead = (time, sched, event, message)
+
     def log_kind(self, task_id, name):
         if task_id not in self.task_kinds:
             self.task_kinds[task_id] = TaskKind(task_id, name)
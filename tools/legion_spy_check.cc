@@ -0,0 +1,1250 @@
+/* Copyright 2015 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Native replacement for the logical (-l) and physical (-c) checks and the
+//  dataflow graphs (-D) of legion_spy.py.  The log is streamed a line at a
+//  time into compact tables instead of Python object graphs, and the checks
+//  are then partitioned by context (logical) and by instance (physical) and
+//  run on a pool of threads.  Messages are printed in the same format as
+//  legion_spy.py, and the dataflow graphs are written as the same .dot files
+//  (render them with 'dot -Tpdf').
+//
+// Build with 'make' in this directory, 'make check' runs it on the log of an
+//  example (see test_legion_spy_check.sh).
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// these must match the values in legion_spy.py
+enum {
+  NO_ACCESS = 0x00000000,
+  READ_ONLY = 0x00000001,
+  READ_WRITE = 0x00000007,
+  WRITE_ONLY = 0x00000002,
+  REDUCE = 0x00000004,
+};
+
+enum {
+  EXCLUSIVE = 0,
+  ATOMIC = 1,
+  SIMULTANEOUS = 2,
+  RELAXED = 3,
+};
+
+enum {
+  NO_DEPENDENCE = 0,
+  TRUE_DEPENDENCE = 1,
+  ANTI_DEPENDENCE = 2,
+  ATOMIC_DEPENDENCE = 3,
+  SIMULTANEOUS_DEPENDENCE = 4,
+};
+
+enum OpKind {
+  UNKNOWN_OP,
+  TOP_TASK,
+  SINGLE_TASK,
+  INDEX_TASK,
+  MAPPING_OP,
+  CLOSE_OP,
+  FENCE_OP,
+  COPY_OP,
+  FILL_OP,
+  ACQUIRE_OP,
+  RELEASE_OP,
+  DELETION_OP,
+  DEP_PARTITION_OP,
+  PENDING_PARTITION_OP,
+};
+
+typedef unsigned long long ID;
+
+static bool verbose = false;
+
+static void appendf(std::string& out, const char *fmt, ...)
+{
+  char buffer[1024];
+  va_list args;
+  va_start(args, fmt);
+  int len = vsnprintf(buffer, sizeof(buffer), fmt, args);
+  va_end(args);
+  if(len < (int)sizeof(buffer)) {
+    out.append(buffer, len);
+  } else {
+    std::vector<char> big(len + 1);
+    va_start(args, fmt);
+    vsnprintf(&big[0], len + 1, fmt, args);
+    va_end(args);
+    out.append(&big[0], len);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// index space tree
+//
+
+class IndexNode {
+public:
+  IndexNode(bool _is_region, ID _uid)
+    : uid(_uid), parent(0), depth(-1), is_region(_is_region), disjoint(false) {}
+
+  // for a region this is the set of independent child partitions, for a
+  //  partition it's the set of independent child subspaces
+  bool is_independent(ID a, ID b) const
+  {
+    if(a > b) std::swap(a, b);
+    return (independent.find(std::make_pair(a, b)) != independent.end());
+  }
+
+  // depths are filled in by resolve_index_nodes before any checks run,
+  //  so the (parallel) checks only ever read them
+  int resolve_depth(void)
+  {
+    if(depth < 0)
+      depth = (parent ? (parent->resolve_depth() + 1) : 0);
+    return depth;
+  }
+
+  ID uid;
+  IndexNode *parent;
+  int depth;
+  bool is_region, disjoint;
+  std::set<std::pair<ID, ID> > independent;
+};
+
+static std::map<ID, IndexNode *> index_spaces, index_partitions;
+
+static IndexNode *get_index_node(bool is_region, ID uid)
+{
+  std::map<ID, IndexNode *>& nodes = (is_region ? index_spaces : index_partitions);
+  std::map<ID, IndexNode *>::iterator it = nodes.find(uid);
+  if(it != nodes.end())
+    return it->second;
+  IndexNode *node = new IndexNode(is_region, uid);
+  nodes[uid] = node;
+  return node;
+}
+
+static bool is_aliased(const IndexNode *inode1, const IndexNode *inode2)
+{
+  const IndexNode *orig1 = inode1;
+  const IndexNode *orig2 = inode2;
+  assert((inode1->depth >= 0) && (inode2->depth >= 0));
+  // lift the deeper node up to the depth of the shallower one
+  while(inode1->depth > inode2->depth)
+    inode1 = inode1->parent;
+  while(inode2->depth > inode1->depth)
+    inode2 = inode2->parent;
+  // one is a subset of the other
+  if((inode1 == orig2) || (inode2 == orig1))
+    return true;
+  // walk up in sync to the least common ancestor
+  const IndexNode *prev1 = 0, *prev2 = 0;
+  while(inode1 != inode2) {
+    if(!inode1->parent || !inode2->parent)
+      return false;
+    prev1 = inode1;
+    inode1 = inode1->parent;
+    prev2 = inode2;
+    inode2 = inode2->parent;
+  }
+  if(inode1->is_region)
+    return !inode1->is_independent(prev1->uid, prev2->uid);
+  return !(inode1->disjoint || inode1->is_independent(prev1->uid, prev2->uid));
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// operations and requirements
+//
+
+struct Requirement {
+  unsigned index;
+  bool is_reg;
+  ID ispace;
+  unsigned fspace, tid, priv, coher, redop;
+  std::vector<unsigned> fields;  // kept sorted
+  const IndexNode *inode;        // set by resolve_index_nodes
+
+  bool is_read_only(void) const { return (priv == NO_ACCESS) || (priv == READ_ONLY); }
+  bool has_write(void) const { return (priv == READ_WRITE) || (priv == REDUCE) || (priv == WRITE_ONLY); }
+  bool is_write_only(void) const { return priv == WRITE_ONLY; }
+  bool is_reduce(void) const { return priv == REDUCE; }
+  bool is_exclusive(void) const { return coher == EXCLUSIVE; }
+  bool is_atomic(void) const { return coher == ATOMIC; }
+  bool is_simult(void) const { return coher == SIMULTANEOUS; }
+  bool is_relaxed(void) const { return coher == RELAXED; }
+
+  void add_field(unsigned fid)
+  {
+    std::vector<unsigned>::iterator it = std::lower_bound(fields.begin(), fields.end(), fid);
+    if((it == fields.end()) || (*it != fid))
+      fields.insert(it, fid);
+  }
+
+  void print(std::string& out) const
+  {
+    if(is_reg)
+      appendf(out, "        Logical Region Requirement (0x%llx,%u,%u)\n", ispace, fspace, tid);
+    else
+      appendf(out, "        Logical Partition Requirement (%llu,%u,%u)\n", ispace, fspace, tid);
+    out += "          Fields: ";
+    for(size_t i = 0; i < fields.size(); i++)
+      appendf(out, (i ? ", %u" : "%u"), fields[i]);
+    out += "\n        Privilege: ";
+    switch(priv) {
+    case NO_ACCESS: out += "NO ACCESS"; break;
+    case READ_ONLY: out += "READ-ONLY"; break;
+    case READ_WRITE: out += "READ-WRITE"; break;
+    case WRITE_ONLY: out += "WRITE-ONLY"; break;
+    default: appendf(out, "REDUCE with Reduction Op %u", redop); break;
+    }
+    out += "\n        Coherence: ";
+    switch(coher) {
+    case EXCLUSIVE: out += "EXCLUSIVE"; break;
+    case ATOMIC: out += "ATOMIC"; break;
+    case SIMULTANEOUS: out += "SIMULTANEOUS"; break;
+    default: out += "RELAXED"; break;
+    }
+    out += "\n";
+  }
+};
+
+static int check_for_anti_dependence(const Requirement& req1, const Requirement& req2,
+				     int actual)
+{
+  if(req1.is_read_only())
+    return ANTI_DEPENDENCE;
+  if(req2.is_write_only())
+    return ANTI_DEPENDENCE;
+  return actual;
+}
+
+static int compute_dependence_type(const Requirement& req1, const Requirement& req2)
+{
+  if(req1.is_read_only() && req2.is_read_only())
+    return NO_DEPENDENCE;
+  if(req1.is_reduce() && req2.is_reduce())
+    return ((req1.redop == req2.redop) ? NO_DEPENDENCE : TRUE_DEPENDENCE);
+  if(req1.is_exclusive() || req2.is_exclusive())
+    return check_for_anti_dependence(req1, req2, TRUE_DEPENDENCE);
+  if(req1.is_atomic() || req2.is_atomic()) {
+    if(req1.is_atomic() && req2.is_atomic())
+      return check_for_anti_dependence(req1, req2, ATOMIC_DEPENDENCE);
+    if((!req1.is_atomic() && req1.is_read_only()) ||
+       (!req2.is_atomic() && req2.is_read_only()))
+      return NO_DEPENDENCE;
+    return check_for_anti_dependence(req1, req2, TRUE_DEPENDENCE);
+  }
+  return check_for_anti_dependence(req1, req2, SIMULTANEOUS_DEPENDENCE);
+}
+
+static bool fields_overlap(const std::vector<unsigned>& a, const std::vector<unsigned>& b)
+{
+  std::vector<unsigned>::const_iterator it1 = a.begin(), it2 = b.begin();
+  while((it1 != a.end()) && (it2 != b.end())) {
+    if(*it1 == *it2) return true;
+    if(*it1 < *it2) it1++; else it2++;
+  }
+  return false;
+}
+
+static int compute_dependence(const Requirement& req1, const Requirement& req2)
+{
+  if(req1.tid != req2.tid)
+    return NO_DEPENDENCE;
+  if(!fields_overlap(req1.fields, req2.fields))
+    return NO_DEPENDENCE;
+  if(!is_aliased(req1.inode, req2.inode))
+    return NO_DEPENDENCE;
+  return compute_dependence_type(req1, req2);
+}
+
+struct EventNode;
+
+class Operation {
+public:
+  Operation(ID _uid)
+    : uid(_uid), ctx(0), enclosing(0), kind(UNKNOWN_OP), inter_close(false),
+      local_index(0), start_event(-1), term_event(-1) {}
+
+  const Requirement *get_requirement(unsigned idx) const
+  {
+    for(std::vector<Requirement>::const_iterator it = reqs.begin();
+	it != reqs.end();
+	it++)
+      if(it->index == idx)
+	return &(*it);
+    return 0;
+  }
+
+  Requirement *get_requirement(unsigned idx)
+  {
+    return const_cast<Requirement *>(static_cast<const Operation *>(this)->get_requirement(idx));
+  }
+
+  // deletions and fences don't contribute to the all-pairs test
+  bool has_dependences(void) const
+  {
+    return (kind != DELETION_OP) && (kind != FENCE_OP) && (kind != UNKNOWN_OP);
+  }
+
+  std::string get_name(void) const
+  {
+    std::string result;
+    switch(kind) {
+    case TOP_TASK:
+    case SINGLE_TASK: appendf(result, "%s %llu", name.c_str(), uid); break;
+    case INDEX_TASK: result = name; break;
+    case MAPPING_OP: appendf(result, "Mapping %llu", uid); break;
+    case CLOSE_OP: appendf(result, "Close %llu", uid); break;
+    case FENCE_OP: appendf(result, "Fence %llu", uid); break;
+    case COPY_OP: appendf(result, "Copy Op %llu", uid); break;
+    case FILL_OP: appendf(result, "Fill %llu", uid); break;
+    case ACQUIRE_OP: appendf(result, "Acquire %llu", uid); break;
+    case RELEASE_OP: appendf(result, "Release %llu", uid); break;
+    case DELETION_OP: appendf(result, "Deletion %llu", uid); break;
+    case DEP_PARTITION_OP: appendf(result, "Dependent Partition %llu", uid); break;
+    case PENDING_PARTITION_OP: appendf(result, "Pending Partition %llu", uid); break;
+    default: appendf(result, "Operation %llu", uid); break;
+    }
+    return result;
+  }
+
+  void print_dot_node(FILE *f, const std::string& ctx_name) const;
+
+  ID uid, ctx;
+  ID enclosing;  // index task that a point task belongs to
+  unsigned kind;
+  bool inter_close;
+  std::string name;
+  std::vector<Requirement> reqs;
+  unsigned local_index;  // position in the enclosing context
+  int start_event, term_event;
+};
+
+static std::map<ID, Operation *> operations;
+
+static Operation *get_operation(ID uid)
+{
+  std::map<ID, Operation *>::iterator it = operations.find(uid);
+  if(it != operations.end())
+    return it->second;
+  Operation *op = new Operation(uid);
+  operations[uid] = op;
+  return op;
+}
+
+// slices map to the slice or index task they were split from
+static std::map<ID, ID> slice_parents;
+
+struct PointRequirement {
+  ID point, ispace;
+  unsigned index;
+};
+
+// point task requirements can only be built once the index task's
+//  requirements have been seen
+static std::vector<PointRequirement> point_requirements;
+
+static void add_point_task(ID slice, ID point)
+{
+  std::map<ID, ID>::const_iterator it = slice_parents.find(slice);
+  while(it != slice_parents.end()) {
+    slice = it->second;
+    it = slice_parents.find(slice);
+  }
+  Operation *index = get_operation(slice);
+  Operation *op = get_operation(point);
+  op->kind = SINGLE_TASK;
+  op->enclosing = slice;
+  op->name = index->name;
+}
+
+static void resolve_point_requirements(void)
+{
+  for(std::vector<PointRequirement>::const_iterator it = point_requirements.begin();
+      it != point_requirements.end();
+      it++) {
+    Operation *op = get_operation(it->point);
+    if(!op->enclosing || op->get_requirement(it->index))
+      continue;
+    const Requirement *parent = get_operation(op->enclosing)->get_requirement(it->index);
+    if(!parent)
+      continue;
+    Requirement req = *parent;
+    req.is_reg = true;
+    req.ispace = it->ispace;
+    op->reqs.push_back(req);
+  }
+  std::vector<PointRequirement>().swap(point_requirements);
+}
+
+// looks up the index node of every requirement and the depth of every node
+//  up front - the checks run on several threads and must not add to the
+//  index space maps or fill in depths while they run
+static void resolve_index_nodes(void)
+{
+  for(std::map<ID, Operation *>::iterator it = operations.begin();
+      it != operations.end();
+      it++)
+    for(std::vector<Requirement>::iterator rit = it->second->reqs.begin();
+	rit != it->second->reqs.end();
+	rit++)
+      rit->inode = get_index_node(rit->is_reg, rit->ispace);
+  for(std::map<ID, IndexNode *>::const_iterator it = index_spaces.begin();
+      it != index_spaces.end();
+      it++)
+    it->second->resolve_depth();
+  for(std::map<ID, IndexNode *>::const_iterator it = index_partitions.begin();
+      it != index_partitions.end();
+      it++)
+    it->second->resolve_depth();
+}
+
+void Operation::print_dot_node(FILE *f, const std::string& ctx_name) const
+{
+  const char *prefix = "task_node_";
+  const char *color = "mediumslateblue";
+  switch(kind) {
+  case MAPPING_OP: prefix = "mapping_node_"; color = "mediumseagreen"; break;
+  case CLOSE_OP: prefix = "close_op_"; color = (inter_close ? "red" : "orangered"); break;
+  case FENCE_OP: prefix = "fence_node_"; color = "darkorchid2"; break;
+  case COPY_OP: prefix = "copy_across_"; color = "darkgoldenrod3"; break;
+  case FILL_OP: prefix = "fill_node_"; color = "darkorange1"; break;
+  case ACQUIRE_OP: prefix = "acquire_node_"; color = "darkolivegreen"; break;
+  case RELEASE_OP: prefix = "release_node_"; color = "darksalmon"; break;
+  case DELETION_OP: prefix = "deletion_node_"; color = "dodgerblue3"; break;
+  case DEP_PARTITION_OP: prefix = "dep_partition_node_"; color = "steelblue"; break;
+  case PENDING_PARTITION_OP: prefix = "pending_partition_node_"; color = "honeydew"; break;
+  default: break;
+  }
+  std::string label;
+  if((kind == SINGLE_TASK) || (kind == INDEX_TASK))
+    appendf(label, "%s\\nUnique\\ ID\\ %llu", name.c_str(), uid);
+  else if(kind == CLOSE_OP)
+    appendf(label, "Close\\ %llu\\ in\\ %s", uid, ctx_name.c_str());
+  else {
+    label = get_name();
+    for(size_t pos = label.find(' '); pos != std::string::npos; pos = label.find(' ', pos + 2))
+      label.replace(pos, 1, "\\ ");
+  }
+  fprintf(f, "  %s%llu [style=filled,label=\"%s\",fillcolor=%s,fontsize=14,"
+	  "fontcolor=black,shape=record,penwidth=2];\n",
+	  prefix, uid, label.c_str(), color);
+}
+
+static std::string dot_node_name(const Operation *op)
+{
+  const char *prefix = "task_node_";
+  switch(op->kind) {
+  case MAPPING_OP: prefix = "mapping_node_"; break;
+  case CLOSE_OP: prefix = "close_op_"; break;
+  case FENCE_OP: prefix = "fence_node_"; break;
+  case COPY_OP: prefix = "copy_across_"; break;
+  case FILL_OP: prefix = "fill_node_"; break;
+  case ACQUIRE_OP: prefix = "acquire_node_"; break;
+  case RELEASE_OP: prefix = "release_node_"; break;
+  case DELETION_OP: prefix = "deletion_node_"; break;
+  case DEP_PARTITION_OP: prefix = "dep_partition_node_"; break;
+  case PENDING_PARTITION_OP: prefix = "pending_partition_node_"; break;
+  default: break;
+  }
+  std::string result(prefix);
+  appendf(result, "%llu", op->uid);
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// contexts and mapping dependences
+//
+
+struct MappingDependence {
+  // op1 and op2 are indices into the context's list of operations
+  unsigned op1, op2, idx1, idx2, dtype;
+
+  bool operator<(const MappingDependence& rhs) const
+  {
+    if(op1 != rhs.op1) return op1 < rhs.op1;
+    if(op2 != rhs.op2) return op2 < rhs.op2;
+    if(idx1 != rhs.idx1) return idx1 < rhs.idx1;
+    if(idx2 != rhs.idx2) return idx2 < rhs.idx2;
+    return dtype < rhs.dtype;
+  }
+};
+
+struct RawDependence {
+  ID prev_id, next_id;
+  unsigned pidx, nidx, dtype;
+};
+
+class Context {
+public:
+  Context(ID _uid) : uid(_uid) {}
+
+  void resolve_dependences(void);
+  void check_dependences(std::string& out) const;
+  bool print_dataflow(const char *path) const;
+
+  ID uid;
+  std::vector<Operation *> ops;
+  std::vector<RawDependence> raw_deps;
+  std::vector<MappingDependence> mdeps;
+  // the recorded dependences as edges from the later op to the earlier one
+  std::vector<std::vector<unsigned> > outgoing;
+};
+
+static std::map<ID, Context *> contexts;
+// contexts in the order they were first seen, so output is deterministic
+static std::vector<Context *> context_order;
+
+static Context *get_context(ID uid)
+{
+  std::map<ID, Context *>::iterator it = contexts.find(uid);
+  if(it != contexts.end())
+    return it->second;
+  Context *ctx = new Context(uid);
+  contexts[uid] = ctx;
+  context_order.push_back(ctx);
+  return ctx;
+}
+
+static void add_operation(ID ctx_uid, ID uid, unsigned kind)
+{
+  Operation *op = get_operation(uid);
+  // the top-level task is logged a second time as an individual task
+  if(op->kind == TOP_TASK)
+    return;
+  op->kind = kind;
+  op->ctx = ctx_uid;
+  Context *ctx = get_context(ctx_uid);
+  op->local_index = ctx->ops.size();
+  ctx->ops.push_back(op);
+}
+
+void Context::resolve_dependences(void)
+{
+  outgoing.resize(ops.size());
+  for(std::vector<RawDependence>::const_iterator it = raw_deps.begin();
+      it != raw_deps.end();
+      it++) {
+    std::map<ID, Operation *>::const_iterator prev = operations.find(it->prev_id);
+    std::map<ID, Operation *>::const_iterator next = operations.find(it->next_id);
+    if((prev == operations.end()) || (prev->second->ctx != uid) ||
+       (next == operations.end()) || (next->second->ctx != uid))
+      continue;
+    MappingDependence dep;
+    dep.op1 = prev->second->local_index;
+    dep.op2 = next->second->local_index;
+    dep.idx1 = it->pidx;
+    dep.idx2 = it->nidx;
+    dep.dtype = it->dtype;
+    mdeps.push_back(dep);
+    if(dep.op1 != dep.op2)
+      outgoing[dep.op2].push_back(dep.op1);
+  }
+  std::vector<RawDependence>().swap(raw_deps);
+}
+
+// marks every operation reachable from 'start' along the recorded
+//  dependences with 'mark'
+static void mark_reachable(const std::vector<std::vector<unsigned> >& edges,
+			   unsigned start, std::vector<unsigned>& marks, unsigned mark,
+			   std::vector<unsigned>& stack)
+{
+  stack.clear();
+  stack.push_back(start);
+  marks[start] = mark;
+  while(!stack.empty()) {
+    unsigned cur = stack.back();
+    stack.pop_back();
+    for(std::vector<unsigned>::const_iterator it = edges[cur].begin();
+	it != edges[cur].end();
+	it++)
+      if(marks[*it] != mark) {
+	marks[*it] = mark;
+	stack.push_back(*it);
+      }
+  }
+}
+
+void Context::check_dependences(std::string& out) const
+{
+  const Operation *task = operations.find(uid)->second;
+  appendf(out, "Checking mapping dependences for task context %s (UID %llu)\n",
+	  task->name.c_str(), uid);
+  if(ops.size() < 2)
+    return;
+
+  // requirements are bucketed by (tree, field) so the all-pairs test only
+  //  looks at earlier requirements that can possibly interfere
+  typedef std::pair<unsigned, unsigned> ReqRef;  // (op, requirement)
+  std::map<std::pair<unsigned, unsigned>, std::vector<ReqRef> > buckets;
+  std::vector<MappingDependence> adeps;
+  std::vector<ReqRef> candidates;
+  for(unsigned idx = 0; idx < ops.size(); idx++) {
+    const Operation *op = ops[idx];
+    if(!op->has_dependences())
+      continue;
+    for(unsigned r = 0; r < op->reqs.size(); r++) {
+      const Requirement& req = op->reqs[r];
+      candidates.clear();
+      for(std::vector<unsigned>::const_iterator fit = req.fields.begin();
+	  fit != req.fields.end();
+	  fit++) {
+	std::map<std::pair<unsigned, unsigned>, std::vector<ReqRef> >::const_iterator bit =
+	  buckets.find(std::make_pair(req.tid, *fit));
+	if(bit != buckets.end())
+	  candidates.insert(candidates.end(), bit->second.begin(), bit->second.end());
+      }
+      std::sort(candidates.begin(), candidates.end());
+      candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+      for(std::vector<ReqRef>::const_iterator it = candidates.begin();
+	  it != candidates.end();
+	  it++) {
+	const Requirement& prev_req = ops[it->first]->reqs[it->second];
+	int dtype = compute_dependence(prev_req, req);
+	if(dtype != NO_DEPENDENCE) {
+	  MappingDependence dep;
+	  dep.op1 = it->first;
+	  dep.op2 = idx;
+	  dep.idx1 = prev_req.index;
+	  dep.idx2 = req.index;
+	  dep.dtype = dtype;
+	  adeps.push_back(dep);
+	}
+      }
+    }
+    // add after the loop so an operation never depends on itself
+    for(unsigned r = 0; r < op->reqs.size(); r++)
+      for(std::vector<unsigned>::const_iterator fit = op->reqs[r].fields.begin();
+	  fit != op->reqs[r].fields.end();
+	  fit++)
+	buckets[std::make_pair(op->reqs[r].tid, *fit)].push_back(ReqRef(idx, r));
+  }
+  std::map<std::pair<unsigned, unsigned>, std::vector<ReqRef> >().swap(buckets);
+
+  appendf(out, "    Found %zd dependences in all-pairs test for task %s\n",
+	  adeps.size(), task->name.c_str());
+  if(verbose) {
+    out += "        Computed Dependences:\n";
+    for(std::vector<MappingDependence>::const_iterator it = mdeps.begin();
+	it != mdeps.end();
+	it++)
+      appendf(out, "          index %u of %s (ID %llu) and index %u of %s (ID %llu)\n",
+	      it->idx1, ops[it->op1]->get_name().c_str(), ops[it->op1]->uid,
+	      it->idx2, ops[it->op2]->get_name().c_str(), ops[it->op2]->uid);
+    out += "        Actual Dependences:\n";
+    for(std::vector<MappingDependence>::const_iterator it = adeps.begin();
+	it != adeps.end();
+	it++)
+      appendf(out, "          index %u of %s (ID %llu) and index %u of %s (ID %llu)\n",
+	      it->idx1, ops[it->op1]->get_name().c_str(), ops[it->op1]->uid,
+	      it->idx2, ops[it->op2]->get_name().c_str(), ops[it->op2]->uid);
+  }
+
+  // adeps are grouped by their later operation, so one traversal from each
+  //  later operation answers every query for it
+  std::vector<unsigned> marks(ops.size(), 0);
+  std::vector<unsigned> stack;
+  unsigned mark = 0;
+  unsigned marked_from = (unsigned)-1;
+  std::set<MappingDependence> expected;
+  unsigned errors = 0;
+  for(std::vector<MappingDependence>::const_iterator it = adeps.begin();
+      it != adeps.end();
+      it++) {
+    if(it->op2 != marked_from) {
+      mark_reachable(outgoing, it->op2, marks, ++mark, stack);
+      marked_from = it->op2;
+    }
+    bool check = (marks[it->op1] == mark);
+    bool reversed = false;
+    if(!check && (ops[it->op2]->kind == CLOSE_OP) && ops[it->op2]->inter_close) {
+      mark_reachable(outgoing, it->op1, marks, ++mark, stack);
+      marked_from = (unsigned)-1;
+      check = reversed = (marks[it->op2] == mark);
+    }
+    if(reversed) {
+      MappingDependence rev;
+      rev.op1 = it->op2;
+      rev.op2 = it->op1;
+      rev.idx1 = it->idx2;
+      rev.idx2 = it->idx1;
+      rev.dtype = compute_dependence(*ops[it->op2]->get_requirement(it->idx2),
+				     *ops[it->op1]->get_requirement(it->idx1));
+      expected.insert(rev);
+    } else
+      expected.insert(*it);
+    if(!check) {
+      appendf(out, "    ERROR: Failed to compute mapping dependence between index %u of %s "
+	      "(ID %llu) and index %u of %s (ID %llu)\n",
+	      it->idx1, ops[it->op1]->get_name().c_str(), ops[it->op1]->uid,
+	      it->idx2, ops[it->op2]->get_name().c_str(), ops[it->op2]->uid);
+      out += "      First Requirement:\n";
+      ops[it->op1]->get_requirement(it->idx1)->print(out);
+      out += "      Second Requirement:\n";
+      ops[it->op2]->get_requirement(it->idx2)->print(out);
+      errors++;
+    }
+  }
+
+  unsigned warnings = 0;
+  for(std::vector<MappingDependence>::const_iterator it = mdeps.begin();
+      it != mdeps.end();
+      it++) {
+    if(expected.find(*it) != expected.end())
+      continue;
+    // legion_spy.py doesn't compute dependences for deletions yet
+    if(ops[it->op2]->kind == DELETION_OP)
+      continue;
+    appendf(out, "    WARNING: Computed extra mapping dependence between index %u of %s "
+	    "(ID %llu) and index %u of %s (ID %llu) in context of task %s\n",
+	    it->idx1, ops[it->op1]->get_name().c_str(), ops[it->op1]->uid,
+	    it->idx2, ops[it->op2]->get_name().c_str(), ops[it->op2]->uid,
+	    task->name.c_str());
+    warnings++;
+  }
+
+  appendf(out, "    Mapping Dependence Errors: %u\n", errors);
+  appendf(out, "    Mapping Dependence Warnings: %u\n", warnings);
+}
+
+bool Context::print_dataflow(const char *path) const
+{
+  if(ops.size() < 2)
+    return false;
+  const Operation *task = operations.find(uid)->second;
+  std::string name;
+  appendf(name, "dataflow_%s_%llu", task->name.c_str(), uid);
+  std::string filename = std::string(path) + "/" + name + ".dot";
+  FILE *f = fopen(filename.c_str(), "w");
+  if(!f) {
+    fprintf(stderr, "WARNING: unable to write %s\n", filename.c_str());
+    return false;
+  }
+  fprintf(f, "digraph %s\n{\n  compound = true;\n  rankdir=\"LR\";\n  size = \"36,36\";\n",
+	  name.c_str());
+  for(std::vector<Operation *>::const_iterator it = ops.begin(); it != ops.end(); it++)
+    (*it)->print_dot_node(f, task->name);
+  std::set<std::pair<unsigned, unsigned> > printed;
+  for(std::vector<MappingDependence>::const_iterator it = mdeps.begin();
+      it != mdeps.end();
+      it++)
+    if(printed.insert(std::make_pair(it->op1, it->op2)).second)
+      fprintf(f, "  %s -> %s [style=solid,color=black,penwidth=2];\n",
+	      dot_node_name(ops[it->op1]).c_str(), dot_node_name(ops[it->op2]).c_str());
+  fprintf(f, "}\n");
+  fclose(f);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// event graph and physical instances
+//
+
+// each event keeps the events that must trigger before it - an operation
+//  or copy links its termination event back to its start event
+static std::map<std::pair<ID, unsigned>, int> event_ids;
+static std::vector<std::vector<int> > event_preds;
+
+static int get_event(ID id, unsigned gen)
+{
+  std::pair<ID, unsigned> key(id, gen);
+  std::map<std::pair<ID, unsigned>, int>::iterator it = event_ids.find(key);
+  if(it != event_ids.end())
+    return it->second;
+  int idx = event_preds.size();
+  event_ids[key] = idx;
+  event_preds.push_back(std::vector<int>());
+  return idx;
+}
+
+static void add_event_edge(int pre, int post)
+{
+  if(pre != post)
+    event_preds[post].push_back(pre);
+}
+
+struct InstanceVersion {
+  ID iid;
+  std::vector<std::pair<Operation *, unsigned> > users;  // (op, requirement)
+};
+
+static std::map<ID, InstanceVersion *> current_instances;
+static std::vector<InstanceVersion *> all_instances;
+
+static void add_instance(ID iid)
+{
+  // instance ids can be recycled, so each creation starts a new version
+  InstanceVersion *inst = new InstanceVersion;
+  inst->iid = iid;
+  current_instances[iid] = inst;
+  all_instances.push_back(inst);
+}
+
+// per-thread state for searching the event graph
+struct EventSearch {
+  EventSearch(void) : mark(0) {}
+
+  // can 'target' trigger before 'start' without being ordered by it?
+  bool precedes(int target, int start)
+  {
+    if(marks.size() < event_preds.size())
+      marks.resize(event_preds.size(), 0);
+    mark++;
+    stack.clear();
+    stack.push_back(start);
+    marks[start] = mark;
+    while(!stack.empty()) {
+      int cur = stack.back();
+      stack.pop_back();
+      if(cur == target)
+	return true;
+      for(std::vector<int>::const_iterator it = event_preds[cur].begin();
+	  it != event_preds[cur].end();
+	  it++)
+	if(marks[*it] != mark) {
+	  marks[*it] = mark;
+	  stack.push_back(*it);
+	}
+    }
+    return false;
+  }
+
+  std::vector<unsigned> marks;
+  std::vector<int> stack;
+  unsigned mark;
+};
+
+static void check_instance(const InstanceVersion *inst, EventSearch& search,
+			   std::string& out)
+{
+  appendf(out, "Checking physical instance %llu...\n", inst->iid);
+  // group the users by field
+  std::map<unsigned, std::vector<std::pair<Operation *, const Requirement *> > > field_users;
+  for(std::vector<std::pair<Operation *, unsigned> >::const_iterator it = inst->users.begin();
+      it != inst->users.end();
+      it++) {
+    const Requirement *req = it->first->get_requirement(it->second);
+    if(!req)
+      continue;
+    for(std::vector<unsigned>::const_iterator fit = req->fields.begin();
+	fit != req->fields.end();
+	fit++)
+      field_users[*fit].push_back(std::make_pair(it->first, req));
+  }
+  std::map<std::pair<Operation *, Operation *>, bool> ordered;
+  for(std::map<unsigned, std::vector<std::pair<Operation *, const Requirement *> > >::const_iterator
+	fit = field_users.begin();
+      fit != field_users.end();
+      fit++) {
+    const std::vector<std::pair<Operation *, const Requirement *> >& users = fit->second;
+    for(size_t i = 0; i < users.size(); i++)
+      for(size_t j = i + 1; j < users.size(); j++) {
+	Operation *op1 = users[i].first;
+	Operation *op2 = users[j].first;
+	if(op1 == op2)
+	  continue;
+	int d1 = compute_dependence(*users[i].second, *users[j].second);
+	int d2 = compute_dependence(*users[j].second, *users[i].second);
+	if((d1 != TRUE_DEPENDENCE) && (d1 != ANTI_DEPENDENCE) &&
+	   (d2 != TRUE_DEPENDENCE) && (d2 != ANTI_DEPENDENCE))
+	  continue;
+	// operations without events can't be checked
+	if((op1->start_event < 0) || (op2->start_event < 0))
+	  continue;
+	std::pair<Operation *, Operation *> key((op1 < op2) ? op1 : op2, (op1 < op2) ? op2 : op1);
+	std::map<std::pair<Operation *, Operation *>, bool>::iterator oit = ordered.find(key);
+	if(oit == ordered.end()) {
+	  bool found = (search.precedes(op1->term_event, op2->start_event) ||
+			search.precedes(op2->term_event, op1->start_event));
+	  oit = ordered.insert(std::make_pair(key, found)).first;
+	}
+	if(oit->second)
+	  continue;
+	appendf(out, "   ERROR: Potential data race between requirement %u of %s (UID %llu) "
+		"and requirement %u of %s (UID %llu) for field %u\n",
+		users[i].second->index, op1->get_name().c_str(), op1->uid,
+		users[j].second->index, op2->get_name().c_str(), op2->uid, fit->first);
+	if(verbose) {
+	  out += "      First Requirement:\n";
+	  users[i].second->print(out);
+	  out += "      Second Requirement:\n";
+	  users[j].second->print(out);
+	}
+      }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// log parsing
+//
+
+static bool match(const char *& s, const char *prefix)
+{
+  size_t len = strlen(prefix);
+  if(strncmp(s, prefix, len))
+    return false;
+  s += len;
+  return true;
+}
+
+// reads the rest of a line after the (space-separated) numeric fields
+//  that were already parsed
+static std::string last_word(const char *s)
+{
+  const char *end = s + strlen(s);
+  while((end > s) && ((end[-1] == '\n') || (end[-1] == '\r') || (end[-1] == ' ')))
+    end--;
+  const char *start = end;
+  while((start > s) && (start[-1] != ' '))
+    start--;
+  return std::string(start, end);
+}
+
+static bool parse_line(const char *line)
+{
+  const char *s = strstr(line, "{legion_spy}: ");
+  if(!s)
+    return false;
+  s += strlen("{legion_spy}: ");
+
+  ID a, b, c;
+  unsigned u1, u2;
+
+  // region tree shape
+  if(match(s, "Index Space ")) {
+    if(match(s, "Name ")) return true;
+    if(match(s, "Independence ")) {
+      if(sscanf(s, "%llx %llx %llx", &a, &b, &c) != 3) return false;
+      get_index_node(true, a)->independent.insert(std::make_pair(std::min(b, c), std::max(b, c)));
+      return true;
+    }
+    if(sscanf(s, "%llx", &a) != 1) return false;
+    get_index_node(true, a);
+    return true;
+  }
+  if(match(s, "Index Partition ")) {
+    if(match(s, "Name ")) return true;
+    if(match(s, "Independence ")) {
+      if(sscanf(s, "%llx %llx %llx", &a, &b, &c) != 3) return false;
+      get_index_node(false, a)->independent.insert(std::make_pair(std::min(b, c), std::max(b, c)));
+      return true;
+    }
+    if(sscanf(s, "%llx %llx %u", &a, &b, &u1) != 3) return false;
+    IndexNode *part = get_index_node(false, b);
+    part->parent = get_index_node(true, a);
+    part->disjoint = (u1 != 0);
+    return true;
+  }
+  if(match(s, "Index Subspace ")) {
+    if(sscanf(s, "%llx %llx", &a, &b) != 2) return false;
+    get_index_node(true, b)->parent = get_index_node(false, a);
+    return true;
+  }
+
+  // operations
+  if(match(s, "Top Task ")) {
+    if(sscanf(s, "%u %llu", &u1, &a) != 2) return false;
+    Operation *op = get_operation(a);
+    op->kind = TOP_TASK;
+    op->name = last_word(s);
+    get_context(a);
+    return true;
+  }
+  if(match(s, "Individual Task ") || match(s, "Index Task ")) {
+    bool index = (strstr(line, "{legion_spy}: Index Task ") != 0);
+    if(sscanf(s, "%llu %u %llu", &a, &u1, &b) != 3) return false;
+    add_operation(a, b, (index ? INDEX_TASK : SINGLE_TASK));
+    if(!index)
+      get_context(b);
+    Operation *op = get_operation(b);
+    if(op->kind != TOP_TASK)
+      op->name = last_word(s);
+    return true;
+  }
+  static const struct { const char *prefix; unsigned kind; } simple_ops[] = {
+    { "Mapping Operation ", MAPPING_OP },
+    { "Close Operation ", CLOSE_OP },
+    { "Fence Operation ", FENCE_OP },
+    { "Copy Operation ", COPY_OP },
+    { "Fill Operation ", FILL_OP },
+    { "Acquire Operation ", ACQUIRE_OP },
+    { "Release Operation ", RELEASE_OP },
+    { "Deletion Operation ", DELETION_OP },
+    { "Dependent Partition Operation ", DEP_PARTITION_OP },
+    { "Pending Partition Operation ", PENDING_PARTITION_OP },
+  };
+  for(size_t i = 0; i < sizeof(simple_ops) / sizeof(simple_ops[0]); i++)
+    if(match(s, simple_ops[i].prefix)) {
+      int n = sscanf(s, "%llu %llu %u", &a, &b, &u1);
+      if(n < 2) return false;
+      add_operation(a, b, simple_ops[i].kind);
+      if((simple_ops[i].kind == CLOSE_OP) && (n == 3))
+	get_operation(b)->inter_close = (u1 != 0);
+      return true;
+    }
+
+  // index task slices and points
+  if(match(s, "Index Slice ") || match(s, "Slice Slice ")) {
+    if(sscanf(s, "%llu %llu", &a, &b) != 2) return false;
+    slice_parents[b] = a;
+    return true;
+  }
+  if(match(s, "Slice Point ")) {
+    if(sscanf(s, "%llu %llu", &a, &b) != 2) return false;
+    add_point_task(a, b);
+    get_context(b);
+    return true;
+  }
+  if(match(s, "Point Point ")) {
+    if(sscanf(s, "%llu %llu", &a, &b) != 2) return false;
+    // the same point task known by another id on a remote node
+    if(operations.find(b) == operations.end())
+      operations[b] = get_operation(a);
+    return true;
+  }
+  if(match(s, "Task Instance Requirement ")) {
+    PointRequirement req;
+    if(sscanf(s, "%llu %u %u", &req.point, &req.index, &u1) != 3) return false;
+    req.ispace = u1;
+    point_requirements.push_back(req);
+    return true;
+  }
+
+  // requirements and dependences
+  if(match(s, "Logical Requirement Field ")) {
+    if(sscanf(s, "%llu %u %u", &a, &u1, &u2) != 3) return false;
+    Requirement *req = get_operation(a)->get_requirement(u1);
+    if(!req) return false;
+    req->add_field(u2);
+    return true;
+  }
+  if(match(s, "Logical Requirement ")) {
+    Requirement req;
+    req.inode = 0;
+    if(sscanf(s, "%llu %u %u %llx %u %u %u %u %u", &a, &req.index, &u1, &req.ispace,
+	      &req.fspace, &req.tid, &req.priv, &req.coher, &req.redop) != 9) return false;
+    req.is_reg = (u1 != 0);
+    get_operation(a)->reqs.push_back(req);
+    return true;
+  }
+  if(match(s, "Mapping Dependence ")) {
+    RawDependence dep;
+    if(sscanf(s, "%llu %llu %u %llu %u %u", &a, &dep.prev_id, &dep.pidx,
+	      &dep.next_id, &dep.nidx, &dep.dtype) != 6) return false;
+    get_context(a)->raw_deps.push_back(dep);
+    return true;
+  }
+
+  // physical state
+  if(match(s, "Physical Instance ") || match(s, "Reduction Instance ")) {
+    if(sscanf(s, "%llx", &a) != 1) return false;
+    add_instance(a);
+    return true;
+  }
+  if(match(s, "Op Instance User ")) {
+    if(sscanf(s, "%llu %u %llx", &a, &u1, &b) != 3) return false;
+    std::map<ID, InstanceVersion *>::iterator it = current_instances.find(b);
+    if(it == current_instances.end()) return false;
+    it->second->users.push_back(std::make_pair(get_operation(a), u1));
+    return true;
+  }
+  if(match(s, "Event Event ") || match(s, "Implicit Event ")) {
+    if(sscanf(s, "%llx %u %llx %u", &a, &u1, &b, &u2) != 4) return false;
+    add_event_edge(get_event(a, u1), get_event(b, u2));
+    return true;
+  }
+  if(match(s, "Op Events ")) {
+    if(sscanf(s, "%llu %llx %u %llx %u", &a, &b, &u1, &c, &u2) != 5) return false;
+    Operation *op = get_operation(a);
+    op->start_event = get_event(b, u1);
+    op->term_event = get_event(c, u2);
+    add_event_edge(op->start_event, op->term_event);
+    return true;
+  }
+  if(match(s, "Copy Events ")) {
+    // (src manager, dst manager, index space, field space, tree, start, term)
+    if(sscanf(s, "%*x %*x %*x %*u %*u %llx %u %llx %u", &a, &u1, &b, &u2) != 4) return false;
+    add_event_edge(get_event(a, u1), get_event(b, u2));
+    return true;
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// parallel checking
+//
+
+struct WorkQueue {
+  size_t next, count;
+  void (*func)(size_t index, EventSearch& search, std::string& out);
+  std::vector<std::string> *results;
+};
+
+static void *worker_thread(void *arg)
+{
+  WorkQueue *queue = (WorkQueue *)arg;
+  EventSearch search;
+  while(true) {
+    size_t index = __sync_fetch_and_add(&queue->next, 1);
+    if(index >= queue->count)
+      break;
+    queue->func(index, search, (*queue->results)[index]);
+  }
+  return 0;
+}
+
+// runs func over [0, count) on 'num_threads' threads and prints the
+//  results in order
+static void run_parallel(size_t count, unsigned num_threads,
+			 void (*func)(size_t, EventSearch&, std::string&))
+{
+  std::vector<std::string> results(count);
+  WorkQueue queue;
+  queue.next = 0;
+  queue.count = count;
+  queue.func = func;
+  queue.results = &results;
+  std::vector<pthread_t> threads(num_threads);
+  for(unsigned i = 0; i < num_threads; i++)
+    pthread_create(&threads[i], 0, worker_thread, &queue);
+  for(unsigned i = 0; i < num_threads; i++)
+    pthread_join(threads[i], 0);
+  for(size_t i = 0; i < count; i++)
+    fputs(results[i].c_str(), stdout);
+}
+
+static std::vector<Context *> checked_contexts;
+
+static void check_context(size_t index, EventSearch& search, std::string& out)
+{
+  checked_contexts[index]->check_dependences(out);
+}
+
+static void check_instance_version(size_t index, EventSearch& search, std::string& out)
+{
+  check_instance(all_instances[index], search, out);
+}
+
+static void usage(const char *prog)
+{
+  fprintf(stderr, "Usage: %s [-l -c -v -t <threads> -D <dir>] <file_name> ...\n", prog);
+  fprintf(stderr, "  -l : perform logical analyses\n");
+  fprintf(stderr, "  -c : perform physical analyses\n");
+  fprintf(stderr, "  -v : verbose\n");
+  fprintf(stderr, "  -t : number of analysis threads (default: one per core)\n");
+  fprintf(stderr, "  -D : write dataflow graphs (.dot) into <dir>\n");
+  exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+  bool logical_checks = false, physical_checks = false;
+  const char *dataflow_path = 0;
+  long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+  int opt;
+  while((opt = getopt(argc, argv, "lcvt:D:")) != -1) {
+    switch(opt) {
+    case 'l': logical_checks = true; break;
+    case 'c': physical_checks = true; break;
+    case 'v': verbose = true; break;
+    case 't': num_threads = atol(optarg); break;
+    case 'D': dataflow_path = optarg; break;
+    default: usage(argv[0]);
+    }
+  }
+  if(optind >= argc)
+    usage(argv[0]);
+  if(num_threads < 1)
+    num_threads = 1;
+
+  // logs from every node can be given at once - a node's file contains
+  //  only the operations it ran, so nothing is assumed about ordering
+  //  between files except that a context's operations are logged by the
+  //  node the context ran on
+  size_t total_matches = 0;
+  char *line = 0;
+  size_t line_size = 0;
+  for(int i = optind; i < argc; i++) {
+    FILE *f = fopen(argv[i], "r");
+    if(!f) {
+      fprintf(stderr, "ERROR: unable to open %s\n", argv[i]);
+      return 1;
+    }
+    printf("Loading log file %s...\n", argv[i]);
+    while(getline(&line, &line_size, f) > 0)
+      if(parse_line(line))
+	total_matches++;
+    fclose(f);
+  }
+  free(line);
+  printf("Matched %zd lines\n", total_matches);
+  resolve_point_requirements();
+  resolve_index_nodes();
+  if(total_matches == 0) {
+    printf("No matches. Exiting...\n");
+    return 0;
+  }
+
+  for(std::vector<Context *>::const_iterator it = context_order.begin();
+      it != context_order.end();
+      it++) {
+    (*it)->resolve_dependences();
+    // only tasks have contexts that can be checked
+    std::map<ID, Operation *>::const_iterator op = operations.find((*it)->uid);
+    if((op != operations.end()) &&
+       ((op->second->kind == TOP_TASK) || (op->second->kind == SINGLE_TASK)))
+      checked_contexts.push_back(*it);
+  }
+
+  if(logical_checks) {
+    printf("Performing logical checks...\n");
+    fflush(stdout);
+    run_parallel(checked_contexts.size(), num_threads, check_context);
+  }
+  if(physical_checks) {
+    printf("Performing physical checks...\n");
+    fflush(stdout);
+    run_parallel(all_instances.size(), num_threads, check_instance_version);
+  }
+  if(dataflow_path) {
+    printf("Printing dataflow graphs...\n");
+    int total = 0;
+    for(std::vector<Context *>::const_iterator it = checked_contexts.begin();
+	it != checked_contexts.end();
+	it++)
+      if((*it)->print_dataflow(dataflow_path))
+	total++;
+    printf("Printed %d dataflow graphs\n", total);
+  }
+  printf("Legion Spy analysis complete.  Exiting...\n");
+  return 0;
+}
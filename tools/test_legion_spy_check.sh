@@ -0,0 +1,72 @@
+#!/bin/sh
+# Copyright 2015 Stanford University, NVIDIA Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Builds an example with -DLEGION_SPY in a scratch directory, runs it
+#  with '-level legion_spy=2' and runs legion_spy_check -l -c on the
+#  log.  Fails if the log has no Legion Spy lines or the checker reports
+#  any errors.  Usage (from the tools directory, with LG_RT_DIR set):
+#
+#    ./test_legion_spy_check.sh [example] [make arguments...]
+#
+#  The example defaults to 07_partitioning, the make arguments are passed
+#  to its build (e.g. USE_GASNET=0).  The runtime sources are copied into
+#  the scratch directory and built there, so the objects in LG_RT_DIR are
+#  never touched.
+
+set -e
+
+if [ -z "$LG_RT_DIR" ]; then
+  echo "LG_RT_DIR variable is not defined, aborting test" >&2
+  exit 1
+fi
+
+TOOLS_DIR=$(cd "$(dirname "$0")" && pwd)
+EXAMPLE=${1:-07_partitioning}
+[ $# -gt 0 ] && shift
+
+SCRATCH=$(mktemp -d)
+trap 'rm -rf "$SCRATCH"' EXIT
+
+# the runtime makefile puts objects next to their sources, so build a
+#  private copy of the runtime rather than the user's
+mkdir "$SCRATCH/runtime" "$SCRATCH/example"
+(cd "$LG_RT_DIR" && tar cf - --exclude='*.o' --exclude='*.a' .) | \
+  (cd "$SCRATCH/runtime" && tar xf -)
+cp "$TOOLS_DIR/../examples/$EXAMPLE"/* "$SCRATCH/example"
+OUTFILE=$(sed -n 's/^OUTFILE[[:space:]]*:=[[:space:]]*\([^[:space:]#]*\).*/\1/p' "$SCRATCH/example/Makefile")
+# CC_FLAGS comes from the environment so the runtime makefile can add to it
+CC_FLAGS=-DLEGION_SPY make -s -C "$SCRATCH/example" LG_RT_DIR="$SCRATCH/runtime" \
+  "$@" > "$SCRATCH/build.log" 2>&1 || {
+  cat "$SCRATCH/build.log"
+  exit 1
+}
+
+make -s -C "$TOOLS_DIR" legion_spy_check
+
+cd "$SCRATCH/example"
+# the log lines go wherever the logger writes, the checker skips the rest
+./$OUTFILE -level legion_spy=2 > spy.log 2>&1
+"$TOOLS_DIR/legion_spy_check" -l -c spy.log | tee check.log
+
+if grep -q "^No matches" check.log; then
+  echo "FAIL: no Legion Spy output in the log of $EXAMPLE"
+  exit 1
+fi
+if grep -q "ERROR:" check.log; then
+  echo "FAIL: legion_spy_check found errors in the log of $EXAMPLE"
+  exit 1
+fi
+echo "PASS: $EXAMPLE"